@@ -0,0 +1,43 @@
+using System;
+
+namespace UnixxtyMCP.Editor
+{
+    /// <summary>
+    /// Editor state a read-only tool or resource result depends on.
+    /// The native proxy caches such results and drops them when any of
+    /// the listed epochs is bumped by the matching editor change event.
+    /// </summary>
+    [Flags]
+    public enum CacheEpoch
+    {
+        /// <summary>
+        /// Not cached.
+        /// </summary>
+        None = 0,
+
+        /// <summary>
+        /// Loaded scenes, GameObjects and components.
+        /// </summary>
+        Scene = 1 << 0,
+
+        /// <summary>
+        /// Assets, scripts and project-level data on disk.
+        /// </summary>
+        Assets = 1 << 1,
+
+        /// <summary>
+        /// Console log entries.
+        /// </summary>
+        Console = 1 << 2,
+
+        /// <summary>
+        /// Editor selection.
+        /// </summary>
+        Selection = 1 << 3,
+
+        /// <summary>
+        /// Play mode, pause and compilation state.
+        /// </summary>
+        Editor = 1 << 4
+    }
+}
@@ -18,6 +18,12 @@ namespace UnixxtyMCP.Editor
         /// </summary>
         public string Description { get; }
 
+        /// <summary>
+        /// Editor state the resource depends on. When set, the proxy caches the
+        /// resource contents until one of these epochs changes.
+        /// </summary>
+        public CacheEpoch CacheEpochs { get; set; } = CacheEpoch.None;
+
         /// <summary>
         /// Creates a new MCP resource attribute.
         /// </summary>
@@ -48,6 +48,12 @@ namespace UnixxtyMCP.Editor
         /// </summary>
         public string Title { get; set; } = null;
 
+        /// <summary>
+        /// Editor state the result depends on. When set on a read-only tool, the proxy
+        /// caches results per argument set until one of these epochs changes.
+        /// </summary>
+        public CacheEpoch CacheEpochs { get; set; } = CacheEpoch.None;
+
         /// <summary>
         /// Creates a new MCP tool attribute.
         /// </summary>
@@ -0,0 +1,141 @@
+using System;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
+using UnityEngine;
+
+namespace UnixxtyMCP.Editor.Core
+{
+    /// <summary>
+    /// Puts binary data into JSON responses as base64 without building the base64 string
+    /// in managed memory.
+    ///
+    /// <see cref="Inline"/> copies the bytes to the native proxy and returns a short token to
+    /// use where the base64 text belongs. The proxy encodes the bytes in place of the token
+    /// with its SIMD kernels when the response is sent. Outside a proxy request, or with an
+    /// outdated native plugin, it returns the real base64 text instead.
+    /// </summary>
+    internal static class Base64Payload
+    {
+        #region P/Invoke Declarations
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr AttachBase64Payload(byte[] data, int length);
+
+        #endregion
+
+        private static bool s_unavailable = false;
+        private static bool s_inRequest = false;
+
+        // Attached bytes by token, for responses that leave through the spill path
+        private static readonly List<KeyValuePair<string, Func<byte[]>>> s_attached = new List<KeyValuePair<string, Func<byte[]>>>();
+
+        /// <summary>
+        /// Marks the start of a proxy request. Called by MCPProxy.
+        /// </summary>
+        internal static void BeginRequest()
+        {
+            s_attached.Clear();
+            s_inRequest = true;
+        }
+
+        /// <summary>
+        /// Marks the end of a proxy request. Called by MCPProxy.
+        /// </summary>
+        internal static void EndRequest()
+        {
+            s_attached.Clear();
+            s_inRequest = false;
+        }
+
+        /// <summary>
+        /// Gets text to put in a JSON string in place of the data's base64 encoding.
+        /// </summary>
+        /// <param name="data">Bytes to encode.</param>
+        /// <returns>A token the proxy expands, or the base64 text itself.</returns>
+        public static string Inline(byte[] data)
+        {
+            if (data == null)
+            {
+                return null;
+            }
+
+            if (s_inRequest && !s_unavailable && data.Length > 0)
+            {
+                try
+                {
+                    IntPtr ptr = AttachBase64Payload(data, data.Length);
+                    if (ptr != IntPtr.Zero)
+                    {
+                        string token = Marshal.PtrToStringAnsi(ptr);
+                        s_attached.Add(new KeyValuePair<string, Func<byte[]>>(token, () => data));
+                        return token;
+                    }
+                }
+                catch (EntryPointNotFoundException)
+                {
+                    // Outdated native plugin without deferred payloads
+                    s_unavailable = true;
+                    if (MCPProxy.VerboseLogging) Debug.Log("[Base64Payload] Native plugin has no base64 payloads; encoding in C#");
+                }
+            }
+
+            return Convert.ToBase64String(data);
+        }
+
+        /// <summary>
+        /// Gets text to put in a JSON string in place of an image's base64 encoding, without
+        /// waiting for a native encoding job to finish.
+        /// </summary>
+        /// <param name="png">PNG or JPEG to encode.</param>
+        /// <returns>A token the proxy expands, or the base64 text itself.</returns>
+        public static string Inline(ImageJob png)
+        {
+            if (png == null)
+            {
+                return null;
+            }
+
+            if (s_inRequest && !s_unavailable)
+            {
+                try
+                {
+                    string token = png.TryAttach();
+                    if (token != null)
+                    {
+                        s_attached.Add(new KeyValuePair<string, Func<byte[]>>(token, png.ToArray));
+                        return token;
+                    }
+                }
+                catch (EntryPointNotFoundException)
+                {
+                    s_unavailable = true;
+                    if (MCPProxy.VerboseLogging) Debug.Log("[Base64Payload] Native plugin has no base64 payloads; encoding in C#");
+                }
+            }
+
+            byte[] data = png.ToArray();
+            return data == null ? null : Convert.ToBase64String(data);
+        }
+
+        /// <summary>
+        /// Replaces tokens in a response with their base64 text. Needed only when the
+        /// response is not handed over with SendResponse (spilled or saved responses).
+        /// </summary>
+        /// <param name="response">Response JSON that may contain tokens.</param>
+        /// <returns>The response with every token expanded.</returns>
+        public static string Materialize(string response)
+        {
+            if (response == null || s_attached.Count == 0)
+            {
+                return response;
+            }
+
+            var builder = new System.Text.StringBuilder(response);
+            foreach (var attached in s_attached)
+            {
+                builder.Replace(attached.Key, Convert.ToBase64String(attached.Value() ?? Array.Empty<byte>()));
+            }
+            return builder.ToString();
+        }
+    }
+}
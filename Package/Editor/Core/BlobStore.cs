@@ -0,0 +1,141 @@
+using System;
+using System.Runtime.InteropServices;
+using UnityEngine;
+
+namespace UnixxtyMCP.Editor.Core
+{
+    /// <summary>
+    /// Publishes binary payloads (PNG captures, previews, binary resources) through the
+    /// proxy's blob side channel instead of base64-encoding them into JSON.
+    ///
+    /// Clients opt in per request with <c>params._meta.blobUrls = true</c>; the response then
+    /// carries a short-lived <c>/blob/&lt;id&gt;</c> URL, relative to the MCP endpoint, which the
+    /// proxy serves as raw bytes from its server thread. Requests without the flag, or an
+    /// outdated native plugin, fall back to inline base64.
+    /// </summary>
+    internal static class BlobStore
+    {
+        /// <summary>
+        /// How long a published blob stays fetchable.
+        /// </summary>
+        private const int TimeToLiveMs = 120000;
+
+        #region P/Invoke Declarations
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr StoreBlob(byte[] data, int length,
+            [MarshalAs(UnmanagedType.LPStr)] string mimeType, int ttlMs);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr GetBlobStats();
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int CopyBlob([MarshalAs(UnmanagedType.LPStr)] string id, byte[] output, int capacity);
+
+        #endregion
+
+        private static bool s_unavailable = false;
+
+        /// <summary>
+        /// Gets whether the request being handled asked for blob URLs. Set by MCPServer
+        /// around each request on the main thread.
+        /// </summary>
+        public static bool AcceptsBlobUrls { get; internal set; }
+
+        /// <summary>
+        /// Stores the data with the proxy if the current request accepts blob URLs.
+        /// </summary>
+        /// <param name="data">Payload bytes.</param>
+        /// <param name="mimeType">Content-Type the proxy serves the blob with.</param>
+        /// <returns>The blob URL relative to the MCP endpoint, or null to fall back to base64.</returns>
+        public static string TryPublish(byte[] data, string mimeType)
+        {
+            if (!AcceptsBlobUrls || s_unavailable || data == null || !MCPProxy.IsInitialized)
+            {
+                return null;
+            }
+
+            try
+            {
+                IntPtr ptr = StoreBlob(data, data.Length, mimeType, TimeToLiveMs);
+                return ptr == IntPtr.Zero ? null : "/blob/" + Marshal.PtrToStringAnsi(ptr);
+            }
+            catch (EntryPointNotFoundException)
+            {
+                // Outdated native plugin without the blob side channel
+                s_unavailable = true;
+                if (MCPProxy.VerboseLogging) Debug.Log("[BlobStore] Native plugin has no blob support; using base64");
+                return null;
+            }
+        }
+
+        /// <summary>
+        /// Stores an encoded image with the proxy if the current request accepts blob URLs.
+        /// Waits for the encoder only in that case.
+        /// </summary>
+        /// <param name="image">Image to publish.</param>
+        /// <returns>The blob URL relative to the MCP endpoint, or null to fall back to base64.</returns>
+        public static string TryPublish(ImageJob image)
+        {
+            if (!AcceptsBlobUrls || s_unavailable || image == null || !MCPProxy.IsInitialized)
+            {
+                return null;
+            }
+            return TryPublish(image.ToArray(), image.MimeType);
+        }
+
+        /// <summary>
+        /// Reads a blob back from the proxy, typically one a client uploaded with
+        /// <c>POST /blob</c> to pass as a tool parameter.
+        /// </summary>
+        /// <param name="id">Blob id, or its <c>/blob/&lt;id&gt;</c> URL.</param>
+        /// <returns>The blob's bytes, or null if it is unknown or expired.</returns>
+        public static byte[] TryRead(string id)
+        {
+            if (string.IsNullOrEmpty(id) || s_unavailable || !MCPProxy.IsInitialized)
+            {
+                return null;
+            }
+
+            int slash = id.LastIndexOf('/');
+            if (slash >= 0)
+            {
+                id = id.Substring(slash + 1);
+            }
+
+            try
+            {
+                // The blob cannot change, but it can expire between the two calls
+                int size = CopyBlob(id, null, 0);
+                if (size < 0)
+                {
+                    return null;
+                }
+                var data = new byte[size];
+                return CopyBlob(id, data, size) == size ? data : null;
+            }
+            catch (EntryPointNotFoundException)
+            {
+                // Outdated native plugin without uploads
+                if (MCPProxy.VerboseLogging) Debug.Log("[BlobStore] Native plugin cannot read blobs back");
+                return null;
+            }
+        }
+
+        /// <summary>
+        /// Gets blob table statistics (blobs, bytes, budget, stored, served, expired) as JSON.
+        /// </summary>
+        public static string GetStats()
+        {
+            try
+            {
+                IntPtr ptr = GetBlobStats();
+                return ptr == IntPtr.Zero ? "{}" : Marshal.PtrToStringAnsi(ptr);
+            }
+            catch (Exception)
+            {
+                return "{}";
+            }
+        }
+    }
+}
@@ -0,0 +1,185 @@
+using System;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
+using UnityEngine;
+
+namespace UnixxtyMCP.Editor.Core
+{
+    /// <summary>
+    /// Sends repeated captures of the same view as deltas.
+    ///
+    /// The native proxy splits each frame into 32x32 tiles, compares their hashes with the
+    /// session's previous frame and encodes only the changed tiles, packed into an atlas
+    /// PNG. Sessions live in the native plugin, so they survive domain reloads. A client
+    /// pastes atlas cell i (row-major, <see cref="FrameDeltaCapture.AtlasColumns"/> per row)
+    /// at the position of tile i over its copy of the previous frame.
+    /// </summary>
+    internal static class FrameDelta
+    {
+        /// <summary>
+        /// Tile edge in pixels.
+        /// </summary>
+        public const int TileSize = 32;
+
+        /// <summary>
+        /// Frames between keyframes, so that a client that lost a delta catches up.
+        /// </summary>
+        public const int DefaultKeyframeInterval = 30;
+
+        private const int InfoFrame = 0;
+        private const int InfoBaseFrame = 1;
+        private const int InfoKeyframe = 2;
+        private const int InfoWidth = 3;
+        private const int InfoHeight = 4;
+        private const int InfoAtlasColumns = 5;
+        private const int InfoJob = 6;
+        private const int InfoFields = 7;
+
+        #region P/Invoke Declarations
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int DiffFrame([MarshalAs(UnmanagedType.LPStr)] string session, Color32[] pixels,
+            int width, int height, int stride, int targetWidth, int targetHeight, int keyframeInterval,
+            int forceKeyframe, int[] tiles, int capacity, int[] info);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ResetFrameSession([MarshalAs(UnmanagedType.LPStr)] string session);
+
+        #endregion
+
+        private static bool s_unavailable = false;
+
+        /// <summary>
+        /// Diffs a readable texture against the session's previous frame.
+        /// </summary>
+        /// <param name="session">Session name; captures of different views need different sessions.</param>
+        /// <param name="texture">Texture whose CPU-side pixels to diff.</param>
+        /// <param name="targetWidth">Width to diff and send at, or 0 for the texture's.</param>
+        /// <param name="targetHeight">Height to diff and send at, or 0 for the texture's.</param>
+        /// <param name="topRowFirst">True if the pixel data is stored top row first.</param>
+        /// <param name="forceKeyframe">Send the whole frame.</param>
+        /// <param name="keyframeInterval">Frames between keyframes (0 for never).</param>
+        /// <returns>The delta, or null if the native differ is unavailable or failed.</returns>
+        public static FrameDeltaCapture Diff(string session, Texture2D texture, int targetWidth, int targetHeight,
+            bool topRowFirst, bool forceKeyframe, int keyframeInterval = DefaultKeyframeInterval)
+        {
+            if (s_unavailable || string.IsNullOrEmpty(session))
+            {
+                return null;
+            }
+
+            int width = texture.width;
+            int height = texture.height;
+            int outWidth = targetWidth > 0 ? targetWidth : width;
+            int outHeight = targetHeight > 0 ? targetHeight : height;
+            var tiles = new int[((outWidth + TileSize - 1) / TileSize) * ((outHeight + TileSize - 1) / TileSize)];
+            var info = new int[InfoFields];
+
+            int changed;
+            try
+            {
+                changed = DiffFrame(session, texture.GetPixels32(), width, height, topRowFirst ? width * 4 : -width * 4,
+                    outWidth, outHeight, keyframeInterval, forceKeyframe ? 1 : 0, tiles, tiles.Length, info);
+            }
+            catch (Exception ex) when (ex is EntryPointNotFoundException || ex is DllNotFoundException)
+            {
+                // Outdated or missing native plugin
+                s_unavailable = true;
+                if (MCPProxy.VerboseLogging) Debug.Log("[FrameDelta] Native frame differ unavailable; sending full captures");
+                return null;
+            }
+            if (changed < 0)
+            {
+                return null;
+            }
+
+            bool keyframe = info[InfoKeyframe] != 0;
+            if (!keyframe)
+            {
+                Array.Resize(ref tiles, changed);
+            }
+            return new FrameDeltaCapture
+            {
+                Frame = info[InfoFrame],
+                BaseFrame = info[InfoBaseFrame],
+                Keyframe = keyframe,
+                Width = info[InfoWidth],
+                Height = info[InfoHeight],
+                AtlasColumns = info[InfoAtlasColumns],
+                Tiles = keyframe ? Array.Empty<int>() : tiles,
+                Image = info[InfoJob] != 0 ? new ImageJob(info[InfoJob]) : null
+            };
+        }
+
+        /// <summary>
+        /// Makes the session's next capture a keyframe.
+        /// </summary>
+        /// <param name="session">Session name, or null for every session.</param>
+        public static void Reset(string session)
+        {
+            if (s_unavailable)
+            {
+                return;
+            }
+
+            try
+            {
+                ResetFrameSession(session);
+            }
+            catch (Exception ex) when (ex is EntryPointNotFoundException || ex is DllNotFoundException)
+            {
+                s_unavailable = true;
+            }
+        }
+    }
+
+    /// <summary>
+    /// One capture diffed by <see cref="FrameDelta"/>.
+    /// </summary>
+    internal sealed class FrameDeltaCapture
+    {
+        public int Frame;
+        public int BaseFrame;
+        public bool Keyframe;
+        public int Width;
+        public int Height;
+        public int AtlasColumns;
+
+        /// <summary>
+        /// Row-major indices of the changed tiles, in atlas order; empty for a keyframe.
+        /// </summary>
+        public int[] Tiles;
+
+        /// <summary>
+        /// The whole frame for a keyframe, otherwise the atlas; null if nothing changed.
+        /// </summary>
+        public ImageJob Image;
+
+        /// <summary>
+        /// Describes the delta for a tool result: tile positions are in pixels.
+        /// </summary>
+        public Dictionary<string, object> Describe()
+        {
+            int tilesPerRow = (Width + FrameDelta.TileSize - 1) / FrameDelta.TileSize;
+            var positions = new List<int[]>(Tiles.Length);
+            foreach (int tile in Tiles)
+            {
+                positions.Add(new[] { tile % tilesPerRow * FrameDelta.TileSize, tile / tilesPerRow * FrameDelta.TileSize });
+            }
+
+            var description = new Dictionary<string, object>
+            {
+                ["frame"] = Frame,
+                ["keyframe"] = Keyframe
+            };
+            if (!Keyframe)
+            {
+                description["base_frame"] = BaseFrame;
+                description["tile_size"] = FrameDelta.TileSize;
+                description["atlas_columns"] = AtlasColumns;
+                description["tiles"] = positions;
+            }
+            return description;
+        }
+    }
+}
@@ -482,6 +482,7 @@ namespace UnixxtyMCP.Editor.Core
         public string mimeType;
         public string text;
         public string blob;
+        public string blobUrl;
 
         /// <summary>
         /// Creates a text resource content
@@ -510,15 +511,17 @@ namespace UnixxtyMCP.Editor.Core
         }
 
         /// <summary>
-        /// Creates a binary resource content (base64 encoded)
+        /// Creates a binary resource content (a blob URL if the client accepts them, else base64 encoded)
         /// </summary>
         public static ResourceContent Binary(string uri, byte[] data, string mimeType = "application/octet-stream")
         {
+            string blobUrl = BlobStore.TryPublish(data, mimeType);
             return new ResourceContent
             {
                 uri = uri,
                 mimeType = mimeType,
-                blob = Convert.ToBase64String(data)
+                blob = blobUrl == null ? Base64Payload.Inline(data) : null,
+                blobUrl = blobUrl
             };
         }
     }
@@ -533,6 +536,7 @@ namespace UnixxtyMCP.Editor.Core
         public string text;
         public string mimeType;
         public string data;
+        public string blobUrl;
 
         /// <summary>
         /// Creates a text result
@@ -547,15 +551,17 @@ namespace UnixxtyMCP.Editor.Core
         }
 
         /// <summary>
-        /// Creates an image result (base64 encoded)
+        /// Creates an image result (a blob URL if the client accepts them, else base64 encoded)
         /// </summary>
         public static ToolResultContent Image(byte[] imageData, string mimeType = "image/png")
         {
+            string blobUrl = BlobStore.TryPublish(imageData, mimeType);
             return new ToolResultContent
             {
                 type = "image",
                 mimeType = mimeType,
-                data = Convert.ToBase64String(imageData)
+                data = blobUrl == null ? Base64Payload.Inline(imageData) : null,
+                blobUrl = blobUrl
             };
         }
     }
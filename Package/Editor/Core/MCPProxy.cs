@@ -4,6 +4,7 @@ using System.Linq;
 using System.Runtime.InteropServices;
 using System.Security.Cryptography;
 using System.Text.RegularExpressions;
+using Newtonsoft.Json;
 using Newtonsoft.Json.Linq;
 using UnityEditor;
 using UnityEngine;
@@ -22,13 +23,13 @@ namespace UnixxtyMCP.Editor.Core
     [InitializeOnLoad]
     public static class MCPProxy
     {
-        private const string DLL_NAME = "UnixxtyMCPProxy";
+        internal const string DLL_NAME = "UnixxtyMCPProxy";
         private const int DEFAULT_PORT = 8081;
 
         /// <summary>
         /// Maximum response size supported by the proxy buffer.
         /// Must match PROXY_MAX_RESPONSE_SIZE in proxy.h.
-        /// Responses exceeding this limit will trigger an error response.
+        /// Larger responses are handed to the proxy as spill files and streamed from disk.
         /// </summary>
         public const int MaxResponseSize = 262144;  // 256KB
 
@@ -46,9 +47,27 @@ namespace UnixxtyMCP.Editor.Core
         [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
         private static extern IntPtr GetPendingRequest();
 
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr GetPendingRequestFile();
+
         [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
         private static extern void SendResponse([MarshalAs(UnmanagedType.LPStr)] string json);
 
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int SendResponseFile([MarshalAs(UnmanagedType.LPStr)] string path);
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int GetPendingRequestSequence();
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void SendResponseForRequest(int sequence, [MarshalAs(UnmanagedType.LPStr)] string json);
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int SendResponseFileForRequest(int sequence, [MarshalAs(UnmanagedType.LPStr)] string path);
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ConfigureSpillDirectory([MarshalAs(UnmanagedType.LPStr)] string path);
+
         [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
         private static extern void ConfigureBindAddress([MarshalAs(UnmanagedType.LPStr)] string address);
 
@@ -63,6 +82,9 @@ namespace UnixxtyMCP.Editor.Core
         [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
         private static extern int GetTlsSupported();
 
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr GetProxyMemoryStats();
+
         #endregion
 
         /// <summary>
@@ -76,6 +98,29 @@ namespace UnixxtyMCP.Editor.Core
         /// </summary>
         private static string s_currentRequestId = null;
 
+        /// <summary>
+        /// The proxy's sequence number for the in-flight request, so that a response that
+        /// arrives after the request timed out is dropped instead of answering the next one.
+        /// 0 with a native plugin that does not number requests.
+        /// </summary>
+        private static int s_currentSequence = 0;
+
+        /// <summary>
+        /// Set when the native plugin does not number requests.
+        /// </summary>
+        private static bool s_noSequences = false;
+
+        /// <summary>
+        /// Directory for responses the proxy streams from disk (under Temp/, never imported),
+        /// or null if the native plugin cannot stream files.
+        /// </summary>
+        private static string s_spillDirectory = null;
+
+        /// <summary>
+        /// Set when the native plugin cannot hand over requests as files.
+        /// </summary>
+        private static bool s_noRequestFiles = false;
+
         /// <summary>
         /// The actual port this instance bound to (may differ from DEFAULT_PORT for ParrelSync clones).
         /// </summary>
@@ -136,6 +181,22 @@ namespace UnixxtyMCP.Editor.Core
             }
         }
 
+        /// <summary>
+        /// Gets the proxy's allocation statistics (per size class and for large blocks) as JSON.
+        /// </summary>
+        public static string GetMemoryStats()
+        {
+            try
+            {
+                IntPtr ptr = GetProxyMemoryStats();
+                return ptr == IntPtr.Zero ? "{}" : Marshal.PtrToStringAnsi(ptr);
+            }
+            catch (Exception)
+            {
+                return "{}";
+            }
+        }
+
         /// <summary>
         /// Starts the MCP proxy server.
         /// </summary>
@@ -157,6 +218,7 @@ namespace UnixxtyMCP.Editor.Core
             EditorApplication.update -= PollForRequests;
             AssemblyReloadEvents.beforeAssemblyReload -= OnBeforeReload;
             EditorApplication.quitting -= OnQuit;
+            ResponseCache.Shutdown();
 
             try
             {
@@ -351,6 +413,10 @@ namespace UnixxtyMCP.Editor.Core
                     return;
                 }
 
+                ConfigureSpill(result > 0);
+                StagedUploads.Configure(result > 0);
+                ProjectIndex.Configure();
+
                 // Activate polling and hook into EditorApplication.update
                 SetPollingActive(1);
                 EditorApplication.update += PollForRequests;
@@ -364,6 +430,9 @@ namespace UnixxtyMCP.Editor.Core
 
                 s_initialized = true;
 
+                // Let the native server answer cacheable read-only requests directly
+                ResponseCache.Initialize();
+
                 if (VerboseLogging) Debug.Log($"[MCPProxy] MCP proxy initialized on port {s_activePort} ({InstanceLabel})");
             }
             catch (DllNotFoundException dllException)
@@ -387,35 +456,84 @@ namespace UnixxtyMCP.Editor.Core
         /// </summary>
         private static void PollForRequests()
         {
+            int sequence = GetRequestSequence();
             IntPtr ptr = GetPendingRequest();
-            if (ptr == IntPtr.Zero)
+            string requestPath = ptr == IntPtr.Zero ? GetPendingRequestPath() : null;
+            if (ptr == IntPtr.Zero && requestPath == null)
             {
                 return;
             }
 
-            string jsonRequest = Marshal.PtrToStringAnsi(ptr);
-            string requestId = ExtractRequestId(jsonRequest);
-            string toolName = ExtractToolName(jsonRequest);
+            string jsonRequest = null;
+            JObject requestObject = null;
+            string requestId;
+            string toolName;
+            if (requestPath != null)
+            {
+                // Bodies too large for the request buffer are streamed to a spill file by the proxy
+                // and parsed from there, without building the request as one string
+                try
+                {
+                    requestObject = LoadRequestFile(requestPath);
+                }
+                catch (Exception exception) when (exception is JsonException || exception is IOException)
+                {
+                    Respond(sequence, BuildErrorResponse(-32700, $"Parse error: {exception.Message}", "null"));
+                    return;
+                }
+                requestId = requestObject["id"]?.ToString(Formatting.None) ?? "null";
+                toolName = requestObject["method"]?.ToString() == "tools/call" ? requestObject["params"]?["name"]?.ToString() : null;
+            }
+            else
+            {
+                jsonRequest = Marshal.PtrToStringAnsi(ptr);
+                requestId = ExtractRequestId(jsonRequest);
+                toolName = ExtractToolName(jsonRequest);
+            }
+
+            if (sequence != GetRequestSequence())
+            {
+                // The request timed out and the next one replaced it while it was read; pick that up next tick
+                return;
+            }
+            s_currentSequence = sequence;
 
             // Track the in-flight request so OnBeforeReload can respond if domain reload strikes
             s_currentRequestId = requestId;
 
             try
             {
-                string response = MCPServer.Instance.HandleRequest(jsonRequest);
+                Base64Payload.BeginRequest();
+                string response = requestObject != null
+                    ? MCPServer.Instance.HandleRequest(requestObject)
+                    : MCPServer.Instance.HandleRequest(jsonRequest);
+
+                // Spilled and saved responses do not pass through the proxy's token expansion
+                if (response != null && response.Length >= MaxResponseSize)
+                {
+                    response = Base64Payload.Materialize(response);
+                }
+
+                if (response != null && response.Length >= MaxResponseSize && TrySendSpilledResponse(sequence, response, toolName))
+                {
+                    s_currentRequestId = null;
+                    if (toolName != null)
+                        ActivityLog.Record(toolName, true, $"Streamed from spill file ({response.Length} bytes)");
+                    return;
+                }
 
                 if (response != null && response.Length >= MaxResponseSize)
                 {
                     Debug.LogWarning($"[MCPProxy] Response too large ({response.Length} bytes). Saving to file.");
                     string savedResponse = SaveOversizedResponse(response, toolName, requestId);
-                    SendResponse(savedResponse);
+                    Respond(sequence, savedResponse);
                     s_currentRequestId = null;
                     if (toolName != null)
                         ActivityLog.Record(toolName, true, "Saved to file (oversized)");
                     return;
                 }
 
-                SendResponse(response);
+                Respond(sequence, response);
                 s_currentRequestId = null;
                 if (toolName != null)
                     ActivityLog.Record(toolName, true);
@@ -436,11 +554,99 @@ namespace UnixxtyMCP.Editor.Core
                 }
 
                 string errorResponse = BuildErrorResponse(-32603, errorMessage, requestId);
-                SendResponse(errorResponse);
+                Respond(sequence, errorResponse);
                 s_currentRequestId = null;
                 if (toolName != null)
                     ActivityLog.Record(toolName, false, isDomainReload ? "Domain reload interrupted" : exception.Message);
             }
+            finally
+            {
+                Base64Payload.EndRequest();
+            }
+        }
+
+        /// <summary>
+        /// Gets the proxy's sequence number for the pending request, or 0.
+        /// </summary>
+        private static int GetRequestSequence()
+        {
+            if (s_noSequences)
+            {
+                return 0;
+            }
+
+            try
+            {
+                return GetPendingRequestSequence();
+            }
+            catch (EntryPointNotFoundException)
+            {
+                // Outdated native plugin: responses go to whichever request is pending
+                s_noSequences = true;
+                return 0;
+            }
+        }
+
+        /// <summary>
+        /// Answers the request with the given sequence number; the proxy drops the response
+        /// if that request is no longer pending.
+        /// </summary>
+        private static void Respond(int sequence, string json)
+        {
+            if (s_noSequences)
+            {
+                SendResponse(json);
+            }
+            else
+            {
+                SendResponseForRequest(sequence, json);
+            }
+        }
+
+        /// <summary>
+        /// Hands a spilled response for the request with the given sequence number to the proxy.
+        /// </summary>
+        private static int RespondWithFile(int sequence, string path)
+        {
+            return s_noSequences ? SendResponseFile(path) : SendResponseFileForRequest(sequence, path);
+        }
+
+        /// <summary>
+        /// Gets the spill file holding the pending request, if the proxy streamed its body to disk.
+        /// </summary>
+        private static string GetPendingRequestPath()
+        {
+            if (s_noRequestFiles)
+            {
+                return null;
+            }
+
+            try
+            {
+                IntPtr ptr = GetPendingRequestFile();
+                return ptr == IntPtr.Zero ? null : Marshal.PtrToStringAnsi(ptr);
+            }
+            catch (EntryPointNotFoundException)
+            {
+                // Outdated native plugin: large requests are rejected by the proxy
+                s_noRequestFiles = true;
+                return null;
+            }
+        }
+
+        /// <summary>
+        /// Parses a request the proxy streamed to a spill file. The proxy deletes the file
+        /// once the request is answered.
+        /// </summary>
+        private static JObject LoadRequestFile(string path)
+        {
+            using (var stream = new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.ReadWrite | FileShare.Delete,
+                64 * 1024, FileOptions.SequentialScan))
+            using (var reader = new JsonTextReader(new StreamReader(stream, new System.Text.UTF8Encoding(false))))
+            {
+                reader.DateParseHandling = DateParseHandling.None;
+                return JObject.Load(reader);
+            }
         }
 
         /// <summary>
@@ -461,7 +667,7 @@ namespace UnixxtyMCP.Editor.Core
                         "Request interrupted by Unity domain reload. This is recoverable — wait 2-3 seconds and retry. " +
                         "Domain reloads occur after exiting play mode or script recompilation.",
                         s_currentRequestId);
-                    SendResponse(errorResponse);
+                    Respond(s_currentSequence, errorResponse);
                     s_currentRequestId = null;
 
                     if (VerboseLogging)
@@ -470,6 +676,9 @@ namespace UnixxtyMCP.Editor.Core
 
                 SetPollingActive(0);
                 EditorApplication.update -= PollForRequests;
+
+                // Cached results may not survive the reload (tool set, compilation state)
+                ResponseCache.Shutdown();
             }
             catch (Exception exception)
             {
@@ -627,6 +836,71 @@ namespace UnixxtyMCP.Editor.Core
             return $"{{\"jsonrpc\":\"2.0\",\"error\":{{\"code\":{code},\"message\":\"{EscapeJson(message)}\"}},\"id\":{requestId}}}";
         }
 
+        /// <summary>
+        /// Sets up the proxy's spill directory and removes files left by a previous session.
+        /// </summary>
+        /// <param name="serverSurvived">True after a domain reload, when the proxy kept running and may
+        /// still hold request bodies it streamed to the directory.</param>
+        private static void ConfigureSpill(bool serverSurvived)
+        {
+            try
+            {
+                string directory = Path.GetFullPath(Path.Combine(Application.dataPath, "..", "Temp", "UnixxtyMCP", "Spill"));
+                Directory.CreateDirectory(directory);
+                foreach (string stale in Directory.GetFiles(directory))
+                {
+                    if (serverSurvived && Path.GetFileName(stale).StartsWith("upload_", StringComparison.Ordinal))
+                    {
+                        continue;
+                    }
+                    File.Delete(stale);
+                }
+
+                s_spillDirectory = directory.Replace("\\", "/");
+                ConfigureSpillDirectory(s_spillDirectory);
+            }
+            catch (EntryPointNotFoundException)
+            {
+                // Outdated native plugin: oversized responses fall back to Assets/_MCP_Output
+                s_spillDirectory = null;
+            }
+            catch (Exception exception)
+            {
+                s_spillDirectory = null;
+                Debug.LogWarning($"[MCPProxy] Spill directory unavailable: {exception.Message}");
+            }
+        }
+
+        /// <summary>
+        /// Writes an oversized response to the spill directory and hands it to the proxy,
+        /// which streams it to the client and deletes it. Returns false if the proxy
+        /// did not take the file.
+        /// </summary>
+        private static bool TrySendSpilledResponse(int sequence, string response, string toolName)
+        {
+            if (s_spillDirectory == null)
+            {
+                return false;
+            }
+
+            string path = $"{s_spillDirectory}/{toolName ?? "response"}_{Guid.NewGuid():N}.json";
+            try
+            {
+                File.WriteAllText(path, response, new System.Text.UTF8Encoding(false));
+                if (RespondWithFile(sequence, path) != 0)
+                {
+                    return true;
+                }
+                File.Delete(path);
+            }
+            catch (Exception exception)
+            {
+                Debug.LogWarning($"[MCPProxy] Failed to spill response: {exception.Message}");
+                try { File.Delete(path); } catch { /* Best effort */ }
+            }
+            return false;
+        }
+
         /// <summary>
         /// Saves an oversized response to a file and returns a small JSON-RPC success
         /// response with the file path, so agents can use the Read tool to paginate.
@@ -108,10 +108,30 @@ namespace UnixxtyMCP.Editor.Core
         /// <param name="jsonRequest">The raw JSON-RPC request string.</param>
         /// <returns>The JSON-RPC response string.</returns>
         public string HandleRequest(string jsonRequest)
+        {
+            JObject requestObject;
+            try
+            {
+                requestObject = JObject.Parse(jsonRequest);
+            }
+            catch (JsonException jsonException)
+            {
+                return CreateErrorResponse(MCPErrorCodes.ParseError, $"Parse error: {jsonException.Message}", null)
+                    .ToString(Formatting.None);
+            }
+            return HandleRequest(requestObject);
+        }
+
+        /// <summary>
+        /// Handles an already parsed JSON-RPC request, such as one read from a spill file.
+        /// This method is synchronous and runs on Unity's main thread.
+        /// </summary>
+        /// <param name="requestObject">The JSON-RPC request.</param>
+        /// <returns>The JSON-RPC response string.</returns>
+        public string HandleRequest(JObject requestObject)
         {
             try
             {
-                var requestObject = JObject.Parse(jsonRequest);
                 string requestId = requestObject["id"]?.ToString();
                 string method = requestObject["method"]?.ToString();
 
@@ -122,6 +142,8 @@ namespace UnixxtyMCP.Editor.Core
                 }
 
                 JToken paramsToken = requestObject["params"];
+                BlobStore.AcceptsBlobUrls = paramsToken?["_meta"]?["blobUrls"]?.Type == JTokenType.Boolean &&
+                    (bool)paramsToken["_meta"]["blobUrls"];
 
                 JObject response = method switch
                 {
@@ -149,6 +171,10 @@ namespace UnixxtyMCP.Editor.Core
                 return CreateErrorResponse(MCPErrorCodes.InternalError, $"Internal error: {exception.Message}", null)
                     .ToString(Formatting.None);
             }
+            finally
+            {
+                BlobStore.AcceptsBlobUrls = false;
+            }
         }
 
         #endregion
@@ -525,6 +551,10 @@ namespace UnixxtyMCP.Editor.Core
                 {
                     contentObject["blob"] = content.blob;
                 }
+                else if (!string.IsNullOrEmpty(content.blobUrl))
+                {
+                    contentObject["blobUrl"] = content.blobUrl;
+                }
 
                 contentsArray.Add(contentObject);
 
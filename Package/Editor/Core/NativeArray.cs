@@ -0,0 +1,360 @@
+using System;
+using System.IO;
+using System.IO.Compression;
+using System.Runtime.InteropServices;
+using UnityEngine;
+
+namespace UnixxtyMCP.Editor.Core
+{
+    /// <summary>
+    /// Encodes and decodes large numeric arrays (heightmaps, alphamaps) in the proxy's
+    /// typed array format instead of JSON number lists.
+    ///
+    /// An encoded array starts with "UMTA", a version byte, the element type, the flags and
+    /// the rank, followed by one little-endian uint32 extent per axis and the elements in
+    /// row-major order. The flags delta-code the elements, shuffle their bytes and wrap the
+    /// result in a zlib stream; the native plugin compresses it on all cores (see
+    /// <c>Proxy~/arrays.h</c>). With an outdated native plugin arrays are encoded raw and
+    /// decoded by a managed loop.
+    /// </summary>
+    internal static class NativeArray
+    {
+        public const int TypeUInt8 = 1;
+        public const int TypeUInt16 = 2;
+        public const int TypeInt32 = 3;
+        public const int TypeFloat32 = 4;
+
+        public const int FlagDelta = 1;
+        public const int FlagShuffle = 2;
+        public const int FlagDeflate = 4;
+
+        /// <summary>
+        /// Flags used for compressed arrays.
+        /// </summary>
+        public const int Compressed = FlagDelta | FlagShuffle | FlagDeflate;
+
+        public const string MimeType = "application/x-umta";
+
+        private const int MaxRank = 4;
+
+        #region P/Invoke Declarations
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int TypedArrayBound(int type, int[] shape, int rank);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int EncodeTypedArray(IntPtr data, int type, int[] shape, int rank, int flags,
+            byte[] output, int capacity);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int DecodeTypedArray(byte[] encoded, int length, IntPtr output, int capacity);
+
+        #endregion
+
+        private static bool s_unavailable = false;
+
+        /// <summary>
+        /// Gets the size in bytes of one element of a type, or 0 for an unknown type.
+        /// </summary>
+        public static int ElementSize(int type)
+        {
+            switch (type)
+            {
+                case TypeUInt8: return 1;
+                case TypeUInt16: return 2;
+                case TypeInt32:
+                case TypeFloat32: return 4;
+                default: return 0;
+            }
+        }
+
+        /// <summary>
+        /// Gets the name of an element type as used in tool parameters.
+        /// </summary>
+        public static string TypeName(int type)
+        {
+            switch (type)
+            {
+                case TypeUInt8: return "uint8";
+                case TypeUInt16: return "uint16";
+                case TypeInt32: return "int32";
+                case TypeFloat32: return "float32";
+                default: return "unknown";
+            }
+        }
+
+        /// <summary>
+        /// Parses an element type name ("uint8", "uint16", "int32" or "float32").
+        /// </summary>
+        /// <returns>The type, or 0 if the name is unknown.</returns>
+        public static int ParseType(string name)
+        {
+            switch (name?.Trim().ToLowerInvariant())
+            {
+                case "uint8": return TypeUInt8;
+                case "uint16": return TypeUInt16;
+                case "int32": return TypeInt32;
+                case "float32": return TypeFloat32;
+                default: return 0;
+            }
+        }
+
+        /// <summary>
+        /// Encodes an array of blittable elements. Multidimensional arrays are passed as
+        /// they are; their memory is already row-major.
+        /// </summary>
+        /// <param name="data">Elements matching the type; at least the shape's product.</param>
+        /// <param name="type">Element type (TypeUInt8 ... TypeFloat32).</param>
+        /// <param name="shape">Extent of each axis, 1 to 4 axes.</param>
+        /// <param name="compress">Whether to delta-code, shuffle and deflate.</param>
+        /// <returns>The encoded array.</returns>
+        public static byte[] Encode(Array data, int type, int[] shape, bool compress)
+        {
+            long count = ElementCount(shape);
+            int elementSize = ElementSize(type);
+            if (elementSize == 0 || count < 0 || count > data.Length || count * elementSize > int.MaxValue - 64)
+            {
+                throw new ArgumentException("Invalid array type or shape.");
+            }
+
+            var handle = GCHandle.Alloc(data, GCHandleType.Pinned);
+            try
+            {
+                if (!s_unavailable)
+                {
+                    try
+                    {
+                        int bound = TypedArrayBound(type, shape, shape.Length);
+                        if (bound > 0)
+                        {
+                            var output = new byte[bound];
+                            int size = EncodeTypedArray(handle.AddrOfPinnedObject(), type, shape, shape.Length,
+                                compress ? Compressed : 0, output, output.Length);
+                            if (size > 0)
+                            {
+                                Array.Resize(ref output, size);
+                                return output;
+                            }
+                        }
+                    }
+                    catch (Exception ex) when (ex is EntryPointNotFoundException || ex is DllNotFoundException)
+                    {
+                        // Outdated or missing native plugin
+                        s_unavailable = true;
+                        if (MCPProxy.VerboseLogging) Debug.Log("[NativeArray] Native typed arrays unavailable; encoding raw arrays in C#");
+                    }
+                }
+
+                int headerSize = 8 + shape.Length * 4;
+                var raw = new byte[headerSize + count * elementSize];
+                WriteHeader(raw, type, 0, shape);
+                Marshal.Copy(handle.AddrOfPinnedObject(), raw, headerSize, (int)(count * elementSize));
+                return raw;
+            }
+            finally
+            {
+                handle.Free();
+            }
+        }
+
+        /// <summary>
+        /// Reads the header of an encoded array.
+        /// </summary>
+        /// <param name="encoded">Encoded array.</param>
+        /// <param name="type">Element type.</param>
+        /// <param name="shape">Extent of each axis.</param>
+        /// <returns>False if the header is invalid.</returns>
+        public static bool TryReadHeader(byte[] encoded, out int type, out int[] shape)
+        {
+            type = 0;
+            shape = null;
+            if (encoded == null || encoded.Length < 8 || encoded[0] != 'U' || encoded[1] != 'M' ||
+                encoded[2] != 'T' || encoded[3] != 'A' || encoded[4] != 1)
+            {
+                return false;
+            }
+
+            int rank = encoded[7];
+            if (ElementSize(encoded[5]) == 0 || (encoded[6] & ~Compressed) != 0 || rank < 1 || rank > MaxRank ||
+                encoded.Length < 8 + rank * 4)
+            {
+                return false;
+            }
+
+            type = encoded[5];
+            shape = new int[rank];
+            for (int axis = 0; axis < rank; axis++)
+            {
+                uint extent = BitConverter.ToUInt32(encoded, 8 + axis * 4);
+                if (extent > int.MaxValue)
+                {
+                    return false;
+                }
+                shape[axis] = (int)extent;
+            }
+            return ElementCount(shape) >= 0;
+        }
+
+        /// <summary>
+        /// Decodes an array into a caller-allocated array of matching element type, such as
+        /// a float[,] of the expected shape.
+        /// </summary>
+        /// <param name="encoded">Encoded array.</param>
+        /// <param name="output">Receives the elements; must hold exactly the encoded count.</param>
+        /// <returns>False if the array is invalid or corrupt, or its size does not match.</returns>
+        public static bool TryDecode(byte[] encoded, Array output)
+        {
+            if (!TryReadHeader(encoded, out int type, out int[] shape) || ElementCount(shape) != output.Length ||
+                Buffer.ByteLength(output) != output.Length * ElementSize(type))
+            {
+                return false;
+            }
+
+            var handle = GCHandle.Alloc(output, GCHandleType.Pinned);
+            try
+            {
+                int capacity = Buffer.ByteLength(output);
+                if (!s_unavailable)
+                {
+                    try
+                    {
+                        return DecodeTypedArray(encoded, encoded.Length, handle.AddrOfPinnedObject(), capacity) == output.Length;
+                    }
+                    catch (Exception ex) when (ex is EntryPointNotFoundException || ex is DllNotFoundException)
+                    {
+                        s_unavailable = true;
+                        if (MCPProxy.VerboseLogging) Debug.Log("[NativeArray] Native typed arrays unavailable; decoding in C#");
+                    }
+                }
+
+                byte[] payload = DecodeManaged(encoded, 8 + shape.Length * 4, capacity, ElementSize(type));
+                if (payload == null)
+                {
+                    return false;
+                }
+                Marshal.Copy(payload, 0, handle.AddrOfPinnedObject(), capacity);
+                return true;
+            }
+            finally
+            {
+                handle.Free();
+            }
+        }
+
+        private static long ElementCount(int[] shape)
+        {
+            if (shape == null || shape.Length < 1 || shape.Length > MaxRank)
+            {
+                return -1;
+            }
+
+            long count = 1;
+            foreach (int extent in shape)
+            {
+                if (extent <= 0)
+                {
+                    return -1;
+                }
+                count *= extent;
+                if (count > int.MaxValue)
+                {
+                    return -1;
+                }
+            }
+            return count;
+        }
+
+        private static void WriteHeader(byte[] output, int type, int flags, int[] shape)
+        {
+            output[0] = (byte)'U';
+            output[1] = (byte)'M';
+            output[2] = (byte)'T';
+            output[3] = (byte)'A';
+            output[4] = 1;
+            output[5] = (byte)type;
+            output[6] = (byte)flags;
+            output[7] = (byte)shape.Length;
+            for (int axis = 0; axis < shape.Length; axis++)
+            {
+                uint extent = (uint)shape[axis];
+                for (int b = 0; b < 4; b++)
+                {
+                    output[8 + axis * 4 + b] = (byte)(extent >> (b * 8));
+                }
+            }
+        }
+
+        private static byte[] DecodeManaged(byte[] encoded, int offset, int size, int elementSize)
+        {
+            int flags = encoded[6];
+            byte[] payload = new byte[size];
+            if ((flags & FlagDeflate) != 0)
+            {
+                // Skip the zlib header; the checksum is left to the native decoder
+                if (encoded.Length < offset + 6)
+                {
+                    return null;
+                }
+                try
+                {
+                    using (var stream = new DeflateStream(new MemoryStream(encoded, offset + 2, encoded.Length - offset - 2),
+                        CompressionMode.Decompress))
+                    {
+                        int read = 0;
+                        while (read < size)
+                        {
+                            int n = stream.Read(payload, read, size - read);
+                            if (n <= 0)
+                            {
+                                return null;
+                            }
+                            read += n;
+                        }
+                    }
+                }
+                catch (InvalidDataException)
+                {
+                    return null;
+                }
+            }
+            else if (encoded.Length - offset == size)
+            {
+                Buffer.BlockCopy(encoded, offset, payload, 0, size);
+            }
+            else
+            {
+                return null;
+            }
+
+            int count = size / elementSize;
+            if ((flags & FlagShuffle) != 0)
+            {
+                var unshuffled = new byte[size];
+                for (int b = 0; b < elementSize; b++)
+                {
+                    for (int i = 0; i < count; i++)
+                    {
+                        unshuffled[i * elementSize + b] = payload[b * count + i];
+                    }
+                }
+                payload = unshuffled;
+            }
+
+            if ((flags & FlagDelta) != 0)
+            {
+                // Wrapping sums at the element's width, little-endian
+                for (int i = 1; i < count; i++)
+                {
+                    int carry = 0;
+                    for (int b = 0; b < elementSize; b++)
+                    {
+                        int sum = payload[i * elementSize + b] + payload[(i - 1) * elementSize + b] + carry;
+                        payload[i * elementSize + b] = (byte)sum;
+                        carry = sum >> 8;
+                    }
+                }
+            }
+            return payload;
+        }
+    }
+}
@@ -0,0 +1,296 @@
+using System;
+using System.Runtime.InteropServices;
+using UnityEngine;
+
+namespace UnixxtyMCP.Editor.Core
+{
+    /// <summary>
+    /// How <see cref="NativeImage"/> writes a capture.
+    /// </summary>
+    internal struct ImageEncoding
+    {
+        /// <summary>
+        /// JPEG quality used when none is given.
+        /// </summary>
+        public const int DefaultJpegQuality = 75;
+
+        /// <summary>
+        /// True for a baseline JPEG, false for PNG.
+        /// </summary>
+        public bool Jpeg;
+
+        /// <summary>
+        /// JPEG quality (1-100); ignored for PNG.
+        /// </summary>
+        public int Quality;
+
+        /// <summary>
+        /// Writes a single luma channel instead of color.
+        /// </summary>
+        public bool Grayscale;
+
+        /// <summary>
+        /// Lossless RGB(A) PNG, the default.
+        /// </summary>
+        public static ImageEncoding Png => default;
+
+        public string MimeType => Jpeg ? "image/jpeg" : "image/png";
+
+        public string Extension => Jpeg ? ".jpg" : ".png";
+
+        /// <summary>
+        /// Builds an encoding from tool parameters.
+        /// </summary>
+        /// <param name="format">"png" or "jpeg" ("jpg" is accepted); null for PNG.</param>
+        /// <param name="quality">JPEG quality, or 0 or less for the default.</param>
+        /// <param name="grayscale">Whether to drop color.</param>
+        public static ImageEncoding FromParameters(string format, int quality, bool grayscale)
+        {
+            string normalized = format?.Trim().ToLowerInvariant();
+            return new ImageEncoding
+            {
+                Jpeg = normalized == "jpeg" || normalized == "jpg",
+                Quality = quality > 0 ? Mathf.Clamp(quality, 1, 100) : DefaultJpegQuality,
+                Grayscale = grayscale
+            };
+        }
+    }
+
+    /// <summary>
+    /// Encodes textures to PNG or JPEG on the native proxy's worker threads.
+    ///
+    /// The main thread only reads the pixels back and hands them over; downscaling,
+    /// filtering and compression run in the background. The returned <see cref="ImageJob"/>
+    /// can be attached to a response with <see cref="Base64Payload.Inline(ImageJob)"/>
+    /// without waiting for it. With an outdated native plugin it falls back to a GPU blit
+    /// and EncodeToPNG / EncodeToJPG.
+    /// </summary>
+    internal static class NativeImage
+    {
+        /// <summary>
+        /// zlib-style compression level used for captures.
+        /// </summary>
+        public const int DefaultLevel = 6;
+
+        private const int EncodeJpeg = 1;
+        private const int EncodeGrayscale = 2;
+
+        #region P/Invoke Declarations
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int EncodeImageAsync(Color32[] pixels, int width, int height, int stride,
+            int targetWidth, int targetHeight, int quality, int flags);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern int WaitPngJob(int job, int timeoutMs);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern int GetPngJobSize(int job);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern int CopyPngJobResult(int job, byte[] output, int capacity);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void ReleasePngJob(int job);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr AttachPngJobPayload(int job);
+
+        #endregion
+
+        private static bool s_unavailable = false;
+
+        /// <summary>
+        /// Starts encoding a readable texture as PNG.
+        /// </summary>
+        /// <param name="texture">Texture whose CPU-side pixels to encode.</param>
+        /// <param name="topRowFirst">True if the pixel data is stored top row first
+        /// (render textures read back from the Game View); Unity textures are bottom-up.</param>
+        /// <returns>The encoding job.</returns>
+        public static ImageJob Encode(Texture2D texture, bool topRowFirst = false)
+        {
+            return Encode(texture, ImageEncoding.Png, 0, 0, topRowFirst);
+        }
+
+        /// <summary>
+        /// Starts encoding a readable texture, downscaling it first if a target size is given.
+        /// </summary>
+        /// <param name="texture">Texture whose CPU-side pixels to encode.</param>
+        /// <param name="encoding">Output format.</param>
+        /// <param name="targetWidth">Output width, or 0 for the texture's.</param>
+        /// <param name="targetHeight">Output height, or 0 for the texture's.</param>
+        /// <param name="topRowFirst">True if the pixel data is stored top row first.</param>
+        /// <returns>The encoding job.</returns>
+        public static ImageJob Encode(Texture2D texture, ImageEncoding encoding, int targetWidth, int targetHeight,
+            bool topRowFirst = false)
+        {
+            int width = texture.width;
+            int height = texture.height;
+            if (targetWidth <= 0) targetWidth = width;
+            if (targetHeight <= 0) targetHeight = height;
+            Color32[] pixels = texture.GetPixels32();
+
+            if (!s_unavailable)
+            {
+                try
+                {
+                    int flags = (encoding.Jpeg ? EncodeJpeg : 0) | (encoding.Grayscale ? EncodeGrayscale : 0);
+                    int handle = EncodeImageAsync(pixels, width, height, topRowFirst ? width * 4 : -width * 4,
+                        targetWidth, targetHeight, encoding.Jpeg ? encoding.Quality : DefaultLevel, flags);
+                    if (handle != 0)
+                    {
+                        return new ImageJob(handle, encoding.MimeType);
+                    }
+                }
+                catch (Exception ex) when (ex is EntryPointNotFoundException || ex is DllNotFoundException)
+                {
+                    // Outdated or missing native plugin
+                    s_unavailable = true;
+                    if (MCPProxy.VerboseLogging) Debug.Log("[NativeImage] Native image encoder unavailable; using EncodeToPNG/EncodeToJPG");
+                }
+            }
+
+            return EncodeManaged(texture, pixels, encoding, targetWidth, targetHeight, topRowFirst);
+        }
+
+        private static ImageJob EncodeManaged(Texture2D texture, Color32[] pixels, ImageEncoding encoding,
+            int targetWidth, int targetHeight, bool topRowFirst)
+        {
+            int width = texture.width;
+            int height = texture.height;
+            if (topRowFirst)
+            {
+                var flipped = new Color32[pixels.Length];
+                for (int y = 0; y < height; y++)
+                {
+                    Array.Copy(pixels, (height - 1 - y) * width, flipped, y * width, width);
+                }
+                texture.SetPixels32(flipped);
+                texture.Apply();
+            }
+
+            Texture2D output = texture;
+            if (targetWidth != width || targetHeight != height)
+            {
+                var rt = RenderTexture.GetTemporary(targetWidth, targetHeight, 0, RenderTextureFormat.ARGB32);
+                Graphics.Blit(texture, rt);
+                var previous = RenderTexture.active;
+                RenderTexture.active = rt;
+                output = new Texture2D(targetWidth, targetHeight, TextureFormat.RGBA32, false);
+                output.ReadPixels(new Rect(0, 0, targetWidth, targetHeight), 0, 0);
+                output.Apply();
+                RenderTexture.active = previous;
+                RenderTexture.ReleaseTemporary(rt);
+            }
+
+            if (encoding.Grayscale)
+            {
+                Color32[] colors = output.GetPixels32();
+                for (int i = 0; i < colors.Length; i++)
+                {
+                    var c = colors[i];
+                    byte luma = (byte)((c.r * 19595 + c.g * 38470 + c.b * 7471 + 32768) >> 16);
+                    colors[i] = new Color32(luma, luma, luma, c.a);
+                }
+                output.SetPixels32(colors);
+                output.Apply();
+            }
+
+            byte[] bytes = encoding.Jpeg ? output.EncodeToJPG(encoding.Quality) : output.EncodeToPNG();
+            if (output != texture)
+            {
+                UnityEngine.Object.DestroyImmediate(output);
+            }
+            return new ImageJob(bytes, encoding.MimeType);
+        }
+    }
+
+    /// <summary>
+    /// An image being encoded by <see cref="NativeImage"/>, or already encoded bytes.
+    /// </summary>
+    internal sealed class ImageJob : IDisposable
+    {
+        private int _handle;
+        private byte[] _bytes;
+
+        internal ImageJob(int handle, string mimeType = "image/png")
+        {
+            _handle = handle;
+            MimeType = mimeType;
+        }
+
+        internal ImageJob(byte[] bytes, string mimeType = "image/png")
+        {
+            _bytes = bytes;
+            MimeType = mimeType;
+        }
+
+        ~ImageJob()
+        {
+            Release();
+        }
+
+        /// <summary>
+        /// Gets the Content-Type of the encoded image.
+        /// </summary>
+        public string MimeType { get; }
+
+        /// <summary>
+        /// Gets the size of the image in bytes, waiting for the encoder if needed.
+        /// </summary>
+        public int Size => ToArray()?.Length ?? 0;
+
+        /// <summary>
+        /// Gets the encoded bytes, waiting for the encoder if needed.
+        /// </summary>
+        /// <returns>The file, or null if encoding failed.</returns>
+        public byte[] ToArray()
+        {
+            if (_bytes == null && _handle != 0)
+            {
+                NativeImage.WaitPngJob(_handle, -1);
+                int size = NativeImage.GetPngJobSize(_handle);
+                if (size >= 0)
+                {
+                    var bytes = new byte[size];
+                    if (NativeImage.CopyPngJobResult(_handle, bytes, size) == size)
+                    {
+                        _bytes = bytes;
+                    }
+                }
+                Release();
+            }
+            return _bytes;
+        }
+
+        /// <summary>
+        /// Attaches the image to the current proxy response without waiting for it.
+        /// </summary>
+        /// <returns>The payload token, or null if the job is no longer native.</returns>
+        internal string TryAttach()
+        {
+            if (_handle == 0)
+            {
+                return null;
+            }
+
+            IntPtr ptr = NativeImage.AttachPngJobPayload(_handle);
+            return ptr == IntPtr.Zero ? null : Marshal.PtrToStringAnsi(ptr);
+        }
+
+        public void Dispose()
+        {
+            Release();
+            GC.SuppressFinalize(this);
+        }
+
+        private void Release()
+        {
+            if (_handle != 0)
+            {
+                NativeImage.ReleasePngJob(_handle);
+                _handle = 0;
+            }
+        }
+    }
+}
@@ -0,0 +1,224 @@
+using System;
+using System.Runtime.InteropServices;
+using UnityEngine;
+
+namespace UnixxtyMCP.Editor.Core
+{
+    /// <summary>
+    /// Pixel kernels for texture tools, run by the native proxy on all cores.
+    ///
+    /// Pixels are raw RGBA8 (4 bytes) or RGBAHalf (8 bytes) per pixel, as returned by
+    /// <see cref="Texture2D.GetRawTextureData()"/>; only the first pixelCount pixels are
+    /// used, so arrays holding a whole mip chain can be passed as they are. With an
+    /// outdated native plugin every kernel falls back to a managed loop on the main thread.
+    /// </summary>
+    internal static class NativeTexture
+    {
+        /// <summary>
+        /// Histogram bins per channel.
+        /// </summary>
+        public const int HistogramBins = 256;
+
+        private const int FilterBox = 0;
+        private const int FilterLanczos = 1;
+
+        #region P/Invoke Declarations
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int TextureHalfToRgba8(byte[] half, byte[] rgba, int pixelCount);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int TextureRgba8ToHalf(byte[] rgba, byte[] half, int pixelCount);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int TexturePackChannels(byte[] red, byte[] green, byte[] blue, byte[] alpha,
+            int[] channels, byte[] rgba, int pixelCount);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int TexturePremultiply(byte[] rgba, int pixelCount);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int TextureResize(byte[] rgba, int width, int height, byte[] output,
+            int targetWidth, int targetHeight, int filter);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int TextureHistogram(byte[] rgba, int pixelCount, int[] histogram);
+
+        #endregion
+
+        private static bool s_unavailable = false;
+
+        /// <summary>
+        /// Converts RGBAHalf pixels to RGBA8, clamping to [0, 1].
+        /// </summary>
+        public static byte[] HalfToRgba8(byte[] half, int pixelCount)
+        {
+            var rgba = new byte[pixelCount * 4];
+            if (TryNative(() => TextureHalfToRgba8(half, rgba, pixelCount)))
+            {
+                return rgba;
+            }
+
+            for (int i = 0; i < rgba.Length; i++)
+            {
+                float value = Mathf.HalfToFloat((ushort)(half[i * 2] | (half[i * 2 + 1] << 8)));
+                rgba[i] = (byte)(Mathf.Clamp01(float.IsNaN(value) ? 1f : value) * 255f + 0.5f);
+            }
+            return rgba;
+        }
+
+        /// <summary>
+        /// Converts RGBA8 pixels to RGBAHalf.
+        /// </summary>
+        public static byte[] Rgba8ToHalf(byte[] rgba, int pixelCount)
+        {
+            var half = new byte[pixelCount * 8];
+            if (TryNative(() => TextureRgba8ToHalf(rgba, half, pixelCount)))
+            {
+                return half;
+            }
+
+            var table = new ushort[256];
+            for (int i = 0; i < table.Length; i++)
+            {
+                table[i] = Mathf.FloatToHalf(i / 255f);
+            }
+            for (int i = 0; i < pixelCount * 4; i++)
+            {
+                ushort value = table[rgba[i]];
+                half[i * 2] = (byte)value;
+                half[i * 2 + 1] = (byte)(value >> 8);
+            }
+            return half;
+        }
+
+        /// <summary>
+        /// Builds RGBA8 pixels from one channel of up to four same-sized RGBA8 images.
+        /// </summary>
+        /// <param name="sources">Four sources (red, green, blue, alpha); null for a constant.</param>
+        /// <param name="channels">For each source, the channel to take (0-3, RGBA), or the
+        /// constant (0-255) if the source is null.</param>
+        /// <param name="pixelCount">Number of pixels.</param>
+        public static byte[] PackChannels(byte[][] sources, int[] channels, int pixelCount)
+        {
+            var rgba = new byte[pixelCount * 4];
+            if (TryNative(() => TexturePackChannels(sources[0], sources[1], sources[2], sources[3], channels, rgba, pixelCount)))
+            {
+                return rgba;
+            }
+
+            for (int c = 0; c < 4; c++)
+            {
+                byte[] source = sources[c];
+                for (int i = 0; i < pixelCount; i++)
+                {
+                    rgba[i * 4 + c] = source != null ? source[i * 4 + channels[c]] : (byte)channels[c];
+                }
+            }
+            return rgba;
+        }
+
+        /// <summary>
+        /// Multiplies the color channels of RGBA8 pixels by their alpha, in place.
+        /// </summary>
+        public static void Premultiply(byte[] rgba, int pixelCount)
+        {
+            if (TryNative(() => TexturePremultiply(rgba, pixelCount)))
+            {
+                return;
+            }
+
+            for (int i = 0; i < pixelCount * 4; i += 4)
+            {
+                int alpha = rgba[i + 3];
+                for (int c = 0; c < 3; c++)
+                {
+                    int product = rgba[i + c] * alpha + 128;
+                    rgba[i + c] = (byte)((product + (product >> 8)) >> 8);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Resizes RGBA8 pixels with a box (area average) or Lanczos-3 filter.
+        /// </summary>
+        /// <returns>The resized pixels, or null if the resize failed.</returns>
+        public static byte[] Resize(byte[] rgba, int width, int height, int targetWidth, int targetHeight, bool lanczos)
+        {
+            var output = new byte[targetWidth * targetHeight * 4];
+            if (TryNative(() => TextureResize(rgba, width, height, output, targetWidth, targetHeight,
+                    lanczos ? FilterLanczos : FilterBox)))
+            {
+                return output;
+            }
+            return s_unavailable ? ResizeManaged(rgba, width, height, targetWidth, targetHeight) : null;
+        }
+
+        /// <summary>
+        /// Counts the values of each channel of RGBA8 pixels.
+        /// </summary>
+        /// <returns><see cref="HistogramBins"/> counts for red, then green, blue and alpha.</returns>
+        public static int[] Histogram(byte[] rgba, int pixelCount)
+        {
+            var histogram = new int[HistogramBins * 4];
+            if (TryNative(() => TextureHistogram(rgba, pixelCount, histogram)))
+            {
+                return histogram;
+            }
+
+            Array.Clear(histogram, 0, histogram.Length);
+            for (int i = 0; i < pixelCount * 4; i++)
+            {
+                histogram[(i & 3) * HistogramBins + rgba[i]]++;
+            }
+            return histogram;
+        }
+
+        /// <summary>
+        /// Runs a kernel unless the native plugin is known to lack it.
+        /// </summary>
+        /// <returns>True if the kernel ran and succeeded.</returns>
+        private static bool TryNative(Func<int> kernel)
+        {
+            if (s_unavailable)
+            {
+                return false;
+            }
+
+            try
+            {
+                return kernel() == 0;
+            }
+            catch (Exception ex) when (ex is EntryPointNotFoundException || ex is DllNotFoundException)
+            {
+                // Outdated or missing native plugin
+                s_unavailable = true;
+                if (MCPProxy.VerboseLogging) Debug.Log("[NativeTexture] Native texture kernels unavailable; using managed loops");
+                return false;
+            }
+        }
+
+        private static byte[] ResizeManaged(byte[] rgba, int width, int height, int targetWidth, int targetHeight)
+        {
+            var source = new Texture2D(width, height, TextureFormat.RGBA32, false, true);
+            source.LoadRawTextureData(rgba);
+            source.Apply(false);
+
+            var rt = RenderTexture.GetTemporary(targetWidth, targetHeight, 0, RenderTextureFormat.ARGB32,
+                RenderTextureReadWrite.Linear);
+            Graphics.Blit(source, rt);
+            var previous = RenderTexture.active;
+            RenderTexture.active = rt;
+            var output = new Texture2D(targetWidth, targetHeight, TextureFormat.RGBA32, false, true);
+            output.ReadPixels(new Rect(0, 0, targetWidth, targetHeight), 0, 0);
+            output.Apply(false);
+            RenderTexture.active = previous;
+            RenderTexture.ReleaseTemporary(rt);
+
+            byte[] result = output.GetRawTextureData();
+            UnityEngine.Object.DestroyImmediate(source);
+            UnityEngine.Object.DestroyImmediate(output);
+            return result;
+        }
+    }
+}
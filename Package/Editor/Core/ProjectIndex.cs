@@ -0,0 +1,161 @@
+using System;
+using System.IO;
+using System.Runtime.InteropServices;
+using System.Text;
+using Newtonsoft.Json.Linq;
+using UnityEditor;
+using UnityEditor.PackageManager;
+using UnityEngine;
+
+namespace UnixxtyMCP.Editor.Core
+{
+    /// <summary>
+    /// Project indexes kept by the native proxy.
+    ///
+    /// The proxy walks Assets/ and Packages/ on its worker threads and answers methods such as
+    /// <c>search/files</c>, <c>assets/resolve</c> (GUIDs, paths and FindAssets-style filters
+    /// from the .meta files), <c>assets/references</c> (the assets mentioning a GUID),
+    /// <c>scenes/hierarchy</c>, <c>scenes/find</c> and <c>scenes/object</c> (the contents of
+    /// scene and prefab files, without opening them) and <c>code/symbols</c> and
+    /// <c>code/definition</c> (C# declarations and usages, read from source) itself, so they
+    /// keep working while scripts compile or the domain reloads. This class tells it where the project is, where local
+    /// ("file:") packages live and which paths to leave out. The proxy also watches these files and publishes changes
+    /// (GetFileChanges, the <c>files/changes</c> method and the <c>GET /events</c> stream), and follows the
+    /// editor log, so <c>console/read</c> and <c>console://errors</c> still answer while scripts compile.
+    /// </summary>
+    internal static class ProjectIndex
+    {
+        #region P/Invoke Declarations
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ConfigureProjectRoot([MarshalAs(UnmanagedType.LPStr)] string path);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ConfigureProjectExcludes([MarshalAs(UnmanagedType.LPStr)] string patterns);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ConfigureProjectPackages([MarshalAs(UnmanagedType.LPStr)] string mounts);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ConfigureEditorLog([MarshalAs(UnmanagedType.LPStr)] string path);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr GetSearchIndexStats();
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr GetAssetIndexStats();
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr GetReferenceIndexStats();
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr GetSceneCacheStats();
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr GetSymbolIndexStats();
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr GetEditorLogStats();
+
+        #endregion
+
+        private const string ExcludesPrefKey = "UnixxtyMCP_IndexExcludes";
+
+        private static bool s_unavailable = false;
+
+        /// <summary>
+        /// Project-relative globs the native indexes skip, separated by ';'
+        /// (e.g. "Assets/ThirdParty;Assets/**.bytes").
+        /// </summary>
+        public static string Excludes
+        {
+            get => EditorPrefs.GetString(ExcludesPrefKey, "");
+            set
+            {
+                EditorPrefs.SetString(ExcludesPrefKey, value ?? "");
+                Configure();
+            }
+        }
+
+        /// <summary>
+        /// Points the proxy at this project. The indexes are rebuilt in the background only
+        /// when the root, the local packages or the excludes change, so calling this after a
+        /// domain reload is cheap.
+        /// </summary>
+        public static void Configure()
+        {
+            if (s_unavailable)
+            {
+                return;
+            }
+
+            try
+            {
+                string root = Path.GetFullPath(Path.Combine(Application.dataPath, ".."));
+                ConfigureProjectExcludes(Excludes);
+                ConfigureProjectPackages(GetLocalPackageMounts());
+                ConfigureProjectRoot(root.Replace("\\", "/"));
+                ConfigureEditorLog(string.IsNullOrEmpty(Application.consoleLogPath) ? "" : Application.consoleLogPath.Replace("\\", "/"));
+            }
+            catch (EntryPointNotFoundException)
+            {
+                // Outdated native plugin without project indexes, package mounts or the editor log tailer
+                s_unavailable = true;
+                if (MCPProxy.VerboseLogging)
+                {
+                    Debug.Log("[ProjectIndex] Native project indexes not available");
+                }
+            }
+        }
+
+        /// <summary>
+        /// Gets the statistics of each native index (search, assets, references, scenes, symbols)
+        /// and of the editor log tailer, keyed by those names. Empty if the native plugin is outdated.
+        /// </summary>
+        public static JObject GetStats()
+        {
+            var stats = new JObject();
+            if (s_unavailable)
+            {
+                return stats;
+            }
+
+            try
+            {
+                stats["search"] = ReadStats(GetSearchIndexStats());
+                stats["assets"] = ReadStats(GetAssetIndexStats());
+                stats["references"] = ReadStats(GetReferenceIndexStats());
+                stats["scenes"] = ReadStats(GetSceneCacheStats());
+                stats["symbols"] = ReadStats(GetSymbolIndexStats());
+                stats["editorLog"] = ReadStats(GetEditorLogStats());
+            }
+            catch (EntryPointNotFoundException)
+            {
+                // Outdated native plugin; report the indexes it does have
+            }
+            return stats;
+        }
+
+        private static JToken ReadStats(IntPtr ptr)
+        {
+            return ptr == IntPtr.Zero ? new JObject() : JToken.Parse(Marshal.PtrToStringAnsi(ptr));
+        }
+
+        /// <summary>
+        /// "Packages/&lt;name&gt;=&lt;folder&gt;" lines for the packages Unity resolves from local
+        /// folders outside the project; embedded packages are already under Packages/.
+        /// </summary>
+        private static string GetLocalPackageMounts()
+        {
+            var mounts = new StringBuilder();
+            foreach (var package in UnityEditor.PackageManager.PackageInfo.GetAllRegisteredPackages())
+            {
+                if (package.source == PackageSource.Local && !string.IsNullOrEmpty(package.resolvedPath))
+                {
+                    mounts.Append(package.assetPath).Append('=').Append(package.resolvedPath.Replace("\\", "/")).Append('\n');
+                }
+            }
+            return mounts.ToString();
+        }
+    }
+}
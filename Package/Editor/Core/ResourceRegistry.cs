@@ -152,6 +152,15 @@ namespace UnixxtyMCP.Editor.Core
             return _resources.Values.Select(resourceInfo => resourceInfo.ToDefinition());
         }
 
+        /// <summary>
+        /// Gets all registered resources, static and parameterized.
+        /// </summary>
+        internal static IEnumerable<ResourceInfo> GetResourceInfos()
+        {
+            EnsureInitialized();
+            return _resources.Values.Concat(_parameterizedResources).ToList();
+        }
+
         /// <summary>
         /// Gets resource template definitions for the MCP resources/templates/list response.
         /// Only includes parameterized URI templates (e.g., "scene://gameobject/{id}").
@@ -261,6 +270,7 @@ namespace UnixxtyMCP.Editor.Core
         public string Uri => _attribute.Uri;
         public string Description => _attribute.Description;
         public bool IsParameterized => _isParameterized;
+        public CacheEpoch CacheEpochs => _attribute.CacheEpochs;
 
         public ResourceInfo(MCPResourceAttribute attribute, MethodInfo method)
         {
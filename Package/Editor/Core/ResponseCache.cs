@@ -0,0 +1,274 @@
+using System;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
+using UnityEditor;
+using UnityEditor.Compilation;
+using UnityEditor.SceneManagement;
+using UnityEngine;
+
+namespace UnixxtyMCP.Editor.Core
+{
+    /// <summary>
+    /// Configures the native response cache and keeps its invalidation epochs in sync
+    /// with editor change events.
+    ///
+    /// Read-only tools and resources that declare <see cref="CacheEpoch"/> dependencies are
+    /// answered by the proxy on its server thread, without waiting for the next editor update,
+    /// until one of those epochs is bumped. Any tools/call that is not read-only invalidates
+    /// the whole cache natively, so only changes made outside MCP need to be reported here.
+    /// </summary>
+    internal static class ResponseCache
+    {
+        /// <summary>
+        /// Memory budget for cached responses in the native plugin.
+        /// </summary>
+        private const int BudgetBytes = 16 * 1024 * 1024;
+
+        #region P/Invoke Declarations
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ConfigureResponseCache(int budgetBytes, int ttlMs);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void RegisterCacheableRequest(
+            [MarshalAs(UnmanagedType.LPStr)] string method,
+            [MarshalAs(UnmanagedType.LPStr)] string name,
+            [MarshalAs(UnmanagedType.LPStr)] string epochs);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void BumpCacheEpoch([MarshalAs(UnmanagedType.LPStr)] string name);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ResetResponseCache();
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr GetResponseCacheStats();
+
+        #endregion
+
+        private static bool s_active = false;
+
+        /// <summary>
+        /// Gets whether the native cache was configured for this domain.
+        /// </summary>
+        public static bool IsActive => s_active;
+
+        /// <summary>
+        /// Gets or sets whether the response cache is enabled.
+        /// </summary>
+        public static bool Enabled
+        {
+            get => EditorPrefs.GetBool("UnixxtyMCP_ResponseCache", true);
+            set => EditorPrefs.SetBool("UnixxtyMCP_ResponseCache", value);
+        }
+
+        /// <summary>
+        /// Registers cacheable tools and resources with the proxy and subscribes to the
+        /// editor events that invalidate them. Called by MCPProxy after the server starts.
+        /// </summary>
+        public static void Initialize()
+        {
+            if (s_active)
+            {
+                return;
+            }
+
+            try
+            {
+                // Entries from the previous domain may describe tools that no longer exist
+                ResetResponseCache();
+                ConfigureResponseCache(Enabled ? BudgetBytes : 0, 0);
+                int cached = RegisterRequests();
+
+                Subscribe();
+                s_active = true;
+
+                if (MCPProxy.VerboseLogging) Debug.Log($"[ResponseCache] Registered {cached} cacheable requests");
+            }
+            catch (EntryPointNotFoundException)
+            {
+                // Outdated native plugin without cache support: every request goes to C#
+                if (MCPProxy.VerboseLogging) Debug.Log("[ResponseCache] Native plugin has no response cache; skipping");
+            }
+        }
+
+        /// <summary>
+        /// Unsubscribes from editor events and invalidates everything cached.
+        /// </summary>
+        public static void Shutdown()
+        {
+            if (!s_active)
+            {
+                return;
+            }
+
+            Unsubscribe();
+            s_active = false;
+
+            try
+            {
+                BumpCacheEpoch("*");
+            }
+            catch (Exception exception)
+            {
+                Debug.LogWarning($"[ResponseCache] Error invalidating cache: {exception.Message}");
+            }
+        }
+
+        /// <summary>
+        /// Invalidates cached results that depend on the given editor state.
+        /// Safe to call from any thread.
+        /// </summary>
+        public static void Invalidate(CacheEpoch epochs)
+        {
+            if (!s_active)
+            {
+                return;
+            }
+
+            foreach (string name in GetEpochNames(epochs))
+            {
+                BumpCacheEpoch(name);
+            }
+        }
+
+        /// <summary>
+        /// Gets cache statistics (entries, bytes, hits, misses, evictions) as JSON.
+        /// </summary>
+        public static string GetStats()
+        {
+            try
+            {
+                IntPtr ptr = GetResponseCacheStats();
+                return ptr == IntPtr.Zero ? "{}" : Marshal.PtrToStringAnsi(ptr);
+            }
+            catch (Exception)
+            {
+                return "{}";
+            }
+        }
+
+        private static int RegisterRequests()
+        {
+            int cached = 0;
+
+            foreach (var tool in ToolRegistry.GetToolInfos())
+            {
+                if (!tool.ReadOnly)
+                {
+                    continue;
+                }
+
+                // Read-only tools without epochs are never cached, but must not invalidate the cache either
+                string epochs = ToEpochList(tool.CacheEpochs);
+                RegisterCacheableRequest("tools/call", tool.Name, epochs);
+                if (epochs != null) cached++;
+            }
+
+            foreach (var resource in ResourceRegistry.GetResourceInfos())
+            {
+                string epochs = ToEpochList(resource.CacheEpochs);
+                if (epochs == null)
+                {
+                    continue;
+                }
+
+                string uri = resource.Uri;
+                if (resource.IsParameterized)
+                {
+                    // Match concrete URIs by the prefix before the first template parameter
+                    uri = uri.Substring(0, uri.IndexOf('{')) + "*";
+                }
+                RegisterCacheableRequest("resources/read", uri, epochs);
+                cached++;
+            }
+
+            // Listings only change across domain reloads, which reset the cache
+            RegisterCacheableRequest("tools/list", null, "editor");
+            RegisterCacheableRequest("resources/list", null, "editor");
+            RegisterCacheableRequest("resources/templates/list", null, "editor");
+            RegisterCacheableRequest("prompts/list", null, "editor");
+
+            return cached + 4;
+        }
+
+        private static void Subscribe()
+        {
+            EditorApplication.hierarchyChanged += OnSceneChanged;
+            ObjectChangeEvents.changesPublished += OnObjectChangesPublished;
+            Undo.undoRedoPerformed += OnSceneChanged;
+            EditorSceneManager.sceneOpened += OnSceneOpened;
+            EditorSceneManager.sceneClosed += OnSceneClosed;
+            EditorSceneManager.sceneSaved += OnSceneSaved;
+            EditorApplication.projectChanged += OnProjectChanged;
+            EditorBuildSettings.sceneListChanged += OnProjectChanged;
+            Application.logMessageReceivedThreaded += OnLogMessage;
+            Selection.selectionChanged += OnSelectionChanged;
+            EditorApplication.playModeStateChanged += OnPlayModeStateChanged;
+            EditorApplication.pauseStateChanged += OnPauseStateChanged;
+            CompilationPipeline.compilationStarted += OnCompilation;
+            CompilationPipeline.compilationFinished += OnCompilation;
+            EditorApplication.update += OnUpdate;
+        }
+
+        private static void Unsubscribe()
+        {
+            EditorApplication.hierarchyChanged -= OnSceneChanged;
+            ObjectChangeEvents.changesPublished -= OnObjectChangesPublished;
+            Undo.undoRedoPerformed -= OnSceneChanged;
+            EditorSceneManager.sceneOpened -= OnSceneOpened;
+            EditorSceneManager.sceneClosed -= OnSceneClosed;
+            EditorSceneManager.sceneSaved -= OnSceneSaved;
+            EditorApplication.projectChanged -= OnProjectChanged;
+            EditorBuildSettings.sceneListChanged -= OnProjectChanged;
+            Application.logMessageReceivedThreaded -= OnLogMessage;
+            Selection.selectionChanged -= OnSelectionChanged;
+            EditorApplication.playModeStateChanged -= OnPlayModeStateChanged;
+            EditorApplication.pauseStateChanged -= OnPauseStateChanged;
+            CompilationPipeline.compilationStarted -= OnCompilation;
+            CompilationPipeline.compilationFinished -= OnCompilation;
+            EditorApplication.update -= OnUpdate;
+        }
+
+        private static void OnSceneChanged() => Invalidate(CacheEpoch.Scene);
+        private static void OnObjectChangesPublished(ref ObjectChangeEventStream stream) => Invalidate(CacheEpoch.Scene);
+        private static void OnSceneOpened(UnityEngine.SceneManagement.Scene scene, OpenSceneMode mode) => Invalidate(CacheEpoch.Scene);
+        private static void OnSceneClosed(UnityEngine.SceneManagement.Scene scene) => Invalidate(CacheEpoch.Scene);
+        private static void OnSceneSaved(UnityEngine.SceneManagement.Scene scene) => Invalidate(CacheEpoch.Scene | CacheEpoch.Assets);
+        private static void OnProjectChanged() => Invalidate(CacheEpoch.Assets);
+        private static void OnLogMessage(string message, string stackTrace, LogType type) => Invalidate(CacheEpoch.Console);
+        private static void OnSelectionChanged() => Invalidate(CacheEpoch.Selection);
+        private static void OnPlayModeStateChanged(PlayModeStateChange change) => Invalidate(CacheEpoch.Scene | CacheEpoch.Selection | CacheEpoch.Editor);
+        private static void OnPauseStateChanged(PauseState state) => Invalidate(CacheEpoch.Editor);
+        private static void OnCompilation(object context) => Invalidate(CacheEpoch.Assets | CacheEpoch.Editor);
+
+        /// <summary>
+        /// In play mode, scripts move objects every frame without raising hierarchy events.
+        /// </summary>
+        private static void OnUpdate()
+        {
+            if (EditorApplication.isPlaying && !EditorApplication.isPaused)
+            {
+                Invalidate(CacheEpoch.Scene);
+            }
+        }
+
+        private static IEnumerable<string> GetEpochNames(CacheEpoch epochs)
+        {
+            if ((epochs & CacheEpoch.Scene) != 0) yield return "scene";
+            if ((epochs & CacheEpoch.Assets) != 0) yield return "assets";
+            if ((epochs & CacheEpoch.Console) != 0) yield return "console";
+            if ((epochs & CacheEpoch.Selection) != 0) yield return "selection";
+            if ((epochs & CacheEpoch.Editor) != 0) yield return "editor";
+        }
+
+        /// <summary>
+        /// Converts epoch flags to the comma-separated list the native plugin expects,
+        /// or null when the request should not be cached.
+        /// </summary>
+        private static string ToEpochList(CacheEpoch epochs)
+        {
+            return epochs == CacheEpoch.None ? null : string.Join(",", GetEpochNames(epochs));
+        }
+    }
+}
@@ -0,0 +1,121 @@
+using System;
+using System.IO;
+using System.Runtime.InteropServices;
+using UnityEngine;
+
+namespace UnixxtyMCP.Editor.Core
+{
+    /// <summary>
+    /// Files clients upload with multipart <c>POST /upload</c> for file_import.
+    ///
+    /// The proxy receives the whole upload first (bodies over 256KB are streamed to a spill
+    /// file as they arrive), then copies each file part to Temp/UnixxtyMCP/Staging and
+    /// answers with an upload id; file_import resolves the id to the staged file here and
+    /// drops it once imported. Uploads the client never imports expire in the proxy.
+    /// </summary>
+    internal static class StagedUploads
+    {
+        #region P/Invoke Declarations
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ConfigureStagingDirectory([MarshalAs(UnmanagedType.LPStr)] string path);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr GetStagedUpload([MarshalAs(UnmanagedType.LPStr)] string id);
+
+        [DllImport(MCPProxy.DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void DropStagedUpload([MarshalAs(UnmanagedType.LPStr)] string id);
+
+        #endregion
+
+        private static bool s_unavailable = false;
+
+        /// <summary>
+        /// Points the proxy at the staging directory. Leftover files are deleted unless the
+        /// server survived a domain reload and still tracks them.
+        /// </summary>
+        /// <param name="serverSurvived">Whether the native server was already running.</param>
+        public static void Configure(bool serverSurvived)
+        {
+            try
+            {
+                string directory = Path.GetFullPath(Path.Combine(Application.dataPath, "..", "Temp", "UnixxtyMCP", "Staging"));
+                Directory.CreateDirectory(directory);
+                if (!serverSurvived)
+                {
+                    foreach (string stale in Directory.GetFiles(directory))
+                    {
+                        File.Delete(stale);
+                    }
+                }
+                ConfigureStagingDirectory(directory.Replace("\\", "/"));
+            }
+            catch (EntryPointNotFoundException)
+            {
+                // Outdated native plugin without POST /upload
+                s_unavailable = true;
+            }
+            catch (Exception exception)
+            {
+                Debug.LogWarning($"[StagedUploads] Staging directory unavailable: {exception.Message}");
+            }
+        }
+
+        /// <summary>
+        /// Finds the staged file of an upload.
+        /// </summary>
+        /// <param name="id">Upload id from the POST /upload reply.</param>
+        /// <param name="path">Path of the staged file.</param>
+        /// <param name="fileName">Filename the client sent.</param>
+        /// <returns>False if the id is unknown or expired.</returns>
+        public static bool TryResolve(string id, out string path, out string fileName)
+        {
+            path = null;
+            fileName = null;
+            if (s_unavailable || string.IsNullOrEmpty(id) || !MCPProxy.IsInitialized)
+            {
+                return false;
+            }
+
+            try
+            {
+                IntPtr ptr = GetStagedUpload(id);
+                if (ptr == IntPtr.Zero)
+                {
+                    return false;
+                }
+                path = Marshal.PtrToStringAnsi(ptr);
+            }
+            catch (EntryPointNotFoundException)
+            {
+                s_unavailable = true;
+                return false;
+            }
+
+            // Staged as "<id>_<filename>"
+            string stagedName = Path.GetFileName(path);
+            fileName = stagedName.Length > id.Length + 1 ? stagedName.Substring(id.Length + 1) : stagedName;
+            return File.Exists(path);
+        }
+
+        /// <summary>
+        /// Deletes a staged upload.
+        /// </summary>
+        public static void Drop(string id)
+        {
+            if (s_unavailable || string.IsNullOrEmpty(id) || !MCPProxy.IsInitialized)
+            {
+                return;
+            }
+
+            try
+            {
+                DropStagedUpload(id);
+            }
+            catch (EntryPointNotFoundException)
+            {
+                s_unavailable = true;
+            }
+        }
+    }
+}
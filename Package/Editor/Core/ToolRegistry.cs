@@ -120,6 +120,19 @@ namespace UnixxtyMCP.Editor.Core
             return snapshot.Select(toolInfo => toolInfo.ToDefinition());
         }
 
+        /// <summary>
+        /// Gets a snapshot of the registered tools, for components that need
+        /// attribute metadata beyond the MCP definition (e.g. the response cache).
+        /// </summary>
+        internal static List<ToolInfo> GetToolInfos()
+        {
+            EnsureInitialized();
+            lock (_lock)
+            {
+                return _tools.Values.ToList();
+            }
+        }
+
         /// <summary>
         /// Gets a specific tool definition by name.
         /// </summary>
@@ -280,6 +293,8 @@ namespace UnixxtyMCP.Editor.Core
         public string Name => _attribute.Name;
         public string Description => _attribute.Description;
         public string Category => _attribute.Category;
+        public bool ReadOnly => _attribute.ReadOnlyHint;
+        public CacheEpoch CacheEpochs => _attribute.CacheEpochs;
 
         public ToolInfo(MCPToolAttribute attribute, MethodInfo method)
         {
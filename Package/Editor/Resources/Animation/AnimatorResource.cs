@@ -16,7 +16,7 @@ namespace UnixxtyMCP.Editor.Resources.Animation
         /// </summary>
         /// <param name="assetPath">The asset path of the AnimatorController.</param>
         /// <returns>Object containing layers, parameters, and state machine structure.</returns>
-        [MCPResource("animation://controller/{path}", "AnimatorController details including layers, parameters, and state machines")]
+        [MCPResource("animation://controller/{path}", "AnimatorController details including layers, parameters, and state machines", CacheEpochs = CacheEpoch.Assets)]
         public static object GetAnimatorController([MCPParam("path", "Asset path of the AnimatorController (e.g., Assets/Animations/Player.controller)")] string assetPath)
         {
             if (string.IsNullOrEmpty(assetPath))
@@ -16,7 +16,7 @@ namespace UnixxtyMCP.Editor.Resources.Asset
         /// </summary>
         /// <param name="assetPath">The asset path relative to the project (e.g., "Assets/Scripts/MyScript.cs").</param>
         /// <returns>Object containing dependency information.</returns>
-        [MCPResource("assets://dependencies/{path}", "Asset dependencies - what an asset uses and what uses it")]
+        [MCPResource("assets://dependencies/{path}", "Asset dependencies - what an asset uses and what uses it", CacheEpochs = CacheEpoch.Assets)]
         public static object GetAssetDependencies([MCPParam("path", "Asset path relative to project (e.g., Assets/Scripts/MyScript.cs)")] string assetPath)
         {
             if (string.IsNullOrEmpty(assetPath))
@@ -15,7 +15,7 @@ namespace UnixxtyMCP.Editor.Resources.Console
         /// Uses reflection to access internal Unity LogEntries API.
         /// </summary>
         /// <returns>Object containing detailed error and warning information.</returns>
-        [MCPResource("console://errors", "Detailed compilation/runtime errors with file paths and line numbers")]
+        [MCPResource("console://errors", "Detailed compilation/runtime errors with file paths and line numbers", CacheEpochs = CacheEpoch.Console)]
         public static object GetConsoleErrors()
         {
             var errors = new List<object>();
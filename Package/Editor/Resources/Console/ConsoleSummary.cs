@@ -14,7 +14,7 @@ namespace UnixxtyMCP.Editor.Resources.Console
         /// Uses reflection to access internal Unity console log entry counts.
         /// </summary>
         /// <returns>Object containing error, warning, and info counts.</returns>
-        [MCPResource("console://summary", "Quick error/warning/info counts from the console")]
+        [MCPResource("console://summary", "Quick error/warning/info counts from the console", CacheEpochs = CacheEpoch.Console)]
         public static object GetConsoleSummary()
         {
             int errorCount = 0;
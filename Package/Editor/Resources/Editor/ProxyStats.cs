@@ -0,0 +1,30 @@
+using Newtonsoft.Json.Linq;
+using UnixxtyMCP.Editor.Core;
+
+namespace UnixxtyMCP.Editor.Resources.Editor
+{
+    /// <summary>
+    /// Resource provider for the native proxy's statistics.
+    /// </summary>
+    public static class ProxyStats
+    {
+        /// <summary>
+        /// Gets the statistics of the response cache, the blob table, the project indexes,
+        /// the editor log tailer and the proxy's memory pools.
+        /// </summary>
+        /// <returns>Object with one JSON object per proxy component.</returns>
+        [MCPResource("editor://proxy", "Native proxy statistics (response cache, blobs, project indexes, editor log, memory)")]
+        public static object GetProxyStats()
+        {
+            return new JObject
+            {
+                ["running"] = MCPProxy.IsInitialized,
+                ["port"] = MCPProxy.ActivePort,
+                ["responseCache"] = JToken.Parse(ResponseCache.GetStats()),
+                ["blobs"] = JToken.Parse(BlobStore.GetStats()),
+                ["indexes"] = ProjectIndex.GetStats(),
+                ["memory"] = JToken.Parse(MCPProxy.GetMemoryStats())
+            };
+        }
+    }
+}
@@ -13,7 +13,7 @@ namespace UnixxtyMCP.Editor.Resources.Editor
         /// Gets information about the currently selected objects in the editor.
         /// </summary>
         /// <returns>Object containing selection information.</returns>
-        [MCPResource("editor://selection", "Currently selected objects in the editor")]
+        [MCPResource("editor://selection", "Currently selected objects in the editor", CacheEpochs = CacheEpoch.Selection)]
         public static object GetSelection()
         {
             var selectedGameObjects = Selection.gameObjects;
@@ -12,7 +12,7 @@ namespace UnixxtyMCP.Editor.Resources.Package
         /// Gets a list of all installed packages in the project.
         /// </summary>
         /// <returns>Object containing installed package information.</returns>
-        [MCPResource("packages://installed", "List of installed packages and their versions")]
+        [MCPResource("packages://installed", "List of installed packages and their versions", CacheEpochs = CacheEpoch.Assets)]
         public static object GetInstalledPackages()
         {
             // Use the synchronous search for packages
@@ -14,7 +14,7 @@ namespace UnixxtyMCP.Editor.Resources.Project
         /// Gets all layers defined in the project with their indices.
         /// </summary>
         /// <returns>Object containing layer information.</returns>
-        [MCPResource("project://layers", "Project layers and their indices")]
+        [MCPResource("project://layers", "Project layers and their indices", CacheEpochs = CacheEpoch.Assets)]
         public static object Get()
         {
             // Get all non-empty layers
@@ -12,7 +12,7 @@ namespace UnixxtyMCP.Editor.Resources.Project
         /// Gets information about the current Unity project.
         /// </summary>
         /// <returns>Object containing project path, name, and Unity version.</returns>
-        [MCPResource("project://info", "Project path, name, and Unity version")]
+        [MCPResource("project://info", "Project path, name, and Unity version", CacheEpochs = CacheEpoch.Assets)]
         public static object Get()
         {
             // Application.dataPath returns the Assets folder path
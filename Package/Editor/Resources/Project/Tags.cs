@@ -12,7 +12,7 @@ namespace UnixxtyMCP.Editor.Resources.Project
         /// Gets all tags defined in the project.
         /// </summary>
         /// <returns>Object containing tag information.</returns>
-        [MCPResource("project://tags", "Project tags")]
+        [MCPResource("project://tags", "Project tags", CacheEpochs = CacheEpoch.Assets)]
         public static object Get()
         {
             // Get all tags defined in the project
@@ -19,7 +19,7 @@ namespace UnixxtyMCP.Editor.Resources.Scene
         /// </summary>
         /// <param name="instanceId">The instance ID of the GameObject.</param>
         /// <returns>Object containing GameObject details or error information.</returns>
-        [MCPResource("scene://gameobject/{id}", "GameObject details by instance ID")]
+        [MCPResource("scene://gameobject/{id}", "GameObject details by instance ID", CacheEpochs = CacheEpoch.Scene)]
         public static object GetGameObject([MCPParam("id", "Instance ID of the GameObject")] int instanceId)
         {
             var unityObject = EditorUtility.InstanceIDToObject(instanceId);
@@ -50,7 +50,7 @@ namespace UnixxtyMCP.Editor.Resources.Scene
         /// </summary>
         /// <param name="instanceId">The instance ID of the GameObject.</param>
         /// <returns>Object containing component list or error information.</returns>
-        [MCPResource("scene://gameobject/{id}/components", "List of components on a GameObject")]
+        [MCPResource("scene://gameobject/{id}/components", "List of components on a GameObject", CacheEpochs = CacheEpoch.Scene)]
         public static object GetGameObjectComponents([MCPParam("id", "Instance ID of the GameObject")] int instanceId)
         {
             var unityObject = EditorUtility.InstanceIDToObject(instanceId);
@@ -114,7 +114,7 @@ namespace UnixxtyMCP.Editor.Resources.Scene
         /// <param name="instanceId">The instance ID of the GameObject.</param>
         /// <param name="componentType">The type name of the component.</param>
         /// <returns>Object containing component details or error information.</returns>
-        [MCPResource("scene://gameobject/{id}/component/{type}", "Specific component details on a GameObject")]
+        [MCPResource("scene://gameobject/{id}/component/{type}", "Specific component details on a GameObject", CacheEpochs = CacheEpoch.Scene)]
         public static object GetGameObjectComponent(
             [MCPParam("id", "Instance ID of the GameObject")] int instanceId,
             [MCPParam("type", "Type name of the component")] string componentType)
@@ -13,7 +13,7 @@ namespace UnixxtyMCP.Editor.Resources.Scene
         /// Gets information about all currently loaded scenes in the editor.
         /// </summary>
         /// <returns>Object containing loaded scene information.</returns>
-        [MCPResource("scene://loaded", "All currently loaded scenes and their status")]
+        [MCPResource("scene://loaded", "All currently loaded scenes and their status", CacheEpochs = CacheEpoch.Scene)]
         public static object GetLoadedScenes()
         {
             int sceneCount = SceneManager.sceneCount;
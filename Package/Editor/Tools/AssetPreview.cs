@@ -14,7 +14,7 @@ namespace UnixxtyMCP.Editor.Tools
     /// </summary>
     public static class AssetPreviewTool
     {
-        [MCPTool("asset_preview", "Get asset preview thumbnails as base64 PNG. Works with prefabs, materials, textures, models, sprites, and more.", Category = "Asset")]
+        [MCPTool("asset_preview", "Get asset preview thumbnails as base64 PNG (or blob URLs when the request sets _meta.blobUrls). Works with prefabs, materials, textures, models, sprites, and more.", Category = "Asset")]
         public static object Execute(
             [MCPParam("action", "Action: get (single asset preview), batch (multiple asset previews)", required: true,
                 Enum = new[] { "get", "batch" })] string action,
@@ -51,7 +51,8 @@ namespace UnixxtyMCP.Editor.Tools
             if (asset == null)
                 throw MCPException.InvalidParams($"Asset not found: '{assetPath}'");
 
-            string base64 = CapturePreview(asset, width, height);
+            var png = CapturePreview(asset, width, height);
+            string blobUrl = BlobStore.TryPublish(png);
             string assetType = asset.GetType().Name;
 
             return new
@@ -59,11 +60,12 @@ namespace UnixxtyMCP.Editor.Tools
                 success = true,
                 assetPath,
                 assetType,
-                hasPreview = base64 != null,
+                hasPreview = png != null,
                 width,
                 height,
-                base64_png = base64,
-                message = base64 != null
+                base64_png = blobUrl == null ? Base64Payload.Inline(png) : null,
+                blob_url = blobUrl,
+                message = png != null
                     ? $"Preview captured for {assetType} '{asset.name}'"
                     : $"No preview available for {assetType} '{asset.name}'. Asset may need to be loaded first."
             };
@@ -89,16 +91,18 @@ namespace UnixxtyMCP.Editor.Tools
                     continue;
                 }
 
-                string base64 = CapturePreview(asset, width, height);
+                var png = CapturePreview(asset, width, height);
+                string blobUrl = BlobStore.TryPublish(png);
                 results.Add(new
                 {
                     assetPath = path,
-                    success = base64 != null,
+                    success = png != null,
                     assetType = asset.GetType().Name,
-                    base64_png = base64
+                    base64_png = blobUrl == null ? Base64Payload.Inline(png) : null,
+                    blob_url = blobUrl
                 });
 
-                if (base64 != null) successCount++;
+                if (png != null) successCount++;
             }
 
             return new
@@ -110,7 +114,7 @@ namespace UnixxtyMCP.Editor.Tools
             };
         }
 
-        private static string CapturePreview(UnityEngine.Object asset, int width, int height)
+        private static ImageJob CapturePreview(UnityEngine.Object asset, int width, int height)
         {
             // For Texture2D assets, we can directly encode
             if (asset is Texture2D tex2d)
@@ -141,7 +145,7 @@ namespace UnixxtyMCP.Editor.Tools
             return null;
         }
 
-        private static string EncodeTexture(Texture2D source, int targetWidth, int targetHeight)
+        private static ImageJob EncodeTexture(Texture2D source, int targetWidth, int targetHeight)
         {
             if (source == null) return null;
 
@@ -161,10 +165,10 @@ namespace UnixxtyMCP.Editor.Tools
                 RenderTexture.active = previous;
                 RenderTexture.ReleaseTemporary(rt);
 
-                byte[] pngData = readable.EncodeToPNG();
+                var png = NativeImage.Encode(readable);
                 UnityEngine.Object.DestroyImmediate(readable);
 
-                return pngData != null ? Convert.ToBase64String(pngData) : null;
+                return png;
             }
             catch
             {
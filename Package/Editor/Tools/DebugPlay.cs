@@ -27,12 +27,15 @@ namespace UnixxtyMCP.Editor.Tools
             [MCPParam("capture_screenshot", "Take screenshot on completion (default: true)")] bool captureScreenshot = true,
             [MCPParam("capture_console", "Return console output (default: true)")] bool captureConsole = true,
             [MCPParam("inspect_objects", "Comma-separated list of GameObject paths to inspect (e.g. 'Player,Main Camera')")] string inspectObjects = null,
-            [MCPParam("auto_stop", "Exit play mode when done (default: false)")] bool autoStop = false)
+            [MCPParam("auto_stop", "Exit play mode when done (default: false)")] bool autoStop = false,
+            [MCPParam("screenshot_delta_session", "Frame delta session for the screenshot: only the 32x32 tiles changed since that session's previous " +
+                "capture are returned, as with vision_capture's delta_session")] string screenshotDeltaSession = null)
         {
             switch (action.ToLower())
             {
                 case "start":
-                    return StartDebugSession(waitSeconds, waitForLog, captureScreenshot, captureConsole, inspectObjects, autoStop);
+                    return StartDebugSession(waitSeconds, waitForLog, captureScreenshot, captureConsole, inspectObjects, autoStop,
+                        screenshotDeltaSession);
                 case "get_status":
                     return GetStatus(jobId);
                 case "stop":
@@ -43,12 +46,13 @@ namespace UnixxtyMCP.Editor.Tools
         }
 
         private static object StartDebugSession(float waitSeconds, string waitForLog,
-            bool captureScreenshot, bool captureConsole, string inspectObjects, bool autoStop)
+            bool captureScreenshot, bool captureConsole, string inspectObjects, bool autoStop, string screenshotDeltaSession)
         {
             // If already in play mode, capture immediately
             if (EditorApplication.isPlaying)
             {
-                var job = DebugPlayJobManager.StartJob(waitSeconds, waitForLog, captureScreenshot, captureConsole, inspectObjects, autoStop);
+                var job = DebugPlayJobManager.StartJob(waitSeconds, waitForLog, captureScreenshot, captureConsole, inspectObjects, autoStop,
+                screenshotDeltaSession);
                 if (job == null)
                     return new { success = false, error = "A debug session is already running." };
 
@@ -68,7 +72,8 @@ namespace UnixxtyMCP.Editor.Tools
             if (EditorApplication.isCompiling)
                 return new { success = false, error = "Cannot enter play mode while compiling." };
 
-            var newJob = DebugPlayJobManager.StartJob(waitSeconds, waitForLog, captureScreenshot, captureConsole, inspectObjects, autoStop);
+            var newJob = DebugPlayJobManager.StartJob(waitSeconds, waitForLog, captureScreenshot, captureConsole, inspectObjects, autoStop,
+                screenshotDeltaSession);
             if (newJob == null)
                 return new { success = false, error = "A debug session is already running." };
 
@@ -145,10 +150,19 @@ namespace UnixxtyMCP.Editor.Tools
                     int w = 640, h = 480;
 
                     // Primary: Game View composited capture (includes UITK panels)
-                    if (GameViewCapture.TryCaptureComposited(w, h,
-                            out byte[] compositedPng, out int cw, out int ch, out string _))
+                    if (job.screenshotDeltaSession != null &&
+                        GameViewCapture.TryCaptureCompositedDelta(job.screenshotDeltaSession, w, h, false,
+                            out FrameDeltaCapture delta, out string _) && delta != null)
                     {
-                        job.screenshotBase64 = Convert.ToBase64String(compositedPng);
+                        job.screenshotDelta = delta;
+                        job.screenshotPng = delta.Image;
+                        job.screenshotWidth = delta.Width;
+                        job.screenshotHeight = delta.Height;
+                    }
+                    else if (GameViewCapture.TryCaptureComposited(w, h,
+                            out ImageJob compositedPng, out int cw, out int ch, out string _))
+                    {
+                        job.screenshotPng = compositedPng;
                         job.screenshotWidth = cw;
                         job.screenshotHeight = ch;
                     }
@@ -173,8 +187,10 @@ namespace UnixxtyMCP.Editor.Tools
                             tex.Apply();
                             RenderTexture.active = prevActive;
 
-                            byte[] png = tex.EncodeToPNG();
-                            job.screenshotBase64 = Convert.ToBase64String(png);
+                            job.screenshotDelta = job.screenshotDeltaSession != null
+                                ? FrameDelta.Diff(job.screenshotDeltaSession, tex, 0, 0, topRowFirst: false, forceKeyframe: false)
+                                : null;
+                            job.screenshotPng = job.screenshotDelta != null ? job.screenshotDelta.Image : NativeImage.Encode(tex);
                             job.screenshotWidth = w;
                             job.screenshotHeight = h;
 
@@ -235,14 +251,31 @@ namespace UnixxtyMCP.Editor.Tools
 
             if (job.status == DebugPlayStatus.Completed)
             {
-                if (job.screenshotBase64 != null)
+                if (job.screenshotPng != null || job.screenshotDelta != null)
                 {
-                    result["screenshot"] = new
+                    var screenshot = new Dictionary<string, object>
                     {
-                        width = job.screenshotWidth,
-                        height = job.screenshotHeight,
-                        base64 = job.screenshotBase64
+                        ["width"] = job.screenshotWidth,
+                        ["height"] = job.screenshotHeight
                     };
+                    if (job.screenshotDelta != null)
+                        screenshot["delta"] = job.screenshotDelta.Describe();
+
+                    if (job.screenshotPng == null)
+                    {
+                        // Delta with no changed tile
+                        screenshot["unchanged"] = true;
+                    }
+                    else
+                    {
+                        // Encoded when the result is read, since only that request knows whether the client takes blob URLs
+                        string blobUrl = BlobStore.TryPublish(job.screenshotPng);
+                        if (blobUrl != null)
+                            screenshot["blob_url"] = blobUrl;
+                        else
+                            screenshot["base64"] = Base64Payload.Inline(job.screenshotPng);
+                    }
+                    result["screenshot"] = screenshot;
                 }
                 if (job.screenshotError != null)
                     result["screenshot_error"] = job.screenshotError;
@@ -442,9 +475,11 @@ namespace UnixxtyMCP.Editor.Tools
         public bool captureConsole;
         public string inspectObjectPaths;
         public bool autoStop;
+        public string screenshotDeltaSession;
 
         // Results (non-serialized to SessionState due to size - held in memory)
-        [NonSerialized] public string screenshotBase64;
+        [NonSerialized] public ImageJob screenshotPng;
+        [NonSerialized] public FrameDeltaCapture screenshotDelta;
         [NonSerialized] public int screenshotWidth;
         [NonSerialized] public int screenshotHeight;
         [NonSerialized] public string screenshotError;
@@ -470,7 +505,8 @@ namespace UnixxtyMCP.Editor.Tools
         public static DebugPlayJob CurrentJob => _currentJob;
 
         public static DebugPlayJob StartJob(float waitSeconds, string waitForLog,
-            bool captureScreenshot, bool captureConsole, string inspectObjects, bool autoStop)
+            bool captureScreenshot, bool captureConsole, string inspectObjects, bool autoStop,
+            string screenshotDeltaSession = null)
         {
             EnsureInitialized();
 
@@ -494,7 +530,8 @@ namespace UnixxtyMCP.Editor.Tools
                 captureScreenshot = captureScreenshot,
                 captureConsole = captureConsole,
                 inspectObjectPaths = inspectObjects,
-                autoStop = autoStop
+                autoStop = autoStop,
+                screenshotDeltaSession = string.IsNullOrEmpty(screenshotDeltaSession) ? null : screenshotDeltaSession
             };
 
             _storage.jobs.Add(_currentJob);
@@ -13,10 +13,10 @@ namespace UnixxtyMCP.Editor.Tools
     /// </summary>
     public static class FileImport
     {
-        [MCPTool("file_import", "Import external files into Unity project. Copies files from anywhere on disk into Assets/ and configures import settings.", Category = "Asset", DestructiveHint = true)]
+        [MCPTool("file_import", "Import external files into Unity project. Copies files from anywhere on disk, or a file uploaded with multipart POST /upload, into Assets/ and configures import settings.", Category = "Asset", DestructiveHint = true)]
         public static object Execute(
-            [MCPParam("source_path", "Absolute path to the source file on disk", required: true)] string sourcePath,
             [MCPParam("destination", "Destination path relative to Assets/ (e.g., 'Textures/player.png'). If a folder, filename is preserved.", required: true)] string destination,
+            [MCPParam("source_path", "Absolute path to the source file on disk (or use upload_id)")] string sourcePath = null,
             [MCPParam("overwrite", "Overwrite if destination exists (default: false)")] bool overwrite = false,
             [MCPParam("texture_type", "For textures: Default, NormalMap, Sprite, Editor GUI, Cursor, Cookie, Lightmap, SingleChannel")] string textureType = null,
             [MCPParam("texture_max_size", "For textures: max size (32-16384)")] int? textureMaxSize = null,
@@ -25,13 +25,26 @@ namespace UnixxtyMCP.Editor.Tools
             [MCPParam("model_scale_factor", "For models: scale factor (default: 1)")] float? modelScaleFactor = null,
             [MCPParam("model_import_materials", "For models: import materials")] bool? modelImportMaterials = null,
             [MCPParam("audio_force_mono", "For audio: force to mono")] bool? audioForceMono = null,
-            [MCPParam("audio_load_in_background", "For audio: load in background")] bool? audioLoadInBackground = null)
+            [MCPParam("audio_load_in_background", "For audio: load in background")] bool? audioLoadInBackground = null,
+            [MCPParam("upload_id", "Id of a file uploaded with multipart POST /upload, instead of source_path")] string uploadId = null)
         {
             // Validate source
-            if (string.IsNullOrEmpty(sourcePath))
-                throw MCPException.InvalidParams("source_path is required.");
-            if (!File.Exists(sourcePath))
-                throw MCPException.InvalidParams($"Source file not found: '{sourcePath}'");
+            string sourceName;
+            if (!string.IsNullOrEmpty(uploadId))
+            {
+                if (!string.IsNullOrEmpty(sourcePath))
+                    throw MCPException.InvalidParams("Pass either source_path or upload_id, not both.");
+                if (!StagedUploads.TryResolve(uploadId, out sourcePath, out sourceName))
+                    throw MCPException.InvalidParams($"Upload not found or expired: '{uploadId}'");
+            }
+            else
+            {
+                if (string.IsNullOrEmpty(sourcePath))
+                    throw MCPException.InvalidParams("source_path or upload_id is required.");
+                if (!File.Exists(sourcePath))
+                    throw MCPException.InvalidParams($"Source file not found: '{sourcePath}'");
+                sourceName = Path.GetFileName(sourcePath);
+            }
 
             // Build destination path
             if (string.IsNullOrEmpty(destination))
@@ -43,7 +56,7 @@ namespace UnixxtyMCP.Editor.Tools
 
             // If destination is a directory path (ends with / or existing dir), append filename
             if (assetPath.EndsWith("/") || assetPath.EndsWith("\\"))
-                assetPath += Path.GetFileName(sourcePath);
+                assetPath += sourceName;
 
             // Normalize path separators
             assetPath = assetPath.Replace('\\', '/');
@@ -64,6 +77,8 @@ namespace UnixxtyMCP.Editor.Tools
             {
                 // Copy file
                 File.Copy(sourcePath, fullDestPath, overwrite);
+                if (!string.IsNullOrEmpty(uploadId))
+                    StagedUploads.Drop(uploadId);
 
                 // Import into Unity
                 AssetDatabase.ImportAsset(assetPath, ImportAssetOptions.ForceUpdate);
@@ -89,7 +104,7 @@ namespace UnixxtyMCP.Editor.Tools
                     fileSize = fileInfo.Length,
                     fileType = GetFileCategory(extension),
                     importSettings = importerSettings.Count > 0 ? importerSettings : null,
-                    message = $"Imported '{Path.GetFileName(sourcePath)}' to '{assetPath}'"
+                    message = $"Imported '{sourceName}' to '{assetPath}'"
                 };
             }
             catch (MCPException) { throw; }
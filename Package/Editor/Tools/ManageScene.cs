@@ -346,7 +346,7 @@ namespace UnixxtyMCP.Editor.Tools
         /// <summary>
         /// Gets information about the currently active scene.
         /// </summary>
-        [MCPTool("scene_get_active", "Gets information about the currently active scene", Category = "Scene", ReadOnlyHint = true)]
+        [MCPTool("scene_get_active", "Gets information about the currently active scene", Category = "Scene", ReadOnlyHint = true, CacheEpochs = CacheEpoch.Scene)]
         public static object GetActiveScene()
         {
             try
@@ -407,15 +407,19 @@ namespace UnixxtyMCP.Editor.Tools
         [MCPTool("scene_get_hierarchy",
             "Gets the hierarchy of GameObjects in the current scene. " +
             "For deep/complex hierarchies (imported 3D models), use compact=true and lower max_depth to avoid oversized responses. " +
-            "Use parent parameter to drill into specific subtrees.",
-            Category = "Scene", ReadOnlyHint = true)]
+            "Use parent parameter to drill into specific subtrees. " +
+            "When polling after edits, pass since_version from the previous response to receive only added/removed/changed nodes " +
+            "(changed nodes list removed properties under removedProperties).",
+            Category = "Scene", ReadOnlyHint = true, CacheEpochs = CacheEpoch.Scene)]
         public static object GetHierarchy(
             [MCPParam("parent", "Instance ID or name of parent GameObject to list children of (null for roots)")] string parent = null,
             [MCPParam("max_depth", "Maximum depth to traverse (default: 1, just immediate children)", Minimum = 1)] int maxDepth = 1,
             [MCPParam("include_transform", "Include transform data in results")] bool includeTransform = false,
             [MCPParam("compact", "Compact mode: only name, instanceID, childCount, and children. Use for deep/large hierarchies to avoid response size limits.")] bool compact = false,
             [MCPParam("page_size", "Maximum number of items to return (default: 50, max: 500)", Minimum = 1, Maximum = 500)] int pageSize = 50,
-            [MCPParam("cursor", "Starting index for pagination (default: 0)", Minimum = 0)] int cursor = 0)
+            [MCPParam("cursor", "Starting index for pagination (default: 0)", Minimum = 0)] int cursor = 0,
+            [MCPParam("since_version", "Version from a previous response. Returns a diff (added, removed, changed nodes) against it, " +
+                "or a full snapshot if that version is no longer kept. Pass 0 to get a full snapshot with a version.", Minimum = 0)] long sinceVersion = -1)
         {
             try
             {
@@ -505,6 +509,53 @@ namespace UnixxtyMCP.Editor.Tools
                 bool truncated = endIndex < total;
                 int? nextCursor = truncated ? endIndex : (int?)null;
 
+                if (sinceVersion >= 0)
+                {
+                    // Versions are per query shape, so the same page of the same scene is compared
+                    string queryKey = $"scene_get_hierarchy|{activeScene.handle}|{(parentGameObject != null ? parentGameObject.GetInstanceID() : 0)}|" +
+                        $"{resolvedMaxDepth}|{includeTransform}|{compact}|{resolvedCursor}|{resolvedPageSize}";
+                    var delta = SnapshotStore.Record(queryKey, items, "instanceID", sinceVersion);
+
+                    if (delta.isDelta)
+                    {
+                        return new
+                        {
+                            success = true,
+                            sceneName = activeScene.name,
+                            scope,
+                            cursor = resolvedCursor,
+                            pageSize = resolvedPageSize,
+                            nextCursor,
+                            truncated,
+                            total,
+                            version = delta.version,
+                            baseVersion = sinceVersion,
+                            delta = true,
+                            added = delta.added,
+                            removed = delta.removed,
+                            changed = delta.changed
+                        };
+                    }
+
+                    return new
+                    {
+                        success = true,
+                        sceneName = activeScene.name,
+                        scope,
+                        cursor = resolvedCursor,
+                        pageSize = resolvedPageSize,
+                        nextCursor,
+                        truncated,
+                        total,
+                        version = delta.version,
+                        delta = false,
+                        note = sinceVersion > 0
+                            ? $"Version {sinceVersion} is no longer available; returned a full snapshot."
+                            : null,
+                        items
+                    };
+                }
+
                 return new
                 {
                     success = true,
@@ -537,18 +588,22 @@ namespace UnixxtyMCP.Editor.Tools
         /// </summary>
         [MCPTool("scene_screenshot",
             "Captures a screenshot of the Game View and saves to Assets/Screenshots/. " +
-            "Returns synchronously with file path and size. " +
+            "Returns synchronously with file path and size. format=jpeg writes a much smaller .jpg. " +
             "Note: Canvas/uGUI elements (ScreenSpaceOverlay) are only visible during Play Mode. " +
             "UI Toolkit panels may also require Play Mode to render. " +
             "For inline base64 (direct AI vision analysis) or Scene View capture, use vision_capture instead.",
             Category = "Scene", DestructiveHint = true)]
         public static object CaptureScreenshot(
             [MCPParam("filename", "Filename for the screenshot (without extension)")] string filename = null,
-            [MCPParam("super_size", "Multiplier for resolution (1-4, default: 1)", Minimum = 1, Maximum = 4)] int superSize = 1)
+            [MCPParam("super_size", "Multiplier for resolution (1-4, default: 1)", Minimum = 1, Maximum = 4)] int superSize = 1,
+            [MCPParam("format", "Image format: png (lossless) or jpeg (default: png)",
+                Enum = new[] { "png", "jpeg" })] string format = "png",
+            [MCPParam("quality", "JPEG quality 1-100 (default: 75)", Minimum = 1, Maximum = 100)] int quality = ImageEncoding.DefaultJpegQuality)
         {
             try
             {
                 int resolvedSuperSize = Mathf.Clamp(superSize, 1, 4);
+                var encoding = ImageEncoding.FromParameters(format, quality, false);
 
                 string screenshotFileName = string.IsNullOrEmpty(filename)
                     ? $"Screenshot_{DateTime.Now:yyyy-MM-dd_HH-mm-ss}"
@@ -559,14 +614,7 @@ namespace UnixxtyMCP.Editor.Tools
                     Directory.CreateDirectory(screenshotsFolder);
 
                 string basePath = Path.Combine(screenshotsFolder, screenshotFileName);
-                string finalPath = basePath + ".png";
-                int counter = 1;
-                while (File.Exists(finalPath))
-                {
-                    finalPath = $"{basePath}_{counter}.png";
-                    counter++;
-                }
-
+                string finalPath = UniqueScreenshotPath(basePath, encoding.Extension);
                 string relativePath = "Assets/Screenshots/" + Path.GetFileName(finalPath);
 
                 // Get Game View size for resolution
@@ -592,10 +640,11 @@ namespace UnixxtyMCP.Editor.Tools
                 int captureHeight = baseHeight * resolvedSuperSize;
 
                 // Primary: Game View composited capture (includes UITK panels)
-                if (GameViewCapture.TryCaptureComposited(captureWidth, captureHeight,
-                        out byte[] compositedPng, out int cw, out int ch, out string _diag))
+                if (GameViewCapture.TryCaptureComposited(captureWidth, captureHeight, encoding,
+                        out ImageJob compositedImage, out int cw, out int ch, out string _diag) &&
+                    compositedImage.ToArray() is byte[] composited)
                 {
-                    File.WriteAllBytes(finalPath, compositedPng);
+                    File.WriteAllBytes(finalPath, composited);
                     AssetDatabase.ImportAsset(relativePath, ImportAssetOptions.ForceSynchronousImport);
 
                     return new
@@ -606,7 +655,7 @@ namespace UnixxtyMCP.Editor.Tools
                         fullPath = finalPath,
                         width = cw,
                         height = ch,
-                        file_size_bytes = compositedPng.Length,
+                        file_size_bytes = composited.Length,
                         superSize = resolvedSuperSize,
                         capture_method = "gameview_composited"
                     };
@@ -632,11 +681,11 @@ namespace UnixxtyMCP.Editor.Tools
                     tex.Apply();
                     RenderTexture.active = prevActive;
 
-                    byte[] png = tex.EncodeToPNG();
+                    byte[] image = NativeImage.Encode(tex, encoding, 0, 0).ToArray();
                     UnityEngine.Object.DestroyImmediate(tex);
                     UnityEngine.Object.DestroyImmediate(rt);
 
-                    File.WriteAllBytes(finalPath, png);
+                    File.WriteAllBytes(finalPath, image);
                     AssetDatabase.ImportAsset(relativePath, ImportAssetOptions.ForceSynchronousImport);
 
                     return new
@@ -647,13 +696,18 @@ namespace UnixxtyMCP.Editor.Tools
                         fullPath = finalPath,
                         width = captureWidth,
                         height = captureHeight,
-                        file_size_bytes = png.Length,
+                        file_size_bytes = image.Length,
                         superSize = resolvedSuperSize,
                         capture_method = "camera_render"
                     };
                 }
 
-                // Fallback: no camera available, use ScreenCapture (async)
+                // Fallback: no camera available, use ScreenCapture (async), which only writes PNG
+                if (encoding.Jpeg)
+                {
+                    finalPath = UniqueScreenshotPath(basePath, ".png");
+                    relativePath = "Assets/Screenshots/" + Path.GetFileName(finalPath);
+                }
                 if (!Application.isBatchMode)
                     EnsureGameView();
 
@@ -689,6 +743,18 @@ namespace UnixxtyMCP.Editor.Tools
             }
         }
 
+        private static string UniqueScreenshotPath(string basePath, string extension)
+        {
+            string path = basePath + extension;
+            int counter = 1;
+            while (File.Exists(path))
+            {
+                path = $"{basePath}_{counter}{extension}";
+                counter++;
+            }
+            return path;
+        }
+
         #endregion
 
         #region Helper Methods
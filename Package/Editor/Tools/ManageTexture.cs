@@ -4,20 +4,23 @@ using System.Linq;
 using System.Text.RegularExpressions;
 using UnityEditor;
 using UnityEngine;
+using UnityEngine.Experimental.Rendering;
 using UnixxtyMCP.Editor.Core;
 using UnixxtyMCP.Editor.Utilities;
 
 namespace UnixxtyMCP.Editor.Tools
 {
     /// <summary>
-    /// Tool for managing textures: get info, list, find, and modify import settings.
+    /// Tool for managing textures: get info, list, find, modify import settings, and process pixels.
+    /// Pixel work (statistics, resizing, channel packing, premultiplying) runs in the native
+    /// proxy's texture kernels on all cores.
     /// </summary>
     public static class ManageTexture
     {
         /// <summary>
-        /// Manages textures: get info, list, find, and modify import settings.
+        /// Manages textures: get info, list, find, modify import settings, and process pixels.
         /// </summary>
-        /// <param name="action">The action to perform: get, list, find, set_import_settings</param>
+        /// <param name="action">The action to perform: get, list, find, set_import_settings, stats, resize, premultiply, pack_channels, unpack_channel</param>
         /// <param name="texturePath">Asset path to texture file</param>
         /// <param name="folderPath">Folder to search in for list/find</param>
         /// <param name="searchPattern">Pattern for find action (name pattern, dimensions, or format)</param>
@@ -35,10 +38,20 @@ namespace UnixxtyMCP.Editor.Tools
         /// <param name="readable">Set read/write enabled</param>
         /// <param name="filterMode">Set filter mode (Point, Bilinear, Trilinear)</param>
         /// <param name="wrapMode">Set wrap mode (Repeat, Clamp, Mirror, MirrorOnce)</param>
+        /// <param name="width">Target width for resize</param>
+        /// <param name="height">Target height for resize</param>
+        /// <param name="filter">Resize filter (box, lanczos)</param>
+        /// <param name="outputPath">Image file to write for resize, premultiply, pack_channels, unpack_channel</param>
+        /// <param name="channel">Channel to extract for unpack_channel (r, g, b, a)</param>
+        /// <param name="redSource">Red channel source for pack_channels: texture path, "path:channel", or a 0-1 constant</param>
+        /// <param name="greenSource">Green channel source for pack_channels</param>
+        /// <param name="blueSource">Blue channel source for pack_channels</param>
+        /// <param name="alphaSource">Alpha channel source for pack_channels</param>
+        /// <param name="histogramBins">Histogram bins per channel for stats (0 to omit)</param>
         /// <returns>Result object indicating success or failure with appropriate data.</returns>
-        [MCPTool("manage_texture", "Manage textures: get info, list, find, modify import settings", Category = "Asset", DestructiveHint = true)]
+        [MCPTool("manage_texture", "Manage textures: get info, list, find, modify import settings, pixel statistics, resize, premultiply alpha, pack and unpack channels", Category = "Asset", DestructiveHint = true)]
         public static object Execute(
-            [MCPParam("action", "Action: get, list, find, set_import_settings", required: true, Enum = new[] { "get", "list", "find", "set_import_settings" })] string action,
+            [MCPParam("action", "Action: get, list, find, set_import_settings, stats, resize, premultiply, pack_channels, unpack_channel", required: true, Enum = new[] { "get", "list", "find", "set_import_settings", "stats", "resize", "premultiply", "pack_channels", "unpack_channel" })] string action,
             [MCPParam("texture_path", "Asset path to texture file")] string texturePath = null,
             [MCPParam("folder_path", "Folder to search in for list/find")] string folderPath = null,
             [MCPParam("search_pattern", "Pattern for find action")] string searchPattern = null,
@@ -55,7 +68,17 @@ namespace UnixxtyMCP.Editor.Tools
             [MCPParam("generate_mipmaps", "Generate mipmaps")] bool? generateMipmaps = null,
             [MCPParam("readable", "Read/Write enabled")] bool? readable = null,
             [MCPParam("filter_mode", "Filter mode: Point, Bilinear, Trilinear")] string filterMode = null,
-            [MCPParam("wrap_mode", "Wrap mode: Repeat, Clamp, Mirror, MirrorOnce")] string wrapMode = null)
+            [MCPParam("wrap_mode", "Wrap mode: Repeat, Clamp, Mirror, MirrorOnce")] string wrapMode = null,
+            [MCPParam("width", "Target width for resize (height alone keeps the aspect ratio)")] int? width = null,
+            [MCPParam("height", "Target height for resize (width alone keeps the aspect ratio)")] int? height = null,
+            [MCPParam("filter", "Resize filter: box, lanczos (default: lanczos)")] string filter = null,
+            [MCPParam("output_path", "Image file to write (.png, .jpg, .tga, .exr); defaults to '<name>_<suffix>.png' next to the texture, required for pack_channels")] string outputPath = null,
+            [MCPParam("channel", "Channel for unpack_channel: r, g, b, a")] string channel = null,
+            [MCPParam("red_source", "pack_channels red: texture path (same channel), 'path:a' for another channel, or a 0-1 constant")] string redSource = null,
+            [MCPParam("green_source", "pack_channels green: texture path, 'path:channel', or a 0-1 constant")] string greenSource = null,
+            [MCPParam("blue_source", "pack_channels blue: texture path, 'path:channel', or a 0-1 constant")] string blueSource = null,
+            [MCPParam("alpha_source", "pack_channels alpha: texture path, 'path:channel', or a 0-1 constant (default: 1)")] string alphaSource = null,
+            [MCPParam("histogram_bins", "Histogram bins per channel for stats: a divisor of 256, 0 to omit (default: 16)")] int histogramBins = 16)
         {
             if (string.IsNullOrWhiteSpace(action))
             {
@@ -72,7 +95,12 @@ namespace UnixxtyMCP.Editor.Tools
                     "list" => HandleList(folderPath),
                     "find" => HandleFind(searchPattern, searchType, folderPath, minWidth, maxWidth, minHeight, maxHeight, format),
                     "set_import_settings" => HandleSetImportSettings(texturePath, maxSize, textureType, compression, srgb, generateMipmaps, readable, filterMode, wrapMode),
-                    _ => throw MCPException.InvalidParams($"Unknown action: '{action}'. Valid actions: get, list, find, set_import_settings")
+                    "stats" => HandleStats(texturePath, histogramBins),
+                    "resize" => HandleResize(texturePath, width, height, filter, outputPath),
+                    "premultiply" => HandlePremultiply(texturePath, outputPath),
+                    "pack_channels" => HandlePackChannels(new[] { redSource, greenSource, blueSource, alphaSource }, outputPath),
+                    "unpack_channel" => HandleUnpackChannel(texturePath, channel, outputPath),
+                    _ => throw MCPException.InvalidParams($"Unknown action: '{action}'. Valid actions: get, list, find, set_import_settings, stats, resize, premultiply, pack_channels, unpack_channel")
                 };
             }
             catch (MCPException)
@@ -570,6 +598,219 @@ namespace UnixxtyMCP.Editor.Tools
             }
         }
 
+        /// <summary>
+        /// Computes per-channel statistics and histograms of a texture's pixels.
+        /// </summary>
+        private static object HandleStats(string texturePath, int histogramBins)
+        {
+            if (histogramBins < 0 || histogramBins > NativeTexture.HistogramBins ||
+                (histogramBins > 0 && NativeTexture.HistogramBins % histogramBins != 0))
+            {
+                throw MCPException.InvalidParams("'histogram_bins' must be 0 or a divisor of 256 (1, 2, 4, ..., 256).");
+            }
+
+            TexturePixels pixels = ReadTexturePixels(texturePath, out string error);
+            if (pixels == null)
+            {
+                return new { success = false, error };
+            }
+
+            int[] histogram = NativeTexture.Histogram(pixels.Rgba, pixels.PixelCount);
+            string[] channelNames = { "r", "g", "b", "a" };
+            var channels = new Dictionary<string, object>();
+            for (int c = 0; c < 4; c++)
+            {
+                channels[channelNames[c]] = BuildChannelStats(histogram, c * NativeTexture.HistogramBins, pixels.PixelCount, histogramBins);
+            }
+
+            int alphaOffset = 3 * NativeTexture.HistogramBins;
+            return new
+            {
+                success = true,
+                path = pixels.Path,
+                width = pixels.Width,
+                height = pixels.Height,
+                hdrClamped = pixels.Hdr,
+                valueRange = "0-255",
+                opaque = histogram[alphaOffset + 255] == pixels.PixelCount,
+                transparentPixels = histogram[alphaOffset],
+                channels
+            };
+        }
+
+        /// <summary>
+        /// Resizes a texture and writes the result to a new image file.
+        /// </summary>
+        private static object HandleResize(string texturePath, int? width, int? height, string filter, string outputPath)
+        {
+            if (!width.HasValue && !height.HasValue)
+            {
+                throw MCPException.InvalidParams("The 'width' or 'height' parameter is required for resize action.");
+            }
+            if ((width.HasValue && width.Value <= 0) || (height.HasValue && height.Value <= 0))
+            {
+                throw MCPException.InvalidParams("'width' and 'height' must be positive.");
+            }
+
+            string normalizedFilter = string.IsNullOrWhiteSpace(filter) ? "lanczos" : filter.Trim().ToLowerInvariant();
+            if (normalizedFilter != "lanczos" && normalizedFilter != "box")
+            {
+                throw MCPException.InvalidParams($"Invalid filter: '{filter}'. Valid values: box, lanczos");
+            }
+
+            TexturePixels pixels = ReadTexturePixels(texturePath, out string error);
+            if (pixels == null)
+            {
+                return new { success = false, error };
+            }
+
+            // A single dimension keeps the aspect ratio
+            int targetWidth = width ?? Math.Max(1, (int)Math.Round((double)pixels.Width * height.Value / pixels.Height));
+            int targetHeight = height ?? Math.Max(1, (int)Math.Round((double)pixels.Height * width.Value / pixels.Width));
+            if ((long)targetWidth * targetHeight > MaxOutputPixels)
+            {
+                throw MCPException.InvalidParams($"Output of {targetWidth}x{targetHeight} exceeds the 16384x16384 limit.");
+            }
+
+            byte[] resized = NativeTexture.Resize(pixels.Rgba, pixels.Width, pixels.Height, targetWidth, targetHeight,
+                normalizedFilter == "lanczos");
+            if (resized == null)
+            {
+                return new { success = false, error = $"Could not resize '{pixels.Path}' to {targetWidth}x{targetHeight}." };
+            }
+
+            return WriteTexturePixels(outputPath ?? DerivedOutputPath(pixels.Path, $"{targetWidth}x{targetHeight}"),
+                resized, targetWidth, targetHeight, false, $"Resized '{pixels.Path}' to {targetWidth}x{targetHeight}");
+        }
+
+        /// <summary>
+        /// Multiplies a texture's color channels by its alpha and writes the result to a new image file.
+        /// </summary>
+        private static object HandlePremultiply(string texturePath, string outputPath)
+        {
+            TexturePixels pixels = ReadTexturePixels(texturePath, out string error);
+            if (pixels == null)
+            {
+                return new { success = false, error };
+            }
+
+            NativeTexture.Premultiply(pixels.Rgba, pixels.PixelCount);
+            return WriteTexturePixels(outputPath ?? DerivedOutputPath(pixels.Path, "premultiplied"),
+                pixels.Rgba, pixels.Width, pixels.Height, false, $"Premultiplied alpha of '{pixels.Path}'");
+        }
+
+        /// <summary>
+        /// Packs channels of up to four textures (or constants) into one image file, e.g. a mask map.
+        /// </summary>
+        private static object HandlePackChannels(string[] channelSources, string outputPath)
+        {
+            if (string.IsNullOrWhiteSpace(outputPath))
+            {
+                throw MCPException.InvalidParams("The 'output_path' parameter is required for pack_channels action.");
+            }
+            if (channelSources.All(string.IsNullOrWhiteSpace))
+            {
+                throw MCPException.InvalidParams("At least one of 'red_source', 'green_source', 'blue_source' or 'alpha_source' is required.");
+            }
+
+            // Textures are read once even when they feed several channels
+            var loaded = new Dictionary<string, TexturePixels>(StringComparer.OrdinalIgnoreCase);
+            var sources = new byte[4][];
+            var channels = new int[4];
+            TexturePixels first = null;
+            for (int c = 0; c < 4; c++)
+            {
+                string spec = channelSources[c];
+                if (string.IsNullOrWhiteSpace(spec))
+                {
+                    // Missing color channels are black, a missing alpha channel opaque
+                    channels[c] = c == 3 ? 255 : 0;
+                    continue;
+                }
+
+                if (float.TryParse(spec, System.Globalization.NumberStyles.Float, System.Globalization.CultureInfo.InvariantCulture, out float constant))
+                {
+                    channels[c] = Mathf.RoundToInt(Mathf.Clamp01(constant) * 255f);
+                    continue;
+                }
+
+                string path = spec.Trim();
+                int channel = c;
+                int separator = path.LastIndexOf(':');
+                if (separator > 0 && separator == path.Length - 2)
+                {
+                    channel = ParseChannel(path.Substring(separator + 1));
+                    if (channel < 0)
+                    {
+                        throw MCPException.InvalidParams($"Invalid channel in '{spec}'. Valid channels: r, g, b, a");
+                    }
+                    path = path.Substring(0, separator);
+                }
+
+                if (!loaded.TryGetValue(path, out TexturePixels pixels))
+                {
+                    pixels = ReadTexturePixels(path, out string error);
+                    if (pixels == null)
+                    {
+                        return new { success = false, error };
+                    }
+                    loaded[path] = pixels;
+                }
+
+                if (first == null)
+                {
+                    first = pixels;
+                }
+                else if (pixels.Width != first.Width || pixels.Height != first.Height)
+                {
+                    // Other sources are scaled to the first one's size
+                    byte[] resized = NativeTexture.Resize(pixels.Rgba, pixels.Width, pixels.Height, first.Width, first.Height, true);
+                    if (resized == null)
+                    {
+                        return new { success = false, error = $"Could not resize '{pixels.Path}' to {first.Width}x{first.Height}." };
+                    }
+                    pixels = new TexturePixels { Path = pixels.Path, Rgba = resized, Width = first.Width, Height = first.Height, Hdr = pixels.Hdr };
+                    loaded[path] = pixels;
+                }
+
+                sources[c] = pixels.Rgba;
+                channels[c] = channel;
+            }
+
+            if (first == null)
+            {
+                throw MCPException.InvalidParams("At least one channel source must be a texture path.");
+            }
+
+            byte[] packed = NativeTexture.PackChannels(sources, channels, first.PixelCount);
+            return WriteTexturePixels(outputPath, packed, first.Width, first.Height, false,
+                $"Packed {loaded.Count} texture(s) into {first.Width}x{first.Height} image");
+        }
+
+        /// <summary>
+        /// Writes one channel of a texture to a grayscale image file.
+        /// </summary>
+        private static object HandleUnpackChannel(string texturePath, string channelName, string outputPath)
+        {
+            int channel = ParseChannel(channelName);
+            if (channel < 0)
+            {
+                throw MCPException.InvalidParams("The 'channel' parameter (r, g, b or a) is required for unpack_channel action.");
+            }
+
+            TexturePixels pixels = ReadTexturePixels(texturePath, out string error);
+            if (pixels == null)
+            {
+                return new { success = false, error };
+            }
+
+            var sources = new[] { pixels.Rgba, pixels.Rgba, pixels.Rgba, null };
+            byte[] gray = NativeTexture.PackChannels(sources, new[] { channel, channel, channel, 255 }, pixels.PixelCount);
+            string suffix = "rgba"[channel].ToString();
+            return WriteTexturePixels(outputPath ?? DerivedOutputPath(pixels.Path, suffix), gray, pixels.Width, pixels.Height, true,
+                $"Extracted channel '{suffix}' of '{pixels.Path}'");
+        }
+
         #endregion
 
         #region Helper Methods
@@ -804,6 +1045,250 @@ namespace UnixxtyMCP.Editor.Tools
             return $"{formattedSize:0.##} {sizes[sizeIndex]}";
         }
 
+        /// <summary>
+        /// RGBA8 pixels of a texture's first mip, bottom row first.
+        /// </summary>
+        private sealed class TexturePixels
+        {
+            public string Path;
+            public byte[] Rgba;
+            public int Width;
+            public int Height;
+
+            /// <summary>
+            /// True if the texture has an HDR format, whose values were clamped to [0, 1].
+            /// </summary>
+            public bool Hdr;
+
+            public int PixelCount => Width * Height;
+        }
+
+        private const long MaxOutputPixels = 16384L * 16384L;
+
+        /// <summary>
+        /// Reads a texture's pixels. Readable RGBA32 and RGBAHalf textures are used as they are;
+        /// anything else (compressed, non-readable) is rendered into a temporary RenderTexture
+        /// and read back.
+        /// </summary>
+        /// <returns>The pixels, or null with an error message.</returns>
+        private static TexturePixels ReadTexturePixels(string texturePath, out string error)
+        {
+            error = null;
+            if (string.IsNullOrWhiteSpace(texturePath))
+            {
+                throw MCPException.InvalidParams("The 'texture_path' parameter is required for this action.");
+            }
+
+            string normalizedPath = PathUtilities.NormalizePath(texturePath);
+            Texture2D texture = AssetDatabase.LoadAssetAtPath<Texture2D>(normalizedPath);
+            if (texture == null)
+            {
+                error = $"Texture2D not found at '{normalizedPath}'.";
+                return null;
+            }
+
+            int width = texture.width;
+            int height = texture.height;
+            int pixelCount = width * height;
+            bool hdr = IsHdrFormat(texture.format);
+
+            byte[] raw;
+            if (texture.isReadable && (texture.format == TextureFormat.RGBA32 || texture.format == TextureFormat.RGBAHalf))
+            {
+                // The first mip comes first in the raw data
+                raw = texture.GetRawTextureData();
+            }
+            else
+            {
+                bool srgb = GraphicsFormatUtility.IsSRGBFormat(texture.graphicsFormat);
+                var rt = RenderTexture.GetTemporary(width, height, 0,
+                    hdr ? RenderTextureFormat.ARGBHalf : RenderTextureFormat.ARGB32,
+                    srgb ? RenderTextureReadWrite.sRGB : RenderTextureReadWrite.Linear);
+                Graphics.Blit(texture, rt);
+
+                var previous = RenderTexture.active;
+                RenderTexture.active = rt;
+                var readable = new Texture2D(width, height, hdr ? TextureFormat.RGBAHalf : TextureFormat.RGBA32, false, !srgb);
+                readable.ReadPixels(new Rect(0, 0, width, height), 0, 0);
+                readable.Apply(false);
+                RenderTexture.active = previous;
+                RenderTexture.ReleaseTemporary(rt);
+
+                raw = readable.GetRawTextureData();
+                UnityEngine.Object.DestroyImmediate(readable);
+            }
+
+            byte[] rgba = hdr ? NativeTexture.HalfToRgba8(raw, pixelCount) : raw;
+            if (rgba.Length != pixelCount * 4)
+            {
+                Array.Resize(ref rgba, pixelCount * 4);
+            }
+
+            return new TexturePixels
+            {
+                Path = normalizedPath,
+                Rgba = rgba,
+                Width = width,
+                Height = height,
+                Hdr = hdr
+            };
+        }
+
+        /// <summary>
+        /// Encodes RGBA8 pixels by the output path's extension (png, jpg, tga or exr), writes the
+        /// file and imports it.
+        /// </summary>
+        private static object WriteTexturePixels(string outputPath, byte[] rgba, int width, int height, bool grayscale, string summary)
+        {
+            string normalizedPath = PathUtilities.NormalizePath(outputPath);
+            if (!normalizedPath.StartsWith("Assets/", StringComparison.Ordinal) || normalizedPath.Contains(".."))
+            {
+                throw MCPException.InvalidParams($"'output_path' must be inside Assets/: '{outputPath}'.");
+            }
+
+            string extension = System.IO.Path.GetExtension(normalizedPath).ToLowerInvariant();
+            bool exr = extension == ".exr";
+            var texture = new Texture2D(width, height, exr ? TextureFormat.RGBAHalf : TextureFormat.RGBA32, false, true);
+            byte[] bytes;
+            try
+            {
+                texture.LoadRawTextureData(exr ? NativeTexture.Rgba8ToHalf(rgba, width * height) : rgba);
+                texture.Apply(false);
+
+                switch (extension)
+                {
+                    case ".png":
+                        bytes = NativeImage.Encode(texture, new ImageEncoding { Grayscale = grayscale }, 0, 0).ToArray();
+                        break;
+                    case ".jpg":
+                    case ".jpeg":
+                        bytes = NativeImage.Encode(texture, ImageEncoding.FromParameters("jpeg", 90, grayscale), 0, 0).ToArray();
+                        break;
+                    case ".tga":
+                        bytes = texture.EncodeToTGA();
+                        break;
+                    case ".exr":
+                        bytes = texture.EncodeToEXR(Texture2D.EXRFlags.CompressZIP);
+                        break;
+                    default:
+                        throw MCPException.InvalidParams($"Unsupported output extension '{extension}'. Valid extensions: .png, .jpg, .tga, .exr");
+                }
+            }
+            finally
+            {
+                UnityEngine.Object.DestroyImmediate(texture);
+            }
+
+            if (bytes == null)
+            {
+                return new { success = false, error = $"Could not encode '{normalizedPath}'." };
+            }
+
+            string directory = System.IO.Path.GetDirectoryName(normalizedPath);
+            if (!string.IsNullOrEmpty(directory) && !PathUtilities.EnsureFolderExists(directory, out string folderError))
+            {
+                return new { success = false, error = folderError };
+            }
+            System.IO.File.WriteAllBytes(normalizedPath, bytes);
+            AssetDatabase.ImportAsset(normalizedPath);
+
+            return new
+            {
+                success = true,
+                message = $"{summary}; wrote '{normalizedPath}'.",
+                path = normalizedPath,
+                width,
+                height,
+                sizeBytes = bytes.Length
+            };
+        }
+
+        /// <summary>
+        /// Builds "Folder/Name_suffix.png" next to a texture.
+        /// </summary>
+        private static string DerivedOutputPath(string texturePath, string suffix)
+        {
+            string directory = System.IO.Path.GetDirectoryName(texturePath)?.Replace('\\', '/');
+            string name = System.IO.Path.GetFileNameWithoutExtension(texturePath);
+            return string.IsNullOrEmpty(directory) ? $"{name}_{suffix}.png" : $"{directory}/{name}_{suffix}.png";
+        }
+
+        /// <summary>
+        /// Min, max, mean, standard deviation and an optional coarse histogram of one channel.
+        /// </summary>
+        private static object BuildChannelStats(int[] histogram, int offset, int pixelCount, int bins)
+        {
+            int min = -1, max = 0;
+            double sum = 0, sumSquares = 0;
+            for (int value = 0; value < NativeTexture.HistogramBins; value++)
+            {
+                int count = histogram[offset + value];
+                if (count == 0)
+                {
+                    continue;
+                }
+                if (min < 0) min = value;
+                max = value;
+                sum += (double)count * value;
+                sumSquares += (double)count * value * value;
+            }
+
+            double mean = sum / pixelCount;
+            double variance = Math.Max(0, sumSquares / pixelCount - mean * mean);
+            var stats = new Dictionary<string, object>
+            {
+                { "min", Math.Max(min, 0) },
+                { "max", max },
+                { "mean", Math.Round(mean, 3) },
+                { "stdDev", Math.Round(Math.Sqrt(variance), 3) }
+            };
+
+            if (bins > 0)
+            {
+                int width = NativeTexture.HistogramBins / bins;
+                var counts = new int[bins];
+                for (int value = 0; value < NativeTexture.HistogramBins; value++)
+                {
+                    counts[value / width] += histogram[offset + value];
+                }
+                stats["histogram"] = counts;
+            }
+            return stats;
+        }
+
+        /// <summary>
+        /// Parses r/g/b/a (or red/green/blue/alpha) to a channel index, or -1.
+        /// </summary>
+        private static int ParseChannel(string channel)
+        {
+            switch (channel?.Trim().ToLowerInvariant())
+            {
+                case "r": case "red": return 0;
+                case "g": case "green": return 1;
+                case "b": case "blue": return 2;
+                case "a": case "alpha": return 3;
+                default: return -1;
+            }
+        }
+
+        private static bool IsHdrFormat(TextureFormat format)
+        {
+            switch (format)
+            {
+                case TextureFormat.RGBAHalf:
+                case TextureFormat.RGBAFloat:
+                case TextureFormat.RGHalf:
+                case TextureFormat.RGFloat:
+                case TextureFormat.RHalf:
+                case TextureFormat.RFloat:
+                case TextureFormat.BC6H:
+                case TextureFormat.RGB9e5Float:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
         #endregion
     }
 }
@@ -10,7 +10,7 @@ namespace UnixxtyMCP.Editor.Tools
 {
     public static class SearchTools
     {
-        [MCPTool("search_tools", "Search available tools by name, description, or category. Use with no args for a category overview.", Category = "Editor", ReadOnlyHint = true)]
+        [MCPTool("search_tools", "Search available tools by name, description, or category. Use with no args for a category overview.", Category = "Editor", ReadOnlyHint = true, CacheEpochs = CacheEpoch.Editor)]
         public static object SearchAvailableTools(
             [MCPParam("query", "Search names and descriptions")] string query = null,
             [MCPParam("category", "Filter by category")] string category = null,
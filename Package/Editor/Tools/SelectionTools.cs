@@ -19,7 +19,7 @@ namespace UnixxtyMCP.Editor.Tools
         /// Gets the currently selected objects in the Unity Editor.
         /// </summary>
         /// <returns>Information about the current selection including count and object details.</returns>
-        [MCPTool("selection_get", "Get currently selected objects in the Unity Editor", Category = "Editor", ReadOnlyHint = true)]
+        [MCPTool("selection_get", "Get currently selected objects in the Unity Editor", Category = "Editor", ReadOnlyHint = true, CacheEpochs = CacheEpoch.Selection)]
         public static object Get()
         {
             try
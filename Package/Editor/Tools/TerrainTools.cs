@@ -15,7 +15,8 @@ namespace UnixxtyMCP.Editor.Tools
                 Enum = new[] { "create", "get_info", "set_height", "flatten", "smooth",
                                "get_layers", "add_layer", "paint_texture",
                                "add_tree", "get_trees", "clear_trees",
-                               "set_detail_density", "get_terrains" })] string action,
+                               "set_detail_density", "get_terrains",
+                               "get_heightmap", "set_heightmap", "get_alphamaps", "set_alphamaps" })] string action,
             [MCPParam("width", "Terrain width in world units (for create)", Minimum = 1)] int width = 500,
             [MCPParam("length", "Terrain length in world units (for create)", Minimum = 1)] int length = 500,
             [MCPParam("height", "Terrain max height (for create)", Minimum = 1)] int height = 100,
@@ -31,7 +32,12 @@ namespace UnixxtyMCP.Editor.Tools
             [MCPParam("prefab_path", "Tree prefab path (for add_tree)")] string prefabPath = null,
             [MCPParam("count", "Number of items to place (for add_tree)")] int count = 1,
             [MCPParam("name", "Name for the terrain (for create)")] string name = "Terrain",
-            [MCPParam("save_path", "Asset save path (for create)")] string savePath = null)
+            [MCPParam("save_path", "Asset save path (for create)")] string savePath = null,
+            [MCPParam("dtype", "Element type for get_heightmap/get_alphamaps: float32 (default), uint16 (value * 65535) or uint8 (alphamaps only, value * 255)",
+                Enum = new[] { "float32", "uint16", "uint8" })] string dtype = null,
+            [MCPParam("compress", "Delta-code, shuffle and deflate get_heightmap/get_alphamaps arrays")] bool compress = true,
+            [MCPParam("blob_id", "Id of a typed array uploaded with POST /blob (for set_heightmap/set_alphamaps)")] string blobId = null,
+            [MCPParam("data", "Base64 typed array, instead of blob_id (for set_heightmap/set_alphamaps)")] string data = null)
         {
             try
             {
@@ -50,6 +56,10 @@ namespace UnixxtyMCP.Editor.Tools
                     "clear_trees" => ClearTrees(target),
                     "set_detail_density" => SetDetailDensity(target, x, z, radius, strength),
                     "get_terrains" => GetAllTerrains(),
+                    "get_heightmap" => GetHeightmap(target, dtype, compress),
+                    "set_heightmap" => SetHeightmap(target, blobId, data),
+                    "get_alphamaps" => GetAlphamaps(target, dtype, compress),
+                    "set_alphamaps" => SetAlphamaps(target, blobId, data),
                     _ => throw MCPException.InvalidParams($"Unknown action: '{action}'.")
                 };
             }
@@ -451,5 +461,175 @@ namespace UnixxtyMCP.Editor.Tools
                 count = terrains.Length
             };
         }
+
+        private static object GetHeightmap(string target, string dtype, bool compress)
+        {
+            var terrain = ResolveTerrain(target);
+            var data = terrain.terrainData;
+            int res = data.heightmapResolution;
+            int type = ParseArrayType(dtype, allowUInt8: false);
+
+            var heights = data.GetHeights(0, 0, res, res);
+            return ArrayResult(heights, type, new[] { res, res }, compress);
+        }
+
+        private static object SetHeightmap(string target, string blobId, string base64)
+        {
+            var terrain = ResolveTerrain(target);
+            var data = terrain.terrainData;
+            int res = data.heightmapResolution;
+
+            var heights = new float[res, res];
+            ReadArray(blobId, base64, new[] { res, res }, heights, allowUInt8: false);
+
+            Undo.RecordObject(data, "Set Terrain Heightmap");
+            data.SetHeights(0, 0, heights);
+
+            return new { success = true, message = $"Heightmap set ({res}x{res})." };
+        }
+
+        private static object GetAlphamaps(string target, string dtype, bool compress)
+        {
+            var terrain = ResolveTerrain(target);
+            var data = terrain.terrainData;
+            int res = data.alphamapResolution;
+            int layers = data.alphamapLayers;
+            if (layers == 0)
+                return new { success = false, error = "Terrain has no layers." };
+            int type = ParseArrayType(dtype, allowUInt8: true);
+
+            var alphamaps = data.GetAlphamaps(0, 0, res, res);
+            return ArrayResult(alphamaps, type, new[] { res, res, layers }, compress);
+        }
+
+        private static object SetAlphamaps(string target, string blobId, string base64)
+        {
+            var terrain = ResolveTerrain(target);
+            var data = terrain.terrainData;
+            int res = data.alphamapResolution;
+            int layers = data.alphamapLayers;
+            if (layers == 0)
+                return new { success = false, error = "Terrain has no layers." };
+
+            var alphamaps = new float[res, res, layers];
+            ReadArray(blobId, base64, new[] { res, res, layers }, alphamaps, allowUInt8: true);
+
+            Undo.RecordObject(data, "Set Terrain Alphamaps");
+            data.SetAlphamaps(0, 0, alphamaps);
+
+            return new { success = true, message = $"Alphamaps set ({res}x{res}, {layers} layers)." };
+        }
+
+        private static int ParseArrayType(string dtype, bool allowUInt8)
+        {
+            if (string.IsNullOrEmpty(dtype)) return NativeArray.TypeFloat32;
+            int type = NativeArray.ParseType(dtype);
+            if (type == NativeArray.TypeFloat32 || type == NativeArray.TypeUInt16 || (allowUInt8 && type == NativeArray.TypeUInt8))
+                return type;
+            throw MCPException.InvalidParams($"Unsupported dtype '{dtype}'.");
+        }
+
+        /// <summary>
+        /// Encodes terrain values (0-1 floats) as a typed array and publishes it as a blob,
+        /// or inline base64 if the request does not accept blob URLs.
+        /// </summary>
+        private static object ArrayResult(Array values, int type, int[] shape, bool compress)
+        {
+            Array elements = values;
+            if (type != NativeArray.TypeFloat32)
+            {
+                var floats = new float[values.Length];
+                Buffer.BlockCopy(values, 0, floats, 0, floats.Length * sizeof(float));
+                elements = Quantize(floats, type);
+            }
+
+            byte[] encoded = NativeArray.Encode(elements, type, shape, compress);
+            string blobUrl = BlobStore.TryPublish(encoded, NativeArray.MimeType);
+            return new
+            {
+                success = true,
+                shape,
+                dtype = NativeArray.TypeName(type),
+                encoding = compress ? "umta+deflate" : "umta",
+                size_bytes = encoded.Length,
+                raw_bytes = values.Length * NativeArray.ElementSize(type),
+                blob_url = blobUrl,
+                data = blobUrl == null ? Base64Payload.Inline(encoded) : null
+            };
+        }
+
+        /// <summary>
+        /// Reads an uploaded or inline typed array of the given shape into terrain values.
+        /// </summary>
+        private static void ReadArray(string blobId, string base64, int[] shape, Array values, bool allowUInt8)
+        {
+            byte[] encoded;
+            if (!string.IsNullOrEmpty(blobId))
+            {
+                encoded = BlobStore.TryRead(blobId);
+                if (encoded == null)
+                    throw MCPException.InvalidParams($"Blob '{blobId}' not found or expired.");
+            }
+            else if (!string.IsNullOrEmpty(base64))
+            {
+                try { encoded = Convert.FromBase64String(base64); }
+                catch (FormatException) { throw MCPException.InvalidParams("'data' is not valid base64."); }
+            }
+            else
+            {
+                throw MCPException.InvalidParams("'blob_id' or 'data' is required.");
+            }
+
+            if (!NativeArray.TryReadHeader(encoded, out int type, out int[] actual))
+                throw MCPException.InvalidParams("Not a typed array.");
+            if (!actual.SequenceEqual(shape))
+                throw MCPException.InvalidParams($"Array shape [{string.Join(", ", actual)}] does not match terrain [{string.Join(", ", shape)}].");
+            ParseArrayType(NativeArray.TypeName(type), allowUInt8);
+
+            if (type == NativeArray.TypeFloat32)
+            {
+                if (!NativeArray.TryDecode(encoded, values))
+                    throw MCPException.InvalidParams("Typed array is corrupt.");
+                return;
+            }
+
+            Array elements = type == NativeArray.TypeUInt16 ? new ushort[values.Length] : (Array)new byte[values.Length];
+            if (!NativeArray.TryDecode(encoded, elements))
+                throw MCPException.InvalidParams("Typed array is corrupt.");
+            var floats = Dequantize(elements);
+            Buffer.BlockCopy(floats, 0, values, 0, floats.Length * sizeof(float));
+        }
+
+        private static Array Quantize(float[] values, int type)
+        {
+            if (type == NativeArray.TypeUInt16)
+            {
+                var result = new ushort[values.Length];
+                for (int i = 0; i < values.Length; i++)
+                    result[i] = (ushort)(Mathf.Clamp01(values[i]) * 65535f + 0.5f);
+                return result;
+            }
+            var bytes = new byte[values.Length];
+            for (int i = 0; i < values.Length; i++)
+                bytes[i] = (byte)(Mathf.Clamp01(values[i]) * 255f + 0.5f);
+            return bytes;
+        }
+
+        private static float[] Dequantize(Array elements)
+        {
+            var result = new float[elements.Length];
+            if (elements is ushort[] words)
+            {
+                for (int i = 0; i < words.Length; i++)
+                    result[i] = words[i] / 65535f;
+            }
+            else
+            {
+                var bytes = (byte[])elements;
+                for (int i = 0; i < bytes.Length; i++)
+                    result[i] = bytes[i] / 255f;
+            }
+            return result;
+        }
     }
 }
@@ -60,7 +60,7 @@ namespace UnixxtyMCP.Editor.Tools
         /// <summary>
         /// Lists all scenes in the build settings.
         /// </summary>
-        [MCPTool("test_list_scenes", "Lists all scenes in build settings", Category = "Debug", ReadOnlyHint = true)]
+        [MCPTool("test_list_scenes", "Lists all scenes in build settings", Category = "Debug", ReadOnlyHint = true, CacheEpochs = CacheEpoch.Assets)]
         public static object ListScenes()
         {
             var scenes = EditorBuildSettings.scenes
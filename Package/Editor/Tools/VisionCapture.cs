@@ -15,7 +15,10 @@ namespace UnixxtyMCP.Editor.Tools
     public static class VisionCapture
     {
         [MCPTool("vision_capture",
-            "Capture Game View or Scene View screenshot as base64 PNG for AI vision analysis. " +
+            "Capture Game View or Scene View screenshot as base64 PNG or JPEG (or a blob URL when the request sets _meta.blobUrls) for AI vision analysis. " +
+            "format=jpeg with grayscale keeps captures to tens of KB when color and exact pixels are not needed. " +
+            "For repeated captures of a view, pass the same delta_session: after the first (key)frame only the changed 32x32 tiles are sent, " +
+            "as a PNG atlas listed in the delta's tiles. " +
             "Use output_path to save to disk instead of returning base64 (recommended for large captures). " +
             "For file-based capture with ScreenCapture API, see scene_screenshot.",
             Category = "Scene", ReadOnlyHint = true)]
@@ -24,8 +27,21 @@ namespace UnixxtyMCP.Editor.Tools
                 Enum = new[] { "game", "scene", "both" })] string view = "game",
             [MCPParam("width", "Target width in pixels (default: 640)", Minimum = 64, Maximum = 1920)] int width = 640,
             [MCPParam("height", "Target height in pixels (default: 480, or 0 for auto aspect ratio)", Minimum = 0, Maximum = 1080)] int height = 0,
-            [MCPParam("output_path", "Save PNG to this path instead of returning base64. Relative paths resolve from project root. Recommended for large captures.")] string outputPath = null)
+            [MCPParam("output_path", "Save the image to this path instead of returning base64. Relative paths resolve from project root. Recommended for large captures.")] string outputPath = null,
+            [MCPParam("format", "Image format: png (lossless) or jpeg (default: png)",
+                Enum = new[] { "png", "jpeg" })] string format = "png",
+            [MCPParam("quality", "JPEG quality 1-100 (default: 75)", Minimum = 1, Maximum = 100)] int quality = ImageEncoding.DefaultJpegQuality,
+            [MCPParam("grayscale", "Drop color to a single luma channel (default: false)")] bool grayscale = false,
+            [MCPParam("delta_session", "Name of a frame delta session: return only the tiles that changed since this session's previous capture (always PNG). " +
+                "Atlas cell i (row-major, atlas_columns per row, 32px each) goes at tiles[i] of the previous frame.")] string deltaSession = null,
+            [MCPParam("keyframe", "With delta_session, send the whole frame (default: false; also sent every 30 frames)")] bool keyframe = false)
         {
+            var options = new CaptureOptions
+            {
+                Encoding = ImageEncoding.FromParameters(format, quality, grayscale),
+                DeltaSession = string.IsNullOrEmpty(deltaSession) ? null : deltaSession,
+                Keyframe = keyframe
+            };
             var images = new List<object>();
             bool saveToFile = !string.IsNullOrEmpty(outputPath);
 
@@ -33,14 +49,14 @@ namespace UnixxtyMCP.Editor.Tools
             {
                 if (view == "game" || view == "both")
                 {
-                    var gameCapture = CaptureView("game", width, height, saveToFile, outputPath, view == "both" ? "_game" : "");
+                    var gameCapture = CaptureView("game", width, height, options, saveToFile, outputPath, view == "both" ? "_game" : "");
                     if (gameCapture != null)
                         images.Add(gameCapture);
                 }
 
                 if (view == "scene" || view == "both")
                 {
-                    var sceneCapture = CaptureView("scene", width, height, saveToFile, outputPath, view == "both" ? "_scene" : "");
+                    var sceneCapture = CaptureView("scene", width, height, options, saveToFile, outputPath, view == "both" ? "_scene" : "");
                     if (sceneCapture != null)
                         images.Add(sceneCapture);
                 }
@@ -72,10 +88,12 @@ namespace UnixxtyMCP.Editor.Tools
             }
         }
 
-        private static object CaptureView(string viewType, int width, int height, bool saveToFile, string outputPath, string suffix)
+        private static object CaptureView(string viewType, int width, int height, CaptureOptions options,
+            bool saveToFile, string outputPath, string suffix)
         {
-            // Capture the raw PNG bytes using existing methods
-            var captureResult = viewType == "game" ? CaptureGameViewRaw(width, height) : CaptureSceneViewRaw(width, height);
+            var captureResult = viewType == "game"
+                ? CaptureGameViewRaw(width, height, options.ForView(viewType))
+                : CaptureSceneViewRaw(width, height, options.ForView(viewType));
             if (captureResult == null) return null;
 
             if (captureResult.Error != null)
@@ -83,39 +101,52 @@ namespace UnixxtyMCP.Editor.Tools
                 return new { view = viewType, error = captureResult.Error };
             }
 
+            var result = new Dictionary<string, object>
+            {
+                ["view"] = viewType,
+                ["width"] = captureResult.Width,
+                ["height"] = captureResult.Height
+            };
+            if (captureResult.Delta != null)
+            {
+                result["delta"] = captureResult.Delta.Describe();
+            }
+            if (captureResult.Image == null)
+            {
+                // Delta with no changed tile
+                result["unchanged"] = true;
+                return result;
+            }
+            result["mime_type"] = captureResult.Image.MimeType;
+
             if (saveToFile)
             {
-                string resolvedPath = ResolveSavePath(outputPath, suffix);
+                string extension = captureResult.Image.MimeType == "image/jpeg" ? ".jpg" : ".png";
+                string resolvedPath = ResolveSavePath(outputPath, suffix, extension);
                 string directory = Path.GetDirectoryName(resolvedPath);
                 if (!string.IsNullOrEmpty(directory) && !Directory.Exists(directory))
                     Directory.CreateDirectory(directory);
 
-                File.WriteAllBytes(resolvedPath, captureResult.PngBytes);
+                File.WriteAllBytes(resolvedPath, captureResult.Image.ToArray());
+                result["size_bytes"] = captureResult.Image.Size;
+                result["path"] = resolvedPath;
+                return result;
+            }
 
-                return new
-                {
-                    view = viewType,
-                    width = captureResult.Width,
-                    height = captureResult.Height,
-                    size_bytes = captureResult.PngBytes.Length,
-                    path = resolvedPath
-                };
+            string blobUrl = BlobStore.TryPublish(captureResult.Image);
+            if (blobUrl != null)
+            {
+                result["size_bytes"] = captureResult.Image.Size;
+                result["blob_url"] = blobUrl;
             }
             else
             {
-                string base64 = Convert.ToBase64String(captureResult.PngBytes);
-                return new
-                {
-                    view = viewType,
-                    width = captureResult.Width,
-                    height = captureResult.Height,
-                    size_bytes = captureResult.PngBytes.Length,
-                    base64
-                };
+                result["base64"] = Base64Payload.Inline(captureResult.Image);
             }
+            return result;
         }
 
-        private static string ResolveSavePath(string outputPath, string suffix)
+        private static string ResolveSavePath(string outputPath, string suffix, string extension)
         {
             // Insert suffix before extension for "both" mode
             string path = outputPath;
@@ -123,12 +154,14 @@ namespace UnixxtyMCP.Editor.Tools
             {
                 string ext = Path.GetExtension(path);
                 string withoutExt = Path.ChangeExtension(path, null);
-                path = withoutExt + suffix + (string.IsNullOrEmpty(ext) ? ".png" : ext);
+                path = withoutExt + suffix + (string.IsNullOrEmpty(ext) ? extension : ext);
             }
 
-            // Ensure .png extension
-            if (!path.EndsWith(".png", StringComparison.OrdinalIgnoreCase))
-                path += ".png";
+            // Ensure the format's extension (.jpeg is kept as is)
+            bool hasExtension = path.EndsWith(extension, StringComparison.OrdinalIgnoreCase) ||
+                (extension == ".jpg" && path.EndsWith(".jpeg", StringComparison.OrdinalIgnoreCase));
+            if (!hasExtension)
+                path += extension;
 
             // Resolve relative paths from project root
             if (!Path.IsPathRooted(path))
@@ -137,23 +170,67 @@ namespace UnixxtyMCP.Editor.Tools
             return Path.GetFullPath(path);
         }
 
+        private class CaptureOptions
+        {
+            public ImageEncoding Encoding;
+            public string DeltaSession;
+            public bool Keyframe;
+
+            /// <summary>
+            /// Each view diffs against its own previous frame.
+            /// </summary>
+            public CaptureOptions ForView(string viewType)
+            {
+                return new CaptureOptions
+                {
+                    Encoding = Encoding,
+                    DeltaSession = DeltaSession == null ? null : $"{DeltaSession}:{viewType}",
+                    Keyframe = Keyframe
+                };
+            }
+        }
+
         private class CaptureData
         {
-            public byte[] PngBytes;
+            public ImageJob Image;
+            public FrameDeltaCapture Delta;
             public int Width;
             public int Height;
             public string Error;
         }
 
-        private static CaptureData CaptureGameViewRaw(int targetWidth, int targetHeight)
+        private static CaptureData EncodeCapture(Texture2D tex, CaptureOptions options)
+        {
+            var data = new CaptureData { Width = tex.width, Height = tex.height };
+            if (options.DeltaSession != null)
+            {
+                data.Delta = FrameDelta.Diff(options.DeltaSession, tex, 0, 0, topRowFirst: false, options.Keyframe);
+                if (data.Delta != null)
+                {
+                    data.Image = data.Delta.Image;
+                    return data;
+                }
+            }
+            data.Image = NativeImage.Encode(tex, options.Encoding, 0, 0);
+            return data;
+        }
+
+        private static CaptureData CaptureGameViewRaw(int targetWidth, int targetHeight, CaptureOptions options)
         {
             int captureHeight = targetHeight > 0 ? targetHeight : Mathf.RoundToInt(targetWidth * 0.75f);
+            string diag;
 
             // Primary: Read from Game View's composited RT (includes UITK panels)
-            if (GameViewCapture.TryCaptureComposited(targetWidth, captureHeight,
-                    out byte[] compositedPng, out int cw, out int ch, out string diag))
+            if (options.DeltaSession != null &&
+                GameViewCapture.TryCaptureCompositedDelta(options.DeltaSession, targetWidth, captureHeight, options.Keyframe,
+                    out FrameDeltaCapture delta, out diag) && delta != null)
+            {
+                return new CaptureData { Image = delta.Image, Delta = delta, Width = delta.Width, Height = delta.Height };
+            }
+            if (GameViewCapture.TryCaptureComposited(targetWidth, captureHeight, options.Encoding,
+                    out ImageJob composited, out int cw, out int ch, out diag))
             {
-                return new CaptureData { PngBytes = compositedPng, Width = cw, Height = ch };
+                return new CaptureData { Image = composited, Width = cw, Height = ch };
             }
 
             // Fallback: Camera.Render() only (no UITK panels)
@@ -179,12 +256,12 @@ namespace UnixxtyMCP.Editor.Tools
                 tex.Apply();
                 RenderTexture.active = prevActive;
 
-                byte[] png = tex.EncodeToPNG();
+                var data = EncodeCapture(tex, options);
 
                 UnityEngine.Object.DestroyImmediate(tex);
                 UnityEngine.Object.DestroyImmediate(rt);
 
-                return new CaptureData { PngBytes = png, Width = targetWidth, Height = captureHeight };
+                return data;
             }
             catch (Exception ex)
             {
@@ -192,7 +269,7 @@ namespace UnixxtyMCP.Editor.Tools
             }
         }
 
-        private static CaptureData CaptureSceneViewRaw(int targetWidth, int targetHeight)
+        private static CaptureData CaptureSceneViewRaw(int targetWidth, int targetHeight, CaptureOptions options)
         {
             try
             {
@@ -223,12 +300,12 @@ namespace UnixxtyMCP.Editor.Tools
                 tex.Apply();
                 RenderTexture.active = prevActive;
 
-                byte[] png = tex.EncodeToPNG();
+                var data = EncodeCapture(tex, options);
 
                 UnityEngine.Object.DestroyImmediate(tex);
                 UnityEngine.Object.DestroyImmediate(rt);
 
-                return new CaptureData { PngBytes = png, Width = targetWidth, Height = captureHeight };
+                return data;
             }
             catch (Exception ex)
             {
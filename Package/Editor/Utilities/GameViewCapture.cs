@@ -2,6 +2,7 @@ using System;
 using System.Reflection;
 using UnityEditor;
 using UnityEngine;
+using UnixxtyMCP.Editor.Core;
 
 namespace UnixxtyMCP.Editor.Utilities
 {
@@ -31,72 +32,100 @@ namespace UnixxtyMCP.Editor.Utilities
         public static bool TryCaptureComposited(int width, int height,
             out byte[] png, out int captureWidth, out int captureHeight, out string diagnostics)
         {
-            png = null;
+            bool captured = TryCaptureComposited(width, height,
+                out ImageJob job, out captureWidth, out captureHeight, out diagnostics);
+            png = job?.ToArray();
+            return captured && png != null;
+        }
+
+        /// <summary>
+        /// Attempts to capture the Game View's composited output (including UITK panels) as PNG.
+        /// The PNG is encoded on native worker threads; only the readback happens here.
+        /// </summary>
+        /// <param name="width">Target width in pixels</param>
+        /// <param name="height">Target height in pixels</param>
+        /// <param name="png">Encoding job for the capture</param>
+        /// <param name="captureWidth">Actual width of the captured image</param>
+        /// <param name="captureHeight">Actual height of the captured image</param>
+        /// <param name="diagnostics">Diagnostic info if capture fails</param>
+        /// <returns>True if composited capture succeeded</returns>
+        internal static bool TryCaptureComposited(int width, int height,
+            out ImageJob png, out int captureWidth, out int captureHeight, out string diagnostics)
+        {
+            return TryCaptureComposited(width, height, ImageEncoding.Png,
+                out png, out captureWidth, out captureHeight, out diagnostics);
+        }
+
+        /// <summary>
+        /// Attempts to capture the Game View's composited output (including UITK panels).
+        /// The frame is read back at the Game View's resolution; downscaling and encoding
+        /// happen on native worker threads.
+        /// </summary>
+        /// <param name="width">Target width in pixels</param>
+        /// <param name="height">Target height in pixels</param>
+        /// <param name="encoding">Output format</param>
+        /// <param name="image">Encoding job for the capture</param>
+        /// <param name="captureWidth">Actual width of the captured image</param>
+        /// <param name="captureHeight">Actual height of the captured image</param>
+        /// <param name="diagnostics">Diagnostic info if capture fails</param>
+        /// <returns>True if composited capture succeeded</returns>
+        internal static bool TryCaptureComposited(int width, int height, ImageEncoding encoding,
+            out ImageJob image, out int captureWidth, out int captureHeight, out string diagnostics)
+        {
+            image = null;
             captureWidth = 0;
             captureHeight = 0;
             diagnostics = null;
 
             try
             {
-                var gameView = GetGameView();
-                if (gameView == null)
-                {
-                    diagnostics = "GameView window not found.";
-                    return false;
-                }
-
-                // Force repaint to ensure the RT has the latest frame
-                gameView.Repaint();
-                UnityEditorInternal.InternalEditorUtility.RepaintAllViews();
-
-                var sourceRT = GetGameViewRT(gameView);
-                if (sourceRT == null || !sourceRT.IsCreated())
-                {
-                    diagnostics = s_discovered
-                        ? "GameView RT field found but RT is null or not created."
-                        : "Could not discover GameView internal RenderTexture field.";
+                var tex = ReadComposited(out diagnostics);
+                if (tex == null)
                     return false;
-                }
-
-                // Read from the source RT, then resize if needed
-                int srcW = sourceRT.width;
-                int srcH = sourceRT.height;
 
-                // If requested dimensions match source, read directly
-                bool needsResize = width != srcW || height != srcH;
-                RenderTexture readTarget = sourceRT;
+                bool needsResize = width > 0 && height > 0 && (width != tex.width || height != tex.height);
+                captureWidth = needsResize ? width : tex.width;
+                captureHeight = needsResize ? height : tex.height;
 
-                if (needsResize && width > 0 && height > 0)
-                {
-                    // Blit to a resized RT
-                    readTarget = RenderTexture.GetTemporary(width, height, 0, RenderTextureFormat.ARGB32);
-                    Graphics.Blit(sourceRT, readTarget);
-                    captureWidth = width;
-                    captureHeight = height;
-                }
-                else
-                {
-                    captureWidth = srcW;
-                    captureHeight = srcH;
-                }
+                // Game View RT is Y-flipped: its rows read back top row first, so the
+                // encoder takes them in that order instead of flipping the texture
+                image = NativeImage.Encode(tex, encoding, captureWidth, captureHeight, topRowFirst: true);
+                UnityEngine.Object.DestroyImmediate(tex);
 
-                // Read pixels — Game View RT is Y-flipped, so we flip during read
-                var tex = new Texture2D(captureWidth, captureHeight, TextureFormat.RGBA32, false);
-                var prevActive = RenderTexture.active;
-                RenderTexture.active = readTarget;
-                tex.ReadPixels(new Rect(0, 0, captureWidth, captureHeight), 0, 0);
-                tex.Apply();
-                RenderTexture.active = prevActive;
+                return true;
+            }
+            catch (Exception ex)
+            {
+                diagnostics = $"GameViewCapture exception: {ex.Message}";
+                return false;
+            }
+        }
 
-                if (needsResize && readTarget != sourceRT)
-                    RenderTexture.ReleaseTemporary(readTarget);
+        /// <summary>
+        /// Attempts to capture the Game View's composited output as a delta against the
+        /// previous capture of a frame delta session.
+        /// </summary>
+        /// <param name="session">Frame delta session name</param>
+        /// <param name="width">Target width in pixels</param>
+        /// <param name="height">Target height in pixels</param>
+        /// <param name="forceKeyframe">Send the whole frame even if the session has a previous one</param>
+        /// <param name="delta">The changed tiles, or null if the native differ is unavailable</param>
+        /// <param name="diagnostics">Diagnostic info if capture fails</param>
+        /// <returns>True if the Game View could be read</returns>
+        internal static bool TryCaptureCompositedDelta(string session, int width, int height, bool forceKeyframe,
+            out FrameDeltaCapture delta, out string diagnostics)
+        {
+            delta = null;
+            diagnostics = null;
 
-                // Flip Y (Game View RT is stored bottom-up)
-                FlipTextureY(tex);
+            try
+            {
+                var tex = ReadComposited(out diagnostics);
+                if (tex == null)
+                    return false;
 
-                png = tex.EncodeToPNG();
+                delta = FrameDelta.Diff(session, tex, width, height, topRowFirst: true, forceKeyframe);
                 UnityEngine.Object.DestroyImmediate(tex);
-
                 return true;
             }
             catch (Exception ex)
@@ -106,6 +135,45 @@ namespace UnixxtyMCP.Editor.Utilities
             }
         }
 
+        /// <summary>
+        /// Reads the Game View's RenderTexture back at its own resolution. Rows come out top
+        /// row first. The caller destroys the texture.
+        /// </summary>
+        private static Texture2D ReadComposited(out string diagnostics)
+        {
+            diagnostics = null;
+
+            var gameView = GetGameView();
+            if (gameView == null)
+            {
+                diagnostics = "GameView window not found.";
+                return null;
+            }
+
+            // Force repaint to ensure the RT has the latest frame
+            gameView.Repaint();
+            UnityEditorInternal.InternalEditorUtility.RepaintAllViews();
+
+            var sourceRT = GetGameViewRT(gameView);
+            if (sourceRT == null || !sourceRT.IsCreated())
+            {
+                diagnostics = s_discovered
+                    ? "GameView RT field found but RT is null or not created."
+                    : "Could not discover GameView internal RenderTexture field.";
+                return null;
+            }
+
+            // Read pixels at source resolution; the encoder filters them down, which
+            // avoids the aliasing of a bilinear GPU blit
+            var tex = new Texture2D(sourceRT.width, sourceRT.height, TextureFormat.RGBA32, false);
+            var prevActive = RenderTexture.active;
+            RenderTexture.active = sourceRT;
+            tex.ReadPixels(new Rect(0, 0, sourceRT.width, sourceRT.height), 0, 0);
+            tex.Apply();
+            RenderTexture.active = prevActive;
+            return tex;
+        }
+
         /// <summary>
         /// Returns diagnostic info about available RT fields on GameView.
         /// </summary>
@@ -211,23 +279,5 @@ namespace UnixxtyMCP.Editor.Utilities
                 type = type.BaseType;
             }
         }
-
-        private static void FlipTextureY(Texture2D tex)
-        {
-            int w = tex.width;
-            int h = tex.height;
-            var pixels = tex.GetPixels32();
-            var flipped = new Color32[pixels.Length];
-
-            for (int y = 0; y < h; y++)
-            {
-                int srcRow = (h - 1 - y) * w;
-                int dstRow = y * w;
-                Array.Copy(pixels, srcRow, flipped, dstRow, w);
-            }
-
-            tex.SetPixels32(flipped);
-            tex.Apply();
-        }
     }
 }
@@ -0,0 +1,245 @@
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using Newtonsoft.Json.Linq;
+using UnityEditor;
+using UnityEditor.SceneManagement;
+using UnityEngine.SceneManagement;
+
+namespace UnixxtyMCP.Editor.Utilities
+{
+    /// <summary>
+    /// Keeps recent serialized snapshots of tree-shaped tool results (e.g. scene hierarchy pages)
+    /// so a client that sends back the version it holds can receive a structural diff instead of
+    /// the whole tree again.
+    ///
+    /// Snapshots are grouped by query key (the tool name plus every argument that shapes the result).
+    /// Each key keeps its last few versions; clients polling the same query share them, and each
+    /// client simply holds whichever version it last received. Versions start from the clock at
+    /// each domain reload, so one kept from before a reload never matches a newer snapshot.
+    /// </summary>
+    [InitializeOnLoad]
+    public static class SnapshotStore
+    {
+        /// <summary>
+        /// Versions kept per query key. Older bases fall back to a full snapshot.
+        /// </summary>
+        public const int VersionsPerQuery = 4;
+
+        /// <summary>
+        /// Distinct queries tracked before the least recently used one is dropped.
+        /// </summary>
+        public const int MaxQueries = 32;
+
+        /// <summary>
+        /// A flattened snapshot: node properties (without children) keyed by node id.
+        /// Each node also records its "parent" id and sibling "index".
+        /// </summary>
+        private class Snapshot
+        {
+            public long version;
+            public Dictionary<long, JObject> nodes;
+        }
+
+        private static readonly Dictionary<string, LinkedList<Snapshot>> s_queries = new Dictionary<string, LinkedList<Snapshot>>();
+        private static readonly LinkedList<string> s_queryOrder = new LinkedList<string>();
+        private static long s_nextVersion = DateTimeOffset.UtcNow.ToUnixTimeMilliseconds() * 1000;
+
+        static SnapshotStore()
+        {
+            EditorSceneManager.activeSceneChangedInEditMode += OnActiveSceneChanged;
+            SceneManager.activeSceneChanged += OnActiveSceneChanged;
+        }
+
+        /// <summary>
+        /// Result of recording a snapshot.
+        /// </summary>
+        public struct DeltaResult
+        {
+            /// <summary>Version assigned to the current tree.</summary>
+            public long version;
+
+            /// <summary>True when added/removed/changed describe the change from the base version.</summary>
+            public bool isDelta;
+
+            /// <summary>Nodes present now but not in the base (flattened, with parent and index).</summary>
+            public List<JObject> added;
+
+            /// <summary>Ids of nodes present in the base but not now.</summary>
+            public List<long> removed;
+
+            /// <summary>
+            /// Changed nodes: the id plus only the properties whose values differ, and under
+            /// "removedProperties" the names of properties the node no longer has.
+            /// </summary>
+            public List<JObject> changed;
+        }
+
+        /// <summary>
+        /// Records the current tree for a query and diffs it against the version the client holds.
+        /// </summary>
+        /// <param name="queryKey">Identifies the query shape (tool name and result-shaping arguments).</param>
+        /// <param name="items">Root items of the current result; nested nodes live in "children" arrays.</param>
+        /// <param name="idProperty">Property holding each node's unique id (e.g. "instanceID").</param>
+        /// <param name="sinceVersion">Version the client holds, or 0 for none.</param>
+        public static DeltaResult Record(string queryKey, IEnumerable<object> items, string idProperty, long sinceVersion)
+        {
+            var nodes = Flatten(items, idProperty);
+
+            if (!s_queries.TryGetValue(queryKey, out var history))
+            {
+                history = new LinkedList<Snapshot>();
+                s_queries[queryKey] = history;
+                if (s_queries.Count > MaxQueries)
+                {
+                    string oldest = s_queryOrder.Last.Value;
+                    s_queryOrder.RemoveLast();
+                    s_queries.Remove(oldest);
+                }
+            }
+            else
+            {
+                s_queryOrder.Remove(queryKey);
+            }
+            s_queryOrder.AddFirst(queryKey);
+
+            // Unchanged since the latest snapshot: keep its version so repeated polls converge
+            Snapshot current;
+            var latest = history.First?.Value;
+            if (latest != null && IsEqual(latest.nodes, nodes))
+            {
+                current = latest;
+            }
+            else
+            {
+                current = new Snapshot { version = s_nextVersion++, nodes = nodes };
+                history.AddFirst(current);
+                while (history.Count > VersionsPerQuery)
+                {
+                    history.RemoveLast();
+                }
+            }
+
+            var result = new DeltaResult { version = current.version };
+            var baseSnapshot = sinceVersion > 0 ? history.FirstOrDefault(snapshot => snapshot.version == sinceVersion) : null;
+            if (baseSnapshot == null)
+            {
+                return result;
+            }
+
+            result.isDelta = true;
+            result.added = new List<JObject>();
+            result.removed = new List<long>();
+            result.changed = new List<JObject>();
+
+            foreach (var pair in current.nodes)
+            {
+                if (!baseSnapshot.nodes.TryGetValue(pair.Key, out var before))
+                {
+                    result.added.Add(pair.Value);
+                    continue;
+                }
+
+                JObject difference = null;
+                foreach (var property in pair.Value.Properties())
+                {
+                    if (!JToken.DeepEquals(before[property.Name], property.Value))
+                    {
+                        difference = difference ?? new JObject { [idProperty] = pair.Key };
+                        difference[property.Name] = property.Value;
+                    }
+                }
+                foreach (var property in before.Properties())
+                {
+                    if (pair.Value.Property(property.Name) == null)
+                    {
+                        difference = difference ?? new JObject { [idProperty] = pair.Key };
+                        var removedProperties = difference["removedProperties"] as JArray;
+                        if (removedProperties == null)
+                        {
+                            removedProperties = new JArray();
+                            difference["removedProperties"] = removedProperties;
+                        }
+                        removedProperties.Add(property.Name);
+                    }
+                }
+                if (difference != null)
+                {
+                    result.changed.Add(difference);
+                }
+            }
+
+            foreach (long id in baseSnapshot.nodes.Keys)
+            {
+                if (!current.nodes.ContainsKey(id))
+                {
+                    result.removed.Add(id);
+                }
+            }
+
+            return result;
+        }
+
+        /// <summary>
+        /// Drops every stored snapshot. Called when the active scene changes.
+        /// </summary>
+        public static void Clear()
+        {
+            s_queries.Clear();
+            s_queryOrder.Clear();
+        }
+
+        private static void OnActiveSceneChanged(Scene previous, Scene next) => Clear();
+
+        private static Dictionary<long, JObject> Flatten(IEnumerable<object> items, string idProperty)
+        {
+            var nodes = new Dictionary<long, JObject>();
+            int index = 0;
+            foreach (var item in items)
+            {
+                if (item != null)
+                {
+                    FlattenNode(JObject.FromObject(item), 0, index++, idProperty, nodes);
+                }
+            }
+            return nodes;
+        }
+
+        private static void FlattenNode(JObject node, long parentId, int index, string idProperty, Dictionary<long, JObject> nodes)
+        {
+            long id = node.Value<long>(idProperty);
+            var children = node["children"] as JArray;
+            node.Remove("children");
+            node["parent"] = parentId;
+            node["index"] = index;
+            nodes[id] = node;
+
+            if (children == null)
+            {
+                return;
+            }
+
+            int childIndex = 0;
+            foreach (var child in children.OfType<JObject>())
+            {
+                FlattenNode(child, id, childIndex++, idProperty, nodes);
+            }
+        }
+
+        private static bool IsEqual(Dictionary<long, JObject> a, Dictionary<long, JObject> b)
+        {
+            if (a.Count != b.Count)
+            {
+                return false;
+            }
+            foreach (var pair in a)
+            {
+                if (!b.TryGetValue(pair.Key, out var other) || !JToken.DeepEquals(pair.Value, other))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+}
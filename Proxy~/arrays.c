@@ -0,0 +1,488 @@
+/*
+ * UnixxtyMCP Proxy - Typed array transfer format
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "arrays.h"
+#include "deflate.h"
+#include "workers.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Elements per task for the delta and shuffle passes */
+#define TRANSFORM_CHUNK 65536
+
+typedef struct ArrayTransform
+{
+    const unsigned char* source;
+    unsigned char* target;
+    size_t count;
+    int size;
+    int flags;
+} ArrayTransform;
+
+typedef struct ArrayPiece
+{
+    DeflateOutput output;
+    uint32_t adler;
+    int ok;
+} ArrayPiece;
+
+typedef struct ArrayDeflate
+{
+    const unsigned char* data;
+    size_t length;
+    ArrayPiece* pieces;
+    int piece_count;
+} ArrayDeflate;
+
+static int ElementSize(int type)
+{
+    switch (type)
+    {
+        case ARRAY_TYPE_UINT8: return 1;
+        case ARRAY_TYPE_UINT16: return 2;
+        case ARRAY_TYPE_INT32: return 4;
+        case ARRAY_TYPE_FLOAT32: return 4;
+        default: return 0;
+    }
+}
+
+static uint32_t LoadElement(const unsigned char* p, int size)
+{
+    uint32_t value = p[0];
+    if (size > 1) value |= (uint32_t)p[1] << 8;
+    if (size > 2) value |= ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    return value;
+}
+
+static void StoreElement(unsigned char* p, int size, uint32_t value)
+{
+    p[0] = (unsigned char)value;
+    if (size > 1) p[1] = (unsigned char)(value >> 8);
+    if (size > 2)
+    {
+        p[2] = (unsigned char)(value >> 16);
+        p[3] = (unsigned char)(value >> 24);
+    }
+}
+
+/*
+ * Element count of a shape, or 0 if it is empty, invalid or too large for
+ * an int-sized buffer.
+ */
+static size_t ShapeCount(const int* shape, int rank, int size)
+{
+    size_t count = 1;
+    int axis;
+
+    if (shape == NULL || rank < 1 || rank > ARRAY_MAX_RANK || size == 0)
+    {
+        return 0;
+    }
+    for (axis = 0; axis < rank; axis++)
+    {
+        if (shape[axis] <= 0 || count > (size_t)0x7fffffff / (size_t)shape[axis])
+        {
+            return 0;
+        }
+        count *= (size_t)shape[axis];
+    }
+    return count * (size_t)size > (size_t)0x7fffffff - 4096 ? 0 : count;
+}
+
+static size_t HeaderLength(int rank)
+{
+    return 8 + 4 * (size_t)rank;
+}
+
+/*
+ * Delta and shuffle elements [begin, end).
+ */
+static void EncodeChunk(void* context, int begin, int end)
+{
+    const ArrayTransform* transform = (const ArrayTransform*)context;
+    int size = transform->size;
+    int i, k;
+    uint32_t mask = size == 4 ? 0xffffffffu : (1u << (size * 8)) - 1;
+
+    for (i = begin; i < end; i++)
+    {
+        uint32_t value = LoadElement(transform->source + (size_t)i * (size_t)size, size);
+        if ((transform->flags & ARRAY_FLAG_DELTA) && i > 0)
+        {
+            value = (value - LoadElement(transform->source + (size_t)(i - 1) * (size_t)size, size)) & mask;
+        }
+        if (transform->flags & ARRAY_FLAG_SHUFFLE)
+        {
+            for (k = 0; k < size; k++)
+            {
+                transform->target[(size_t)k * transform->count + (size_t)i] = (unsigned char)(value >> (k * 8));
+            }
+        }
+        else
+        {
+            StoreElement(transform->target + (size_t)i * (size_t)size, size, value);
+        }
+    }
+}
+
+/*
+ * Unshuffle elements [begin, end); deltas are summed afterwards.
+ */
+static void UnshuffleChunk(void* context, int begin, int end)
+{
+    const ArrayTransform* transform = (const ArrayTransform*)context;
+    int size = transform->size;
+    int i, k;
+
+    for (i = begin; i < end; i++)
+    {
+        for (k = 0; k < size; k++)
+        {
+            transform->target[(size_t)i * (size_t)size + (size_t)k] =
+                transform->source[(size_t)k * transform->count + (size_t)i];
+        }
+    }
+}
+
+static void SumDeltas(unsigned char* data, size_t count, int size)
+{
+    size_t i;
+    if (size == 1)
+    {
+        for (i = 1; i < count; i++)
+        {
+            data[i] = (unsigned char)(data[i] + data[i - 1]);
+        }
+    }
+    else if (size == 2)
+    {
+        uint16_t* values = (uint16_t*)data;
+        for (i = 1; i < count; i++)
+        {
+            values[i] = (uint16_t)(values[i] + values[i - 1]);
+        }
+    }
+    else
+    {
+        uint32_t* values = (uint32_t*)data;
+        for (i = 1; i < count; i++)
+        {
+            values[i] += values[i - 1];
+        }
+    }
+}
+
+/*
+ * Compress one piece, with the 32KB before it as dictionary.
+ */
+static void DeflatePieces(void* context, int begin, int end)
+{
+    ArrayDeflate* deflate = (ArrayDeflate*)context;
+    int index;
+
+    for (index = begin; index < end; index++)
+    {
+        ArrayPiece* piece = &deflate->pieces[index];
+        size_t start = (size_t)index * ARRAY_PIECE_SIZE;
+        size_t length = deflate->length - start < ARRAY_PIECE_SIZE ? deflate->length - start : ARRAY_PIECE_SIZE;
+        size_t dictionary = start < DEFLATE_WINDOW_SIZE ? start : DEFLATE_WINDOW_SIZE;
+
+        piece->adler = DeflateAdler32(1, deflate->data + start, length);
+        piece->ok = DeflateCompress(deflate->data + start - dictionary, dictionary, dictionary + length,
+            ARRAY_DEFLATE_LEVEL, index == deflate->piece_count - 1, &piece->output);
+    }
+}
+
+/*
+ * Write data as a zlib stream to output. Returns the stream length, or 0
+ * if out of memory or it does not fit.
+ */
+static size_t WriteZlib(const unsigned char* data, size_t length, unsigned char* output, size_t capacity)
+{
+    ArrayDeflate deflate;
+    size_t written = 0;
+    uint32_t adler = 1;
+    int index, ok = 1;
+
+    deflate.data = data;
+    deflate.length = length;
+    deflate.piece_count = length == 0 ? 1 : (int)((length - 1) / ARRAY_PIECE_SIZE + 1);
+    deflate.pieces = (ArrayPiece*)calloc((size_t)deflate.piece_count, sizeof(ArrayPiece));
+    if (deflate.pieces == NULL || capacity < 6)
+    {
+        free(deflate.pieces);
+        return 0;
+    }
+    WorkerParallelFor(deflate.piece_count, 1, DeflatePieces, &deflate);
+
+    output[written++] = 0x78;       /* Deflate, 32KB window */
+    output[written++] = 0x5e;       /* Default-ish level, check bits */
+    for (index = 0; index < deflate.piece_count; index++)
+    {
+        ArrayPiece* piece = &deflate.pieces[index];
+        size_t piece_length = index == deflate.piece_count - 1
+            ? length - (size_t)index * ARRAY_PIECE_SIZE : ARRAY_PIECE_SIZE;
+        if (!piece->ok || capacity - written < piece->output.length + 4)
+        {
+            ok = 0;
+        }
+        else
+        {
+            memcpy(output + written, piece->output.data, piece->output.length);
+            written += piece->output.length;
+            adler = DeflateAdler32Combine(adler, piece->adler, piece_length);
+        }
+        free(piece->output.data);
+    }
+    free(deflate.pieces);
+    if (!ok)
+    {
+        return 0;
+    }
+
+    output[written++] = (unsigned char)(adler >> 24);
+    output[written++] = (unsigned char)(adler >> 16);
+    output[written++] = (unsigned char)(adler >> 8);
+    output[written++] = (unsigned char)adler;
+    return written;
+}
+
+/*
+ * Get an upper bound of the encoded size of an array.
+ */
+EXPORT int TypedArrayBound(int type, const int* shape, int rank)
+{
+    int size = ElementSize(type);
+    size_t count = ShapeCount(shape, rank, size);
+    size_t raw;
+
+    if (count == 0)
+    {
+        return -1;
+    }
+    /* Stored-block framing, the sync flush of every piece and the zlib wrapper */
+    raw = count * (size_t)size;
+    raw += raw / 8192 + (raw / ARRAY_PIECE_SIZE + 1) * 16 + 64;
+    return raw + HeaderLength(rank) > 0x7fffffff ? -1 : (int)(raw + HeaderLength(rank));
+}
+
+/*
+ * Encode an array in the typed array format.
+ */
+EXPORT int EncodeTypedArray(const void* data, int type, const int* shape, int rank, int flags,
+    unsigned char* output, int capacity)
+{
+    int size = ElementSize(type);
+    size_t count = ShapeCount(shape, rank, size);
+    size_t header = HeaderLength(rank);
+    size_t raw, payload;
+    unsigned char* transformed = NULL;
+    const unsigned char* bytes = (const unsigned char*)data;
+    int axis;
+
+    if (data == NULL || output == NULL || count == 0 || (flags & ~7) != 0 || capacity < 0 ||
+        (size_t)capacity < header)
+    {
+        return -1;
+    }
+    raw = count * (size_t)size;
+
+    memcpy(output, ARRAY_MAGIC, 4);
+    output[4] = ARRAY_VERSION;
+    output[5] = (unsigned char)type;
+    output[6] = (unsigned char)flags;
+    output[7] = (unsigned char)rank;
+    for (axis = 0; axis < rank; axis++)
+    {
+        StoreElement(output + 8 + axis * 4, 4, (uint32_t)shape[axis]);
+    }
+
+    if (flags & (ARRAY_FLAG_DELTA | ARRAY_FLAG_SHUFFLE))
+    {
+        ArrayTransform transform;
+
+        /* Without deflate the transformed elements go straight to the output */
+        if (flags & ARRAY_FLAG_DEFLATE)
+        {
+            transformed = (unsigned char*)malloc(raw);
+            if (transformed == NULL)
+            {
+                return -1;
+            }
+        }
+        else if ((size_t)capacity - header < raw)
+        {
+            return -1;
+        }
+        transform.source = bytes;
+        transform.target = transformed != NULL ? transformed : output + header;
+        transform.count = count;
+        transform.size = size;
+        transform.flags = flags;
+        WorkerParallelFor((int)count, TRANSFORM_CHUNK, EncodeChunk, &transform);
+        bytes = transform.target;
+    }
+
+    if (flags & ARRAY_FLAG_DEFLATE)
+    {
+        payload = WriteZlib(bytes, raw, output + header, (size_t)capacity - header);
+        free(transformed);
+        if (payload == 0)
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        if ((size_t)capacity - header < raw)
+        {
+            return -1;
+        }
+        if (bytes != output + header)
+        {
+            memcpy(output + header, bytes, raw);
+        }
+        payload = raw;
+    }
+    return (int)(header + payload);
+}
+
+/*
+ * Parse the header of an encoded array.
+ */
+EXPORT int ReadTypedArrayHeader(const unsigned char* encoded, int length, int* header)
+{
+    int rank, axis, size;
+    int shape[ARRAY_MAX_RANK];
+    size_t count;
+
+    if (encoded == NULL || length < 8 || memcmp(encoded, ARRAY_MAGIC, 4) != 0 || encoded[4] != ARRAY_VERSION)
+    {
+        return -1;
+    }
+    size = ElementSize(encoded[5]);
+    rank = encoded[7];
+    if (size == 0 || (encoded[6] & ~7) != 0 || rank < 1 || rank > ARRAY_MAX_RANK ||
+        (size_t)length < HeaderLength(rank))
+    {
+        return -1;
+    }
+    for (axis = 0; axis < rank; axis++)
+    {
+        uint32_t extent = LoadElement(encoded + 8 + axis * 4, 4);
+        shape[axis] = extent > 0x7fffffff ? -1 : (int)extent;
+    }
+    count = ShapeCount(shape, rank, size);
+    if (count == 0)
+    {
+        return -1;
+    }
+
+    if (header != NULL)
+    {
+        header[0] = encoded[5];
+        header[1] = encoded[6];
+        header[2] = rank;
+        for (axis = 0; axis < ARRAY_MAX_RANK; axis++)
+        {
+            header[3 + axis] = axis < rank ? shape[axis] : 0;
+        }
+    }
+    return (int)count;
+}
+
+/*
+ * Decode an encoded array into its elements.
+ */
+EXPORT int DecodeTypedArray(const unsigned char* encoded, int length, void* output, int capacity)
+{
+    int header[ARRAY_HEADER_FIELDS];
+    int count = ReadTypedArrayHeader(encoded, length, header);
+    int size, flags;
+    size_t raw, offset;
+    const unsigned char* payload;
+    size_t payload_length;
+    unsigned char* inflated = NULL;
+
+    if (count < 0 || output == NULL)
+    {
+        return -1;
+    }
+    size = ElementSize(header[0]);
+    flags = header[1];
+    raw = (size_t)count * (size_t)size;
+    if (capacity < 0 || (size_t)capacity < raw)
+    {
+        return -1;
+    }
+    offset = HeaderLength(header[2]);
+    payload = encoded + offset;
+    payload_length = (size_t)length - offset;
+
+    if (flags & ARRAY_FLAG_DEFLATE)
+    {
+        size_t consumed = 0;
+        uint32_t adler;
+        unsigned char* target = (flags & ARRAY_FLAG_SHUFFLE) ? NULL : (unsigned char*)output;
+
+        /* zlib header: deflate with a window of at most 32KB, no preset dictionary */
+        if (payload_length < 6 || (payload[0] & 0x0f) != 8 || (payload[0] >> 4) > 7 || (payload[1] & 0x20) != 0 ||
+            ((payload[0] << 8) | payload[1]) % 31 != 0)
+        {
+            return -1;
+        }
+        if (target == NULL)
+        {
+            target = inflated = (unsigned char*)malloc(raw);
+            if (inflated == NULL)
+            {
+                return -1;
+            }
+        }
+        if (!DeflateDecompress(payload + 2, payload_length - 2, target, raw, &consumed) ||
+            payload_length - 2 - consumed < 4)
+        {
+            free(inflated);
+            return -1;
+        }
+        adler = LoadElement(payload + 2 + consumed, 4);
+        adler = (adler >> 24) | ((adler >> 8) & 0xff00) | ((adler << 8) & 0xff0000) | (adler << 24);
+        if (adler != DeflateAdler32(1, target, raw))
+        {
+            free(inflated);
+            return -1;
+        }
+        payload = target;
+    }
+    else if (payload_length < raw)
+    {
+        return -1;
+    }
+
+    if (flags & ARRAY_FLAG_SHUFFLE)
+    {
+        ArrayTransform transform;
+        transform.source = payload;
+        transform.target = (unsigned char*)output;
+        transform.count = (size_t)count;
+        transform.size = size;
+        transform.flags = flags;
+        WorkerParallelFor(count, TRANSFORM_CHUNK, UnshuffleChunk, &transform);
+    }
+    else if (payload != (const unsigned char*)output)
+    {
+        memcpy(output, payload, raw);
+    }
+    free(inflated);
+
+    if (flags & ARRAY_FLAG_DELTA)
+    {
+        SumDeltas((unsigned char*)output, (size_t)count, size);
+    }
+    return count;
+}
@@ -0,0 +1,49 @@
+/*
+ * UnixxtyMCP Proxy - Typed array transfer format
+ *
+ * Large numeric arrays (terrain heightmaps, alphamaps) travel as binary
+ * blobs instead of JSON number lists. An encoded array is a small header
+ * followed by the elements, little-endian, row-major (last axis fastest):
+ *
+ *   offset 0   "UMTA"
+ *          4   version (1)
+ *          5   element type (ARRAY_TYPE_*)
+ *          6   flags (ARRAY_FLAG_*)
+ *          7   rank, 1 to ARRAY_MAX_RANK
+ *          8   rank uint32 extents
+ *          ... payload
+ *
+ * Flags apply in order when encoding and in reverse when decoding:
+ * ARRAY_FLAG_DELTA replaces each element by its difference from the
+ * previous one (as unsigned integers of the element's width, wrapping, so
+ * float bit patterns round-trip exactly); ARRAY_FLAG_SHUFFLE stores byte 0
+ * of every element, then byte 1, and so on; ARRAY_FLAG_DEFLATE wraps the
+ * result in a zlib stream. Smooth data such as heightmaps turns into runs
+ * of near-zero high bytes that deflate well. The zlib stream is compressed
+ * in pieces on the worker pool (see deflate.h) but is one ordinary stream,
+ * so any zlib can read it.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_ARRAYS_H
+#define UNITY_MCP_ARRAYS_H
+
+#define ARRAY_MAGIC "UMTA"
+#define ARRAY_VERSION 1
+#define ARRAY_MAX_RANK 4
+#define ARRAY_HEADER_FIELDS (3 + ARRAY_MAX_RANK)    /* For ReadTypedArrayHeader() */
+
+#define ARRAY_TYPE_UINT8 1
+#define ARRAY_TYPE_UINT16 2
+#define ARRAY_TYPE_INT32 3
+#define ARRAY_TYPE_FLOAT32 4
+
+#define ARRAY_FLAG_DELTA 1
+#define ARRAY_FLAG_SHUFFLE 2
+#define ARRAY_FLAG_DEFLATE 4
+
+#define ARRAY_DEFLATE_LEVEL 4
+#define ARRAY_PIECE_SIZE (1024 * 1024)              /* Bytes deflated per worker task */
+
+#endif /* UNITY_MCP_ARRAYS_H */
@@ -0,0 +1,1375 @@
+/*
+ * UnixxtyMCP Proxy - Asset GUID index
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "assets.h"
+#include "project.h"
+#include "jsonutil.h"
+#include "workers.h"
+#include "platform.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GUID_LENGTH ASSETS_GUID_LENGTH
+#define SCRIPT_CLASS_ID 114           /* MonoBehaviour: the root of a ScriptableObject .asset */
+
+typedef struct AssetType
+{
+    const char* key;                  /* Extension or importer */
+    const char* type;
+    const char* base;                 /* Also matched by "t:", or NULL */
+} AssetType;
+
+/* Main asset types by extension, as FindAssets() names them */
+static const AssetType EXTENSION_TYPES[] = {
+    { ".png", "Texture2D", "Texture" }, { ".jpg", "Texture2D", "Texture" }, { ".jpeg", "Texture2D", "Texture" },
+    { ".tga", "Texture2D", "Texture" }, { ".psd", "Texture2D", "Texture" }, { ".tif", "Texture2D", "Texture" },
+    { ".tiff", "Texture2D", "Texture" }, { ".gif", "Texture2D", "Texture" }, { ".bmp", "Texture2D", "Texture" },
+    { ".exr", "Texture2D", "Texture" }, { ".hdr", "Texture2D", "Texture" }, { ".iff", "Texture2D", "Texture" },
+    { ".pict", "Texture2D", "Texture" },
+    { ".rendertexture", "RenderTexture", "Texture" }, { ".cubemap", "Cubemap", "Texture" },
+    { ".mat", "Material", NULL },
+    { ".prefab", "Prefab", "GameObject" },
+    { ".fbx", "Model", "GameObject" }, { ".obj", "Model", "GameObject" }, { ".blend", "Model", "GameObject" },
+    { ".dae", "Model", "GameObject" }, { ".3ds", "Model", "GameObject" }, { ".max", "Model", "GameObject" },
+    { ".ma", "Model", "GameObject" }, { ".mb", "Model", "GameObject" },
+    { ".unity", "Scene", "SceneAsset" },
+    { ".shader", "Shader", NULL }, { ".shadergraph", "Shader", NULL },
+    { ".compute", "ComputeShader", NULL },
+    { ".cginc", "ShaderInclude", NULL }, { ".hlsl", "ShaderInclude", NULL },
+    { ".cs", "MonoScript", "TextAsset" },
+    { ".asmdef", "AssemblyDefinitionAsset", "TextAsset" },
+    { ".asmref", "AssemblyDefinitionReferenceAsset", "TextAsset" },
+    { ".controller", "AnimatorController", "RuntimeAnimatorController" },
+    { ".overridecontroller", "AnimatorOverrideController", "RuntimeAnimatorController" },
+    { ".anim", "AnimationClip", NULL }, { ".mask", "AvatarMask", NULL },
+    { ".wav", "AudioClip", NULL }, { ".mp3", "AudioClip", NULL }, { ".ogg", "AudioClip", NULL },
+    { ".aif", "AudioClip", NULL }, { ".aiff", "AudioClip", NULL }, { ".flac", "AudioClip", NULL },
+    { ".mod", "AudioClip", NULL }, { ".it", "AudioClip", NULL }, { ".s3m", "AudioClip", NULL },
+    { ".xm", "AudioClip", NULL },
+    { ".mixer", "AudioMixerController", "AudioMixer" },
+    { ".mp4", "VideoClip", NULL }, { ".mov", "VideoClip", NULL }, { ".webm", "VideoClip", NULL },
+    { ".avi", "VideoClip", NULL }, { ".m4v", "VideoClip", NULL }, { ".mpg", "VideoClip", NULL },
+    { ".mpeg", "VideoClip", NULL }, { ".ogv", "VideoClip", NULL }, { ".wmv", "VideoClip", NULL },
+    { ".ttf", "Font", NULL }, { ".otf", "Font", NULL }, { ".fontsettings", "Font", NULL },
+    { ".physicmaterial", "PhysicMaterial", NULL }, { ".physicsmaterial2d", "PhysicsMaterial2D", NULL },
+    { ".flare", "Flare", NULL }, { ".guiskin", "GUISkin", NULL }, { ".spriteatlas", "SpriteAtlas", NULL },
+    { ".terrainlayer", "TerrainLayer", NULL }, { ".lighting", "LightingSettings", NULL },
+    { ".giparams", "LightmapParameters", NULL }, { ".preset", "Preset", NULL },
+    { ".inputactions", "InputActionAsset", "ScriptableObject" },
+    { ".uxml", "VisualTreeAsset", "ScriptableObject" }, { ".uss", "StyleSheet", "ScriptableObject" },
+    { ".playable", "TimelineAsset", "ScriptableObject" }, { ".signal", "SignalAsset", "ScriptableObject" },
+    { ".vfx", "VisualEffectAsset", NULL },
+    { ".txt", "TextAsset", NULL }, { ".json", "TextAsset", NULL }, { ".bytes", "TextAsset", NULL },
+    { ".xml", "TextAsset", NULL }, { ".csv", "TextAsset", NULL }, { ".yaml", "TextAsset", NULL },
+    { ".yml", "TextAsset", NULL }, { ".html", "TextAsset", NULL }, { ".htm", "TextAsset", NULL },
+    { ".md", "TextAsset", NULL }, { ".fnt", "TextAsset", NULL },
+};
+
+/* Types of extensions missing above, by the importer their .meta names */
+static const AssetType IMPORTER_TYPES[] = {
+    { "TextureImporter", "Texture2D", "Texture" },
+    { "IHVImageFormatImporter", "Texture2D", "Texture" },
+    { "ModelImporter", "Model", "GameObject" },
+    { "AudioImporter", "AudioClip", NULL },
+    { "VideoClipImporter", "VideoClip", NULL },
+    { "TrueTypeFontImporter", "Font", NULL },
+    { "ShaderImporter", "Shader", NULL },
+    { "TextScriptImporter", "TextAsset", NULL },
+    { "MonoImporter", "MonoScript", "TextAsset" },
+};
+
+/* The class of the first object in a text-serialized .asset ("--- !u!28 &...") */
+static const struct
+{
+    int class_id;
+    const char* type;
+    const char* base;
+} CLASS_TYPES[] = {
+    { 21, "Material", NULL }, { 28, "Texture2D", "Texture" }, { 43, "Mesh", NULL },
+    { 62, "PhysicsMaterial2D", NULL }, { 74, "AnimationClip", NULL }, { 84, "RenderTexture", "Texture" },
+    { 89, "Cubemap", "Texture" }, { 90, "Avatar", NULL },
+    { 91, "AnimatorController", "RuntimeAnimatorController" }, { 117, "Texture3D", "Texture" },
+    { 134, "PhysicMaterial", NULL }, { 156, "TerrainData", NULL }, { 187, "Texture2DArray", "Texture" },
+    { 213, "Sprite", NULL }, { 221, "AnimatorOverrideController", "RuntimeAnimatorController" },
+    { 319, "AvatarMask", NULL }, { 1113, "LightmapParameters", NULL },
+};
+
+typedef struct AssetEntry
+{
+    int references;                   /* Indexes holding it; guarded by s_assets_lock */
+    char* path;                       /* Of the asset, without ".meta" */
+    uint64_t meta_size;
+    int64_t meta_modified;
+    uint64_t asset_size;              /* Of an .asset file, whose class is read too */
+    int64_t asset_modified;
+    char guid[GUID_LENGTH + 1];       /* Empty if the .meta could not be read */
+    char importer[64];
+    const char* type;                 /* NULL if unknown */
+    const char* base;
+    char script_guid[GUID_LENGTH + 1];  /* ScriptableObject .asset files: their script */
+    char* labels;                     /* '\n'-separated, or NULL */
+} AssetEntry;
+
+typedef struct AssetIndex
+{
+    int references;
+    unsigned generation;              /* Project root generation it was built for */
+    AssetEntry** entries;             /* Sorted by path */
+    int count;
+    int guid_count;
+    int folder_count;
+    int duplicate_count;              /* GUIDs held by more than one .meta; the first path wins */
+    uint32_t* slots;                  /* Open addressing by GUID; entry index + 1, 0 when empty */
+    uint32_t capacity;                /* Power of two */
+    uint64_t built_at;
+    uint64_t build_ms;
+} AssetIndex;
+
+static ProxyMutex s_assets_lock = PROXY_MUTEX_INITIALIZER;
+static AssetIndex* s_assets_index = NULL;
+static int s_assets_running = 0;
+static int s_assets_again = 0;
+static char s_assets_stats_buffer[256];
+
+static unsigned char FoldByte(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + 32) : c;
+}
+
+static int EqualsFolded(const char* a, const char* b)
+{
+    while (*a != '\0' && FoldByte((unsigned char)*a) == FoldByte((unsigned char)*b))
+    {
+        a++;
+        b++;
+    }
+    return *a == '\0' && *b == '\0';
+}
+
+static int HasSuffix(const char* text, const char* suffix)
+{
+    size_t length = strlen(text);
+    size_t suffix_length = strlen(suffix);
+    return length >= suffix_length && strcmp(text + length - suffix_length, suffix) == 0;
+}
+
+static int IsGuid(const char* p)
+{
+    int i;
+    for (i = 0; i < GUID_LENGTH; i++)
+    {
+        if (!((p[i] >= '0' && p[i] <= '9') || (p[i] >= 'a' && p[i] <= 'f')))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static uint32_t GuidSlot(const char* guid, uint32_t capacity)
+{
+    /* GUIDs are random: their first 16 digits make a good hash */
+    uint64_t value = 0;
+    int i;
+    for (i = 0; i < 16; i++)
+    {
+        value = (value << 4) | (uint64_t)(guid[i] <= '9' ? guid[i] - '0' : guid[i] - 'a' + 10);
+    }
+    return (uint32_t)((value * 0x9e3779b97f4a7c15ull) >> 32) & (capacity - 1);
+}
+
+/*
+ * Entries and indexes
+ */
+
+static void ReleaseEntry(AssetEntry* entry)
+{
+    int last;
+
+    PROXY_MUTEX_LOCK(&s_assets_lock);
+    last = --entry->references == 0;
+    PROXY_MUTEX_UNLOCK(&s_assets_lock);
+    if (last)
+    {
+        free(entry->path);
+        free(entry->labels);
+        free(entry);
+    }
+}
+
+static void ReleaseIndex(AssetIndex* index)
+{
+    int last;
+    int i;
+
+    if (index == NULL)
+    {
+        return;
+    }
+    PROXY_MUTEX_LOCK(&s_assets_lock);
+    last = --index->references == 0;
+    PROXY_MUTEX_UNLOCK(&s_assets_lock);
+    if (!last)
+    {
+        return;
+    }
+    for (i = 0; i < index->count; i++)
+    {
+        ReleaseEntry(index->entries[i]);
+    }
+    free(index->entries);
+    free(index->slots);
+    free(index);
+}
+
+static AssetIndex* AcquireIndex(void)
+{
+    AssetIndex* index;
+
+    PROXY_MUTEX_LOCK(&s_assets_lock);
+    index = s_assets_index;
+    if (index != NULL)
+    {
+        index->references++;
+    }
+    PROXY_MUTEX_UNLOCK(&s_assets_lock);
+    return index;
+}
+
+static AssetEntry* FindGuid(const AssetIndex* index, const char* guid)
+{
+    uint32_t slot;
+
+    if (strlen(guid) != GUID_LENGTH || !IsGuid(guid))
+    {
+        return NULL;
+    }
+    for (slot = GuidSlot(guid, index->capacity); index->slots[slot] != 0; slot = (slot + 1) & (index->capacity - 1))
+    {
+        AssetEntry* entry = index->entries[index->slots[slot] - 1];
+        if (memcmp(entry->guid, guid, GUID_LENGTH) == 0)
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static AssetEntry* FindPath(const AssetIndex* index, const char* path)
+{
+    int low = 0;
+    int high = index->count - 1;
+
+    while (low <= high)
+    {
+        int middle = low + (high - low) / 2;
+        int order = strcmp(index->entries[middle]->path, path);
+        if (order == 0)
+        {
+            return index->entries[middle];
+        }
+        if (order < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Parsing
+ */
+
+static const char* LineEnd(const char* p, const char* end)
+{
+    const char* newline = (const char*)memchr(p, '\n', (size_t)(end - p));
+    return newline != NULL ? newline : end;
+}
+
+/*
+ * Length of a line without its trailing whitespace.
+ */
+static size_t TrimmedLength(const char* line, const char* line_end)
+{
+    while (line_end > line && (line_end[-1] == '\r' || line_end[-1] == ' ' || line_end[-1] == '\t'))
+    {
+        line_end--;
+    }
+    return (size_t)(line_end - line);
+}
+
+static void AddLabel(AssetEntry* entry, const char* label, size_t length)
+{
+    size_t used = entry->labels != NULL ? strlen(entry->labels) : 0;
+    char* labels = (char*)realloc(entry->labels, used + length + 2);
+
+    if (labels == NULL)
+    {
+        return;
+    }
+    if (used > 0)
+    {
+        labels[used++] = '\n';
+    }
+    memcpy(labels + used, label, length);
+    labels[used + length] = '\0';
+    entry->labels = labels;
+}
+
+/*
+ * Read the GUID, importer and labels of an entry's .meta file. The keys
+ * Unity writes first (fileFormatVersion, guid, labels, folderAsset) are
+ * lowercase; the importer is the first capitalized top-level key.
+ */
+static int ParseMeta(AssetEntry* entry)
+{
+    char meta_path[PROJECT_MAX_PATH];
+    size_t length = 0;
+    char* data;
+    const char* p;
+    const char* end;
+    int in_labels = 0;
+    int folder = 0;
+
+    if ((size_t)snprintf(meta_path, sizeof(meta_path), "%s.meta", entry->path) >= sizeof(meta_path) ||
+        (data = ProjectReadHead(meta_path, ASSETS_HEAD_SIZE, &length)) == NULL)
+    {
+        return 0;
+    }
+    end = data + length;
+    for (p = data; p < end; )
+    {
+        const char* line_end = LineEnd(p, end);
+        size_t line_length = TrimmedLength(p, line_end);
+
+        if (in_labels && line_length > 2 && p[0] == '-' && p[1] == ' ')
+        {
+            AddLabel(entry, p + 2, line_length - 2);
+        }
+        else
+        {
+            in_labels = 0;
+            if (line_length >= 6 + GUID_LENGTH && memcmp(p, "guid: ", 6) == 0 && IsGuid(p + 6))
+            {
+                memcpy(entry->guid, p + 6, GUID_LENGTH);
+                entry->guid[GUID_LENGTH] = '\0';
+            }
+            else if (line_length == 7 && memcmp(p, "labels:", 7) == 0)
+            {
+                in_labels = 1;
+            }
+            else if (line_length == 16 && memcmp(p, "folderAsset: yes", 16) == 0)
+            {
+                folder = 1;
+            }
+            else if (line_length > 1 && p[0] >= 'A' && p[0] <= 'Z' && p[line_length - 1] == ':' &&
+                     line_length - 1 < sizeof(entry->importer))
+            {
+                memcpy(entry->importer, p, line_length - 1);
+                entry->importer[line_length - 1] = '\0';
+                break;
+            }
+        }
+        p = line_end + 1;
+    }
+    free(data);
+
+    if (folder)
+    {
+        entry->type = "Folder";
+        entry->base = "DefaultAsset";
+    }
+    return entry->guid[0] != '\0';
+}
+
+/*
+ * Type a text-serialized .asset by the class of its first object; for a
+ * ScriptableObject, remember its script so the type can be named after it.
+ */
+static void ParseAssetClass(AssetEntry* entry)
+{
+    size_t length = 0;
+    char* data = ProjectReadHead(entry->path, ASSETS_HEAD_SIZE, &length);
+    const char* header;
+    long class_id;
+    size_t i;
+
+    if (data == NULL)
+    {
+        return;
+    }
+    if (strncmp(data, "%YAML", 5) != 0 || (header = strstr(data, "--- !u!")) == NULL)
+    {
+        free(data);  /* Binary serialization */
+        return;
+    }
+    class_id = strtol(header + 7, NULL, 10);
+    if (class_id == SCRIPT_CLASS_ID)
+    {
+        const char* script = strstr(header, "m_Script:");
+        const char* line_end = script != NULL ? strchr(script, '\n') : NULL;
+        const char* guid = script != NULL ? strstr(script, "guid: ") : NULL;
+
+        entry->type = "ScriptableObject";
+        if (guid != NULL && (line_end == NULL || guid < line_end) && strlen(guid + 6) >= GUID_LENGTH &&
+            IsGuid(guid + 6))
+        {
+            memcpy(entry->script_guid, guid + 6, GUID_LENGTH);
+            entry->script_guid[GUID_LENGTH] = '\0';
+        }
+    }
+    for (i = 0; i < sizeof(CLASS_TYPES) / sizeof(CLASS_TYPES[0]); i++)
+    {
+        if (CLASS_TYPES[i].class_id == class_id)
+        {
+            entry->type = CLASS_TYPES[i].type;
+            entry->base = CLASS_TYPES[i].base;
+        }
+    }
+    free(data);
+}
+
+static void ParseEntry(AssetEntry* entry)
+{
+    const char* slash = strrchr(entry->path, '/');
+    const char* extension = strrchr(slash != NULL ? slash : entry->path, '.');
+    size_t i;
+
+    entry->guid[0] = '\0';
+    entry->importer[0] = '\0';
+    entry->script_guid[0] = '\0';
+    entry->type = NULL;
+    entry->base = NULL;
+    free(entry->labels);
+    entry->labels = NULL;
+    if (!ParseMeta(entry) || entry->type != NULL)
+    {
+        return;
+    }
+
+    if (extension != NULL && strcmp(extension, ".asset") == 0)
+    {
+        ParseAssetClass(entry);
+        return;
+    }
+    for (i = 0; extension != NULL && i < sizeof(EXTENSION_TYPES) / sizeof(EXTENSION_TYPES[0]); i++)
+    {
+        if (EqualsFolded(EXTENSION_TYPES[i].key, extension))
+        {
+            entry->type = EXTENSION_TYPES[i].type;
+            entry->base = EXTENSION_TYPES[i].base;
+            return;
+        }
+    }
+    for (i = 0; i < sizeof(IMPORTER_TYPES) / sizeof(IMPORTER_TYPES[0]); i++)
+    {
+        if (strcmp(IMPORTER_TYPES[i].key, entry->importer) == 0)
+        {
+            entry->type = IMPORTER_TYPES[i].type;
+            entry->base = IMPORTER_TYPES[i].base;
+            return;
+        }
+    }
+}
+
+typedef struct ParseJob
+{
+    AssetEntry** entries;
+} ParseJob;
+
+static void ParseRange(void* context, int begin, int end)
+{
+    ParseJob* job = (ParseJob*)context;
+    int i;
+
+    for (i = begin; i < end; i++)
+    {
+        ParseEntry(job->entries[i]);
+    }
+}
+
+/*
+ * Scanning
+ */
+
+typedef struct AssetStamp
+{
+    char* path;
+    uint64_t size;
+    int64_t modified;
+} AssetStamp;
+
+typedef struct ScanState
+{
+    AssetEntry** entries;
+    int count;
+    int capacity;
+    AssetStamp* stamps;               /* .asset files */
+    int stamp_count;
+    int stamp_capacity;
+} ScanState;
+
+static int GrowArray(void** items, int* capacity, size_t item_size)
+{
+    int grown_capacity = *capacity > 0 ? *capacity * 2 : 4096;
+    void* grown = realloc(*items, (size_t)grown_capacity * item_size);
+    if (grown == NULL)
+    {
+        return 0;
+    }
+    *items = grown;
+    *capacity = grown_capacity;
+    return 1;
+}
+
+static char* CopyText(const char* text, size_t length)
+{
+    char* copy = (char*)malloc(length + 1);
+    if (copy != NULL)
+    {
+        memcpy(copy, text, length);
+        copy[length] = '\0';
+    }
+    return copy;
+}
+
+static int CollectMeta(void* context, const char* path, uint64_t size, int64_t modified)
+{
+    ScanState* state = (ScanState*)context;
+    size_t length = strlen(path);
+
+    if (length > 5 && strcmp(path + length - 5, ".meta") == 0)
+    {
+        AssetEntry* entry;
+        if (state->count == state->capacity &&
+            !GrowArray((void**)&state->entries, &state->capacity, sizeof(AssetEntry*)))
+        {
+            return 0;
+        }
+        entry = (AssetEntry*)calloc(1, sizeof(AssetEntry));
+        if (entry == NULL || (entry->path = CopyText(path, length - 5)) == NULL)
+        {
+            free(entry);
+            return 0;
+        }
+        entry->references = 1;
+        entry->meta_size = size;
+        entry->meta_modified = modified;
+        state->entries[state->count++] = entry;
+    }
+    else if (length > 6 && strcmp(path + length - 6, ".asset") == 0)
+    {
+        AssetStamp* stamp;
+        if (state->stamp_count == state->stamp_capacity &&
+            !GrowArray((void**)&state->stamps, &state->stamp_capacity, sizeof(AssetStamp)))
+        {
+            return 0;
+        }
+        stamp = &state->stamps[state->stamp_count];
+        if ((stamp->path = CopyText(path, length)) == NULL)
+        {
+            return 0;
+        }
+        stamp->size = size;
+        stamp->modified = modified;
+        state->stamp_count++;
+    }
+    return 1;
+}
+
+static int CompareEntryPaths(const void* a, const void* b)
+{
+    return strcmp((*(AssetEntry* const*)a)->path, (*(AssetEntry* const*)b)->path);
+}
+
+static int CompareStampPaths(const void* a, const void* b)
+{
+    return strcmp(((const AssetStamp*)a)->path, ((const AssetStamp*)b)->path);
+}
+
+static const AssetStamp* FindStamp(const ScanState* state, const char* path)
+{
+    AssetStamp key;
+    if (state->stamp_count == 0)
+    {
+        return NULL;
+    }
+    key.path = (char*)path;
+    return (const AssetStamp*)bsearch(&key, state->stamps, (size_t)state->stamp_count, sizeof(AssetStamp),
+        CompareStampPaths);
+}
+
+/*
+ * Fill the GUID table; of entries sharing a GUID the first (by path) wins,
+ * as it is the one AssetDatabase most likely kept.
+ */
+static int BuildSlots(AssetIndex* index)
+{
+    int i;
+
+    index->capacity = 1024;
+    while (index->capacity < (uint32_t)index->count * 2)
+    {
+        index->capacity *= 2;
+    }
+    if ((index->slots = (uint32_t*)calloc(index->capacity, sizeof(uint32_t))) == NULL)
+    {
+        return 0;
+    }
+    for (i = 0; i < index->count; i++)
+    {
+        AssetEntry* entry = index->entries[i];
+        uint32_t slot;
+
+        if (entry->guid[0] == '\0')
+        {
+            continue;
+        }
+        for (slot = GuidSlot(entry->guid, index->capacity); index->slots[slot] != 0;
+             slot = (slot + 1) & (index->capacity - 1))
+        {
+            if (memcmp(index->entries[index->slots[slot] - 1]->guid, entry->guid, GUID_LENGTH) == 0)
+            {
+                break;
+            }
+        }
+        if (index->slots[slot] != 0)
+        {
+            index->duplicate_count++;
+            continue;
+        }
+        index->slots[slot] = (uint32_t)i + 1;
+        index->guid_count++;
+        index->folder_count += entry->type != NULL && strcmp(entry->type, "Folder") == 0;
+    }
+    return 1;
+}
+
+/*
+ * Walk the project and build a new index, reusing the entries of the
+ * previous one whose files did not change. Returns NULL if no root is
+ * configured or out of memory.
+ */
+static AssetIndex* BuildIndex(AssetIndex* previous)
+{
+    char root[PROJECT_MAX_PATH];
+    ScanState scan;
+    ParseJob job;
+    AssetIndex* index;
+    uint64_t started = mg_millis();
+    unsigned generation = ProjectRoot(root, sizeof(root));
+    int parse_count = 0;
+    int i;
+
+    memset(&scan, 0, sizeof(scan));
+    if (generation != 0 && ProjectWalk(CollectMeta, &scan) >= 0)
+    {
+        if (scan.count > 0)
+        {
+            qsort(scan.entries, (size_t)scan.count, sizeof(AssetEntry*), CompareEntryPaths);
+        }
+        if (scan.stamp_count > 0)
+        {
+            qsort(scan.stamps, (size_t)scan.stamp_count, sizeof(AssetStamp), CompareStampPaths);
+        }
+        job.entries = (AssetEntry**)malloc((size_t)(scan.count > 0 ? scan.count : 1) * sizeof(AssetEntry*));
+    }
+    else
+    {
+        generation = 0;
+        job.entries = NULL;
+    }
+
+    /* Take over the entries whose .meta (and .asset) did not change */
+    for (i = 0; i < scan.count && job.entries != NULL; i++)
+    {
+        AssetEntry* entry = scan.entries[i];
+        const AssetStamp* stamp = HasSuffix(entry->path, ".asset") ? FindStamp(&scan, entry->path) : NULL;
+        AssetEntry* old = previous != NULL && previous->generation == generation ? FindPath(previous, entry->path) : NULL;
+
+        if (stamp != NULL)
+        {
+            entry->asset_size = stamp->size;
+            entry->asset_modified = stamp->modified;
+        }
+        if (old != NULL && old->meta_size == entry->meta_size && old->meta_modified == entry->meta_modified &&
+            old->asset_size == entry->asset_size && old->asset_modified == entry->asset_modified)
+        {
+            PROXY_MUTEX_LOCK(&s_assets_lock);
+            old->references++;
+            PROXY_MUTEX_UNLOCK(&s_assets_lock);
+            ReleaseEntry(entry);
+            scan.entries[i] = old;
+        }
+        else
+        {
+            job.entries[parse_count++] = entry;
+        }
+    }
+    for (i = 0; i < scan.stamp_count; i++)
+    {
+        free(scan.stamps[i].path);
+    }
+    free(scan.stamps);
+
+    index = job.entries != NULL ? (AssetIndex*)calloc(1, sizeof(AssetIndex)) : NULL;
+    if (index == NULL)
+    {
+        for (i = 0; i < scan.count; i++)
+        {
+            ReleaseEntry(scan.entries[i]);
+        }
+        free(scan.entries);
+        free(job.entries);
+        return NULL;
+    }
+    WorkerParallelFor(parse_count, 64, ParseRange, &job);
+    free(job.entries);
+
+    index->references = 1;
+    index->generation = generation;
+    index->entries = scan.entries;
+    index->count = scan.count;
+    if (!BuildSlots(index))
+    {
+        ReleaseIndex(index);
+        return NULL;
+    }
+    index->built_at = mg_millis();
+    index->build_ms = index->built_at - started;
+    return index;
+}
+
+static void RebuildTask(void* context)
+{
+    (void)context;
+    for (;;)
+    {
+        AssetIndex* previous = AcquireIndex();
+        AssetIndex* index = BuildIndex(previous);
+        AssetIndex* replaced = NULL;
+        int again;
+
+        PROXY_MUTEX_LOCK(&s_assets_lock);
+        if (index != NULL)
+        {
+            replaced = s_assets_index;
+            s_assets_index = index;
+        }
+        again = s_assets_again;
+        s_assets_again = 0;
+        if (!again)
+        {
+            s_assets_running = 0;
+        }
+        PROXY_MUTEX_UNLOCK(&s_assets_lock);
+
+        ReleaseIndex(replaced);
+        ReleaseIndex(previous);
+        if (!again)
+        {
+            return;
+        }
+    }
+}
+
+/*
+ * Start a scan unless one is running; `again` schedules another one after it.
+ */
+static void StartScan(int again)
+{
+    int start;
+
+    PROXY_MUTEX_LOCK(&s_assets_lock);
+    start = !s_assets_running;
+    if (start)
+    {
+        s_assets_running = 1;
+    }
+    else if (again)
+    {
+        s_assets_again = 1;
+    }
+    PROXY_MUTEX_UNLOCK(&s_assets_lock);
+
+    if (start && !WorkerSubmit(RebuildTask, NULL))
+    {
+        PROXY_MUTEX_LOCK(&s_assets_lock);
+        s_assets_running = 0;
+        PROXY_MUTEX_UNLOCK(&s_assets_lock);
+    }
+}
+
+void AssetsRefresh(void)
+{
+    StartScan(1);
+}
+
+int AssetsAffectedBy(const char* path)
+{
+    return HasSuffix(path, ".meta") || HasSuffix(path, ".asset");
+}
+
+/*
+ * The index, if it was built for the configured root.
+ */
+static AssetIndex* AcquireCurrentIndex(void)
+{
+    char root[PROJECT_MAX_PATH];
+    AssetIndex* index = AcquireIndex();
+
+    if (index != NULL && index->generation != ProjectRoot(root, sizeof(root)))
+    {
+        ReleaseIndex(index);
+        index = NULL;
+    }
+    return index;
+}
+
+int AssetsFindGuid(const char* path, char* guid)
+{
+    AssetIndex* index = AcquireCurrentIndex();
+    const AssetEntry* entry = index != NULL ? FindPath(index, path) : NULL;
+    int found = entry != NULL && entry->guid[0] != '\0';
+
+    if (found)
+    {
+        memcpy(guid, entry->guid, GUID_LENGTH + 1);
+    }
+    ReleaseIndex(index);
+    return found;
+}
+
+int AssetsFindPath(const char* guid, char* path, size_t capacity)
+{
+    AssetIndex* index = AcquireCurrentIndex();
+    const AssetEntry* entry = index != NULL ? FindGuid(index, guid) : NULL;
+    int found = entry != NULL && strlen(entry->path) < capacity;
+
+    if (found)
+    {
+        memcpy(path, entry->path, strlen(entry->path) + 1);
+    }
+    ReleaseIndex(index);
+    return found;
+}
+
+/*
+ * Get asset index statistics as a JSON object.
+ */
+EXPORT const char* GetAssetIndexStats(void)
+{
+    AssetIndex* index = AcquireIndex();
+    int running;
+
+    PROXY_MUTEX_LOCK(&s_assets_lock);
+    running = s_assets_running;
+    PROXY_MUTEX_UNLOCK(&s_assets_lock);
+
+    if (index == NULL)
+    {
+        snprintf(s_assets_stats_buffer, sizeof(s_assets_stats_buffer), "{\"ready\":false,\"scanning\":%s}",
+            running ? "true" : "false");
+        return s_assets_stats_buffer;
+    }
+    snprintf(s_assets_stats_buffer, sizeof(s_assets_stats_buffer),
+        "{\"ready\":true,\"scanning\":%s,\"assets\":%d,\"folders\":%d,\"duplicate_guids\":%d,"
+        "\"build_ms\":%lu,\"age_ms\":%lu}",
+        running ? "true" : "false", index->guid_count, index->folder_count, index->duplicate_count,
+        (unsigned long)index->build_ms, (unsigned long)(mg_millis() - index->built_at));
+    ReleaseIndex(index);
+    return s_assets_stats_buffer;
+}
+
+/*
+ * Queries
+ */
+
+typedef struct AssetQuery
+{
+    struct mg_str types[ASSETS_MAX_FILTER_TERMS];
+    int type_count;
+    struct mg_str labels[ASSETS_MAX_FILTER_TERMS];
+    int label_count;
+    struct mg_str names[ASSETS_MAX_FILTER_TERMS];   /* Lowercase */
+    int name_count;
+    char* filter;                     /* Owns the terms */
+    char* folders[ASSETS_MAX_FILTER_TERMS];
+    int folder_count;
+    int max_results;
+} AssetQuery;
+
+/*
+ * The type an entry reports; a ScriptableObject is named after its script
+ * when that is indexed.
+ */
+static const char* EntryType(const AssetIndex* index, const AssetEntry* entry, char* buffer, size_t capacity)
+{
+    const AssetEntry* script;
+
+    if (entry->script_guid[0] != '\0' && (script = FindGuid(index, entry->script_guid)) != NULL &&
+        HasSuffix(script->path, ".cs"))
+    {
+        const char* name = strrchr(script->path, '/');
+        size_t length;
+
+        name = name != NULL ? name + 1 : script->path;
+        length = strlen(name) - 3;
+        if (length < capacity)
+        {
+            memcpy(buffer, name, length);
+            buffer[length] = '\0';
+            return buffer;
+        }
+    }
+    return entry->type;
+}
+
+static int ContainsFolded(const char* text, size_t length, struct mg_str needle)
+{
+    size_t i;
+    size_t j;
+
+    for (i = 0; i + needle.len <= length; i++)
+    {
+        for (j = 0; j < needle.len && FoldByte((unsigned char)text[i + j]) == (unsigned char)needle.buf[j]; j++)
+        {
+        }
+        if (j == needle.len)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int MatchesTerm(const char* value, struct mg_str term)
+{
+    size_t i;
+
+    if (value == NULL || strlen(value) != term.len)
+    {
+        return 0;
+    }
+    for (i = 0; i < term.len; i++)
+    {
+        if (FoldByte((unsigned char)value[i]) != FoldByte((unsigned char)term.buf[i]))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int HasLabel(const AssetEntry* entry, struct mg_str label)
+{
+    const char* p = entry->labels;
+
+    while (p != NULL && *p != '\0')
+    {
+        const char* end = strchr(p, '\n');
+        size_t length = end != NULL ? (size_t)(end - p) : strlen(p);
+        if (mg_strcasecmp(mg_str_n(p, length), label) == 0)
+        {
+            return 1;
+        }
+        p = end != NULL ? end + 1 : NULL;
+    }
+    return 0;
+}
+
+static int MatchesQuery(const AssetIndex* index, const AssetQuery* query, const AssetEntry* entry)
+{
+    const char* name;
+    const char* extension;
+    size_t name_length;
+    int i;
+
+    if (entry->guid[0] == '\0' || FindGuid(index, entry->guid) != entry)
+    {
+        return 0;
+    }
+    if (query->folder_count > 0)
+    {
+        for (i = 0; i < query->folder_count; i++)
+        {
+            size_t length = strlen(query->folders[i]);
+            if (strncmp(entry->path, query->folders[i], length) == 0 && entry->path[length] == '/')
+            {
+                break;
+            }
+        }
+        if (i == query->folder_count)
+        {
+            return 0;
+        }
+    }
+    if (query->type_count > 0)
+    {
+        char buffer[128];
+        const char* type = EntryType(index, entry, buffer, sizeof(buffer));
+        for (i = 0; i < query->type_count; i++)
+        {
+            /* A named ScriptableObject keeps its base type */
+            if (MatchesTerm(type, query->types[i]) || MatchesTerm(entry->base, query->types[i]) ||
+                (type != entry->type && MatchesTerm("ScriptableObject", query->types[i])))
+            {
+                break;
+            }
+        }
+        if (i == query->type_count)
+        {
+            return 0;
+        }
+    }
+    if (query->label_count > 0)
+    {
+        for (i = 0; i < query->label_count && !HasLabel(entry, query->labels[i]); i++)
+        {
+        }
+        if (i == query->label_count)
+        {
+            return 0;
+        }
+    }
+
+    name = strrchr(entry->path, '/');
+    name = name != NULL ? name + 1 : entry->path;
+    extension = strrchr(name, '.');
+    name_length = extension != NULL && extension != name ? (size_t)(extension - name) : strlen(name);
+    for (i = 0; i < query->name_count; i++)
+    {
+        if (!ContainsFolded(name, name_length, query->names[i]))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void AppendEntry(const AssetIndex* index, const AssetEntry* entry, struct mg_iobuf* out, int first)
+{
+    char buffer[128];
+    const char* type = EntryType(index, entry, buffer, sizeof(buffer));
+
+    mg_iobuf_add(out, out->len, first ? "{\"guid\":\"" : ",{\"guid\":\"", first ? 9 : 10);
+    mg_iobuf_add(out, out->len, entry->guid, GUID_LENGTH);
+    mg_iobuf_add(out, out->len, "\",\"path\":", 9);
+    JsonAppendString(out, entry->path, strlen(entry->path));
+    mg_iobuf_add(out, out->len, ",\"type\":", 8);
+    if (type != NULL)
+    {
+        JsonAppendString(out, type, strlen(type));
+    }
+    else
+    {
+        mg_iobuf_add(out, out->len, "null", 4);
+    }
+    mg_iobuf_add(out, out->len, ",\"importer\":", 12);
+    if (entry->importer[0] != '\0')
+    {
+        JsonAppendString(out, entry->importer, strlen(entry->importer));
+    }
+    else
+    {
+        mg_iobuf_add(out, out->len, "null", 4);
+    }
+    if (entry->labels != NULL)
+    {
+        const char* p = entry->labels;
+        mg_iobuf_add(out, out->len, ",\"labels\":[", 11);
+        while (p != NULL)
+        {
+            const char* end = strchr(p, '\n');
+            size_t length = end != NULL ? (size_t)(end - p) : strlen(p);
+            JsonAppendString(out, p, length);
+            if (end != NULL)
+            {
+                mg_iobuf_add(out, out->len, ",", 1);
+            }
+            p = end != NULL ? end + 1 : NULL;
+        }
+        mg_iobuf_add(out, out->len, "]", 1);
+    }
+    mg_iobuf_add(out, out->len, "}", 1);
+}
+
+static void FreeQuery(AssetQuery* query)
+{
+    int i;
+
+    free(query->filter);
+    for (i = 0; i < query->folder_count; i++)
+    {
+        free(query->folders[i]);
+    }
+}
+
+/*
+ * Copy a JSON string token into malloc'ed memory, or NULL if it is not one.
+ */
+static char* StringValue(struct mg_str token)
+{
+    char* value;
+    char* copy = NULL;
+
+    /* mongoose allocates from the pool (mg_free); the query owns malloc'd strings */
+    if (token.len > 0 && token.buf[0] == '"' && (value = mg_json_get_str(token, "$")) != NULL)
+    {
+        copy = CopyText(value, strlen(value));
+        mg_free(value);
+    }
+    return copy;
+}
+
+/*
+ * Split a FindAssets() filter into type, label and name terms.
+ */
+static const char* ParseFilter(AssetQuery* query)
+{
+    char* p = query->filter;
+
+    while (*p != '\0')
+    {
+        char* term;
+        size_t length;
+
+        while (*p == ' ' || *p == '\t')
+        {
+            p++;
+        }
+        term = p;
+        while (*p != '\0' && *p != ' ' && *p != '\t')
+        {
+            *p = (char)FoldByte((unsigned char)*p);
+            p++;
+        }
+        length = (size_t)(p - term);
+        if (length == 0)
+        {
+            break;
+        }
+        if (query->type_count + query->label_count + query->name_count == ASSETS_MAX_FILTER_TERMS)
+        {
+            return "Too many filter terms";
+        }
+        if (length > 2 && term[0] == 't' && term[1] == ':')
+        {
+            query->types[query->type_count++] = mg_str_n(term + 2, length - 2);
+        }
+        else if (length > 2 && term[0] == 'l' && term[1] == ':')
+        {
+            query->labels[query->label_count++] = mg_str_n(term + 2, length - 2);
+        }
+        else
+        {
+            query->names[query->name_count++] = mg_str_n(term, length);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Parse the filter params. Returns NULL or an error message.
+ */
+static const char* ParseQuery(struct mg_str request, AssetQuery* query)
+{
+    struct mg_str folders = mg_json_get_tok(request, "$.params.folders");
+    struct mg_str value;
+    long max_results;
+    size_t offset = 0;
+
+    memset(query, 0, sizeof(*query));
+    query->filter = StringValue(mg_json_get_tok(request, "$.params.filter"));
+    max_results = mg_json_get_long(request, "$.params.max_results", ASSETS_DEFAULT_RESULTS);
+    query->max_results = max_results < 1 ? 1 : max_results > ASSETS_MAX_RESULTS ? ASSETS_MAX_RESULTS : (int)max_results;
+
+    if (folders.len > 0 && folders.buf[0] == '"')
+    {
+        query->folders[query->folder_count++] = StringValue(folders);
+    }
+    else if (folders.len > 0)
+    {
+        while ((offset = mg_json_next(folders, offset, NULL, &value)) > 0)
+        {
+            if (query->folder_count == ASSETS_MAX_FILTER_TERMS)
+            {
+                return "Too many folders";
+            }
+            query->folders[query->folder_count++] = StringValue(value);
+        }
+    }
+    {
+        int i;
+        for (i = 0; i < query->folder_count; i++)
+        {
+            char* folder = query->folders[i];
+            size_t length;
+            if (folder == NULL)
+            {
+                return "folders must be strings";
+            }
+            length = strlen(folder);
+            while (length > 0 && folder[length - 1] == '/')
+            {
+                folder[--length] = '\0';
+            }
+        }
+    }
+    return query->filter != NULL ? ParseFilter(query) : NULL;
+}
+
+/*
+ * Resolve each string of a guids or paths param, appending the entries
+ * found and the values that are not to `missing`.
+ */
+static int ResolveList(const AssetIndex* index, struct mg_str list, int by_guid, struct mg_iobuf* result,
+    struct mg_iobuf* missing, int* count)
+{
+    struct mg_str value;
+    size_t offset = 0;
+    int single = list.len > 0 && list.buf[0] == '"';
+
+    while (single || (offset = mg_json_next(list, offset, NULL, &value)) > 0)
+    {
+        char* text = StringValue(single ? list : value);
+        const AssetEntry* entry = NULL;
+
+        if (text == NULL)
+        {
+            return 0;
+        }
+        if (by_guid)
+        {
+            entry = FindGuid(index, text);
+        }
+        else
+        {
+            char* p;
+            for (p = text; *p != '\0'; p++)
+            {
+                if (*p == '\\')
+                {
+                    *p = '/';
+                }
+            }
+            entry = FindPath(index, text);
+            if (entry != NULL && FindGuid(index, entry->guid) != entry)
+            {
+                entry = NULL;   /* A duplicate GUID: not the asset AssetDatabase knows */
+            }
+        }
+        if (entry != NULL)
+        {
+            AppendEntry(index, entry, result, (*count)++ == 0);
+        }
+        else
+        {
+            mg_iobuf_add(missing, missing->len, missing->len > 0 ? "," : "", missing->len > 0 ? 1 : 0);
+            JsonAppendString(missing, text, strlen(text));
+        }
+        free(text);
+        if (single)
+        {
+            break;
+        }
+    }
+    return 1;
+}
+
+int AssetsResolveMethod(struct mg_str request, struct mg_iobuf* result, const char** error)
+{
+    struct mg_str guids = mg_json_get_tok(request, "$.params.guids");
+    struct mg_str paths = mg_json_get_tok(request, "$.params.paths");
+    struct mg_iobuf missing = {0, 0, 0, 256};
+    AssetQuery query;
+    AssetIndex* index;
+    int count = 0;
+    int matched = 0;
+    int truncated = 0;
+    char summary[160];
+
+    if ((*error = ParseQuery(request, &query)) != NULL)
+    {
+        FreeQuery(&query);
+        return -32602;
+    }
+    if (guids.len == 0 && paths.len == 0 && query.filter == NULL)
+    {
+        FreeQuery(&query);
+        *error = "guids, paths or filter is required";
+        return -32602;
+    }
+
+    index = AcquireIndex();
+    if (index == NULL)
+    {
+        StartScan(0);
+    }
+    {
+        char root[PROJECT_MAX_PATH];
+        unsigned generation = ProjectRoot(root, sizeof(root));
+
+        /* An index of another root or exclude set would answer for the wrong assets */
+        if (index != NULL && index->generation != generation)
+        {
+            ReleaseIndex(index);
+            index = NULL;
+        }
+        if (index == NULL)
+        {
+            FreeQuery(&query);
+            *error = generation == 0 ? "Project root not configured"
+                : "Asset index is being built; retry shortly";
+            return PROJECT_ERROR_NOT_READY;
+        }
+    }
+
+    mg_iobuf_add(result, result->len, "{\"assets\":[", 11);
+    if (!ResolveList(index, guids, 1, result, &missing, &count) ||
+        !ResolveList(index, paths, 0, result, &missing, &count))
+    {
+        mg_iobuf_free(&missing);
+        ReleaseIndex(index);
+        FreeQuery(&query);
+        *error = "guids and paths must be strings";
+        return -32602;
+    }
+    if (query.filter != NULL)
+    {
+        int i;
+        for (i = 0; i < index->count; i++)
+        {
+            if (MatchesQuery(index, &query, index->entries[i]))
+            {
+                if (matched == query.max_results)
+                {
+                    truncated = 1;
+                    break;
+                }
+                AppendEntry(index, index->entries[i], result, count++ == 0);
+                matched++;
+            }
+        }
+    }
+    mg_iobuf_add(result, result->len, "],\"missing\":[", 13);
+    mg_iobuf_add(result, result->len, missing.buf, missing.len);
+    snprintf(summary, sizeof(summary), "],\"truncated\":%s,\"assets_indexed\":%d,\"index_age_ms\":%lu}",
+        truncated ? "true" : "false", index->guid_count, (unsigned long)(mg_millis() - index->built_at));
+    mg_iobuf_add(result, result->len, summary, strlen(summary));
+
+    mg_iobuf_free(&missing);
+    ReleaseIndex(index);
+    FreeQuery(&query);
+    return 0;
+}
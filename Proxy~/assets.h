@@ -0,0 +1,73 @@
+/*
+ * UnixxtyMCP Proxy - Asset GUID index
+ *
+ * Answers the "assets/resolve" JSON-RPC method on the server thread, so
+ * assets can be looked up by GUID, path, type, name or label while the
+ * editor compiles or reloads its domain, when AssetDatabase is unavailable.
+ * The index holds one entry per .meta file of the project tree (see
+ * project.h): the asset's GUID, its importer, its labels and a type derived
+ * from its extension, like the ones FindAssets() takes after "t:". For
+ * .asset files the type is the class of the first serialized object; a
+ * ScriptableObject reports its script's name (which Unity requires to match
+ * the class), with ScriptableObject as its base type.
+ *
+ * Like the search index, it is built on the worker pool and refreshed after
+ * every batch of .meta or .asset changes from the file watcher; entries
+ * whose .meta (and .asset) size and modification time are unchanged are
+ * carried over without reading them again. The index can lag the files by a
+ * rebuild, and types are the importer's defaults: a texture imported as a
+ * cubemap still reports Texture2D.
+ *
+ * Request params (at least one of guids, paths and filter):
+ *   guids        GUIDs to resolve; unknown ones are listed in "missing"
+ *   paths        Asset paths to resolve ("Assets/Art/Hero.png")
+ *   filter       FindAssets() syntax: "t:Type" (type or base type),
+ *                "l:Label" and name words, all matched case-insensitively
+ *                ("t:Material water"); an empty filter matches every asset
+ *   folders      Only assets under these folders (not the folders themselves)
+ *   max_results  Filter matches returned, default ASSETS_DEFAULT_RESULTS,
+ *                at most ASSETS_MAX_RESULTS
+ *
+ * Result: {"assets":[{"guid","path","type","importer","labels"}],
+ * "missing", "truncated", "assets_indexed", "index_age_ms"}. "type" is null
+ * when unknown; "labels" is only present when the asset has some.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_ASSETS_H
+#define UNITY_MCP_ASSETS_H
+
+#include "mongoose.h"
+
+#define ASSETS_GUID_LENGTH 32           /* Hex digits */
+#define ASSETS_HEAD_SIZE 16384           /* Bytes read from a .meta, or an .asset for its class */
+#define ASSETS_DEFAULT_RESULTS 500
+#define ASSETS_MAX_RESULTS 20000
+#define ASSETS_MAX_FILTER_TERMS 16
+
+/*
+ * Start a background rescan of the .meta files, or schedule another one
+ * after the scan in progress.
+ */
+void AssetsRefresh(void);
+
+/*
+ * True if a change to this project-relative path can change the index.
+ */
+int AssetsAffectedBy(const char* path);
+
+/*
+ * Look up an asset in the current index: the GUID of a path (`guid` holds
+ * ASSETS_GUID_LENGTH + 1 bytes) or the path of a GUID. Return 0 if it is
+ * not indexed, or the index is not built yet.
+ */
+int AssetsFindGuid(const char* path, char* guid);
+int AssetsFindPath(const char* guid, char* path, size_t capacity);
+
+/*
+ * The "assets/resolve" method (a ProjectMethod, see project.h).
+ */
+int AssetsResolveMethod(struct mg_str request, struct mg_iobuf* result, const char** error);
+
+#endif /* UNITY_MCP_ASSETS_H */
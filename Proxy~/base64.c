@@ -0,0 +1,735 @@
+/*
+ * UnixxtyMCP Proxy - Base64 kernels and deferred payloads
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "base64.h"
+#include "mongoose.h"
+#include "platform.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define BASE64_X86 1
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define BASE64_TARGET(isa)
+    #else
+        #include <immintrin.h>
+        #define BASE64_TARGET(isa) __attribute__((target(isa)))
+    #endif
+#else
+    #define BASE64_X86 0
+#endif
+
+enum
+{
+    BASE64_KERNEL_UNKNOWN = -1,
+    BASE64_KERNEL_SCALAR = 0,
+    BASE64_KERNEL_SSSE3,
+    BASE64_KERNEL_AVX2
+};
+
+static volatile int s_kernel = BASE64_KERNEL_UNKNOWN;
+
+static const char BASE64_ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static const signed char BASE64_VALUES[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+    -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+/*
+ * Scalar kernels (tails, and the whole input without SSSE3)
+ */
+
+static size_t EncodeScalar(const unsigned char* data, size_t length, char* output)
+{
+    char* out = output;
+    size_t i = 0;
+
+    for (; length - i >= 3; i += 3)
+    {
+        uint32_t value = ((uint32_t)data[i] << 16) | ((uint32_t)data[i + 1] << 8) | data[i + 2];
+        out[0] = BASE64_ALPHABET[value >> 18];
+        out[1] = BASE64_ALPHABET[(value >> 12) & 63];
+        out[2] = BASE64_ALPHABET[(value >> 6) & 63];
+        out[3] = BASE64_ALPHABET[value & 63];
+        out += 4;
+    }
+    if (length - i == 1)
+    {
+        out[0] = BASE64_ALPHABET[data[i] >> 2];
+        out[1] = BASE64_ALPHABET[(data[i] & 3) << 4];
+        out[2] = '=';
+        out[3] = '=';
+        out += 4;
+    }
+    else if (length - i == 2)
+    {
+        out[0] = BASE64_ALPHABET[data[i] >> 2];
+        out[1] = BASE64_ALPHABET[((data[i] & 3) << 4) | (data[i + 1] >> 4)];
+        out[2] = BASE64_ALPHABET[(data[i + 1] & 15) << 2];
+        out[3] = '=';
+        out += 4;
+    }
+    return (size_t)(out - output);
+}
+
+static long DecodeScalar(const char* text, size_t length, unsigned char* output)
+{
+    const unsigned char* in = (const unsigned char*)text;
+    unsigned char* out = output;
+    size_t i = 0;
+
+    if (length % 4 == 0 && length > 0 && in[length - 1] == '=')
+    {
+        length -= (in[length - 2] == '=') ? 2 : 1;
+    }
+    if (length % 4 == 1)
+    {
+        return -1;
+    }
+
+    for (; length - i >= 4; i += 4)
+    {
+        int a = BASE64_VALUES[in[i]];
+        int b = BASE64_VALUES[in[i + 1]];
+        int c = BASE64_VALUES[in[i + 2]];
+        int d = BASE64_VALUES[in[i + 3]];
+        uint32_t value;
+        if ((a | b | c | d) < 0)
+        {
+            return -1;
+        }
+        value = ((uint32_t)a << 18) | ((uint32_t)b << 12) | ((uint32_t)c << 6) | (uint32_t)d;
+        out[0] = (unsigned char)(value >> 16);
+        out[1] = (unsigned char)(value >> 8);
+        out[2] = (unsigned char)value;
+        out += 3;
+    }
+    if (length - i >= 2)
+    {
+        int a = BASE64_VALUES[in[i]];
+        int b = BASE64_VALUES[in[i + 1]];
+        int c = (length - i == 3) ? BASE64_VALUES[in[i + 2]] : 0;
+        if ((a | b | c) < 0)
+        {
+            return -1;
+        }
+        *out++ = (unsigned char)((a << 2) | (b >> 4));
+        if (length - i == 3)
+        {
+            *out++ = (unsigned char)(((b & 15) << 4) | (c >> 2));
+        }
+    }
+    return (long)(out - output);
+}
+
+#if BASE64_X86
+
+/*
+ * SSSE3 kernels: 12 bytes <-> 16 characters per step
+ */
+
+/* Map 6-bit indices to ASCII: one pshufb picks the offset for each range */
+BASE64_TARGET("ssse3")
+static __m128i LookupSsse3(__m128i indices)
+{
+    const __m128i offsets = _mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    __m128i below_26 = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    range = _mm_or_si128(range, _mm_and_si128(below_26, _mm_set1_epi8(13)));
+    return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+}
+
+/* Spread 3 bytes over 4 lanes of 6 bits each, within each 32-bit word */
+BASE64_TARGET("ssse3")
+static __m128i SplitSsse3(__m128i in)
+{
+    const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    __m128i high, low;
+    in = _mm_shuffle_epi8(in, shuffle);
+    high = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+    low = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(high, low);
+}
+
+BASE64_TARGET("ssse3")
+static size_t EncodeSsse3(const unsigned char* data, size_t length, char* output)
+{
+    char* out = output;
+    size_t i = 0;
+
+    /* Each step reads 16 bytes but consumes 12 */
+    for (; length - i >= 16; i += 12)
+    {
+        __m128i indices = SplitSsse3(_mm_loadu_si128((const __m128i*)(data + i)));
+        _mm_storeu_si128((__m128i*)out, LookupSsse3(indices));
+        out += 16;
+    }
+    return (size_t)(out - output) + EncodeScalar(data + i, length - i, out);
+}
+
+/*
+ * Translate 16 characters to 6-bit values. Returns 0 if any character is
+ * outside the alphabet ('=' included; padding is left to the scalar tail).
+ */
+BASE64_TARGET("ssse3")
+static int TranslateSsse3(__m128i in, __m128i* values)
+{
+    const __m128i shifts = _mm_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    /* Per low nibble, the high nibbles that form a valid character */
+    const __m128i valid_high = _mm_setr_epi8(
+        (char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+        (char)0xf8, (char)0xf8, (char)0xf0, 0x54, 0x50, 0x50, 0x50, 0x54);
+    const __m128i high_bits = _mm_setr_epi8(
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i high = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0f));
+    __m128i low = _mm_and_si128(in, _mm_set1_epi8(0x0f));
+    __m128i is_slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+    __m128i shift = _mm_shuffle_epi8(shifts, high);
+    __m128i allowed = _mm_and_si128(_mm_shuffle_epi8(valid_high, low), _mm_shuffle_epi8(high_bits, high));
+
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(allowed, _mm_setzero_si128())) != 0)
+    {
+        return 0;
+    }
+    /* '/' shares its high nibble with '+' but needs a different offset */
+    shift = _mm_or_si128(_mm_andnot_si128(is_slash, shift), _mm_and_si128(is_slash, _mm_set1_epi8(16)));
+    *values = _mm_add_epi8(in, shift);
+    return 1;
+}
+
+/* Pack 4 x 6-bit values per 32-bit word into 3 bytes, big-endian */
+BASE64_TARGET("ssse3")
+static __m128i PackSsse3(__m128i values)
+{
+    __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+    return _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+/*
+ * Decode whole 16-character blocks. Stops early at the first block that
+ * needs the scalar path (padding, invalid characters). Each store writes 16
+ * bytes for 12 decoded, so at least 8 characters must follow the block.
+ */
+BASE64_TARGET("ssse3")
+static size_t DecodeSsse3(const char* text, size_t length, unsigned char* output, size_t* consumed)
+{
+    unsigned char* out = output;
+    size_t i = 0;
+
+    for (; length - i >= 24; i += 16)
+    {
+        __m128i values;
+        if (!TranslateSsse3(_mm_loadu_si128((const __m128i*)(text + i)), &values))
+        {
+            break;
+        }
+        _mm_storeu_si128((__m128i*)out, PackSsse3(values));
+        out += 12;
+    }
+    *consumed = i;
+    return (size_t)(out - output);
+}
+
+/*
+ * AVX2 kernels: the SSSE3 steps on two 128-bit lanes, 24 bytes <-> 32
+ * characters per step
+ */
+
+BASE64_TARGET("avx2")
+static size_t EncodeAvx2(const unsigned char* data, size_t length, char* output)
+{
+    const __m256i shuffle = _mm256_set_epi8(
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m256i offsets = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    char* out = output;
+    size_t i = 0;
+
+    /* The upper lane loads bytes 12..27, so 28 must be readable */
+    for (; length - i >= 28; i += 24)
+    {
+        __m256i in = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(data + i))),
+            _mm_loadu_si128((const __m128i*)(data + i + 12)), 1);
+        __m256i high, low, indices, range;
+
+        in = _mm256_shuffle_epi8(in, shuffle);
+        high = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+        low = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+        indices = _mm256_or_si256(high, low);
+
+        range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        range = _mm256_or_si256(range,
+            _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+        _mm256_storeu_si256((__m256i*)out, _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices));
+        out += 32;
+    }
+    return (size_t)(out - output) + EncodeSsse3(data + i, length - i, out);
+}
+
+BASE64_TARGET("avx2")
+static size_t DecodeAvx2(const char* text, size_t length, unsigned char* output, size_t* consumed)
+{
+    const __m256i shifts = _mm256_setr_epi8(
+        0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i valid_high = _mm256_setr_epi8(
+        (char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+        (char)0xf8, (char)0xf8, (char)0xf0, 0x54, 0x50, 0x50, 0x50, 0x54,
+        (char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+        (char)0xf8, (char)0xf8, (char)0xf0, 0x54, 0x50, 0x50, 0x50, 0x54);
+    const __m256i high_bits = _mm256_setr_epi8(
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i pack_shuffle = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    unsigned char* out = output;
+    size_t tail_consumed = 0;
+    size_t i = 0;
+
+    /* 24 bytes decoded per 32-byte store: keep 16 characters in reserve */
+    for (; length - i >= 48; i += 32)
+    {
+        __m256i in = _mm256_loadu_si256((const __m256i*)(text + i));
+        __m256i high = _mm256_and_si256(_mm256_srli_epi32(in, 4), _mm256_set1_epi8(0x0f));
+        __m256i low = _mm256_and_si256(in, _mm256_set1_epi8(0x0f));
+        __m256i is_slash = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/'));
+        __m256i shift = _mm256_shuffle_epi8(shifts, high);
+        __m256i allowed = _mm256_and_si256(_mm256_shuffle_epi8(valid_high, low), _mm256_shuffle_epi8(high_bits, high));
+        __m256i merged, packed;
+
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(allowed, _mm256_setzero_si256())) != 0)
+        {
+            break;
+        }
+        shift = _mm256_blendv_epi8(shift, _mm256_set1_epi8(16), is_slash);
+        merged = _mm256_maddubs_epi16(_mm256_add_epi8(in, shift), _mm256_set1_epi32(0x01400140));
+        packed = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        packed = _mm256_shuffle_epi8(packed, pack_shuffle);
+        /* Close the 4-byte gap between the lanes */
+        packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_storeu_si256((__m256i*)out, packed);
+        out += 24;
+    }
+    out += DecodeSsse3(text + i, length - i, out, &tail_consumed);
+    *consumed = i + tail_consumed;
+    return (size_t)(out - output);
+}
+
+static int DetectKernel(void)
+{
+#ifdef _MSC_VER
+    int info[4];
+    int kernel = BASE64_KERNEL_SCALAR;
+    __cpuid(info, 1);
+    if (info[2] & (1 << 9))
+    {
+        kernel = BASE64_KERNEL_SSSE3;
+    }
+    /* AVX2 also needs OS support for the YMM state (OSXSAVE, XCR0 bits 1-2) */
+    if ((info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6)
+    {
+        __cpuidex(info, 7, 0);
+        if (info[1] & (1 << 5))
+        {
+            kernel = BASE64_KERNEL_AVX2;
+        }
+    }
+    return kernel;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return BASE64_KERNEL_AVX2;
+    }
+    return __builtin_cpu_supports("ssse3") ? BASE64_KERNEL_SSSE3 : BASE64_KERNEL_SCALAR;
+#endif
+}
+
+#else
+
+static int DetectKernel(void)
+{
+    return BASE64_KERNEL_SCALAR;
+}
+
+#endif /* BASE64_X86 */
+
+static int GetKernel(void)
+{
+    int kernel = s_kernel;
+    if (kernel == BASE64_KERNEL_UNKNOWN)
+    {
+        kernel = DetectKernel();
+        s_kernel = kernel;
+    }
+    return kernel;
+}
+
+size_t Base64Encode(const unsigned char* data, size_t length, char* output)
+{
+    switch (GetKernel())
+    {
+#if BASE64_X86
+    case BASE64_KERNEL_AVX2:
+        return EncodeAvx2(data, length, output);
+    case BASE64_KERNEL_SSSE3:
+        return EncodeSsse3(data, length, output);
+#endif
+    default:
+        return EncodeScalar(data, length, output);
+    }
+}
+
+long Base64Decode(const char* text, size_t length, unsigned char* output)
+{
+    size_t consumed = 0;
+    size_t written = 0;
+    long tail;
+
+    switch (GetKernel())
+    {
+#if BASE64_X86
+    case BASE64_KERNEL_AVX2:
+        written = DecodeAvx2(text, length, output, &consumed);
+        break;
+    case BASE64_KERNEL_SSSE3:
+        written = DecodeSsse3(text, length, output, &consumed);
+        break;
+#endif
+    default:
+        break;
+    }
+
+    tail = DecodeScalar(text + consumed, length - consumed, output + written);
+    return tail < 0 ? -1 : (long)written + tail;
+}
+
+const char* Base64Kernel(void)
+{
+    switch (GetKernel())
+    {
+    case BASE64_KERNEL_AVX2: return "avx2";
+    case BASE64_KERNEL_SSSE3: return "ssse3";
+    default: return "scalar";
+    }
+}
+
+/*
+ * Encode into a caller-provided buffer.
+ */
+EXPORT int EncodeBase64(const unsigned char* data, int length, char* output, int capacity)
+{
+    if (data == NULL || output == NULL || length < 0 ||
+        (size_t)length > ((size_t)0x7fffffff / 4) * 3 - 2 ||
+        (size_t)capacity < BASE64_ENCODED_LENGTH((size_t)length))
+    {
+        return -1;
+    }
+    return (int)Base64Encode(data, (size_t)length, output);
+}
+
+/*
+ * Decode into a caller-provided buffer.
+ */
+EXPORT int DecodeBase64(const char* text, int length, unsigned char* output, int capacity)
+{
+    if (text == NULL || output == NULL || length < 0 ||
+        (size_t)capacity < ((size_t)length + 3) / 4 * 3)
+    {
+        return -1;
+    }
+    return (int)Base64Decode(text, (size_t)length, output);
+}
+
+/*
+ * Deferred payloads
+ */
+
+typedef struct Base64Payload
+{
+    unsigned char* data;
+    size_t size;
+    const Base64Source* source;     /* Deferred bytes instead of data, or NULL */
+    void* context;
+    const unsigned char* view;      /* Bytes to encode, set when expanding */
+} Base64Payload;
+
+static ProxyMutex s_payload_lock = PROXY_MUTEX_INITIALIZER;
+static Base64Payload s_payloads[BASE64_MAX_PAYLOADS];
+static size_t s_payload_count = 0;
+static size_t s_payload_bytes = 0;
+
+/* "@b64:<nonce>:" - tokens are this prefix, the payload index and '@' */
+static char s_token_prefix[40] = "";
+static size_t s_token_prefix_len = 0;
+static char s_token_buffer[64];
+
+/*
+ * Caller holds the lock.
+ */
+static void ReleasePayloads(void)
+{
+    size_t i;
+    for (i = 0; i < s_payload_count; i++)
+    {
+        free(s_payloads[i].data);
+        s_payloads[i].data = NULL;
+        if (s_payloads[i].source != NULL)
+        {
+            s_payloads[i].source->release(s_payloads[i].context);
+            s_payloads[i].source = NULL;
+        }
+    }
+    s_payload_count = 0;
+    s_payload_bytes = 0;
+}
+
+/*
+ * Find the next token at or after `from`. Returns its offset (and payload
+ * index and length), or `length` if there is none. Caller holds the lock.
+ */
+static size_t FindToken(const char* json, size_t length, size_t from, size_t* index, size_t* token_length)
+{
+    while (from < length)
+    {
+        const char* at = (const char*)memchr(json + from, '@', length - from);
+        size_t position, digits, value = 0;
+        if (at == NULL)
+        {
+            break;
+        }
+        position = (size_t)(at - json);
+        if (length - position > s_token_prefix_len &&
+            memcmp(at, s_token_prefix, s_token_prefix_len) == 0)
+        {
+            size_t end = position + s_token_prefix_len;
+            for (digits = 0; end < length && json[end] >= '0' && json[end] <= '9' && digits < 4; end++, digits++)
+            {
+                value = value * 10 + (size_t)(json[end] - '0');
+            }
+            if (digits > 0 && end < length && json[end] == '@' && value < s_payload_count)
+            {
+                *index = value;
+                *token_length = end + 1 - position;
+                return position;
+            }
+        }
+        from = position + 1;
+    }
+    return length;
+}
+
+/*
+ * Make sure the per-process token prefix exists. Caller holds the lock.
+ */
+static int HaveTokenPrefix(void)
+{
+    if (s_token_prefix_len == 0)
+    {
+        unsigned char nonce[8];
+        size_t i;
+        if (mg_random(nonce, sizeof(nonce)))
+        {
+            int written = snprintf(s_token_prefix, sizeof(s_token_prefix), "%s", BASE64_TOKEN_PREFIX);
+            for (i = 0; i < sizeof(nonce); i++)
+            {
+                written += snprintf(s_token_prefix + written, sizeof(s_token_prefix) - (size_t)written, "%02x", nonce[i]);
+            }
+            snprintf(s_token_prefix + written, sizeof(s_token_prefix) - (size_t)written, ":");
+            s_token_prefix_len = strlen(s_token_prefix);
+        }
+    }
+    return s_token_prefix_len > 0;
+}
+
+/*
+ * Claim the next payload slot (already filled in) and format its token.
+ * Caller holds the lock.
+ */
+static const char* NextToken(void)
+{
+    snprintf(s_token_buffer, sizeof(s_token_buffer), "%s%lu@", s_token_prefix, (unsigned long)s_payload_count);
+    s_payload_count++;
+    return s_token_buffer;
+}
+
+/*
+ * Attach bytes to the response being built and get the token to put in
+ * its JSON in place of their base64 text.
+ */
+EXPORT const char* AttachBase64Payload(const unsigned char* data, int length)
+{
+    const char* token = NULL;
+    unsigned char* copy;
+
+    if (data == NULL || length < 0)
+    {
+        return NULL;
+    }
+    copy = (unsigned char*)malloc(length > 0 ? (size_t)length : 1);
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    memcpy(copy, data, (size_t)length);
+
+    PROXY_MUTEX_LOCK(&s_payload_lock);
+    if (HaveTokenPrefix() && s_payload_count < BASE64_MAX_PAYLOADS &&
+        s_payload_bytes + (size_t)length <= BASE64_PAYLOAD_BUDGET)
+    {
+        s_payloads[s_payload_count].data = copy;
+        s_payloads[s_payload_count].size = (size_t)length;
+        s_payloads[s_payload_count].source = NULL;
+        token = NextToken();
+        s_payload_bytes += (size_t)length;
+        copy = NULL;
+    }
+    PROXY_MUTEX_UNLOCK(&s_payload_lock);
+
+    free(copy);
+    return token;
+}
+
+const char* Base64AttachSource(const Base64Source* source, void* context)
+{
+    const char* token = NULL;
+
+    PROXY_MUTEX_LOCK(&s_payload_lock);
+    if (HaveTokenPrefix() && s_payload_count < BASE64_MAX_PAYLOADS)
+    {
+        s_payloads[s_payload_count].data = NULL;
+        s_payloads[s_payload_count].size = 0;
+        s_payloads[s_payload_count].source = source;
+        s_payloads[s_payload_count].context = context;
+        token = NextToken();
+    }
+    PROXY_MUTEX_UNLOCK(&s_payload_lock);
+    return token;
+}
+
+int Base64PayloadsReady(void)
+{
+    int ready = 1;
+    size_t i;
+
+    PROXY_MUTEX_LOCK(&s_payload_lock);
+    for (i = 0; i < s_payload_count && ready; i++)
+    {
+        if (s_payloads[i].source != NULL)
+        {
+            const unsigned char* data;
+            size_t size;
+            ready = s_payloads[i].source->poll(s_payloads[i].context, &data, &size) != 0;
+        }
+    }
+    PROXY_MUTEX_UNLOCK(&s_payload_lock);
+    return ready;
+}
+
+/*
+ * Resolve deferred payloads to their bytes; a source that failed or is
+ * still pending expands to nothing. Caller holds the lock.
+ */
+static void ResolveSources(void)
+{
+    size_t i;
+    for (i = 0; i < s_payload_count; i++)
+    {
+        if (s_payloads[i].source != NULL)
+        {
+            const unsigned char* data = NULL;
+            size_t size = 0;
+            if (s_payloads[i].source->poll(s_payloads[i].context, &data, &size) != 1)
+            {
+                size = 0;
+            }
+            s_payloads[i].size = size;
+            s_payloads[i].view = data;
+        }
+        else
+        {
+            s_payloads[i].view = s_payloads[i].data;
+        }
+    }
+}
+
+char* Base64ExpandPayloads(const char* json, size_t length, size_t* expanded_length)
+{
+    char* expanded = NULL;
+    size_t total = length;
+    size_t position, index, token_length;
+
+    PROXY_MUTEX_LOCK(&s_payload_lock);
+    if (s_payload_count == 0)
+    {
+        PROXY_MUTEX_UNLOCK(&s_payload_lock);
+        return NULL;
+    }
+    ResolveSources();
+
+    for (position = FindToken(json, length, 0, &index, &token_length); position < length;
+         position = FindToken(json, length, position + token_length, &index, &token_length))
+    {
+        total = total - token_length + BASE64_ENCODED_LENGTH(s_payloads[index].size);
+    }
+
+    expanded = (char*)malloc(total + 1);
+    if (expanded != NULL)
+    {
+        char* out = expanded;
+        size_t copied = 0;
+        for (position = FindToken(json, length, 0, &index, &token_length); position < length;
+             position = FindToken(json, length, position + token_length, &index, &token_length))
+        {
+            memcpy(out, json + copied, position - copied);
+            out += position - copied;
+            out += Base64Encode(s_payloads[index].view, s_payloads[index].size, out);
+            copied = position + token_length;
+        }
+        memcpy(out, json + copied, length - copied);
+        out += length - copied;
+        *out = '\0';
+        *expanded_length = (size_t)(out - expanded);
+    }
+    ReleasePayloads();
+    PROXY_MUTEX_UNLOCK(&s_payload_lock);
+    return expanded;
+}
+
+void Base64DiscardPayloads(void)
+{
+    PROXY_MUTEX_LOCK(&s_payload_lock);
+    ReleasePayloads();
+    PROXY_MUTEX_UNLOCK(&s_payload_lock);
+}
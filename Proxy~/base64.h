@@ -0,0 +1,93 @@
+/*
+ * UnixxtyMCP Proxy - Base64 kernels and deferred payloads
+ *
+ * Standard base64 (RFC 4648, padded) with AVX2 and SSSE3 kernels, chosen
+ * once at runtime from CPUID, and a table-driven scalar fallback for the
+ * tail and for non-x86 builds. The SIMD encoder is the pshufb/multiply
+ * scheme by Wojciech Muła; the decoder validates 16 or 32 characters at a
+ * time with nibble bitmask lookups.
+ *
+ * Deferred payloads keep images out of managed strings: C# hands the raw
+ * bytes to AttachBase64Payload() and puts the returned token in its JSON
+ * where the base64 text belongs. When the response arrives, the proxy
+ * replaces every token with the encoded bytes on its server thread. Tokens
+ * carry a per-process random nonce, so tool output cannot forge one.
+ * Other native modules can attach a source instead of bytes (an image
+ * still being encoded on the worker pool); the proxy holds the response
+ * until every source is ready.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_BASE64_H
+#define UNITY_MCP_BASE64_H
+
+#include <stddef.h>
+
+#define BASE64_MAX_PAYLOADS 64
+#define BASE64_PAYLOAD_BUDGET (128 * 1024 * 1024)
+#define BASE64_TOKEN_PREFIX "@b64:"
+
+/*
+ * Encoded length (with padding) of `length` bytes.
+ */
+#define BASE64_ENCODED_LENGTH(length) ((((length) + 2) / 3) * 4)
+
+/*
+ * Encode `length` bytes into `output`, which must hold
+ * BASE64_ENCODED_LENGTH(length) characters. No terminator is written.
+ * Returns the number of characters written.
+ */
+size_t Base64Encode(const unsigned char* data, size_t length, char* output);
+
+/*
+ * Decode `length` characters into `output`, which must hold length / 4 * 3
+ * bytes (rounded up). Padding is optional. Returns the number of bytes
+ * written, or -1 if the input is not valid base64.
+ */
+long Base64Decode(const char* text, size_t length, unsigned char* output);
+
+/*
+ * Name of the kernel in use: "avx2", "ssse3" or "scalar".
+ */
+const char* Base64Kernel(void);
+
+/*
+ * Deferred payload bytes. poll() returns 1 with the bytes once they are
+ * ready, 0 while pending and -1 if they will never be; release() is called
+ * once the payload is expanded or discarded. Both run under the payload
+ * lock and must not attach payloads themselves.
+ */
+typedef struct Base64Source
+{
+    int (*poll)(void* context, const unsigned char** data, size_t* size);
+    void (*release)(void* context);
+} Base64Source;
+
+/*
+ * Attach a deferred payload. Returns its token, or NULL if no slot is left
+ * (the caller then keeps ownership of the context). The token is in a
+ * static buffer that the next attach overwrites.
+ */
+const char* Base64AttachSource(const Base64Source* source, void* context);
+
+/*
+ * Whether every attached source has finished (ready or failed).
+ */
+int Base64PayloadsReady(void);
+
+/*
+ * Replace the tokens of attached payloads in a response with their base64
+ * encoding. Returns a malloc'd copy of the response (with its length in
+ * `expanded_length`) or NULL if no payload is attached. Attached payloads
+ * are released either way.
+ */
+char* Base64ExpandPayloads(const char* json, size_t length, size_t* expanded_length);
+
+/*
+ * Release attached payloads without expanding them (new request, or the
+ * response went through another path).
+ */
+void Base64DiscardPayloads(void);
+
+#endif /* UNITY_MCP_BASE64_H */
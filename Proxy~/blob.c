@@ -0,0 +1,258 @@
+/*
+ * UnixxtyMCP Proxy - Binary blob side channel
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "blob.h"
+#include "mongoose.h"
+#include "platform.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+struct Blob
+{
+    int references;            /* The table holds one while the blob is listed */
+    char id[BLOB_ID_LENGTH + 1];
+    char mime_type[96];
+    unsigned char* data;
+    size_t size;
+    uint64_t expires_at;
+    struct Blob* prev;
+    struct Blob* next;
+};
+
+/* Listed blobs, oldest first */
+static ProxyMutex s_blob_lock = PROXY_MUTEX_INITIALIZER;
+static Blob* s_blob_head = NULL;
+static Blob* s_blob_tail = NULL;
+static size_t s_blob_count = 0;
+static size_t s_blob_bytes = 0;
+static uint64_t s_blob_stored = 0;
+static uint64_t s_blob_served = 0;
+static uint64_t s_blob_expired = 0;
+
+static char s_blob_id_buffer[BLOB_ID_LENGTH + 1];
+static char s_blob_stats_buffer[256];
+
+/*
+ * Caller holds the lock.
+ */
+static void FreeBlob(Blob* blob)
+{
+    free(blob->data);
+    free(blob);
+}
+
+/*
+ * Remove a blob from the table. Caller holds the lock.
+ */
+static void UnlistBlob(Blob* blob)
+{
+    if (blob->prev != NULL) blob->prev->next = blob->next;
+    else s_blob_head = blob->next;
+    if (blob->next != NULL) blob->next->prev = blob->prev;
+    else s_blob_tail = blob->prev;
+    blob->prev = blob->next = NULL;
+
+    s_blob_count--;
+    s_blob_bytes -= blob->size;
+    if (--blob->references == 0)
+    {
+        FreeBlob(blob);
+    }
+}
+
+/*
+ * Drop expired blobs, then the oldest ones until `incoming` more bytes fit
+ * the budget. Caller holds the lock.
+ */
+static void SweepBlobs(uint64_t now, size_t incoming)
+{
+    Blob* blob = s_blob_head;
+    while (blob != NULL)
+    {
+        Blob* next = blob->next;
+        if (now >= blob->expires_at)
+        {
+            UnlistBlob(blob);
+            s_blob_expired++;
+        }
+        blob = next;
+    }
+    while (s_blob_head != NULL && s_blob_bytes + incoming > BLOB_BUDGET)
+    {
+        UnlistBlob(s_blob_head);
+    }
+}
+
+int BlobPut(const unsigned char* data, size_t length, const char* mime_type, int ttl_ms, char* id)
+{
+    unsigned char random[BLOB_ID_LENGTH / 2];
+    Blob* blob;
+    size_t i;
+
+    if (data == NULL || length > BLOB_BUDGET)
+    {
+        return 0;
+    }
+
+    blob = (Blob*)calloc(1, sizeof(Blob));
+    if (blob == NULL)
+    {
+        return 0;
+    }
+    blob->data = (unsigned char*)malloc(length > 0 ? length : 1);
+    if (blob->data == NULL || !mg_random(random, sizeof(random)))
+    {
+        FreeBlob(blob);
+        return 0;
+    }
+    memcpy(blob->data, data, length);
+    blob->size = length;
+    blob->references = 1;
+    snprintf(blob->mime_type, sizeof(blob->mime_type), "%s",
+        (mime_type != NULL && mime_type[0] != '\0') ? mime_type : "application/octet-stream");
+    for (i = 0; i < sizeof(random); i++)
+    {
+        snprintf(blob->id + i * 2, 3, "%02x", random[i]);
+    }
+    memcpy(id, blob->id, BLOB_ID_LENGTH + 1);
+
+    PROXY_MUTEX_LOCK(&s_blob_lock);
+    blob->expires_at = mg_millis() + (uint64_t)(ttl_ms > 0 ? ttl_ms : BLOB_DEFAULT_TTL_MS);
+    SweepBlobs(mg_millis(), blob->size);
+    blob->prev = s_blob_tail;
+    if (s_blob_tail != NULL) s_blob_tail->next = blob;
+    else s_blob_head = blob;
+    s_blob_tail = blob;
+    s_blob_count++;
+    s_blob_bytes += blob->size;
+    s_blob_stored++;
+    PROXY_MUTEX_UNLOCK(&s_blob_lock);
+    return 1;
+}
+
+/*
+ * Store a binary payload for GET /blob/<id>.
+ */
+EXPORT const char* StoreBlob(const unsigned char* data, int length, const char* mime_type, int ttl_ms)
+{
+    if (length < 0 || !BlobPut(data, (size_t)length, mime_type, ttl_ms, s_blob_id_buffer))
+    {
+        return NULL;
+    }
+    return s_blob_id_buffer;
+}
+
+/*
+ * Copy a blob's contents, such as a client upload, into a caller buffer.
+ */
+EXPORT int CopyBlob(const char* id, unsigned char* output, int capacity)
+{
+    Blob* blob;
+    int size;
+
+    if (id == NULL)
+    {
+        return -1;
+    }
+    blob = BlobAcquire(mg_str(id));
+    if (blob == NULL)
+    {
+        return -1;
+    }
+    size = blob->size > 0x7fffffff ? -1 : (int)blob->size;
+    if (size > 0 && output != NULL && capacity >= size)
+    {
+        memcpy(output, blob->data, (size_t)size);
+    }
+    BlobRelease(blob);
+    return size;
+}
+
+/*
+ * Remove a blob before it expires (e.g. once the client has fetched it).
+ */
+EXPORT void DropBlob(const char* id)
+{
+    Blob* blob;
+    if (id == NULL)
+    {
+        return;
+    }
+    PROXY_MUTEX_LOCK(&s_blob_lock);
+    for (blob = s_blob_head; blob != NULL; blob = blob->next)
+    {
+        if (strcmp(blob->id, id) == 0)
+        {
+            UnlistBlob(blob);
+            break;
+        }
+    }
+    PROXY_MUTEX_UNLOCK(&s_blob_lock);
+}
+
+/*
+ * Get blob table statistics as JSON.
+ */
+EXPORT const char* GetBlobStats(void)
+{
+    PROXY_MUTEX_LOCK(&s_blob_lock);
+    snprintf(s_blob_stats_buffer, sizeof(s_blob_stats_buffer),
+        "{\"blobs\":%lu,\"bytes\":%lu,\"budget\":%lu,\"stored\":%llu,\"served\":%llu,\"expired\":%llu}",
+        (unsigned long)s_blob_count, (unsigned long)s_blob_bytes, (unsigned long)BLOB_BUDGET,
+        (unsigned long long)s_blob_stored, (unsigned long long)s_blob_served,
+        (unsigned long long)s_blob_expired);
+    PROXY_MUTEX_UNLOCK(&s_blob_lock);
+    return s_blob_stats_buffer;
+}
+
+Blob* BlobAcquire(struct mg_str id)
+{
+    Blob* blob;
+    if (id.len != BLOB_ID_LENGTH)
+    {
+        return NULL;
+    }
+
+    PROXY_MUTEX_LOCK(&s_blob_lock);
+    SweepBlobs(mg_millis(), 0);
+    for (blob = s_blob_head; blob != NULL; blob = blob->next)
+    {
+        if (memcmp(blob->id, id.buf, BLOB_ID_LENGTH) == 0)
+        {
+            blob->references++;
+            s_blob_served++;
+            break;
+        }
+    }
+    PROXY_MUTEX_UNLOCK(&s_blob_lock);
+    return blob;
+}
+
+void BlobRelease(Blob* blob)
+{
+    if (blob == NULL)
+    {
+        return;
+    }
+    PROXY_MUTEX_LOCK(&s_blob_lock);
+    if (--blob->references == 0)
+    {
+        FreeBlob(blob);
+    }
+    PROXY_MUTEX_UNLOCK(&s_blob_lock);
+}
+
+struct mg_str BlobData(const Blob* blob)
+{
+    return mg_str_n((const char*)blob->data, blob->size);
+}
+
+const char* BlobMimeType(const Blob* blob)
+{
+    return blob->mime_type;
+}
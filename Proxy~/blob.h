@@ -0,0 +1,51 @@
+/*
+ * UnixxtyMCP Proxy - Binary blob side channel
+ *
+ * Binary payloads (PNG captures, previews, resource blobs) are stored here
+ * by C# with StoreBlob() instead of being base64-encoded into JSON. The JSON
+ * carries a short-lived "/blob/<id>" URL, relative to the MCP endpoint,
+ * which the proxy serves as raw bytes with GET. Clients upload the other
+ * way with POST /blob, which stores the body and answers with its id for
+ * a tool parameter; C# reads it back with CopyBlob(). Ids are 128-bit random
+ * tokens. Blobs expire after their TTL, and the oldest are evicted when the
+ * table exceeds its memory budget.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_BLOB_H
+#define UNITY_MCP_BLOB_H
+
+#include "mongoose.h"
+
+#define BLOB_ID_LENGTH 32                 /* Hex characters */
+#define BLOB_DEFAULT_TTL_MS 120000
+#define BLOB_BUDGET (64 * 1024 * 1024)
+#define BLOB_URL_PREFIX "/blob/"
+
+typedef struct Blob Blob;
+
+/*
+ * Store a copy of data and write its id (BLOB_ID_LENGTH + 1 bytes) to
+ * `id`. Returns 0 if it is larger than the budget or out of memory.
+ */
+int BlobPut(const unsigned char* data, size_t length, const char* mime_type, int ttl_ms, char* id);
+
+/*
+ * Find a live blob by id and take a reference, or return NULL if it is
+ * unknown or expired.
+ */
+Blob* BlobAcquire(struct mg_str id);
+
+/*
+ * Drop a reference taken with BlobAcquire().
+ */
+void BlobRelease(Blob* blob);
+
+/*
+ * Contents and MIME type of an acquired blob.
+ */
+struct mg_str BlobData(const Blob* blob);
+const char* BlobMimeType(const Blob* blob);
+
+#endif /* UNITY_MCP_BLOB_H */
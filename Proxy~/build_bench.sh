@@ -0,0 +1,34 @@
+#!/bin/bash
+set -e
+
+# Navigate to script directory
+cd "$(dirname "$0")"
+
+echo "Building UnityMCPProxy microbenchmarks..."
+
+# Pick an available C compiler
+CC="${CC:-}"
+if [ -z "$CC" ]; then
+    if command -v gcc &> /dev/null; then
+        CC=gcc
+    elif command -v clang &> /dev/null; then
+        CC=clang
+    else
+        echo "ERROR: no C compiler found (gcc or clang)."
+        exit 1
+    fi
+fi
+
+# Same defines as the plugin build so the numbers reflect shipped code
+$CC -O2 -DNDEBUG -DMG_ENABLE_LINES=0 -DMG_TLS=MG_TLS_BUILTIN -DMG_ENABLE_CUSTOM_CALLOC=1 \
+    bench.c mongoose.c pool.c base64.c \
+    -o bench \
+    -lpthread
+
+if [ ! -f "bench" ]; then
+    echo "ERROR: Compilation failed - output file not created"
+    exit 1
+fi
+
+echo "Build successful: bench"
+echo "Run ./bench --help for options (e.g. ./bench --save baseline.txt, ./bench --compare baseline.txt)"
@@ -0,0 +1,34 @@
+#!/bin/bash
+set -e
+
+# Navigate to script directory
+cd "$(dirname "$0")"
+
+echo "Building UnityMCPProxy response cache test..."
+
+# Pick an available C compiler
+CC="${CC:-}"
+if [ -z "$CC" ]; then
+    if command -v gcc &> /dev/null; then
+        CC=gcc
+    elif command -v clang &> /dev/null; then
+        CC=clang
+    else
+        echo "ERROR: no C compiler found (gcc or clang)."
+        exit 1
+    fi
+fi
+
+# Same defines as the plugin build; the test links the plugin sources it exercises
+$CC -O2 -DNDEBUG -DMG_ENABLE_LINES=0 -DMG_TLS=MG_TLS_BUILTIN -DMG_ENABLE_CUSTOM_CALLOC=1 \
+    cache_test.c cache.c jsonutil.c pool.c mongoose.c \
+    -o cache_test \
+    -lpthread -lm
+
+if [ ! -f "cache_test" ]; then
+    echo "ERROR: Compilation failed - output file not created"
+    exit 1
+fi
+
+echo "Build successful: cache_test"
+echo "Run ./cache_test (exit status 1 if any check fails)"
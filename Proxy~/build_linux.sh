@@ -16,12 +16,15 @@ if ! command -v gcc &> /dev/null; then
     exit 1
 fi
 
+# Source files (keep in sync with the other build scripts and the release workflow)
+SOURCES="proxy.c mongoose.c jsonutil.c cache.c pool.c spill.c blob.c base64.c workers.c deflate.c png.c image.c jpeg.c frames.c texture.c arrays.c staging.c project.c pattern.c search.c watcher.c assets.c references.c scenes.c symbols.c editorlog.c"
+
 # Build shared library
 echo "Compiling shared library..."
-gcc -shared -fPIC -O2 -DNDEBUG -DMG_ENABLE_LINES=0 -DMG_TLS=MG_TLS_BUILTIN \
-    proxy.c mongoose.c \
+gcc -shared -fPIC -O2 -DNDEBUG -DMG_ENABLE_LINES=0 -DMG_TLS=MG_TLS_BUILTIN -DMG_ENABLE_CUSTOM_CALLOC=1 \
+    $SOURCES \
     -o libUnityMCPProxy.so \
-    -lpthread
+    -lpthread -lm
 
 if [ ! -f "libUnityMCPProxy.so" ]; then
     echo "ERROR: Compilation failed - output file not created"
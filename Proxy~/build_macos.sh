@@ -16,10 +16,13 @@ if ! command -v clang &> /dev/null; then
     exit 1
 fi
 
+# Source files (keep in sync with the other build scripts and the release workflow)
+SOURCES="proxy.c mongoose.c jsonutil.c cache.c pool.c spill.c blob.c base64.c workers.c deflate.c png.c image.c jpeg.c frames.c texture.c arrays.c staging.c project.c pattern.c search.c watcher.c assets.c references.c scenes.c symbols.c editorlog.c"
+
 # Build universal binary (arm64 + x86_64)
 echo "Compiling universal binary (arm64 + x86_64)..."
-clang -shared -O2 -DNDEBUG -DMG_ENABLE_LINES=0 -DMG_TLS=MG_TLS_BUILTIN \
-    proxy.c mongoose.c \
+clang -shared -O2 -DNDEBUG -DMG_ENABLE_LINES=0 -DMG_TLS=MG_TLS_BUILTIN -DMG_ENABLE_CUSTOM_CALLOC=1 \
+    $SOURCES \
     -o UnityMCPProxy.bundle \
     -arch arm64 -arch x86_64 \
     -framework CoreFoundation -framework Security
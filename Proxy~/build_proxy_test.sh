@@ -0,0 +1,35 @@
+#!/bin/bash
+set -e
+
+# Navigate to script directory
+cd "$(dirname "$0")"
+
+echo "Building UnityMCPProxy request queue test..."
+
+# Pick an available C compiler
+CC="${CC:-}"
+if [ -z "$CC" ]; then
+    if command -v gcc &> /dev/null; then
+        CC=gcc
+    elif command -v clang &> /dev/null; then
+        CC=clang
+    else
+        echo "ERROR: no C compiler found (gcc or clang)."
+        exit 1
+    fi
+fi
+
+# Same defines as the plugin build; the test links all plugin sources
+$CC -O2 -DNDEBUG -DMG_ENABLE_LINES=0 -DMG_TLS=MG_TLS_BUILTIN -DMG_ENABLE_CUSTOM_CALLOC=1 \
+    proxy_test.c proxy.c mongoose.c jsonutil.c cache.c pool.c spill.c blob.c base64.c workers.c deflate.c png.c image.c jpeg.c frames.c texture.c arrays.c staging.c \
+    project.c pattern.c search.c watcher.c assets.c references.c scenes.c symbols.c editorlog.c \
+    -o proxy_test \
+    -lpthread -lm
+
+if [ ! -f "proxy_test" ]; then
+    echo "ERROR: Compilation failed - output file not created"
+    exit 1
+fi
+
+echo "Build successful: proxy_test"
+echo "Run ./proxy_test (exit status 1 if any check fails)"
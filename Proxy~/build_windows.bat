@@ -23,9 +23,12 @@ if errorlevel 1 (
     exit /b 1
 )
 
+:: Source files (keep in sync with the other build scripts and the release workflow)
+set SOURCES=proxy.c mongoose.c jsonutil.c cache.c pool.c spill.c blob.c base64.c workers.c deflate.c png.c image.c jpeg.c frames.c texture.c arrays.c staging.c project.c pattern.c search.c watcher.c assets.c references.c scenes.c symbols.c editorlog.c
+
 :: Build with MSVC
 echo Compiling...
-cl /LD /O2 /DNDEBUG /DMG_ENABLE_LINES=0 /DMG_TLS=MG_TLS_BUILTIN proxy.c mongoose.c /Fe:UnityMCPProxy.dll ws2_32.lib
+cl /LD /O2 /DNDEBUG /DMG_ENABLE_LINES=0 /DMG_TLS=MG_TLS_BUILTIN /DMG_ENABLE_CUSTOM_CALLOC=1 %SOURCES% /Fe:UnityMCPProxy.dll ws2_32.lib
 if errorlevel 1 (
     echo ERROR: Compilation failed
     exit /b 1
@@ -43,8 +46,7 @@ if errorlevel 1 (
 if exist UnityMCPProxy.exp del UnityMCPProxy.exp
 if exist UnityMCPProxy.lib del UnityMCPProxy.lib
 if exist UnityMCPProxy.obj del UnityMCPProxy.obj
-if exist proxy.obj del proxy.obj
-if exist mongoose.obj del mongoose.obj
+del /Q *.obj 2>nul
 
 echo Build successful: UnityMCPProxy.dll
 exit /b 0
@@ -23,10 +23,13 @@ if errorlevel 1 (
     exit /b 1
 )
 
+:: Source files (keep in sync with the other build scripts and the release workflow)
+set SOURCES=proxy.c mongoose.c jsonutil.c cache.c pool.c spill.c blob.c base64.c workers.c deflate.c png.c image.c jpeg.c frames.c texture.c arrays.c staging.c project.c pattern.c search.c watcher.c assets.c references.c scenes.c symbols.c editorlog.c
+
 :: Build with GCC
 echo Compiling...
-gcc -shared -O2 -DNDEBUG -DMG_ENABLE_LINES=0 -DMG_TLS=MG_TLS_BUILTIN ^
-    proxy.c mongoose.c ^
+gcc -shared -O2 -DNDEBUG -DMG_ENABLE_LINES=0 -DMG_TLS=MG_TLS_BUILTIN -DMG_ENABLE_CUSTOM_CALLOC=1 ^
+    %SOURCES% ^
     -o UnityMCPProxy.dll ^
     -lws2_32 ^
     -Wl,--out-implib,libUnityMCPProxy.a
@@ -0,0 +1,713 @@
+/*
+ * UnixxtyMCP Proxy - Read-only response cache
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "cache.h"
+#include "jsonutil.h"
+#include "platform.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CACHE_BUCKET_COUNT 1024
+#define CACHE_EPOCH_NAME_SIZE 32
+#define CACHE_POLICY_NAME_SIZE 256
+
+/*
+ * A registered read-only request. `name` is the tool name (tools/call),
+ * the resource URI (resources/read), or empty to match the whole method.
+ * A trailing '*' in name makes it a prefix match (resource templates).
+ */
+typedef struct CachePolicy
+{
+    char method[32];
+    char name[CACHE_POLICY_NAME_SIZE];
+    size_t name_len;
+    int is_prefix;
+    int cacheable;
+    uint32_t mask;
+} CachePolicy;
+
+typedef struct CacheEntry
+{
+    uint64_t hash;
+    char* key;
+    size_t key_len;
+    char* response;
+    size_t response_len;
+    size_t id_start;        /* Span of the original "id" value inside response */
+    size_t id_end;
+    char etag[CACHE_ETAG_SIZE];  /* Empty unless the response was tagged */
+    uint32_t mask;
+    uint32_t epochs[CACHE_MAX_EPOCHS];
+    uint64_t stored_at;
+    struct CacheEntry* bucket_next;
+    struct CacheEntry* lru_prev;
+    struct CacheEntry* lru_next;
+} CacheEntry;
+
+static ProxyMutex s_cache_lock = PROXY_MUTEX_INITIALIZER;
+
+static CachePolicy* s_policies = NULL;
+static size_t s_policy_count = 0;
+static size_t s_policy_capacity = 0;
+
+static char s_epoch_names[CACHE_MAX_EPOCHS][CACHE_EPOCH_NAME_SIZE];
+static uint32_t s_epoch_values[CACHE_MAX_EPOCHS];
+static int s_epoch_count = 0;
+
+static CacheEntry* s_buckets[CACHE_BUCKET_COUNT];
+static CacheEntry* s_lru_head = NULL;   /* Most recently used */
+static CacheEntry* s_lru_tail = NULL;   /* Eviction candidate */
+static size_t s_budget = CACHE_DEFAULT_BUDGET;
+static uint64_t s_ttl_ms = 0;
+static size_t s_bytes = 0;
+static size_t s_entry_count = 0;
+
+static uint64_t s_hits = 0;
+static uint64_t s_misses = 0;
+static uint64_t s_stores = 0;
+static uint64_t s_evictions = 0;
+static uint64_t s_invalidations = 0;
+static uint64_t s_not_modified = 0;
+
+static char s_stats_buffer[2048];
+
+/*
+ * Find or create the slot for a named epoch. Caller holds the lock.
+ * Returns -1 when all slots are in use.
+ */
+static int GetEpochSlot(const char* name, size_t length)
+{
+    int i;
+    if (length == 0 || length >= CACHE_EPOCH_NAME_SIZE)
+    {
+        return -1;
+    }
+    for (i = 0; i < s_epoch_count; i++)
+    {
+        if (strlen(s_epoch_names[i]) == length && memcmp(s_epoch_names[i], name, length) == 0)
+        {
+            return i;
+        }
+    }
+    if (s_epoch_count >= CACHE_MAX_EPOCHS)
+    {
+        return -1;
+    }
+    memcpy(s_epoch_names[s_epoch_count], name, length);
+    s_epoch_names[s_epoch_count][length] = '\0';
+    s_epoch_values[s_epoch_count] = 0;
+    return s_epoch_count++;
+}
+
+/*
+ * Parse a comma-separated epoch list into a mask. Caller holds the lock.
+ */
+static uint32_t ParseEpochList(const char* epochs)
+{
+    uint32_t mask = 0;
+    const char* p = epochs;
+    while (p != NULL && *p != '\0')
+    {
+        const char* start;
+        const char* stop;
+        int slot;
+        while (*p == ' ' || *p == ',')
+        {
+            p++;
+        }
+        start = p;
+        while (*p != '\0' && *p != ',')
+        {
+            p++;
+        }
+        stop = p;
+        while (stop > start && stop[-1] == ' ')
+        {
+            stop--;
+        }
+        slot = GetEpochSlot(start, (size_t)(stop - start));
+        if (slot >= 0)
+        {
+            mask |= 1u << slot;
+        }
+    }
+    return mask;
+}
+
+static void LruUnlink(CacheEntry* entry)
+{
+    if (entry->lru_prev != NULL) entry->lru_prev->lru_next = entry->lru_next;
+    else s_lru_head = entry->lru_next;
+    if (entry->lru_next != NULL) entry->lru_next->lru_prev = entry->lru_prev;
+    else s_lru_tail = entry->lru_prev;
+    entry->lru_prev = entry->lru_next = NULL;
+}
+
+static void LruPushFront(CacheEntry* entry)
+{
+    entry->lru_prev = NULL;
+    entry->lru_next = s_lru_head;
+    if (s_lru_head != NULL) s_lru_head->lru_prev = entry;
+    s_lru_head = entry;
+    if (s_lru_tail == NULL) s_lru_tail = entry;
+}
+
+static size_t EntryCost(const CacheEntry* entry)
+{
+    return sizeof(CacheEntry) + entry->key_len + entry->response_len;
+}
+
+/*
+ * Unlink and free an entry. Caller holds the lock.
+ */
+static void RemoveEntry(CacheEntry* entry)
+{
+    CacheEntry** link = &s_buckets[entry->hash % CACHE_BUCKET_COUNT];
+    while (*link != NULL && *link != entry)
+    {
+        link = &(*link)->bucket_next;
+    }
+    if (*link == entry)
+    {
+        *link = entry->bucket_next;
+    }
+    LruUnlink(entry);
+    s_bytes -= EntryCost(entry);
+    s_entry_count--;
+    free(entry->key);
+    free(entry->response);
+    free(entry);
+}
+
+static void ClearEntries(void)
+{
+    while (s_lru_head != NULL)
+    {
+        RemoveEntry(s_lru_head);
+    }
+}
+
+static int IsEntryValid(const CacheEntry* entry, uint64_t now)
+{
+    int i;
+    if (s_ttl_ms > 0 && now - entry->stored_at > s_ttl_ms)
+    {
+        return 0;
+    }
+    for (i = 0; i < s_epoch_count; i++)
+    {
+        if ((entry->mask & (1u << i)) && entry->epochs[i] != s_epoch_values[i])
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static CacheEntry* FindEntry(uint64_t hash, const char* key, size_t key_len)
+{
+    CacheEntry* entry = s_buckets[hash % CACHE_BUCKET_COUNT];
+    while (entry != NULL)
+    {
+        if (entry->hash == hash && entry->key_len == key_len && memcmp(entry->key, key, key_len) == 0)
+        {
+            return entry;
+        }
+        entry = entry->bucket_next;
+    }
+    return NULL;
+}
+
+/*
+ * Match a request against the registered policies. Caller holds the lock.
+ */
+static const CachePolicy* FindPolicy(struct mg_str method, struct mg_str name)
+{
+    const CachePolicy* method_match = NULL;
+    size_t i;
+    for (i = 0; i < s_policy_count; i++)
+    {
+        const CachePolicy* policy = &s_policies[i];
+        if (strlen(policy->method) != method.len || memcmp(policy->method, method.buf, method.len) != 0)
+        {
+            continue;
+        }
+        if (policy->name_len == 0)
+        {
+            method_match = policy;
+            continue;
+        }
+        if (policy->is_prefix)
+        {
+            if (name.len >= policy->name_len && memcmp(policy->name, name.buf, policy->name_len) == 0)
+            {
+                return policy;
+            }
+        }
+        else if (name.len == policy->name_len && memcmp(policy->name, name.buf, name.len) == 0)
+        {
+            return policy;
+        }
+    }
+    return method_match;
+}
+
+void CacheClassify(struct mg_str body, CacheRequest* request)
+{
+    struct mg_str method_token, params, name_token, name;
+    const CachePolicy* policy;
+    int is_tool_call;
+
+    memset(request, 0, sizeof(*request));
+    request->cache_class = CACHE_CLASS_READONLY;
+
+    if (!JsonFindMember(body, "method", &method_token))
+    {
+        return;
+    }
+    struct mg_str method = JsonStringContents(method_token);
+    is_tool_call = (mg_strcmp(method, mg_str("tools/call")) == 0);
+
+    params = mg_str_n(NULL, 0);
+    name = mg_str_n(NULL, 0);
+    if (JsonFindMember(body, "params", &params))
+    {
+        if (is_tool_call && JsonFindMember(params, "name", &name_token))
+        {
+            name = JsonStringContents(name_token);
+        }
+        else if (mg_strcmp(method, mg_str("resources/read")) == 0 && JsonFindMember(params, "uri", &name_token))
+        {
+            name = JsonStringContents(name_token);
+        }
+    }
+
+    if (mg_strcmp(method, mg_str("resources/read")) == 0)
+    {
+        struct mg_str meta, token;
+        request->conditional = 1;
+        if (JsonFindMember(params, "_meta", &meta) && JsonFindMember(meta, "ifNoneMatch", &token))
+        {
+            token = JsonStringContents(token);
+            if (token.len > 0 && token.len < sizeof(request->if_none_match))
+            {
+                memcpy(request->if_none_match, token.buf, token.len);
+            }
+        }
+    }
+
+    /* Clients that fetch /blob/ URLs say so per request */
+    {
+        struct mg_str meta, token;
+        if (JsonFindMember(params, "_meta", &meta) && JsonFindMember(meta, "blobUrls", &token))
+        {
+            request->blob_urls = (mg_strcmp(token, mg_str("true")) == 0);
+        }
+    }
+
+    PROXY_MUTEX_LOCK(&s_cache_lock);
+    policy = FindPolicy(method, name);
+    if (policy == NULL)
+    {
+        /* Unknown tools may change anything; every other method is read-only */
+        request->cache_class = is_tool_call ? CACHE_CLASS_MUTATING : CACHE_CLASS_READONLY;
+    }
+    else if (policy->cacheable && s_budget > 0 && !request->blob_urls)  /* Blob URLs expire: never cache */
+    {
+        request->cache_class = CACHE_CLASS_CACHEABLE;
+        request->mask = policy->mask;
+        memcpy(request->epochs, s_epoch_values, sizeof(request->epochs));
+    }
+    PROXY_MUTEX_UNLOCK(&s_cache_lock);
+
+    /* Read-only requests get a key too, so identical in-flight calls can be coalesced */
+    if (request->cache_class != CACHE_CLASS_MUTATING)
+    {
+        struct mg_iobuf key = {0, 0, 0, 256};
+        mg_iobuf_add(&key, 0, method.buf, method.len);
+        mg_iobuf_add(&key, key.len, "\n", 1);
+        if (params.len > 0 && JsonCanonicalize(params, "_meta", &key) != 0)
+        {
+            /* Unparseable params: let C# produce the error, don't cache or share it */
+            mg_iobuf_free(&key);
+            request->cache_class = CACHE_CLASS_READONLY;
+            return;
+        }
+        if (request->blob_urls)
+        {
+            /* Only share a response with requests that accept blob URLs too */
+            mg_iobuf_add(&key, key.len, "\nblob", 5);
+        }
+        request->key = (char*)key.buf;
+        request->key_len = key.len;
+        request->hash = JsonHash64(key.buf, key.len, JSON_HASH_SEED);
+    }
+}
+
+char* CacheLookup(const CacheRequest* request, const char* request_id, size_t* out_length)
+{
+    CacheEntry* entry;
+    char* result = NULL;
+
+    if (request->cache_class != CACHE_CLASS_CACHEABLE || request->key == NULL)
+    {
+        return NULL;
+    }
+
+    PROXY_MUTEX_LOCK(&s_cache_lock);
+    entry = FindEntry(request->hash, request->key, request->key_len);
+    if (entry != NULL && !IsEntryValid(entry, mg_millis()))
+    {
+        RemoveEntry(entry);
+        s_invalidations++;
+        entry = NULL;
+    }
+    if (entry == NULL)
+    {
+        s_misses++;
+    }
+    else if (request->if_none_match[0] != '\0' && strcmp(request->if_none_match, entry->etag) == 0)
+    {
+        LruUnlink(entry);
+        LruPushFront(entry);
+        s_hits++;
+        PROXY_MUTEX_UNLOCK(&s_cache_lock);
+        return CacheNotModifiedResponse(request->if_none_match, request_id, out_length);
+    }
+    else
+    {
+        size_t id_length = strlen(request_id);
+        size_t length = entry->response_len - (entry->id_end - entry->id_start) + id_length;
+        result = (char*)malloc(length + 1);
+        if (result != NULL)
+        {
+            memcpy(result, entry->response, entry->id_start);
+            memcpy(result + entry->id_start, request_id, id_length);
+            memcpy(result + entry->id_start + id_length, entry->response + entry->id_end,
+                entry->response_len - entry->id_end);
+            result[length] = '\0';
+            *out_length = length;
+            LruUnlink(entry);
+            LruPushFront(entry);
+            s_hits++;
+        }
+    }
+    PROXY_MUTEX_UNLOCK(&s_cache_lock);
+    return result;
+}
+
+void CacheStore(const CacheRequest* request, const char* response, size_t length)
+{
+    struct mg_str json = mg_str_n(response, length);
+    struct mg_str id_value, result_value, is_error;
+    CacheEntry* entry;
+    CacheEntry* existing;
+
+    if (request->cache_class != CACHE_CLASS_CACHEABLE || request->key == NULL || length == 0)
+    {
+        return;
+    }
+
+    /* Only successful results are cached */
+    if (JsonFindMember(json, "error", NULL) || !JsonFindMember(json, "result", &result_value))
+    {
+        return;
+    }
+    if (JsonFindMember(result_value, "isError", &is_error) && mg_strcmp(is_error, mg_str("true")) == 0)
+    {
+        return;
+    }
+    if (!JsonFindMember(json, "id", &id_value))
+    {
+        return;
+    }
+
+    entry = (CacheEntry*)calloc(1, sizeof(CacheEntry));
+    if (entry == NULL)
+    {
+        return;
+    }
+    entry->key = (char*)malloc(request->key_len);
+    entry->response = (char*)malloc(length);
+    if (entry->key == NULL || entry->response == NULL)
+    {
+        free(entry->key);
+        free(entry->response);
+        free(entry);
+        return;
+    }
+    memcpy(entry->key, request->key, request->key_len);
+    memcpy(entry->response, response, length);
+    entry->key_len = request->key_len;
+    entry->response_len = length;
+    entry->id_start = (size_t)(id_value.buf - response);
+    entry->id_end = entry->id_start + id_value.len;
+    entry->hash = request->hash;
+    entry->mask = request->mask;
+    memcpy(entry->epochs, request->epochs, sizeof(entry->epochs));
+    entry->stored_at = mg_millis();
+    if (request->conditional)
+    {
+        struct mg_str meta, tag;
+        if (JsonFindMember(result_value, "_meta", &meta) && JsonFindMember(meta, "etag", &tag))
+        {
+            tag = JsonStringContents(tag);
+            if (tag.len < sizeof(entry->etag))
+            {
+                memcpy(entry->etag, tag.buf, tag.len);
+            }
+        }
+    }
+
+    PROXY_MUTEX_LOCK(&s_cache_lock);
+    if (EntryCost(entry) > s_budget / 4)
+    {
+        /* Too large relative to the budget; would just churn the cache */
+        PROXY_MUTEX_UNLOCK(&s_cache_lock);
+        free(entry->key);
+        free(entry->response);
+        free(entry);
+        return;
+    }
+
+    existing = FindEntry(entry->hash, entry->key, entry->key_len);
+    if (existing != NULL)
+    {
+        RemoveEntry(existing);
+    }
+    while (s_lru_tail != NULL && s_bytes + EntryCost(entry) > s_budget)
+    {
+        RemoveEntry(s_lru_tail);
+        s_evictions++;
+    }
+
+    entry->bucket_next = s_buckets[entry->hash % CACHE_BUCKET_COUNT];
+    s_buckets[entry->hash % CACHE_BUCKET_COUNT] = entry;
+    LruPushFront(entry);
+    s_bytes += EntryCost(entry);
+    s_entry_count++;
+    s_stores++;
+    PROXY_MUTEX_UNLOCK(&s_cache_lock);
+}
+
+char* CacheTagResponse(const CacheRequest* request, const char* response, size_t length,
+    char* etag, size_t* out_length)
+{
+    struct mg_str json = mg_str_n(response, length);
+    struct mg_str result_value;
+    const char* body;
+    size_t insert_at, tagged_length;
+    int is_empty;
+    char meta[64];
+    char* tagged;
+
+    if (!request->conditional || JsonFindMember(json, "error", NULL) ||
+        !JsonFindMember(json, "result", &result_value) ||
+        result_value.len < 2 || result_value.buf[0] != '{' ||
+        JsonFindMember(result_value, "_meta", NULL))
+    {
+        return NULL;
+    }
+
+    /* The tag covers only the result, so it is independent of the request id */
+    mg_snprintf(etag, CACHE_ETAG_SIZE, "%016llx",
+        (unsigned long long)JsonHash64(result_value.buf, result_value.len, JSON_HASH_SEED));
+
+    body = JsonSkipWhitespace(result_value.buf + 1, result_value.buf + result_value.len);
+    is_empty = (*body == '}');
+    mg_snprintf(meta, sizeof(meta), "\"_meta\":{\"etag\":\"%s\"}%s", etag, is_empty ? "" : ",");
+
+    insert_at = (size_t)(result_value.buf + 1 - response);
+    tagged_length = length + strlen(meta);
+    tagged = (char*)malloc(tagged_length + 1);
+    if (tagged == NULL)
+    {
+        return NULL;
+    }
+    memcpy(tagged, response, insert_at);
+    memcpy(tagged + insert_at, meta, strlen(meta));
+    memcpy(tagged + insert_at + strlen(meta), response + insert_at, length - insert_at);
+    tagged[tagged_length] = '\0';
+    *out_length = tagged_length;
+    return tagged;
+}
+
+char* CacheNotModifiedResponse(const char* etag, const char* request_id, size_t* out_length)
+{
+    static const char* format =
+        "{\"jsonrpc\":\"2.0\",\"result\":{\"_meta\":{\"etag\":\"%s\",\"notModified\":true},"
+        "\"contents\":[]},\"id\":%s}";
+    size_t length = strlen(format) + strlen(etag) + strlen(request_id);
+    char* response = (char*)malloc(length + 1);
+    if (response != NULL)
+    {
+        *out_length = (size_t)snprintf(response, length + 1, format, etag, request_id);
+        PROXY_MUTEX_LOCK(&s_cache_lock);
+        s_not_modified++;
+        PROXY_MUTEX_UNLOCK(&s_cache_lock);
+    }
+    return response;
+}
+
+void CacheInvalidateAll(void)
+{
+    int i;
+    PROXY_MUTEX_LOCK(&s_cache_lock);
+    for (i = 0; i < s_epoch_count; i++)
+    {
+        s_epoch_values[i]++;
+    }
+    PROXY_MUTEX_UNLOCK(&s_cache_lock);
+}
+
+int CacheSameRequest(const CacheRequest* a, const CacheRequest* b)
+{
+    return a->key != NULL && b->key != NULL &&
+           a->cache_class != CACHE_CLASS_MUTATING && b->cache_class != CACHE_CLASS_MUTATING &&
+           a->hash == b->hash && a->key_len == b->key_len &&
+           memcmp(a->key, b->key, a->key_len) == 0;
+}
+
+void CacheRelease(CacheRequest* request)
+{
+    mg_free(request->key);  /* Built with mg_iobuf */
+    request->key = NULL;
+    request->key_len = 0;
+}
+
+/*
+ * Configure the response cache budget and optional time-to-live.
+ */
+EXPORT void ConfigureResponseCache(int budget_bytes, int ttl_ms)
+{
+    PROXY_MUTEX_LOCK(&s_cache_lock);
+    s_budget = budget_bytes > 0 ? (size_t)budget_bytes : 0;
+    s_ttl_ms = ttl_ms > 0 ? (uint64_t)ttl_ms : 0;
+    while (s_lru_tail != NULL && s_bytes > s_budget)
+    {
+        RemoveEntry(s_lru_tail);
+        s_evictions++;
+    }
+    PROXY_MUTEX_UNLOCK(&s_cache_lock);
+}
+
+/*
+ * Register a read-only request and the epochs its result depends on.
+ */
+EXPORT void RegisterCacheableRequest(const char* method, const char* name, const char* epochs)
+{
+    CachePolicy* policy;
+    size_t name_length;
+
+    if (method == NULL || strlen(method) >= sizeof(policy->method))
+    {
+        return;
+    }
+    name_length = (name != NULL) ? strlen(name) : 0;
+    if (name_length >= CACHE_POLICY_NAME_SIZE)
+    {
+        return;
+    }
+
+    PROXY_MUTEX_LOCK(&s_cache_lock);
+    if (s_policy_count == s_policy_capacity)
+    {
+        size_t capacity = s_policy_capacity ? s_policy_capacity * 2 : 64;
+        CachePolicy* grown = (CachePolicy*)realloc(s_policies, capacity * sizeof(CachePolicy));
+        if (grown == NULL)
+        {
+            PROXY_MUTEX_UNLOCK(&s_cache_lock);
+            return;
+        }
+        s_policies = grown;
+        s_policy_capacity = capacity;
+    }
+    policy = &s_policies[s_policy_count++];
+    memset(policy, 0, sizeof(*policy));
+    strcpy(policy->method, method);
+    if (name_length > 0)
+    {
+        memcpy(policy->name, name, name_length);
+        if (name[name_length - 1] == '*')
+        {
+            policy->is_prefix = 1;
+            name_length--;
+        }
+        policy->name[name_length] = '\0';
+    }
+    policy->name_len = name_length;
+    policy->cacheable = (epochs != NULL && epochs[0] != '\0');
+    policy->mask = policy->cacheable ? ParseEpochList(epochs) : 0;
+    PROXY_MUTEX_UNLOCK(&s_cache_lock);
+}
+
+/*
+ * Bump a named invalidation epoch ("*" bumps all of them).
+ */
+EXPORT void BumpCacheEpoch(const char* name)
+{
+    if (name == NULL)
+    {
+        return;
+    }
+    if (strcmp(name, "*") == 0)
+    {
+        CacheInvalidateAll();
+        return;
+    }
+    PROXY_MUTEX_LOCK(&s_cache_lock);
+    {
+        int slot = GetEpochSlot(name, strlen(name));
+        if (slot >= 0)
+        {
+            s_epoch_values[slot]++;
+        }
+    }
+    PROXY_MUTEX_UNLOCK(&s_cache_lock);
+}
+
+/*
+ * Drop every cached entry and registered policy.
+ */
+EXPORT void ResetResponseCache(void)
+{
+    PROXY_MUTEX_LOCK(&s_cache_lock);
+    ClearEntries();
+    s_policy_count = 0;
+    PROXY_MUTEX_UNLOCK(&s_cache_lock);
+}
+
+/*
+ * Get cache statistics as a JSON object.
+ */
+EXPORT const char* GetResponseCacheStats(void)
+{
+    size_t offset;
+    int i;
+
+    PROXY_MUTEX_LOCK(&s_cache_lock);
+    offset = mg_snprintf(s_stats_buffer, sizeof(s_stats_buffer),
+        "{\"enabled\":%s,\"entries\":%lu,\"bytes\":%lu,\"budget\":%lu,\"ttl_ms\":%lu,"
+        "\"hits\":%lu,\"misses\":%lu,\"stores\":%lu,\"evictions\":%lu,\"invalidations\":%lu,\"not_modified\":%lu,"
+        "\"policies\":%lu,\"epochs\":{",
+        s_budget > 0 ? "true" : "false", (unsigned long)s_entry_count, (unsigned long)s_bytes,
+        (unsigned long)s_budget, (unsigned long)s_ttl_ms, (unsigned long)s_hits,
+        (unsigned long)s_misses, (unsigned long)s_stores, (unsigned long)s_evictions,
+        (unsigned long)s_invalidations, (unsigned long)s_not_modified, (unsigned long)s_policy_count);
+    for (i = 0; i < s_epoch_count && offset < sizeof(s_stats_buffer); i++)
+    {
+        offset += mg_snprintf(s_stats_buffer + offset, sizeof(s_stats_buffer) - offset,
+            "%s\"%s\":%lu", i > 0 ? "," : "", s_epoch_names[i], (unsigned long)s_epoch_values[i]);
+    }
+    if (offset < sizeof(s_stats_buffer))
+    {
+        mg_snprintf(s_stats_buffer + offset, sizeof(s_stats_buffer) - offset, "}}");
+    }
+    PROXY_MUTEX_UNLOCK(&s_cache_lock);
+    return s_stats_buffer;
+}
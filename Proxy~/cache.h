@@ -0,0 +1,104 @@
+/*
+ * UnixxtyMCP Proxy - Read-only response cache
+ *
+ * Caches JSON-RPC responses of read-only requests (tools marked readOnlyHint,
+ * resources) so repeated calls are answered on the server thread without a
+ * main-thread dispatch. Entries are keyed by a hash of the method, tool name
+ * or resource URI and the canonicalized arguments, bounded by a memory budget
+ * with LRU eviction.
+ *
+ * Invalidation is epoch based: C# registers which named epochs ("scene",
+ * "assets", "console", "selection", ...) each request depends on, and bumps
+ * an epoch from the matching editor change callback. An entry is valid only
+ * while every epoch it depends on still has the value it was stored under.
+ * Any tools/call that is not registered as read-only bumps every epoch.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_CACHE_H
+#define UNITY_MCP_CACHE_H
+
+#include "mongoose.h"
+
+#define CACHE_MAX_EPOCHS 16
+#define CACHE_DEFAULT_BUDGET (16 * 1024 * 1024)
+#define CACHE_ETAG_SIZE 24
+
+typedef enum CacheClass
+{
+    CACHE_CLASS_MUTATING = 0,  /* May change editor state: invalidates everything */
+    CACHE_CLASS_READONLY,      /* Does not change state, but is never cached */
+    CACHE_CLASS_CACHEABLE      /* Read-only and cacheable under the epochs in mask */
+} CacheClass;
+
+/*
+ * Classification and key of one incoming request.
+ * Filled by CacheClassify(), released with CacheRelease().
+ */
+typedef struct CacheRequest
+{
+    CacheClass cache_class;
+    uint64_t hash;
+    char* key;                          /* "<method>\n<canonical params>", NULL if mutating */
+    size_t key_len;
+    uint32_t mask;                      /* Epochs this request depends on */
+    uint32_t epochs[CACHE_MAX_EPOCHS];  /* Epoch values when the request arrived */
+    int conditional;                    /* resources/read: response carries an ETag */
+    char if_none_match[CACHE_ETAG_SIZE];/* params._meta.ifNoneMatch, or empty */
+    int blob_urls;                      /* params._meta.blobUrls: binary payloads may come back as /blob/ URLs */
+} CacheRequest;
+
+/*
+ * Classify a raw JSON-RPC request body. Read-only requests get a key
+ * (also used to coalesce identical in-flight requests); cacheable ones
+ * additionally snapshot the epochs they depend on.
+ */
+void CacheClassify(struct mg_str body, CacheRequest* request);
+
+/*
+ * Look up a cached response. On a hit, returns a malloc'd copy of the
+ * response with its "id" replaced by request_id (caller frees), and stores
+ * its length in out_length. If the request's ifNoneMatch equals the entry's
+ * ETag, the copy is a "not modified" result instead. Returns NULL on a miss.
+ */
+char* CacheLookup(const CacheRequest* request, const char* request_id, size_t* out_length);
+
+/*
+ * Store a successful response for a cacheable request. Error responses and
+ * tool results with "isError":true are ignored.
+ */
+void CacheStore(const CacheRequest* request, const char* response, size_t length);
+
+/*
+ * Tag a conditional (resources/read) response with an ETag: a hash of its
+ * "result" value, added as result._meta.etag. Returns a malloc'd tagged copy
+ * (caller frees) and writes the tag to etag, or returns NULL if the request
+ * is not conditional or the response is an error.
+ */
+char* CacheTagResponse(const CacheRequest* request, const char* response, size_t length,
+    char* etag, size_t* out_length);
+
+/*
+ * Build a "not modified" result for a client whose ifNoneMatch equals etag.
+ * Returns a malloc'd response (caller frees).
+ */
+char* CacheNotModifiedResponse(const char* etag, const char* request_id, size_t* out_length);
+
+/*
+ * Bump every epoch, invalidating all cached entries.
+ */
+void CacheInvalidateAll(void);
+
+/*
+ * Check whether two classified requests are identical read-only calls
+ * that can share one execution.
+ */
+int CacheSameRequest(const CacheRequest* a, const CacheRequest* b);
+
+/*
+ * Release memory owned by a CacheRequest.
+ */
+void CacheRelease(CacheRequest* request);
+
+#endif /* UNITY_MCP_CACHE_H */
@@ -0,0 +1,348 @@
+/*
+ * UnixxtyMCP Proxy - Response cache test
+ *
+ * Standalone executable that registers read-only requests with the response
+ * cache the way ResponseCache.cs does and checks which requests it answers:
+ * hits with the caller's id, arguments compared in canonical form, epochs
+ * bumped by name or all at once, unregistered tools, error results, ETags
+ * of resources/read replies ("not modified" or the full reply), the memory
+ * budget and the time-to-live.
+ *
+ * Usage:
+ *   cache_test
+ *
+ * Build with build_cache_test.sh (Linux/macOS). Not shipped with the plugin.
+ * Exits with status 1 if any check fails.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "cache.h"
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int s_failures = 0;
+static int s_checks = 0;
+
+#define CHECK(condition, ...) \
+    do \
+    { \
+        s_checks++; \
+        if (!(condition)) \
+        { \
+            s_failures++; \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+        } \
+    } while (0)
+
+#define HIERARCHY_CALL(id, arguments) \
+    "{\"jsonrpc\":\"2.0\",\"id\":" id ",\"method\":\"tools/call\"," \
+    "\"params\":{\"name\":\"scene_get_hierarchy\",\"arguments\":" arguments "}}"
+
+#define HIERARCHY_RESULT "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":{\"content\":[{\"type\":\"text\",\"text\":\"Main Camera\"}]}}"
+
+/*
+ * Classify a request as the server thread does and look it up. Returns the
+ * cached reply (caller frees), or NULL on a miss.
+ */
+static char* Lookup(const char* body, const char* id)
+{
+    CacheRequest request;
+    size_t length = 0;
+    char* response;
+
+    CacheClassify(mg_str(body), &request);
+    response = CacheLookup(&request, id, &length);
+    CHECK(response == NULL || length == strlen(response), "Reply length %lu", (unsigned long)length);
+    CacheRelease(&request);
+    return response;
+}
+
+/*
+ * Classify a request and store its reply, as once C# has answered it.
+ */
+static void Store(const char* body, const char* response)
+{
+    CacheRequest request;
+    CacheClassify(mg_str(body), &request);
+    CacheStore(&request, response, strlen(response));
+    CacheRelease(&request);
+}
+
+static int Classify(const char* body)
+{
+    CacheRequest request;
+    int cache_class;
+    CacheClassify(mg_str(body), &request);
+    cache_class = (int)request.cache_class;
+    CacheRelease(&request);
+    return cache_class;
+}
+
+static void Register(void)
+{
+    ResetResponseCache();
+    ConfigureResponseCache(CACHE_DEFAULT_BUDGET, 0);
+    RegisterCacheableRequest("tools/call", "scene_get_hierarchy", "scene,selection");
+    RegisterCacheableRequest("tools/call", "console_read", "");
+    RegisterCacheableRequest("resources/read", "scene://gameobject/*", "scene");
+    RegisterCacheableRequest("tools/list", NULL, "editor");
+}
+
+static void TestHits(void)
+{
+    char* response;
+
+    Register();
+    CHECK(Lookup(HIERARCHY_CALL("1", "{\"depth\":2,\"root\":\"A\"}"), "1") == NULL, "Hit before any store");
+    Store(HIERARCHY_CALL("1", "{\"depth\":2,\"root\":\"A\"}"), HIERARCHY_RESULT);
+
+    /* Same arguments in another order and spacing, with a string id */
+    response = Lookup(HIERARCHY_CALL("\"b-7\"", "{ \"root\" : \"A\", \"depth\" : 2 }"), "\"b-7\"");
+    CHECK(response != NULL && strstr(response, "\"id\":\"b-7\"") != NULL && strstr(response, "Main Camera") != NULL,
+        "Canonical hit: %s", response != NULL ? response : "(miss)");
+    free(response);
+
+    response = Lookup(HIERARCHY_CALL("2", "{\"depth\":3,\"root\":\"A\"}"), "2");
+    CHECK(response == NULL, "Other arguments hit: %s", response);
+    free(response);
+
+    /* _meta is not part of the key */
+    response = Lookup("{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"tools/call\",\"params\":{\"name\":"
+        "\"scene_get_hierarchy\",\"arguments\":{\"depth\":2,\"root\":\"A\"},\"_meta\":{\"progressToken\":9}}}", "3");
+    CHECK(response != NULL && strstr(response, "\"id\":3") != NULL, "_meta changed the key");
+    free(response);
+
+    /* Prefix registrations and method-wide ones */
+    Store("{\"id\":4,\"method\":\"resources/read\",\"params\":{\"uri\":\"scene://gameobject/42\"}}",
+        "{\"jsonrpc\":\"2.0\",\"id\":4,\"result\":{\"contents\":[]}}");
+    response = Lookup("{\"id\":5,\"method\":\"resources/read\",\"params\":{\"uri\":\"scene://gameobject/42\"}}", "5");
+    CHECK(response != NULL && strstr(response, "\"id\":5") != NULL, "Prefix registration miss");
+    free(response);
+    Store("{\"id\":6,\"method\":\"tools/list\"}", "{\"jsonrpc\":\"2.0\",\"id\":6,\"result\":{\"tools\":[]}}");
+    response = Lookup("{\"id\":7,\"method\":\"tools/list\"}", "7");
+    CHECK(response != NULL && strstr(response, "\"id\":7") != NULL, "Method registration miss");
+    free(response);
+}
+
+static void TestClasses(void)
+{
+    Register();
+    CHECK(Classify(HIERARCHY_CALL("1", "{}")) == CACHE_CLASS_CACHEABLE, "Registered tool not cacheable");
+    CHECK(Classify("{\"id\":1,\"method\":\"tools/call\",\"params\":{\"name\":\"console_read\"}}") == CACHE_CLASS_READONLY,
+        "Tool without epochs cached");
+    CHECK(Classify("{\"id\":1,\"method\":\"tools/call\",\"params\":{\"name\":\"gameobject_create\"}}") == CACHE_CLASS_MUTATING,
+        "Unregistered tool not mutating");
+    CHECK(Classify("{\"id\":1,\"method\":\"prompts/get\",\"params\":{\"name\":\"x\"}}") == CACHE_CLASS_READONLY,
+        "Unregistered method not read-only");
+    CHECK(Classify("{\"id\":1,\"method\":\"tools/call\",\"params\":{\"name\":\"scene_get_hierarchy\","
+        "\"_meta\":{\"blobUrls\":true}}}") == CACHE_CLASS_READONLY, "Blob URL request cacheable");
+    CHECK(Classify("{\"id\":1,\"method\":\"tools/call\",\"params\":{\"name\":\"scene_get_hierarchy\",\"arguments\":{]}}")
+        != CACHE_CLASS_CACHEABLE, "Malformed arguments cacheable");
+}
+
+static void TestEpochs(void)
+{
+    char* response;
+
+    Register();
+    Store(HIERARCHY_CALL("1", "{}"), HIERARCHY_RESULT);
+    Store("{\"id\":2,\"method\":\"tools/list\"}", "{\"jsonrpc\":\"2.0\",\"id\":2,\"result\":{\"tools\":[]}}");
+
+    BumpCacheEpoch("assets");
+    response = Lookup(HIERARCHY_CALL("3", "{}"), "3");
+    CHECK(response != NULL, "Unrelated epoch invalidated the entry");
+    free(response);
+
+    BumpCacheEpoch("selection");
+    response = Lookup(HIERARCHY_CALL("4", "{}"), "4");
+    CHECK(response == NULL, "Entry survived a bump of its epoch");
+    free(response);
+    response = Lookup("{\"id\":5,\"method\":\"tools/list\"}", "5");
+    CHECK(response != NULL, "Bump invalidated an entry of another epoch");
+    free(response);
+
+    /* A request classified before a bump must not store a reply stale to the new epoch */
+    {
+        CacheRequest request;
+        CacheClassify(mg_str(HIERARCHY_CALL("6", "{}")), &request);
+        BumpCacheEpoch("scene");
+        CacheStore(&request, HIERARCHY_RESULT, strlen(HIERARCHY_RESULT));
+        CacheRelease(&request);
+    }
+    response = Lookup(HIERARCHY_CALL("7", "{}"), "7");
+    CHECK(response == NULL, "Reply computed before a bump was served after it");
+    free(response);
+
+    /* What the server thread does for a mutating tools/call */
+    Store(HIERARCHY_CALL("8", "{}"), HIERARCHY_RESULT);
+    CacheInvalidateAll();
+    response = Lookup(HIERARCHY_CALL("9", "{}"), "9");
+    CHECK(response == NULL, "Entry survived invalidating everything");
+    free(response);
+    response = Lookup("{\"id\":10,\"method\":\"tools/list\"}", "10");
+    CHECK(response == NULL, "tools/list survived invalidating everything");
+    free(response);
+
+    Store(HIERARCHY_CALL("11", "{}"), HIERARCHY_RESULT);
+    BumpCacheEpoch("*");
+    response = Lookup(HIERARCHY_CALL("12", "{}"), "12");
+    CHECK(response == NULL, "Entry survived BumpCacheEpoch(\"*\")");
+    free(response);
+}
+
+static void TestErrorsNotStored(void)
+{
+    char* response;
+
+    Register();
+    Store(HIERARCHY_CALL("1", "{}"), "{\"jsonrpc\":\"2.0\",\"id\":1,\"error\":{\"code\":-32603,\"message\":\"x\"}}");
+    response = Lookup(HIERARCHY_CALL("2", "{}"), "2");
+    CHECK(response == NULL, "Error reply cached");
+    free(response);
+
+    Store(HIERARCHY_CALL("3", "{}"), "{\"jsonrpc\":\"2.0\",\"id\":3,\"result\":{\"content\":[],\"isError\":true}}");
+    response = Lookup(HIERARCHY_CALL("4", "{}"), "4");
+    CHECK(response == NULL, "isError result cached");
+    free(response);
+}
+
+#define SCENE_READ(id, meta) \
+    "{\"jsonrpc\":\"2.0\",\"id\":" id ",\"method\":\"resources/read\"," \
+    "\"params\":{\"uri\":\"scene://gameobject/42\"" meta "}}"
+
+#define SCENE_RESULT(id, text) \
+    "{\"jsonrpc\":\"2.0\",\"id\":" id ",\"result\":{\"contents\":[{\"text\":\"" text "\"}]}}"
+
+/*
+ * Tag a reply as the server thread does before storing it. Returns the
+ * tagged reply (caller frees) and writes its ETag to etag.
+ */
+static char* Tag(const char* body, const char* response, char* etag)
+{
+    CacheRequest request;
+    size_t length = 0;
+    char* tagged;
+
+    CacheClassify(mg_str(body), &request);
+    tagged = CacheTagResponse(&request, response, strlen(response), etag, &length);
+    CHECK(tagged == NULL || length == strlen(tagged), "Tagged length %lu", (unsigned long)length);
+    CacheRelease(&request);
+    return tagged;
+}
+
+static void TestETags(void)
+{
+    char etag[CACHE_ETAG_SIZE] = "";
+    char other[CACHE_ETAG_SIZE] = "";
+    char expected[128];
+    char body[256];
+    char* tagged;
+    char* response;
+
+    Register();
+    tagged = Tag(SCENE_READ("1", ""), SCENE_RESULT("1", "Cube"), etag);
+    snprintf(expected, sizeof(expected), "\"result\":{\"_meta\":{\"etag\":\"%s\"},\"contents\"", etag);
+    CHECK(tagged != NULL && strlen(etag) == 16 && strstr(tagged, expected) != NULL,
+        "Tagged reply: %s", tagged != NULL ? tagged : "(none)");
+
+    /* The tag covers the result only */
+    free(Tag(SCENE_READ("2", ""), SCENE_RESULT("\"x\"", "Cube"), other));
+    CHECK(strcmp(etag, other) == 0, "ETag depends on the id: %s vs %s", etag, other);
+    free(Tag(SCENE_READ("3", ""), SCENE_RESULT("3", "Sphere"), other));
+    CHECK(strcmp(etag, other) != 0, "Other contents, same ETag %s", etag);
+    CHECK(Tag(SCENE_READ("4", ""), "{\"jsonrpc\":\"2.0\",\"id\":4,\"error\":{\"code\":-32602}}", other) == NULL,
+        "Error reply tagged");
+    CHECK(Tag(HIERARCHY_CALL("5", "{}"), HIERARCHY_RESULT, other) == NULL, "tools/call reply tagged");
+
+    if (tagged == NULL)
+    {
+        return;
+    }
+    Store(SCENE_READ("1", ""), tagged);
+
+    /* The client's copy is current */
+    snprintf(body, sizeof(body), SCENE_READ("6", ",\"_meta\":{\"ifNoneMatch\":\"%s\"}"), etag);
+    response = Lookup(body, "6");
+    CHECK(response != NULL && strstr(response, "\"notModified\":true") != NULL && strstr(response, "\"id\":6") != NULL &&
+        strstr(response, "Cube") == NULL, "Not modified: %s", response != NULL ? response : "(miss)");
+    free(response);
+
+    /* The client's copy is stale: the full reply, with the current tag */
+    response = Lookup(SCENE_READ("7", ",\"_meta\":{\"ifNoneMatch\":\"0123456789abcdef\"}"), "7");
+    CHECK(response != NULL && strstr(response, "notModified") == NULL && strstr(response, "Cube") != NULL &&
+        strstr(response, etag) != NULL && strstr(response, "\"id\":7") != NULL,
+        "ETag mismatch: %s", response != NULL ? response : "(miss)");
+    free(response);
+
+    /* An invalidated entry is a miss even for a matching tag */
+    BumpCacheEpoch("scene");
+    response = Lookup(body, "8");
+    CHECK(response == NULL, "Not modified after a bump: %s", response);
+    free(response);
+    free(tagged);
+}
+
+static void TestBudgetAndTtl(void)
+{
+    char body[256];
+    char reply[2048];
+    char* response;
+    int i;
+
+    /* Entries larger than a quarter of the budget are not kept; older ones are evicted */
+    Register();
+    ConfigureResponseCache(16 * 1024, 0);
+    for (i = 0; i < 32; i++)
+    {
+        snprintf(body, sizeof(body), HIERARCHY_CALL("1", "{\"root\":\"%d\"}"), i);
+        snprintf(reply, sizeof(reply), "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":{\"text\":\"%01000d\"}}", i);
+        Store(body, reply);
+    }
+    CHECK(strstr(GetResponseCacheStats(), "\"evictions\":0,") == NULL, "Nothing evicted: %s", GetResponseCacheStats());
+    snprintf(body, sizeof(body), HIERARCHY_CALL("1", "{\"root\":\"%d\"}"), 31);
+    response = Lookup(body, "2");
+    CHECK(response != NULL, "Newest entry evicted");
+    free(response);
+    snprintf(body, sizeof(body), HIERARCHY_CALL("1", "{\"root\":\"%d\"}"), 0);
+    response = Lookup(body, "2");
+    CHECK(response == NULL, "Oldest entry kept past the budget");
+    free(response);
+
+    ConfigureResponseCache(0, 0);
+    CHECK(Classify(HIERARCHY_CALL("1", "{}")) == CACHE_CLASS_READONLY, "Cacheable with a zero budget");
+
+    ConfigureResponseCache(CACHE_DEFAULT_BUDGET, 50);
+    Store(HIERARCHY_CALL("1", "{}"), HIERARCHY_RESULT);
+    response = Lookup(HIERARCHY_CALL("2", "{}"), "2");
+    CHECK(response != NULL, "Entry expired early");
+    free(response);
+    PROXY_SLEEP_MS(80);
+    response = Lookup(HIERARCHY_CALL("3", "{}"), "3");
+    CHECK(response == NULL, "Entry outlived its time-to-live");
+    free(response);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+    {
+        printf("Usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    TestHits();
+    TestClasses();
+    TestEpochs();
+    TestErrorsNotStored();
+    TestETags();
+    TestBudgetAndTtl();
+
+    printf("%d checks, %d failed\n", s_checks, s_failures);
+    return s_failures == 0 ? 0 : 1;
+}
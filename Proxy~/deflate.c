@@ -0,0 +1,1080 @@
+/*
+ * UnixxtyMCP Proxy - Deflate compressor and decompressor
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "deflate.h"
+#include "platform.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define HASH_BITS 15
+#define HASH_SIZE (1 << HASH_BITS)
+#define WINDOW_MASK (DEFLATE_WINDOW_SIZE - 1)
+#define MIN_MATCH 4                 /* The hash covers 4 bytes */
+#define MAX_MATCH 258
+#define BLOCK_SYMBOLS 32768
+#define LITLEN_CODES 286
+#define DIST_CODES 30
+#define CODELEN_CODES 19
+#define MAX_CODE_BITS 15
+#define MAX_CODELEN_BITS 7
+#define STORED_MAX 65535
+
+static const uint16_t LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t DIST_BASE[DIST_CODES] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t DIST_EXTRA[DIST_CODES] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static const uint8_t CODELEN_ORDER[CODELEN_CODES] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+/* Per level: hash chain candidates to try, and the length that ends the search */
+static const int LEVEL_CHAIN[10] = { 0, 4, 6, 10, 16, 32, 64, 128, 256, 1024 };
+static const int LEVEL_NICE[10] = { 0, 16, 32, 64, 64, 128, 128, 258, 258, 258 };
+
+static ProxyMutex s_table_lock = PROXY_MUTEX_INITIALIZER;
+static volatile int s_tables_ready = 0;
+static uint8_t s_length_code[MAX_MATCH + 1];
+static uint8_t s_dist_code[512];    /* dist-1 < 256 directly, else 256 + ((dist-1) >> 7) */
+static uint32_t s_crc_table[4][256];
+
+typedef struct BitWriter
+{
+    DeflateOutput* out;
+    uint64_t bits;
+    int count;
+} BitWriter;
+
+typedef struct Compressor
+{
+    const unsigned char* input;
+    size_t length;
+    int level;
+    int32_t head[HASH_SIZE];
+    int32_t prev[DEFLATE_WINDOW_SIZE];
+    uint16_t sym_litlen[BLOCK_SYMBOLS];
+    uint16_t sym_dist[BLOCK_SYMBOLS];       /* 0 for literals */
+    size_t sym_count;
+    uint32_t litlen_freq[LITLEN_CODES];
+    uint32_t dist_freq[DIST_CODES];
+    BitWriter writer;
+} Compressor;
+
+static void InitTables(void)
+{
+    int code, i;
+
+    if (s_tables_ready)
+    {
+        return;
+    }
+    PROXY_MUTEX_LOCK(&s_table_lock);
+    if (!s_tables_ready)
+    {
+        for (code = 0; code < 29; code++)
+        {
+            int end = code < 28 ? LENGTH_BASE[code + 1] : MAX_MATCH + 1;
+            for (i = LENGTH_BASE[code]; i < end; i++)
+            {
+                s_length_code[i] = (uint8_t)code;
+            }
+        }
+        s_length_code[MAX_MATCH] = 28;
+        for (code = 0; code < DIST_CODES; code++)
+        {
+            int end = code < DIST_CODES - 1 ? DIST_BASE[code + 1] : DEFLATE_WINDOW_SIZE + 1;
+            for (i = DIST_BASE[code]; i < end; i++)
+            {
+                if (i - 1 < 256) s_dist_code[i - 1] = (uint8_t)code;
+                else s_dist_code[256 + ((i - 1) >> 7)] = (uint8_t)code;
+            }
+        }
+        for (i = 0; i < 256; i++)
+        {
+            uint32_t crc = (uint32_t)i;
+            int bit;
+            for (bit = 0; bit < 8; bit++)
+            {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+            }
+            s_crc_table[0][i] = crc;
+        }
+        for (i = 0; i < 256; i++)
+        {
+            s_crc_table[1][i] = (s_crc_table[0][i] >> 8) ^ s_crc_table[0][s_crc_table[0][i] & 0xff];
+            s_crc_table[2][i] = (s_crc_table[1][i] >> 8) ^ s_crc_table[0][s_crc_table[1][i] & 0xff];
+            s_crc_table[3][i] = (s_crc_table[2][i] >> 8) ^ s_crc_table[0][s_crc_table[2][i] & 0xff];
+        }
+        s_tables_ready = 1;
+    }
+    PROXY_MUTEX_UNLOCK(&s_table_lock);
+}
+
+static int DistanceCode(unsigned distance)
+{
+    return distance <= 256 ? s_dist_code[distance - 1] : s_dist_code[256 + ((distance - 1) >> 7)];
+}
+
+/*
+ * Bit output
+ */
+
+static int Reserve(DeflateOutput* out, size_t extra)
+{
+    if (out->length + extra > out->capacity)
+    {
+        size_t capacity = out->capacity > 0 ? out->capacity : 4096;
+        unsigned char* data;
+        while (capacity < out->length + extra)
+        {
+            capacity *= 2;
+        }
+        data = (unsigned char*)realloc(out->data, capacity);
+        if (data == NULL)
+        {
+            return 0;
+        }
+        out->data = data;
+        out->capacity = capacity;
+    }
+    return 1;
+}
+
+static void PutBits(BitWriter* writer, uint32_t value, int count)
+{
+    writer->bits |= (uint64_t)value << writer->count;
+    writer->count += count;
+    while (writer->count >= 8)
+    {
+        writer->out->data[writer->out->length++] = (unsigned char)writer->bits;
+        writer->bits >>= 8;
+        writer->count -= 8;
+    }
+}
+
+static void AlignToByte(BitWriter* writer)
+{
+    if (writer->count > 0)
+    {
+        writer->out->data[writer->out->length++] = (unsigned char)writer->bits;
+        writer->bits = 0;
+        writer->count = 0;
+    }
+}
+
+/*
+ * Huffman codes
+ */
+
+static int CompareKeys(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/*
+ * Optimal code lengths for `freq`, limited to `limit` bits.
+ */
+static void BuildLengths(const uint32_t* freq, int count, int limit, uint8_t* lengths)
+{
+    uint64_t keys[LITLEN_CODES];
+    uint64_t weight[2 * LITLEN_CODES];
+    int parent[2 * LITLEN_CODES];
+    int depth[2 * LITLEN_CODES];
+    int bl_count[64];
+    int n = 0, i, leaf, node, next, max_depth = 0, symbol_index, bits;
+
+    memset(lengths, 0, (size_t)count);
+    for (i = 0; i < count; i++)
+    {
+        if (freq[i] > 0)
+        {
+            keys[n++] = ((uint64_t)freq[i] << 9) | (uint64_t)i;
+        }
+    }
+    if (n == 0)
+    {
+        return;
+    }
+    if (n == 1)
+    {
+        lengths[keys[0] & 511] = 1;
+        return;
+    }
+    qsort(keys, (size_t)n, sizeof(uint64_t), CompareKeys);
+
+    /* Two-queue Huffman: leaves in ascending weight, merged nodes are created in ascending weight too */
+    for (i = 0; i < n; i++)
+    {
+        weight[i] = keys[i] >> 9;
+    }
+    leaf = 0;
+    node = n;
+    for (next = n; next < 2 * n - 1; next++)
+    {
+        int pick, k;
+        weight[next] = 0;
+        for (k = 0; k < 2; k++)
+        {
+            if (leaf < n && (node >= next || weight[leaf] <= weight[node])) pick = leaf++;
+            else pick = node++;
+            weight[next] += weight[pick];
+            parent[pick] = next;
+        }
+    }
+    depth[2 * n - 2] = 0;
+    for (i = 2 * n - 3; i >= 0; i--)
+    {
+        depth[i] = depth[parent[i]] + 1;
+    }
+
+    memset(bl_count, 0, sizeof(bl_count));
+    for (i = 0; i < n; i++)
+    {
+        bl_count[depth[i]]++;
+        if (depth[i] > max_depth) max_depth = depth[i];
+    }
+
+    /* Move leaves up until nothing is deeper than the limit (JPEG Annex K.3) */
+    for (i = max_depth; i > limit; i--)
+    {
+        while (bl_count[i] > 0)
+        {
+            int j = i - 2;
+            while (bl_count[j] == 0)
+            {
+                j--;
+            }
+            bl_count[i] -= 2;
+            bl_count[i - 1] += 1;
+            bl_count[j + 1] += 2;
+            bl_count[j] -= 1;
+        }
+    }
+    if (max_depth > limit)
+    {
+        max_depth = limit;
+    }
+
+    /* Rarest symbols get the longest codes */
+    symbol_index = 0;
+    for (bits = max_depth; bits >= 1; bits--)
+    {
+        for (i = 0; i < bl_count[bits]; i++)
+        {
+            lengths[keys[symbol_index++] & 511] = (uint8_t)bits;
+        }
+    }
+}
+
+static void BuildCodes(const uint8_t* lengths, int count, uint16_t* codes)
+{
+    int bl_count[MAX_CODE_BITS + 1];
+    int next_code[MAX_CODE_BITS + 1];
+    int code = 0, bits, i;
+
+    memset(bl_count, 0, sizeof(bl_count));
+    for (i = 0; i < count; i++)
+    {
+        bl_count[lengths[i]]++;
+    }
+    bl_count[0] = 0;
+    for (bits = 1; bits <= MAX_CODE_BITS; bits++)
+    {
+        code = (code + bl_count[bits - 1]) << 1;
+        next_code[bits] = code;
+    }
+    for (i = 0; i < count; i++)
+    {
+        int length = lengths[i];
+        if (length > 0)
+        {
+            /* Huffman codes are sent most significant bit first */
+            unsigned value = (unsigned)next_code[length]++;
+            unsigned reversed = 0;
+            int b;
+            for (b = 0; b < length; b++)
+            {
+                reversed = (reversed << 1) | (value & 1);
+                value >>= 1;
+            }
+            codes[i] = (uint16_t)reversed;
+        }
+        else
+        {
+            codes[i] = 0;
+        }
+    }
+}
+
+/*
+ * Blocks
+ */
+
+static void WriteStored(Compressor* compressor, size_t start, size_t end, int final)
+{
+    BitWriter* writer = &compressor->writer;
+    do
+    {
+        size_t chunk = end - start > STORED_MAX ? STORED_MAX : end - start;
+        int last = final && start + chunk == end;
+        PutBits(writer, (uint32_t)last, 1);
+        PutBits(writer, 0, 2);
+        AlignToByte(writer);
+        writer->out->data[writer->out->length++] = (unsigned char)(chunk & 0xff);
+        writer->out->data[writer->out->length++] = (unsigned char)(chunk >> 8);
+        writer->out->data[writer->out->length++] = (unsigned char)(~chunk & 0xff);
+        writer->out->data[writer->out->length++] = (unsigned char)((~chunk >> 8) & 0xff);
+        memcpy(writer->out->data + writer->out->length, compressor->input + start, chunk);
+        writer->out->length += chunk;
+        start += chunk;
+    } while (start < end);
+}
+
+/*
+ * Emit the buffered symbols for input [start, end) as one block, dynamic
+ * Huffman or stored, whichever is smaller.
+ */
+static int FlushBlock(Compressor* compressor, size_t start, size_t end, int final)
+{
+    BitWriter* writer = &compressor->writer;
+    uint8_t litlen_lengths[LITLEN_CODES], dist_lengths[DIST_CODES], codelen_lengths[CODELEN_CODES];
+    uint16_t litlen_codes[LITLEN_CODES], dist_codes[DIST_CODES], codelen_codes[CODELEN_CODES];
+    uint8_t all_lengths[LITLEN_CODES + DIST_CODES];
+    uint8_t rle_symbols[LITLEN_CODES + DIST_CODES];
+    uint8_t rle_extra[LITLEN_CODES + DIST_CODES];
+    uint32_t codelen_freq[CODELEN_CODES];
+    size_t rle_count = 0, i, stored_chunks, symbol;
+    uint64_t dynamic_bits, stored_bits;
+    int hlit, hdist, hclen, total, run;
+
+    compressor->litlen_freq[256]++;
+    BuildLengths(compressor->litlen_freq, LITLEN_CODES, MAX_CODE_BITS, litlen_lengths);
+    BuildLengths(compressor->dist_freq, DIST_CODES, MAX_CODE_BITS, dist_lengths);
+    if (compressor->sym_count == 0 || compressor->level == 0)
+    {
+        memset(dist_lengths, 0, sizeof(dist_lengths));
+    }
+    for (i = 0; i < DIST_CODES && dist_lengths[i] == 0; i++)
+    {
+    }
+    if (i == DIST_CODES)
+    {
+        dist_lengths[0] = 1;  /* A block must describe at least one distance code */
+    }
+
+    for (hlit = LITLEN_CODES; hlit > 257 && litlen_lengths[hlit - 1] == 0; hlit--)
+    {
+    }
+    for (hdist = DIST_CODES; hdist > 1 && dist_lengths[hdist - 1] == 0; hdist--)
+    {
+    }
+    memcpy(all_lengths, litlen_lengths, (size_t)hlit);
+    memcpy(all_lengths + hlit, dist_lengths, (size_t)hdist);
+    total = hlit + hdist;
+
+    /* Run-length encode the code lengths (16: repeat previous, 17/18: zeros) */
+    memset(codelen_freq, 0, sizeof(codelen_freq));
+    for (i = 0; i < (size_t)total; i += (size_t)run)
+    {
+        uint8_t length = all_lengths[i];
+        for (run = 1; i + (size_t)run < (size_t)total && all_lengths[i + (size_t)run] == length; run++)
+        {
+        }
+        if (length == 0 && run >= 11)
+        {
+            if (run > 138) run = 138;
+            rle_symbols[rle_count] = 18;
+            rle_extra[rle_count++] = (uint8_t)(run - 11);
+        }
+        else if (length == 0 && run >= 3)
+        {
+            rle_symbols[rle_count] = 17;
+            rle_extra[rle_count++] = (uint8_t)(run - 3);
+        }
+        else if (length != 0 && run >= 4)
+        {
+            rle_symbols[rle_count] = length;
+            rle_extra[rle_count++] = 0;
+            codelen_freq[length]++;
+            run = run - 1 > 6 ? 6 : run - 1;
+            rle_symbols[rle_count] = 16;
+            rle_extra[rle_count++] = (uint8_t)(run - 3);
+            run++;
+        }
+        else
+        {
+            rle_symbols[rle_count] = length;
+            rle_extra[rle_count++] = 0;
+            run = 1;
+        }
+        if (rle_symbols[rle_count - 1] >= 16 || run == 1)
+        {
+            codelen_freq[rle_symbols[rle_count - 1]]++;
+        }
+    }
+    BuildLengths(codelen_freq, CODELEN_CODES, MAX_CODELEN_BITS, codelen_lengths);
+    for (hclen = CODELEN_CODES; hclen > 4 && codelen_lengths[CODELEN_ORDER[hclen - 1]] == 0; hclen--)
+    {
+    }
+
+    /* Compare sizes */
+    dynamic_bits = 3 + 5 + 5 + 4 + 3 * (uint64_t)hclen;
+    for (i = 0; i < CODELEN_CODES; i++)
+    {
+        dynamic_bits += (uint64_t)codelen_freq[i] * codelen_lengths[i];
+    }
+    dynamic_bits += 2 * (uint64_t)codelen_freq[16] + 3 * (uint64_t)codelen_freq[17] + 7 * (uint64_t)codelen_freq[18];
+    for (i = 0; i < LITLEN_CODES; i++)
+    {
+        dynamic_bits += (uint64_t)compressor->litlen_freq[i] *
+            (litlen_lengths[i] + (i >= 257 ? LENGTH_EXTRA[i - 257] : 0));
+    }
+    for (i = 0; i < DIST_CODES; i++)
+    {
+        dynamic_bits += (uint64_t)compressor->dist_freq[i] * (dist_lengths[i] + DIST_EXTRA[i]);
+    }
+    stored_chunks = (end - start + STORED_MAX - 1) / STORED_MAX;
+    if (stored_chunks == 0) stored_chunks = 1;
+    stored_bits = (uint64_t)stored_chunks * (3 + 7 + 32) + 8 * (uint64_t)(end - start);
+
+    if (!Reserve(writer->out, (end - start) + stored_chunks * 5 + compressor->sym_count * 6 + 1024))
+    {
+        return 0;
+    }
+
+    if (compressor->level == 0 || stored_bits <= dynamic_bits)
+    {
+        WriteStored(compressor, start, end, final);
+    }
+    else
+    {
+        BuildCodes(litlen_lengths, LITLEN_CODES, litlen_codes);
+        BuildCodes(dist_lengths, DIST_CODES, dist_codes);
+        BuildCodes(codelen_lengths, CODELEN_CODES, codelen_codes);
+
+        PutBits(writer, (uint32_t)final, 1);
+        PutBits(writer, 2, 2);
+        PutBits(writer, (uint32_t)(hlit - 257), 5);
+        PutBits(writer, (uint32_t)(hdist - 1), 5);
+        PutBits(writer, (uint32_t)(hclen - 4), 4);
+        for (i = 0; i < (size_t)hclen; i++)
+        {
+            PutBits(writer, codelen_lengths[CODELEN_ORDER[i]], 3);
+        }
+        for (i = 0; i < rle_count; i++)
+        {
+            uint8_t code = rle_symbols[i];
+            PutBits(writer, codelen_codes[code], codelen_lengths[code]);
+            if (code == 16) PutBits(writer, rle_extra[i], 2);
+            else if (code == 17) PutBits(writer, rle_extra[i], 3);
+            else if (code == 18) PutBits(writer, rle_extra[i], 7);
+        }
+
+        for (symbol = 0; symbol < compressor->sym_count; symbol++)
+        {
+            unsigned value = compressor->sym_litlen[symbol];
+            unsigned distance = compressor->sym_dist[symbol];
+            if (distance == 0)
+            {
+                PutBits(writer, litlen_codes[value], litlen_lengths[value]);
+            }
+            else
+            {
+                int length_code = s_length_code[value];
+                int dist_code = DistanceCode(distance);
+                PutBits(writer, litlen_codes[257 + length_code], litlen_lengths[257 + length_code]);
+                PutBits(writer, value - LENGTH_BASE[length_code], LENGTH_EXTRA[length_code]);
+                PutBits(writer, dist_codes[dist_code], dist_lengths[dist_code]);
+                PutBits(writer, distance - DIST_BASE[dist_code], DIST_EXTRA[dist_code]);
+            }
+        }
+        PutBits(writer, litlen_codes[256], litlen_lengths[256]);
+    }
+
+    compressor->sym_count = 0;
+    memset(compressor->litlen_freq, 0, sizeof(compressor->litlen_freq));
+    memset(compressor->dist_freq, 0, sizeof(compressor->dist_freq));
+    return 1;
+}
+
+/*
+ * Matching
+ */
+
+static uint32_t HashAt(const unsigned char* p)
+{
+    uint32_t value = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    return (value * 0x9E3779B1u) >> (32 - HASH_BITS);
+}
+
+static void Insert(Compressor* compressor, size_t position)
+{
+    uint32_t hash = HashAt(compressor->input + position);
+    compressor->prev[position & WINDOW_MASK] = compressor->head[hash];
+    compressor->head[hash] = (int32_t)position;
+}
+
+static size_t MatchLength(const unsigned char* a, const unsigned char* b, size_t max_length)
+{
+    size_t length = 0;
+    while (length + 8 <= max_length)
+    {
+        uint64_t x, y;
+        memcpy(&x, a + length, 8);
+        memcpy(&y, b + length, 8);
+        if (x != y)
+        {
+            break;
+        }
+        length += 8;
+    }
+    while (length < max_length && a[length] == b[length])
+    {
+        length++;
+    }
+    return length;
+}
+
+/*
+ * Longest match for `position` among the hash chain, or 0.
+ */
+static size_t FindMatch(const Compressor* compressor, size_t position, size_t* distance)
+{
+    const unsigned char* input = compressor->input;
+    size_t max_length = compressor->length - position;
+    size_t best = 0;
+    int chain = LEVEL_CHAIN[compressor->level];
+    size_t nice = (size_t)LEVEL_NICE[compressor->level];
+    int32_t candidate = compressor->head[HashAt(input + position)];
+
+    if (max_length > MAX_MATCH) max_length = MAX_MATCH;
+    if (nice > max_length) nice = max_length;
+
+    while (candidate >= 0 && position - (size_t)candidate <= DEFLATE_WINDOW_SIZE && chain-- > 0)
+    {
+        const unsigned char* match = input + candidate;
+        int32_t next;
+        if (match[best] == input[position + best] && match[0] == input[position])
+        {
+            size_t length = MatchLength(match, input + position, max_length);
+            if (length > best)
+            {
+                best = length;
+                *distance = position - (size_t)candidate;
+                if (best >= nice)
+                {
+                    break;
+                }
+            }
+        }
+        next = compressor->prev[candidate & WINDOW_MASK];
+        if (next >= candidate)
+        {
+            break;  /* Slot reused by a newer position */
+        }
+        candidate = next;
+    }
+    return best >= MIN_MATCH ? best : 0;
+}
+
+int DeflateCompress(const unsigned char* input, size_t dictionary_length, size_t length,
+    int level, int final, DeflateOutput* output)
+{
+    Compressor* compressor;
+    size_t position, block_start, prime;
+    int ok = 1;
+
+    if (level < 0) level = 0;
+    if (level > 9) level = 9;
+    InitTables();
+
+    compressor = (Compressor*)malloc(sizeof(Compressor));
+    if (compressor == NULL)
+    {
+        return 0;
+    }
+    compressor->input = input;
+    compressor->length = length;
+    compressor->level = level;
+    compressor->sym_count = 0;
+    compressor->writer.out = output;
+    compressor->writer.bits = 0;
+    compressor->writer.count = 0;
+    memset(compressor->head, 0xff, sizeof(compressor->head));
+    memset(compressor->litlen_freq, 0, sizeof(compressor->litlen_freq));
+    memset(compressor->dist_freq, 0, sizeof(compressor->dist_freq));
+
+    position = dictionary_length;
+    block_start = position;
+
+    if (level > 0)
+    {
+        prime = dictionary_length > DEFLATE_WINDOW_SIZE ? dictionary_length - DEFLATE_WINDOW_SIZE : 0;
+        for (; prime < dictionary_length && prime + MIN_MATCH <= length; prime++)
+        {
+            Insert(compressor, prime);
+        }
+
+        while (position < length && ok)
+        {
+            size_t distance = 0;
+            size_t match = 0;
+
+            if (length - position >= MIN_MATCH)
+            {
+                match = FindMatch(compressor, position, &distance);
+                Insert(compressor, position);
+
+                /* Lazy matching: take a literal if the next position matches longer */
+                if (level >= 4 && match > 0 && match < (size_t)LEVEL_NICE[level] &&
+                    length - position - 1 >= MIN_MATCH)
+                {
+                    size_t next_distance = 0;
+                    if (FindMatch(compressor, position + 1, &next_distance) > match)
+                    {
+                        match = 0;
+                    }
+                }
+            }
+
+            if (match > 0)
+            {
+                size_t end = position + match;
+                compressor->sym_litlen[compressor->sym_count] = (uint16_t)match;
+                compressor->sym_dist[compressor->sym_count++] = (uint16_t)distance;
+                compressor->litlen_freq[257 + s_length_code[match]]++;
+                compressor->dist_freq[DistanceCode((unsigned)distance)]++;
+                for (position++; position < end; position++)
+                {
+                    if (position + MIN_MATCH <= length)
+                    {
+                        Insert(compressor, position);
+                    }
+                }
+            }
+            else
+            {
+                compressor->sym_litlen[compressor->sym_count] = input[position];
+                compressor->sym_dist[compressor->sym_count++] = 0;
+                compressor->litlen_freq[input[position]]++;
+                position++;
+            }
+
+            if (compressor->sym_count == BLOCK_SYMBOLS)
+            {
+                ok = FlushBlock(compressor, block_start, position, 0);
+                block_start = position;
+            }
+        }
+    }
+
+    if (ok)
+    {
+        ok = FlushBlock(compressor, block_start, length, final);
+    }
+    if (ok && !final)
+    {
+        /* Sync flush: an empty stored block leaves the stream byte-aligned */
+        ok = Reserve(output, 8);
+        if (ok)
+        {
+            PutBits(&compressor->writer, 0, 3);
+            AlignToByte(&compressor->writer);
+            memcpy(output->data + output->length, "\x00\x00\xff\xff", 4);
+            output->length += 4;
+        }
+    }
+    else if (ok)
+    {
+        ok = Reserve(output, 1);
+        if (ok)
+        {
+            AlignToByte(&compressor->writer);
+        }
+    }
+
+    free(compressor);
+    return ok;
+}
+
+/*
+ * Decompressor
+ */
+
+typedef struct BitReader
+{
+    const unsigned char* data;
+    size_t length;
+    size_t position;
+    uint32_t bits;
+    int count;
+    int failed;             /* Read past the end of the input */
+} BitReader;
+
+/* Canonical Huffman code: codes per length, then symbols in code order */
+typedef struct HuffmanDecoder
+{
+    int16_t count[MAX_CODE_BITS + 1];
+    int16_t symbol[LITLEN_CODES + 2];
+} HuffmanDecoder;
+
+static int GetBits(BitReader* reader, int need)
+{
+    uint32_t value = reader->bits;
+    while (reader->count < need)
+    {
+        if (reader->position >= reader->length)
+        {
+            reader->failed = 1;
+            return 0;
+        }
+        value |= (uint32_t)reader->data[reader->position++] << reader->count;
+        reader->count += 8;
+    }
+    reader->bits = value >> need;
+    reader->count -= need;
+    return (int)(value & ((1u << need) - 1));
+}
+
+/*
+ * Build a decoder from code lengths. Returns 0 for an over-subscribed set;
+ * incomplete sets are accepted and fail when an unused code is read.
+ */
+static int BuildDecoder(HuffmanDecoder* decoder, const uint8_t* lengths, int count)
+{
+    int16_t offsets[MAX_CODE_BITS + 1];
+    int left = 1;
+    int length, symbol;
+
+    memset(decoder->count, 0, sizeof(decoder->count));
+    for (symbol = 0; symbol < count; symbol++)
+    {
+        decoder->count[lengths[symbol]]++;
+    }
+    for (length = 1; length <= MAX_CODE_BITS; length++)
+    {
+        left = (left << 1) - decoder->count[length];
+        if (left < 0)
+        {
+            return 0;
+        }
+    }
+
+    offsets[1] = 0;
+    for (length = 1; length < MAX_CODE_BITS; length++)
+    {
+        offsets[length + 1] = (int16_t)(offsets[length] + decoder->count[length]);
+    }
+    for (symbol = 0; symbol < count; symbol++)
+    {
+        if (lengths[symbol] != 0)
+        {
+            decoder->symbol[offsets[lengths[symbol]]++] = (int16_t)symbol;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Read one symbol, a bit at a time (codes are stored most significant bit
+ * first). Returns -1 on an unused code or the end of the input.
+ */
+static int DecodeSymbol(BitReader* reader, const HuffmanDecoder* decoder)
+{
+    int code = 0, first = 0, index = 0;
+    int length;
+    for (length = 1; length <= MAX_CODE_BITS; length++)
+    {
+        int count;
+        code |= GetBits(reader, 1);
+        count = decoder->count[length];
+        if (code - count < first)
+        {
+            return reader->failed ? -1 : decoder->symbol[index + (code - first)];
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+static int InflateStored(BitReader* reader, unsigned char* output, size_t output_length, size_t* written)
+{
+    size_t length;
+
+    /* Drop the rest of the current byte */
+    reader->bits = 0;
+    reader->count = 0;
+    if (reader->length - reader->position < 4)
+    {
+        return 0;
+    }
+    length = reader->data[reader->position] | ((size_t)reader->data[reader->position + 1] << 8);
+    if (((size_t)reader->data[reader->position + 2] | ((size_t)reader->data[reader->position + 3] << 8)) != (~length & 0xffff))
+    {
+        return 0;
+    }
+    reader->position += 4;
+    if (reader->length - reader->position < length || output_length - *written < length)
+    {
+        return 0;
+    }
+    memcpy(output + *written, reader->data + reader->position, length);
+    reader->position += length;
+    *written += length;
+    return 1;
+}
+
+static int InflateCodes(BitReader* reader, const HuffmanDecoder* literals, const HuffmanDecoder* distances,
+    unsigned char* output, size_t output_length, size_t* written)
+{
+    for (;;)
+    {
+        int symbol = DecodeSymbol(reader, literals);
+        if (symbol < 0)
+        {
+            return 0;
+        }
+        if (symbol < 256)
+        {
+            if (*written >= output_length)
+            {
+                return 0;
+            }
+            output[(*written)++] = (unsigned char)symbol;
+        }
+        else if (symbol == 256)
+        {
+            return 1;
+        }
+        else
+        {
+            size_t length, distance;
+            symbol -= 257;
+            if (symbol >= 29)
+            {
+                return 0;
+            }
+            length = LENGTH_BASE[symbol] + (size_t)GetBits(reader, LENGTH_EXTRA[symbol]);
+            symbol = DecodeSymbol(reader, distances);
+            if (symbol < 0 || symbol >= DIST_CODES)
+            {
+                return 0;
+            }
+            distance = DIST_BASE[symbol] + (size_t)GetBits(reader, DIST_EXTRA[symbol]);
+            if (reader->failed || distance > *written || output_length - *written < length)
+            {
+                return 0;
+            }
+            /* Byte by byte: the source may overlap what is being written */
+            while (length-- > 0)
+            {
+                output[*written] = output[*written - distance];
+                (*written)++;
+            }
+        }
+    }
+}
+
+static int InflateDynamic(BitReader* reader, unsigned char* output, size_t output_length, size_t* written)
+{
+    uint8_t lengths[LITLEN_CODES + DIST_CODES];
+    HuffmanDecoder literals, distances;
+    int literal_count = GetBits(reader, 5) + 257;
+    int distance_count = GetBits(reader, 5) + 1;
+    int codelen_count = GetBits(reader, 4) + 4;
+    int index;
+
+    if (reader->failed || literal_count > LITLEN_CODES || distance_count > DIST_CODES)
+    {
+        return 0;
+    }
+    memset(lengths, 0, sizeof(lengths));
+    for (index = 0; index < codelen_count; index++)
+    {
+        lengths[CODELEN_ORDER[index]] = (uint8_t)GetBits(reader, 3);
+    }
+    if (!BuildDecoder(&literals, lengths, CODELEN_CODES))
+    {
+        return 0;
+    }
+
+    index = 0;
+    while (index < literal_count + distance_count)
+    {
+        int symbol = DecodeSymbol(reader, &literals);
+        int repeat;
+        uint8_t value = 0;
+
+        if (symbol < 0)
+        {
+            return 0;
+        }
+        if (symbol < 16)
+        {
+            lengths[index++] = (uint8_t)symbol;
+            continue;
+        }
+        if (symbol == 16)
+        {
+            if (index == 0)
+            {
+                return 0;
+            }
+            value = lengths[index - 1];
+            repeat = 3 + GetBits(reader, 2);
+        }
+        else if (symbol == 17)
+        {
+            repeat = 3 + GetBits(reader, 3);
+        }
+        else
+        {
+            repeat = 11 + GetBits(reader, 7);
+        }
+        if (reader->failed || index + repeat > literal_count + distance_count)
+        {
+            return 0;
+        }
+        while (repeat-- > 0)
+        {
+            lengths[index++] = value;
+        }
+    }
+
+    if (lengths[256] == 0 ||
+        !BuildDecoder(&literals, lengths, literal_count) ||
+        !BuildDecoder(&distances, lengths + literal_count, distance_count))
+    {
+        return 0;
+    }
+    return InflateCodes(reader, &literals, &distances, output, output_length, written);
+}
+
+static int InflateFixed(BitReader* reader, unsigned char* output, size_t output_length, size_t* written)
+{
+    uint8_t lengths[LITLEN_CODES + 2];
+    HuffmanDecoder literals, distances;
+    int symbol;
+
+    for (symbol = 0; symbol < 144; symbol++) lengths[symbol] = 8;
+    for (; symbol < 256; symbol++) lengths[symbol] = 9;
+    for (; symbol < 280; symbol++) lengths[symbol] = 7;
+    for (; symbol < LITLEN_CODES + 2; symbol++) lengths[symbol] = 8;
+    BuildDecoder(&literals, lengths, LITLEN_CODES + 2);
+    for (symbol = 0; symbol < DIST_CODES; symbol++) lengths[symbol] = 5;
+    BuildDecoder(&distances, lengths, DIST_CODES);
+    return InflateCodes(reader, &literals, &distances, output, output_length, written);
+}
+
+int DeflateDecompress(const unsigned char* input, size_t input_length, unsigned char* output,
+    size_t output_length, size_t* consumed)
+{
+    BitReader reader;
+    size_t written = 0;
+    int final = 0;
+
+    memset(&reader, 0, sizeof(reader));
+    reader.data = input;
+    reader.length = input_length;
+
+    while (!final)
+    {
+        int type, ok;
+        final = GetBits(&reader, 1);
+        type = GetBits(&reader, 2);
+        if (reader.failed)
+        {
+            return 0;
+        }
+        switch (type)
+        {
+            case 0: ok = InflateStored(&reader, output, output_length, &written); break;
+            case 1: ok = InflateFixed(&reader, output, output_length, &written); break;
+            case 2: ok = InflateDynamic(&reader, output, output_length, &written); break;
+            default: ok = 0; break;
+        }
+        if (!ok || reader.failed)
+        {
+            return 0;
+        }
+    }
+
+    if (consumed != NULL)
+    {
+        *consumed = reader.position;
+    }
+    return written == output_length;
+}
+
+/*
+ * Checksums
+ */
+
+#define ADLER_BASE 65521u
+#define ADLER_NMAX 5552
+
+uint32_t DeflateAdler32(uint32_t adler, const unsigned char* data, size_t length)
+{
+    uint32_t a = adler & 0xffff;
+    uint32_t b = adler >> 16;
+    while (length > 0)
+    {
+        size_t chunk = length < ADLER_NMAX ? length : ADLER_NMAX;
+        length -= chunk;
+        while (chunk-- > 0)
+        {
+            a += *data++;
+            b += a;
+        }
+        a %= ADLER_BASE;
+        b %= ADLER_BASE;
+    }
+    return (b << 16) | a;
+}
+
+uint32_t DeflateAdler32Combine(uint32_t adler_a, uint32_t adler_b, size_t length_b)
+{
+    uint32_t remainder = (uint32_t)(length_b % ADLER_BASE);
+    uint32_t sum1 = adler_a & 0xffff;
+    uint32_t sum2 = (uint32_t)(((uint64_t)remainder * sum1) % ADLER_BASE);
+    sum1 += (adler_b & 0xffff) + ADLER_BASE - 1;
+    sum2 += ((adler_a >> 16) & 0xffff) + ((adler_b >> 16) & 0xffff) + ADLER_BASE - remainder;
+    if (sum1 >= ADLER_BASE) sum1 -= ADLER_BASE;
+    if (sum1 >= ADLER_BASE) sum1 -= ADLER_BASE;
+    if (sum2 >= (ADLER_BASE << 1)) sum2 -= (ADLER_BASE << 1);
+    if (sum2 >= ADLER_BASE) sum2 -= ADLER_BASE;
+    return sum1 | (sum2 << 16);
+}
+
+uint32_t DeflateCrc32(uint32_t crc, const unsigned char* data, size_t length)
+{
+    InitTables();
+    crc = ~crc;
+    /* Slicing by 4 */
+    while (length >= 4)
+    {
+        crc ^= (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+        crc = s_crc_table[3][crc & 0xff] ^ s_crc_table[2][(crc >> 8) & 0xff] ^
+              s_crc_table[1][(crc >> 16) & 0xff] ^ s_crc_table[0][crc >> 24];
+        data += 4;
+        length -= 4;
+    }
+    while (length-- > 0)
+    {
+        crc = s_crc_table[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
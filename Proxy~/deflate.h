@@ -0,0 +1,63 @@
+/*
+ * UnixxtyMCP Proxy - Deflate compressor and decompressor
+ *
+ * A small raw-deflate (RFC 1951) encoder for the PNG writer: hash-chain
+ * LZ77 (greedy at low levels, one-step lazy from level 4), dynamic Huffman
+ * blocks with length-limited codes, and a stored-block fallback for data
+ * that does not compress. Streams are built to be cut into independent
+ * pieces, pigz style: each piece may be primed with the 32KB that precede
+ * it and, unless final, ends on a byte boundary with an empty stored block,
+ * so pieces compressed in parallel concatenate into one valid stream.
+ * The decompressor is a plain bit-at-a-time canonical Huffman decoder for
+ * uploads whose decompressed size is known up front.
+ * Adler-32 (with combine) and CRC-32 helpers for the zlib and PNG wrappers
+ * live here too.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_DEFLATE_H
+#define UNITY_MCP_DEFLATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DEFLATE_WINDOW_SIZE 32768
+
+/* Growable output buffer (free data with free()) */
+typedef struct DeflateOutput
+{
+    unsigned char* data;
+    size_t length;
+    size_t capacity;
+} DeflateOutput;
+
+/*
+ * Compress input[dictionary_length, length) and append it to `output`.
+ * The bytes before dictionary_length are not emitted but matches may refer
+ * to the last 32KB of them. Level 0 stores; 1-9 trade speed for ratio.
+ * Unless `final` is set the output ends with a sync flush. Returns 0 if
+ * out of memory.
+ */
+int DeflateCompress(const unsigned char* input, size_t dictionary_length, size_t length,
+    int level, int final, DeflateOutput* output);
+
+/*
+ * Decompress a raw deflate stream into exactly output_length bytes.
+ * `consumed` (optional) receives the number of input bytes used, which
+ * ends at the byte after the final block. Returns 0 for a corrupt or
+ * truncated stream, or one that does not fill the output exactly.
+ */
+int DeflateDecompress(const unsigned char* input, size_t input_length, unsigned char* output,
+    size_t output_length, size_t* consumed);
+
+uint32_t DeflateAdler32(uint32_t adler, const unsigned char* data, size_t length);
+
+/*
+ * Adler-32 of A followed by B, from the checksums of A and B and B's length.
+ */
+uint32_t DeflateAdler32Combine(uint32_t adler_a, uint32_t adler_b, size_t length_b);
+
+uint32_t DeflateCrc32(uint32_t crc, const unsigned char* data, size_t length);
+
+#endif /* UNITY_MCP_DEFLATE_H */
@@ -0,0 +1,1393 @@
+/*
+ * UnixxtyMCP Proxy - Editor.log tailer
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "editorlog.h"
+#include "project.h"
+#include "jsonutil.h"
+#include "platform.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+    #include <sys/inotify.h>
+    #include <poll.h>
+#endif
+
+enum
+{
+    SEVERITY_ERROR = 0,
+    SEVERITY_WARNING,
+    SEVERITY_LOG,
+    SEVERITY_COUNT
+};
+
+static const char* const SEVERITY_NAMES[] = { "error", "warning", "log" };
+
+enum
+{
+    KIND_COMPILER = 0,
+    KIND_EXCEPTION,
+    KIND_ASSERT,
+    KIND_LOG,
+    KIND_EDITOR
+};
+
+static const char* const KIND_NAMES[] = { "compiler", "exception", "assert", "log", "editor" };
+
+/* Lines announcing a script compilation, from the editor versions that print one */
+static const char* const COMPILE_MARKERS[] = {
+    "[ScriptCompilation] Requested script compilation",
+    "- Starting script compilation",
+};
+
+typedef struct LogEntry
+{
+    int64_t sequence;                /* 0 for a free slot */
+    int64_t epoch;                   /* Compile epoch it was logged in */
+    uint64_t hash;                   /* Of everything but the stack, to collapse repeats */
+    int severity;
+    int kind;
+    int superseded;                  /* Repeated by a later entry */
+    uint32_t count;                  /* Times logged, this one included */
+    uint32_t line;                   /* 0 if unknown */
+    uint32_t column;
+    char code[16];                   /* Compiler code, "" if none */
+    char* file;                      /* NULL if unknown */
+    char* message;
+    char* stack;                     /* NULL if none */
+} LogEntry;
+
+static ProxyMutex s_log_lock = PROXY_MUTEX_INITIALIZER;
+static ProxyCondition s_log_wake = PROXY_CONDITION_INITIALIZER;
+static LogEntry s_log_ring[EDITOR_LOG_CAPACITY];
+static int64_t s_log_sequence = 0;            /* Latest entry */
+static int64_t s_log_first = 1;               /* Oldest entry still held */
+static int64_t s_log_epoch = 0;
+static int s_log_session = 0;
+static char s_log_path[PROJECT_MAX_PATH];
+static const char* s_log_mode = "off";
+static uint64_t s_log_bytes = 0;              /* Read this session */
+static unsigned s_log_restarts = 0;
+static int s_log_started = 0;
+static char s_log_stats_buffer[256];
+
+/*
+ * Ring. The tailer appends, the server thread reads; both under s_log_lock.
+ */
+
+static void FreeEntry(LogEntry* entry)
+{
+    free(entry->file);
+    free(entry->message);
+    free(entry->stack);
+    memset(entry, 0, sizeof(*entry));
+}
+
+/*
+ * Empty the ring and start a new session. Caller holds the lock.
+ */
+static void ResetRing(void)
+{
+    int i;
+
+    for (i = 0; i < EDITOR_LOG_CAPACITY; i++)
+    {
+        if (s_log_ring[i].sequence != 0)
+        {
+            FreeEntry(&s_log_ring[i]);
+        }
+    }
+    s_log_first = s_log_sequence + 1;
+    s_log_session++;
+    s_log_bytes = 0;
+}
+
+/*
+ * Take ownership of an entry's strings and append it, superseding a recent
+ * repeat. Caller holds the lock.
+ */
+static void PushEntry(LogEntry* entry)
+{
+    int64_t sequence;
+    LogEntry* slot;
+
+    entry->count = 1;
+    for (sequence = s_log_sequence;
+         sequence >= s_log_first && sequence > s_log_sequence - EDITOR_LOG_COLLAPSE_WINDOW; sequence--)
+    {
+        LogEntry* previous = &s_log_ring[sequence % EDITOR_LOG_CAPACITY];
+        if (!previous->superseded && previous->hash == entry->hash)
+        {
+            previous->superseded = 1;
+            entry->count = previous->count + 1;
+            break;
+        }
+    }
+
+    s_log_sequence++;
+    slot = &s_log_ring[s_log_sequence % EDITOR_LOG_CAPACITY];
+    if (slot->sequence != 0)
+    {
+        FreeEntry(slot);
+        s_log_first = s_log_sequence - EDITOR_LOG_CAPACITY + 1;
+    }
+    *slot = *entry;
+    slot->sequence = s_log_sequence;
+    slot->epoch = s_log_epoch;
+}
+
+/*
+ * Compiler diagnostics of an earlier compile are resolved. Caller holds
+ * the lock.
+ */
+static int IsResolved(const LogEntry* entry)
+{
+    return entry->kind == KIND_COMPILER && entry->epoch < s_log_epoch;
+}
+
+static char* CopyText(const char* text, size_t length)
+{
+    char* copy = (char*)malloc(length + 1);
+    if (copy != NULL)
+    {
+        memcpy(copy, text, length);
+        copy[length] = '\0';
+    }
+    return copy;
+}
+
+static size_t TrimEnd(const char* text, size_t length)
+{
+    while (length > 0 && isspace((unsigned char)text[length - 1]))
+    {
+        length--;
+    }
+    return length;
+}
+
+/*
+ * Build an entry and append it. file and stack may be NULL.
+ */
+static void EmitEntry(int severity, int kind, const char* message, size_t message_length,
+    const char* stack, size_t stack_length, const char* file, size_t file_length,
+    uint32_t line, uint32_t column, const char* code, size_t code_length)
+{
+    LogEntry entry;
+    uint64_t hash;
+
+    memset(&entry, 0, sizeof(entry));
+    message_length = TrimEnd(message, message_length);
+    stack_length = stack != NULL ? TrimEnd(stack, stack_length) : 0;
+    if (code_length >= sizeof(entry.code))
+    {
+        code_length = 0;
+    }
+    entry.severity = severity;
+    entry.kind = kind;
+    entry.line = line;
+    entry.column = column;
+    if (code_length > 0)
+    {
+        memcpy(entry.code, code, code_length);
+    }
+    entry.message = CopyText(message, message_length);
+    entry.file = file != NULL && file_length > 0 ? CopyText(file, file_length) : NULL;
+    entry.stack = stack_length > 0 ? CopyText(stack, stack_length) : NULL;
+    if (entry.message == NULL || (file != NULL && file_length > 0 && entry.file == NULL) ||
+        (stack_length > 0 && entry.stack == NULL))
+    {
+        FreeEntry(&entry);
+        return;
+    }
+
+    hash = JsonHash64(&severity, sizeof(severity), (uint64_t)kind);
+    hash = JsonHash64(entry.code, strlen(entry.code), hash);
+    hash = JsonHash64(&line, sizeof(line), hash);
+    hash = JsonHash64(&column, sizeof(column), hash);
+    hash = entry.file != NULL ? JsonHash64(entry.file, file_length, hash) : hash;
+    entry.hash = JsonHash64(entry.message, message_length, hash);
+
+    PROXY_MUTEX_LOCK(&s_log_lock);
+    PushEntry(&entry);
+    PROXY_MUTEX_UNLOCK(&s_log_lock);
+}
+
+/*
+ * Parsing
+ */
+
+typedef struct LogParser
+{
+    char line[EDITOR_LOG_MAX_LINE + 1];
+    size_t line_length;
+    int skip_line;                   /* Drop the line being read (backfill started mid-line) */
+    struct mg_iobuf block;           /* Lines since the last blank one */
+    long stack_at;                   /* Offset of the block's first stack line, or -1 */
+    uint64_t fed_at;                 /* When text last arrived */
+} LogParser;
+
+static int StartsWith(const char* text, const char* prefix)
+{
+    return strncmp(text, prefix, strlen(prefix)) == 0;
+}
+
+/*
+ * "path(line,col): error CS0246: message". Fills the parts and returns 1.
+ */
+static int ParseDiagnostic(const char* text, int* severity, size_t* path_length, uint32_t* line,
+    uint32_t* column, const char** code, size_t* code_length, const char** message)
+{
+    const char* error = strstr(text, "): error ");
+    const char* warning = strstr(text, "): warning ");
+    const char* close;
+    const char* open;
+    const char* paren;
+    const char* p;
+    unsigned long numbers[2] = { 0, 0 };
+    int n = 0;
+
+    if (error != NULL && (warning == NULL || error < warning))
+    {
+        close = error;
+        *severity = SEVERITY_ERROR;
+        p = error + 9;
+    }
+    else if (warning != NULL)
+    {
+        close = warning;
+        *severity = SEVERITY_WARNING;
+        p = warning + 11;
+    }
+    else
+    {
+        return 0;
+    }
+
+    /* Back to the "(line,col" before it */
+    for (open = close; open > text && open[-1] != '('; open--)
+    {
+        if (!isdigit((unsigned char)open[-1]) && open[-1] != ',')
+        {
+            return 0;
+        }
+    }
+    if (open == text || open - 1 == text || open == close)
+    {
+        return 0;
+    }
+    paren = open - 1;
+    while (open < close && n < 2)
+    {
+        if (!isdigit((unsigned char)*open))
+        {
+            return 0;
+        }
+        numbers[n++] = strtoul(open, (char**)&open, 10);
+        if (*open == ',')
+        {
+            open++;
+        }
+    }
+    *path_length = (size_t)(paren - text);
+    *line = (uint32_t)numbers[0];
+    *column = (uint32_t)numbers[1];
+
+    /* An optional code, then the message */
+    *code = p;
+    *code_length = 0;
+    while (isalnum((unsigned char)p[*code_length]))
+    {
+        (*code_length)++;
+    }
+    if (*code_length > 0 && p[*code_length] == ':')
+    {
+        p += *code_length + 1;
+    }
+    else
+    {
+        *code_length = 0;
+    }
+    while (*p == ' ')
+    {
+        p++;
+    }
+    *message = p;
+    return 1;
+}
+
+/*
+ * "SomeException: message" or "Namespace.SomeException: message"; returns
+ * the length of the type name, or 0.
+ */
+static size_t ExceptionTypeLength(const char* text, size_t length)
+{
+    size_t i;
+
+    for (i = 0; i < length && text[i] != ':'; i++)
+    {
+        if (!isalnum((unsigned char)text[i]) && text[i] != '.' && text[i] != '_' && text[i] != '`')
+        {
+            return 0;
+        }
+    }
+    if (i < 9 || i == length || strncmp(text + i - 9, "Exception", 9) != 0)
+    {
+        return 0;
+    }
+    return i;
+}
+
+/*
+ * A stack frame: "Type:Method (args)", "Namespace.Type.Method () (at
+ * path:line)" or "  at Type.Method () [0x00000] in path:line" - a qualified
+ * name, then its argument list.
+ */
+static int IsStackLine(const char* text, size_t length)
+{
+    size_t i;
+    int qualified = 0;
+
+    if (StartsWith(text, "  at ") || StartsWith(text, "at "))
+    {
+        return 1;
+    }
+    for (i = 0; i < length && text[i] != ' '; i++)
+    {
+        char c = text[i];
+        if (c == '.' || c == ':')
+        {
+            qualified = qualified || (i > 0 && i + 1 < length && text[i + 1] != ' ');
+        }
+        else if (!isalnum((unsigned char)c) && c != '_' && c != '`' && c != '<' && c != '>' && c != '$')
+        {
+            return 0;
+        }
+    }
+    return qualified && i + 1 < length && text[i + 1] == '(';
+}
+
+static int IsCompileMarker(const char* text)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(COMPILE_MARKERS) / sizeof(COMPILE_MARKERS[0]); i++)
+    {
+        if (StartsWith(text, COMPILE_MARKERS[i]))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * The source location a stack names: the first "(at path:line)" frame with
+ * a real path, else a "(Filename: path Line: n)" line.
+ */
+static int FindLocation(const char* stack, const char** file, size_t* file_length, uint32_t* line)
+{
+    const char* p = stack;
+    const char* filename;
+
+    while ((p = strstr(p, "(at ")) != NULL)
+    {
+        const char* begin = p + 4;
+        const char* close = strchr(begin, ')');
+        const char* colon = close;
+
+        p = begin;
+        if (close == NULL || *begin == '<')
+        {
+            continue;
+        }
+        while (colon > begin && colon[-1] != ':')
+        {
+            colon--;
+        }
+        if (colon - 1 > begin && isdigit((unsigned char)*colon))
+        {
+            *file = begin;
+            *file_length = (size_t)(colon - 1 - begin);
+            *line = (uint32_t)strtoul(colon, NULL, 10);
+            return 1;
+        }
+    }
+
+    if ((filename = strstr(stack, "(Filename: ")) != NULL)
+    {
+        const char* begin = filename + 11;
+        const char* marker = strstr(begin, " Line: ");
+        const char* end = strchr(begin, '\n');
+        long number;
+
+        if (marker != NULL && (end == NULL || marker < end) && !StartsWith(begin, "currently not available") &&
+            (number = strtol(marker + 7, NULL, 10)) > 0)
+        {
+            *file = begin;
+            *file_length = (size_t)(marker - begin);
+            *line = (uint32_t)number;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * A line outside any stack trace: kept only if it reads as an error or a
+ * warning.
+ */
+static void HandlePlainLine(const char* text, size_t length)
+{
+    int severity;
+    int kind = KIND_EDITOR;
+
+    if (StartsWith(text, "Error") || StartsWith(text, "error:") || StartsWith(text, "ERROR"))
+    {
+        severity = SEVERITY_ERROR;
+    }
+    else if (StartsWith(text, "Warning") || StartsWith(text, "warning:") || StartsWith(text, "WARNING"))
+    {
+        severity = SEVERITY_WARNING;
+    }
+    else if (ExceptionTypeLength(text, length) > 0)
+    {
+        severity = SEVERITY_ERROR;
+        kind = KIND_EXCEPTION;
+    }
+    else
+    {
+        return;
+    }
+    EmitEntry(severity, kind, text, length, NULL, 0, NULL, 0, 0, 0, NULL, 0);
+}
+
+/*
+ * Turn the pending block into entries: one console message if it holds a
+ * stack trace, else its error and warning lines.
+ */
+static void FlushBlock(LogParser* parser)
+{
+    char* text;
+    size_t length = parser->block.len;
+
+    if (length == 0)
+    {
+        return;
+    }
+    mg_iobuf_add(&parser->block, length, "", 1);  /* Terminate */
+    text = (char*)parser->block.buf;
+
+    if (parser->stack_at < 0)
+    {
+        char* line = text;
+        while (line < text + length)
+        {
+            char* end = (char*)memchr(line, '\n', (size_t)(text + length - line));
+            *end = '\0';
+            HandlePlainLine(line, (size_t)(end - line));
+            line = end + 1;
+        }
+    }
+    else
+    {
+        const char* message = text;
+        size_t message_length = (size_t)parser->stack_at;
+        const char* stack = text + parser->stack_at;
+        size_t stack_length = length - (size_t)parser->stack_at;
+        const char* file = NULL;
+        size_t file_length = 0;
+        uint32_t line = 0;
+        int severity = SEVERITY_LOG;
+        int kind = KIND_LOG;
+
+        if (message_length == 0)
+        {
+            /* A bare stack: its first line stands in for the message */
+            message_length = (size_t)((const char*)memchr(stack, '\n', stack_length) - stack);
+        }
+        else
+        {
+            /* Editor output run into an exception: the exception starts at its own line */
+            char* line = text;
+            char* start = NULL;
+            while (line < stack)
+            {
+                if (ExceptionTypeLength(line, (size_t)(stack - line)) > 0)
+                {
+                    start = line;
+                }
+                line = (char*)memchr(line, '\n', (size_t)(stack - line)) + 1;
+            }
+            for (line = text; start != NULL && line < start;)
+            {
+                char* end = (char*)memchr(line, '\n', (size_t)(start - line));
+                *end = '\0';
+                HandlePlainLine(line, (size_t)(end - line));
+                line = end + 1;
+            }
+            if (start != NULL)
+            {
+                message = start;
+                message_length = (size_t)(stack - start);
+            }
+        }
+        if (strstr(stack, "Debug:LogException") != NULL ||
+            ExceptionTypeLength(message, message_length) > 0)
+        {
+            severity = SEVERITY_ERROR;
+            kind = KIND_EXCEPTION;
+        }
+        else if (strstr(stack, "Debug:LogAssertion") != NULL || strstr(stack, "Debug:Assert") != NULL ||
+                 strstr(stack, "UnityEngine.Assertions.") != NULL)
+        {
+            severity = SEVERITY_ERROR;
+            kind = KIND_ASSERT;
+        }
+        else if (strstr(stack, "Debug:LogError") != NULL)
+        {
+            severity = SEVERITY_ERROR;
+        }
+        else if (strstr(stack, "Debug:LogWarning") != NULL)
+        {
+            severity = SEVERITY_WARNING;
+        }
+        FindLocation(stack, &file, &file_length, &line);
+        EmitEntry(severity, kind, message, message_length, stack, stack_length, file, file_length, line, 0,
+            NULL, 0);
+    }
+    parser->block.len = 0;
+    parser->stack_at = -1;
+}
+
+static void HandleLine(LogParser* parser, char* text, size_t length)
+{
+    int severity;
+    size_t path_length;
+    uint32_t line, column;
+    const char* code;
+    size_t code_length;
+    const char* message;
+
+    length = TrimEnd(text, length);
+    text[length] = '\0';
+
+    if (length == 0)
+    {
+        FlushBlock(parser);
+        return;
+    }
+    if (IsCompileMarker(text))
+    {
+        FlushBlock(parser);
+        PROXY_MUTEX_LOCK(&s_log_lock);
+        s_log_epoch++;
+        PROXY_MUTEX_UNLOCK(&s_log_lock);
+        return;
+    }
+    if (ParseDiagnostic(text, &severity, &path_length, &line, &column, &code, &code_length, &message))
+    {
+        FlushBlock(parser);
+        EmitEntry(severity, KIND_COMPILER, message, strlen(message), NULL, 0, text, path_length, line, column,
+            code, code_length);
+        return;
+    }
+
+    /* Text the editor prints between messages must not grow a block without end */
+    if (parser->stack_at < 0 && parser->block.len + length >= EDITOR_LOG_MAX_BLOCK)
+    {
+        FlushBlock(parser);
+    }
+    if (parser->stack_at < 0 && IsStackLine(text, length))
+    {
+        parser->stack_at = (long)parser->block.len;
+    }
+    if (parser->block.len + length < EDITOR_LOG_MAX_BLOCK)
+    {
+        mg_iobuf_add(&parser->block, parser->block.len, text, length);
+        mg_iobuf_add(&parser->block, parser->block.len, "\n", 1);
+    }
+    if (StartsWith(text, "(Filename: "))
+    {
+        FlushBlock(parser);  /* Ends a message in the editor's log */
+    }
+}
+
+static void FeedParser(LogParser* parser, const char* data, size_t length)
+{
+    while (length > 0)
+    {
+        const char* newline = (const char*)memchr(data, '\n', length);
+        size_t take = newline != NULL ? (size_t)(newline - data) : length;
+        size_t room = EDITOR_LOG_MAX_LINE - parser->line_length;
+
+        size_t i;
+
+        memcpy(parser->line + parser->line_length, data, take < room ? take : room);
+        for (i = parser->line_length; i < parser->line_length + (take < room ? take : room); i++)
+        {
+            /* NULs (logged strings, or the padding a crash leaves) would end the line early */
+            if (parser->line[i] == '\0')
+            {
+                parser->line[i] = ' ';
+            }
+        }
+        parser->line_length += take < room ? take : room;
+        if (newline == NULL)
+        {
+            break;
+        }
+        if (parser->skip_line)
+        {
+            parser->skip_line = 0;
+        }
+        else
+        {
+            HandleLine(parser, parser->line, parser->line_length);
+        }
+        parser->line_length = 0;
+        data = newline + 1;
+        length -= take + 1;
+    }
+    parser->fed_at = mg_millis();
+}
+
+static void ResetParser(LogParser* parser)
+{
+    parser->line_length = 0;
+    parser->skip_line = 0;
+    parser->block.len = 0;
+    parser->stack_at = -1;
+}
+
+/*
+ * Tailing
+ */
+
+typedef struct LogFile
+{
+    int seen;                        /* The log has been found in this run */
+    int present;
+    int64_t identity;                /* Inode, or creation time on Windows */
+    uint64_t offset;                 /* Bytes parsed */
+} LogFile;
+
+static int StatLog(const char* path, uint64_t* size, int64_t* identity)
+{
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data) ||
+        (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+    {
+        return 0;
+    }
+    *size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+    *identity = (int64_t)(((uint64_t)data.ftCreationTime.dwHighDateTime << 32) |
+        data.ftCreationTime.dwLowDateTime);
+#else
+    struct stat info;
+    if (stat(path, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        return 0;
+    }
+    *size = (uint64_t)info.st_size;
+    *identity = (int64_t)info.st_ino;
+#endif
+    return 1;
+}
+
+static int SeekLog(FILE* stream, uint64_t offset)
+{
+#ifdef _WIN32
+    return _fseeki64(stream, (__int64)offset, SEEK_SET) == 0;
+#else
+    return fseeko(stream, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+/*
+ * Parse what was appended since the last call. Returns 1 if anything was
+ * read.
+ */
+static int ReadAppended(const char* path, LogFile* log, LogParser* parser)
+{
+    static char buffer[64 * 1024];
+    uint64_t size;
+    int64_t identity;
+    FILE* stream;
+    int read_any = 0;
+
+    if (!StatLog(path, &size, &identity))
+    {
+        log->present = 0;
+        return 0;
+    }
+    if (!log->present || identity != log->identity || size < log->offset)
+    {
+        if (log->seen)
+        {
+            /* Replaced or truncated: the editor restarted or the log was cleared */
+            PROXY_MUTEX_LOCK(&s_log_lock);
+            ResetRing();
+            PROXY_MUTEX_UNLOCK(&s_log_lock);
+            ResetParser(parser);
+            log->offset = 0;
+        }
+        else
+        {
+            log->offset = size > EDITOR_LOG_BACKFILL ? size - EDITOR_LOG_BACKFILL : 0;
+            parser->skip_line = log->offset > 0;
+        }
+        log->seen = 1;
+        log->present = 1;
+        log->identity = identity;
+    }
+    if (size == log->offset || (stream = fopen(path, "rb")) == NULL)
+    {
+        return 0;
+    }
+    if (SeekLog(stream, log->offset))
+    {
+        size_t length;
+        while (log->offset < size && (length = fread(buffer, 1, sizeof(buffer), stream)) > 0)
+        {
+            FeedParser(parser, buffer, length);
+            log->offset += length;
+            read_any = 1;
+        }
+    }
+    fclose(stream);
+
+    if (read_any)
+    {
+        PROXY_MUTEX_LOCK(&s_log_lock);
+        s_log_bytes = log->offset;
+        PROXY_MUTEX_UNLOCK(&s_log_lock);
+    }
+    return read_any;
+}
+
+static int TailRestartRequested(unsigned restarts)
+{
+    int requested;
+
+    PROXY_MUTEX_LOCK(&s_log_lock);
+    requested = s_log_restarts != restarts;
+    PROXY_MUTEX_UNLOCK(&s_log_lock);
+    return requested;
+}
+
+static void SetTailMode(const char* mode)
+{
+    PROXY_MUTEX_LOCK(&s_log_lock);
+    s_log_mode = mode;
+    PROXY_MUTEX_UNLOCK(&s_log_lock);
+}
+
+#ifdef __linux__
+
+/*
+ * Watch the log's folder, which sees the log replaced as well as written.
+ * Returns the inotify descriptor, or -1 to poll instead.
+ */
+static int WatchLogFolder(const char* path)
+{
+    char folder[PROJECT_MAX_PATH];
+    const char* slash = strrchr(path, '/');
+    int fd;
+
+    if (slash == NULL || (size_t)(slash - path) >= sizeof(folder))
+    {
+        return -1;
+    }
+    memcpy(folder, path, (size_t)(slash - path));
+    folder[slash == path ? 1 : slash - path] = '\0';
+    if ((fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) < 0)
+    {
+        return -1;
+    }
+    if (inotify_add_watch(fd, folder, IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/*
+ * Wait up to timeout for a change in the log's folder.
+ */
+static void WaitLogEvent(int fd, int timeout)
+{
+    char buffer[16 * 1024];
+    struct pollfd descriptor;
+
+    descriptor.fd = fd;
+    descriptor.events = POLLIN;
+    descriptor.revents = 0;
+    if (poll(&descriptor, 1, timeout) > 0)
+    {
+        while (read(fd, buffer, sizeof(buffer)) > 0)
+        {
+        }
+    }
+}
+
+#endif
+
+/*
+ * Follow one log path until a restart is requested.
+ */
+static void TailLog(const char* path, unsigned restarts, LogParser* parser)
+{
+    LogFile log;
+    int fd = -1;
+
+    memset(&log, 0, sizeof(log));
+    ResetParser(parser);
+#ifdef __linux__
+    fd = WatchLogFolder(path);
+#endif
+    SetTailMode(fd >= 0 ? "inotify" : "polling");
+
+    for (;;)
+    {
+        if (!ReadAppended(path, &log, parser) && parser->block.len > 0 &&
+            mg_millis() - parser->fed_at >= EDITOR_LOG_POLL_MS)
+        {
+            /* Nothing more came: the message is complete */
+            FlushBlock(parser);
+        }
+
+#ifdef __linux__
+        if (fd >= 0)
+        {
+            /* Changes wake us at once; the timeout still checks the log now and then */
+            WaitLogEvent(fd, parser->block.len > 0 ? EDITOR_LOG_POLL_MS : EDITOR_LOG_POLL_MS * 4);
+        }
+        else
+#endif
+        {
+            PROXY_MUTEX_LOCK(&s_log_lock);
+            if (s_log_restarts == restarts)
+            {
+                PROXY_CONDITION_WAIT_MS(&s_log_wake, &s_log_lock, EDITOR_LOG_POLL_MS);
+            }
+            PROXY_MUTEX_UNLOCK(&s_log_lock);
+        }
+        if (TailRestartRequested(restarts))
+        {
+            break;
+        }
+    }
+#ifdef __linux__
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+#endif
+}
+
+static void RunTailer(void)
+{
+    static LogParser parser;
+
+    parser.stack_at = -1;
+    for (;;)
+    {
+        char path[PROJECT_MAX_PATH];
+        unsigned restarts;
+
+        PROXY_MUTEX_LOCK(&s_log_lock);
+        while (s_log_path[0] == '\0')
+        {
+            s_log_mode = "off";
+            PROXY_CONDITION_WAIT(&s_log_wake, &s_log_lock);
+        }
+        memcpy(path, s_log_path, sizeof(path));
+        restarts = s_log_restarts;
+        PROXY_MUTEX_UNLOCK(&s_log_lock);
+
+        TailLog(path, restarts, &parser);
+
+        /* Entries so far came from another log */
+        PROXY_MUTEX_LOCK(&s_log_lock);
+        ResetRing();
+        PROXY_MUTEX_UNLOCK(&s_log_lock);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI TailerThreadFunc(LPVOID param)
+{
+    (void)param;
+    RunTailer();
+    return 0;
+}
+#else
+static void* TailerThreadFunc(void* param)
+{
+    (void)param;
+    RunTailer();
+    return NULL;
+}
+#endif
+
+/*
+ * Configure the editor log to follow.
+ */
+EXPORT void ConfigureEditorLog(const char* path)
+{
+    size_t length = path != NULL ? strlen(path) : 0;
+    int start;
+
+    if (length >= sizeof(s_log_path))
+    {
+        length = 0;
+    }
+    PROXY_MUTEX_LOCK(&s_log_lock);
+    if (strlen(s_log_path) == length && strncmp(s_log_path, path != NULL ? path : "", length) == 0)
+    {
+        PROXY_MUTEX_UNLOCK(&s_log_lock);
+        return;  /* Unchanged: called again after every domain reload */
+    }
+    if (length > 0)
+    {
+        memcpy(s_log_path, path, length);
+    }
+    s_log_path[length] = '\0';
+    s_log_restarts++;
+    start = !s_log_started && length > 0;
+    if (start)
+    {
+        s_log_started = 1;
+    }
+    PROXY_CONDITION_BROADCAST(&s_log_wake);
+    PROXY_MUTEX_UNLOCK(&s_log_lock);
+
+    if (start)
+    {
+#ifdef _WIN32
+        HANDLE thread = CreateThread(NULL, 0, TailerThreadFunc, NULL, 0, NULL);
+        start = thread != NULL;
+        if (start)
+        {
+            CloseHandle(thread);
+        }
+#else
+        pthread_t thread;
+        start = pthread_create(&thread, NULL, TailerThreadFunc, NULL) == 0;
+        if (start)
+        {
+            pthread_detach(thread);
+        }
+#endif
+        if (!start)
+        {
+            PROXY_MUTEX_LOCK(&s_log_lock);
+            s_log_started = 0;
+            PROXY_MUTEX_UNLOCK(&s_log_lock);
+        }
+    }
+}
+
+/*
+ * Counts of the current entries by severity. Caller holds the lock.
+ */
+static void CountEntries(int counts[SEVERITY_COUNT])
+{
+    int64_t sequence;
+
+    memset(counts, 0, sizeof(int) * SEVERITY_COUNT);
+    for (sequence = s_log_first; sequence <= s_log_sequence; sequence++)
+    {
+        const LogEntry* entry = &s_log_ring[sequence % EDITOR_LOG_CAPACITY];
+        if (!entry->superseded && !IsResolved(entry))
+        {
+            counts[entry->severity]++;
+        }
+    }
+}
+
+/*
+ * Get editor log tailer statistics as a JSON object.
+ */
+EXPORT const char* GetEditorLogStats(void)
+{
+    int counts[SEVERITY_COUNT];
+
+    PROXY_MUTEX_LOCK(&s_log_lock);
+    CountEntries(counts);
+    snprintf(s_log_stats_buffer, sizeof(s_log_stats_buffer),
+        "{\"mode\":\"%s\",\"session\":%d,\"entries\":%ld,\"cursor\":%lld,\"errors\":%d,\"warnings\":%d,"
+        "\"bytes\":%llu}",
+        s_log_mode, s_log_session, (long)(s_log_sequence - s_log_first + 1), (long long)s_log_sequence,
+        counts[SEVERITY_ERROR], counts[SEVERITY_WARNING], (unsigned long long)s_log_bytes);
+    PROXY_MUTEX_UNLOCK(&s_log_lock);
+    return s_log_stats_buffer;
+}
+
+/*
+ * Queries
+ */
+
+/*
+ * The name console://errors gives an entry's type.
+ */
+static void AppendType(struct mg_iobuf* out, const LogEntry* entry)
+{
+    const char* name;
+    size_t length;
+
+    switch (entry->kind)
+    {
+    case KIND_COMPILER:
+        name = entry->severity == SEVERITY_ERROR ? "CompilationError" : "CompilationWarning";
+        break;
+    case KIND_ASSERT:
+        name = "Assert";
+        break;
+    case KIND_EXCEPTION:
+        if ((length = ExceptionTypeLength(entry->message, strlen(entry->message))) > 0)
+        {
+            /* Without its namespace */
+            const char* begin = entry->message + length;
+            while (begin > entry->message && begin[-1] != '.')
+            {
+                begin--;
+            }
+            JsonAppendString(out, begin, (size_t)(entry->message + length - begin));
+            return;
+        }
+        name = "Exception";
+        break;
+    default:
+        name = entry->severity == SEVERITY_ERROR ? "Error" : entry->severity == SEVERITY_WARNING ? "Warning" : "Info";
+        break;
+    }
+    JsonAppendString(out, name, strlen(name));
+}
+
+static void AppendEntryJson(struct mg_iobuf* out, const LogEntry* entry, int include_stack)
+{
+    char number[128];
+    int length;
+
+    length = snprintf(number, sizeof(number), "{\"seq\":%lld,\"severity\":\"%s\",\"kind\":\"%s\",\"type\":",
+        (long long)entry->sequence, SEVERITY_NAMES[entry->severity], KIND_NAMES[entry->kind]);
+    mg_iobuf_add(out, out->len, number, (size_t)length);
+    AppendType(out, entry);
+    mg_iobuf_add(out, out->len, ",\"message\":", 11);
+    JsonAppendString(out, entry->message, strlen(entry->message));
+    mg_iobuf_add(out, out->len, ",\"file\":", 8);
+    if (entry->file != NULL)
+    {
+        JsonAppendString(out, entry->file, strlen(entry->file));
+    }
+    else
+    {
+        mg_iobuf_add(out, out->len, "null", 4);
+    }
+    length = snprintf(number, sizeof(number), ",\"line\":%lu,\"column\":%lu,\"code\":",
+        (unsigned long)entry->line, (unsigned long)entry->column);
+    mg_iobuf_add(out, out->len, number, (size_t)length);
+    if (entry->code[0] != '\0')
+    {
+        JsonAppendString(out, entry->code, strlen(entry->code));
+    }
+    else
+    {
+        mg_iobuf_add(out, out->len, "null", 4);
+    }
+    length = snprintf(number, sizeof(number), ",\"count\":%lu,\"resolved\":%s",
+        (unsigned long)entry->count, IsResolved(entry) ? "true" : "false");
+    mg_iobuf_add(out, out->len, number, (size_t)length);
+    if (include_stack && entry->stack != NULL)
+    {
+        mg_iobuf_add(out, out->len, ",\"stack\":", 9);
+        JsonAppendString(out, entry->stack, strlen(entry->stack));
+    }
+    mg_iobuf_add(out, out->len, "}", 1);
+}
+
+/*
+ * Case-insensitive substring search.
+ */
+static int ContainsFold(const char* text, const char* needle)
+{
+    size_t length = strlen(needle);
+
+    for (; *text != '\0'; text++)
+    {
+        size_t i = 0;
+        while (i < length && text[i] != '\0' &&
+               tolower((unsigned char)text[i]) == tolower((unsigned char)needle[i]))
+        {
+            i++;
+        }
+        if (i == length)
+        {
+            return 1;
+        }
+    }
+    return length == 0;
+}
+
+/*
+ * The "types" param as a mask of severities: -1 if a name is unknown.
+ */
+static int GetTypesParam(struct mg_str request)
+{
+    char* value = mg_json_get_str(request, "$.params.types");
+    const char* p;
+    int mask = 0;
+
+    if (value == NULL)
+    {
+        return (1 << SEVERITY_ERROR) | (1 << SEVERITY_WARNING);
+    }
+    for (p = value; *p != '\0';)
+    {
+        size_t length;
+        while (*p == ',' || *p == ' ')
+        {
+            p++;
+        }
+        for (length = 0; p[length] != '\0' && p[length] != ',' && p[length] != ' '; length++)
+        {
+        }
+        if (length == 0)
+        {
+            break;
+        }
+        if ((length == 5 && strncmp(p, "error", 5) == 0) || (length == 6 && strncmp(p, "errors", 6) == 0))
+        {
+            mask |= 1 << SEVERITY_ERROR;
+        }
+        else if ((length == 7 && strncmp(p, "warning", 7) == 0) || (length == 8 && strncmp(p, "warnings", 8) == 0))
+        {
+            mask |= 1 << SEVERITY_WARNING;
+        }
+        else if ((length == 3 && strncmp(p, "log", 3) == 0) || (length == 4 && strncmp(p, "logs", 4) == 0))
+        {
+            mask |= 1 << SEVERITY_LOG;
+        }
+        else if (length == 3 && strncmp(p, "all", 3) == 0)
+        {
+            mask |= (1 << SEVERITY_COUNT) - 1;
+        }
+        else
+        {
+            mask = -1;
+            break;
+        }
+        p += length;
+    }
+    mg_free(value);
+    return mask == 0 ? -1 : mask;
+}
+
+/*
+ * Write the console/read result. Caller holds the lock.
+ */
+static void ReadEntries(struct mg_iobuf* result, int64_t* matches, int types, long since, long max_results,
+    const char* code, const char* file, const char* text, int include_stack, int include_resolved)
+{
+    int reset = since >= 0 && (since < s_log_first - 1 || since > s_log_sequence);
+    int64_t cursor = s_log_sequence;
+    int64_t sequence;
+    size_t count = 0;
+    size_t begin, end, i;
+    int counts[SEVERITY_COUNT];
+    char number[256];
+    int length;
+
+    /* A cursor from another session, or older than the ring, reads everything held */
+    for (sequence = since >= 0 && !reset ? since + 1 : s_log_first; sequence <= s_log_sequence; sequence++)
+    {
+        const LogEntry* entry = &s_log_ring[sequence % EDITOR_LOG_CAPACITY];
+        if (entry->superseded || (types & (1 << entry->severity)) == 0 ||
+            (!include_resolved && IsResolved(entry)) ||
+            (code != NULL && strcmp(entry->code, code) != 0) ||
+            (file != NULL && (entry->file == NULL || !ContainsFold(entry->file, file))) ||
+            (text != NULL && !ContainsFold(entry->message, text)))
+        {
+            continue;
+        }
+        matches[count++] = sequence;
+    }
+
+    /* Paging forward from a cursor takes the oldest, otherwise the newest */
+    if (since >= 0)
+    {
+        begin = 0;
+        end = count > (size_t)max_results ? (size_t)max_results : count;
+        if (end < count)
+        {
+            cursor = matches[end - 1];
+        }
+    }
+    else
+    {
+        begin = count > (size_t)max_results ? count - (size_t)max_results : 0;
+        end = count;
+    }
+
+    mg_iobuf_add(result, result->len, "{\"log_path\":", 12);
+    JsonAppendString(result, s_log_path, strlen(s_log_path));
+    CountEntries(counts);
+    length = snprintf(number, sizeof(number),
+        ",\"mode\":\"%s\",\"session\":%d,\"cursor\":%lld,\"reset\":%s,"
+        "\"counts\":{\"error\":%d,\"warning\":%d,\"log\":%d},\"entries\":[",
+        s_log_mode, s_log_session, (long long)cursor, reset ? "true" : "false",
+        counts[SEVERITY_ERROR], counts[SEVERITY_WARNING], counts[SEVERITY_LOG]);
+    mg_iobuf_add(result, result->len, number, (size_t)length);
+    for (i = begin; i < end; i++)
+    {
+        if (i > begin)
+        {
+            mg_iobuf_add(result, result->len, ",", 1);
+        }
+        AppendEntryJson(result, &s_log_ring[matches[i] % EDITOR_LOG_CAPACITY], include_stack);
+    }
+    length = snprintf(number, sizeof(number), "],\"truncated\":%s}", end - begin < count ? "true" : "false");
+    mg_iobuf_add(result, result->len, number, (size_t)length);
+}
+
+int ConsoleReadMethod(struct mg_str request, struct mg_iobuf* result, const char** error)
+{
+    int types = GetTypesParam(request);
+    long since = mg_json_get_long(request, "$.params.since", -1);
+    long max_results = mg_json_get_long(request, "$.params.max_results", EDITOR_LOG_DEFAULT_RESULTS);
+    char* code = mg_json_get_str(request, "$.params.code");
+    char* file = mg_json_get_str(request, "$.params.file");
+    char* text = mg_json_get_str(request, "$.params.filter_text");
+    bool include_stack = false;
+    bool include_resolved = false;
+    int64_t* matches = NULL;
+    int result_code = 0;
+
+    mg_json_get_bool(request, "$.params.include_stacktrace", &include_stack);
+    mg_json_get_bool(request, "$.params.include_resolved", &include_resolved);
+    max_results = max_results < 1 ? 1 : max_results > EDITOR_LOG_MAX_RESULTS ? EDITOR_LOG_MAX_RESULTS : max_results;
+
+    if (types < 0)
+    {
+        *error = "Unknown type; use error, warning, log or all";
+        result_code = -32602;
+    }
+    else if ((matches = (int64_t*)malloc(sizeof(int64_t) * EDITOR_LOG_CAPACITY)) == NULL)
+    {
+        *error = "Out of memory";
+        result_code = -32603;
+    }
+    else
+    {
+        PROXY_MUTEX_LOCK(&s_log_lock);
+        if (s_log_path[0] == '\0')
+        {
+            *error = "Editor log not configured";
+            result_code = PROJECT_ERROR_NOT_READY;
+        }
+        else
+        {
+            ReadEntries(result, matches, types, since, max_results, code, file, text, include_stack, include_resolved);
+        }
+        PROXY_MUTEX_UNLOCK(&s_log_lock);
+    }
+    free(matches);
+    mg_free(code);
+    mg_free(file);
+    mg_free(text);
+    return result_code;
+}
+
+/*
+ * One console://errors item, as ConsoleErrors.cs writes it.
+ */
+static void AppendErrorItem(struct mg_iobuf* out, const LogEntry* entry)
+{
+    char number[192];
+    int length;
+
+    mg_iobuf_add(out, out->len, "{\"message\":", 11);
+    JsonAppendString(out, entry->message, strlen(entry->message));
+    mg_iobuf_add(out, out->len, ",\"file\":", 8);
+    JsonAppendString(out, entry->file != NULL ? entry->file : "", entry->file != NULL ? strlen(entry->file) : 0);
+    length = snprintf(number, sizeof(number), ",\"line\":%lu,\"column\":%lu,\"type\":",
+        (unsigned long)entry->line, (unsigned long)entry->column);
+    mg_iobuf_add(out, out->len, number, (size_t)length);
+    AppendType(out, entry);
+    mg_iobuf_add(out, out->len, ",\"code\":", 8);
+    if (entry->code[0] != '\0')
+    {
+        JsonAppendString(out, entry->code, strlen(entry->code));
+    }
+    else
+    {
+        mg_iobuf_add(out, out->len, "null", 4);
+    }
+    length = snprintf(number, sizeof(number), ",\"count\":%lu,\"isCompilationError\":%s,\"isCompilationWarning\":%s}",
+        (unsigned long)entry->count,
+        entry->kind == KIND_COMPILER && entry->severity == SEVERITY_ERROR ? "true" : "false",
+        entry->kind == KIND_COMPILER && entry->severity == SEVERITY_WARNING ? "true" : "false");
+    mg_iobuf_add(out, out->len, number, (size_t)length);
+}
+
+int EditorLogReadErrors(struct mg_iobuf* out)
+{
+    static const char* const LISTS[] = { "errors", "warnings", "messages" };
+    int counts[SEVERITY_COUNT];
+    char number[256];
+    int length;
+    int severity;
+
+    PROXY_MUTEX_LOCK(&s_log_lock);
+    if (s_log_path[0] == '\0')
+    {
+        PROXY_MUTEX_UNLOCK(&s_log_lock);
+        return 0;
+    }
+    CountEntries(counts);
+    length = snprintf(number, sizeof(number),
+        "{\"counts\":{\"errors\":%d,\"warnings\":%d,\"messages\":%d,\"total\":%d}",
+        counts[SEVERITY_ERROR], counts[SEVERITY_WARNING], counts[SEVERITY_LOG],
+        counts[SEVERITY_ERROR] + counts[SEVERITY_WARNING] + counts[SEVERITY_LOG]);
+    mg_iobuf_add(out, out->len, number, (size_t)length);
+    for (severity = 0; severity < SEVERITY_COUNT; severity++)
+    {
+        int64_t sequence;
+        int first = 1;
+
+        length = snprintf(number, sizeof(number), ",\"%s\":[", LISTS[severity]);
+        mg_iobuf_add(out, out->len, number, (size_t)length);
+        for (sequence = s_log_first; sequence <= s_log_sequence; sequence++)
+        {
+            const LogEntry* entry = &s_log_ring[sequence % EDITOR_LOG_CAPACITY];
+            if (entry->severity != severity || entry->superseded || IsResolved(entry))
+            {
+                continue;
+            }
+            if (!first)
+            {
+                mg_iobuf_add(out, out->len, ",", 1);
+            }
+            first = 0;
+            AppendErrorItem(out, entry);
+        }
+        mg_iobuf_add(out, out->len, "]", 1);
+    }
+    length = snprintf(number, sizeof(number), ",\"source\":\"editor_log\",\"session\":%d,\"cursor\":%lld}",
+        s_log_session, (long long)s_log_sequence);
+    mg_iobuf_add(out, out->len, number, (size_t)length);
+    PROXY_MUTEX_UNLOCK(&s_log_lock);
+    return 1;
+}
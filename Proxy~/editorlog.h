@@ -0,0 +1,87 @@
+/*
+ * UnixxtyMCP Proxy - Editor.log tailer
+ *
+ * Keeps the console readable while C# is away. Reading the console goes
+ * through UnityEditor.LogEntries on the main thread, which is gone while
+ * scripts compile and the domain reloads - exactly when the compiler errors
+ * are wanted. The editor writes every console message to its log file as
+ * well, so a thread here follows that file (inotify on its folder on Linux,
+ * polling elsewhere) and parses what is appended, line by line, into a ring
+ * of EDITOR_LOG_CAPACITY entries that the server thread queries.
+ *
+ * Entries come from three shapes of text:
+ *   - compiler diagnostics, "path(line,col): error CS0246: message", one
+ *     per line, with their file, line, column and code;
+ *   - console messages, a blank-line-terminated block whose stack trace
+ *     names the logging call ("UnityEngine.Debug:LogWarning (object)") or
+ *     starts right after an exception's "SomeException: message" line; the
+ *     first "(at path:line)" frame gives the file and line;
+ *   - lines without a stack that start with "Error" or "Warning", such as
+ *     import failures.
+ * Everything else the editor prints is skipped. An entry repeating one of
+ * the last EDITOR_LOG_COLLAPSE_WINDOW entries replaces it, with the count of
+ * both. A line announcing a script compilation starts a new compile epoch:
+ * compiler diagnostics of earlier epochs are resolved and left out unless
+ * asked for, much as the console clears them when a compile starts. The
+ * announcement differs between editor versions; without one, diagnostics
+ * stay until they scroll out of the ring.
+ *
+ * A log that shrinks or is replaced starts a new session and empties the
+ * ring. On startup only the last EDITOR_LOG_BACKFILL bytes of an existing
+ * log are read.
+ *
+ * "console/read" - console entries, newest last
+ *   types              Severities, comma-separated: error, warning, log, or
+ *                      all (default "error,warning")
+ *   since              Only entries after this cursor, oldest first;
+ *                      without it, the newest ones
+ *   code               Only compiler diagnostics with this code ("CS0246")
+ *   file               Only entries whose file contains this text
+ *   filter_text        Only entries whose message contains this text
+ *                      (case-insensitive)
+ *   include_stacktrace Add each entry's stack trace (default false)
+ *   include_resolved   Keep diagnostics of earlier compiles (default false)
+ *   max_results        Default EDITOR_LOG_DEFAULT_RESULTS, at most
+ *                      EDITOR_LOG_MAX_RESULTS
+ * Result: {"log_path", "mode", "session", "cursor", "reset", "counts":
+ * {"error", "warning", "log"}, "entries":[entry], "truncated"}. cursor is
+ * the value to pass as since next time; reset is true when since names
+ * entries no longer held (another session, or scrolled out of the ring).
+ * An entry is {"seq", "severity", "kind", "type", "message", "file",
+ * "line", "column", "code", "count", "resolved", "stack"}: kind one of
+ * compiler, exception, assert, log, editor; type as console://errors names
+ * it; file and code null when unknown.
+ *
+ * While C# is not polling, the proxy also answers resources/read of
+ * console://errors from here (EditorLogReadErrors), in the shape the C#
+ * resource returns plus "source":"editor_log".
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_EDITORLOG_H
+#define UNITY_MCP_EDITORLOG_H
+
+#include "mongoose.h"
+
+#define EDITOR_LOG_CAPACITY 4096              /* Entries kept */
+#define EDITOR_LOG_COLLAPSE_WINDOW 256        /* Recent entries searched for a repeat */
+#define EDITOR_LOG_BACKFILL (4u * 1024u * 1024u)
+#define EDITOR_LOG_MAX_LINE (16u * 1024u)     /* Longer lines are cut */
+#define EDITOR_LOG_MAX_BLOCK (64u * 1024u)    /* Text kept per entry, stack included */
+#define EDITOR_LOG_POLL_MS 250
+#define EDITOR_LOG_DEFAULT_RESULTS 100
+#define EDITOR_LOG_MAX_RESULTS 2000
+
+/*
+ * The "console/read" method (a ProjectMethod, see project.h).
+ */
+int ConsoleReadMethod(struct mg_str request, struct mg_iobuf* result, const char** error);
+
+/*
+ * Append the console://errors resource text (JSON, unescaped) to out.
+ * Returns 0, appending nothing, if no log is configured.
+ */
+int EditorLogReadErrors(struct mg_iobuf* out);
+
+#endif /* UNITY_MCP_EDITORLOG_H */
@@ -0,0 +1,166 @@
+/*
+ * UnixxtyMCP Proxy - Editor log tailer test
+ *
+ * Standalone executable that writes editor logs to the working directory,
+ * points the tailer at them and checks what "console/read" returns:
+ * compiler diagnostics with their file, line, code and repeat count,
+ * diagnostics of an earlier compile left out once a new one starts, lines
+ * appended after the first read, and NUL bytes in the log, which used to
+ * crash the parser.
+ *
+ * Usage:
+ *   editorlog_test
+ *
+ * Build with build_editorlog_test.sh (Linux/macOS). Not shipped with the
+ * plugin. Exits with status 1 if any check fails.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "editorlog.h"
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int s_failures = 0;
+static int s_checks = 0;
+
+#define CHECK(condition, ...) \
+    do \
+    { \
+        s_checks++; \
+        if (!(condition)) \
+        { \
+            s_failures++; \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+        } \
+    } while (0)
+
+static int WriteLog(const char* path, const char* mode, const char* text, size_t length)
+{
+    FILE* file = fopen(path, mode);
+    CHECK(file != NULL, "Cannot write %s", path);
+    if (file == NULL)
+    {
+        return 0;
+    }
+    fwrite(text, 1, length, file);
+    fclose(file);
+    return 1;
+}
+
+/*
+ * Read the console until the reply contains `expected` (the tailer runs on
+ * its own thread), or give up after two seconds. The reply is NUL-terminated.
+ */
+static void ReadConsole(const char* request, const char* expected, struct mg_iobuf* result)
+{
+    const char* error = "";
+    int attempt;
+
+    for (attempt = 0; attempt < 40; attempt++)
+    {
+        result->len = 0;
+        if (ConsoleReadMethod(mg_str(request), result, &error) == 0)
+        {
+            mg_iobuf_add(result, result->len, "", 1);
+            if (strstr((const char*)result->buf, expected) != NULL)
+            {
+                return;
+            }
+        }
+        PROXY_SLEEP_MS(50);
+    }
+    mg_iobuf_add(result, result->len, "", 1);
+}
+
+static int Contains(const struct mg_iobuf* result, const char* text)
+{
+    return result->buf != NULL && strstr((const char*)result->buf, text) != NULL;
+}
+
+static void TestDiagnostics(void)
+{
+    static const char LOG[] =
+        "[ScriptCompilation] Requested script compilation because: Assetdatabase observed changes\n"
+        "Assets/Scripts/Player.cs(12,5): error CS0246: The type or namespace name 'Rigid' could not be found\n"
+        "Assets/Scripts/Player.cs(12,5): error CS0246: The type or namespace name 'Rigid' could not be found\n"
+        "Assets/Scripts/Enemy.cs(40,17): warning CS0168: The variable 'e' is declared but never used\n"
+        "Refreshing native plugins compatible for Editor in 1.23 ms, found 0 plugins.\n";
+    static const char RECOMPILE[] =
+        "- Starting script compilation\n"
+        "Assets/Scripts/Enemy.cs(3,1): error CS1022: Type or namespace definition, or end-of-file expected\n";
+    const char* path = "editorlog_test_diagnostics.log";
+    struct mg_iobuf result = {0, 0, 0, 4096};
+
+    if (!WriteLog(path, "wb", LOG, sizeof(LOG) - 1))
+    {
+        return;
+    }
+    ConfigureEditorLog(path);
+
+    ReadConsole("{\"params\":{\"code\":\"CS0246\"}}", "CS0246", &result);
+    CHECK(Contains(&result, "\"file\":\"Assets/Scripts/Player.cs\",\"line\":12,\"column\":5,\"code\":\"CS0246\""),
+        "Diagnostic location: %s", (const char*)result.buf);
+    CHECK(Contains(&result, "\"count\":2"), "Repeated diagnostic not collapsed: %s", (const char*)result.buf);
+    CHECK(!Contains(&result, "CS0168"), "code filter: %s", (const char*)result.buf);
+    CHECK(!Contains(&result, "Refreshing native plugins"), "Plain line kept: %s", (const char*)result.buf);
+
+    ReadConsole("{\"params\":{\"types\":\"warning\"}}", "CS0168", &result);
+    CHECK(Contains(&result, "\"severity\":\"warning\"") && !Contains(&result, "CS0246"),
+        "types filter: %s", (const char*)result.buf);
+
+    /* A new compile resolves the diagnostics of the previous one */
+    WriteLog(path, "ab", RECOMPILE, sizeof(RECOMPILE) - 1);
+    ReadConsole("{\"params\":{}}", "CS1022", &result);
+    CHECK(Contains(&result, "CS1022") && !Contains(&result, "CS0246"),
+        "Diagnostics of an earlier compile: %s", (const char*)result.buf);
+    ReadConsole("{\"params\":{\"include_resolved\":true}}", "CS0246", &result);
+    CHECK(Contains(&result, "CS0246") && Contains(&result, "\"resolved\":true"),
+        "include_resolved: %s", (const char*)result.buf);
+
+    mg_iobuf_free(&result);
+    ConfigureEditorLog("");
+    remove(path);
+}
+
+/* NUL bytes in Editor.log (a logged "\0", or a crashed editor's padding) */
+static void TestNulBytes(void)
+{
+    static const char LOG[] = "Warning: foo\0bar\n\nError\0\0\0\nUnityEngine.Debug:LogError (object)\n\n";
+    const char* path = "editorlog_test_nul.log";
+    struct mg_iobuf result = {0, 0, 0, 4096};
+
+    if (!WriteLog(path, "wb", LOG, sizeof(LOG) - 1))
+    {
+        return;
+    }
+    ConfigureEditorLog(path);
+
+    ReadConsole("{\"params\":{}}", "\"Error\"", &result);
+    CHECK(Contains(&result, "\"Warning: foo bar\""), "Editor log NUL line: %s", (const char*)result.buf);
+    CHECK(Contains(&result, "\"severity\":\"error\""), "Editor log NUL message: %s", (const char*)result.buf);
+
+    mg_iobuf_free(&result);
+    ConfigureEditorLog("");
+    remove(path);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+    {
+        printf("Usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    TestDiagnostics();
+    TestNulBytes();
+
+    printf("%d checks, %d failed\n", s_checks, s_failures);
+    return s_failures == 0 ? 0 : 1;
+}
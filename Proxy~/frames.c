@@ -0,0 +1,444 @@
+/*
+ * UnixxtyMCP Proxy - Tile-based frame deltas
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "frames.h"
+#include "image.h"
+#include "png.h"
+#include "platform.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define FRAME_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+#define TILE_ROW_BYTES (FRAME_TILE_SIZE * 4)
+#define TILE_CHUNKS (TILE_ROW_BYTES / 16)
+#define ROW_KEY_STEP UINT64_C(0x9e3779b97f4a7c15)
+
+typedef struct FrameSession
+{
+    char name[FRAME_SESSION_NAME_SIZE];
+    int width;
+    int height;
+    int frame;                  /* Frames diffed so far */
+    int keyframe;               /* Number of the last keyframe */
+    uint64_t* hashes;           /* One per tile of the previous frame; NULL before a keyframe */
+    uint64_t used_at;
+} FrameSession;
+
+static ProxyMutex s_frame_lock = PROXY_MUTEX_INITIALIZER;
+static FrameSession s_frame_sessions[FRAME_MAX_SESSIONS];
+static uint64_t s_frame_clock = 0;
+
+/* Two lanes of key per 16-byte chunk of a tile row */
+static const uint64_t s_tile_keys[TILE_CHUNKS * 2] = {
+    UINT64_C(0xc81a0d35c50eb982), UINT64_C(0x506e90f594419a89),
+    UINT64_C(0x734d0e03e6f349e9), UINT64_C(0x8a4763566f4d6d62),
+    UINT64_C(0x3948b7e112a172a3), UINT64_C(0xd3d5b841c3bbc0e3),
+    UINT64_C(0xf6f90aea6f4b9475), UINT64_C(0xda31f4bf0a46aee4),
+    UINT64_C(0x2326e6539f091ce4), UINT64_C(0xebc77a5c17d4bb44),
+    UINT64_C(0x0805a538a97a064f), UINT64_C(0x59b9096f1d8607d4),
+    UINT64_C(0x9f72d2b47e15125c), UINT64_C(0x0a6d140532bfd2b4),
+    UINT64_C(0x2a701668a3e1c1e7), UINT64_C(0xf760ac19c11b65fb)
+};
+
+/*
+ * Tile hash
+ *
+ * The accumulate step of XXH3: every 16-byte chunk is XORed with a key
+ * that depends on its position, the 32-bit halves of each 64-bit lane are
+ * multiplied together, and the product and the other lane's data are added
+ * to that lane's accumulator. The scalar path computes the same value.
+ */
+
+static uint64_t Mix64(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= UINT64_C(0xff51afd7ed558ccd);
+    value ^= value >> 33;
+    value *= UINT64_C(0xc4ceb9fe1a85ec53);
+    value ^= value >> 33;
+    return value;
+}
+
+#ifndef FRAME_SSE2
+static uint64_t ReadLane(const unsigned char* bytes)
+{
+    uint64_t value = 0;
+    int i;
+    for (i = 7; i >= 0; i--)
+    {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+#endif
+
+/*
+ * Hash `rows` rows of TILE_ROW_BYTES bytes each.
+ */
+static void AccumulateRows(const unsigned char* first, size_t stride, int rows, uint64_t acc[2])
+{
+    int row, chunk;
+#ifdef FRAME_SSE2
+    __m128i sums = _mm_loadu_si128((const __m128i*)acc);
+    __m128i row_key = _mm_setzero_si128();
+    __m128i step;
+    uint64_t step_lanes[2] = { ROW_KEY_STEP, ROW_KEY_STEP };
+    step = _mm_loadu_si128((const __m128i*)step_lanes);
+    for (row = 0; row < rows; row++)
+    {
+        const unsigned char* bytes = first + (size_t)row * stride;
+        for (chunk = 0; chunk < TILE_CHUNKS; chunk++)
+        {
+            __m128i data = _mm_loadu_si128((const __m128i*)(bytes + chunk * 16));
+            __m128i key = _mm_add_epi64(_mm_loadu_si128((const __m128i*)(s_tile_keys + chunk * 2)), row_key);
+            __m128i mixed = _mm_xor_si128(data, key);
+            __m128i product = _mm_mul_epu32(mixed, _mm_shuffle_epi32(mixed, _MM_SHUFFLE(3, 3, 1, 1)));
+            sums = _mm_add_epi64(sums, _mm_add_epi64(product, _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2))));
+        }
+        row_key = _mm_add_epi64(row_key, step);
+    }
+    _mm_storeu_si128((__m128i*)acc, sums);
+#else
+    uint64_t row_key = 0;
+    for (row = 0; row < rows; row++)
+    {
+        const unsigned char* bytes = first + (size_t)row * stride;
+        for (chunk = 0; chunk < TILE_CHUNKS; chunk++)
+        {
+            uint64_t low = ReadLane(bytes + chunk * 16);
+            uint64_t high = ReadLane(bytes + chunk * 16 + 8);
+            uint64_t mixed_low = low ^ (s_tile_keys[chunk * 2] + row_key);
+            uint64_t mixed_high = high ^ (s_tile_keys[chunk * 2 + 1] + row_key);
+            acc[0] += (mixed_low & 0xffffffffu) * (mixed_low >> 32) + high;
+            acc[1] += (mixed_high & 0xffffffffu) * (mixed_high >> 32) + low;
+        }
+        row_key += ROW_KEY_STEP;
+    }
+#endif
+}
+
+static uint64_t HashTile(const unsigned char* first, size_t stride, int tile_width, int tile_height)
+{
+    uint64_t acc[2] = { 0, 0 };
+
+    if (tile_width == FRAME_TILE_SIZE)
+    {
+        AccumulateRows(first, stride, tile_height, acc);
+    }
+    else
+    {
+        /* Edge tile: hash its rows zero-padded to full width */
+        unsigned char padded[FRAME_TILE_SIZE * TILE_ROW_BYTES];
+        int row;
+        memset(padded, 0, sizeof(padded));
+        for (row = 0; row < tile_height; row++)
+        {
+            memcpy(padded + row * TILE_ROW_BYTES, first + (size_t)row * stride, (size_t)tile_width * 4);
+        }
+        AccumulateRows(padded, TILE_ROW_BYTES, tile_height, acc);
+    }
+    return Mix64(acc[0]) ^ Mix64(acc[1] + ((uint64_t)tile_width << 32 | (uint64_t)tile_height));
+}
+
+/*
+ * Sessions
+ */
+
+static FrameSession* FindFrameSession(const char* name, int create)
+{
+    FrameSession* oldest = &s_frame_sessions[0];
+    int i;
+
+    for (i = 0; i < FRAME_MAX_SESSIONS; i++)
+    {
+        FrameSession* session = &s_frame_sessions[i];
+        if (session->name[0] != '\0' && strcmp(session->name, name) == 0)
+        {
+            return session;
+        }
+        if (session->used_at < oldest->used_at)
+        {
+            oldest = session;
+        }
+    }
+    if (!create)
+    {
+        return NULL;
+    }
+
+    /* Unused slots have used_at 0, so they are taken before live ones */
+    free(oldest->hashes);
+    memset(oldest, 0, sizeof(*oldest));
+    strncpy(oldest->name, name, FRAME_SESSION_NAME_SIZE - 1);
+    return oldest;
+}
+
+static void CopyTile(unsigned char* target, size_t target_stride, const unsigned char* source,
+    size_t source_stride, int tile_width, int tile_height)
+{
+    int row;
+    for (row = 0; row < tile_height; row++)
+    {
+        memcpy(target + (size_t)row * target_stride, source + (size_t)row * source_stride, (size_t)tile_width * 4);
+    }
+}
+
+int ComputeFrameDelta(const char* name, unsigned char* pixels, int width, int height,
+    int keyframe_interval, int force_keyframe, int* tiles, int capacity, int* info,
+    unsigned char** image, int* image_width, int* image_height)
+{
+    FrameSession* session;
+    size_t stride = (size_t)width * 4;
+    int tiles_x = (width + FRAME_TILE_SIZE - 1) / FRAME_TILE_SIZE;
+    int tiles_y = (height + FRAME_TILE_SIZE - 1) / FRAME_TILE_SIZE;
+    int tile_count = tiles_x * tiles_y;
+    int changed = 0, keyframe, columns = 0, t;
+    uint64_t* hashes;
+    unsigned char* atlas = NULL;
+
+    *image = NULL;
+    *image_width = 0;
+    *image_height = 0;
+    if (name == NULL || name[0] == '\0' || pixels == NULL || width <= 0 || height <= 0 ||
+        tiles == NULL || capacity < tile_count)
+    {
+        free(pixels);
+        return -1;
+    }
+
+    hashes = (uint64_t*)malloc((size_t)tile_count * sizeof(uint64_t));
+    if (hashes == NULL)
+    {
+        free(pixels);
+        return -1;
+    }
+    for (t = 0; t < tile_count; t++)
+    {
+        int x = (t % tiles_x) * FRAME_TILE_SIZE;
+        int y = (t / tiles_x) * FRAME_TILE_SIZE;
+        hashes[t] = HashTile(pixels + (size_t)y * stride + (size_t)x * 4, stride,
+            width - x < FRAME_TILE_SIZE ? width - x : FRAME_TILE_SIZE,
+            height - y < FRAME_TILE_SIZE ? height - y : FRAME_TILE_SIZE);
+    }
+
+    PROXY_MUTEX_LOCK(&s_frame_lock);
+    session = FindFrameSession(name, 1);
+    keyframe = force_keyframe || session->hashes == NULL || session->width != width || session->height != height ||
+        (keyframe_interval > 0 && session->frame + 1 - session->keyframe >= keyframe_interval);
+
+    if (keyframe)
+    {
+        changed = tile_count;
+        atlas = pixels;
+        *image_width = width;
+        *image_height = height;
+    }
+    else
+    {
+        for (t = 0; t < tile_count; t++)
+        {
+            if (hashes[t] != session->hashes[t])
+            {
+                tiles[changed++] = t;
+            }
+        }
+        if (changed > 0)
+        {
+            int rows;
+            columns = 1;
+            while (columns * columns < changed)
+            {
+                columns++;
+            }
+            rows = (changed + columns - 1) / columns;
+            *image_width = columns * FRAME_TILE_SIZE;
+            *image_height = rows * FRAME_TILE_SIZE;
+            atlas = (unsigned char*)calloc((size_t)*image_width * (size_t)*image_height, 4);
+            if (atlas == NULL)
+            {
+                changed = -1;
+            }
+        }
+        if (atlas != NULL)
+        {
+            size_t atlas_stride = (size_t)*image_width * 4;
+            int i;
+            for (i = 0; i < changed; i++)
+            {
+                int x = (tiles[i] % tiles_x) * FRAME_TILE_SIZE;
+                int y = (tiles[i] / tiles_x) * FRAME_TILE_SIZE;
+                CopyTile(atlas + (size_t)(i / columns) * FRAME_TILE_SIZE * atlas_stride +
+                    (size_t)(i % columns) * TILE_ROW_BYTES, atlas_stride,
+                    pixels + (size_t)y * stride + (size_t)x * 4, stride,
+                    width - x < FRAME_TILE_SIZE ? width - x : FRAME_TILE_SIZE,
+                    height - y < FRAME_TILE_SIZE ? height - y : FRAME_TILE_SIZE);
+            }
+        }
+        free(pixels);
+    }
+
+    if (changed < 0)
+    {
+        PROXY_MUTEX_UNLOCK(&s_frame_lock);
+        free(hashes);
+        *image_width = 0;
+        *image_height = 0;
+        return -1;
+    }
+
+    session->frame++;
+    if (keyframe)
+    {
+        session->keyframe = session->frame;
+    }
+    session->width = width;
+    session->height = height;
+    free(session->hashes);
+    session->hashes = hashes;
+    session->used_at = ++s_frame_clock;
+
+    info[FRAME_INFO_FRAME] = session->frame;
+    info[FRAME_INFO_BASE_FRAME] = keyframe ? 0 : session->frame - 1;
+    info[FRAME_INFO_KEYFRAME] = keyframe;
+    info[FRAME_INFO_WIDTH] = width;
+    info[FRAME_INFO_HEIGHT] = height;
+    info[FRAME_INFO_ATLAS_COLUMNS] = columns;
+    info[FRAME_INFO_JOB] = 0;
+    PROXY_MUTEX_UNLOCK(&s_frame_lock);
+
+    *image = atlas;
+    return changed;
+}
+
+EXPORT int DiffFrame(const char* session, const unsigned char* rgba, int width, int height, int stride,
+    int target_width, int target_height, int keyframe_interval, int force_keyframe,
+    int* tiles, int capacity, int* info)
+{
+    size_t row_length, y;
+    size_t abs_stride = stride < 0 ? (size_t)(-(long)stride) : (size_t)stride;
+    unsigned char* pixels;
+    unsigned char* image;
+    int image_width, image_height, changed;
+
+    if (rgba == NULL || info == NULL || width <= 0 || height <= 0 ||
+        (uint64_t)width * (uint64_t)height > PNG_MAX_PIXELS)
+    {
+        return -1;
+    }
+    row_length = (size_t)width * 4;
+    if (stride == 0)
+    {
+        abs_stride = row_length;
+    }
+    if (abs_stride < row_length)
+    {
+        return -1;
+    }
+
+    pixels = (unsigned char*)malloc(row_length * (size_t)height);
+    if (pixels == NULL)
+    {
+        return -1;
+    }
+    for (y = 0; y < (size_t)height; y++)
+    {
+        size_t source_row = stride < 0 ? (size_t)height - 1 - y : y;
+        memcpy(pixels + y * row_length, rgba + source_row * abs_stride, row_length);
+    }
+
+    /* Tiles are compared at the output size, so resize here rather than on a worker */
+    if (target_width > 0 && target_height > 0 && (target_width != width || target_height != height))
+    {
+        unsigned char* resized;
+        if ((uint64_t)target_width * (uint64_t)target_height > PNG_MAX_PIXELS)
+        {
+            free(pixels);
+            return -1;
+        }
+        resized = ImageResize(pixels, width, height, target_width, target_height, IMAGE_FILTER_BOX);
+        free(pixels);
+        if (resized == NULL)
+        {
+            return -1;
+        }
+        pixels = resized;
+        width = target_width;
+        height = target_height;
+    }
+
+    changed = ComputeFrameDelta(session, pixels, width, height, keyframe_interval, force_keyframe,
+        tiles, capacity, info, &image, &image_width, &image_height);
+    if (changed < 0 || image == NULL)
+    {
+        return changed;
+    }
+
+    /* Lossless, so that frames rebuilt from deltas match the captures exactly */
+    info[FRAME_INFO_JOB] = SubmitImageJob(image, image_width, image_height, 0, 0, -1, 0);
+    if (info[FRAME_INFO_JOB] == 0)
+    {
+        /* The caller cannot send this delta; start the session over */
+        ResetFrameSession(session);
+        return -1;
+    }
+    return changed;
+}
+
+EXPORT void ResetFrameSession(const char* name)
+{
+    int i;
+    PROXY_MUTEX_LOCK(&s_frame_lock);
+    for (i = 0; i < FRAME_MAX_SESSIONS; i++)
+    {
+        FrameSession* session = &s_frame_sessions[i];
+        if (session->name[0] != '\0' && (name == NULL || strcmp(session->name, name) == 0))
+        {
+            free(session->hashes);
+            memset(session, 0, sizeof(*session));
+        }
+    }
+    PROXY_MUTEX_UNLOCK(&s_frame_lock);
+}
+
+EXPORT int ApplyFrameDelta(unsigned char* frame, int width, int height, const unsigned char* atlas,
+    int atlas_width, int atlas_height, const int* tiles, int tile_count)
+{
+    int tiles_x = (width + FRAME_TILE_SIZE - 1) / FRAME_TILE_SIZE;
+    int tiles_y = (height + FRAME_TILE_SIZE - 1) / FRAME_TILE_SIZE;
+    int columns = atlas_width / FRAME_TILE_SIZE;
+    size_t stride = (size_t)width * 4;
+    size_t atlas_stride = (size_t)atlas_width * 4;
+    int i;
+
+    if (frame == NULL || width <= 0 || height <= 0 || tile_count < 0 || (tile_count > 0 &&
+        (atlas == NULL || tiles == NULL || columns <= 0 ||
+        (tile_count + columns - 1) / columns * FRAME_TILE_SIZE > atlas_height)))
+    {
+        return -1;
+    }
+    for (i = 0; i < tile_count; i++)
+    {
+        int x, y;
+        if (tiles[i] < 0 || tiles[i] >= tiles_x * tiles_y)
+        {
+            return -1;
+        }
+        x = (tiles[i] % tiles_x) * FRAME_TILE_SIZE;
+        y = (tiles[i] / tiles_x) * FRAME_TILE_SIZE;
+        CopyTile(frame + (size_t)y * stride + (size_t)x * 4, stride,
+            atlas + (size_t)(i / columns) * FRAME_TILE_SIZE * atlas_stride + (size_t)(i % columns) * TILE_ROW_BYTES,
+            atlas_stride,
+            width - x < FRAME_TILE_SIZE ? width - x : FRAME_TILE_SIZE,
+            height - y < FRAME_TILE_SIZE ? height - y : FRAME_TILE_SIZE);
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+/*
+ * UnixxtyMCP Proxy - Tile-based frame deltas
+ *
+ * Agents capture the same view again and again (debug_play, visual
+ * iteration) and most pixels do not change between shots. DiffFrame()
+ * splits a frame into FRAME_TILE_SIZE square tiles, hashes each one (SSE2
+ * on x86) and compares the hashes with those of the session's previous
+ * frame. The session keeps that frame as its tile hashes, which is all the
+ * diff needs. Only the changed tiles are returned, packed into an atlas
+ * that is PNG-encoded on the worker pool like any other capture.
+ *
+ * A session starts with a keyframe, the whole frame, and sends another
+ * when asked, when the frame size changes, or every keyframe_interval
+ * frames. Sessions are named by the caller and outlive domain reloads;
+ * the least recently used one is dropped when FRAME_MAX_SESSIONS are open.
+ *
+ * Atlas layout: with n changed tiles the atlas has columns = ceil(sqrt(n))
+ * cells of FRAME_TILE_SIZE per row, and the i-th tile of the list sits in
+ * cell (i % columns, i / columns). Tiles on the right and bottom edges of
+ * the frame are cropped and fill the top-left of their cell; the rest of
+ * the cell is transparent black. ApplyFrameDelta() pastes an atlas over
+ * the previous frame.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_FRAMES_H
+#define UNITY_MCP_FRAMES_H
+
+#define FRAME_TILE_SIZE 32
+#define FRAME_MAX_SESSIONS 16
+#define FRAME_SESSION_NAME_SIZE 64
+#define FRAME_DEFAULT_KEYFRAME_INTERVAL 30
+
+/* Slots of the info array filled by DiffFrame() */
+#define FRAME_INFO_FRAME 0              /* Sequence number in the session, from 1 */
+#define FRAME_INFO_BASE_FRAME 1         /* Frame the delta applies to; 0 for a keyframe */
+#define FRAME_INFO_KEYFRAME 2           /* 1 if the image is the whole frame */
+#define FRAME_INFO_WIDTH 3              /* Frame size after resizing */
+#define FRAME_INFO_HEIGHT 4
+#define FRAME_INFO_ATLAS_COLUMNS 5      /* Cells per atlas row; 0 for a keyframe */
+#define FRAME_INFO_JOB 6                /* Image job for the atlas or keyframe; 0 if nothing changed */
+#define FRAME_INFO_FIELDS 7
+
+/*
+ * Diff packed RGBA rows, top first, against the session's previous frame.
+ * Takes over `pixels`. `capacity` must be at least the frame's tile count. On success `*image` receives the malloc'd keyframe
+ * (the pixels themselves) or atlas, NULL if no tile changed, and `info`
+ * every slot but FRAME_INFO_JOB. Returns the number of changed tiles
+ * written to `tiles` (row-major tile indices), the tile count of the frame
+ * for a keyframe (without writing `tiles`), or -1 on failure, which leaves
+ * the session as it was.
+ */
+int ComputeFrameDelta(const char* session, unsigned char* pixels, int width, int height,
+    int keyframe_interval, int force_keyframe, int* tiles, int capacity, int* info,
+    unsigned char** image, int* image_width, int* image_height);
+
+#endif /* UNITY_MCP_FRAMES_H */
@@ -0,0 +1,350 @@
+/*
+ * UnixxtyMCP Proxy - Frame delta test
+ *
+ * Standalone executable that feeds sequences of synthetic frames through
+ * the tile differ and rebuilds every frame from the keyframes and delta
+ * atlases it returns, the way a client would, checking that the result is
+ * identical to the capture. Covers frame sizes that are not multiples of
+ * the tile size, single-byte changes in every tile, keyframe intervals,
+ * forced keyframes, size changes, session eviction and DiffFrame() with
+ * bottom-up rows and resizing.
+ *
+ * Usage:
+ *   frames_test [--seed <n>]
+ *
+ * Build with build_frames_test.sh (Linux/macOS). Not shipped with the plugin.
+ * Exits with status 1 if any check fails.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "frames.h"
+#include "png.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int s_failures = 0;
+static int s_checks = 0;
+static unsigned int s_seed = 12345;
+
+#define CHECK(condition, ...) \
+    do \
+    { \
+        s_checks++; \
+        if (!(condition)) \
+        { \
+            s_failures++; \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+        } \
+    } while (0)
+
+static unsigned int Random(void)
+{
+    s_seed = s_seed * 1103515245u + 12345u;
+    return (s_seed >> 8) & 0xffffff;
+}
+
+static unsigned char* Duplicate(const unsigned char* pixels, size_t size)
+{
+    unsigned char* copy = (unsigned char*)malloc(size);
+    memcpy(copy, pixels, size);
+    return copy;
+}
+
+/* A client that rebuilds frames from what the differ sends */
+typedef struct Client
+{
+    unsigned char* frame;
+    int width;
+    int height;
+    int last_frame;
+} Client;
+
+/*
+ * Diff `truth`, apply the result to the client's copy and compare.
+ * Returns the number of changed tiles reported.
+ */
+static int Step(const char* session, Client* client, const unsigned char* truth, int width, int height,
+    int keyframe_interval, int force_keyframe, int* expect_keyframe)
+{
+    size_t size = (size_t)width * (size_t)height * 4;
+    int tiles_x = (width + FRAME_TILE_SIZE - 1) / FRAME_TILE_SIZE;
+    int tiles_y = (height + FRAME_TILE_SIZE - 1) / FRAME_TILE_SIZE;
+    int* tiles = (int*)malloc((size_t)tiles_x * (size_t)tiles_y * sizeof(int));
+    int info[FRAME_INFO_FIELDS];
+    unsigned char* image;
+    int image_width, image_height, changed, i;
+
+    changed = ComputeFrameDelta(session, Duplicate(truth, size), width, height, keyframe_interval,
+        force_keyframe, tiles, tiles_x * tiles_y, info, &image, &image_width, &image_height);
+    CHECK(changed >= 0, "%s: ComputeFrameDelta failed", session);
+    if (changed < 0)
+    {
+        free(tiles);
+        return -1;
+    }
+
+    CHECK(info[FRAME_INFO_FRAME] == client->last_frame + 1 || info[FRAME_INFO_KEYFRAME],
+        "%s: frame %d follows %d", session, info[FRAME_INFO_FRAME], client->last_frame);
+    if (expect_keyframe != NULL)
+    {
+        CHECK(info[FRAME_INFO_KEYFRAME] == *expect_keyframe, "%s: frame %d keyframe=%d, expected %d",
+            session, info[FRAME_INFO_FRAME], info[FRAME_INFO_KEYFRAME], *expect_keyframe);
+    }
+
+    if (info[FRAME_INFO_KEYFRAME])
+    {
+        CHECK(changed == tiles_x * tiles_y, "%s: keyframe reports %d tiles", session, changed);
+        CHECK(image != NULL && image_width == width && image_height == height, "%s: keyframe image", session);
+        free(client->frame);
+        client->frame = Duplicate(image, size);
+        client->width = width;
+        client->height = height;
+    }
+    else
+    {
+        CHECK(info[FRAME_INFO_BASE_FRAME] == client->last_frame, "%s: delta against %d, client has %d",
+            session, info[FRAME_INFO_BASE_FRAME], client->last_frame);
+        CHECK((changed == 0) == (image == NULL), "%s: atlas present with %d tiles", session, changed);
+
+        /* Every reported tile differs from the client's copy and every other one matches */
+        for (i = 0; i < tiles_x * tiles_y; i++)
+        {
+            int x = (i % tiles_x) * FRAME_TILE_SIZE, y = (i / tiles_x) * FRAME_TILE_SIZE;
+            int w = width - x < FRAME_TILE_SIZE ? width - x : FRAME_TILE_SIZE;
+            int h = height - y < FRAME_TILE_SIZE ? height - y : FRAME_TILE_SIZE;
+            int differs = 0, listed = 0, row, k;
+            for (row = 0; row < h && !differs; row++)
+            {
+                size_t offset = ((size_t)(y + row) * (size_t)width + (size_t)x) * 4;
+                differs = memcmp(client->frame + offset, truth + offset, (size_t)w * 4) != 0;
+            }
+            for (k = 0; k < changed && !listed; k++)
+            {
+                listed = tiles[k] == i;
+            }
+            CHECK(differs == listed, "%s: tile %d differs=%d listed=%d", session, i, differs, listed);
+        }
+
+        if (changed > 0)
+        {
+            CHECK(image_width == info[FRAME_INFO_ATLAS_COLUMNS] * FRAME_TILE_SIZE, "%s: atlas width", session);
+            CHECK(ApplyFrameDelta(client->frame, width, height, image, image_width, image_height, tiles, changed) == 0,
+                "%s: ApplyFrameDelta failed", session);
+        }
+    }
+    client->last_frame = info[FRAME_INFO_FRAME];
+    CHECK(memcmp(client->frame, truth, size) == 0, "%s: frame %d not reconstructed exactly",
+        session, info[FRAME_INFO_FRAME]);
+
+    free(image);
+    free(tiles);
+    return changed;
+}
+
+static void FillRandom(unsigned char* pixels, size_t size)
+{
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        pixels[i] = (unsigned char)Random();
+    }
+}
+
+/* Overwrite a random rectangle, as a moving object would */
+static void PaintRectangle(unsigned char* pixels, int width, int height)
+{
+    int x0 = (int)(Random() % (unsigned int)width), y0 = (int)(Random() % (unsigned int)height);
+    int w = 1 + (int)(Random() % 80u), h = 1 + (int)(Random() % 80u);
+    unsigned char color[4];
+    int x, y;
+    color[0] = (unsigned char)Random();
+    color[1] = (unsigned char)Random();
+    color[2] = (unsigned char)Random();
+    color[3] = 255;
+    for (y = y0; y < y0 + h && y < height; y++)
+    {
+        for (x = x0; x < x0 + w && x < width; x++)
+        {
+            memcpy(pixels + ((size_t)y * (size_t)width + (size_t)x) * 4, color, 4);
+        }
+    }
+}
+
+static void TestSequence(int width, int height, int frames, int keyframe_interval)
+{
+    char session[FRAME_SESSION_NAME_SIZE];
+    size_t size = (size_t)width * (size_t)height * 4;
+    unsigned char* truth = (unsigned char*)malloc(size);
+    Client client = { NULL, 0, 0, 0 };
+    int f, yes = 1, no = 0;
+
+    snprintf(session, sizeof(session), "sequence %dx%d", width, height);
+    FillRandom(truth, size);
+    Step(session, &client, truth, width, height, keyframe_interval, 0, &yes);
+
+    for (f = 1; f < frames; f++)
+    {
+        int paints = (int)(Random() % 4u), p;
+        int expect_keyframe = keyframe_interval > 0 && f % keyframe_interval == 0;
+        for (p = 0; p < paints; p++)
+        {
+            PaintRectangle(truth, width, height);
+        }
+        Step(session, &client, truth, width, height, keyframe_interval, 0, expect_keyframe ? &yes : &no);
+    }
+
+    /* An unchanged frame sends nothing */
+    if (keyframe_interval <= 0)
+    {
+        CHECK(Step(session, &client, truth, width, height, keyframe_interval, 0, &no) == 0,
+            "%s: unchanged frame reported tiles", session);
+    }
+    /* Forced keyframe */
+    Step(session, &client, truth, width, height, keyframe_interval, 1, &yes);
+
+    free(client.frame);
+    free(truth);
+}
+
+static void TestSingleByteChanges(int width, int height)
+{
+    const char* session = "single byte";
+    size_t size = (size_t)width * (size_t)height * 4;
+    unsigned char* truth = (unsigned char*)malloc(size);
+    Client client = { NULL, 0, 0, 0 };
+    int tiles_x = (width + FRAME_TILE_SIZE - 1) / FRAME_TILE_SIZE;
+    int tiles_y = (height + FRAME_TILE_SIZE - 1) / FRAME_TILE_SIZE;
+    int t, yes = 1, no = 0;
+
+    FillRandom(truth, size);
+    ResetFrameSession(session);
+    Step(session, &client, truth, width, height, 0, 0, &yes);
+
+    /* Flip one byte at a random spot of each tile, including the cropped edge tiles */
+    for (t = 0; t < tiles_x * tiles_y; t++)
+    {
+        int x = (t % tiles_x) * FRAME_TILE_SIZE, y = (t / tiles_x) * FRAME_TILE_SIZE;
+        int w = width - x < FRAME_TILE_SIZE ? width - x : FRAME_TILE_SIZE;
+        int h = height - y < FRAME_TILE_SIZE ? height - y : FRAME_TILE_SIZE;
+        size_t offset = ((size_t)(y + (int)(Random() % (unsigned int)h)) * (size_t)width +
+            (size_t)(x + (int)(Random() % (unsigned int)w))) * 4 + Random() % 4u;
+        truth[offset] ^= (unsigned char)(1u << (Random() % 8u));
+        CHECK(Step(session, &client, truth, width, height, 0, 0, &no) == 1, "tile %d: single byte change", t);
+    }
+
+    free(client.frame);
+    free(truth);
+}
+
+static void TestSizeChangeAndSessions(void)
+{
+    Client client = { NULL, 0, 0, 0 };
+    Client other = { NULL, 0, 0, 0 };
+    unsigned char* small = (unsigned char*)malloc(64 * 48 * 4);
+    unsigned char* large = (unsigned char*)malloc(100 * 70 * 4);
+    char name[FRAME_SESSION_NAME_SIZE];
+    int yes = 1, no = 0, i;
+
+    FillRandom(small, 64 * 48 * 4);
+    FillRandom(large, 100 * 70 * 4);
+    Step("resize", &client, small, 64, 48, 0, 0, &yes);
+    Step("resize", &client, small, 64, 48, 0, 0, &no);
+    Step("resize", &client, large, 100, 70, 0, 0, &yes);
+    Step("resize", &client, large, 100, 70, 0, 0, &no);
+
+    /* Sessions are independent */
+    Step("other", &other, small, 64, 48, 0, 0, &yes);
+    Step("resize", &client, large, 100, 70, 0, 0, &no);
+
+    /* Reset */
+    ResetFrameSession("resize");
+    Step("resize", &client, large, 100, 70, 0, 0, &yes);
+
+    /* Opening FRAME_MAX_SESSIONS more sessions evicts the least recently used ones */
+    for (i = 0; i < FRAME_MAX_SESSIONS; i++)
+    {
+        Client scratch = { NULL, 0, 0, 0 };
+        snprintf(name, sizeof(name), "filler %d", i);
+        Step(name, &scratch, small, 64, 48, 0, 0, &yes);
+        free(scratch.frame);
+    }
+    Step("resize", &client, large, 100, 70, 0, 0, &yes);
+
+    free(client.frame);
+    free(other.frame);
+    free(small);
+    free(large);
+}
+
+static void TestDiffFrame(void)
+{
+    int width = 320, height = 200;
+    size_t stride = (size_t)width * 4;
+    unsigned char* bottom_up = (unsigned char*)malloc(stride * (size_t)height);
+    int tiles[512];
+    int info[FRAME_INFO_FIELDS];
+    int changed, y;
+
+    FillRandom(bottom_up, stride * (size_t)height);
+    ResetFrameSession(NULL);
+
+    changed = DiffFrame("native", bottom_up, width, height, -(int)stride, 160, 100, 0, 0, tiles, 512, info);
+    CHECK(changed == 5 * 4 && info[FRAME_INFO_KEYFRAME] == 1, "DiffFrame keyframe: %d", changed);
+    CHECK(info[FRAME_INFO_WIDTH] == 160 && info[FRAME_INFO_HEIGHT] == 100, "DiffFrame resized size");
+    CHECK(info[FRAME_INFO_JOB] != 0 && WaitPngJob(info[FRAME_INFO_JOB], -1) == PNG_JOB_DONE,
+        "DiffFrame keyframe job");
+    ReleasePngJob(info[FRAME_INFO_JOB]);
+
+    changed = DiffFrame("native", bottom_up, width, height, -(int)stride, 160, 100, 0, 0, tiles, 512, info);
+    CHECK(changed == 0 && info[FRAME_INFO_JOB] == 0, "DiffFrame unchanged: %d", changed);
+
+    /* The last source row is the top of the frame: only the first tile row changes */
+    for (y = height - 2; y < height; y++)
+    {
+        memset(bottom_up + (size_t)y * stride, 0, stride);
+    }
+    changed = DiffFrame("native", bottom_up, width, height, -(int)stride, 160, 100, 0, 0, tiles, 512, info);
+    CHECK(changed == 5 && tiles[0] == 0 && tiles[4] == 4, "DiffFrame top row: %d", changed);
+    CHECK(info[FRAME_INFO_ATLAS_COLUMNS] == 3 && info[FRAME_INFO_JOB] != 0 &&
+        WaitPngJob(info[FRAME_INFO_JOB], -1) == PNG_JOB_DONE, "DiffFrame delta job");
+    ReleasePngJob(info[FRAME_INFO_JOB]);
+
+    CHECK(DiffFrame("native", bottom_up, width, height, -(int)stride, 0, 0, 0, 0, tiles, 3, info) == -1,
+        "DiffFrame accepted a short tile buffer");
+
+    free(bottom_up);
+}
+
+int main(int argc, char** argv)
+{
+    int i;
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            s_seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        }
+        else
+        {
+            printf("Usage: %s [--seed <n>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    TestSequence(640, 480, 60, 0);
+    TestSequence(1917, 1081, 12, 5);
+    TestSequence(33, 17, 40, 7);
+    TestSequence(31, 31, 20, 0);
+    TestSequence(1, 1, 10, 3);
+    TestSingleByteChanges(161, 97);
+    TestSizeChangeAndSessions();
+    TestDiffFrame();
+
+    printf("%d checks, %d failed\n", s_checks, s_failures);
+    return s_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,321 @@
+/*
+ * UnixxtyMCP Proxy - Image resampling
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "image.h"
+#include "workers.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define IMAGE_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+#define WEIGHT_BITS 14
+#define WEIGHT_ROUND (1 << (WEIGHT_BITS - 1))
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* Source range and weights of every output sample along one axis */
+typedef struct ResizeTaps
+{
+    int* start;
+    int* count;
+    int16_t* weights;       /* max_taps per output sample */
+    int max_taps;
+} ResizeTaps;
+
+static double BoxFilter(double x)
+{
+    return x > -0.5 && x <= 0.5 ? 1.0 : 0.0;
+}
+
+static double Sinc(double x)
+{
+    if (x == 0.0)
+    {
+        return 1.0;
+    }
+    x *= M_PI;
+    return sin(x) / x;
+}
+
+static double LanczosFilter(double x)
+{
+    return x > -3.0 && x < 3.0 ? Sinc(x) * Sinc(x / 3.0) : 0.0;
+}
+
+static void FreeTaps(ResizeTaps* taps)
+{
+    free(taps->start);
+    free(taps->count);
+    free(taps->weights);
+}
+
+static int BuildTaps(int in_size, int out_size, int filter, ResizeTaps* taps)
+{
+    double scale = (double)in_size / (double)out_size;
+    double filter_scale = scale < 1.0 ? 1.0 : scale;
+    double support = (filter == IMAGE_FILTER_LANCZOS ? 3.0 : 0.5) * filter_scale;
+    double (*kernel)(double) = filter == IMAGE_FILTER_LANCZOS ? LanczosFilter : BoxFilter;
+    double* values;
+    int out;
+
+    taps->max_taps = (int)ceil(support) * 2 + 1;
+    taps->start = (int*)malloc((size_t)out_size * sizeof(int));
+    taps->count = (int*)malloc((size_t)out_size * sizeof(int));
+    taps->weights = (int16_t*)calloc((size_t)out_size * (size_t)taps->max_taps, sizeof(int16_t));
+    values = (double*)malloc((size_t)taps->max_taps * sizeof(double));
+    if (taps->start == NULL || taps->count == NULL || taps->weights == NULL || values == NULL)
+    {
+        free(values);
+        FreeTaps(taps);
+        return 0;
+    }
+
+    for (out = 0; out < out_size; out++)
+    {
+        double center = (out + 0.5) * scale;
+        double total = 0.0;
+        int first = (int)(center - support + 0.5);
+        int last = (int)(center + support + 0.5);
+        int count, k;
+        if (first < 0) first = 0;
+        if (last > in_size) last = in_size;
+        count = last - first;
+        if (count > taps->max_taps) count = taps->max_taps;
+        for (k = 0; k < count; k++)
+        {
+            values[k] = kernel((first + k - center + 0.5) / filter_scale);
+            total += values[k];
+        }
+        for (k = 0; k < count; k++)
+        {
+            double weight = total != 0.0 ? values[k] / total : 0.0;
+            taps->weights[(size_t)out * (size_t)taps->max_taps + (size_t)k] =
+                (int16_t)floor(weight * (1 << WEIGHT_BITS) + 0.5);
+        }
+        taps->start[out] = first;
+        taps->count[out] = count;
+    }
+    free(values);
+    return 1;
+}
+
+static unsigned char Clamp(int32_t value)
+{
+    value = (value + WEIGHT_ROUND) >> WEIGHT_BITS;
+    return (unsigned char)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+/*
+ * Horizontal pass over one row.
+ */
+static void ResampleRow(const unsigned char* source, unsigned char* target, int target_width, const ResizeTaps* taps)
+{
+    int x;
+    for (x = 0; x < target_width; x++)
+    {
+        const unsigned char* pixels = source + (size_t)taps->start[x] * 4;
+        const int16_t* weights = taps->weights + (size_t)x * (size_t)taps->max_taps;
+        int count = taps->count[x];
+        int k = 0;
+#ifdef IMAGE_SSE2
+        __m128i zero = _mm_setzero_si128();
+        __m128i sums = zero;
+        for (; k + 1 < count; k += 2)
+        {
+            /* Two pixels as r0 r1 g0 g1 b0 b1 a0 a1, times w0 w1 per channel */
+            __m128i pair = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(pixels + k * 4)), zero);
+            __m128i channels = _mm_unpacklo_epi16(pair, _mm_srli_si128(pair, 8));
+            __m128i weight = _mm_set1_epi32((int)(((uint32_t)(uint16_t)weights[k + 1] << 16) | (uint16_t)weights[k]));
+            sums = _mm_add_epi32(sums, _mm_madd_epi16(channels, weight));
+        }
+        if (k < count)
+        {
+            int32_t single;
+            __m128i pixel;
+            memcpy(&single, pixels + k * 4, 4);
+            pixel = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(single), zero), zero);
+            sums = _mm_add_epi32(sums, _mm_madd_epi16(pixel, _mm_set1_epi32((uint16_t)weights[k])));
+        }
+        sums = _mm_srai_epi32(_mm_add_epi32(sums, _mm_set1_epi32(WEIGHT_ROUND)), WEIGHT_BITS);
+        sums = _mm_packus_epi16(_mm_packs_epi32(sums, zero), zero);
+        {
+            int32_t packed = _mm_cvtsi128_si32(sums);
+            memcpy(target + (size_t)x * 4, &packed, 4);
+        }
+#else
+        int32_t r = 0, g = 0, b = 0, a = 0;
+        for (; k < count; k++)
+        {
+            r += pixels[k * 4 + 0] * weights[k];
+            g += pixels[k * 4 + 1] * weights[k];
+            b += pixels[k * 4 + 2] * weights[k];
+            a += pixels[k * 4 + 3] * weights[k];
+        }
+        target[(size_t)x * 4 + 0] = Clamp(r);
+        target[(size_t)x * 4 + 1] = Clamp(g);
+        target[(size_t)x * 4 + 2] = Clamp(b);
+        target[(size_t)x * 4 + 3] = Clamp(a);
+#endif
+    }
+}
+
+/*
+ * Vertical pass producing one output row from `count` rows of the
+ * intermediate image.
+ */
+static void ResampleColumn(const unsigned char* rows, size_t row_bytes, int count, const int16_t* weights,
+    unsigned char* target)
+{
+    size_t i = 0;
+#ifdef IMAGE_SSE2
+    __m128i zero = _mm_setzero_si128();
+    __m128i round = _mm_set1_epi32(WEIGHT_ROUND);
+    for (; i + 8 <= row_bytes; i += 8)
+    {
+        __m128i low = zero, high = zero;
+        int k = 0;
+        for (; k + 1 < count; k += 2)
+        {
+            __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(rows + (size_t)k * row_bytes + i)), zero);
+            __m128i b = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(rows + (size_t)(k + 1) * row_bytes + i)), zero);
+            __m128i weight = _mm_set1_epi32((int)(((uint32_t)(uint16_t)weights[k + 1] << 16) | (uint16_t)weights[k]));
+            low = _mm_add_epi32(low, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), weight));
+            high = _mm_add_epi32(high, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), weight));
+        }
+        if (k < count)
+        {
+            __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(rows + (size_t)k * row_bytes + i)), zero);
+            __m128i weight = _mm_set1_epi32((uint16_t)weights[k]);
+            low = _mm_add_epi32(low, _mm_madd_epi16(_mm_unpacklo_epi16(a, zero), weight));
+            high = _mm_add_epi32(high, _mm_madd_epi16(_mm_unpackhi_epi16(a, zero), weight));
+        }
+        low = _mm_srai_epi32(_mm_add_epi32(low, round), WEIGHT_BITS);
+        high = _mm_srai_epi32(_mm_add_epi32(high, round), WEIGHT_BITS);
+        _mm_storel_epi64((__m128i*)(target + i), _mm_packus_epi16(_mm_packs_epi32(low, high), zero));
+    }
+#endif
+    for (; i < row_bytes; i++)
+    {
+        int32_t sum = 0;
+        int k;
+        for (k = 0; k < count; k++)
+        {
+            sum += rows[(size_t)k * row_bytes + i] * weights[k];
+        }
+        target[i] = Clamp(sum);
+    }
+}
+
+/* Rows of about this many pixels go to one worker */
+#define RESIZE_CHUNK_PIXELS 65536
+
+typedef struct ResizePass
+{
+    const unsigned char* source;
+    int width;
+    unsigned char* intermediate;
+    size_t row_bytes;
+    unsigned char* target;
+    int target_width;
+    const ResizeTaps* horizontal;
+    const ResizeTaps* vertical;
+} ResizePass;
+
+static int RowGrain(int width)
+{
+    return width >= RESIZE_CHUNK_PIXELS ? 1 : RESIZE_CHUNK_PIXELS / width;
+}
+
+static void ResampleRows(void* context, int begin, int end)
+{
+    const ResizePass* pass = (const ResizePass*)context;
+    int y;
+    for (y = begin; y < end; y++)
+    {
+        ResampleRow(pass->source + (size_t)y * (size_t)pass->width * 4, pass->intermediate + (size_t)y * pass->row_bytes,
+            pass->target_width, pass->horizontal);
+    }
+}
+
+static void ResampleColumns(void* context, int begin, int end)
+{
+    const ResizePass* pass = (const ResizePass*)context;
+    const ResizeTaps* vertical = pass->vertical;
+    int y;
+    for (y = begin; y < end; y++)
+    {
+        ResampleColumn(pass->intermediate + (size_t)vertical->start[y] * pass->row_bytes, pass->row_bytes,
+            vertical->count[y], vertical->weights + (size_t)y * (size_t)vertical->max_taps,
+            pass->target + (size_t)y * pass->row_bytes);
+    }
+}
+
+int ImageResizeInto(const unsigned char* rgba, int width, int height,
+    unsigned char* target, int target_width, int target_height, int filter)
+{
+    ResizeTaps horizontal, vertical;
+    ResizePass pass;
+    int ok = 0;
+
+    if (!BuildTaps(width, target_width, filter, &horizontal))
+    {
+        return 0;
+    }
+    if (!BuildTaps(height, target_height, filter, &vertical))
+    {
+        FreeTaps(&horizontal);
+        return 0;
+    }
+
+    pass.source = rgba;
+    pass.width = width;
+    pass.row_bytes = (size_t)target_width * 4;
+    pass.intermediate = (unsigned char*)malloc(pass.row_bytes * (size_t)height);
+    pass.target = target;
+    pass.target_width = target_width;
+    pass.horizontal = &horizontal;
+    pass.vertical = &vertical;
+    if (pass.intermediate != NULL)
+    {
+        WorkerParallelFor(height, RowGrain(width), ResampleRows, &pass);
+        WorkerParallelFor(target_height, RowGrain(target_width), ResampleColumns, &pass);
+        ok = 1;
+    }
+
+    free(pass.intermediate);
+    FreeTaps(&horizontal);
+    FreeTaps(&vertical);
+    return ok;
+}
+
+unsigned char* ImageResize(const unsigned char* rgba, int width, int height,
+    int target_width, int target_height, int filter)
+{
+    unsigned char* result = (unsigned char*)malloc((size_t)target_width * 4 * (size_t)target_height);
+    if (result != NULL && !ImageResizeInto(rgba, width, height, result, target_width, target_height, filter))
+    {
+        free(result);
+        result = NULL;
+    }
+    return result;
+}
+
+void ImageGrayscale(unsigned char* pixels, size_t pixel_count)
+{
+    size_t i;
+    for (i = 0; i < pixel_count; i++)
+    {
+        const unsigned char* pixel = pixels + i * 4;
+        pixels[i] = (unsigned char)((pixel[0] * 19595u + pixel[1] * 38470u + pixel[2] * 7471u + 32768u) >> 16);
+    }
+}
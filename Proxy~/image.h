@@ -0,0 +1,42 @@
+/*
+ * UnixxtyMCP Proxy - Image resampling
+ *
+ * Separable resize of packed RGBA images with a box (area average) or
+ * Lanczos-3 filter, as Pillow does it: per-axis tap tables with 14-bit
+ * fixed-point weights, a horizontal pass into an 8-bit intermediate image
+ * and a vertical pass. Both passes have SSE2 kernels that multiply-add two
+ * taps per instruction; other targets use the scalar loops. Rows of both
+ * passes are spread over the worker pool. Also converts
+ * RGBA to 8-bit luma for grayscale output.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_IMAGE_H
+#define UNITY_MCP_IMAGE_H
+
+#include <stddef.h>
+
+#define IMAGE_FILTER_BOX 0
+#define IMAGE_FILTER_LANCZOS 1
+
+/*
+ * Resize packed RGBA rows. Returns a malloc'd target_width * target_height
+ * * 4 buffer, or NULL if out of memory.
+ */
+unsigned char* ImageResize(const unsigned char* rgba, int width, int height,
+    int target_width, int target_height, int filter);
+
+/*
+ * Resize packed RGBA rows into a target_width * target_height * 4 buffer.
+ * Returns 0 if out of memory.
+ */
+int ImageResizeInto(const unsigned char* rgba, int width, int height,
+    unsigned char* target, int target_width, int target_height, int filter);
+
+/*
+ * Convert packed RGBA pixels to one luma byte each (BT.601), in place.
+ */
+void ImageGrayscale(unsigned char* pixels, size_t pixel_count);
+
+#endif /* UNITY_MCP_IMAGE_H */
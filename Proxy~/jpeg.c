@@ -0,0 +1,590 @@
+/*
+ * UnixxtyMCP Proxy - Baseline JPEG encoder
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "jpeg.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Natural (row-major) index of each coefficient in zigzag order */
+static const uint8_t ZIGZAG[64] = {
+    0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63 };
+
+static const uint8_t LUMA_QUANT[64] = {
+    16, 11, 10, 16, 24, 40, 51, 61,
+    12, 12, 14, 19, 26, 58, 60, 55,
+    14, 13, 16, 24, 40, 57, 69, 56,
+    14, 17, 22, 29, 51, 87, 80, 62,
+    18, 22, 37, 56, 68, 109, 103, 77,
+    24, 35, 55, 64, 81, 104, 113, 92,
+    49, 64, 78, 87, 103, 121, 120, 101,
+    72, 92, 95, 98, 112, 100, 103, 99 };
+
+static const uint8_t CHROMA_QUANT[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99,
+    18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99,
+    47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99 };
+
+/* Standard Huffman tables: code counts per length 1-16, then symbols */
+static const uint8_t DC_LUMA_BITS[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+static const uint8_t DC_CHROMA_BITS[16] = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+static const uint8_t DC_VALUES[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+static const uint8_t AC_LUMA_BITS[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d };
+static const uint8_t AC_LUMA_VALUES[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa };
+
+static const uint8_t AC_CHROMA_BITS[16] = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+static const uint8_t AC_CHROMA_VALUES[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa };
+
+typedef struct HuffmanTable
+{
+    uint16_t code[256];
+    uint8_t size[256];
+} HuffmanTable;
+
+typedef struct JpegWriter
+{
+    unsigned char* data;
+    size_t length;
+    size_t capacity;
+    uint32_t bits;
+    int count;
+    int failed;
+} JpegWriter;
+
+/* One component: its plane, quantization divisors and tables */
+typedef struct JpegComponent
+{
+    const unsigned char* plane;
+    int stride;
+    const uint16_t* divisors;
+    const HuffmanTable* dc;
+    const HuffmanTable* ac;
+    int previous_dc;
+} JpegComponent;
+
+static void BuildHuffman(const uint8_t* bits, const uint8_t* values, HuffmanTable* table)
+{
+    int code = 0, k = 0, length, i;
+    memset(table, 0, sizeof(*table));
+    for (length = 1; length <= 16; length++)
+    {
+        for (i = 0; i < bits[length - 1]; i++)
+        {
+            table->code[values[k]] = (uint16_t)code;
+            table->size[values[k]] = (uint8_t)length;
+            code++;
+            k++;
+        }
+        code <<= 1;
+    }
+}
+
+/*
+ * Scale a base table by quality (libjpeg's jpeg_quality_scaling).
+ */
+static void ScaleQuant(const uint8_t* base, int quality, uint8_t* table)
+{
+    int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+    int i;
+    for (i = 0; i < 64; i++)
+    {
+        int value = (base[i] * scale + 50) / 100;
+        table[i] = (uint8_t)(value < 1 ? 1 : (value > 255 ? 255 : value));
+    }
+}
+
+/*
+ * Output
+ */
+
+static void PutByte(JpegWriter* writer, unsigned char value)
+{
+    if (writer->length == writer->capacity)
+    {
+        size_t capacity = writer->capacity * 2;
+        unsigned char* data = (unsigned char*)realloc(writer->data, capacity);
+        if (data == NULL)
+        {
+            writer->failed = 1;
+            return;
+        }
+        writer->data = data;
+        writer->capacity = capacity;
+    }
+    writer->data[writer->length++] = value;
+}
+
+static void PutWord(JpegWriter* writer, unsigned value)
+{
+    PutByte(writer, (unsigned char)(value >> 8));
+    PutByte(writer, (unsigned char)value);
+}
+
+/*
+ * Entropy-coded bits, most significant first, with 0xFF stuffing.
+ */
+static void PutBits(JpegWriter* writer, unsigned value, int size)
+{
+    writer->bits = (writer->bits << size) | (value & ((1u << size) - 1));
+    writer->count += size;
+    while (writer->count >= 8)
+    {
+        unsigned char byte = (unsigned char)(writer->bits >> (writer->count - 8));
+        PutByte(writer, byte);
+        if (byte == 0xff)
+        {
+            PutByte(writer, 0);
+        }
+        writer->count -= 8;
+    }
+}
+
+static void PutQuantTable(JpegWriter* writer, int id, const uint8_t* table)
+{
+    int i;
+    PutByte(writer, (unsigned char)id);
+    for (i = 0; i < 64; i++)
+    {
+        PutByte(writer, table[ZIGZAG[i]]);
+    }
+}
+
+static void PutHuffmanTable(JpegWriter* writer, int table_class, int id, const uint8_t* bits,
+    const uint8_t* values, int count)
+{
+    int i;
+    PutByte(writer, (unsigned char)((table_class << 4) | id));
+    for (i = 0; i < 16; i++)
+    {
+        PutByte(writer, bits[i]);
+    }
+    for (i = 0; i < count; i++)
+    {
+        PutByte(writer, values[i]);
+    }
+}
+
+/*
+ * Forward DCT
+ */
+
+#define CONST_BITS 13
+#define PASS1_BITS 2
+#define DESCALE(x, n) (((x) + (1 << ((n) - 1))) >> (n))
+
+#define FIX_0_298631336 2446
+#define FIX_0_390180644 3196
+#define FIX_0_541196100 4433
+#define FIX_0_765366865 6270
+#define FIX_0_899976223 7373
+#define FIX_1_175875602 9633
+#define FIX_1_501321110 12299
+#define FIX_1_847759065 15137
+#define FIX_1_961570560 16069
+#define FIX_2_053119869 16819
+#define FIX_2_562915447 20995
+#define FIX_3_072711026 25172
+
+/*
+ * Integer DCT of a block of level-shifted samples, in place. The output is
+ * scaled up by 8, which the quantization divisors absorb.
+ */
+static void ForwardDct(int32_t* block)
+{
+    int pass;
+    for (pass = 0; pass < 2; pass++)
+    {
+        /* Rows first, then columns */
+        int step = pass == 0 ? 1 : 8;
+        int next = pass == 0 ? 8 : 1;
+        int i;
+        for (i = 0; i < 8; i++)
+        {
+            int32_t* d = block + i * next;
+            int32_t tmp0 = d[0 * step] + d[7 * step];
+            int32_t tmp7 = d[0 * step] - d[7 * step];
+            int32_t tmp1 = d[1 * step] + d[6 * step];
+            int32_t tmp6 = d[1 * step] - d[6 * step];
+            int32_t tmp2 = d[2 * step] + d[5 * step];
+            int32_t tmp5 = d[2 * step] - d[5 * step];
+            int32_t tmp3 = d[3 * step] + d[4 * step];
+            int32_t tmp4 = d[3 * step] - d[4 * step];
+            int32_t tmp10 = tmp0 + tmp3;
+            int32_t tmp13 = tmp0 - tmp3;
+            int32_t tmp11 = tmp1 + tmp2;
+            int32_t tmp12 = tmp1 - tmp2;
+            int32_t z1, z2, z3, z4, z5;
+            int shift = pass == 0 ? CONST_BITS - PASS1_BITS : CONST_BITS + PASS1_BITS;
+
+            if (pass == 0)
+            {
+                d[0 * step] = (tmp10 + tmp11) * (1 << PASS1_BITS);
+                d[4 * step] = (tmp10 - tmp11) * (1 << PASS1_BITS);
+            }
+            else
+            {
+                d[0 * step] = DESCALE(tmp10 + tmp11, PASS1_BITS);
+                d[4 * step] = DESCALE(tmp10 - tmp11, PASS1_BITS);
+            }
+
+            z1 = (tmp12 + tmp13) * FIX_0_541196100;
+            d[2 * step] = DESCALE(z1 + tmp13 * FIX_0_765366865, shift);
+            d[6 * step] = DESCALE(z1 - tmp12 * FIX_1_847759065, shift);
+
+            z1 = tmp4 + tmp7;
+            z2 = tmp5 + tmp6;
+            z3 = tmp4 + tmp6;
+            z4 = tmp5 + tmp7;
+            z5 = (z3 + z4) * FIX_1_175875602;
+            tmp4 *= FIX_0_298631336;
+            tmp5 *= FIX_2_053119869;
+            tmp6 *= FIX_3_072711026;
+            tmp7 *= FIX_1_501321110;
+            z1 *= -FIX_0_899976223;
+            z2 *= -FIX_2_562915447;
+            z3 = z3 * -FIX_1_961570560 + z5;
+            z4 = z4 * -FIX_0_390180644 + z5;
+
+            d[7 * step] = DESCALE(tmp4 + z1 + z3, shift);
+            d[5 * step] = DESCALE(tmp5 + z2 + z4, shift);
+            d[3 * step] = DESCALE(tmp6 + z2 + z3, shift);
+            d[1 * step] = DESCALE(tmp7 + z1 + z4, shift);
+        }
+    }
+}
+
+/*
+ * Entropy-code one 8x8 block whose top-left sample is at `samples`.
+ */
+static void EncodeBlock(JpegWriter* writer, JpegComponent* component, const unsigned char* samples)
+{
+    int32_t block[64];
+    int quantized[64];
+    int i, run = 0, value, magnitude, size;
+
+    for (i = 0; i < 64; i++)
+    {
+        block[i] = (int32_t)samples[(i >> 3) * component->stride + (i & 7)] - 128;
+    }
+    ForwardDct(block);
+    for (i = 0; i < 64; i++)
+    {
+        int32_t coefficient = block[ZIGZAG[i]];
+        int32_t divisor = component->divisors[ZIGZAG[i]];
+        quantized[i] = coefficient < 0
+            ? -(int)((-coefficient + divisor / 2) / divisor)
+            : (int)((coefficient + divisor / 2) / divisor);
+    }
+
+    /* DC difference */
+    value = quantized[0] - component->previous_dc;
+    component->previous_dc = quantized[0];
+    magnitude = value < 0 ? -value : value;
+    for (size = 0; magnitude > 0; size++)
+    {
+        magnitude >>= 1;
+    }
+    PutBits(writer, component->dc->code[size], component->dc->size[size]);
+    if (size > 0)
+    {
+        PutBits(writer, (unsigned)(value < 0 ? value - 1 : value), size);
+    }
+
+    /* AC run lengths */
+    for (i = 1; i < 64; i++)
+    {
+        value = quantized[i];
+        if (value == 0)
+        {
+            run++;
+            continue;
+        }
+        while (run > 15)
+        {
+            PutBits(writer, component->ac->code[0xf0], component->ac->size[0xf0]);
+            run -= 16;
+        }
+        magnitude = value < 0 ? -value : value;
+        for (size = 0; magnitude > 0; size++)
+        {
+            magnitude >>= 1;
+        }
+        PutBits(writer, component->ac->code[(run << 4) | size], component->ac->size[(run << 4) | size]);
+        PutBits(writer, (unsigned)(value < 0 ? value - 1 : value), size);
+        run = 0;
+    }
+    if (run > 0)
+    {
+        PutBits(writer, component->ac->code[0x00], component->ac->size[0x00]);
+    }
+}
+
+/*
+ * Color planes
+ */
+
+/*
+ * Split the image into Y (and, for color, 2x2-averaged Cb and Cr) planes
+ * padded to whole MCUs by repeating the edge samples.
+ */
+static int BuildPlanes(const unsigned char* pixels, int width, int height, int channels,
+    int padded_width, int padded_height, unsigned char** planes)
+{
+    int color = channels >= 3;
+    int chroma_width = padded_width / 2;
+    int x, y;
+
+    planes[0] = (unsigned char*)malloc((size_t)padded_width * (size_t)padded_height);
+    planes[1] = planes[2] = NULL;
+    if (planes[0] == NULL)
+    {
+        return 0;
+    }
+    if (color)
+    {
+        planes[1] = (unsigned char*)malloc((size_t)chroma_width * (size_t)(padded_height / 2));
+        planes[2] = (unsigned char*)malloc((size_t)chroma_width * (size_t)(padded_height / 2));
+        if (planes[1] == NULL || planes[2] == NULL)
+        {
+            return 0;
+        }
+    }
+
+    for (y = 0; y < padded_height; y++)
+    {
+        const unsigned char* row = pixels + (size_t)(y < height ? y : height - 1) * (size_t)width * (size_t)channels;
+        unsigned char* luma = planes[0] + (size_t)y * (size_t)padded_width;
+        for (x = 0; x < padded_width; x++)
+        {
+            const unsigned char* pixel = row + (size_t)(x < width ? x : width - 1) * (size_t)channels;
+            luma[x] = color
+                ? (unsigned char)((pixel[0] * 19595u + pixel[1] * 38470u + pixel[2] * 7471u + 32768u) >> 16)
+                : pixel[0];
+        }
+    }
+
+    if (color)
+    {
+        for (y = 0; y < padded_height / 2; y++)
+        {
+            unsigned char* cb = planes[1] + (size_t)y * (size_t)chroma_width;
+            unsigned char* cr = planes[2] + (size_t)y * (size_t)chroma_width;
+            int y0 = 2 * y < height ? 2 * y : height - 1;
+            int y1 = 2 * y + 1 < height ? 2 * y + 1 : height - 1;
+            for (x = 0; x < chroma_width; x++)
+            {
+                int x0 = 2 * x < width ? 2 * x : width - 1;
+                int x1 = 2 * x + 1 < width ? 2 * x + 1 : width - 1;
+                const unsigned char* p[4];
+                int32_t r = 0, g = 0, b = 0;
+                int k;
+                p[0] = pixels + ((size_t)y0 * (size_t)width + (size_t)x0) * (size_t)channels;
+                p[1] = pixels + ((size_t)y0 * (size_t)width + (size_t)x1) * (size_t)channels;
+                p[2] = pixels + ((size_t)y1 * (size_t)width + (size_t)x0) * (size_t)channels;
+                p[3] = pixels + ((size_t)y1 * (size_t)width + (size_t)x1) * (size_t)channels;
+                for (k = 0; k < 4; k++)
+                {
+                    r += p[k][0];
+                    g += p[k][1];
+                    b += p[k][2];
+                }
+                /* Sums of 4 samples: the extra 2 bits come off with the 16-bit shift */
+                cb[x] = (unsigned char)((-11059 * r - 21709 * g + 32768 * b + (128 << 18) + (1 << 17)) >> 18);
+                cr[x] = (unsigned char)((32768 * r - 27439 * g - 5329 * b + (128 << 18) + (1 << 17)) >> 18);
+            }
+        }
+    }
+    return 1;
+}
+
+unsigned char* JpegEncode(const unsigned char* pixels, int width, int height, int channels,
+    int quality, size_t* size)
+{
+    HuffmanTable dc_luma, ac_luma, dc_chroma, ac_chroma;
+    uint8_t luma_quant[64], chroma_quant[64];
+    uint16_t luma_divisors[64], chroma_divisors[64];
+    unsigned char* planes[3];
+    JpegComponent components[3];
+    JpegWriter writer;
+    int color = channels >= 3;
+    int mcu = color ? 16 : 8;
+    int padded_width = (width + mcu - 1) / mcu * mcu;
+    int padded_height = (height + mcu - 1) / mcu * mcu;
+    int component_count = color ? 3 : 1;
+    int i, x, y;
+
+    if (pixels == NULL || width <= 0 || height <= 0 || width > JPEG_MAX_DIMENSION || height > JPEG_MAX_DIMENSION ||
+        (channels != 1 && channels != 3 && channels != 4))
+    {
+        return NULL;
+    }
+    if (quality < 1) quality = 1;
+    if (quality > 100) quality = 100;
+
+    ScaleQuant(LUMA_QUANT, quality, luma_quant);
+    ScaleQuant(CHROMA_QUANT, quality, chroma_quant);
+    for (i = 0; i < 64; i++)
+    {
+        luma_divisors[i] = (uint16_t)(luma_quant[i] * 8);
+        chroma_divisors[i] = (uint16_t)(chroma_quant[i] * 8);
+    }
+    BuildHuffman(DC_LUMA_BITS, DC_VALUES, &dc_luma);
+    BuildHuffman(AC_LUMA_BITS, AC_LUMA_VALUES, &ac_luma);
+    BuildHuffman(DC_CHROMA_BITS, DC_VALUES, &dc_chroma);
+    BuildHuffman(AC_CHROMA_BITS, AC_CHROMA_VALUES, &ac_chroma);
+
+    if (!BuildPlanes(pixels, width, height, channels, padded_width, padded_height, planes))
+    {
+        free(planes[0]);
+        free(planes[1]);
+        free(planes[2]);
+        return NULL;
+    }
+
+    memset(&writer, 0, sizeof(writer));
+    writer.capacity = 4096 + (size_t)width * (size_t)height / 4;
+    writer.data = (unsigned char*)malloc(writer.capacity);
+    writer.failed = writer.data == NULL;
+
+    if (!writer.failed)
+    {
+        /* SOI, JFIF APP0 */
+        static const unsigned char JFIF[18] = {
+            0xff, 0xd8, 0xff, 0xe0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01 };
+        for (i = 0; i < 18; i++)
+        {
+            PutByte(&writer, JFIF[i]);
+        }
+        PutWord(&writer, 0x0000);   /* No thumbnail */
+
+        PutWord(&writer, 0xffdb);
+        PutWord(&writer, color ? 2 + 2 * 65 : 2 + 65);
+        PutQuantTable(&writer, 0, luma_quant);
+        if (color)
+        {
+            PutQuantTable(&writer, 1, chroma_quant);
+        }
+
+        PutWord(&writer, 0xffc0);
+        PutWord(&writer, (unsigned)(8 + 3 * component_count));
+        PutByte(&writer, 8);
+        PutWord(&writer, (unsigned)height);
+        PutWord(&writer, (unsigned)width);
+        PutByte(&writer, (unsigned char)component_count);
+        for (i = 0; i < component_count; i++)
+        {
+            PutByte(&writer, (unsigned char)(i + 1));
+            PutByte(&writer, i == 0 && color ? 0x22 : 0x11);
+            PutByte(&writer, i == 0 ? 0 : 1);
+        }
+
+        PutWord(&writer, 0xffc4);
+        PutWord(&writer, color ? 2 + 2 * (17 + 12) + 2 * (17 + 162) : 2 + (17 + 12) + (17 + 162));
+        PutHuffmanTable(&writer, 0, 0, DC_LUMA_BITS, DC_VALUES, 12);
+        PutHuffmanTable(&writer, 1, 0, AC_LUMA_BITS, AC_LUMA_VALUES, 162);
+        if (color)
+        {
+            PutHuffmanTable(&writer, 0, 1, DC_CHROMA_BITS, DC_VALUES, 12);
+            PutHuffmanTable(&writer, 1, 1, AC_CHROMA_BITS, AC_CHROMA_VALUES, 162);
+        }
+
+        PutWord(&writer, 0xffda);
+        PutWord(&writer, (unsigned)(6 + 2 * component_count));
+        PutByte(&writer, (unsigned char)component_count);
+        for (i = 0; i < component_count; i++)
+        {
+            PutByte(&writer, (unsigned char)(i + 1));
+            PutByte(&writer, i == 0 ? 0x00 : 0x11);
+        }
+        PutByte(&writer, 0);
+        PutByte(&writer, 63);
+        PutByte(&writer, 0);
+
+        components[0].plane = planes[0];
+        components[0].stride = padded_width;
+        components[0].divisors = luma_divisors;
+        components[0].dc = &dc_luma;
+        components[0].ac = &ac_luma;
+        components[0].previous_dc = 0;
+        for (i = 1; i < component_count; i++)
+        {
+            components[i].plane = planes[i];
+            components[i].stride = padded_width / 2;
+            components[i].divisors = chroma_divisors;
+            components[i].dc = &dc_chroma;
+            components[i].ac = &ac_chroma;
+            components[i].previous_dc = 0;
+        }
+
+        for (y = 0; y < padded_height && !writer.failed; y += mcu)
+        {
+            for (x = 0; x < padded_width; x += mcu)
+            {
+                const unsigned char* luma = planes[0] + (size_t)y * (size_t)padded_width + (size_t)x;
+                if (color)
+                {
+                    size_t chroma_offset = (size_t)(y / 2) * (size_t)(padded_width / 2) + (size_t)(x / 2);
+                    EncodeBlock(&writer, &components[0], luma);
+                    EncodeBlock(&writer, &components[0], luma + 8);
+                    EncodeBlock(&writer, &components[0], luma + 8 * padded_width);
+                    EncodeBlock(&writer, &components[0], luma + 8 * padded_width + 8);
+                    EncodeBlock(&writer, &components[1], planes[1] + chroma_offset);
+                    EncodeBlock(&writer, &components[2], planes[2] + chroma_offset);
+                }
+                else
+                {
+                    EncodeBlock(&writer, &components[0], luma);
+                }
+            }
+        }
+
+        /* Pad the last byte with ones, then EOI */
+        PutBits(&writer, 0x7f, 7);
+        PutWord(&writer, 0xffd9);
+    }
+
+    free(planes[0]);
+    free(planes[1]);
+    free(planes[2]);
+    if (writer.failed)
+    {
+        free(writer.data);
+        return NULL;
+    }
+    *size = writer.length;
+    return writer.data;
+}
@@ -0,0 +1,28 @@
+/*
+ * UnixxtyMCP Proxy - Baseline JPEG encoder
+ *
+ * Lossy output for captures that only need to be looked at. Baseline
+ * sequential JPEG (JFIF) with the standard Annex K quantization tables
+ * scaled by quality as libjpeg does, the standard Huffman tables, 4:2:0
+ * chroma subsampling for color, and the accurate integer DCT (the
+ * Loeffler-Ligtenberg-Moschytz factorization libjpeg calls "islow").
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_JPEG_H
+#define UNITY_MCP_JPEG_H
+
+#include <stddef.h>
+
+#define JPEG_MAX_DIMENSION 65535
+
+/*
+ * Encode packed rows, top first: 1 channel for grayscale, 3 for RGB or 4
+ * for RGBA (alpha is ignored). Quality is 1-100. Returns the malloc'd
+ * file (its size in `size`), or NULL if out of memory or too large.
+ */
+unsigned char* JpegEncode(const unsigned char* pixels, int width, int height, int channels,
+    int quality, size_t* size);
+
+#endif /* UNITY_MCP_JPEG_H */
@@ -0,0 +1,434 @@
+/*
+ * UnixxtyMCP Proxy - JSON helpers
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "jsonutil.h"
+#include <string.h>
+#include <stdlib.h>
+
+#define JSON_MAX_DEPTH 64
+#define JSON_INLINE_MEMBERS 32
+
+const char* JsonSkipWhitespace(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+    {
+        p++;
+    }
+    return p;
+}
+
+static const char* SkipString(const char* p, const char* end)
+{
+    /* p points at the opening quote */
+    p++;
+    while (p < end)
+    {
+        if (*p == '\\')
+        {
+            p += 2;
+            continue;
+        }
+        if (*p == '"')
+        {
+            return p + 1;
+        }
+        p++;
+    }
+    return NULL;
+}
+
+static const char* SkipValueDepth(const char* p, const char* end, int depth)
+{
+    p = JsonSkipWhitespace(p, end);
+    if (p >= end || depth > JSON_MAX_DEPTH)
+    {
+        return NULL;
+    }
+
+    if (*p == '"')
+    {
+        return SkipString(p, end);
+    }
+
+    if (*p == '{' || *p == '[')
+    {
+        char close = (*p == '{') ? '}' : ']';
+        int is_object = (*p == '{');
+        p = JsonSkipWhitespace(p + 1, end);
+        if (p < end && *p == close)
+        {
+            return p + 1;
+        }
+        while (p < end)
+        {
+            if (is_object)
+            {
+                p = JsonSkipWhitespace(p, end);
+                if (p >= end || *p != '"')
+                {
+                    return NULL;
+                }
+                p = SkipString(p, end);
+                if (p == NULL)
+                {
+                    return NULL;
+                }
+                p = JsonSkipWhitespace(p, end);
+                if (p >= end || *p != ':')
+                {
+                    return NULL;
+                }
+                p++;
+            }
+            p = SkipValueDepth(p, end, depth + 1);
+            if (p == NULL)
+            {
+                return NULL;
+            }
+            p = JsonSkipWhitespace(p, end);
+            if (p >= end)
+            {
+                return NULL;
+            }
+            if (*p == ',')
+            {
+                p++;
+                continue;
+            }
+            if (*p == close)
+            {
+                return p + 1;
+            }
+            return NULL;
+        }
+        return NULL;
+    }
+
+    /* Number or literal: scan to the next structural character */
+    {
+        const char* start = p;
+        while (p < end && *p != ',' && *p != '}' && *p != ']' &&
+               *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r')
+        {
+            p++;
+        }
+        return (p > start) ? p : NULL;
+    }
+}
+
+const char* JsonSkipValue(const char* p, const char* end)
+{
+    return SkipValueDepth(p, end, 0);
+}
+
+int JsonFindMember(struct mg_str json, const char* key, struct mg_str* value)
+{
+    const char* p = json.buf;
+    const char* end = json.buf + json.len;
+    size_t key_length = strlen(key);
+
+    p = JsonSkipWhitespace(p, end);
+    if (p >= end || *p != '{')
+    {
+        return 0;
+    }
+    p = JsonSkipWhitespace(p + 1, end);
+
+    while (p < end && *p == '"')
+    {
+        const char* key_start = p + 1;
+        const char* key_end = SkipString(p, end);
+        const char* value_start;
+        const char* value_end;
+        if (key_end == NULL)
+        {
+            return 0;
+        }
+        p = JsonSkipWhitespace(key_end, end);
+        if (p >= end || *p != ':')
+        {
+            return 0;
+        }
+        value_start = JsonSkipWhitespace(p + 1, end);
+        value_end = JsonSkipValue(value_start, end);
+        if (value_end == NULL)
+        {
+            return 0;
+        }
+
+        if ((size_t)(key_end - 1 - key_start) == key_length &&
+            memcmp(key_start, key, key_length) == 0)
+        {
+            if (value != NULL)
+            {
+                *value = mg_str_n(value_start, (size_t)(value_end - value_start));
+            }
+            return 1;
+        }
+
+        p = JsonSkipWhitespace(value_end, end);
+        if (p < end && *p == ',')
+        {
+            p = JsonSkipWhitespace(p + 1, end);
+        }
+        else
+        {
+            break;
+        }
+    }
+    return 0;
+}
+
+struct mg_str JsonStringContents(struct mg_str token)
+{
+    if (token.len >= 2 && token.buf[0] == '"' && token.buf[token.len - 1] == '"')
+    {
+        return mg_str_n(token.buf + 1, token.len - 2);
+    }
+    return mg_str_n(NULL, 0);
+}
+
+/*
+ * Object member spans collected while canonicalizing an object.
+ */
+typedef struct JsonMember
+{
+    struct mg_str key;    /* Including quotes */
+    struct mg_str value;
+} JsonMember;
+
+static int CompareMembers(const void* a, const void* b)
+{
+    const JsonMember* x = (const JsonMember*)a;
+    const JsonMember* y = (const JsonMember*)b;
+    size_t n = x->key.len < y->key.len ? x->key.len : y->key.len;
+    int result = memcmp(x->key.buf, y->key.buf, n);
+    if (result != 0)
+    {
+        return result;
+    }
+    return (x->key.len > y->key.len) - (x->key.len < y->key.len);
+}
+
+static int CanonicalizeDepth(struct mg_str json, const char* skip_key, struct mg_iobuf* out, int depth)
+{
+    const char* p = json.buf;
+    const char* end = json.buf + json.len;
+
+    p = JsonSkipWhitespace(p, end);
+    if (p >= end || depth > JSON_MAX_DEPTH)
+    {
+        return -1;
+    }
+
+    if (*p == '[')
+    {
+        int first = 1;
+        mg_iobuf_add(out, out->len, "[", 1);
+        p = JsonSkipWhitespace(p + 1, end);
+        if (p < end && *p == ']')
+        {
+            mg_iobuf_add(out, out->len, "]", 1);
+            return 0;
+        }
+        while (p < end)
+        {
+            const char* value_end = JsonSkipValue(p, end);
+            if (value_end == NULL)
+            {
+                return -1;
+            }
+            if (!first)
+            {
+                mg_iobuf_add(out, out->len, ",", 1);
+            }
+            first = 0;
+            if (CanonicalizeDepth(mg_str_n(p, (size_t)(value_end - p)), NULL, out, depth + 1) != 0)
+            {
+                return -1;
+            }
+            p = JsonSkipWhitespace(value_end, end);
+            if (p < end && *p == ',')
+            {
+                p = JsonSkipWhitespace(p + 1, end);
+                continue;
+            }
+            if (p < end && *p == ']')
+            {
+                mg_iobuf_add(out, out->len, "]", 1);
+                return 0;
+            }
+            return -1;
+        }
+        return -1;
+    }
+
+    if (*p == '{')
+    {
+        JsonMember inline_members[JSON_INLINE_MEMBERS];
+        JsonMember* members = inline_members;
+        size_t capacity = JSON_INLINE_MEMBERS;
+        size_t count = 0;
+        size_t skip_length = skip_key != NULL ? strlen(skip_key) : 0;
+        size_t i;
+        int status = 0;
+
+        p = JsonSkipWhitespace(p + 1, end);
+        while (p < end && *p == '"')
+        {
+            const char* key_end = SkipString(p, end);
+            const char* value_start;
+            const char* value_end;
+            if (key_end == NULL)
+            {
+                status = -1;
+                break;
+            }
+            value_start = JsonSkipWhitespace(key_end, end);
+            if (value_start >= end || *value_start != ':')
+            {
+                status = -1;
+                break;
+            }
+            value_start = JsonSkipWhitespace(value_start + 1, end);
+            value_end = JsonSkipValue(value_start, end);
+            if (value_end == NULL)
+            {
+                status = -1;
+                break;
+            }
+
+            if (!(skip_key != NULL && (size_t)(key_end - p) == skip_length + 2 &&
+                  memcmp(p + 1, skip_key, skip_length) == 0))
+            {
+                if (count == capacity)
+                {
+                    JsonMember* grown = (JsonMember*)malloc(capacity * 2 * sizeof(JsonMember));
+                    if (grown == NULL)
+                    {
+                        status = -1;
+                        break;
+                    }
+                    memcpy(grown, members, count * sizeof(JsonMember));
+                    if (members != inline_members)
+                    {
+                        free(members);
+                    }
+                    members = grown;
+                    capacity *= 2;
+                }
+                members[count].key = mg_str_n(p, (size_t)(key_end - p));
+                members[count].value = mg_str_n(value_start, (size_t)(value_end - value_start));
+                count++;
+            }
+
+            p = JsonSkipWhitespace(value_end, end);
+            if (p < end && *p == ',')
+            {
+                p = JsonSkipWhitespace(p + 1, end);
+            }
+        }
+        if (status == 0 && (p >= end || *p != '}'))
+        {
+            status = -1;
+        }
+
+        if (status == 0)
+        {
+            qsort(members, count, sizeof(JsonMember), CompareMembers);
+            mg_iobuf_add(out, out->len, "{", 1);
+            for (i = 0; i < count && status == 0; i++)
+            {
+                if (i > 0)
+                {
+                    mg_iobuf_add(out, out->len, ",", 1);
+                }
+                mg_iobuf_add(out, out->len, members[i].key.buf, members[i].key.len);
+                mg_iobuf_add(out, out->len, ":", 1);
+                status = CanonicalizeDepth(members[i].value, NULL, out, depth + 1);
+            }
+            mg_iobuf_add(out, out->len, "}", 1);
+        }
+
+        if (members != inline_members)
+        {
+            free(members);
+        }
+        return status;
+    }
+
+    /* Scalars are copied verbatim */
+    {
+        const char* value_end = JsonSkipValue(p, end);
+        if (value_end == NULL)
+        {
+            return -1;
+        }
+        mg_iobuf_add(out, out->len, p, (size_t)(value_end - p));
+        return 0;
+    }
+}
+
+int JsonCanonicalize(struct mg_str json, const char* skip_key, struct mg_iobuf* out)
+{
+    return CanonicalizeDepth(json, skip_key, out, 0);
+}
+
+void JsonAppendString(struct mg_iobuf* out, const char* text, size_t length)
+{
+    static const char HEX[] = "0123456789abcdef";
+    size_t run = 0;
+    size_t i;
+
+    mg_iobuf_add(out, out->len, "\"", 1);
+    for (i = 0; i < length; i++)
+    {
+        unsigned char c = (unsigned char)text[i];
+        char escape[6];
+        size_t escape_length = 2;
+
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+        /* Flush the plain run before this byte */
+        mg_iobuf_add(out, out->len, text + run, i - run);
+        run = i + 1;
+        escape[0] = '\\';
+        switch (c)
+        {
+        case '"': escape[1] = '"'; break;
+        case '\\': escape[1] = '\\'; break;
+        case '\n': escape[1] = 'n'; break;
+        case '\r': escape[1] = 'r'; break;
+        case '\t': escape[1] = 't'; break;
+        default:
+            escape[1] = 'u';
+            escape[2] = '0';
+            escape[3] = '0';
+            escape[4] = HEX[c >> 4];
+            escape[5] = HEX[c & 15];
+            escape_length = 6;
+            break;
+        }
+        mg_iobuf_add(out, out->len, escape, escape_length);
+    }
+    mg_iobuf_add(out, out->len, text + run, length - run);
+    mg_iobuf_add(out, out->len, "\"", 1);
+}
+
+uint64_t JsonHash64(const void* data, size_t length, uint64_t seed)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t hash = seed;
+    size_t i;
+    for (i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
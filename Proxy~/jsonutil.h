@@ -0,0 +1,67 @@
+/*
+ * UnixxtyMCP Proxy - JSON helpers
+ *
+ * Allocation-free scanning helpers for the JSON-RPC envelopes that pass
+ * through the proxy. They operate on raw text spans and never unescape
+ * strings; keys are compared byte-for-byte as they appear on the wire.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_JSONUTIL_H
+#define UNITY_MCP_JSONUTIL_H
+
+#include "mongoose.h"
+
+/*
+ * Skip JSON whitespace. Returns the first non-whitespace position (or end).
+ */
+const char* JsonSkipWhitespace(const char* p, const char* end);
+
+/*
+ * Skip one JSON value starting at p (leading whitespace allowed).
+ * Returns the position just past the value, or NULL if malformed.
+ */
+const char* JsonSkipValue(const char* p, const char* end);
+
+/*
+ * Find a top-level member of a JSON object.
+ *
+ * @param json   The object text (must start with '{' after whitespace)
+ * @param key    The member name, compared against the raw (escaped) key
+ * @param value  Receives the value span (strings include their quotes)
+ * @return 1 if found, 0 otherwise
+ */
+int JsonFindMember(struct mg_str json, const char* key, struct mg_str* value);
+
+/*
+ * Return the contents of a JSON string token without its quotes.
+ * Escapes are left as-is. Returns an empty span if the token is not a string.
+ */
+struct mg_str JsonStringContents(struct mg_str token);
+
+/*
+ * Append the canonical form of a JSON value to `out`: insignificant
+ * whitespace removed and object members sorted by key, recursively.
+ * If skip_key is non-NULL, a member with that name is dropped from the
+ * top-level object only (used to ignore "_meta" in request params).
+ *
+ * @return 0 on success, -1 if the input is malformed
+ */
+int JsonCanonicalize(struct mg_str json, const char* skip_key, struct mg_iobuf* out);
+
+/*
+ * Append `text` as a quoted JSON string, escaping quotes, backslashes and
+ * control characters. Other bytes are copied as they are (UTF-8 passes
+ * through).
+ */
+void JsonAppendString(struct mg_iobuf* out, const char* text, size_t length);
+
+/*
+ * 64-bit FNV-1a hash. Pass the previous result as seed to hash
+ * several spans as one; use JSON_HASH_SEED for the first span.
+ */
+#define JSON_HASH_SEED 0xcbf29ce484222325ull
+uint64_t JsonHash64(const void* data, size_t length, uint64_t seed);
+
+#endif /* UNITY_MCP_JSONUTIL_H */
@@ -0,0 +1,1184 @@
+/*
+ * UnixxtyMCP Proxy - Line patterns
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "pattern.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PATTERN_MAX_NODES 2048
+#define PATTERN_MAX_CLASSES 256
+#define PATTERN_MAX_DEPTH 64
+
+typedef enum
+{
+    NODE_EMPTY,
+    NODE_CHAR,
+    NODE_ANY,
+    NODE_CLASS,
+    NODE_LINE_START,
+    NODE_LINE_END,
+    NODE_WORD_BOUNDARY,
+    NODE_NOT_WORD_BOUNDARY,
+    NODE_CONCAT,
+    NODE_ALTERNATE,
+    NODE_REPEAT
+} NodeType;
+
+typedef struct Node
+{
+    NodeType type;
+    unsigned char c;        /* NODE_CHAR */
+    int class_index;        /* NODE_CLASS */
+    int min;                /* NODE_REPEAT */
+    int max;                /* NODE_REPEAT, -1 for unbounded */
+    int child;              /* First child, -1 if none */
+    int next;               /* Next sibling, -1 if last */
+} Node;
+
+typedef enum
+{
+    OP_CHAR,
+    OP_CHAR_FOLDED,         /* Input byte lowercased before comparing */
+    OP_ANY,
+    OP_CLASS,
+    OP_LINE_START,
+    OP_LINE_END,
+    OP_WORD_BOUNDARY,
+    OP_NOT_WORD_BOUNDARY,
+    OP_SPLIT,               /* Fork: x first, then y */
+    OP_JUMP,
+    OP_MATCH
+} OpCode;
+
+typedef struct Instruction
+{
+    unsigned char op;
+    unsigned char c;
+    unsigned short class_index;
+    int x;
+    int y;
+} Instruction;
+
+typedef struct ClassBits
+{
+    uint32_t bits[8];
+} ClassBits;
+
+struct Pattern
+{
+    Instruction* program;
+    int length;
+    ClassBits* classes;
+    int class_count;
+    int anchored;           /* Starts with '^': only tried at offset 0 */
+    PatternPlan plan;
+};
+
+typedef struct PatternThread
+{
+    int pc;
+    size_t start;
+} PatternThread;
+
+struct PatternScratch
+{
+    PatternThread* current;
+    PatternThread* next;
+    int* stack;
+    uint32_t* marks;
+    uint32_t generation;
+};
+
+/* Parse and compile state */
+typedef struct PatternParser
+{
+    const char* p;
+    const char* end;
+    int ignore_case;
+    const char* error;
+    Node nodes[PATTERN_MAX_NODES];
+    int node_count;
+    ClassBits classes[PATTERN_MAX_CLASSES];
+    int class_count;
+    Instruction* program;
+    int length;
+} PatternParser;
+
+static int IsWordByte(unsigned char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static unsigned char FoldByte(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + 32) : c;
+}
+
+static void SetBit(ClassBits* bits, unsigned c)
+{
+    bits->bits[c >> 5] |= 1u << (c & 31);
+}
+
+static int TestBit(const ClassBits* bits, unsigned c)
+{
+    return (bits->bits[c >> 5] >> (c & 31)) & 1;
+}
+
+/*
+ * Syntax tree
+ */
+
+static int NewNode(PatternParser* parser, NodeType type)
+{
+    Node* node;
+    if (parser->node_count == PATTERN_MAX_NODES)
+    {
+        parser->error = "Pattern too complex";
+        return -1;
+    }
+    node = &parser->nodes[parser->node_count];
+    memset(node, 0, sizeof(*node));
+    node->type = type;
+    node->child = -1;
+    node->next = -1;
+    return parser->node_count++;
+}
+
+static int NewClass(PatternParser* parser)
+{
+    if (parser->class_count == PATTERN_MAX_CLASSES)
+    {
+        parser->error = "Too many character classes";
+        return -1;
+    }
+    memset(&parser->classes[parser->class_count], 0, sizeof(ClassBits));
+    return parser->class_count++;
+}
+
+/*
+ * Add the set of a class escape (\d \w \s, or their negations) to a class.
+ * Returns 0 if `e` is not one.
+ */
+static int AddClassEscape(ClassBits* bits, char e)
+{
+    ClassBits set;
+    unsigned c;
+    int negate = e == 'D' || e == 'W' || e == 'S';
+
+    memset(&set, 0, sizeof(set));
+    switch (e)
+    {
+    case 'd': case 'D':
+        for (c = '0'; c <= '9'; c++) SetBit(&set, c);
+        break;
+    case 'w': case 'W':
+        for (c = 0; c < 256; c++) if (IsWordByte((unsigned char)c)) SetBit(&set, c);
+        break;
+    case 's': case 'S':
+        SetBit(&set, ' '); SetBit(&set, '\t'); SetBit(&set, '\n');
+        SetBit(&set, '\r'); SetBit(&set, '\f'); SetBit(&set, '\v');
+        break;
+    default:
+        return 0;
+    }
+    for (c = 0; c < 8; c++)
+    {
+        bits->bits[c] |= negate ? ~set.bits[c] : set.bits[c];
+    }
+    return 1;
+}
+
+static int HexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/*
+ * Decode a single-byte escape after the backslash (\t, \x41, \.). Returns
+ * the byte, or -1 if the escape is not a literal.
+ */
+static int ParseLiteralEscape(PatternParser* parser)
+{
+    char e = *parser->p++;
+    switch (e)
+    {
+    case 't': return '\t';
+    case 'n': return '\n';
+    case 'r': return '\r';
+    case 'f': return '\f';
+    case 'v': return '\v';
+    case '0': return '\0';
+    case 'x':
+        if (parser->end - parser->p >= 2 && HexValue(parser->p[0]) >= 0 && HexValue(parser->p[1]) >= 0)
+        {
+            int value = HexValue(parser->p[0]) * 16 + HexValue(parser->p[1]);
+            parser->p += 2;
+            return value;
+        }
+        return -1;
+    default:
+        /* Escaped punctuation stands for itself; unknown letters are errors, not guesses */
+        if ((e >= 'a' && e <= 'z') || (e >= 'A' && e <= 'Z') || (e >= '0' && e <= '9'))
+        {
+            return -1;
+        }
+        return (unsigned char)e;
+    }
+}
+
+static int ParseClass(PatternParser* parser)
+{
+    int index = NewClass(parser);
+    ClassBits* bits;
+    int negate = 0;
+    int first = 1;
+    unsigned c;
+
+    if (index < 0)
+    {
+        return -1;
+    }
+    bits = &parser->classes[index];
+    if (parser->p < parser->end && *parser->p == '^')
+    {
+        negate = 1;
+        parser->p++;
+    }
+    for (;;)
+    {
+        int low;
+        int high;
+
+        if (parser->p >= parser->end)
+        {
+            parser->error = "Missing ']'";
+            return -1;
+        }
+        if (*parser->p == ']' && !first)
+        {
+            parser->p++;
+            break;
+        }
+        first = 0;
+
+        if (*parser->p == '\\' && parser->p + 1 < parser->end)
+        {
+            parser->p++;
+            if (AddClassEscape(bits, *parser->p))
+            {
+                parser->p++;
+                continue;
+            }
+            if ((low = ParseLiteralEscape(parser)) < 0)
+            {
+                parser->error = "Unsupported escape in class";
+                return -1;
+            }
+        }
+        else
+        {
+            low = (unsigned char)*parser->p++;
+        }
+
+        high = low;
+        if (parser->end - parser->p >= 2 && parser->p[0] == '-' && parser->p[1] != ']')
+        {
+            parser->p++;
+            if (*parser->p == '\\' && parser->p + 1 < parser->end)
+            {
+                parser->p++;
+                high = ParseLiteralEscape(parser);
+            }
+            else
+            {
+                high = (unsigned char)*parser->p++;
+            }
+            if (high < low)
+            {
+                parser->error = "Invalid class range";
+                return -1;
+            }
+        }
+        for (c = (unsigned)low; c <= (unsigned)high; c++)
+        {
+            SetBit(bits, c);
+        }
+    }
+
+    if (parser->ignore_case)
+    {
+        for (c = 'a'; c <= 'z'; c++)
+        {
+            if (TestBit(bits, c) || TestBit(bits, c - 32))
+            {
+                SetBit(bits, c);
+                SetBit(bits, c - 32);
+            }
+        }
+    }
+    if (negate)
+    {
+        for (c = 0; c < 8; c++)
+        {
+            bits->bits[c] = ~bits->bits[c];
+        }
+    }
+
+    {
+        int node = NewNode(parser, NODE_CLASS);
+        if (node >= 0)
+        {
+            parser->nodes[node].class_index = index;
+        }
+        return node;
+    }
+}
+
+static int ParseAlternation(PatternParser* parser, int depth);
+
+static int ParseAtom(PatternParser* parser, int depth)
+{
+    int node;
+    char c = *parser->p;
+
+    switch (c)
+    {
+    case '(':
+        parser->p++;
+        if (parser->p < parser->end && *parser->p == '?')
+        {
+            if (parser->end - parser->p < 2 || parser->p[1] != ':')
+            {
+                parser->error = "Unsupported group type";
+                return -1;
+            }
+            parser->p += 2;
+        }
+        node = ParseAlternation(parser, depth + 1);
+        if (node < 0)
+        {
+            return -1;
+        }
+        if (parser->p >= parser->end || *parser->p != ')')
+        {
+            parser->error = "Missing ')'";
+            return -1;
+        }
+        parser->p++;
+        return node;
+    case '[':
+        parser->p++;
+        return ParseClass(parser);
+    case '.':
+        parser->p++;
+        return NewNode(parser, NODE_ANY);
+    case '^':
+        parser->p++;
+        return NewNode(parser, NODE_LINE_START);
+    case '$':
+        parser->p++;
+        return NewNode(parser, NODE_LINE_END);
+    case '*': case '+': case '?': case '{':
+        parser->error = "Nothing to repeat";
+        return -1;
+    case '\\':
+        if (parser->p + 1 >= parser->end)
+        {
+            parser->error = "Trailing backslash";
+            return -1;
+        }
+        parser->p++;
+        if (*parser->p == 'b' || *parser->p == 'B')
+        {
+            return NewNode(parser, *parser->p++ == 'b' ? NODE_WORD_BOUNDARY : NODE_NOT_WORD_BOUNDARY);
+        }
+        {
+            int value;
+            int index = NewClass(parser);
+            if (index < 0)
+            {
+                return -1;
+            }
+            if (AddClassEscape(&parser->classes[index], *parser->p))
+            {
+                parser->p++;
+                node = NewNode(parser, NODE_CLASS);
+                if (node >= 0)
+                {
+                    parser->nodes[node].class_index = index;
+                }
+                return node;
+            }
+            parser->class_count--;
+            if ((value = ParseLiteralEscape(parser)) < 0)
+            {
+                parser->error = "Unsupported escape";
+                return -1;
+            }
+            node = NewNode(parser, NODE_CHAR);
+            if (node >= 0)
+            {
+                parser->nodes[node].c = (unsigned char)value;
+            }
+            return node;
+        }
+    default:
+        parser->p++;
+        node = NewNode(parser, NODE_CHAR);
+        if (node >= 0)
+        {
+            parser->nodes[node].c = (unsigned char)c;
+        }
+        return node;
+    }
+}
+
+/*
+ * Parse "{n}", "{n,}" or "{n,m}". Returns 0 (without consuming anything) if
+ * the brace does not start a valid quantifier.
+ */
+static int ParseBraces(PatternParser* parser, int* min, int* max)
+{
+    const char* p = parser->p + 1;
+    long low = 0;
+    long high;
+
+    if (p >= parser->end || *p < '0' || *p > '9')
+    {
+        return 0;
+    }
+    while (p < parser->end && *p >= '0' && *p <= '9' && low <= PATTERN_MAX_REPEAT)
+    {
+        low = low * 10 + (*p++ - '0');
+    }
+    high = low;
+    if (p < parser->end && *p == ',')
+    {
+        p++;
+        high = -1;
+        if (p < parser->end && *p >= '0' && *p <= '9')
+        {
+            high = 0;
+            while (p < parser->end && *p >= '0' && *p <= '9' && high <= PATTERN_MAX_REPEAT)
+            {
+                high = high * 10 + (*p++ - '0');
+            }
+        }
+    }
+    if (p >= parser->end || *p != '}')
+    {
+        return 0;
+    }
+    if (low > PATTERN_MAX_REPEAT || high > PATTERN_MAX_REPEAT || (high >= 0 && high < low))
+    {
+        parser->error = "Invalid repeat count";
+        return -1;
+    }
+    parser->p = p + 1;
+    *min = (int)low;
+    *max = (int)high;
+    return 1;
+}
+
+static int ParseRepeat(PatternParser* parser, int depth)
+{
+    int atom = ParseAtom(parser, depth);
+
+    while (atom >= 0 && parser->p < parser->end)
+    {
+        int min;
+        int max;
+        int node;
+        char c = *parser->p;
+
+        if (c == '*' || c == '+' || c == '?')
+        {
+            parser->p++;
+            min = c == '+' ? 1 : 0;
+            max = c == '?' ? 1 : -1;
+        }
+        else if (c == '{')
+        {
+            int braces = ParseBraces(parser, &min, &max);
+            if (braces < 0)
+            {
+                return -1;
+            }
+            if (braces == 0)
+            {
+                break;  /* A literal '{' follows */
+            }
+        }
+        else
+        {
+            break;
+        }
+        if (parser->p < parser->end && (*parser->p == '?' || *parser->p == '+'))
+        {
+            parser->p++;  /* Lazy or possessive: same match position */
+        }
+
+        node = NewNode(parser, NODE_REPEAT);
+        if (node < 0)
+        {
+            return -1;
+        }
+        parser->nodes[node].min = min;
+        parser->nodes[node].max = max;
+        parser->nodes[node].child = atom;
+        atom = node;
+    }
+    return atom;
+}
+
+static int ParseConcatenation(PatternParser* parser, int depth)
+{
+    int node = NewNode(parser, NODE_CONCAT);
+    int last = -1;
+
+    while (node >= 0 && parser->p < parser->end && *parser->p != '|' && *parser->p != ')')
+    {
+        int item = ParseRepeat(parser, depth);
+        if (item < 0)
+        {
+            return -1;
+        }
+        if (last < 0)
+        {
+            parser->nodes[node].child = item;
+        }
+        else
+        {
+            parser->nodes[last].next = item;
+        }
+        last = item;
+    }
+    return node;
+}
+
+static int ParseAlternation(PatternParser* parser, int depth)
+{
+    int node;
+    int first;
+    int last;
+
+    if (depth > PATTERN_MAX_DEPTH)
+    {
+        parser->error = "Pattern nested too deeply";
+        return -1;
+    }
+    first = ParseConcatenation(parser, depth);
+    if (first < 0 || parser->p >= parser->end || *parser->p != '|')
+    {
+        return first;
+    }
+
+    node = NewNode(parser, NODE_ALTERNATE);
+    if (node < 0)
+    {
+        return -1;
+    }
+    parser->nodes[node].child = first;
+    last = first;
+    while (parser->p < parser->end && *parser->p == '|')
+    {
+        int branch;
+        parser->p++;
+        branch = ParseConcatenation(parser, depth);
+        if (branch < 0)
+        {
+            return -1;
+        }
+        parser->nodes[last].next = branch;
+        last = branch;
+    }
+    return node;
+}
+
+/*
+ * Required literals
+ */
+
+static void PlanTrue(PatternPlan* plan)
+{
+    plan->clause_count = 1;
+    plan->clauses[0].count = 0;
+}
+
+static void ClauseAdd(PatternClause* clause, const char* literal, int length)
+{
+    if (clause->count < PATTERN_MAX_LITERALS)
+    {
+        memcpy(clause->literals[clause->count], literal, (size_t)length);
+        clause->lengths[clause->count] = length;
+        clause->count++;
+    }
+}
+
+/*
+ * a AND b. A product too large to keep falls back to the side with fewer
+ * clauses, which is weaker but still a valid requirement.
+ */
+static void PlanAnd(PatternPlan* a, const PatternPlan* b)
+{
+    PatternPlan* product;
+    int i;
+    int j;
+    int k;
+
+    if (a->clause_count * b->clause_count > PATTERN_MAX_CLAUSES)
+    {
+        if (b->clause_count < a->clause_count)
+        {
+            *a = *b;
+        }
+        return;
+    }
+    product = (PatternPlan*)malloc(sizeof(PatternPlan));
+    if (product == NULL)
+    {
+        return;
+    }
+    product->clause_count = 0;
+    for (i = 0; i < a->clause_count; i++)
+    {
+        for (j = 0; j < b->clause_count; j++)
+        {
+            PatternClause* clause = &product->clauses[product->clause_count++];
+            *clause = a->clauses[i];
+            for (k = 0; k < b->clauses[j].count; k++)
+            {
+                ClauseAdd(clause, b->clauses[j].literals[k], b->clauses[j].lengths[k]);
+            }
+        }
+    }
+    *a = *product;
+    free(product);
+}
+
+/*
+ * a OR b. If either side requires nothing, neither does the union.
+ */
+static void PlanOr(PatternPlan* a, const PatternPlan* b)
+{
+    int i;
+
+    for (i = 0; i < a->clause_count; i++)
+    {
+        if (a->clauses[i].count == 0)
+        {
+            return;
+        }
+    }
+    for (i = 0; i < b->clause_count; i++)
+    {
+        if (b->clauses[i].count == 0 || a->clause_count == PATTERN_MAX_CLAUSES)
+        {
+            PlanTrue(a);
+            return;
+        }
+        a->clauses[a->clause_count++] = b->clauses[i];
+    }
+}
+
+static void AnalyzeNode(const PatternParser* parser, int index, PatternPlan* plan);
+
+static void FlushRun(PatternPlan* plan, const char* run, int length)
+{
+    if (length >= PATTERN_MIN_LITERAL)
+    {
+        int i;
+        for (i = 0; i < plan->clause_count; i++)
+        {
+            ClauseAdd(&plan->clauses[i], run, length);
+        }
+    }
+}
+
+static void AnalyzeNode(const PatternParser* parser, int index, PatternPlan* plan)
+{
+    const Node* node = &parser->nodes[index];
+    PatternPlan* child;
+    int item;
+
+    PlanTrue(plan);
+    switch (node->type)
+    {
+    case NODE_CONCAT:
+    {
+        char run[PATTERN_MAX_LITERAL];
+        int run_length = 0;
+
+        child = (PatternPlan*)malloc(sizeof(PatternPlan));
+        if (child == NULL)
+        {
+            return;
+        }
+        for (item = node->child; item >= 0; item = parser->nodes[item].next)
+        {
+            const Node* part = &parser->nodes[item];
+            if (part->type == NODE_CHAR)
+            {
+                if (run_length == PATTERN_MAX_LITERAL)
+                {
+                    FlushRun(plan, run, run_length);
+                    run_length = 0;
+                }
+                run[run_length++] = (char)(parser->ignore_case ? FoldByte(part->c) : part->c);
+                continue;
+            }
+            if (part->type == NODE_LINE_START || part->type == NODE_LINE_END ||
+                part->type == NODE_WORD_BOUNDARY || part->type == NODE_NOT_WORD_BOUNDARY)
+            {
+                continue;  /* Zero-width: the run continues */
+            }
+            FlushRun(plan, run, run_length);
+            run_length = 0;
+            AnalyzeNode(parser, item, child);
+            PlanAnd(plan, child);
+        }
+        FlushRun(plan, run, run_length);
+        free(child);
+        break;
+    }
+    case NODE_ALTERNATE:
+        child = (PatternPlan*)malloc(sizeof(PatternPlan));
+        if (child == NULL)
+        {
+            return;
+        }
+        plan->clause_count = 0;
+        for (item = node->child; item >= 0; item = parser->nodes[item].next)
+        {
+            AnalyzeNode(parser, item, child);
+            if (plan->clause_count == 0)
+            {
+                *plan = *child;
+            }
+            else
+            {
+                PlanOr(plan, child);
+            }
+        }
+        if (plan->clause_count == 0)
+        {
+            PlanTrue(plan);
+        }
+        free(child);
+        break;
+    case NODE_REPEAT:
+        if (node->min > 0)
+        {
+            AnalyzeNode(parser, node->child, plan);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+ * Code generation
+ */
+
+static int Emit(PatternParser* parser, OpCode op)
+{
+    Instruction* instruction;
+    if (parser->length == PATTERN_MAX_PROGRAM)
+    {
+        parser->error = "Pattern too complex";
+        return -1;
+    }
+    instruction = &parser->program[parser->length];
+    memset(instruction, 0, sizeof(*instruction));
+    instruction->op = (unsigned char)op;
+    return parser->length++;
+}
+
+static int Generate(PatternParser* parser, int index)
+{
+    const Node* node = &parser->nodes[index];
+    int pc;
+    int item;
+    int i;
+
+    switch (node->type)
+    {
+    case NODE_EMPTY:
+        return 0;
+    case NODE_CHAR:
+    {
+        int folded = parser->ignore_case && (node->c | 0x20) >= 'a' && (node->c | 0x20) <= 'z';
+        pc = Emit(parser, folded ? OP_CHAR_FOLDED : OP_CHAR);
+        if (pc >= 0)
+        {
+            parser->program[pc].c = folded ? FoldByte(node->c) : node->c;
+        }
+        return pc < 0 ? -1 : 0;
+    }
+    case NODE_ANY:
+        return Emit(parser, OP_ANY) < 0 ? -1 : 0;
+    case NODE_CLASS:
+        pc = Emit(parser, OP_CLASS);
+        if (pc >= 0) parser->program[pc].class_index = (unsigned short)node->class_index;
+        return pc < 0 ? -1 : 0;
+    case NODE_LINE_START:
+        return Emit(parser, OP_LINE_START) < 0 ? -1 : 0;
+    case NODE_LINE_END:
+        return Emit(parser, OP_LINE_END) < 0 ? -1 : 0;
+    case NODE_WORD_BOUNDARY:
+        return Emit(parser, OP_WORD_BOUNDARY) < 0 ? -1 : 0;
+    case NODE_NOT_WORD_BOUNDARY:
+        return Emit(parser, OP_NOT_WORD_BOUNDARY) < 0 ? -1 : 0;
+    case NODE_CONCAT:
+        for (item = node->child; item >= 0; item = parser->nodes[item].next)
+        {
+            if (Generate(parser, item) < 0)
+            {
+                return -1;
+            }
+        }
+        return 0;
+    case NODE_ALTERNATE:
+    {
+        /* SPLIT to each branch in turn; every branch but the last jumps past the rest.
+         * The pending jumps are chained through their x until the end is known */
+        int jumps = -1;
+
+        for (item = node->child; item >= 0; item = parser->nodes[item].next)
+        {
+            int split = -1;
+            if (parser->nodes[item].next >= 0)
+            {
+                if ((split = Emit(parser, OP_SPLIT)) < 0)
+                {
+                    return -1;
+                }
+                parser->program[split].x = split + 1;
+            }
+            if (Generate(parser, item) < 0)
+            {
+                return -1;
+            }
+            if (split >= 0)
+            {
+                if ((pc = Emit(parser, OP_JUMP)) < 0)
+                {
+                    return -1;
+                }
+                parser->program[pc].x = jumps;
+                jumps = pc;
+                parser->program[split].y = parser->length;
+            }
+        }
+        while (jumps >= 0)
+        {
+            int previous = parser->program[jumps].x;
+            parser->program[jumps].x = parser->length;
+            jumps = previous;
+        }
+        return 0;
+    }
+    case NODE_REPEAT:
+        for (i = 0; i < node->min; i++)
+        {
+            if (Generate(parser, node->child) < 0)
+            {
+                return -1;
+            }
+        }
+        if (node->max < 0)
+        {
+            /* loop: SPLIT body, out; body; JUMP loop */
+            int loop = Emit(parser, OP_SPLIT);
+            if (loop < 0 || Generate(parser, node->child) < 0 || (pc = Emit(parser, OP_JUMP)) < 0)
+            {
+                return -1;
+            }
+            parser->program[loop].x = loop + 1;
+            parser->program[pc].x = loop;
+            parser->program[loop].y = parser->length;
+            return 0;
+        }
+        {
+            /* Each optional copy: SPLIT copy, out; the splits are chained through their y */
+            int splits = -1;
+            for (i = node->min; i < node->max; i++)
+            {
+                if ((pc = Emit(parser, OP_SPLIT)) < 0)
+                {
+                    return -1;
+                }
+                parser->program[pc].x = pc + 1;
+                parser->program[pc].y = splits;
+                splits = pc;
+                if (Generate(parser, node->child) < 0)
+                {
+                    return -1;
+                }
+            }
+            while (splits >= 0)
+            {
+                int previous = parser->program[splits].y;
+                parser->program[splits].y = parser->length;
+                splits = previous;
+            }
+        }
+        return 0;
+    }
+    return -1;
+}
+
+Pattern* PatternCompile(struct mg_str source, int ignore_case, const char** error)
+{
+    PatternParser* parser;
+    Pattern* pattern = NULL;
+    int root;
+
+    parser = (PatternParser*)calloc(1, sizeof(PatternParser));
+    if (parser == NULL)
+    {
+        *error = "Out of memory";
+        return NULL;
+    }
+    parser->p = source.buf;
+    parser->end = source.buf + source.len;
+    parser->ignore_case = ignore_case;
+    parser->program = (Instruction*)malloc(PATTERN_MAX_PROGRAM * sizeof(Instruction));
+
+    root = parser->program != NULL ? ParseAlternation(parser, 0) : -1;
+    if (root >= 0 && parser->p < parser->end)
+    {
+        parser->error = "Unmatched ')'";
+        root = -1;
+    }
+    if (root >= 0 && (Generate(parser, root) < 0 || Emit(parser, OP_MATCH) < 0))
+    {
+        root = -1;
+    }
+    if (root >= 0)
+    {
+        pattern = (Pattern*)calloc(1, sizeof(Pattern));
+        if (pattern != NULL)
+        {
+            int i;
+            pattern->program = (Instruction*)malloc((size_t)parser->length * sizeof(Instruction));
+            pattern->classes = (ClassBits*)malloc((size_t)(parser->class_count + 1) * sizeof(ClassBits));
+            if (pattern->program == NULL || pattern->classes == NULL)
+            {
+                PatternFree(pattern);
+                pattern = NULL;
+            }
+            else
+            {
+                memcpy(pattern->program, parser->program, (size_t)parser->length * sizeof(Instruction));
+                memcpy(pattern->classes, parser->classes, (size_t)parser->class_count * sizeof(ClassBits));
+                pattern->length = parser->length;
+                pattern->class_count = parser->class_count;
+                pattern->anchored = parser->program[0].op == OP_LINE_START;
+                AnalyzeNode(parser, root, &pattern->plan);
+                for (i = 0; i < pattern->plan.clause_count; i++)
+                {
+                    if (pattern->plan.clauses[i].count == 0)
+                    {
+                        pattern->plan.clause_count = 0;
+                        break;
+                    }
+                }
+            }
+        }
+        if (pattern == NULL)
+        {
+            parser->error = "Out of memory";
+        }
+    }
+    *error = parser->error != NULL ? parser->error : "Out of memory";
+    free(parser->program);
+    free(parser);
+    return pattern;
+}
+
+void PatternFree(Pattern* pattern)
+{
+    if (pattern != NULL)
+    {
+        free(pattern->program);
+        free(pattern->classes);
+        free(pattern);
+    }
+}
+
+const PatternPlan* PatternLiterals(const Pattern* pattern)
+{
+    return &pattern->plan;
+}
+
+PatternScratch* PatternScratchCreate(const Pattern* pattern)
+{
+    size_t length = (size_t)pattern->length;
+    PatternScratch* scratch = (PatternScratch*)calloc(1, sizeof(PatternScratch));
+    if (scratch == NULL)
+    {
+        return NULL;
+    }
+    scratch->current = (PatternThread*)malloc(length * sizeof(PatternThread));
+    scratch->next = (PatternThread*)malloc(length * sizeof(PatternThread));
+    scratch->stack = (int*)malloc((length * 2 + 1) * sizeof(int));
+    scratch->marks = (uint32_t*)calloc(length, sizeof(uint32_t));
+    if (scratch->current == NULL || scratch->next == NULL || scratch->stack == NULL || scratch->marks == NULL)
+    {
+        PatternScratchFree(scratch);
+        return NULL;
+    }
+    return scratch;
+}
+
+void PatternScratchFree(PatternScratch* scratch)
+{
+    if (scratch != NULL)
+    {
+        free(scratch->current);
+        free(scratch->next);
+        free(scratch->stack);
+        free(scratch->marks);
+        free(scratch);
+    }
+}
+
+/*
+ * Add the thread at pc to a list, following jumps, splits and zero-width
+ * assertions at `position` first. Each pc enters a list once per position
+ * (the marks), which keeps the lists bounded and the splits in priority
+ * order.
+ */
+static int AddThread(const Pattern* pattern, PatternScratch* scratch, PatternThread* list, int count, int pc,
+    size_t start, const char* line, size_t length, size_t position)
+{
+    int* stack = scratch->stack;
+    int top = 0;
+
+    stack[top++] = pc;
+    while (top > 0)
+    {
+        const Instruction* instruction;
+        int before;
+        int after;
+
+        pc = stack[--top];
+        if (scratch->marks[pc] == scratch->generation)
+        {
+            continue;
+        }
+        scratch->marks[pc] = scratch->generation;
+        instruction = &pattern->program[pc];
+        switch (instruction->op)
+        {
+        case OP_JUMP:
+            stack[top++] = instruction->x;
+            break;
+        case OP_SPLIT:
+            stack[top++] = instruction->y;
+            stack[top++] = instruction->x;
+            break;
+        case OP_LINE_START:
+            if (position == 0) stack[top++] = pc + 1;
+            break;
+        case OP_LINE_END:
+            if (position == length) stack[top++] = pc + 1;
+            break;
+        case OP_WORD_BOUNDARY:
+        case OP_NOT_WORD_BOUNDARY:
+            before = position > 0 && IsWordByte((unsigned char)line[position - 1]);
+            after = position < length && IsWordByte((unsigned char)line[position]);
+            if ((before != after) == (instruction->op == OP_WORD_BOUNDARY)) stack[top++] = pc + 1;
+            break;
+        default:
+            list[count].pc = pc;
+            list[count].start = start;
+            count++;
+            break;
+        }
+    }
+    return count;
+}
+
+int PatternMatch(const Pattern* pattern, PatternScratch* scratch, const char* line, size_t length,
+    size_t* start)
+{
+    int current_count = 0;
+    int matched = 0;
+    size_t position;
+
+    if (++scratch->generation == 0)
+    {
+        memset(scratch->marks, 0, (size_t)pattern->length * sizeof(uint32_t));
+        scratch->generation = 1;
+    }
+    current_count = AddThread(pattern, scratch, scratch->current, 0, 0, 0, line, length, 0);
+
+    /* Until every thread has died and no new match may start */
+    for (position = 0; current_count > 0 || (!matched && !pattern->anchored); position++)
+    {
+        PatternThread* swap;
+        unsigned char c = position < length ? (unsigned char)line[position] : 0;
+        int next_count = 0;
+        int i;
+
+        if (++scratch->generation == 0)
+        {
+            memset(scratch->marks, 0, (size_t)pattern->length * sizeof(uint32_t));
+            scratch->generation = 1;
+        }
+        for (i = 0; i < current_count; i++)
+        {
+            const PatternThread* thread = &scratch->current[i];
+            const Instruction* instruction = &pattern->program[thread->pc];
+            int advance = 0;
+
+            if (position < length)
+            {
+                switch (instruction->op)
+                {
+                case OP_CHAR: advance = c == instruction->c; break;
+                case OP_CHAR_FOLDED: advance = FoldByte(c) == instruction->c; break;
+                case OP_ANY: advance = c != '\n'; break;
+                case OP_CLASS: advance = TestBit(&pattern->classes[instruction->class_index], c); break;
+                default: break;
+                }
+            }
+            if (instruction->op == OP_MATCH)
+            {
+                /* Threads after this one have lower priority (later starts): drop them */
+                matched = 1;
+                *start = thread->start;
+                break;
+            }
+            if (advance)
+            {
+                next_count = AddThread(pattern, scratch, scratch->next, next_count, thread->pc + 1,
+                    thread->start, line, length, position + 1);
+            }
+        }
+        if (position >= length)
+        {
+            break;
+        }
+        if (!matched && !pattern->anchored)
+        {
+            next_count = AddThread(pattern, scratch, scratch->next, next_count, 0, position + 1, line, length,
+                position + 1);
+        }
+        swap = scratch->current;
+        scratch->current = scratch->next;
+        scratch->next = swap;
+        current_count = next_count;
+    }
+    return matched;
+}
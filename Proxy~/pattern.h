@@ -0,0 +1,82 @@
+/*
+ * UnixxtyMCP Proxy - Line patterns
+ *
+ * A small regular expression engine for the native search services. The
+ * pattern is parsed into a syntax tree, compiled into instructions for a
+ * Pike VM (every thread advances in lockstep, so matching is linear in the
+ * line length and cannot backtrack catastrophically) and matched one line
+ * at a time; '^' and '$' match at the line's ends.
+ *
+ * Supported: literals, '.', classes ("[a-z_]", "[^0-9]"), \d \w \s and
+ * their negations, \b \B, \t \n \r \xHH, groups "( )" and "(?: )",
+ * alternation, and the quantifiers * + ? {n} {n,} {n,m} (a trailing '?'
+ * for laziness is accepted; only the match position is reported).
+ *
+ * PatternLiterals() describes literal text every match must contain, as
+ * alternatives of required literals, so an index can narrow the files to
+ * verify before any line is matched.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_PATTERN_H
+#define UNITY_MCP_PATTERN_H
+
+#include "mongoose.h"
+
+#define PATTERN_MAX_PROGRAM 4096        /* Instructions */
+#define PATTERN_MAX_REPEAT 1000
+#define PATTERN_MAX_LITERAL 64
+#define PATTERN_MIN_LITERAL 3           /* Shorter literals do not narrow a trigram search */
+#define PATTERN_MAX_CLAUSES 8
+#define PATTERN_MAX_LITERALS 8
+
+typedef struct Pattern Pattern;
+typedef struct PatternScratch PatternScratch;
+
+/*
+ * Literals a match must contain: every literal of at least one clause.
+ * Literals are lowercase for a case-insensitive pattern. No clauses means
+ * nothing is known and every line has to be matched.
+ */
+typedef struct PatternClause
+{
+    int count;
+    int lengths[PATTERN_MAX_LITERALS];
+    char literals[PATTERN_MAX_LITERALS][PATTERN_MAX_LITERAL];
+} PatternClause;
+
+typedef struct PatternPlan
+{
+    int clause_count;
+    PatternClause clauses[PATTERN_MAX_CLAUSES];
+} PatternPlan;
+
+/*
+ * Compile a pattern. Returns NULL and points `error` at a static message if
+ * it is invalid or too complex.
+ */
+Pattern* PatternCompile(struct mg_str source, int ignore_case, const char** error);
+
+void PatternFree(Pattern* pattern);
+
+/*
+ * Required literals of a compiled pattern.
+ */
+const PatternPlan* PatternLiterals(const Pattern* pattern);
+
+/*
+ * Matching state for one thread. A scratch may be reused for any number of
+ * lines of the pattern it was created for, but not concurrently.
+ */
+PatternScratch* PatternScratchCreate(const Pattern* pattern);
+void PatternScratchFree(PatternScratch* scratch);
+
+/*
+ * Match a line (without its newline). Returns 1 and sets `start` to the
+ * byte offset of the leftmost match, or returns 0.
+ */
+int PatternMatch(const Pattern* pattern, PatternScratch* scratch, const char* line, size_t length,
+    size_t* start);
+
+#endif /* UNITY_MCP_PATTERN_H */
@@ -0,0 +1,75 @@
+/*
+ * UnixxtyMCP Proxy - Platform helpers
+ *
+ * Thin wrappers over the Win32 / POSIX primitives shared by the proxy modules:
+ * threads, statically-initialized mutexes and condition variables, sleeping,
+ * the process id and the processor count.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_PLATFORM_H
+#define UNITY_MCP_PLATFORM_H
+
+#ifdef _WIN32
+    #include <windows.h>
+    typedef HANDLE ThreadHandle;
+    typedef SRWLOCK ProxyMutex;
+    #define PROXY_MUTEX_INITIALIZER SRWLOCK_INIT
+    #define PROXY_MUTEX_LOCK(m) AcquireSRWLockExclusive(m)
+    #define PROXY_MUTEX_UNLOCK(m) ReleaseSRWLockExclusive(m)
+    typedef CONDITION_VARIABLE ProxyCondition;
+    #define PROXY_CONDITION_INITIALIZER CONDITION_VARIABLE_INIT
+    #define PROXY_CONDITION_WAIT(c, m) SleepConditionVariableSRW(c, m, INFINITE, 0)
+    #define PROXY_CONDITION_WAIT_MS(c, m, ms) SleepConditionVariableSRW(c, m, (DWORD)(ms), 0)
+    #define PROXY_CONDITION_SIGNAL(c) WakeConditionVariable(c)
+    #define PROXY_CONDITION_BROADCAST(c) WakeAllConditionVariable(c)
+    #define PROXY_SLEEP_MS(ms) Sleep((DWORD)(ms))
+    #define GET_PROCESS_ID() ((unsigned long)GetCurrentProcessId())
+
+    static __inline int GetProcessorCount(void)
+    {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return (int)info.dwNumberOfProcessors;
+    }
+#else
+    #include <pthread.h>
+    #include <time.h>
+    #include <unistd.h>
+    typedef pthread_t ThreadHandle;
+    typedef pthread_mutex_t ProxyMutex;
+    #define PROXY_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+    #define PROXY_MUTEX_LOCK(m) pthread_mutex_lock(m)
+    #define PROXY_MUTEX_UNLOCK(m) pthread_mutex_unlock(m)
+    typedef pthread_cond_t ProxyCondition;
+    #define PROXY_CONDITION_INITIALIZER PTHREAD_COND_INITIALIZER
+    #define PROXY_CONDITION_WAIT(c, m) pthread_cond_wait(c, m)
+    #define PROXY_CONDITION_WAIT_MS(c, m, ms) ProxyConditionWaitMs(c, m, ms)
+    #define PROXY_CONDITION_SIGNAL(c) pthread_cond_signal(c)
+    #define PROXY_CONDITION_BROADCAST(c) pthread_cond_broadcast(c)
+    #define PROXY_SLEEP_MS(ms) usleep((ms) * 1000)
+    #define GET_PROCESS_ID() ((unsigned long)getpid())
+
+    static inline int ProxyConditionWaitMs(ProxyCondition* condition, ProxyMutex* mutex, int ms)
+    {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += ms / 1000;
+        deadline.tv_nsec += (long)(ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        return pthread_cond_timedwait(condition, mutex, &deadline);
+    }
+
+    static inline int GetProcessorCount(void)
+    {
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        return count > 0 ? (int)count : 1;
+    }
+#endif
+
+#endif /* UNITY_MCP_PLATFORM_H */
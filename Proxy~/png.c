@@ -0,0 +1,895 @@
+/*
+ * UnixxtyMCP Proxy - Asynchronous PNG encoder
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "png.h"
+#include "base64.h"
+#include "deflate.h"
+#include "image.h"
+#include "jpeg.h"
+#include "workers.h"
+#include "mongoose.h"
+#include "platform.h"
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define PNG_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+typedef struct PngJob PngJob;
+
+typedef struct PngStripe
+{
+    PngJob* job;
+    int first_row;
+    int row_count;
+    DeflateOutput output;
+    uint32_t adler;
+    size_t raw_length;
+} PngStripe;
+
+struct PngJob
+{
+    int handle;
+    int status;
+    int owned;                  /* The caller has not released its handle */
+    int attached;               /* Base64 payloads that refer to the result */
+    uint64_t finished_at;
+    int width;
+    int height;
+    int channels;               /* 4 until the rows turn out to be opaque or are made gray */
+    int level;                  /* Deflate level, or JPEG quality */
+    int target_width;
+    int target_height;
+    int flags;                  /* ENCODE_* */
+    unsigned char* pixels;      /* Packed rows, top first */
+    PngStripe* stripes;
+    int stripe_count;
+    int stripes_left;
+    int failed;
+    unsigned char* result;
+    size_t result_size;
+};
+
+static ProxyMutex s_png_lock = PROXY_MUTEX_INITIALIZER;
+static ProxyCondition s_png_done = PROXY_CONDITION_INITIALIZER;
+static PngJob* s_png_jobs[PNG_MAX_JOBS];
+static int s_png_next_handle = 1;
+
+/*
+ * Row filters. Each writes the filtered row and returns its cost: the sum
+ * of the bytes taken as signed magnitudes.
+ */
+
+static size_t ByteCost(unsigned char value)
+{
+    return value < 128 ? value : 256u - value;
+}
+
+#ifdef PNG_SSE2
+static __m128i CostLanes(__m128i filtered)
+{
+    __m128i zero = _mm_setzero_si128();
+    return _mm_sad_epu8(_mm_min_epu8(filtered, _mm_sub_epi8(zero, filtered)), zero);
+}
+
+static size_t SumLanes(__m128i sums)
+{
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, sums);
+    return (size_t)(lanes[0] + lanes[1]);
+}
+
+static __m128i Abs16(__m128i value)
+{
+    return _mm_max_epi16(value, _mm_sub_epi16(_mm_setzero_si128(), value));
+}
+
+static __m128i Select(__m128i mask, __m128i if_set, __m128i if_clear)
+{
+    return _mm_or_si128(_mm_and_si128(mask, if_set), _mm_andnot_si128(mask, if_clear));
+}
+
+/*
+ * Paeth predictor for 8 pixels widened to 16 bits.
+ */
+static __m128i PaethLanes(__m128i a, __m128i b, __m128i c)
+{
+    __m128i pa = _mm_sub_epi16(b, c);
+    __m128i pb = _mm_sub_epi16(a, c);
+    __m128i pc = Abs16(_mm_add_epi16(pa, pb));
+    __m128i b_or_c;
+    pa = Abs16(pa);
+    pb = Abs16(pb);
+    b_or_c = Select(_mm_cmpgt_epi16(pb, pc), c, b);
+    return Select(_mm_cmpgt_epi16(pa, _mm_min_epi16(pb, pc)), b_or_c, a);
+}
+#endif
+
+static size_t FilterNone(const unsigned char* row, const unsigned char* prior, size_t length, int bpp, unsigned char* out)
+{
+    size_t i, cost = 0;
+    (void)prior;
+    (void)bpp;
+    memcpy(out, row, length);
+    for (i = 0; i < length; i++)
+    {
+        cost += ByteCost(row[i]);
+    }
+    return cost;
+}
+
+static size_t FilterSub(const unsigned char* row, const unsigned char* prior, size_t length, int bpp, unsigned char* out)
+{
+    size_t i = 0, cost = 0;
+    (void)prior;
+    for (; i < (size_t)bpp && i < length; i++)
+    {
+        out[i] = row[i];
+        cost += ByteCost(out[i]);
+    }
+#ifdef PNG_SSE2
+    {
+        __m128i sums = _mm_setzero_si128();
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i x = _mm_loadu_si128((const __m128i*)(row + i));
+            __m128i a = _mm_loadu_si128((const __m128i*)(row + i - bpp));
+            __m128i filtered = _mm_sub_epi8(x, a);
+            _mm_storeu_si128((__m128i*)(out + i), filtered);
+            sums = _mm_add_epi64(sums, CostLanes(filtered));
+        }
+        cost += SumLanes(sums);
+    }
+#endif
+    for (; i < length; i++)
+    {
+        out[i] = (unsigned char)(row[i] - row[i - bpp]);
+        cost += ByteCost(out[i]);
+    }
+    return cost;
+}
+
+static size_t FilterUp(const unsigned char* row, const unsigned char* prior, size_t length, int bpp, unsigned char* out)
+{
+    size_t i = 0, cost = 0;
+    (void)bpp;
+#ifdef PNG_SSE2
+    {
+        __m128i sums = _mm_setzero_si128();
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i x = _mm_loadu_si128((const __m128i*)(row + i));
+            __m128i b = _mm_loadu_si128((const __m128i*)(prior + i));
+            __m128i filtered = _mm_sub_epi8(x, b);
+            _mm_storeu_si128((__m128i*)(out + i), filtered);
+            sums = _mm_add_epi64(sums, CostLanes(filtered));
+        }
+        cost += SumLanes(sums);
+    }
+#endif
+    for (; i < length; i++)
+    {
+        out[i] = (unsigned char)(row[i] - prior[i]);
+        cost += ByteCost(out[i]);
+    }
+    return cost;
+}
+
+static size_t FilterAverage(const unsigned char* row, const unsigned char* prior, size_t length, int bpp, unsigned char* out)
+{
+    size_t i = 0, cost = 0;
+    for (; i < (size_t)bpp && i < length; i++)
+    {
+        out[i] = (unsigned char)(row[i] - (prior[i] >> 1));
+        cost += ByteCost(out[i]);
+    }
+#ifdef PNG_SSE2
+    {
+        __m128i sums = _mm_setzero_si128();
+        __m128i one = _mm_set1_epi8(1);
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i x = _mm_loadu_si128((const __m128i*)(row + i));
+            __m128i a = _mm_loadu_si128((const __m128i*)(row + i - bpp));
+            __m128i b = _mm_loadu_si128((const __m128i*)(prior + i));
+            /* avg_epu8 rounds up; PNG rounds down */
+            __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+            __m128i filtered = _mm_sub_epi8(x, average);
+            _mm_storeu_si128((__m128i*)(out + i), filtered);
+            sums = _mm_add_epi64(sums, CostLanes(filtered));
+        }
+        cost += SumLanes(sums);
+    }
+#endif
+    for (; i < length; i++)
+    {
+        out[i] = (unsigned char)(row[i] - ((row[i - bpp] + prior[i]) >> 1));
+        cost += ByteCost(out[i]);
+    }
+    return cost;
+}
+
+static unsigned char Paeth(int a, int b, int c)
+{
+    int pa = abs(b - c);
+    int pb = abs(a - c);
+    int pc = abs(a + b - 2 * c);
+    if (pa <= pb && pa <= pc) return (unsigned char)a;
+    return (unsigned char)(pb <= pc ? b : c);
+}
+
+static size_t FilterPaeth(const unsigned char* row, const unsigned char* prior, size_t length, int bpp, unsigned char* out)
+{
+    size_t i = 0, cost = 0;
+    for (; i < (size_t)bpp && i < length; i++)
+    {
+        out[i] = (unsigned char)(row[i] - prior[i]);
+        cost += ByteCost(out[i]);
+    }
+#ifdef PNG_SSE2
+    {
+        __m128i sums = _mm_setzero_si128();
+        __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i x = _mm_loadu_si128((const __m128i*)(row + i));
+            __m128i a = _mm_loadu_si128((const __m128i*)(row + i - bpp));
+            __m128i b = _mm_loadu_si128((const __m128i*)(prior + i));
+            __m128i c = _mm_loadu_si128((const __m128i*)(prior + i - bpp));
+            __m128i low = PaethLanes(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(c, zero));
+            __m128i high = PaethLanes(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(c, zero));
+            __m128i filtered = _mm_sub_epi8(x, _mm_packus_epi16(low, high));
+            _mm_storeu_si128((__m128i*)(out + i), filtered);
+            sums = _mm_add_epi64(sums, CostLanes(filtered));
+        }
+        cost += SumLanes(sums);
+    }
+#endif
+    for (; i < length; i++)
+    {
+        out[i] = (unsigned char)(row[i] - Paeth(row[i - bpp], prior[i], prior[i - bpp]));
+        cost += ByteCost(out[i]);
+    }
+    return cost;
+}
+
+typedef size_t (*PngFilter)(const unsigned char*, const unsigned char*, size_t, int, unsigned char*);
+
+static const PngFilter FILTERS[5] = { FilterNone, FilterSub, FilterUp, FilterAverage, FilterPaeth };
+
+/*
+ * Filter one row into out (filter type byte first). The choice depends
+ * only on the row and the one above, so stripes that filter the same rows
+ * as dictionary agree byte for byte. scratch holds 2 * length bytes.
+ */
+static void FilterRow(const unsigned char* row, const unsigned char* prior, size_t length, int bpp,
+    int adaptive, unsigned char* scratch, unsigned char* out)
+{
+    unsigned char* best = scratch;
+    unsigned char* trial = scratch + length;
+    size_t best_cost, cost;
+    int best_type = 0, type;
+
+    if (!adaptive)
+    {
+        out[0] = 0;
+        memcpy(out + 1, row, length);
+        return;
+    }
+
+    best_cost = FILTERS[0](row, prior, length, bpp, best);
+    for (type = 1; type < 5; type++)
+    {
+        cost = FILTERS[type](row, prior, length, bpp, trial);
+        if (cost < best_cost)
+        {
+            unsigned char* swap = best;
+            best = trial;
+            trial = swap;
+            best_cost = cost;
+            best_type = type;
+        }
+    }
+    out[0] = (unsigned char)best_type;
+    memcpy(out + 1, best, length);
+}
+
+/*
+ * Jobs
+ */
+
+static void FreePngJob(PngJob* job)
+{
+    int i;
+    if (job->stripes != NULL)
+    {
+        for (i = 0; i < job->stripe_count; i++)
+        {
+            free(job->stripes[i].output.data);
+        }
+        free(job->stripes);
+    }
+    free(job->pixels);
+    free(job->result);
+    free(job);
+}
+
+/*
+ * Free finished jobs nobody refers to any more, and drop the handle of
+ * jobs finished long ago that were never released. Caller holds the lock.
+ */
+static void CollectPngJobs(void)
+{
+    uint64_t now = mg_millis();
+    int i;
+    for (i = 0; i < PNG_MAX_JOBS; i++)
+    {
+        PngJob* job = s_png_jobs[i];
+        if (job == NULL || job->status == PNG_JOB_RUNNING)
+        {
+            continue;
+        }
+        if (job->owned && job->attached == 0 && now - job->finished_at >= PNG_JOB_TTL_MS)
+        {
+            job->owned = 0;
+        }
+        if (!job->owned && job->attached == 0)
+        {
+            s_png_jobs[i] = NULL;
+            FreePngJob(job);
+        }
+    }
+}
+
+/*
+ * Find a job by handle. Caller holds the lock.
+ */
+static PngJob* FindPngJob(int handle)
+{
+    int i;
+    for (i = 0; i < PNG_MAX_JOBS; i++)
+    {
+        if (s_png_jobs[i] != NULL && s_png_jobs[i]->handle == handle && s_png_jobs[i]->owned)
+        {
+            return s_png_jobs[i];
+        }
+    }
+    return NULL;
+}
+
+static void FinishPngJob(PngJob* job, unsigned char* result, size_t size)
+{
+    PROXY_MUTEX_LOCK(&s_png_lock);
+    job->result = result;
+    job->result_size = size;
+    job->status = result != NULL ? PNG_JOB_DONE : PNG_JOB_FAILED;
+    job->finished_at = mg_millis();
+    free(job->pixels);
+    job->pixels = NULL;
+    PROXY_CONDITION_BROADCAST(&s_png_done);
+    CollectPngJobs();
+    PROXY_MUTEX_UNLOCK(&s_png_lock);
+}
+
+static void RunOrSubmit(WorkerTask task, void* context)
+{
+    if (!WorkerSubmit(task, context))
+    {
+        task(context);
+    }
+}
+
+static unsigned char* PutChunkHeader(unsigned char* out, size_t length, const char* type)
+{
+    out[0] = (unsigned char)(length >> 24);
+    out[1] = (unsigned char)(length >> 16);
+    out[2] = (unsigned char)(length >> 8);
+    out[3] = (unsigned char)length;
+    memcpy(out + 4, type, 4);
+    return out + 8;
+}
+
+/*
+ * Write the CRC of the chunk that starts at `chunk` and whose data ends at
+ * `end`.
+ */
+static unsigned char* PutChunkCrc(unsigned char* chunk, unsigned char* end)
+{
+    uint32_t crc = DeflateCrc32(0, chunk + 4, (size_t)(end - chunk - 4));
+    end[0] = (unsigned char)(crc >> 24);
+    end[1] = (unsigned char)(crc >> 16);
+    end[2] = (unsigned char)(crc >> 8);
+    end[3] = (unsigned char)crc;
+    return end + 4;
+}
+
+/*
+ * Build the file from the compressed stripes.
+ */
+static void AssemblePng(PngJob* job)
+{
+    static const unsigned char SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    size_t idat_length = 2 + 4;
+    size_t total;
+    uint32_t adler = 1;
+    unsigned char* result;
+    unsigned char* out;
+    unsigned char* chunk;
+    int i;
+
+    if (job->failed)
+    {
+        FinishPngJob(job, NULL, 0);
+        return;
+    }
+    for (i = 0; i < job->stripe_count; i++)
+    {
+        idat_length += job->stripes[i].output.length;
+        adler = DeflateAdler32Combine(adler, job->stripes[i].adler, job->stripes[i].raw_length);
+    }
+    if (idat_length > 0x7fffffffu)
+    {
+        FinishPngJob(job, NULL, 0);
+        return;
+    }
+    total = sizeof(SIGNATURE) + (12 + 13) + (12 + idat_length) + 12;
+    result = (unsigned char*)malloc(total);
+    if (result == NULL)
+    {
+        FinishPngJob(job, NULL, 0);
+        return;
+    }
+
+    out = result;
+    memcpy(out, SIGNATURE, sizeof(SIGNATURE));
+    out += sizeof(SIGNATURE);
+
+    chunk = out;
+    out = PutChunkHeader(out, 13, "IHDR");
+    out[0] = (unsigned char)(job->width >> 24);
+    out[1] = (unsigned char)(job->width >> 16);
+    out[2] = (unsigned char)(job->width >> 8);
+    out[3] = (unsigned char)job->width;
+    out[4] = (unsigned char)(job->height >> 24);
+    out[5] = (unsigned char)(job->height >> 16);
+    out[6] = (unsigned char)(job->height >> 8);
+    out[7] = (unsigned char)job->height;
+    out[8] = 8;                                  /* Bit depth */
+    out[9] = job->channels == 4 ? 6 : (job->channels == 3 ? 2 : 0);  /* RGBA, RGB or gray */
+    out[10] = 0;
+    out[11] = 0;
+    out[12] = 0;
+    out = PutChunkCrc(chunk, out + 13);
+
+    chunk = out;
+    out = PutChunkHeader(out, idat_length, "IDAT");
+    out[0] = 0x78;
+    out[1] = job->level <= 1 ? 0x01 : (job->level <= 5 ? 0x5e : (job->level == 6 ? 0x9c : 0xda));
+    out += 2;
+    for (i = 0; i < job->stripe_count; i++)
+    {
+        memcpy(out, job->stripes[i].output.data, job->stripes[i].output.length);
+        out += job->stripes[i].output.length;
+        free(job->stripes[i].output.data);
+        job->stripes[i].output.data = NULL;
+    }
+    out[0] = (unsigned char)(adler >> 24);
+    out[1] = (unsigned char)(adler >> 16);
+    out[2] = (unsigned char)(adler >> 8);
+    out[3] = (unsigned char)adler;
+    out = PutChunkCrc(chunk, out + 4);
+
+    chunk = out;
+    out = PutChunkHeader(out, 0, "IEND");
+    PutChunkCrc(chunk, out);
+
+    FinishPngJob(job, result, total);
+}
+
+/*
+ * Filter and compress one stripe, with the rows above it as dictionary.
+ */
+static void EncodeStripe(void* context)
+{
+    PngStripe* stripe = (PngStripe*)context;
+    PngJob* job = stripe->job;
+    size_t length = (size_t)job->width * (size_t)job->channels;
+    size_t row_bytes = length + 1;
+    int dictionary_rows = 0;
+    int rows, row, last;
+    unsigned char* filtered;
+    unsigned char* scratch;
+    unsigned char* zeros;
+    int ok = 0;
+
+    if (job->level > 0)
+    {
+        dictionary_rows = (int)((DEFLATE_WINDOW_SIZE + row_bytes - 1) / row_bytes);
+        if (dictionary_rows > stripe->first_row) dictionary_rows = stripe->first_row;
+    }
+    rows = dictionary_rows + stripe->row_count;
+
+    filtered = (unsigned char*)malloc((size_t)rows * row_bytes);
+    scratch = (unsigned char*)malloc(2 * length);
+    zeros = (unsigned char*)calloc(1, length);
+    if (filtered != NULL && scratch != NULL && zeros != NULL)
+    {
+        size_t dictionary_length = (size_t)dictionary_rows * row_bytes;
+        for (row = 0; row < rows; row++)
+        {
+            int y = stripe->first_row - dictionary_rows + row;
+            const unsigned char* pixels = job->pixels + (size_t)y * length;
+            FilterRow(pixels, y > 0 ? pixels - length : zeros, length, job->channels,
+                job->level > 0, scratch, filtered + (size_t)row * row_bytes);
+        }
+        stripe->raw_length = (size_t)stripe->row_count * row_bytes;
+        stripe->adler = DeflateAdler32(1, filtered + dictionary_length, stripe->raw_length);
+        ok = DeflateCompress(filtered, dictionary_length, dictionary_length + stripe->raw_length, job->level,
+            stripe->first_row + stripe->row_count == job->height, &stripe->output);
+    }
+    free(zeros);
+    free(scratch);
+    free(filtered);
+
+    PROXY_MUTEX_LOCK(&s_png_lock);
+    if (!ok)
+    {
+        job->failed = 1;
+    }
+    last = --job->stripes_left == 0;
+    PROXY_MUTEX_UNLOCK(&s_png_lock);
+
+    if (last)
+    {
+        AssemblePng(job);
+    }
+}
+
+/*
+ * First task of a job: resize and convert the pixels as asked, write a
+ * JPEG directly, or drop alpha if the image is opaque and fan out the PNG
+ * stripes.
+ */
+static void PreparePngJob(void* context)
+{
+    PngJob* job = (PngJob*)context;
+    size_t pixel_count, i, row_bytes;
+    int rows_per_stripe, stripe_count, s;
+    int opaque = 1;
+
+    if (job->target_width != job->width || job->target_height != job->height)
+    {
+        unsigned char* resized = ImageResize(job->pixels, job->width, job->height, job->target_width,
+            job->target_height, (job->flags & ENCODE_LANCZOS) ? IMAGE_FILTER_LANCZOS : IMAGE_FILTER_BOX);
+        if (resized == NULL)
+        {
+            FinishPngJob(job, NULL, 0);
+            return;
+        }
+        free(job->pixels);
+        job->pixels = resized;
+        job->width = job->target_width;
+        job->height = job->target_height;
+    }
+    pixel_count = (size_t)job->width * (size_t)job->height;
+
+    if (job->flags & ENCODE_GRAYSCALE)
+    {
+        ImageGrayscale(job->pixels, pixel_count);
+        job->channels = 1;
+    }
+
+    if (job->flags & ENCODE_JPEG)
+    {
+        size_t size = 0;
+        unsigned char* jpeg = JpegEncode(job->pixels, job->width, job->height, job->channels, job->level, &size);
+        FinishPngJob(job, jpeg, size);
+        return;
+    }
+
+    for (i = 0; i < pixel_count && opaque && job->channels == 4; i++)
+    {
+        opaque = job->pixels[i * 4 + 3] == 255;
+    }
+    if (opaque && job->channels == 4)
+    {
+        for (i = 0; i < pixel_count; i++)
+        {
+            job->pixels[i * 3 + 0] = job->pixels[i * 4 + 0];
+            job->pixels[i * 3 + 1] = job->pixels[i * 4 + 1];
+            job->pixels[i * 3 + 2] = job->pixels[i * 4 + 2];
+        }
+        job->channels = 3;
+    }
+
+    row_bytes = (size_t)job->width * (size_t)job->channels + 1;
+    rows_per_stripe = (int)(PNG_STRIPE_BYTES / row_bytes);
+    if (rows_per_stripe < 1) rows_per_stripe = 1;
+    stripe_count = (job->height + rows_per_stripe - 1) / rows_per_stripe;
+
+    job->stripes = (PngStripe*)calloc((size_t)stripe_count, sizeof(PngStripe));
+    if (job->stripes == NULL)
+    {
+        FinishPngJob(job, NULL, 0);
+        return;
+    }
+    job->stripe_count = stripe_count;
+    job->stripes_left = stripe_count;
+    for (s = 0; s < stripe_count; s++)
+    {
+        PngStripe* stripe = &job->stripes[s];
+        stripe->job = job;
+        stripe->first_row = s * rows_per_stripe;
+        stripe->row_count = job->height - stripe->first_row < rows_per_stripe
+            ? job->height - stripe->first_row : rows_per_stripe;
+    }
+    /* The job may be finished and freed as soon as the last stripe is queued */
+    for (s = 0; s < stripe_count; s++)
+    {
+        RunOrSubmit(EncodeStripe, &job->stripes[s]);
+    }
+}
+
+int SubmitImageJob(unsigned char* pixels, int width, int height,
+    int target_width, int target_height, int quality, int flags)
+{
+    PngJob* job;
+    int handle = 0, slot;
+
+    if (target_width <= 0) target_width = width;
+    if (target_height <= 0) target_height = height;
+    if ((uint64_t)target_width * (uint64_t)target_height > PNG_MAX_PIXELS ||
+        ((flags & ENCODE_JPEG) && (target_width > JPEG_MAX_DIMENSION || target_height > JPEG_MAX_DIMENSION)))
+    {
+        free(pixels);
+        return 0;
+    }
+    if (flags & ENCODE_JPEG)
+    {
+        if (quality <= 0) quality = 75;
+        if (quality > 100) quality = 100;
+    }
+    else
+    {
+        if (quality < 0) quality = 6;
+        if (quality > 9) quality = 9;
+    }
+
+    job = (PngJob*)calloc(1, sizeof(PngJob));
+    if (job == NULL)
+    {
+        free(pixels);
+        return 0;
+    }
+    job->pixels = pixels;
+    job->width = width;
+    job->height = height;
+    job->channels = 4;
+    job->level = quality;
+    job->target_width = target_width;
+    job->target_height = target_height;
+    job->flags = flags;
+    job->owned = 1;
+    job->status = PNG_JOB_RUNNING;
+
+    PROXY_MUTEX_LOCK(&s_png_lock);
+    CollectPngJobs();
+    for (slot = 0; slot < PNG_MAX_JOBS; slot++)
+    {
+        if (s_png_jobs[slot] == NULL)
+        {
+            handle = s_png_next_handle++;
+            if (s_png_next_handle <= 0)
+            {
+                s_png_next_handle = 1;
+            }
+            job->handle = handle;
+            s_png_jobs[slot] = job;
+            break;
+        }
+    }
+    PROXY_MUTEX_UNLOCK(&s_png_lock);
+
+    if (handle == 0)
+    {
+        FreePngJob(job);
+        return 0;
+    }
+    RunOrSubmit(PreparePngJob, job);
+    return handle;
+}
+
+EXPORT int EncodeImageAsync(const unsigned char* rgba, int width, int height, int stride,
+    int target_width, int target_height, int quality, int flags)
+{
+    size_t row_length, y;
+    size_t abs_stride = stride < 0 ? (size_t)(-(long)stride) : (size_t)stride;
+    unsigned char* pixels;
+
+    if (rgba == NULL || width <= 0 || height <= 0 ||
+        (uint64_t)width * (uint64_t)height > PNG_MAX_PIXELS)
+    {
+        return 0;
+    }
+    row_length = (size_t)width * 4;
+    if (stride == 0)
+    {
+        abs_stride = row_length;
+    }
+    if (abs_stride < row_length)
+    {
+        return 0;
+    }
+
+    pixels = (unsigned char*)malloc(row_length * (size_t)height);
+    if (pixels == NULL)
+    {
+        return 0;
+    }
+    /* The only work done on the caller's thread: a negative stride means bottom-up rows */
+    for (y = 0; y < (size_t)height; y++)
+    {
+        size_t source_row = stride < 0 ? (size_t)height - 1 - y : y;
+        memcpy(pixels + y * row_length, rgba + source_row * abs_stride, row_length);
+    }
+    return SubmitImageJob(pixels, width, height, target_width, target_height, quality, flags);
+}
+
+EXPORT int EncodePngAsync(const unsigned char* rgba, int width, int height, int stride, int level)
+{
+    return EncodeImageAsync(rgba, width, height, stride, width, height, level, 0);
+}
+
+EXPORT int GetPngJobStatus(int job)
+{
+    PngJob* found;
+    int status = PNG_JOB_FAILED;
+    PROXY_MUTEX_LOCK(&s_png_lock);
+    found = FindPngJob(job);
+    if (found != NULL)
+    {
+        status = found->status;
+    }
+    PROXY_MUTEX_UNLOCK(&s_png_lock);
+    return status;
+}
+
+EXPORT int WaitPngJob(int job, int timeout_ms)
+{
+    uint64_t deadline = mg_millis() + (uint64_t)(timeout_ms > 0 ? timeout_ms : 0);
+    PngJob* found;
+    int status = PNG_JOB_FAILED;
+
+    PROXY_MUTEX_LOCK(&s_png_lock);
+    for (;;)
+    {
+        uint64_t now;
+        found = FindPngJob(job);
+        if (found == NULL || found->status != PNG_JOB_RUNNING)
+        {
+            status = found != NULL ? found->status : PNG_JOB_FAILED;
+            break;
+        }
+        if (timeout_ms < 0)
+        {
+            PROXY_CONDITION_WAIT(&s_png_done, &s_png_lock);
+            continue;
+        }
+        now = mg_millis();
+        if (now >= deadline)
+        {
+            status = PNG_JOB_RUNNING;
+            break;
+        }
+        PROXY_CONDITION_WAIT_MS(&s_png_done, &s_png_lock, (int)(deadline - now));
+    }
+    PROXY_MUTEX_UNLOCK(&s_png_lock);
+    return status;
+}
+
+EXPORT int GetPngJobSize(int job)
+{
+    PngJob* found;
+    int size = -1;
+    PROXY_MUTEX_LOCK(&s_png_lock);
+    found = FindPngJob(job);
+    if (found != NULL && found->status == PNG_JOB_DONE && found->result_size <= 0x7fffffffu)
+    {
+        size = (int)found->result_size;
+    }
+    PROXY_MUTEX_UNLOCK(&s_png_lock);
+    return size;
+}
+
+EXPORT int CopyPngJobResult(int job, unsigned char* output, int capacity)
+{
+    PngJob* found;
+    int copied = -1;
+    PROXY_MUTEX_LOCK(&s_png_lock);
+    found = FindPngJob(job);
+    if (found != NULL && found->status == PNG_JOB_DONE && output != NULL &&
+        capacity >= 0 && found->result_size <= (size_t)capacity)
+    {
+        memcpy(output, found->result, found->result_size);
+        copied = (int)found->result_size;
+    }
+    PROXY_MUTEX_UNLOCK(&s_png_lock);
+    return copied;
+}
+
+EXPORT void ReleasePngJob(int job)
+{
+    PngJob* found;
+    PROXY_MUTEX_LOCK(&s_png_lock);
+    found = FindPngJob(job);
+    if (found != NULL)
+    {
+        found->owned = 0;
+        CollectPngJobs();
+    }
+    PROXY_MUTEX_UNLOCK(&s_png_lock);
+}
+
+/*
+ * Base64 payload source over a job's result
+ */
+
+static int PollPngPayload(void* context, const unsigned char** data, size_t* size)
+{
+    PngJob* job = (PngJob*)context;
+    int status;
+    PROXY_MUTEX_LOCK(&s_png_lock);
+    status = job->status;
+    if (status == PNG_JOB_DONE)
+    {
+        *data = job->result;
+        *size = job->result_size;
+    }
+    PROXY_MUTEX_UNLOCK(&s_png_lock);
+    return status;
+}
+
+static void ReleasePngPayload(void* context)
+{
+    PngJob* job = (PngJob*)context;
+    PROXY_MUTEX_LOCK(&s_png_lock);
+    job->attached--;
+    CollectPngJobs();
+    PROXY_MUTEX_UNLOCK(&s_png_lock);
+}
+
+static const Base64Source PNG_PAYLOAD_SOURCE = { PollPngPayload, ReleasePngPayload };
+
+EXPORT const char* AttachPngJobPayload(int job)
+{
+    PngJob* found;
+    const char* token = NULL;
+
+    PROXY_MUTEX_LOCK(&s_png_lock);
+    found = FindPngJob(job);
+    if (found != NULL && found->status != PNG_JOB_FAILED)
+    {
+        found->attached++;
+    }
+    else
+    {
+        found = NULL;
+    }
+    PROXY_MUTEX_UNLOCK(&s_png_lock);
+
+    if (found != NULL)
+    {
+        token = Base64AttachSource(&PNG_PAYLOAD_SOURCE, found);
+        if (token == NULL)
+        {
+            ReleasePngPayload(found);
+        }
+    }
+    return token;
+}
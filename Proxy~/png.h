@@ -0,0 +1,48 @@
+/*
+ * UnixxtyMCP Proxy - Asynchronous PNG encoder
+ *
+ * Encodes raw RGBA readbacks (screenshots, previews) off Unity's main
+ * thread. EncodePngAsync() copies the pixels and returns a job handle at
+ * once; the worker pool then picks RGB or RGBA (RGB when every pixel is
+ * opaque), filters rows with the adaptive minimum-sum heuristic (SSE2 on
+ * x86) and deflates horizontal stripes of about PNG_STRIPE_BYTES in
+ * parallel. Each stripe is primed with the filtered rows just above it, so
+ * the ratio stays close to a single stream, and the zlib checksum is
+ * combined from the stripes'. The last stripe to finish writes the file.
+ *
+ * The same jobs serve EncodeImageAsync(), which can first downscale the
+ * readback (image.c), drop it to grayscale, and write a baseline JPEG
+ * (jpeg.c) instead of a PNG.
+ *
+ * A finished job can be copied out, or attached to the response being
+ * built as a base64 payload without ever reaching managed memory.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_PNG_H
+#define UNITY_MCP_PNG_H
+
+#define PNG_MAX_JOBS 64
+#define PNG_STRIPE_BYTES (256 * 1024)
+#define PNG_MAX_PIXELS (64 * 1024 * 1024)
+#define PNG_JOB_TTL_MS 120000             /* Finished jobs whose handle was never released */
+
+/* EncodeImageAsync() flags */
+#define ENCODE_JPEG 1
+#define ENCODE_GRAYSCALE 2
+#define ENCODE_LANCZOS 4
+
+#define PNG_JOB_RUNNING 0
+#define PNG_JOB_DONE 1
+#define PNG_JOB_FAILED (-1)
+
+/*
+ * Start a job on packed RGBA rows, top first, that the job takes over
+ * (freed even on failure). Arguments otherwise as EncodeImageAsync().
+ * Returns the handle, or 0.
+ */
+int SubmitImageJob(unsigned char* pixels, int width, int height,
+    int target_width, int target_height, int quality, int flags);
+
+#endif /* UNITY_MCP_PNG_H */
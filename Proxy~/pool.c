@@ -0,0 +1,253 @@
+/*
+ * UnixxtyMCP Proxy - Pool allocator
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "pool.h"
+#include "mongoose.h"
+#include "platform.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#if !MG_ENABLE_CUSTOM_CALLOC
+#error "pool.c provides mg_calloc/mg_free: build with -DMG_ENABLE_CUSTOM_CALLOC=1"
+#endif
+
+#define POOL_CLASS_LARGE 0xFFu
+#define POOL_MAGIC 0x4D435050u  /* "MCPP" */
+
+/*
+ * Every block starts with a header naming its class, so mg_free() can find
+ * the pool without a size. 16 bytes keeps payloads 16-byte aligned.
+ */
+typedef union PoolHeader
+{
+    struct
+    {
+        uint32_t size_class;
+        uint32_t magic;
+        size_t size;           /* Block size for pooled blocks, request size for large ones */
+    } info;
+    union PoolHeader* next_free;
+    uint64_t align[2];
+} PoolHeader;
+
+typedef struct Pool
+{
+    size_t block_size;
+    PoolHeader* free_list;
+    size_t live;
+    size_t peak;
+    size_t bytes;              /* Slab memory reserved for this class */
+    uint64_t allocs;
+} Pool;
+
+static ProxyMutex s_pool_lock = PROXY_MUTEX_INITIALIZER;
+static Pool s_pools[POOL_CLASS_COUNT];
+static int s_pools_initialized = 0;
+
+static size_t s_large_live = 0;
+static size_t s_large_peak = 0;
+static size_t s_large_bytes = 0;
+static uint64_t s_large_allocs = 0;
+
+static char s_stats_buffer[2048];
+
+/*
+ * Caller holds the lock.
+ */
+static void InitializePools(void)
+{
+    int i;
+    for (i = 0; i < POOL_CLASS_COUNT; i++)
+    {
+        s_pools[i].block_size = (size_t)POOL_MIN_BLOCK << i;
+    }
+    s_pools_initialized = 1;
+}
+
+static int FindClass(size_t total)
+{
+    int i;
+    for (i = 0; i < POOL_CLASS_COUNT; i++)
+    {
+        if (total <= s_pools[i].block_size)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Carve a new slab into free blocks. Caller holds the lock.
+ * Slabs are never released: the plugin lives as long as the editor and the
+ * pools settle at the peak working set.
+ */
+static int GrowPool(Pool* pool)
+{
+    size_t count = POOL_MIN_SLAB / pool->block_size;
+    size_t i;
+    char* slab;
+
+    if (count < POOL_MIN_BLOCKS_PER_SLAB)
+    {
+        count = POOL_MIN_BLOCKS_PER_SLAB;
+    }
+    slab = (char*)malloc(count * pool->block_size);
+    if (slab == NULL)
+    {
+        return 0;
+    }
+    for (i = 0; i < count; i++)
+    {
+        PoolHeader* block = (PoolHeader*)(slab + i * pool->block_size);
+        block->next_free = pool->free_list;
+        pool->free_list = block;
+    }
+    pool->bytes += count * pool->block_size;
+    return 1;
+}
+
+void* mg_calloc(size_t count, size_t size)
+{
+    size_t total;
+    PoolHeader* header;
+    int size_class;
+
+    if (size != 0 && count > (SIZE_MAX - sizeof(PoolHeader)) / size)
+    {
+        return NULL;
+    }
+    total = count * size + sizeof(PoolHeader);
+
+    PROXY_MUTEX_LOCK(&s_pool_lock);
+    if (!s_pools_initialized)
+    {
+        InitializePools();
+    }
+    size_class = FindClass(total);
+    if (size_class < 0)
+    {
+        s_large_live++;
+        s_large_allocs++;
+        s_large_bytes += total;
+        if (s_large_live > s_large_peak)
+        {
+            s_large_peak = s_large_live;
+        }
+        PROXY_MUTEX_UNLOCK(&s_pool_lock);
+
+        header = (PoolHeader*)calloc(1, total);
+        if (header == NULL)
+        {
+            PROXY_MUTEX_LOCK(&s_pool_lock);
+            s_large_live--;
+            s_large_bytes -= total;
+            PROXY_MUTEX_UNLOCK(&s_pool_lock);
+            return NULL;
+        }
+        header->info.size_class = POOL_CLASS_LARGE;
+        header->info.magic = POOL_MAGIC;
+        header->info.size = total;
+        return header + 1;
+    }
+
+    {
+        Pool* pool = &s_pools[size_class];
+        if (pool->free_list == NULL && !GrowPool(pool))
+        {
+            PROXY_MUTEX_UNLOCK(&s_pool_lock);
+            return NULL;
+        }
+        header = pool->free_list;
+        pool->free_list = header->next_free;
+        pool->live++;
+        pool->allocs++;
+        if (pool->live > pool->peak)
+        {
+            pool->peak = pool->live;
+        }
+    }
+    PROXY_MUTEX_UNLOCK(&s_pool_lock);
+
+    header->info.size_class = (uint32_t)size_class;
+    header->info.magic = POOL_MAGIC;
+    header->info.size = s_pools[size_class].block_size;
+    memset(header + 1, 0, total - sizeof(PoolHeader));
+    return header + 1;
+}
+
+void mg_free(void* ptr)
+{
+    PoolHeader* header;
+
+    if (ptr == NULL)
+    {
+        return;
+    }
+    header = (PoolHeader*)ptr - 1;
+    if (header->info.magic != POOL_MAGIC)
+    {
+        /* Not ours: a mismatched free would corrupt the pools, so leak instead */
+        return;
+    }
+    header->info.magic = 0;
+
+    if (header->info.size_class == POOL_CLASS_LARGE)
+    {
+        PROXY_MUTEX_LOCK(&s_pool_lock);
+        s_large_live--;
+        s_large_bytes -= header->info.size;
+        PROXY_MUTEX_UNLOCK(&s_pool_lock);
+        free(header);
+        return;
+    }
+
+    PROXY_MUTEX_LOCK(&s_pool_lock);
+    {
+        Pool* pool = &s_pools[header->info.size_class];
+        header->next_free = pool->free_list;
+        pool->free_list = header;
+        pool->live--;
+    }
+    PROXY_MUTEX_UNLOCK(&s_pool_lock);
+}
+
+/*
+ * Get per-pool allocation statistics as a JSON object.
+ */
+EXPORT const char* GetProxyMemoryStats(void)
+{
+    size_t offset;
+    size_t reserved = 0;
+    int i;
+
+    PROXY_MUTEX_LOCK(&s_pool_lock);
+    if (!s_pools_initialized)
+    {
+        InitializePools();
+    }
+    offset = mg_snprintf(s_stats_buffer, sizeof(s_stats_buffer), "{\"pools\":[");
+    for (i = 0; i < POOL_CLASS_COUNT && offset < sizeof(s_stats_buffer); i++)
+    {
+        const Pool* pool = &s_pools[i];
+        reserved += pool->bytes;
+        offset += mg_snprintf(s_stats_buffer + offset, sizeof(s_stats_buffer) - offset,
+            "%s{\"block\":%lu,\"live\":%lu,\"peak\":%lu,\"bytes\":%lu,\"allocs\":%lu}",
+            i > 0 ? "," : "", (unsigned long)pool->block_size, (unsigned long)pool->live,
+            (unsigned long)pool->peak, (unsigned long)pool->bytes, (unsigned long)pool->allocs);
+    }
+    if (offset < sizeof(s_stats_buffer))
+    {
+        mg_snprintf(s_stats_buffer + offset, sizeof(s_stats_buffer) - offset,
+            "],\"large\":{\"live\":%lu,\"peak\":%lu,\"bytes\":%lu,\"allocs\":%lu},\"reserved_bytes\":%lu}",
+            (unsigned long)s_large_live, (unsigned long)s_large_peak, (unsigned long)s_large_bytes,
+            (unsigned long)s_large_allocs, (unsigned long)(reserved + s_large_bytes));
+    }
+    PROXY_MUTEX_UNLOCK(&s_pool_lock);
+    return s_stats_buffer;
+}
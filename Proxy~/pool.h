@@ -0,0 +1,24 @@
+/*
+ * UnixxtyMCP Proxy - Pool allocator
+ *
+ * Size-class slab pools behind mongoose's allocation hooks (mg_calloc and
+ * mg_free, enabled with -DMG_ENABLE_CUSTOM_CALLOC=1). Connections, TLS state
+ * and recv/send iobufs are carved from slabs that are reused instead of being
+ * returned to the heap the editor shares with Unity, so bursty traffic
+ * does not fragment it. Blocks above the largest class go straight to
+ * calloc/free and are counted separately.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_POOL_H
+#define UNITY_MCP_POOL_H
+
+#include <stddef.h>
+
+#define POOL_MIN_BLOCK 64              /* Smallest class, header included */
+#define POOL_CLASS_COUNT 11            /* 64 B .. 64 KB, powers of two */
+#define POOL_MIN_SLAB (64 * 1024)      /* Slabs hold at least this much... */
+#define POOL_MIN_BLOCKS_PER_SLAB 4     /* ...and at least this many blocks */
+
+#endif /* UNITY_MCP_POOL_H */
@@ -0,0 +1,730 @@
+/*
+ * UnixxtyMCP Proxy - Project tree
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "project.h"
+#include "search.h"
+#include "assets.h"
+#include "references.h"
+#include "symbols.h"
+#include "watcher.h"
+#include "jsonutil.h"
+#include "mongoose.h"
+#include "platform.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef _WIN32
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+static ProxyMutex s_project_lock = PROXY_MUTEX_INITIALIZER;
+static char s_project_root[PROJECT_MAX_PATH] = "";
+static unsigned s_project_generation = 0;
+static char s_project_excludes[PROJECT_MAX_EXCLUDES][256];
+static int s_project_exclude_count = 0;
+static char s_project_mounts[PROJECT_MAX_MOUNTS][2][PROJECT_MAX_PATH];   /* Project path, folder on disk */
+static int s_project_mount_count = 0;
+
+static const char* const PROJECT_TOP_FOLDERS[] = { "Assets", "Packages" };
+
+/*
+ * Start a new generation of the configuration. Caller holds the lock.
+ */
+static void BumpGeneration(void)
+{
+    s_project_generation++;
+    if (s_project_generation == 0)
+    {
+        s_project_generation = 1;
+    }
+}
+
+/*
+ * Rebuild whatever was built from the previous configuration.
+ */
+static void ProjectChanged(void)
+{
+    WatcherRestart();
+    SearchRefresh();
+    AssetsRefresh();
+    ReferencesRefresh();
+    SymbolsRefresh();
+}
+
+/*
+ * Configure the Unity project root (the folder holding Assets/).
+ */
+EXPORT void ConfigureProjectRoot(const char* path)
+{
+    char root[PROJECT_MAX_PATH];
+    size_t length;
+    int changed = 0;
+
+    snprintf(root, sizeof(root), "%s", path != NULL ? path : "");
+    length = strlen(root);
+    while (length > 1 && (root[length - 1] == '/' || root[length - 1] == '\\'))
+    {
+        root[--length] = '\0';
+    }
+
+    PROXY_MUTEX_LOCK(&s_project_lock);
+    if (strcmp(root, s_project_root) != 0)
+    {
+        memcpy(s_project_root, root, sizeof(root));
+        BumpGeneration();
+        changed = 1;
+    }
+    PROXY_MUTEX_UNLOCK(&s_project_lock);
+
+    if (changed)
+    {
+        ProjectChanged();
+    }
+}
+
+/*
+ * Configure globs of project-relative paths to leave out of the indexes,
+ * separated by ';' or newlines. '*' stays within a folder and '**' crosses
+ * folders.
+ */
+EXPORT void ConfigureProjectExcludes(const char* patterns)
+{
+    static char excludes[PROJECT_MAX_EXCLUDES][256];
+    const char* p = patterns != NULL ? patterns : "";
+    int count = 0;
+    int changed;
+
+    PROXY_MUTEX_LOCK(&s_project_lock);
+    memset(excludes, 0, sizeof(excludes));
+    while (*p != '\0' && count < PROJECT_MAX_EXCLUDES)
+    {
+        char* out = excludes[count];
+        size_t length = 0;
+
+        while (*p == ';' || *p == '\n' || *p == '\r' || *p == ' ')
+        {
+            p++;
+        }
+        while (*p != '\0' && *p != ';' && *p != '\n' && *p != '\r')
+        {
+            /* mongoose globs spell "any characters including '/'" as '#' */
+            if (p[0] == '*' && p[1] == '*')
+            {
+                p += 2;
+                if (length + 1 < sizeof(excludes[0]))
+                {
+                    out[length++] = '#';
+                }
+                continue;
+            }
+            if (length + 1 < sizeof(excludes[0]))
+            {
+                out[length++] = *p == '\\' ? '/' : *p;
+            }
+            p++;
+        }
+        while (length > 0 && (out[length - 1] == ' ' || out[length - 1] == '/'))
+        {
+            length--;
+        }
+        out[length] = '\0';
+        if (length > 0)
+        {
+            count++;
+        }
+    }
+
+    /* Reconfiguring after every domain reload must not rebuild the indexes */
+    changed = count != s_project_exclude_count || memcmp(excludes, s_project_excludes, sizeof(excludes)) != 0;
+    if (changed)
+    {
+        memcpy(s_project_excludes, excludes, sizeof(excludes));
+        s_project_exclude_count = count;
+        BumpGeneration();
+    }
+    PROXY_MUTEX_UNLOCK(&s_project_lock);
+
+    if (changed)
+    {
+        ProjectChanged();
+    }
+}
+
+/*
+ * Configure the local packages, one "Packages/<name>=<folder>" per line.
+ */
+EXPORT void ConfigureProjectPackages(const char* mounts)
+{
+    static char parsed[PROJECT_MAX_MOUNTS][2][PROJECT_MAX_PATH];
+    const char* p = mounts != NULL ? mounts : "";
+    int count = 0;
+    int changed;
+
+    PROXY_MUTEX_LOCK(&s_project_lock);
+    memset(parsed, 0, sizeof(parsed));
+    while (*p != '\0' && count < PROJECT_MAX_MOUNTS)
+    {
+        const char* end = p + strcspn(p, "\r\n");
+        const char* equals = (const char*)memchr(p, '=', (size_t)(end - p));
+        size_t name_length = equals != NULL ? (size_t)(equals - p) : 0;
+        size_t folder_length = equals != NULL ? (size_t)(end - equals - 1) : 0;
+        char* folder = parsed[count][1];
+        size_t i;
+
+        /* One level below Packages/, like Unity's own package paths */
+        if (name_length > 9 && name_length < PROJECT_MAX_PATH && strncmp(p, "Packages/", 9) == 0 &&
+            memchr(p + 9, '/', name_length - 9) == NULL && folder_length > 0 && folder_length < PROJECT_MAX_PATH)
+        {
+            memcpy(parsed[count][0], p, name_length);
+            for (i = 0; i < folder_length; i++)
+            {
+                folder[i] = equals[1 + i] == '\\' ? '/' : equals[1 + i];
+            }
+            while (folder_length > 1 && folder[folder_length - 1] == '/')
+            {
+                folder[--folder_length] = '\0';
+            }
+            count++;
+        }
+        p = end;
+        while (*p == '\r' || *p == '\n')
+        {
+            p++;
+        }
+    }
+
+    changed = count != s_project_mount_count || memcmp(parsed, s_project_mounts, sizeof(parsed)) != 0;
+    if (changed)
+    {
+        memcpy(s_project_mounts, parsed, sizeof(parsed));
+        s_project_mount_count = count;
+        BumpGeneration();
+    }
+    PROXY_MUTEX_UNLOCK(&s_project_lock);
+
+    if (changed)
+    {
+        ProjectChanged();
+    }
+}
+
+unsigned ProjectRoot(char* root, size_t capacity)
+{
+    unsigned generation;
+
+    PROXY_MUTEX_LOCK(&s_project_lock);
+    snprintf(root, capacity, "%s", s_project_root);
+    generation = s_project_root[0] != '\0' ? s_project_generation : 0;
+    PROXY_MUTEX_UNLOCK(&s_project_lock);
+    return generation;
+}
+
+static int IsIgnoredName(const char* name)
+{
+    size_t length = strlen(name);
+    return name[0] == '.' || length == 0 || name[length - 1] == '~';
+}
+
+int ProjectIsExcluded(const char* path)
+{
+    const char* name = path;
+    const char* p;
+    int excluded = 0;
+    int i;
+
+    /* Every component, not just the last: "Assets/.git/x" or "Assets/Docs~/x" */
+    for (p = path; ; p++)
+    {
+        if (*p == '/' || *p == '\0')
+        {
+            if (p > name && (name[0] == '.' || p[-1] == '~'))
+            {
+                return 1;
+            }
+            if (*p == '\0')
+            {
+                break;
+            }
+            name = p + 1;
+        }
+    }
+
+    PROXY_MUTEX_LOCK(&s_project_lock);
+    for (i = 0; i < s_project_exclude_count && !excluded; i++)
+    {
+        excluded = mg_match(mg_str(path), mg_str(s_project_excludes[i]), NULL);
+    }
+    PROXY_MUTEX_UNLOCK(&s_project_lock);
+    return excluded;
+}
+
+int ProjectIsValidPath(const char* path)
+{
+    const char* name;
+    const char* p;
+
+    if (path == NULL ||
+        ((strncmp(path, "Assets", 6) != 0 || (path[6] != '/' && path[6] != '\0')) &&
+         (strncmp(path, "Packages", 8) != 0 || (path[8] != '/' && path[8] != '\0'))))
+    {
+        return 0;
+    }
+
+    /* Backslashes count as separators too, as they do on Windows */
+    for (name = p = path; ; p++)
+    {
+        if (*p == '/' || *p == '\\' || *p == '\0')
+        {
+            if (p - name == 2 && name[0] == '.' && name[1] == '.')
+            {
+                return 0;
+            }
+            if (*p == '\0')
+            {
+                return 1;
+            }
+            name = p + 1;
+        }
+    }
+}
+
+int ProjectResolvePath(const char* path, char* full_path, size_t capacity)
+{
+    int written = -1;
+    int i;
+
+    if (!ProjectIsValidPath(path))
+    {
+        return 0;
+    }
+    PROXY_MUTEX_LOCK(&s_project_lock);
+    if (s_project_root[0] != '\0')
+    {
+        for (i = 0; i < s_project_mount_count && written < 0; i++)
+        {
+            size_t length = strlen(s_project_mounts[i][0]);
+            if (strncmp(path, s_project_mounts[i][0], length) == 0 && (path[length] == '/' || path[length] == '\0'))
+            {
+                written = snprintf(full_path, capacity, "%s%s", s_project_mounts[i][1], path + length);
+            }
+        }
+        if (written < 0)
+        {
+            written = snprintf(full_path, capacity, "%s/%s", s_project_root, path);
+        }
+    }
+    PROXY_MUTEX_UNLOCK(&s_project_lock);
+    return written >= 0 && (size_t)written < capacity;
+}
+
+void ProjectFormatPackages(struct mg_iobuf* out)
+{
+    int i;
+
+    mg_iobuf_add(out, out->len, "{", 1);
+    PROXY_MUTEX_LOCK(&s_project_lock);
+    for (i = 0; i < s_project_mount_count; i++)
+    {
+        if (i > 0)
+        {
+            mg_iobuf_add(out, out->len, ",", 1);
+        }
+        JsonAppendString(out, s_project_mounts[i][0], strlen(s_project_mounts[i][0]));
+        mg_iobuf_add(out, out->len, ":", 1);
+        JsonAppendString(out, s_project_mounts[i][1], strlen(s_project_mounts[i][1]));
+    }
+    PROXY_MUTEX_UNLOCK(&s_project_lock);
+    mg_iobuf_add(out, out->len, "}", 1);
+}
+
+typedef struct ProjectWalkState
+{
+    char full[PROJECT_MAX_PATH];         /* On disk */
+    char path[PROJECT_MAX_PATH];         /* Project-relative, as reported */
+    ProjectVisitor visitor;
+    ProjectFolderVisitor folder_visitor;
+    void* context;
+    int count;
+    int stopped;
+    char mounts[PROJECT_MAX_MOUNTS][2][PROJECT_MAX_PATH];
+    int mount_count;
+} ProjectWalkState;
+
+/*
+ * Append a name to both paths. Returns 0 if they would not fit.
+ */
+static int PushName(ProjectWalkState* state, const char* name, size_t* full_length, size_t* path_length)
+{
+    size_t name_length = strlen(name);
+
+    *full_length = strlen(state->full);
+    *path_length = strlen(state->path);
+    if (*full_length + 1 + name_length + 1 > sizeof(state->full) ||
+        *path_length + 1 + name_length + 1 > sizeof(state->path))
+    {
+        return 0;
+    }
+    state->full[*full_length] = '/';
+    memcpy(state->full + *full_length + 1, name, name_length + 1);
+    state->path[*path_length] = '/';
+    memcpy(state->path + *path_length + 1, name, name_length + 1);
+    return 1;
+}
+
+static void PopName(ProjectWalkState* state, size_t full_length, size_t path_length)
+{
+    state->full[full_length] = '\0';
+    state->path[path_length] = '\0';
+}
+
+static void WalkFolder(ProjectWalkState* state, int depth);
+
+/*
+ * Enter the folder state->path names.
+ */
+static void EnterFolder(ProjectWalkState* state, int depth)
+{
+    if (state->folder_visitor == NULL || state->folder_visitor(state->context, state->path, state->full))
+    {
+        WalkFolder(state, depth);
+    }
+}
+
+static void VisitEntry(ProjectWalkState* state, const char* name, int is_directory, uint64_t size,
+    int64_t modified, int depth)
+{
+    size_t full_length;
+    size_t path_length;
+
+    if (state->stopped || IsIgnoredName(name) || !PushName(state, name, &full_length, &path_length))
+    {
+        return;
+    }
+    if (!ProjectIsExcluded(state->path))
+    {
+        if (is_directory)
+        {
+            EnterFolder(state, depth + 1);
+        }
+        else if (state->visitor != NULL)
+        {
+            state->count++;
+            if (!state->visitor(state->context, state->path, size, modified))
+            {
+                state->stopped = 1;
+            }
+        }
+    }
+    PopName(state, full_length, path_length);
+}
+
+#ifdef _WIN32
+
+static void WalkFolder(ProjectWalkState* state, int depth)
+{
+    char pattern[PROJECT_MAX_PATH + 2];
+    WIN32_FIND_DATAA data;
+    HANDLE find;
+
+    if (depth > 64 || snprintf(pattern, sizeof(pattern), "%s/*", state->full) >= (int)sizeof(pattern))
+    {
+        return;
+    }
+    find = FindFirstFileA(pattern, &data);
+    if (find == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+    do
+    {
+        int is_directory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        uint64_t size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+        /* FILETIME counts 100ns intervals since 1601 */
+        int64_t modified = (int64_t)(((((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) |
+            data.ftLastWriteTime.dwLowDateTime) / 10000ull) - 11644473600000ull);
+
+        if (is_directory && (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0)
+        {
+            continue;  /* Junctions and symbolic links: may loop */
+        }
+        VisitEntry(state, data.cFileName, is_directory, size, modified, depth);
+    } while (!state->stopped && FindNextFileA(find, &data));
+    FindClose(find);
+}
+
+#else
+
+static void WalkFolder(ProjectWalkState* state, int depth)
+{
+    DIR* directory;
+    struct dirent* entry;
+
+    if (depth > 64 || (directory = opendir(state->full)) == NULL)
+    {
+        return;
+    }
+    while (!state->stopped && (entry = readdir(directory)) != NULL)
+    {
+        struct stat info;
+        size_t full_length;
+        size_t path_length;
+        int64_t modified;
+
+        if (IsIgnoredName(entry->d_name) || !PushName(state, entry->d_name, &full_length, &path_length))
+        {
+            continue;
+        }
+        /* Symbolic links to files are followed; to directories they are not, they may loop */
+        if (lstat(state->full, &info) != 0 ||
+            (S_ISLNK(info.st_mode) && (stat(state->full, &info) != 0 || S_ISDIR(info.st_mode))))
+        {
+            PopName(state, full_length, path_length);
+            continue;
+        }
+        PopName(state, full_length, path_length);
+#ifdef __APPLE__
+        modified = (int64_t)info.st_mtimespec.tv_sec * 1000 + info.st_mtimespec.tv_nsec / 1000000;
+#else
+        modified = (int64_t)info.st_mtim.tv_sec * 1000 + info.st_mtim.tv_nsec / 1000000;
+#endif
+        if (S_ISDIR(info.st_mode) || S_ISREG(info.st_mode))
+        {
+            VisitEntry(state, entry->d_name, S_ISDIR(info.st_mode), (uint64_t)info.st_size, modified, depth);
+        }
+    }
+    closedir(directory);
+}
+
+#endif
+
+int ProjectWalkTree(const char* folder, ProjectVisitor visitor, ProjectFolderVisitor folder_visitor,
+    void* context)
+{
+    char root[PROJECT_MAX_PATH];
+    ProjectWalkState* state;
+    int count;
+    int i;
+
+    if (ProjectRoot(root, sizeof(root)) == 0 ||
+        (state = (ProjectWalkState*)calloc(1, sizeof(ProjectWalkState))) == NULL)
+    {
+        return -1;
+    }
+    state->visitor = visitor;
+    state->folder_visitor = folder_visitor;
+    state->context = context;
+
+    if (folder != NULL)
+    {
+        if (snprintf(state->path, sizeof(state->path), "%s", folder) < (int)sizeof(state->path) &&
+            !ProjectIsExcluded(state->path) && ProjectResolvePath(state->path, state->full, sizeof(state->full)))
+        {
+            EnterFolder(state, 0);
+        }
+    }
+    else
+    {
+        for (i = 0; i < (int)(sizeof(PROJECT_TOP_FOLDERS) / sizeof(PROJECT_TOP_FOLDERS[0])) && !state->stopped; i++)
+        {
+            snprintf(state->path, sizeof(state->path), "%s", PROJECT_TOP_FOLDERS[i]);
+            if (ProjectResolvePath(state->path, state->full, sizeof(state->full)) && !ProjectIsExcluded(state->path))
+            {
+                EnterFolder(state, 0);
+            }
+        }
+
+        PROXY_MUTEX_LOCK(&s_project_lock);
+        state->mount_count = s_project_mount_count;
+        memcpy(state->mounts, s_project_mounts, sizeof(state->mounts));
+        PROXY_MUTEX_UNLOCK(&s_project_lock);
+        for (i = 0; i < state->mount_count && !state->stopped; i++)
+        {
+            memcpy(state->path, state->mounts[i][0], sizeof(state->path));
+            memcpy(state->full, state->mounts[i][1], sizeof(state->full));
+            if (!ProjectIsExcluded(state->path))
+            {
+                EnterFolder(state, 0);
+            }
+        }
+    }
+    count = state->count;
+    free(state);
+    return count;
+}
+
+int ProjectWalk(ProjectVisitor visitor, void* context)
+{
+    return ProjectWalkTree(NULL, visitor, NULL, context);
+}
+
+char* ProjectReadFile(const char* path, size_t max_size, size_t* length)
+{
+    char full_path[PROJECT_MAX_PATH];
+    char* data;
+    FILE* file;
+    long size;
+
+    if (!ProjectResolvePath(path, full_path, sizeof(full_path)) || (file = fopen(full_path, "rb")) == NULL)
+    {
+        return NULL;
+    }
+    data = NULL;
+    if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) >= 0 && (size_t)size <= max_size &&
+        fseek(file, 0, SEEK_SET) == 0 && (data = (char*)malloc((size_t)size + 1)) != NULL)
+    {
+        size_t read = fread(data, 1, (size_t)size, file);
+        data[read] = '\0';
+        *length = read;
+    }
+    fclose(file);
+    return data;
+}
+
+char* ProjectReadHead(const char* path, size_t max_length, size_t* length)
+{
+    char full_path[PROJECT_MAX_PATH];
+    char* data;
+    FILE* file;
+
+    if (!ProjectResolvePath(path, full_path, sizeof(full_path)) || (file = fopen(full_path, "rb")) == NULL)
+    {
+        return NULL;
+    }
+    if ((data = (char*)malloc(max_length + 1)) != NULL)
+    {
+        size_t read = fread(data, 1, max_length, file);
+        data[read] = '\0';
+        *length = read;
+    }
+    fclose(file);
+    return data;
+}
+
+int ProjectStatFile(const char* path, uint64_t* size, int64_t* modified)
+{
+    char full_path[PROJECT_MAX_PATH];
+
+    if (!ProjectResolvePath(path, full_path, sizeof(full_path)))
+    {
+        return 0;
+    }
+#ifdef _WIN32
+    {
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (!GetFileAttributesExA(full_path, GetFileExInfoStandard, &data) ||
+            (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+        {
+            return 0;
+        }
+        *size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+        *modified = (int64_t)(((((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) |
+            data.ftLastWriteTime.dwLowDateTime) / 10000ull) - 11644473600000ull);
+    }
+#else
+    {
+        struct stat info;
+        if (stat(full_path, &info) != 0 || !S_ISREG(info.st_mode))
+        {
+            return 0;
+        }
+        *size = (uint64_t)info.st_size;
+#ifdef __APPLE__
+        *modified = (int64_t)info.st_mtimespec.tv_sec * 1000 + info.st_mtimespec.tv_nsec / 1000000;
+#else
+        *modified = (int64_t)info.st_mtim.tv_sec * 1000 + info.st_mtim.tv_nsec / 1000000;
+#endif
+    }
+#endif
+    return 1;
+}
+
+int ProjectMapFile(const char* path, size_t max_size, ProjectMapping* mapping)
+{
+    char full_path[PROJECT_MAX_PATH];
+
+    memset(mapping, 0, sizeof(*mapping));
+    if (!ProjectResolvePath(path, full_path, sizeof(full_path)))
+    {
+        return 0;
+    }
+#ifdef _WIN32
+    {
+        LARGE_INTEGER size;
+        HANDLE file = CreateFileA(full_path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return 0;
+        }
+        if (!GetFileSizeEx(file, &size) || (uint64_t)size.QuadPart > max_size)
+        {
+            CloseHandle(file);
+            return 0;
+        }
+        mapping->length = (size_t)size.QuadPart;
+        if (mapping->length > 0)
+        {
+            /* The mapping keeps the file open */
+            mapping->handle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            mapping->data = mapping->handle != NULL
+                ? (const char*)MapViewOfFile(mapping->handle, FILE_MAP_READ, 0, 0, 0)
+                : NULL;
+            if (mapping->data == NULL)
+            {
+                if (mapping->handle != NULL) CloseHandle(mapping->handle);
+                CloseHandle(file);
+                memset(mapping, 0, sizeof(*mapping));
+                return 0;
+            }
+        }
+        CloseHandle(file);
+    }
+#else
+    {
+        struct stat info;
+        int fd = open(full_path, O_RDONLY);
+        if (fd < 0)
+        {
+            return 0;
+        }
+        if (fstat(fd, &info) != 0 || (uint64_t)info.st_size > max_size)
+        {
+            close(fd);
+            return 0;
+        }
+        mapping->length = (size_t)info.st_size;
+        if (mapping->length > 0)
+        {
+            void* data = mmap(NULL, mapping->length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                close(fd);
+                mapping->length = 0;
+                return 0;
+            }
+            mapping->data = (const char*)data;
+        }
+        close(fd);
+    }
+#endif
+    return 1;
+}
+
+void ProjectUnmapFile(ProjectMapping* mapping)
+{
+#ifdef _WIN32
+    if (mapping->data != NULL) UnmapViewOfFile(mapping->data);
+    if (mapping->handle != NULL) CloseHandle(mapping->handle);
+#else
+    if (mapping->data != NULL) munmap((void*)mapping->data, mapping->length);
+#endif
+    memset(mapping, 0, sizeof(*mapping));
+}
@@ -0,0 +1,136 @@
+/*
+ * UnixxtyMCP Proxy - Project tree
+ *
+ * The native indexes (file search, and the services built on the same
+ * walk) read the Unity project directly, on background threads, so they
+ * keep answering while the editor is busy or reloading its domain. C#
+ * configures the project root once with ConfigureProjectRoot(); files are
+ * then enumerated under Assets/ and Packages/ with paths relative to the
+ * root ("Assets/Scripts/Player.cs"). Hidden entries (".git", ".DS_Store"),
+ * folders and files Unity itself ignores (trailing '~'), symbolic links to
+ * directories and paths matching a configured exclude glob are skipped.
+ *
+ * Local packages ("file:" dependencies in Packages/manifest.json) live
+ * outside the project; C# mounts each one under the path Unity gives it
+ * ("Packages/com.company.tool") with ConfigureProjectPackages(), so they are
+ * walked, read and watched as if they were embedded.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_PROJECT_H
+#define UNITY_MCP_PROJECT_H
+
+#include "mongoose.h"
+#include <stdint.h>
+
+#define PROJECT_MAX_PATH 1024
+#define PROJECT_MAX_EXCLUDES 32
+#define PROJECT_MAX_MOUNTS 32
+
+/*
+ * Called for every file found by a walk. `modified` is the modification
+ * time in milliseconds since the epoch. Return 0 to stop the walk.
+ */
+typedef int (*ProjectVisitor)(void* context, const char* path, uint64_t size, int64_t modified);
+
+/*
+ * Called for every folder a walk enters, before its contents, with its
+ * project-relative and its on-disk path. Return 0 to skip the folder.
+ */
+typedef int (*ProjectFolderVisitor)(void* context, const char* path, const char* full_path);
+
+/*
+ * Copy the configured project root to `root`. Returns its generation, which
+ * changes whenever the root is reconfigured, or 0 if none is configured.
+ */
+unsigned ProjectRoot(char* root, size_t capacity);
+
+/*
+ * Enumerate the files under Assets/, Packages/ and the mounted packages of
+ * the configured root. Returns the number of files visited, or -1 if no
+ * root is configured.
+ */
+int ProjectWalk(ProjectVisitor visitor, void* context);
+
+/*
+ * Walk one project-relative folder ("Assets/Art"), or the whole project
+ * when `folder` is NULL. Either visitor may be NULL. Returns the number of
+ * files visited, or -1 if no root is configured.
+ */
+int ProjectWalkTree(const char* folder, ProjectVisitor visitor, ProjectFolderVisitor folder_visitor,
+    void* context);
+
+/*
+ * True if a path names something inside the project: "Assets" or
+ * "Packages", or a path below either with no ".." component ('\\' counts
+ * as a separator too). Paths taken from requests are checked with this
+ * before they are resolved.
+ */
+int ProjectIsValidPath(const char* path);
+
+/*
+ * Map a project-relative path to its path on disk, through the package
+ * mounts. Returns 0 if no root is configured, the path is not valid (see
+ * ProjectIsValidPath()) or the result does not fit.
+ */
+int ProjectResolvePath(const char* path, char* full_path, size_t capacity);
+
+/*
+ * Append the package mounts as a JSON object, {"Packages/<name>":"<folder>"}.
+ */
+void ProjectFormatPackages(struct mg_iobuf* out);
+
+/*
+ * True if a project-relative path is excluded (hidden, ignored by Unity or
+ * matching an exclude glob). Used for paths reported by other sources, such
+ * as the file watcher.
+ */
+int ProjectIsExcluded(const char* path);
+
+/*
+ * Read a whole file into a NUL-terminated malloc'ed buffer. Fails for files
+ * larger than max_size. Returns NULL on failure.
+ */
+char* ProjectReadFile(const char* path, size_t max_size, size_t* length);
+
+/*
+ * Read up to max_length bytes from the start of a file into a
+ * NUL-terminated malloc'ed buffer. Returns NULL on failure.
+ */
+char* ProjectReadHead(const char* path, size_t max_length, size_t* length);
+
+/*
+ * Size and modification time (milliseconds since the epoch, as in walks) of
+ * a project file. Returns 0 if it does not exist or is not a regular file.
+ */
+int ProjectStatFile(const char* path, uint64_t* size, int64_t* modified);
+
+/*
+ * A read-only mapping of a whole file. `data` is NULL for an empty file.
+ */
+typedef struct ProjectMapping
+{
+    const char* data;
+    size_t length;
+#ifdef _WIN32
+    void* handle;
+#endif
+} ProjectMapping;
+
+/*
+ * Map a file into memory, failing for files larger than max_size. Returns
+ * 0 on failure.
+ */
+int ProjectMapFile(const char* path, size_t max_size, ProjectMapping* mapping);
+void ProjectUnmapFile(ProjectMapping* mapping);
+
+/*
+ * A JSON-RPC method answered natively from a project index, on the server
+ * thread. The handler appends the "result" value to `result` and returns 0,
+ * or returns a JSON-RPC error code and points `error` at a static message.
+ */
+#define PROJECT_ERROR_NOT_READY (-32002)   /* No root configured or index still building */
+typedef int (*ProjectMethod)(struct mg_str request, struct mg_iobuf* result, const char** error);
+
+#endif /* UNITY_MCP_PROJECT_H */
@@ -0,0 +1,604 @@
+/*
+ * UnixxtyMCP Proxy - Project index test
+ *
+ * Standalone executable that writes a small Unity project to the working
+ * directory, points the native project indexes at it and checks what their
+ * JSON-RPC methods answer: "search/files" for literal and regular
+ * expression queries with their filters, and "assets/resolve" for GUIDs,
+ * paths and FindAssets() filters over the .meta files,
+ * "assets/references" for the files mentioning a GUID, the "scenes/"
+ * methods for a scene and a prefab, refusing paths that leave the project,
+ * and "code/symbols" and "code/definition" for the C# declarations.
+ *
+ * Usage:
+ *   project_test
+ *
+ * Build with build_project_test.sh (Linux/macOS). Not shipped with the
+ * plugin. Exits with status 1 if any check fails.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "project.h"
+#include "search.h"
+#include "assets.h"
+#include "references.h"
+#include "scenes.h"
+#include "symbols.h"
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static int s_failures = 0;
+static int s_checks = 0;
+static char s_root[1024] = "";
+
+#define CHECK(condition, ...) \
+    do \
+    { \
+        s_checks++; \
+        if (!(condition)) \
+        { \
+            s_failures++; \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+        } \
+    } while (0)
+
+/*
+ * The fixture project, relative to the working directory. The project root
+ * is project_test_files/root, so that "Assets/../../<name>" would land in
+ * project_test_files/.
+ */
+#define PLAYER_GUID "5a8f0c3e7b1d4e2fa9c6b0d1e2f3a4b5"
+#define ENEMY_GUID "6b9e1d4f8c2e5f3ab0d7c1e2f3a4b5c6"
+#define BALANCE_GUID "4f7d9b2c6a0e3d1fb8a5c9e0d1f2a3b4"
+#define TEXTURE_GUID "7cae2e5a9d3f6a4bc1e8d2f3a4b5c6d7"
+#define MATERIAL_GUID "8dbf3f6bae4a7b5cd2f9e3a4b5c6d7e8"
+#define DATA_GUID "3e6c8a1b5f9d2c0ea7f4b8d9c0e1f2a3"
+#define PREFAB_GUID "2d5b7f0a4e8c1b9fd6e3a7c8b9d0e1f2"
+#define SCENE_GUID "9ec04a7cbf5b8c6de3a0f4b5c6d7e8f9"
+#define MISSING_GUID "0123456789abcdef0123456789abcdef"
+
+#define SCRIPT_META(guid) "fileFormatVersion: 2\nguid: " guid "\nMonoImporter:\n  externalObjects: {}\n"
+
+typedef struct FixtureFile
+{
+    const char* path;
+    const char* contents;
+} FixtureFile;
+
+static const FixtureFile FIXTURE[] =
+{
+    { "root/Assets/Scripts/Player.cs",
+        "using UnityEngine;\n"
+        "\n"
+        "namespace Game.Combat\n"
+        "{\n"
+        "    public class Player : MonoBehaviour\n"
+        "    {\n"
+        "        public int Health = 100;\n"
+        "\n"
+        "        public void TakeDamage(int amount)\n"
+        "        {\n"
+        "            Health -= amount;\n"
+        "        }\n"
+        "    }\n"
+        "}\n" },
+    { "root/Assets/Scripts/Enemy.cs",
+        "using UnityEngine;\n"
+        "using Game.Combat;\n"
+        "\n"
+        "public class Enemy : MonoBehaviour\n"
+        "{\n"
+        "    public Player target;\n"
+        "\n"
+        "    void Attack() { target.TakeDamage(25); }\n"
+        "}\n" },
+    { "root/Assets/Docs/notes.txt",
+        "Enemies call takedamage on the player.\n"
+        "Damage values: 25, 100\n" },
+    { "root/Assets/Scripts/Player.cs.meta", SCRIPT_META(PLAYER_GUID) },
+    { "root/Assets/Scripts/PlayerEditor.cs",
+        "namespace Game.Combat\n"
+        "{\n"
+        "    // class CommentedOut { }\n"
+        "    public partial class Player\n"
+        "    {\n"
+        "        const string Text = @\"class NotAType { \"\"quoted\"\" }\";\n"
+        "        public event System.Action Died;\n"
+        "        public int this[int i] => i;\n"
+        "#if UNITY_EDITOR\n"
+        "        public void EditorOnly() { }\n"
+        "#else\n"
+        "        public void RuntimeOnly() { }\n"
+        "#endif\n"
+        "    }\n"
+        "\n"
+        "    public enum DamageType { Fire, Ice }\n"
+        "}\n" },
+    { "root/Assets/Scripts/Enemy.cs.meta", SCRIPT_META(ENEMY_GUID) },
+    { "root/Assets/Scripts/Balance.cs",
+        "using UnityEngine;\n"
+        "\n"
+        "public class Balance : ScriptableObject\n"
+        "{\n"
+        "    public float speed;\n"
+        "}\n" },
+    { "root/Assets/Scripts/Balance.cs.meta", SCRIPT_META(BALANCE_GUID) },
+    { "root/Assets/Data/Balance.asset",
+        "%YAML 1.1\n"
+        "%TAG !u! tag:unity3d.com,2011:\n"
+        "--- !u!114 &11400000\n"
+        "MonoBehaviour:\n"
+        "  m_Script: {fileID: 11500000, guid: " BALANCE_GUID ", type: 3}\n"
+        "  m_Name: Balance\n"
+        "  speed: 2.5\n" },
+    { "root/Assets/Data/Balance.asset.meta",
+        "fileFormatVersion: 2\nguid: " DATA_GUID "\nNativeFormatImporter:\n  mainObjectFileID: 11400000\n" },
+    { "root/Assets/Textures/Hero.png", "" },
+    { "root/Assets/Textures/Hero.png.meta",
+        "fileFormatVersion: 2\n"
+        "guid: " TEXTURE_GUID "\n"
+        "labels:\n"
+        "- Character\n"
+        "- Hero\n"
+        "TextureImporter:\n"
+        "  mipmaps:\n"
+        "    mipMapMode: 0\n" },
+    { "root/Assets/Materials/Hero.mat",
+        "%YAML 1.1\n"
+        "%TAG !u! tag:unity3d.com,2011:\n"
+        "--- !u!21 &2100000\n"
+        "Material:\n"
+        "  m_Name: Hero\n"
+        "  m_SavedProperties:\n"
+        "    m_TexEnvs:\n"
+        "    - _MainTex:\n"
+        "        m_Texture: {fileID: 2800000, guid: " TEXTURE_GUID ", type: 3}\n"
+        "    - _BumpMap:\n"
+        "        m_Texture: {fileID: 2800000, guid: " TEXTURE_GUID ", type: 3}\n" },
+    { "root/Assets/Materials/Hero.mat.meta",
+        "fileFormatVersion: 2\nguid: " MATERIAL_GUID "\nNativeFormatImporter:\n  mainObjectFileID: 2100000\n" },
+    { "root/Assets/Prefabs/Hero.prefab",
+        "%YAML 1.1\n"
+        "%TAG !u! tag:unity3d.com,2011:\n"
+        "--- !u!1 &1000\n"
+        "GameObject:\n"
+        "  m_Component:\n"
+        "  - component: {fileID: 1001}\n"
+        "  - component: {fileID: 1002}\n"
+        "  - component: {fileID: 1003}\n"
+        "  m_Name: Hero\n"
+        "--- !u!4 &1001\n"
+        "Transform:\n"
+        "  m_GameObject: {fileID: 1000}\n"
+        "  m_Children: []\n"
+        "  m_Father: {fileID: 0}\n"
+        "--- !u!23 &1002\n"
+        "MeshRenderer:\n"
+        "  m_GameObject: {fileID: 1000}\n"
+        "  m_Materials:\n"
+        "  - {fileID: 2100000, guid: " MATERIAL_GUID ", type: 2}\n"
+        "--- !u!114 &1003\n"
+        "MonoBehaviour:\n"
+        "  m_GameObject: {fileID: 1000}\n"
+        "  m_Script: {fileID: 11500000, guid: " PLAYER_GUID ", type: 3}\n" },
+    { "root/Assets/Prefabs/Hero.prefab.meta",
+        "fileFormatVersion: 2\nguid: " PREFAB_GUID "\nPrefabImporter:\n  externalObjects: {}\n" },
+    { "root/Assets/Scenes/Main.unity",
+        "%YAML 1.1\n"
+        "%TAG !u! tag:unity3d.com,2011:\n"
+        "--- !u!1 &100\n"
+        "GameObject:\n"
+        "  m_Component:\n"
+        "  - component: {fileID: 101}\n"
+        "  - component: {fileID: 102}\n"
+        "  m_Layer: 8\n"
+        "  m_Name: Player\n"
+        "  m_TagString: Player\n"
+        "  m_IsActive: 1\n"
+        "--- !u!4 &101\n"
+        "Transform:\n"
+        "  m_GameObject: {fileID: 100}\n"
+        "  m_Children:\n"
+        "  - {fileID: 201}\n"
+        "  m_Father: {fileID: 0}\n"
+        "--- !u!114 &102\n"
+        "MonoBehaviour:\n"
+        "  m_GameObject: {fileID: 100}\n"
+        "  m_Enabled: 1\n"
+        "  m_Script: {fileID: 11500000, guid: " PLAYER_GUID ", type: 3}\n"
+        "  weapon: {fileID: 200}\n"
+        "--- !u!1 &200\n"
+        "GameObject:\n"
+        "  m_Component:\n"
+        "  - component: {fileID: 201}\n"
+        "  m_Layer: 0\n"
+        "  m_Name: Sword\n"
+        "  m_TagString: Untagged\n"
+        "  m_IsActive: 0\n"
+        "--- !u!4 &201\n"
+        "Transform:\n"
+        "  m_GameObject: {fileID: 200}\n"
+        "  m_Children: []\n"
+        "  m_Father: {fileID: 101}\n"
+        "--- !u!1001 &300\n"
+        "PrefabInstance:\n"
+        "  m_Modification:\n"
+        "    m_TransformParent: {fileID: 0}\n"
+        "    m_Modifications:\n"
+        "    - target: {fileID: 1000, guid: " PREFAB_GUID ", type: 3}\n"
+        "      propertyPath: m_Name\n"
+        "      value: Hero (1)\n"
+        "      objectReference: {fileID: 0}\n"
+        "  m_SourcePrefab: {fileID: 100100000, guid: " PREFAB_GUID ", type: 3}\n" },
+    { "root/Assets/Scenes/Main.unity.meta",
+        "fileFormatVersion: 2\nguid: " SCENE_GUID "\nDefaultImporter:\n  externalObjects: {}\n" },
+    /* Next to the project root, for requests trying to leave it */
+    { "outside.unity",
+        "%YAML 1.1\n"
+        "%TAG !u! tag:unity3d.com,2011:\n"
+        "--- !u!1 &1\n"
+        "GameObject:\n"
+        "  m_Name: Outside\n" },
+};
+
+#define FIXTURE_COUNT ((int)(sizeof(FIXTURE) / sizeof(FIXTURE[0])))
+
+static void MakeParents(char* path)
+{
+    char* slash;
+    for (slash = strchr(path, '/'); slash != NULL; slash = strchr(slash + 1, '/'))
+    {
+        *slash = '\0';
+        mkdir(path, 0755);
+        *slash = '/';
+    }
+}
+
+static int WriteProject(void)
+{
+    char path[1024];
+    int i;
+
+    for (i = 0; i < FIXTURE_COUNT; i++)
+    {
+        FILE* file;
+        snprintf(path, sizeof(path), "project_test_files/%s", FIXTURE[i].path);
+        MakeParents(path);
+        file = fopen(path, "wb");
+        CHECK(file != NULL, "Cannot write %s", path);
+        if (file == NULL)
+        {
+            return 0;
+        }
+        fwrite(FIXTURE[i].contents, 1, strlen(FIXTURE[i].contents), file);
+        fclose(file);
+    }
+    return 1;
+}
+
+static void RemoveProject(void)
+{
+    char path[1024];
+    int i;
+
+    for (i = 0; i < FIXTURE_COUNT; i++)
+    {
+        char* slash;
+        snprintf(path, sizeof(path), "project_test_files/%s", FIXTURE[i].path);
+        remove(path);
+        while ((slash = strrchr(path, '/')) != NULL)
+        {
+            *slash = '\0';
+            rmdir(path);  /* Fails until the folder is empty */
+        }
+    }
+}
+
+/*
+ * Call a method until its index is built and the reply contains `expected`
+ * (indexes build on worker threads), or give up after five seconds. Returns
+ * the method's code; the reply or error message is NUL-terminated.
+ */
+static int Call(ProjectMethod method, const char* request, const char* expected, struct mg_iobuf* result)
+{
+    const char* error = "";
+    int code = PROJECT_ERROR_NOT_READY;
+    int attempt;
+
+    for (attempt = 0; attempt < 100; attempt++)
+    {
+        result->len = 0;
+        code = method(mg_str(request), result, &error);
+        if (code != 0)
+        {
+            result->len = 0;
+            mg_iobuf_add(result, 0, error, strlen(error));
+        }
+        mg_iobuf_add(result, result->len, "", 1);
+        if (code != PROJECT_ERROR_NOT_READY && (expected == NULL || strstr((const char*)result->buf, expected) != NULL))
+        {
+            break;
+        }
+        PROXY_SLEEP_MS(50);
+    }
+    return code;
+}
+
+static int Contains(const struct mg_iobuf* result, const char* text)
+{
+    return result->buf != NULL && strstr((const char*)result->buf, text) != NULL;
+}
+
+static int Count(const struct mg_iobuf* result, const char* text)
+{
+    const char* p = result->buf != NULL ? (const char*)result->buf : "";
+    int count = 0;
+    while ((p = strstr(p, text)) != NULL)
+    {
+        count++;
+        p += strlen(text);
+    }
+    return count;
+}
+
+static void TestSearch(void)
+{
+    struct mg_iobuf result = {0, 0, 0, 4096};
+    int code;
+
+    code = Call(SearchFilesMethod, "{\"params\":{\"query\":\"TakeDamage\"}}", "Enemy.cs", &result);
+    CHECK(code == 0 && Count(&result, "\"path\":") == 2 &&
+        Contains(&result, "\"path\":\"Assets/Scripts/Player.cs\",\"line\":9,\"column\":21") &&
+        Contains(&result, "\"path\":\"Assets/Scripts/Enemy.cs\",\"line\":8,\"column\":28"),
+        "Literal search: %s", (const char*)result.buf);
+    CHECK(!Contains(&result, "notes.txt"), "Case-sensitive search matched other case: %s", (const char*)result.buf);
+
+    Call(SearchFilesMethod, "{\"params\":{\"query\":\"takedamage\",\"case_sensitive\":false}}", "notes.txt", &result);
+    CHECK(Count(&result, "\"path\":") == 3, "Case-insensitive search: %s", (const char*)result.buf);
+
+    Call(SearchFilesMethod, "{\"params\":{\"query\":\"TakeDamage\",\"path\":\"Assets/Scripts\",\"glob\":\"E*.cs\"}}",
+        NULL, &result);
+    CHECK(Count(&result, "\"path\":") == 1 && Contains(&result, "Enemy.cs"), "Glob and path: %s", (const char*)result.buf);
+
+    /* Regular expressions, with and without a literal every match contains */
+    Call(SearchFilesMethod, "{\"params\":{\"query\":\"Take[A-Z][a-z]+\\\\([0-9]+\\\\)\",\"regex\":true}}", NULL, &result);
+    CHECK(Count(&result, "\"path\":") == 1 && Contains(&result, "target.TakeDamage(25)"),
+        "Regex search: %s", (const char*)result.buf);
+    Call(SearchFilesMethod, "{\"params\":{\"query\":\"[0-9]+, [0-9]+\",\"regex\":true}}", NULL, &result);
+    CHECK(Count(&result, "\"path\":") == 1 && Contains(&result, "\"path\":\"Assets/Docs/notes.txt\",\"line\":2"),
+        "Regex without a literal: %s", (const char*)result.buf);
+
+    code = Call(SearchFilesMethod, "{\"params\":{\"query\":\"NotInTheProject\"}}", NULL, &result);
+    CHECK(code == 0 && Contains(&result, "\"matches\":[]"), "Absent text: %s", (const char*)result.buf);
+    code = Call(SearchFilesMethod, "{\"params\":{\"query\":\"(\",\"regex\":true}}", NULL, &result);
+    CHECK(code == -32602, "Invalid regex: %d %s", code, (const char*)result.buf);
+    code = Call(SearchFilesMethod, "{\"params\":{}}", NULL, &result);
+    CHECK(code == -32602, "Missing query: %d %s", code, (const char*)result.buf);
+
+    mg_iobuf_free(&result);
+}
+
+static void TestAssets(void)
+{
+    struct mg_iobuf result = {0, 0, 0, 4096};
+    int code;
+
+    code = Call(AssetsResolveMethod, "{\"params\":{\"guids\":[\"" PLAYER_GUID "\",\"" MISSING_GUID "\"]}}",
+        "Player.cs", &result);
+    CHECK(code == 0 && Contains(&result, "{\"guid\":\"" PLAYER_GUID "\",\"path\":\"Assets/Scripts/Player.cs\","
+        "\"type\":\"MonoScript\",\"importer\":\"MonoImporter\"}") &&
+        Contains(&result, "\"missing\":[\"" MISSING_GUID "\"]"), "Resolve by GUID: %s", (const char*)result.buf);
+
+    Call(AssetsResolveMethod, "{\"params\":{\"paths\":[\"Assets/Textures/Hero.png\"]}}", NULL, &result);
+    CHECK(Contains(&result, "\"guid\":\"" TEXTURE_GUID "\"") && Contains(&result, "\"type\":\"Texture2D\"") &&
+        Contains(&result, "\"labels\":[\"Character\",\"Hero\"]"), "Resolve by path: %s", (const char*)result.buf);
+
+    /* FindAssets() filters: type or base type, label, name */
+    Call(AssetsResolveMethod, "{\"params\":{\"filter\":\"t:Material\"}}", NULL, &result);
+    CHECK(Count(&result, "\"guid\":") == 1 && Contains(&result, "\"path\":\"Assets/Materials/Hero.mat\",\"type\":\"Material\""),
+        "t:Material: %s", (const char*)result.buf);
+    Call(AssetsResolveMethod, "{\"params\":{\"filter\":\"t:texture\"}}", NULL, &result);
+    CHECK(Count(&result, "\"guid\":") == 1 && Contains(&result, TEXTURE_GUID), "t:texture: %s", (const char*)result.buf);
+    Call(AssetsResolveMethod, "{\"params\":{\"filter\":\"l:character\"}}", NULL, &result);
+    CHECK(Count(&result, "\"guid\":") == 1 && Contains(&result, TEXTURE_GUID), "l:character: %s", (const char*)result.buf);
+    Call(AssetsResolveMethod, "{\"params\":{\"filter\":\"hero\"}}", NULL, &result);
+    CHECK(Count(&result, "\"guid\":") == 3 && Contains(&result, TEXTURE_GUID) && Contains(&result, PREFAB_GUID),
+        "Name filter: %s", (const char*)result.buf);
+
+    /* A ScriptableObject is typed after its script */
+    Call(AssetsResolveMethod, "{\"params\":{\"filter\":\"t:ScriptableObject\"}}", NULL, &result);
+    CHECK(Count(&result, "\"guid\":") == 1 && Contains(&result, "\"path\":\"Assets/Data/Balance.asset\",\"type\":\"Balance\""),
+        "ScriptableObject type: %s", (const char*)result.buf);
+
+    Call(AssetsResolveMethod, "{\"params\":{\"filter\":\"\",\"folders\":[\"Assets/Scripts\"]}}", NULL, &result);
+    CHECK(Count(&result, "\"guid\":") == 3 && Contains(&result, ENEMY_GUID) && !Contains(&result, TEXTURE_GUID),
+        "Folder filter: %s", (const char*)result.buf);
+
+    code = Call(AssetsResolveMethod, "{\"params\":{}}", NULL, &result);
+    CHECK(code == -32602, "No guids, paths or filter: %d %s", code, (const char*)result.buf);
+
+    mg_iobuf_free(&result);
+}
+
+static void TestReferences(void)
+{
+    struct mg_iobuf result = {0, 0, 0, 4096};
+    int code;
+
+    code = Call(ReferencesMethod, "{\"params\":{\"guid\":\"" TEXTURE_GUID "\"}}", "Hero.mat", &result);
+    CHECK(code == 0 && Contains(&result, "\"guid\":\"" TEXTURE_GUID "\",\"path\":\"Assets/Textures/Hero.png\"") &&
+        Contains(&result, "\"references\":[{\"path\":\"Assets/Materials/Hero.mat\",\"count\":2}]"),
+        "Texture users: %s", (const char*)result.buf);
+
+    /* By path, through the asset index; GUIDs in upper case */
+    Call(ReferencesMethod, "{\"params\":{\"path\":\"Assets/Materials/Hero.mat\"}}", "Hero.prefab", &result);
+    CHECK(Contains(&result, "\"references\":[{\"path\":\"Assets/Prefabs/Hero.prefab\",\"count\":1}]"),
+        "Material users: %s", (const char*)result.buf);
+    Call(ReferencesMethod, "{\"params\":{\"guid\":\"4F7D9B2C6A0E3D1FB8A5C9E0D1F2A3B4\"}}", "Balance.asset", &result);
+    CHECK(Contains(&result, "\"references\":[{\"path\":\"Assets/Data/Balance.asset\",\"count\":1}]"),
+        "Script users: %s", (const char*)result.buf);
+
+    code = Call(ReferencesMethod, "{\"params\":{\"guid\":\"" MISSING_GUID "\"}}", NULL, &result);
+    CHECK(code == 0 && Contains(&result, "\"references\":[]"), "Unused GUID: %s", (const char*)result.buf);
+    code = Call(ReferencesMethod, "{\"params\":{\"guid\":\"not-a-guid\"}}", NULL, &result);
+    CHECK(code == -32602, "Invalid GUID: %d %s", code, (const char*)result.buf);
+    code = Call(ReferencesMethod, "{\"params\":{}}", NULL, &result);
+    CHECK(code == -32602, "No guid or path: %d %s", code, (const char*)result.buf);
+
+    mg_iobuf_free(&result);
+}
+
+static void TestScenes(void)
+{
+    static const char* ESCAPES[] =
+    {
+        "../../tmp/outside.unity",
+        "Assets/../../outside.unity",
+        "Assets/Scenes/../../../outside.unity",
+        "Assets\\\\..\\\\..\\\\outside.unity",
+        "../outside.unity",
+        "/tmp/outside.unity",
+        "ProjectSettings/outside.unity",
+        "Assetsx/outside.unity",
+    };
+    struct mg_iobuf result = {0, 0, 0, 4096};
+    char request[1300];
+    int code;
+    int i;
+
+    code = Call(ScenesHierarchyMethod, "{\"params\":{\"path\":\"Assets/Scenes/Main.unity\"}}", "\"scripts\":{\"Player\":1}",
+        &result);
+    CHECK(code == 0 && Contains(&result, "\"objects\":2,\"components\":3,\"prefab_instances\":1") &&
+        Contains(&result, "{\"file_id\":\"100\",\"name\":\"Player\",\"active\":true,\"tag\":\"Player\",\"layer\":8,"
+            "\"components\":[\"Transform\",\"Player\"],\"children\":[{\"file_id\":\"200\",\"name\":\"Sword\",\"active\":false,") &&
+        Contains(&result, "{\"file_id\":\"300\",\"name\":\"Hero (1)\",\"prefab\":{\"guid\":\"" PREFAB_GUID "\","
+            "\"path\":\"Assets/Prefabs/Hero.prefab\"}"), "Scene hierarchy: %s", (const char*)result.buf);
+
+    Call(ScenesHierarchyMethod, "{\"params\":{\"path\":\"Assets/Scenes/Main.unity\",\"max_depth\":0}}", NULL, &result);
+    CHECK(Contains(&result, "\"child_count\":1") && !Contains(&result, "Sword"), "max_depth: %s", (const char*)result.buf);
+
+    Call(ScenesFindMethod, "{\"params\":{\"path\":\"Assets/Scenes/Main.unity\",\"name\":\"SWORD\"}}", NULL, &result);
+    CHECK(Contains(&result, "\"objects\":[{\"file_id\":\"200\",\"name\":\"Sword\",\"path\":\"Player/Sword\""),
+        "Find by name: %s", (const char*)result.buf);
+    Call(ScenesFindMethod, "{\"params\":{\"path\":\"Assets/Scenes/Main.unity\",\"component\":\"player\"}}", NULL, &result);
+    CHECK(Count(&result, "\"file_id\":") == 1 && Contains(&result, "\"name\":\"Player\""),
+        "Find by script: %s", (const char*)result.buf);
+
+    Call(ScenesObjectMethod, "{\"params\":{\"path\":\"Assets/Scenes/Main.unity\",\"file_id\":\"102\"}}", NULL, &result);
+    CHECK(Contains(&result, "\"script\":{\"guid\":\"" PLAYER_GUID "\",\"path\":\"Assets/Scripts/Player.cs\"}") &&
+        Contains(&result, "{\"field\":\"weapon\",\"file_id\":\"200\""), "Object references: %s", (const char*)result.buf);
+
+    Call(ScenesHierarchyMethod, "{\"params\":{\"path\":\"Assets\\\\Prefabs\\\\Hero.prefab\"}}", NULL, &result);
+    CHECK(Contains(&result, "\"name\":\"Hero\",\"active\":true,\"components\":[\"Transform\",\"MeshRenderer\",\"Player\"]"),
+        "Prefab hierarchy: %s", (const char*)result.buf);
+
+    code = Call(ScenesHierarchyMethod, "{\"params\":{\"path\":\"Assets/Scenes/Missing.unity\"}}", NULL, &result);
+    CHECK(code == -32602 && Contains(&result, "not found"), "Missing scene: %d %s", code, (const char*)result.buf);
+    code = Call(ScenesHierarchyMethod, "{\"params\":{\"path\":\"Assets/Scripts/Player.cs\"}}", NULL, &result);
+    CHECK(code == -32602, "Not a scene: %d %s", code, (const char*)result.buf);
+
+    /* Paths leaving the project are refused before anything is read */
+    for (i = 0; i < (int)(sizeof(ESCAPES) / sizeof(ESCAPES[0])); i++)
+    {
+        snprintf(request, sizeof(request), "{\"params\":{\"path\":\"%s\"}}", ESCAPES[i]);
+        code = Call(ScenesHierarchyMethod, request, NULL, &result);
+        CHECK(code == -32602 && !Contains(&result, "Outside"), "Path %s: %d %s", ESCAPES[i], code,
+            (const char*)result.buf);
+    }
+    snprintf(request, sizeof(request), "{\"params\":{\"path\":\"%s/../outside.unity\"}}", s_root);
+    code = Call(ScenesFindMethod, request, NULL, &result);
+    CHECK(code == -32602 && !Contains(&result, "Outside"), "Absolute path: %d %s", code, (const char*)result.buf);
+
+    CHECK(ProjectIsValidPath("Assets") && ProjectIsValidPath("Packages/com.company.tool/Runtime/a.cs") &&
+        ProjectIsValidPath("Assets/..hidden/x..y.unity"), "Valid paths refused");
+    CHECK(!ProjectIsValidPath("Assets/..") && !ProjectIsValidPath("Packages/../Assets") && !ProjectIsValidPath("") &&
+        !ProjectIsValidPath("Assets/a/..\\b"), "Invalid paths accepted");
+
+    mg_iobuf_free(&result);
+}
+
+static void TestSymbols(void)
+{
+    struct mg_iobuf result = {0, 0, 0, 4096};
+    int code;
+
+    /* Exact name first; both parts of a partial type */
+    code = Call(CodeSymbolsMethod, "{\"params\":{\"query\":\"player\"}}", "PlayerEditor.cs", &result);
+    CHECK(code == 0 && Count(&result, "\"kind\":\"class\"") == 2 &&
+        Contains(&result, "{\"name\":\"Player\",\"kind\":\"class\",\"container\":\"Game.Combat\","
+            "\"path\":\"Assets/Scripts/Player.cs\",\"line\":5,\"end_line\":13,\"modifiers\":[\"public\"],"
+            "\"signature\":\"public class Player : MonoBehaviour\"}") &&
+        Contains(&result, "\"modifiers\":[\"public\",\"partial\"]"), "Symbols by name: %s", (const char*)result.buf);
+
+    Call(CodeSymbolsMethod, "{\"params\":{\"query\":\"damage\",\"kind\":\"method\"}}", NULL, &result);
+    CHECK(Count(&result, "\"name\":") == 1 && Contains(&result, "\"name\":\"TakeDamage\",\"kind\":\"method\","
+        "\"container\":\"Game.Combat.Player\""), "Symbols by kind: %s", (const char*)result.buf);
+
+    /* Outline in file order; comments, strings and both preprocessor branches */
+    Call(CodeSymbolsMethod, "{\"params\":{\"path\":\"Assets/Scripts/Enemy.cs\"}}", NULL, &result);
+    CHECK(strstr((const char*)result.buf, "\"Enemy\"") < strstr((const char*)result.buf, "\"target\"") &&
+        strstr((const char*)result.buf, "\"target\"") < strstr((const char*)result.buf, "\"Attack\"") &&
+        Count(&result, "\"name\":") == 3, "Outline: %s", (const char*)result.buf);
+    Call(CodeSymbolsMethod, "{\"params\":{\"path\":\"Assets/Scripts/PlayerEditor.cs\"}}", NULL, &result);
+    CHECK(Contains(&result, "\"name\":\"Died\",\"kind\":\"event\"") && Contains(&result, "\"kind\":\"indexer\"") &&
+        Contains(&result, "\"name\":\"EditorOnly\"") && Contains(&result, "\"name\":\"RuntimeOnly\"") &&
+        Contains(&result, "\"name\":\"Ice\",\"kind\":\"enum_member\",\"container\":\"Game.Combat.DamageType\""),
+        "Declarations: %s", (const char*)result.buf);
+    CHECK(!Contains(&result, "CommentedOut") && !Contains(&result, "NotAType"),
+        "Comment or string read as code: %s", (const char*)result.buf);
+
+    Call(CodeDefinitionMethod, "{\"params\":{\"name\":\"Game.Combat.Player\"}}", NULL, &result);
+    CHECK(Count(&result, "\"kind\":\"class\"") == 2, "Qualified definition: %s", (const char*)result.buf);
+    Call(CodeDefinitionMethod, "{\"params\":{\"name\":\"Player.TakeDamage\",\"usages\":true}}", NULL, &result);
+    CHECK(Contains(&result, "\"definitions\":[{\"name\":\"TakeDamage\",\"kind\":\"method\",\"container\":\"Game.Combat.Player\","
+        "\"path\":\"Assets/Scripts/Player.cs\",\"line\":9,") &&
+        Contains(&result, "{\"path\":\"Assets/Scripts/Enemy.cs\",\"line\":8,\"text\":\"void Attack() { target.TakeDamage(25); }\"}") &&
+        Count(&result, "\"text\":") == 2, "Definition with usages: %s", (const char*)result.buf);
+    Call(CodeDefinitionMethod, "{\"params\":{\"name\":\"takedamage\"}}", NULL, &result);
+    CHECK(Count(&result, "\"kind\":\"method\"") == 1, "Case-insensitive fallback: %s", (const char*)result.buf);
+
+    code = Call(CodeDefinitionMethod, "{\"params\":{\"name\":\"NotAType\"}}", NULL, &result);
+    CHECK(code == 0 && Contains(&result, "\"definitions\":[]"), "Type inside a string: %s", (const char*)result.buf);
+    code = Call(CodeDefinitionMethod, "{\"params\":{}}", NULL, &result);
+    CHECK(code == -32602, "Missing name: %d %s", code, (const char*)result.buf);
+
+    mg_iobuf_free(&result);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+    {
+        printf("Usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    if (!WriteProject() || getcwd(s_root, sizeof(s_root) - 32) == NULL)
+    {
+        RemoveProject();
+        printf("Cannot create the test project\n");
+        return 1;
+    }
+    strcat(s_root, "/project_test_files/root");
+    ConfigureProjectRoot(s_root);
+
+    TestSearch();
+    TestAssets();
+    TestReferences();
+    TestScenes();
+    TestSymbols();
+
+    ConfigureProjectRoot("");
+    RemoveProject();
+
+    printf("%d checks, %d failed\n", s_checks, s_failures);
+    return s_failures == 0 ? 0 : 1;
+}
@@ -4,31 +4,34 @@
  * HTTP server plugin that survives Unity domain reloads.
  * Acts as a proxy between external MCP clients and Unity's C# code.
  *
- * When C# is unavailable (during recompile), it blocks until polling is re-activated.
- * When C# is available, it stores the request in a buffer and poll-waits for the response.
+ * Requests are queued on the server thread. While C# is unavailable (during
+ * recompile) they wait until polling is re-activated; otherwise the next one is
+ * stored in a buffer for C# to pick up, and answered once C# sends its response.
  *
  * License: GPLv2 (compatible with Mongoose library)
  */
 
 #include "proxy.h"
 #include "mongoose.h"
+#include "platform.h"
+#include "cache.h"
+#include "jsonutil.h"
+#include "spill.h"
+#include "blob.h"
+#include "staging.h"
+#include "project.h"
+#include "search.h"
+#include "watcher.h"
+#include "assets.h"
+#include "references.h"
+#include "scenes.h"
+#include "symbols.h"
+#include "editorlog.h"
+#include "base64.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-#ifdef _WIN32
-    #include <windows.h>
-    typedef HANDLE ThreadHandle;
-    #define PROXY_SLEEP_MS(ms) Sleep((DWORD)(ms))
-    #define GET_PROCESS_ID() ((unsigned long)GetCurrentProcessId())
-#else
-    #include <pthread.h>
-    #include <unistd.h>
-    typedef pthread_t ThreadHandle;
-    #define PROXY_SLEEP_MS(ms) usleep((ms) * 1000)
-    #define GET_PROCESS_ID() ((unsigned long)getpid())
-#endif
-
 /*
  * Internal state
  */
@@ -49,10 +52,55 @@ static int  s_tls_enabled = 0;
 static char s_request_buffer[PROXY_MAX_REQUEST_SIZE];
 static volatile int s_has_request = 0;
 
+/* Sequence number of the request handed to C#, and of the request the pending response answers */
+static int s_request_sequence = 0;
+static volatile int s_pending_sequence = 0;
+static volatile int s_response_sequence = 0;
+
+/* Spill file holding the pending request instead, or empty */
+static char s_request_path[1024] = "";
+
+/* mongoose's HTTP protocol handler, reattached after a streamed request body */
+static void (*s_http_handler)(struct mg_connection*, int, void*) = NULL;
+
 /* Response buffer for synchronous C# response */
 static char s_response_buffer[PROXY_MAX_RESPONSE_SIZE];
 static volatile int s_has_response = 0;
 
+/* Response handed over as a spill file instead of through the buffer */
+static SpillFile* volatile s_response_file = NULL;
+
+/*
+ * A client waiting for a queued request. Coalesced requests add waiters
+ * to an existing job instead of queueing a job of their own.
+ */
+typedef struct RequestWaiter
+{
+    unsigned long connection_id;
+    char request_id[256];
+    char if_none_match[CACHE_ETAG_SIZE];  /* ETag the client already has, or empty */
+    struct RequestWaiter* next;
+} RequestWaiter;
+
+typedef struct RequestJob
+{
+    char* body;
+    SpillFile* body_file;       /* Streamed body, instead of body */
+    size_t body_length;
+    CacheRequest cache_request;
+    RequestWaiter* waiters;     /* First waiter sent the request that C# executes */
+    int sequence;               /* Set when handed to C#; its response must carry it */
+    uint64_t queued_at;
+    uint64_t started_at;
+    struct RequestJob* next;
+} RequestJob;
+
+/* Requests waiting for C#, and the one C# is processing (server thread only) */
+static RequestJob* s_job_head = NULL;
+static RequestJob* s_job_tail = NULL;
+static RequestJob* s_active_job = NULL;
+static size_t s_job_count = 0;
+
 /* Flag set by DllMain/destructor to signal the server thread to exit and clean up */
 static volatile int s_unloading = 0;
 
@@ -76,9 +124,14 @@ static const char* ExtractJsonRpcId(const char* json, size_t json_len)
 
     while (pos < end)
     {
-        /* Find "id" key */
-        const char* found = strstr(pos, id_key);
-        if (found == NULL || found >= end)
+        /* Find "id" key; streamed bodies are mapped files without a terminator */
+        const char* found = pos;
+        while ((found = (const char*)memchr(found, '"', (size_t)(end - found))) != NULL &&
+               (end - found < 4 || memcmp(found, id_key, 4) != 0))
+        {
+            found++;
+        }
+        if (found == NULL || end - found < 4)
         {
             return "null";
         }
@@ -154,7 +207,7 @@ static const char* ExtractJsonRpcId(const char* json, size_t json_len)
             s_id_buffer[len] = '\0';
             return s_id_buffer;
         }
-        else if (strncmp(pos, "null", 4) == 0)
+        else if (end - pos >= 4 && strncmp(pos, "null", 4) == 0)
         {
             return "null";
         }
@@ -192,11 +245,159 @@ static const char* CORS_HEADERS_REMOTE =
     "Access-Control-Allow-Methods: POST, OPTIONS\r\n"
     "Access-Control-Allow-Headers: Content-Type, Authorization\r\n";
 
-static const char* GetCorsHeaders(void)
+/*
+ * Fast reply path. The status line and headers are prebuilt once per status
+ * and CORS mode, so a reply only formats its Content-Length. The send buffer
+ * is grown once to the exact size and the body parts are copied in bulk,
+ * rather than pushed one character at a time through mg_vxprintf as
+ * mg_http_reply() does. Server thread only.
+ */
+typedef struct ReplyHeader
+{
+    int status;
+    size_t length;
+    char text[320];  /* "HTTP/1.1 <status>\r\n<headers>Content-Length: " */
+} ReplyHeader;
+
+static const struct
+{
+    int status;
+    const char* reason;
+} REPLY_STATUSES[] = {
+    { 200, "OK" },
+    { 201, "Created" },
+    { 204, "No Content" },
+    { 400, "Bad Request" },
+    { 401, "Unauthorized" },
+    { 404, "Not Found" },
+    { 413, "Payload Too Large" },
+    { 500, "Internal Server Error" },
+    { 503, "Service Unavailable" },
+};
+#define REPLY_STATUS_COUNT (sizeof(REPLY_STATUSES) / sizeof(REPLY_STATUSES[0]))
+
+static ReplyHeader s_reply_headers[2][REPLY_STATUS_COUNT];  /* [remote mode][status] */
+static int s_reply_headers_ready = 0;
+
+static const ReplyHeader* GetReplyHeader(int status)
+{
+    size_t i;
+    if (!s_reply_headers_ready)
+    {
+        int remote;
+        for (remote = 0; remote < 2; remote++)
+        {
+            for (i = 0; i < REPLY_STATUS_COUNT; i++)
+            {
+                ReplyHeader* header = &s_reply_headers[remote][i];
+                header->status = REPLY_STATUSES[i].status;
+                header->length = (size_t)snprintf(header->text, sizeof(header->text),
+                    "HTTP/1.1 %d %s\r\n%sContent-Length: ", header->status,
+                    REPLY_STATUSES[i].reason,
+                    remote ? CORS_HEADERS_REMOTE : CORS_HEADERS_LOCAL);
+            }
+        }
+        s_reply_headers_ready = 1;
+    }
+
+    for (i = 0; i < REPLY_STATUS_COUNT; i++)
+    {
+        if (REPLY_STATUSES[i].status == status)
+        {
+            return &s_reply_headers[s_api_key[0] != '\0'][i];
+        }
+    }
+    return &s_reply_headers[s_api_key[0] != '\0'][0];
+}
+
+/*
+ * Write the reply headers for a body of body_length bytes, growing the send
+ * buffer once to also hold `reserve` bytes of body. Returns 0 (and closes the
+ * connection rather than send a truncated reply) if out of memory.
+ */
+static int WriteReplyHeader(struct mg_connection* connection, int status, size_t body_length, size_t reserve)
+{
+    const ReplyHeader* header = GetReplyHeader(status);
+    struct mg_iobuf* send = &connection->send;
+    char length_text[32];
+    size_t length_text_len;
+    size_t needed;
+
+    length_text_len = (size_t)snprintf(length_text, sizeof(length_text), "%lu\r\n\r\n",
+        (unsigned long)body_length);
+
+    /* Write straight into the send buffer: mg_send() would re-fit it on every append */
+    needed = send->len + header->length + length_text_len + reserve;
+    if (needed > send->size && !mg_iobuf_resize(send, needed))
+    {
+        connection->is_closing = 1;
+        return 0;
+    }
+    memcpy(send->buf + send->len, header->text, header->length);
+    send->len += header->length;
+    memcpy(send->buf + send->len, length_text, length_text_len);
+    send->len += length_text_len;
+    connection->is_resp = 0;
+    return 1;
+}
+
+/*
+ * Send a reply whose body is the concatenation of the given parts.
+ */
+static void SendReplyParts(struct mg_connection* connection, int status, const struct mg_str* parts, size_t count)
+{
+    struct mg_iobuf* send = &connection->send;
+    size_t body_length = 0;
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        body_length += parts[i].len;
+    }
+    if (!WriteReplyHeader(connection, status, body_length, body_length))
+    {
+        return;
+    }
+    for (i = 0; i < count; i++)
+    {
+        if (parts[i].len > 0)
+        {
+            memcpy(send->buf + send->len, parts[i].buf, parts[i].len);
+            send->len += parts[i].len;
+        }
+    }
+}
+
+static void SendReply(struct mg_connection* connection, int status, const char* body)
+{
+    struct mg_str part = mg_str(body);
+    SendReplyParts(connection, status, &part, 1);
+}
+
+/*
+ * Receive buffer presizing. When a request's headers arrive, MG_EV_HTTP_HDRS
+ * records where its body will end; on the following MG_EV_READ (after the
+ * HTTP handler is done with the buffer) the receive buffer is grown to that
+ * size in one step instead of MG_IO_SIZE at a time. The size is kept in the
+ * connection's user data area.
+ */
+static size_t GetExpectedRequestSize(const struct mg_connection* connection)
+{
+    size_t size;
+    memcpy(&size, connection->data, sizeof(size));
+    return size;
+}
+
+static void SetExpectedRequestSize(struct mg_connection* connection, size_t size)
 {
-    return (s_api_key[0] != '\0') ? CORS_HEADERS_REMOTE : CORS_HEADERS_LOCAL;
+    memcpy(connection->data, &size, sizeof(size));
 }
 
+static void PumpRequestQueue(void);
+static void PumpFileEvents(void);
+static void FailAllJobs(const char* message);
+static int GetPollTimeout(void);
+
 /*
  * Server thread function.
  * Polls the Mongoose event manager in a loop until s_running is cleared.
@@ -209,8 +410,12 @@ static DWORD WINAPI ServerThreadFunc(LPVOID param)
     (void)param;
     while (s_running)
     {
-        mg_mgr_poll(&s_mgr, 10);
+        mg_mgr_poll(&s_mgr, GetPollTimeout());
+        PumpRequestQueue();
+        PumpFileEvents();
     }
+    FailAllJobs("Server is shutting down.");
+    mg_mgr_poll(&s_mgr, 0);  /* Flush the error replies */
     /* If DLL is being unloaded, thread must clean up (StopServer can't wait from DllMain) */
     if (s_unloading)
     {
@@ -227,8 +432,12 @@ static void* ServerThreadFunc(void* param)
     (void)param;
     while (s_running)
     {
-        mg_mgr_poll(&s_mgr, 10);
+        mg_mgr_poll(&s_mgr, GetPollTimeout());
+        PumpRequestQueue();
+        PumpFileEvents();
     }
+    FailAllJobs("Server is shutting down.");
+    mg_mgr_poll(&s_mgr, 0);  /* Flush the error replies */
     /* If DLL is being unloaded, thread must clean up (StopServer can't wait from destructor) */
     if (s_unloading)
     {
@@ -242,312 +451,1334 @@ static void* ServerThreadFunc(void* param)
 #endif
 
 /*
- * Handle an incoming HTTP request.
+ * Request queue
  *
- * This function processes the HTTP request:
- * 1. CORS preflight (OPTIONS) -> 204 No Content
- * 2. Non-POST methods -> 405 Method Not Allowed
- * 3. Request too large -> 413 error
- * 4. If poller not active -> Block and poll until poller becomes active
- * 5. Copy request to buffer, set s_has_request, poll-wait for s_has_response
+ * Requests are queued on the server thread and handed to C# one at a time
+ * through s_request_buffer, so the event loop keeps serving other connections
+ * (and cache hits) while C# works. Identical read-only requests that arrive
+ * while one is queued or in flight attach to it as extra waiters: the call
+ * runs once and every waiter gets the response with its own JSON-RPC id.
  */
-static void HandleHttpRequest(struct mg_connection* connection, struct mg_http_message* http_message)
+static struct mg_connection* FindWaitingConnection(unsigned long connection_id)
 {
-    /* Handle CORS preflight request */
-    if (mg_strcmp(http_message->method, mg_str("OPTIONS")) == 0)
+    struct mg_connection* connection;
+    for (connection = s_mgr.conns; connection != NULL; connection = connection->next)
     {
-        mg_http_reply(connection, 204, GetCorsHeaders(), "");
-        return;
+        if (connection->id == connection_id)
+        {
+            return connection->is_closing ? NULL : connection;
+        }
     }
+    return NULL;  /* Client went away while waiting */
+}
 
-    /* Only allow POST method for JSON-RPC */
-    if (mg_strcmp(http_message->method, mg_str("POST")) != 0)
+static int ReplyToConnection(unsigned long connection_id, const char* json, size_t length, struct mg_str response_id, const char* request_id)
+{
+    struct mg_connection* connection = FindWaitingConnection(connection_id);
+    if (connection == NULL)
     {
-        mg_http_reply(connection, 405,
-            (s_api_key[0] != '\0')
-                ? "Content-Type: text/plain\r\n"
-                : "Content-Type: text/plain\r\nAccess-Control-Allow-Origin: *\r\n",
-            "Method Not Allowed. Use POST for JSON-RPC requests.");
-        return;
+        return 0;
     }
 
-    /* Validate API key if configured */
-    if (s_api_key[0] != '\0')
+    if (response_id.buf == NULL || mg_strcmp(response_id, mg_str(request_id)) == 0)
     {
-        struct mg_str *auth = mg_http_get_header(http_message, "Authorization");
-        size_t key_len = strlen(s_api_key);
-        int valid = 0;
-
-        if (auth != NULL && auth->len >= 7 + key_len &&
-            strncmp(auth->buf, "Bearer ", 7) == 0 &&
-            (auth->len - 7) == key_len)
-        {
-            /* Constant-time comparison to prevent timing attacks */
-            volatile unsigned char result = 0;
-            const char *a = auth->buf + 7;
-            const char *b = s_api_key;
-            size_t i;
-            for (i = 0; i < key_len; i++)
-            {
-                result |= (unsigned char)(a[i] ^ b[i]);
-            }
-            valid = (result == 0);
-        }
-
-        if (!valid)
-        {
-            mg_http_reply(connection, 401, GetCorsHeaders(),
-                "{\"jsonrpc\":\"2.0\",\"error\":{\"code\":-32000,"
-                "\"message\":\"Unauthorized: invalid or missing API key\"},\"id\":null}");
-            return;
-        }
+        struct mg_str part = mg_str_n(json, length);
+        SendReplyParts(connection, 200, &part, 1);
     }
-
-    /* Extract request body */
-    size_t body_length = http_message->body.len;
-    if (body_length == 0)
+    else
     {
-        mg_http_reply(connection, 400, GetCorsHeaders(),
-            "{\"jsonrpc\":\"2.0\",\"error\":{\"code\":-32700,"
-            "\"message\":\"Parse error: Empty request body.\"},\"id\":null}");
-        return;
+        /* Splice in this waiter's id: [json before id][request_id][json after id] */
+        size_t id_start = (size_t)(response_id.buf - json);
+        size_t id_end = id_start + response_id.len;
+        struct mg_str parts[3];
+        parts[0] = mg_str_n(json, id_start);
+        parts[1] = mg_str(request_id);
+        parts[2] = mg_str_n(json + id_end, length - id_end);
+        SendReplyParts(connection, 200, parts, 3);
     }
+    return 1;
+}
 
-    /* Reject requests larger than the buffer */
-    if (body_length >= PROXY_MAX_REQUEST_SIZE)
+static void FreeJob(RequestJob* job)
+{
+    RequestWaiter* waiter = job->waiters;
+    while (waiter != NULL)
     {
-        mg_http_reply(connection, 200, GetCorsHeaders(), "%s",
-            BuildErrorResponse(-32600, "Request too large", "null"));
-        return;
+        RequestWaiter* next = waiter->next;
+        free(waiter);
+        waiter = next;
     }
+    CacheRelease(&job->cache_request);
+    free(job->body);
+    SpillRelease(job->body_file);
+    free(job);
+}
 
-    /* Copy request body to static buffer (no malloc) */
-    memcpy(s_request_buffer, http_message->body.buf, body_length);
-    s_request_buffer[body_length] = '\0';
-
-    /* Extract the request ID for use in error responses */
-    const char* request_id = ExtractJsonRpcId(s_request_buffer, body_length);
+/*
+ * Send the same response to every waiter of a job, substituting ids.
+ * Waiters that already hold the response's ETag get "not modified" instead.
+ */
+static void CompleteJob(RequestJob* job, const char* json, size_t length, const char* etag)
+{
+    struct mg_str response_id = mg_str_n(NULL, 0);
+    RequestWaiter* waiter;
 
-    /* Block and poll until poller becomes active (handles domain reload) */
-    if (!s_poller_active)
+    if (job->waiters != NULL && job->waiters->next != NULL)
     {
-        uint64_t poll_start_time = mg_millis();
-        while (!s_poller_active)
-        {
-            uint64_t elapsed_time = mg_millis() - poll_start_time;
-            if (elapsed_time >= PROXY_REQUEST_TIMEOUT_MS)
-            {
-                mg_http_reply(connection, 200, GetCorsHeaders(), "%s",
-                    BuildErrorResponse(-32000, "Unity recompilation timed out.", request_id));
-                return;
-            }
-            if (!s_running)
-            {
-                mg_http_reply(connection, 200, GetCorsHeaders(), "%s",
-                    BuildErrorResponse(-32000, "Server is shutting down.", request_id));
-                return;
-            }
-            PROXY_SLEEP_MS(PROXY_RECOMPILE_POLL_INTERVAL_MS);
-        }
+        JsonFindMember(mg_str_n(json, length), "id", &response_id);
     }
-
-    /* Clear response state and signal request available */
-    s_has_response = 0;
-    s_response_buffer[0] = '\0';
-    s_has_request = 1;
-
-    /* Poll-wait for C# to process the request and call SendResponse() */
+    for (waiter = job->waiters; waiter != NULL; waiter = waiter->next)
     {
-        uint64_t wait_start_time = mg_millis();
-        while (!s_has_response)
+        if (etag[0] != '\0' && strcmp(waiter->if_none_match, etag) == 0)
         {
-            uint64_t elapsed_time = mg_millis() - wait_start_time;
-            if (elapsed_time >= PROXY_REQUEST_TIMEOUT_MS)
-            {
-                s_has_request = 0;
-                mg_http_reply(connection, 200, GetCorsHeaders(), "%s",
-                    BuildErrorResponse(-32000, "Request processing timed out.", request_id));
-                return;
-            }
-            if (!s_running)
-            {
-                s_has_request = 0;
-                mg_http_reply(connection, 200, GetCorsHeaders(), "%s",
-                    BuildErrorResponse(-32000, "Server is shutting down.", request_id));
-                return;
-            }
-            if (!s_poller_active)
+            size_t not_modified_length = 0;
+            char* not_modified = CacheNotModifiedResponse(etag, waiter->request_id, &not_modified_length);
+            if (not_modified != NULL)
             {
-                s_has_request = 0;
-                mg_http_reply(connection, 200, GetCorsHeaders(), "%s",
-                    BuildErrorResponse(-32000, "Request interrupted by Unity domain reload. Please retry.", request_id));
-                return;
+                ReplyToConnection(waiter->connection_id, not_modified, not_modified_length,
+                    mg_str_n(NULL, 0), waiter->request_id);
+                free(not_modified);
+                continue;
             }
-            PROXY_SLEEP_MS(1);
         }
+        ReplyToConnection(waiter->connection_id, json, length,
+            waiter == job->waiters ? mg_str_n(NULL, 0) : response_id, waiter->request_id);
     }
-
-    /* Send the response */
-    s_has_request = 0;
-    mg_http_reply(connection, 200, GetCorsHeaders(), "%s", s_response_buffer);
 }
 
 /*
- * Mongoose event handler for all connection events.
+ * Stream a spilled response to every waiter of a job, substituting ids.
+ * Spilled responses are neither cached nor tagged.
  */
-static void EventHandler(struct mg_connection* connection, int event, void* event_data)
+static void CompleteJobFromFile(RequestJob* job, SpillFile* file)
 {
-    if (event == MG_EV_ACCEPT && s_tls_enabled)
+    struct mg_str contents = SpillContents(file);
+    struct mg_str response_id = mg_str_n(NULL, 0);
+    RequestWaiter* waiter;
+
+    if (job->waiters != NULL && job->waiters->next != NULL)
     {
-        struct mg_tls_opts opts;
-        memset(&opts, 0, sizeof(opts));
-        opts.cert = mg_str(s_tls_cert);
-        opts.key = mg_str(s_tls_key);
-        mg_tls_init(connection, &opts);
+        JsonFindMember(contents, "id", &response_id);
     }
-    else if (event == MG_EV_HTTP_MSG)
+    for (waiter = job->waiters; waiter != NULL; waiter = waiter->next)
     {
-        struct mg_http_message* http_message = (struct mg_http_message*)event_data;
-        HandleHttpRequest(connection, http_message);
+        struct mg_connection* connection = FindWaitingConnection(waiter->connection_id);
+        struct mg_str replacement = mg_str_n(NULL, 0);
+        size_t cut_start = 0;
+        size_t cut_end = 0;
+        size_t length = contents.len;
+
+        if (connection == NULL)
+        {
+            continue;
+        }
+        if (waiter != job->waiters && response_id.buf != NULL &&
+            mg_strcmp(response_id, mg_str(waiter->request_id)) != 0)
+        {
+            replacement = mg_str(waiter->request_id);
+            cut_start = (size_t)(response_id.buf - contents.buf);
+            cut_end = cut_start + response_id.len;
+            length = length - response_id.len + replacement.len;
+        }
+        if (WriteReplyHeader(connection, 200, length, 0) &&
+            !SpillStreamStart(connection, file, cut_start, cut_end, replacement))
+        {
+            connection->is_closing = 1;
+        }
     }
 }
 
 /*
- * Start the HTTP server on the specified port.
+ * Answer every waiter of a job with a JSON-RPC error.
  */
-EXPORT int StartServer(int port)
+static void FailJob(RequestJob* job, const char* message)
 {
-    if (s_running)
-    {
-        return 1;  /* Already running */
-    }
-
-    /* Clean up stale state from a previous crash or unclean shutdown.
-     * If s_listener is non-NULL but s_running is 0, the previous session
-     * didn't fully clean up (e.g., DllMain's 100ms sleep wasn't enough). */
-    if (s_listener != NULL)
+    RequestWaiter* waiter;
+    for (waiter = job->waiters; waiter != NULL; waiter = waiter->next)
     {
-        mg_mgr_free(&s_mgr);
-        s_listener = NULL;
+        const char* error = BuildErrorResponse(-32000, message, waiter->request_id);
+        ReplyToConnection(waiter->connection_id, error, strlen(error), mg_str_n(NULL, 0), waiter->request_id);
     }
-
-    /* Reset unload flag */
-    s_unloading = 0;
-
-    /* Initialize the event manager */
-    mg_mgr_init(&s_mgr);
-
-    /* Build the listen address string */
-    char listen_address[128];
-    if (s_tls_enabled && s_tls_cert[0] && s_tls_key[0])
-        snprintf(listen_address, sizeof(listen_address), "https://%s:%d", s_bind_address, port);
-    else
-        snprintf(listen_address, sizeof(listen_address), "http://%s:%d", s_bind_address, port);
-
-    /* Start listening for HTTP connections */
-    s_listener = mg_http_listen(&s_mgr, listen_address, EventHandler, NULL);
-    if (s_listener == NULL)
+    if (job->cache_request.cache_class == CACHE_CLASS_MUTATING)
     {
-        mg_mgr_free(&s_mgr);
-        return -1;  /* Failed to bind to port */
+        /* It may have partially run */
+        CacheInvalidateAll();
     }
+}
 
-    /* Set running flag before creating thread */
-    s_running = 1;
-
-    /* Create the server thread */
-#ifdef _WIN32
-    s_server_thread = CreateThread(NULL, 0, ServerThreadFunc, NULL, 0, NULL);
-    if (s_server_thread == NULL)
+static void EnqueueJob(RequestJob* job)
+{
+    job->next = NULL;
+    if (s_job_tail != NULL)
     {
-        s_running = 0;
-        mg_mgr_free(&s_mgr);
-        return -1;  /* Failed to create thread */
+        s_job_tail->next = job;
     }
-#else
-    if (pthread_create(&s_server_thread, NULL, ServerThreadFunc, NULL) != 0)
+    else
     {
-        s_running = 0;
-        mg_mgr_free(&s_mgr);
-        return -1;  /* Failed to create thread */
+        s_job_head = job;
     }
-#endif
-
-    return 0;
+    s_job_tail = job;
+    s_job_count++;
 }
 
-/*
- * Stop the HTTP server and release resources.
- */
-EXPORT void StopServer(void)
+static RequestJob* DequeueJob(void)
 {
-    if (!s_running)
-    {
-        return;
-    }
-
-    /* Signal the thread to stop */
-    s_running = 0;
-
-    /* Wait for the server thread to exit */
-#ifdef _WIN32
-    if (s_server_thread != NULL)
+    RequestJob* job = s_job_head;
+    if (job != NULL)
     {
-        WaitForSingleObject(s_server_thread, INFINITE);
-        CloseHandle(s_server_thread);
-        s_server_thread = NULL;
+        s_job_head = job->next;
+        if (s_job_head == NULL)
+        {
+            s_job_tail = NULL;
+        }
+        job->next = NULL;
+        s_job_count--;
     }
-#else
-    pthread_join(s_server_thread, NULL);
-#endif
-
-    s_listener = NULL;
-    s_poller_active = 0;
-    s_has_request = 0;
-
-    mg_mgr_free(&s_mgr);
+    return job;
 }
 
 /*
- * Activate or deactivate C# polling.
+ * Find a queued or in-flight job that an identical read-only request can
+ * join. Jobs queued before a mutating request are not eligible, since the
+ * new request must observe that mutation.
  */
-EXPORT void SetPollingActive(int active)
+static RequestJob* FindCoalescableJob(const CacheRequest* request)
 {
-    s_poller_active = active ? 1 : 0;
+    RequestJob* candidate = NULL;
+    RequestJob* job;
 
-    if (!active)
+    if (request->key == NULL || request->cache_class == CACHE_CLASS_MUTATING)
     {
-        /* Clear response state when deactivating */
-        s_has_response = 0;
-        s_response_buffer[0] = '\0';
+        return NULL;
+    }
+    if (s_active_job != NULL && CacheSameRequest(&s_active_job->cache_request, request))
+    {
+        candidate = s_active_job;
+    }
+    for (job = s_job_head; job != NULL; job = job->next)
+    {
+        if (job->cache_request.cache_class == CACHE_CLASS_MUTATING)
+        {
+            candidate = NULL;
+        }
+        else if (candidate == NULL && CacheSameRequest(&job->cache_request, request))
+        {
+            candidate = job;
+        }
     }
+    return candidate;
 }
 
 /*
- * Get the pending request body, if any.
+ * Drop a spilled response nobody is waiting for any more (its request
+ * timed out or was interrupted before C# handed it over).
  */
-EXPORT const char* GetPendingRequest(void)
+static void DiscardResponseFile(void)
 {
-    if (s_has_request)
+    SpillFile* file = s_response_file;
+    if (file != NULL)
     {
-        return s_request_buffer;
+        s_response_file = NULL;
+        SpillRelease(file);
     }
-    return NULL;
 }
 
 /*
- * Send a response back to the waiting HTTP request.
- * Note: Response size validation is handled by the C# layer which has access
- * to the request ID for proper JSON-RPC error responses.
+ * Advance the request queue. Called on the server thread after every poll:
+ * completes or times out the in-flight request, then hands the next queued
+ * request to C# once polling is active.
  */
-EXPORT void SendResponse(const char* json)
+static void PumpRequestQueue(void)
 {
-    if (json == NULL)
-    {
-        return;
-    }
+    uint64_t now = mg_millis();
 
-    size_t json_length = strlen(json);
+    if (s_active_job != NULL)
+    {
+        const char* failure = NULL;
+        if (s_has_response && s_response_sequence != s_active_job->sequence)
+        {
+            /* A late answer to a request that already failed: the current one is still unanswered */
+            DiscardResponseFile();
+            s_has_response = 0;
+            s_response_buffer[0] = '\0';
+            s_has_request = 1;
+        }
+        if (s_has_response && s_response_file != NULL)
+        {
+            if (s_active_job->cache_request.cache_class == CACHE_CLASS_MUTATING)
+            {
+                CacheInvalidateAll();
+            }
+            CompleteJobFromFile(s_active_job, s_response_file);
+            SpillRelease(s_response_file);
+            s_response_file = NULL;
+        }
+        else if (s_has_response && !Base64PayloadsReady() &&
+                 now - s_active_job->started_at < PROXY_REQUEST_TIMEOUT_MS)
+        {
+            return;  /* Attached images are still being encoded */
+        }
+        else if (s_has_response)
+        {
+            const char* response = s_response_buffer;
+            size_t length = strlen(s_response_buffer);
+            size_t expanded_length = 0;
+            size_t tagged_length = 0;
+            char etag[CACHE_ETAG_SIZE] = "";
+            char* expanded = Base64ExpandPayloads(response, length, &expanded_length);
+            char* tagged;
+            if (expanded != NULL)
+            {
+                response = expanded;
+                length = expanded_length;
+            }
+            tagged = CacheTagResponse(&s_active_job->cache_request, response, length, etag, &tagged_length);
+            if (tagged != NULL)
+            {
+                response = tagged;
+                length = tagged_length;
+            }
+
+            if (s_active_job->cache_request.cache_class == CACHE_CLASS_MUTATING)
+            {
+                CacheInvalidateAll();
+            }
+            else
+            {
+                CacheStore(&s_active_job->cache_request, response, length);
+            }
+            CompleteJob(s_active_job, response, length, etag);
+            free(tagged);
+            free(expanded);
+        }
+        else if (!s_poller_active)
+        {
+            failure = "Request interrupted by Unity domain reload. Please retry.";
+        }
+        else if (now - s_active_job->started_at >= PROXY_REQUEST_TIMEOUT_MS)
+        {
+            failure = "Request processing timed out.";
+        }
+        else
+        {
+            return;  /* Still running in C# */
+        }
+
+        if (failure != NULL)
+        {
+            FailJob(s_active_job, failure);
+        }
+        s_has_request = 0;
+        s_pending_sequence = 0;
+        FreeJob(s_active_job);
+        s_active_job = NULL;
+    }
+
+    if (!s_poller_active)
+    {
+        /* Domain reload: keep requests queued until C# is back, up to the timeout */
+        while (s_job_head != NULL && now - s_job_head->queued_at >= PROXY_REQUEST_TIMEOUT_MS)
+        {
+            RequestJob* job = DequeueJob();
+            FailJob(job, "Unity recompilation timed out.");
+            FreeJob(job);
+        }
+        return;
+    }
+
+    if (s_job_head != NULL)
+    {
+        s_active_job = DequeueJob();
+        s_active_job->started_at = now;
+        s_request_sequence = s_request_sequence < 0x7fffffff ? s_request_sequence + 1 : 1;
+        s_active_job->sequence = s_request_sequence;
+        if (s_active_job->body_file != NULL)
+        {
+            s_request_buffer[0] = '\0';
+            snprintf(s_request_path, sizeof(s_request_path), "%s", SpillPath(s_active_job->body_file));
+        }
+        else
+        {
+            memcpy(s_request_buffer, s_active_job->body, s_active_job->body_length + 1);
+            s_request_path[0] = '\0';
+        }
+        DiscardResponseFile();
+        Base64DiscardPayloads();
+        s_has_response = 0;
+        s_response_buffer[0] = '\0';
+        s_pending_sequence = s_active_job->sequence;
+        s_has_request = 1;
+    }
+}
+
+/*
+ * Fail every queued and in-flight request (server shutdown).
+ */
+static void FailAllJobs(const char* message)
+{
+    RequestJob* job;
+    if (s_active_job != NULL)
+    {
+        FailJob(s_active_job, message);
+        FreeJob(s_active_job);
+        s_active_job = NULL;
+    }
+    while ((job = DequeueJob()) != NULL)
+    {
+        FailJob(job, message);
+        FreeJob(job);
+    }
+    DiscardResponseFile();
+    Base64DiscardPayloads();
+    s_has_request = 0;
+    s_pending_sequence = 0;
+}
+
+/*
+ * Poll quickly while C# owes a response, and at the recompile interval
+ * while requests wait for a domain reload to finish.
+ */
+static int GetPollTimeout(void)
+{
+    if (s_active_job != NULL || SpillStreamsActive())
+    {
+        return 1;
+    }
+    if (s_job_head != NULL)
+    {
+        return s_poller_active ? 1 : PROXY_RECOMPILE_POLL_INTERVAL_MS;
+    }
+    return 10;
+}
+
+static const char* UNAUTHORIZED_RESPONSE =
+    "{\"jsonrpc\":\"2.0\",\"error\":{\"code\":-32000,"
+    "\"message\":\"Unauthorized: invalid or missing API key\"},\"id\":null}";
+
+/*
+ * Validate the bearer token if an API key is configured.
+ */
+static int IsAuthorized(struct mg_http_message* http_message)
+{
+    struct mg_str *auth;
+    size_t key_len;
+    int valid = 0;
+
+    if (s_api_key[0] == '\0')
+    {
+        return 1;
+    }
+
+    auth = mg_http_get_header(http_message, "Authorization");
+    key_len = strlen(s_api_key);
+    if (auth != NULL && auth->len >= 7 + key_len &&
+        strncmp(auth->buf, "Bearer ", 7) == 0 &&
+        (auth->len - 7) == key_len)
+    {
+        /* Constant-time comparison to prevent timing attacks */
+        volatile unsigned char result = 0;
+        const char *a = auth->buf + 7;
+        const char *b = s_api_key;
+        size_t i;
+        for (i = 0; i < key_len; i++)
+        {
+            result |= (unsigned char)(a[i] ^ b[i]);
+        }
+        valid = (result == 0);
+    }
+    return valid;
+}
+
+/*
+ * Serve GET /blob/<id>: the raw bytes stored with StoreBlob().
+ */
+static void HandleBlobRequest(struct mg_connection* connection, struct mg_str id)
+{
+    struct mg_iobuf* send = &connection->send;
+    Blob* blob = BlobAcquire(id);
+    struct mg_str data;
+    char header[256];
+    size_t header_len;
+
+    if (blob == NULL)
+    {
+        SendReply(connection, 404, "{\"error\":\"Blob not found or expired\"}");
+        return;
+    }
+
+    data = BlobData(blob);
+    header_len = (size_t)snprintf(header, sizeof(header),
+        "HTTP/1.1 200 OK\r\nContent-Type: %s\r\n%sCache-Control: no-store\r\nContent-Length: %lu\r\n\r\n",
+        BlobMimeType(blob), (s_api_key[0] != '\0') ? "" : "Access-Control-Allow-Origin: *\r\n",
+        (unsigned long)data.len);
+    if (header_len >= sizeof(header) ||
+        (send->len + header_len + data.len > send->size && !mg_iobuf_resize(send, send->len + header_len + data.len)))
+    {
+        connection->is_closing = 1;
+        BlobRelease(blob);
+        return;
+    }
+    memcpy(send->buf + send->len, header, header_len);
+    send->len += header_len;
+    if (data.len > 0)
+    {
+        memcpy(send->buf + send->len, data.buf, data.len);
+        send->len += data.len;
+    }
+    connection->is_resp = 0;
+    BlobRelease(blob);
+}
+
+/*
+ * True for the upload endpoint, POST /blob.
+ */
+static int IsBlobUpload(const struct mg_http_message* http_message)
+{
+    return mg_strcmp(http_message->method, mg_str("POST")) == 0 &&
+        (mg_strcmp(http_message->uri, mg_str("/blob")) == 0 || mg_strcmp(http_message->uri, mg_str(BLOB_URL_PREFIX)) == 0);
+}
+
+/*
+ * Serve POST /blob: store the body for a later tool call and answer with
+ * its id.
+ */
+static void HandleBlobUpload(struct mg_connection* connection, struct mg_http_message* http_message)
+{
+    struct mg_str* content_type = mg_http_get_header(http_message, "Content-Type");
+    char id[BLOB_ID_LENGTH + 1];
+    char mime_type[96];
+    char reply[160];
+
+    mime_type[0] = '\0';
+    if (content_type != NULL && content_type->len < sizeof(mime_type))
+    {
+        memcpy(mime_type, content_type->buf, content_type->len);
+        mime_type[content_type->len] = '\0';
+    }
+    if (!BlobPut((const unsigned char*)http_message->body.buf, http_message->body.len, mime_type,
+            BLOB_DEFAULT_TTL_MS, id))
+    {
+        SendReply(connection, 413, "{\"error\":\"Blob too large or out of memory\"}");
+        return;
+    }
+    snprintf(reply, sizeof(reply), "{\"id\":\"%s\",\"url\":\"" BLOB_URL_PREFIX "%s\",\"size\":%lu}",
+        id, id, (unsigned long)http_message->body.len);
+    SendReply(connection, 201, reply);
+}
+
+/*
+ * True for the file staging endpoint, POST /upload.
+ */
+static int IsStagedUpload(const struct mg_http_message* http_message)
+{
+    return mg_strcmp(http_message->method, mg_str("POST")) == 0 &&
+        (mg_strcmp(http_message->uri, mg_str("/upload")) == 0 || mg_strcmp(http_message->uri, mg_str("/upload/")) == 0);
+}
+
+/*
+ * Serve POST /upload: write each file part of a multipart/form-data body to
+ * the staging directory and answer with the upload ids.
+ */
+static void HandleStagedUpload(struct mg_connection* connection, struct mg_http_message* http_message)
+{
+    struct mg_str* content_type = mg_http_get_header(http_message, "Content-Type");
+    char reply[STAGING_MAX_PARTS * 256 + 32];
+    int staged;
+
+    if (content_type == NULL || content_type->len < 19 ||
+        mg_strcasecmp(mg_str_n(content_type->buf, 19), mg_str("multipart/form-data")) != 0)
+    {
+        SendReply(connection, 400, "{\"error\":\"Expected multipart/form-data\"}");
+        return;
+    }
+    staged = StageMultipart(http_message->body, reply, sizeof(reply));
+    if (staged > 0)
+    {
+        SendReply(connection, 201, reply);
+    }
+    else if (staged == 0)
+    {
+        SendReply(connection, 400, "{\"error\":\"No file parts in upload\"}");
+    }
+    else
+    {
+        SendReply(connection, 500, "{\"error\":\"Could not stage upload\"}");
+    }
+}
+
+/*
+ * JSON-RPC methods answered natively from the project indexes (see
+ * project.h), on the server thread and whether or not C# is polling.
+ */
+static const struct
+{
+    const char* method;
+    ProjectMethod handler;
+} PROJECT_METHODS[] = {
+    { "search/files", SearchFilesMethod },
+    { "files/changes", FileChangesMethod },
+    { "assets/resolve", AssetsResolveMethod },
+    { "assets/references", ReferencesMethod },
+    { "scenes/hierarchy", ScenesHierarchyMethod },
+    { "scenes/find", ScenesFindMethod },
+    { "scenes/object", ScenesObjectMethod },
+    { "code/symbols", CodeSymbolsMethod },
+    { "code/definition", CodeDefinitionMethod },
+    { "console/read", ConsoleReadMethod },
+};
+
+/*
+ * Answer the request if it calls a project method. Returns 0 otherwise.
+ */
+static int HandleProjectMethod(struct mg_connection* connection, struct mg_str body, const char* request_id)
+{
+    struct mg_str method;
+    size_t i;
+
+    if (!JsonFindMember(body, "method", &method))
+    {
+        return 0;
+    }
+    method = JsonStringContents(method);
+    for (i = 0; i < sizeof(PROJECT_METHODS) / sizeof(PROJECT_METHODS[0]); i++)
+    {
+        if (mg_strcmp(method, mg_str(PROJECT_METHODS[i].method)) == 0)
+        {
+            struct mg_iobuf result = {0, 0, 0, 4096};
+            const char* error = "Internal error";
+            int code = PROJECT_METHODS[i].handler(body, &result, &error);
+
+            if (code != 0)
+            {
+                SendReply(connection, 200, BuildErrorResponse(code, error, request_id));
+            }
+            else
+            {
+                struct mg_str parts[5];
+                parts[0] = mg_str("{\"jsonrpc\":\"2.0\",\"id\":");
+                parts[1] = mg_str(request_id);
+                parts[2] = mg_str(",\"result\":");
+                parts[3] = mg_str_n((const char*)result.buf, result.len);
+                parts[4] = mg_str("}");
+                SendReplyParts(connection, 200, parts, 5);
+            }
+            mg_iobuf_free(&result);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * While C# is not polling, answer resources/read of console://errors from
+ * the editor log (see editorlog.h). Returns 0 for other requests, or if no
+ * log is followed.
+ */
+static int HandleConsoleFallback(struct mg_connection* connection, struct mg_str body, const char* request_id)
+{
+    static const char HEAD[] = "{\"contents\":[{\"uri\":\"console://errors\",\"mimeType\":\"application/json\",\"text\":";
+    struct mg_str method, params, uri;
+    struct mg_iobuf text = {0, 0, 0, 4096};
+    struct mg_iobuf result = {0, 0, 0, 4096};
+    struct mg_str parts[5];
+
+    if (s_poller_active || !JsonFindMember(body, "method", &method) ||
+        mg_strcmp(JsonStringContents(method), mg_str("resources/read")) != 0 ||
+        !JsonFindMember(body, "params", &params) || !JsonFindMember(params, "uri", &uri) ||
+        mg_strcmp(JsonStringContents(uri), mg_str("console://errors")) != 0)
+    {
+        return 0;
+    }
+    if (!EditorLogReadErrors(&text))
+    {
+        mg_iobuf_free(&text);
+        return 0;
+    }
+    mg_iobuf_add(&result, 0, HEAD, sizeof(HEAD) - 1);
+    JsonAppendString(&result, (const char*)text.buf, text.len);
+    mg_iobuf_add(&result, result.len, "}]}", 3);
+
+    parts[0] = mg_str("{\"jsonrpc\":\"2.0\",\"id\":");
+    parts[1] = mg_str(request_id);
+    parts[2] = mg_str(",\"result\":");
+    parts[3] = mg_str_n((const char*)result.buf, result.len);
+    parts[4] = mg_str("}");
+    SendReplyParts(connection, 200, parts, 5);
+    mg_iobuf_free(&text);
+    mg_iobuf_free(&result);
+    return 1;
+}
+
+/*
+ * File change stream, GET /events: Server-Sent Events carrying the file
+ * watcher's batches (see watcher.h). A "hello" event names the project
+ * root, its package mounts, the watch mode and the starting cursor; every batch then arrives as
+ * a "changes" event holding what GetFileChanges() returns. "?cursor=N"
+ * resumes after N. Idle streams get a comment line every
+ * PROXY_EVENT_KEEPALIVE_MS so clients notice a dead connection.
+ */
+typedef struct EventSubscriber
+{
+    unsigned long connection_id;
+    int64_t cursor;
+    uint64_t last_sent;
+} EventSubscriber;
+
+static EventSubscriber s_event_subscribers[PROXY_MAX_EVENT_SUBSCRIBERS];
+static int s_event_subscriber_count = 0;
+
+static int IsEventStream(struct mg_http_message* http_message)
+{
+    return mg_strcmp(http_message->method, mg_str("GET")) == 0 &&
+        (mg_strcmp(http_message->uri, mg_str("/events")) == 0 || mg_strcmp(http_message->uri, mg_str("/events/")) == 0);
+}
+
+static void SendEvent(struct mg_connection* connection, const char* name, const void* data, size_t length)
+{
+    mg_printf(connection, "event: %s\ndata: ", name);
+    mg_send(connection, data, length);
+    mg_send(connection, "\n\n", 2);
+}
+
+static void HandleEventStream(struct mg_connection* connection, struct mg_http_message* http_message)
+{
+    EventSubscriber* subscriber;
+    struct mg_iobuf hello = {0, 0, 0, 256};
+    char root[PROJECT_MAX_PATH];
+    char text[64];
+    int64_t cursor = WatcherCursor();
+
+    if (s_event_subscriber_count == PROXY_MAX_EVENT_SUBSCRIBERS)
+    {
+        SendReply(connection, 503, "{\"error\":\"Too many event stream subscribers\"}");
+        return;
+    }
+    if (mg_http_get_var(&http_message->query, "cursor", text, sizeof(text)) > 0)
+    {
+        cursor = (int64_t)strtoll(text, NULL, 10);
+    }
+
+    mg_printf(connection, "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-store\r\n%s\r\n",
+        (s_api_key[0] != '\0') ? "" : "Access-Control-Allow-Origin: *\r\n");
+    /* is_resp stays set: the response never ends, and clearing it would let
+     * mongoose honor "Connection: close" right after the hello event */
+
+    ProjectRoot(root, sizeof(root));
+    mg_iobuf_add(&hello, 0, "{\"root\":", 8);
+    JsonAppendString(&hello, root, strlen(root));
+    mg_iobuf_add(&hello, hello.len, ",\"packages\":", 12);
+    ProjectFormatPackages(&hello);
+    snprintf(text, sizeof(text), ",\"cursor\":%lld,\"mode\":\"%s\"}", (long long)cursor,
+        WatcherModeName(WatcherMode()));
+    mg_iobuf_add(&hello, hello.len, text, strlen(text));
+    SendEvent(connection, "hello", hello.buf, hello.len);
+    mg_iobuf_free(&hello);
+
+    subscriber = &s_event_subscribers[s_event_subscriber_count++];
+    subscriber->connection_id = connection->id;
+    subscriber->cursor = cursor;
+    subscriber->last_sent = mg_millis();
+}
+
+/*
+ * Send new change batches to the event stream subscribers. Runs on the
+ * server thread after every poll.
+ */
+static void PumpFileEvents(void)
+{
+    int64_t latest;
+    uint64_t now;
+    int i;
+
+    if (s_event_subscriber_count == 0)
+    {
+        return;
+    }
+    latest = WatcherCursor();
+    now = mg_millis();
+    for (i = 0; i < s_event_subscriber_count; i++)
+    {
+        EventSubscriber* subscriber = &s_event_subscribers[i];
+        struct mg_connection* connection = FindWaitingConnection(subscriber->connection_id);
+
+        if (connection != NULL && connection->send.len > PROXY_MAX_EVENT_BACKLOG)
+        {
+            connection->is_closing = 1;  /* Not reading: it would miss batches anyway */
+            connection = NULL;
+        }
+        if (connection == NULL)
+        {
+            s_event_subscribers[i--] = s_event_subscribers[--s_event_subscriber_count];
+            continue;
+        }
+        if (subscriber->cursor != latest)
+        {
+            struct mg_iobuf changes = {0, 0, 0, 1024};
+            subscriber->cursor = WatcherFormatChanges(subscriber->cursor, &changes);
+            SendEvent(connection, "changes", changes.buf, changes.len);
+            mg_iobuf_free(&changes);
+            subscriber->last_sent = now;
+        }
+        else if (now - subscriber->last_sent >= PROXY_EVENT_KEEPALIVE_MS)
+        {
+            mg_send(connection, ": keepalive\n\n", 13);
+            subscriber->last_sent = now;
+        }
+    }
+}
+
+/*
+ * Handle an incoming HTTP request.
+ *
+ * This function processes the HTTP request:
+ * 1. CORS preflight (OPTIONS) -> 204 No Content
+ * 2. GET /blob/<id> -> raw bytes from the blob table (404 once expired)
+ * 3. GET /events -> file change stream (Server-Sent Events)
+ * 4. POST /blob -> store the body as a blob, 201 with its id
+ * 5. POST /upload -> stage multipart file parts, 201 with their upload ids
+ * 6. Other non-POST methods -> 405 Method Not Allowed
+ * 7. Request too large for the request buffer and not streamed -> error
+ * 8. Project method (search/files, files/changes, assets/resolve, ...) -> answered natively
+ * 9. console://errors while C# is not polling -> answered from the editor log
+ * 10. Cached read-only request -> answer from the response cache
+ *    (resources/read whose ifNoneMatch equals the current ETag -> "not modified")
+ * 11. Identical read-only request already queued or running -> wait for its response
+ * 12. Otherwise queue it; PumpRequestQueue() hands it to C# (once polling is
+ *    active) and replies when SendResponse() is called
+ *
+ * body_file is set for bodies streamed to a spill file (http_message->body
+ * is then its mapping); a queued job keeps a reference to it.
+ */
+static void HandleHttpRequest(struct mg_connection* connection, struct mg_http_message* http_message,
+    SpillFile* body_file)
+{
+    /* Handle CORS preflight request */
+    if (mg_strcmp(http_message->method, mg_str("OPTIONS")) == 0)
+    {
+        SendReply(connection, 204, "");
+        return;
+    }
+
+    /* Binary side channel */
+    if (mg_strcmp(http_message->method, mg_str("GET")) == 0 &&
+        http_message->uri.len > sizeof(BLOB_URL_PREFIX) - 1 &&
+        strncmp(http_message->uri.buf, BLOB_URL_PREFIX, sizeof(BLOB_URL_PREFIX) - 1) == 0)
+    {
+        if (!IsAuthorized(http_message))
+        {
+            SendReply(connection, 401, UNAUTHORIZED_RESPONSE);
+            return;
+        }
+        HandleBlobRequest(connection, mg_str_n(http_message->uri.buf + sizeof(BLOB_URL_PREFIX) - 1,
+            http_message->uri.len - (sizeof(BLOB_URL_PREFIX) - 1)));
+        return;
+    }
+    if (IsEventStream(http_message))
+    {
+        if (!IsAuthorized(http_message))
+        {
+            SendReply(connection, 401, UNAUTHORIZED_RESPONSE);
+            return;
+        }
+        HandleEventStream(connection, http_message);
+        return;
+    }
+    if (IsBlobUpload(http_message))
+    {
+        if (!IsAuthorized(http_message))
+        {
+            SendReply(connection, 401, UNAUTHORIZED_RESPONSE);
+            return;
+        }
+        HandleBlobUpload(connection, http_message);
+        return;
+    }
+    if (IsStagedUpload(http_message))
+    {
+        if (!IsAuthorized(http_message))
+        {
+            SendReply(connection, 401, UNAUTHORIZED_RESPONSE);
+            return;
+        }
+        HandleStagedUpload(connection, http_message);
+        return;
+    }
+
+    /* Only allow POST method for JSON-RPC */
+    if (mg_strcmp(http_message->method, mg_str("POST")) != 0)
+    {
+        mg_http_reply(connection, 405,
+            (s_api_key[0] != '\0')
+                ? "Content-Type: text/plain\r\n"
+                : "Content-Type: text/plain\r\nAccess-Control-Allow-Origin: *\r\n",
+            "Method Not Allowed. Use POST for JSON-RPC requests.");
+        return;
+    }
+
+    if (!IsAuthorized(http_message))
+    {
+        SendReply(connection, 401, UNAUTHORIZED_RESPONSE);
+        return;
+    }
+
+    /* Extract request body */
+    size_t body_length = http_message->body.len;
+    if (body_length == 0)
+    {
+        SendReply(connection, 400,
+            "{\"jsonrpc\":\"2.0\",\"error\":{\"code\":-32700,"
+            "\"message\":\"Parse error: Empty request body.\"},\"id\":null}");
+        return;
+    }
+
+    /* Reject requests larger than the buffer, unless they were streamed to a file */
+    if (body_length >= PROXY_MAX_REQUEST_SIZE && body_file == NULL)
+    {
+        SendReply(connection, 200,
+            BuildErrorResponse(-32600, "Request too large", "null"));
+        return;
+    }
+
+    /* Copy the request body; the queue owns it until C# has answered. A streamed body stays in its file */
+    char* body = NULL;
+    if (body_file == NULL)
+    {
+        body = (char*)malloc(body_length + 1);
+        if (body == NULL)
+        {
+            SendReply(connection, 200,
+                BuildErrorResponse(-32603, "Out of memory", "null"));
+            return;
+        }
+        memcpy(body, http_message->body.buf, body_length);
+        body[body_length] = '\0';
+    }
+    struct mg_str body_text = body != NULL ? mg_str_n(body, body_length) : http_message->body;
+
+    /* Extract the request ID for use in error responses */
+    const char* request_id = ExtractJsonRpcId(body_text.buf, body_text.len);
+
+    if (HandleProjectMethod(connection, body_text, request_id) ||
+        HandleConsoleFallback(connection, body_text, request_id))
+    {
+        free(body);
+        return;
+    }
+
+    /* Answer repeated read-only requests from the response cache */
+    CacheRequest cache_request;
+    CacheClassify(body_text, &cache_request);
+    {
+        size_t cached_length = 0;
+        char* cached = CacheLookup(&cache_request, request_id, &cached_length);
+        if (cached != NULL)
+        {
+            struct mg_str part = mg_str_n(cached, cached_length);
+            SendReplyParts(connection, 200, &part, 1);
+            free(cached);
+            free(body);
+            CacheRelease(&cache_request);
+            return;
+        }
+    }
+
+    RequestWaiter* waiter = (RequestWaiter*)calloc(1, sizeof(RequestWaiter));
+    if (waiter == NULL)
+    {
+        free(body);
+        CacheRelease(&cache_request);
+        SendReply(connection, 200,
+            BuildErrorResponse(-32603, "Out of memory", request_id));
+        return;
+    }
+    waiter->connection_id = connection->id;
+    snprintf(waiter->request_id, sizeof(waiter->request_id), "%s", request_id);
+    memcpy(waiter->if_none_match, cache_request.if_none_match, sizeof(waiter->if_none_match));
+
+    /* Join an identical read-only request that is already queued or running */
+    RequestJob* job = FindCoalescableJob(&cache_request);
+    if (job != NULL)
+    {
+        RequestWaiter* last = job->waiters;
+        while (last->next != NULL)
+        {
+            last = last->next;
+        }
+        last->next = waiter;
+        free(body);
+        CacheRelease(&cache_request);
+        return;
+    }
+
+    if (s_job_count >= PROXY_MAX_QUEUED_REQUESTS)
+    {
+        free(waiter);
+        free(body);
+        CacheRelease(&cache_request);
+        SendReply(connection, 200,
+            BuildErrorResponse(-32000, "Too many pending requests. Please retry.", request_id));
+        return;
+    }
+
+    /* Queue the request; PumpRequestQueue() hands it to C# and replies */
+    job = (RequestJob*)calloc(1, sizeof(RequestJob));
+    if (job == NULL)
+    {
+        free(body);
+        free(waiter);
+        CacheRelease(&cache_request);
+        SendReply(connection, 200,
+            BuildErrorResponse(-32603, "Out of memory", request_id));
+        return;
+    }
+    job->body = body;
+    job->body_length = body_length;
+    if (body_file != NULL)
+    {
+        SpillRetain(body_file);
+        job->body_file = body_file;
+    }
+    job->cache_request = cache_request;
+    job->waiters = waiter;
+    job->queued_at = mg_millis();
+    EnqueueJob(job);
+}
+
+/*
+ * Streamed request bodies
+ *
+ * POST bodies too large for the request buffer are not buffered by
+ * mongoose: once the headers are in, the connection's HTTP parser is
+ * detached and the body is appended to a spill file as it arrives (see
+ * spill.h). When it is complete the request is handled like any other,
+ * with the mapped file as its body, and the parser is reattached for the
+ * connection's next request.
+ */
+static int ShouldStreamBody(const struct mg_http_message* http_message)
+{
+    return http_message->body.len >= PROXY_MAX_REQUEST_SIZE &&
+        mg_strcmp(http_message->method, mg_str("POST")) == 0 &&
+        mg_http_get_header((struct mg_http_message*)http_message, "Transfer-Encoding") == NULL;
+}
+
+/*
+ * Answer a request whose body will not be read, and stop parsing the
+ * connection: emptying the receive buffer detaches mongoose's HTTP handler,
+ * and the connection closes once the reply is sent.
+ */
+static void RejectStreamedBody(struct mg_connection* connection, int status, const char* body)
+{
+    SendReply(connection, status, body);
+    connection->is_draining = 1;
+    connection->recv.len = 0;
+}
+
+static void FinishStreamedBody(struct mg_connection* connection)
+{
+    struct mg_http_message http_message;
+    char* head = NULL;
+    SpillFile* body = SpillUploadFinish(connection, &head);
+
+    connection->pfn = s_http_handler;
+    if (body == NULL || mg_http_parse(head, strlen(head), &http_message) <= 0)
+    {
+        RejectStreamedBody(connection, 200, BuildErrorResponse(-32603, "Failed to store request body", "null"));
+    }
+    else
+    {
+        http_message.body = SpillContents(body);
+        connection->is_resp = 1;  /* As mongoose does before MG_EV_HTTP_MSG */
+        HandleHttpRequest(connection, &http_message, body);
+    }
+    SpillRelease(body);
+    free(head);
+}
+
+static void PumpStreamedBody(struct mg_connection* connection)
+{
+    int state = SpillUploadPump(connection);
+    if (state < 0)
+    {
+        connection->pfn = s_http_handler;
+        RejectStreamedBody(connection, 200, BuildErrorResponse(-32603, "Failed to store request body", "null"));
+    }
+    else if (state > 0)
+    {
+        FinishStreamedBody(connection);
+    }
+}
+
+/*
+ * Called on MG_EV_HTTP_HDRS for a body ShouldStreamBody() accepted. The
+ * headers are checked here, before anything is written to disk.
+ */
+static void StartStreamedBody(struct mg_connection* connection, struct mg_http_message* http_message)
+{
+    size_t head_start = (size_t)(http_message->message.buf - (char*)connection->recv.buf);
+    size_t head_end = (size_t)(http_message->body.buf - (char*)connection->recv.buf);
+    size_t limit = IsBlobUpload(http_message) ? BLOB_BUDGET : PROXY_MAX_UPLOAD_SIZE;
+
+    SetExpectedRequestSize(connection, 0);
+    if (!IsAuthorized(http_message))
+    {
+        RejectStreamedBody(connection, 401, UNAUTHORIZED_RESPONSE);
+        return;
+    }
+    if (http_message->body.len > limit ||
+        !SpillUploadStart(connection, mg_str_n(http_message->message.buf, head_end - head_start),
+            http_message->body.len))
+    {
+        /* No spill directory (C# not initialized yet), or beyond the upload limit */
+        if (IsBlobUpload(http_message) || IsStagedUpload(http_message))
+        {
+            RejectStreamedBody(connection, 413, "{\"error\":\"Upload too large\"}");
+        }
+        else
+        {
+            RejectStreamedBody(connection, 200, BuildErrorResponse(-32600, "Request too large", "null"));
+        }
+        return;
+    }
+
+    /* Drop the headers (and any requests already handled before them); mongoose sees
+     * the buffer change and detaches its parser once this returns. Body bytes already
+     * received are written on the next MG_EV_POLL or MG_EV_READ */
+    s_http_handler = connection->pfn;
+    mg_iobuf_del(&connection->recv, 0, head_end);
+}
+
+/*
+ * Mongoose event handler for all connection events.
+ */
+static void EventHandler(struct mg_connection* connection, int event, void* event_data)
+{
+    if (event == MG_EV_ACCEPT && s_tls_enabled)
+    {
+        struct mg_tls_opts opts;
+        memset(&opts, 0, sizeof(opts));
+        opts.cert = mg_str(s_tls_cert);
+        opts.key = mg_str(s_tls_key);
+        mg_tls_init(connection, &opts);
+    }
+    else if (event == MG_EV_HTTP_HDRS)
+    {
+        /* Fires on every read until the body is complete. Bodies too large for the request
+         * buffer go to a spill file; otherwise only the size is recorded here, since
+         * http_message still points into the receive buffer */
+        struct mg_http_message* http_message = (struct mg_http_message*)event_data;
+        if (ShouldStreamBody(http_message))
+        {
+            StartStreamedBody(connection, http_message);
+        }
+        else if (http_message->body.len < PROXY_MAX_REQUEST_SIZE)
+        {
+            SetExpectedRequestSize(connection,
+                (size_t)(http_message->body.buf - (char*)connection->recv.buf) + http_message->body.len);
+        }
+    }
+    else if (event == MG_EV_READ && SpillUploadActive(connection))
+    {
+        PumpStreamedBody(connection);
+    }
+    else if (event == MG_EV_READ)
+    {
+        /* A partial request is still buffered: grow straight to its announced size */
+        size_t expected = GetExpectedRequestSize(connection);
+        if (expected > connection->recv.size && connection->recv.len > 0)
+        {
+            mg_iobuf_resize(&connection->recv, expected);
+        }
+    }
+    else if (event == MG_EV_POLL || event == MG_EV_WRITE)
+    {
+        SpillStreamPump(connection);
+        if (event == MG_EV_POLL && SpillUploadActive(connection))
+        {
+            PumpStreamedBody(connection);  /* Body bytes that arrived with the headers */
+        }
+    }
+    else if (event == MG_EV_CLOSE)
+    {
+        SpillStreamClose(connection);
+        SpillUploadClose(connection);
+    }
+    else if (event == MG_EV_HTTP_MSG)
+    {
+        struct mg_http_message* http_message = (struct mg_http_message*)event_data;
+        SetExpectedRequestSize(connection, 0);
+        HandleHttpRequest(connection, http_message, NULL);
+    }
+}
+
+/*
+ * Start the HTTP server on the specified port.
+ */
+EXPORT int StartServer(int port)
+{
+    if (s_running)
+    {
+        return 1;  /* Already running */
+    }
+
+    /* Clean up stale state from a previous crash or unclean shutdown.
+     * If s_listener is non-NULL but s_running is 0, the previous session
+     * didn't fully clean up (e.g., DllMain's 100ms sleep wasn't enough). */
+    if (s_listener != NULL)
+    {
+        mg_mgr_free(&s_mgr);
+        s_listener = NULL;
+    }
+
+    /* Reset unload flag */
+    s_unloading = 0;
+
+    /* Connection ids start over with the new manager */
+    s_event_subscriber_count = 0;
+
+    /* Initialize the event manager */
+    mg_mgr_init(&s_mgr);
+
+    /* Build the listen address string */
+    char listen_address[128];
+    if (s_tls_enabled && s_tls_cert[0] && s_tls_key[0])
+        snprintf(listen_address, sizeof(listen_address), "https://%s:%d", s_bind_address, port);
+    else
+        snprintf(listen_address, sizeof(listen_address), "http://%s:%d", s_bind_address, port);
+
+    /* Start listening for HTTP connections */
+    s_listener = mg_http_listen(&s_mgr, listen_address, EventHandler, NULL);
+    if (s_listener == NULL)
+    {
+        mg_mgr_free(&s_mgr);
+        return -1;  /* Failed to bind to port */
+    }
+
+    /* Set running flag before creating thread */
+    s_running = 1;
+
+    /* Create the server thread */
+#ifdef _WIN32
+    s_server_thread = CreateThread(NULL, 0, ServerThreadFunc, NULL, 0, NULL);
+    if (s_server_thread == NULL)
+    {
+        s_running = 0;
+        mg_mgr_free(&s_mgr);
+        return -1;  /* Failed to create thread */
+    }
+#else
+    if (pthread_create(&s_server_thread, NULL, ServerThreadFunc, NULL) != 0)
+    {
+        s_running = 0;
+        mg_mgr_free(&s_mgr);
+        return -1;  /* Failed to create thread */
+    }
+#endif
+
+    return 0;
+}
+
+/*
+ * Stop the HTTP server and release resources.
+ */
+EXPORT void StopServer(void)
+{
+    if (!s_running)
+    {
+        return;
+    }
+
+    /* Signal the thread to stop */
+    s_running = 0;
+
+    /* Wait for the server thread to exit */
+#ifdef _WIN32
+    if (s_server_thread != NULL)
+    {
+        WaitForSingleObject(s_server_thread, INFINITE);
+        CloseHandle(s_server_thread);
+        s_server_thread = NULL;
+    }
+#else
+    pthread_join(s_server_thread, NULL);
+#endif
+
+    s_listener = NULL;
+    s_poller_active = 0;
+    s_has_request = 0;
+
+    mg_mgr_free(&s_mgr);
+}
+
+/*
+ * Activate or deactivate C# polling.
+ */
+EXPORT void SetPollingActive(int active)
+{
+    s_poller_active = active ? 1 : 0;
+
+    if (!active)
+    {
+        /* Clear response state when deactivating */
+        s_has_response = 0;
+        s_response_buffer[0] = '\0';
+    }
+}
+
+/*
+ * Get the pending request body, if any.
+ */
+EXPORT const char* GetPendingRequest(void)
+{
+    if (s_has_request && s_request_path[0] == '\0')
+    {
+        return s_request_buffer;
+    }
+    return NULL;
+}
+
+/*
+ * Get the spill file holding the pending request, if its body was streamed.
+ */
+EXPORT const char* GetPendingRequestFile(void)
+{
+    if (s_has_request && s_request_path[0] != '\0')
+    {
+        return s_request_path;
+    }
+    return NULL;
+}
+
+/*
+ * Get the sequence number of the pending request.
+ */
+EXPORT int GetPendingRequestSequence(void)
+{
+    return s_has_request ? s_pending_sequence : 0;
+}
+
+/*
+ * Send a response back to the waiting HTTP request.
+ */
+EXPORT void SendResponse(const char* json)
+{
+    SendResponseForRequest(s_pending_sequence, json);
+}
+
+/*
+ * Send the response to a given request. Answers to a request that is no
+ * longer pending (it timed out or was interrupted) are dropped here, or by
+ * PumpRequestQueue() if the request fails while the response is copied.
+ * Note: Response size validation is handled by the C# layer which has access
+ * to the request ID for proper JSON-RPC error responses.
+ */
+EXPORT void SendResponseForRequest(int sequence, const char* json)
+{
+    if (json == NULL || sequence == 0 || sequence != s_pending_sequence)
+    {
+        return;
+    }
+
+    size_t json_length = strlen(json);
     if (json_length >= PROXY_MAX_RESPONSE_SIZE)
     {
         /*
@@ -562,7 +1793,46 @@ EXPORT void SendResponse(const char* json)
         strcpy(s_response_buffer, json);
     }
 
+    /* Stop handing out the request before the server thread picks up the response */
+    s_response_sequence = sequence;
+    s_has_request = 0;
+    s_has_response = 1;
+}
+
+/*
+ * Hand over a response too large for SendResponse() as a file in the spill
+ * directory. The proxy streams it to the client and deletes it afterwards.
+ */
+EXPORT int SendResponseFile(const char* path)
+{
+    return SendResponseFileForRequest(s_pending_sequence, path);
+}
+
+/*
+ * Hand over a spilled response for a given request. A file for a request
+ * that is no longer pending is deleted and still counts as taken.
+ */
+EXPORT int SendResponseFileForRequest(int sequence, const char* path)
+{
+    SpillFile* file = SpillOpen(path);
+    if (file == NULL)
+    {
+        return 0;
+    }
+    if (sequence == 0 || sequence != s_pending_sequence)
+    {
+        SpillRelease(file);  /* Nobody waits for it; deletes the file */
+        return 1;
+    }
+
+    s_response_buffer[0] = '\0';
+    s_response_file = file;
+
+    /* Stop handing out the request before the server thread picks up the response */
+    s_response_sequence = sequence;
+    s_has_request = 0;
     s_has_response = 1;
+    return 1;
 }
 
 /*
@@ -32,6 +32,11 @@ extern "C" {
 #define PROXY_MAX_REQUEST_SIZE 262144   /* 256KB */
 #define PROXY_REQUEST_TIMEOUT_MS 30000
 #define PROXY_RECOMPILE_POLL_INTERVAL_MS 50
+#define PROXY_MAX_QUEUED_REQUESTS 256
+#define PROXY_MAX_UPLOAD_SIZE (512u * 1024 * 1024)   /* Request bodies streamed to spill files */
+#define PROXY_MAX_EVENT_SUBSCRIBERS 16
+#define PROXY_EVENT_KEEPALIVE_MS 15000
+#define PROXY_MAX_EVENT_BACKLOG (4u * 1024 * 1024)    /* Unsent stream bytes before a subscriber is dropped */
 
 /*
  * Start the HTTP server on the specified port.
@@ -64,17 +69,73 @@ EXPORT void SetPollingActive(int active);
  * or until the request is cleared by the next incoming request.
  *
  * @return Pointer to request body string, or NULL if no pending request
+ *         (or if it is pending as a file, see GetPendingRequestFile())
  */
 EXPORT const char* GetPendingRequest(void);
 
+/*
+ * Get the path of the pending request, if its body was too large for the
+ * request buffer and was streamed to a file in the spill directory instead.
+ * The proxy deletes the file once the request is answered or has failed.
+ *
+ * @return Absolute path of a file holding the request JSON, or NULL if no
+ *         request is pending as a file
+ */
+EXPORT const char* GetPendingRequestFile(void);
+
+/*
+ * Get the sequence number of the pending request. Every request handed to
+ * C# gets a new one. Read it before GetPendingRequest() and again after
+ * copying the request: if the two differ, the request timed out and the
+ * next one took its place while it was being read.
+ *
+ * @return Sequence number (1 or more), or 0 if no request is pending
+ */
+EXPORT int GetPendingRequestSequence(void);
+
 /*
  * Send a response back to the waiting HTTP request.
  * Must be called from C# after receiving a request via GetPendingRequest().
+ * Answers whichever request is pending now; see SendResponseForRequest().
  *
  * @param json The JSON-RPC response string
  */
 EXPORT void SendResponse(const char* json);
 
+/*
+ * Send the response to the request with the given sequence number. A
+ * response to a request that is no longer pending (it timed out, or a
+ * domain reload interrupted it) is dropped, so it never reaches the clients
+ * of the next request.
+ *
+ * @param sequence Value of GetPendingRequestSequence() for the request
+ * @param json The JSON-RPC response string
+ */
+EXPORT void SendResponseForRequest(int sequence, const char* json);
+
+/*
+ * Send a response too large for SendResponse() as a file.
+ * The file must be directly inside the directory set with
+ * ConfigureSpillDirectory(). The proxy streams it to the waiting client(s)
+ * and deletes it when done.
+ *
+ * @param path Absolute path of the file holding the JSON-RPC response
+ * @return 1 if the proxy took over the file, 0 if it is outside the spill
+ *         directory or cannot be opened (the caller still owns it)
+ */
+EXPORT int SendResponseFile(const char* path);
+
+/*
+ * SendResponseFile() for the request with the given sequence number. If
+ * that request is no longer pending, the file is deleted and nothing is
+ * sent.
+ *
+ * @param sequence Value of GetPendingRequestSequence() for the request
+ * @param path Absolute path of the file holding the JSON-RPC response
+ * @return As for SendResponseFile()
+ */
+EXPORT int SendResponseFileForRequest(int sequence, const char* path);
+
 /*
  * Check if the server is currently running.
  *
@@ -134,6 +195,615 @@ EXPORT void ConfigureTls(const char* cert_pem, const char* key_pem);
  */
 EXPORT int GetTlsSupported(void);
 
+/*
+ * Response cache (cache.c)
+ *
+ * Read-only requests registered with RegisterCacheableRequest() are answered
+ * from a native LRU cache on the server thread while the named epochs they
+ * depend on are unchanged. Any tools/call that is not registered is treated
+ * as mutating and invalidates every entry.
+ */
+
+/*
+ * Configure the response cache.
+ * Defaults to a 16MB budget with no time-to-live.
+ *
+ * @param budget_bytes Memory budget for cached responses; 0 disables caching
+ * @param ttl_ms Maximum entry age in milliseconds; 0 for no limit
+ */
+EXPORT void ConfigureResponseCache(int budget_bytes, int ttl_ms);
+
+/*
+ * Register a read-only request.
+ *
+ * @param method JSON-RPC method (e.g. "tools/call", "resources/read", "tools/list")
+ * @param name Tool name or resource URI; a trailing '*' matches by prefix.
+ *             NULL or empty matches every request of the method.
+ * @param epochs Comma-separated epoch names the result depends on
+ *               (e.g. "scene,selection"). NULL or empty registers the request
+ *               as read-only but never cached (it will not invalidate the cache).
+ */
+EXPORT void RegisterCacheableRequest(const char* method, const char* name, const char* epochs);
+
+/*
+ * Bump a named invalidation epoch, invalidating entries that depend on it.
+ * Safe to call from any thread. Pass "*" to bump every epoch.
+ *
+ * @param name Epoch name (e.g. "scene", "assets", "console", "selection")
+ */
+EXPORT void BumpCacheEpoch(const char* name);
+
+/*
+ * Drop all cached entries and registered requests.
+ * Call before re-registering after a domain reload.
+ */
+EXPORT void ResetResponseCache(void);
+
+/*
+ * Get response cache statistics as a JSON object
+ * (entries, bytes, hits, misses, evictions, epoch values).
+ * The returned pointer is valid until the next call.
+ *
+ * @return Pointer to a static JSON string
+ */
+EXPORT const char* GetResponseCacheStats(void);
+
+/*
+ * Spill files (spill.c)
+ */
+
+/*
+ * Configure the directory for SendResponseFile() and for request bodies
+ * streamed to files (named "upload_*"). It should be outside Assets/ so
+ * Unity never imports the files. Pass NULL to disable; large request bodies
+ * are then rejected.
+ *
+ * @param path Absolute directory path
+ */
+EXPORT void ConfigureSpillDirectory(const char* path);
+
+/*
+ * Binary blobs (blob.c)
+ */
+
+/*
+ * Store a binary payload to be fetched with GET /blob/<id> instead of being
+ * base64-encoded into a JSON response. The data is copied. The oldest blobs
+ * are evicted if the table would exceed its memory budget.
+ *
+ * @param data Payload bytes
+ * @param length Payload length in bytes
+ * @param mime_type Content-Type to serve it with (NULL for octet-stream)
+ * @param ttl_ms Lifetime in milliseconds (0 or less for the default)
+ * @return Pointer to a static buffer holding the 32-character id, valid
+ *         until the next call, or NULL on failure
+ */
+EXPORT const char* StoreBlob(const unsigned char* data, int length, const char* mime_type, int ttl_ms);
+
+/*
+ * Remove a blob before it expires. Transfers already in progress finish.
+ *
+ * @param id Id returned by StoreBlob()
+ */
+EXPORT void DropBlob(const char* id);
+
+/*
+ * Copy a blob, typically one a client uploaded with POST /blob, into a
+ * caller buffer. Call with a NULL buffer first to get the size.
+ *
+ * @param id Blob id
+ * @param output Buffer to copy into, or NULL
+ * @param capacity Buffer size; nothing is copied if it is too small
+ * @return Blob size in bytes, or -1 if the blob is unknown or expired
+ */
+EXPORT int CopyBlob(const char* id, unsigned char* output, int capacity);
+
+/*
+ * Get blob table statistics as a JSON object: live blobs and bytes, the
+ * budget, and stored/served/expired counters.
+ *
+ * @return Pointer to a static JSON string
+ */
+EXPORT const char* GetBlobStats(void);
+
+/*
+ * Staged uploads (staging.c)
+ */
+
+/*
+ * Configure the directory files sent with POST /upload are written to. It
+ * should be outside Assets/ so Unity never imports the files. Pass NULL to
+ * disable; uploads are then rejected.
+ *
+ * @param path Absolute directory path
+ */
+EXPORT void ConfigureStagingDirectory(const char* path);
+
+/*
+ * Look up a staged upload and extend its lifetime. The file is named
+ * "<id>_<original filename>".
+ *
+ * @param id Upload id from the POST /upload reply
+ * @return Pointer to a static buffer holding the file's path, valid until
+ *         the next call, or NULL if the id is unknown or expired
+ */
+EXPORT const char* GetStagedUpload(const char* id);
+
+/*
+ * Delete a staged upload, typically once it has been imported.
+ *
+ * @param id Upload id
+ */
+EXPORT void DropStagedUpload(const char* id);
+
+/*
+ * Project tree (project.c)
+ */
+
+/*
+ * Configure the Unity project root served by the native project methods
+ * ("search/files", "assets/resolve", "assets/references", "scenes/find",
+ * ...). Changing it rebuilds the indexes in the background.
+ *
+ * @param path Absolute path of the folder holding Assets/ and Packages/
+ */
+EXPORT void ConfigureProjectRoot(const char* path);
+
+/*
+ * Configure project-relative paths left out of the indexes.
+ *
+ * @param patterns Globs separated by ';' or newlines; '*' stays within a
+ *        folder and '**' crosses folders. A matching folder is skipped
+ *        with everything in it ("Assets/ThirdParty")
+ */
+EXPORT void ConfigureProjectExcludes(const char* patterns);
+
+/*
+ * Configure local packages (Unity "file:" dependencies outside the
+ * project), so they are indexed and watched under their package paths.
+ *
+ * @param mounts One "Packages/<name>=<absolute folder>" per line
+ */
+EXPORT void ConfigureProjectPackages(const char* mounts);
+
+/*
+ * File watcher (watcher.c)
+ */
+
+/*
+ * Get the project file changes after a cursor, the same object the
+ * "files/changes" method and the GET /events stream carry.
+ *
+ * @param cursor Value of "cursor" from the previous call, or -1 to start
+ *        from the latest change
+ * @return JSON {"cursor","reset","more","mode","changes":[{"path","kind"}]}
+ *         in a buffer valid until the next call
+ */
+EXPORT const char* GetFileChanges(long long cursor);
+
+/*
+ * File search (search.c)
+ */
+
+/*
+ * Get trigram index statistics.
+ *
+ * @return JSON object (ready, scanning, files, text_files, trigrams,
+ *         postings, build_ms, age_ms) in a static buffer
+ */
+EXPORT const char* GetSearchIndexStats(void);
+
+/*
+ * Asset index (assets.c)
+ */
+
+/*
+ * Get .meta GUID index statistics.
+ *
+ * @return JSON object (ready, scanning, assets, folders, duplicate_guids,
+ *         build_ms, age_ms) in a static buffer
+ */
+EXPORT const char* GetAssetIndexStats(void);
+
+/*
+ * Reverse references (references.c)
+ */
+
+/*
+ * Get reverse reference index statistics.
+ *
+ * @return JSON object (ready, scanning, files, guids, references,
+ *         build_ms, age_ms) in a static buffer
+ */
+EXPORT const char* GetReferenceIndexStats(void);
+
+/*
+ * Scene reader (scenes.c)
+ */
+
+/*
+ * Get scene reader cache statistics.
+ *
+ * @return JSON object (files, objects, bytes, parses, hits) in a static
+ *         buffer
+ */
+EXPORT const char* GetSceneCacheStats(void);
+
+/*
+ * C# symbols (symbols.c)
+ */
+
+/*
+ * Get C# symbol index statistics.
+ *
+ * @return JSON object (ready, scanning, files, symbols, build_ms, age_ms)
+ *         in a static buffer
+ */
+EXPORT const char* GetSymbolIndexStats(void);
+
+/*
+ * Editor log (editorlog.c)
+ */
+
+/*
+ * Configure the editor log file to follow, so console reads keep working
+ * while C# is away. Calling it again with the same path does nothing.
+ *
+ * @param path Absolute path of Editor.log, or NULL or "" to stop
+ */
+EXPORT void ConfigureEditorLog(const char* path);
+
+/*
+ * Get editor log tailer statistics.
+ *
+ * @return JSON object (mode, session, entries, cursor, errors, warnings,
+ *         bytes) in a static buffer
+ */
+EXPORT const char* GetEditorLogStats(void);
+
+/*
+ * Base64 (base64.c)
+ */
+
+/*
+ * Base64-encode bytes (padded, no terminator) with the fastest kernel the
+ * CPU supports.
+ *
+ * @param data Bytes to encode
+ * @param length Number of bytes
+ * @param output Destination buffer
+ * @param capacity Size of output; at least 4 * ceil(length / 3)
+ * @return Number of characters written, or -1 if output is too small
+ */
+EXPORT int EncodeBase64(const unsigned char* data, int length, char* output, int capacity);
+
+/*
+ * Decode base64 text. Padding is optional.
+ *
+ * @param text Characters to decode
+ * @param length Number of characters
+ * @param output Destination buffer
+ * @param capacity Size of output; at least 3 * ceil(length / 4)
+ * @return Number of bytes written, or -1 if the text is invalid or output
+ *         is too small
+ */
+EXPORT int DecodeBase64(const char* text, int length, unsigned char* output, int capacity);
+
+/*
+ * Attach bytes to the response of the request being handled. Put the
+ * returned token in the JSON where their base64 text belongs (inside a
+ * string); the proxy encodes the bytes in its place when SendResponse() is
+ * called. The bytes are copied. Payloads are dropped if the response goes
+ * through SendResponseFile() or the next request starts.
+ *
+ * @param data Bytes to attach
+ * @param length Number of bytes
+ * @return Pointer to a static buffer holding the token, valid until the
+ *         next call, or NULL if the payload limits are reached
+ */
+EXPORT const char* AttachBase64Payload(const unsigned char* data, int length);
+
+/*
+ * Image encoding (png.c, image.c, jpeg.c)
+ */
+
+/*
+ * Start encoding an 8-bit RGBA image as PNG on the native worker pool. The
+ * pixels are copied before returning; filtering and compression happen in
+ * the background. Opaque images are written as RGB.
+ *
+ * @param rgba First byte of the pixel buffer
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param stride Bytes between rows (0 for width * 4); negative if the
+ *        buffer holds the bottom row first, as Unity textures do
+ * @param level Compression level, 0 (stored) to 9 (negative for 6)
+ * @return Job handle, or 0 if the job could not be started
+ */
+EXPORT int EncodePngAsync(const unsigned char* rgba, int width, int height, int stride, int level);
+
+/*
+ * Like EncodePngAsync(), but the worker can first downscale the image and
+ * convert it to grayscale, and write a baseline JPEG instead of a PNG. The
+ * job functions below accept handles from either call.
+ *
+ * @param rgba First byte of the pixel buffer
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param stride As for EncodePngAsync()
+ * @param target_width Output width (0 or less for width)
+ * @param target_height Output height (0 or less for height)
+ * @param quality JPEG quality 1-100 (0 or less for 75), or the PNG
+ *        compression level as for EncodePngAsync()
+ * @param flags ENCODE_JPEG (1), ENCODE_GRAYSCALE (2) and ENCODE_LANCZOS (4)
+ *        to resample with Lanczos-3 instead of a box filter
+ * @return Job handle, or 0 if the job could not be started
+ */
+EXPORT int EncodeImageAsync(const unsigned char* rgba, int width, int height, int stride,
+    int target_width, int target_height, int quality, int flags);
+
+/*
+ * @param job Handle returned by EncodePngAsync()
+ * @return 0 while running, 1 when done, -1 if it failed or is unknown
+ */
+EXPORT int GetPngJobStatus(int job);
+
+/*
+ * Wait for a job to finish.
+ *
+ * @param job Handle returned by EncodePngAsync()
+ * @param timeout_ms Maximum wait in milliseconds (negative to wait forever)
+ * @return Job status as GetPngJobStatus(); 0 if the wait timed out
+ */
+EXPORT int WaitPngJob(int job, int timeout_ms);
+
+/*
+ * @param job Handle returned by EncodePngAsync()
+ * @return Size of the finished file in bytes, or -1 if it is not done
+ */
+EXPORT int GetPngJobSize(int job);
+
+/*
+ * Copy a finished PNG or JPEG.
+ *
+ * @param job Handle returned by EncodePngAsync()
+ * @param output Destination buffer
+ * @param capacity Size of output; at least GetPngJobSize()
+ * @return Number of bytes copied, or -1 if the job is not done or output
+ *         is too small
+ */
+EXPORT int CopyPngJobResult(int job, unsigned char* output, int capacity);
+
+/*
+ * Release a job handle. A running job finishes in the background and is
+ * then freed, unless a response still refers to it. Finished jobs whose
+ * handle is never released are freed after two minutes.
+ *
+ * @param job Handle returned by EncodePngAsync()
+ */
+EXPORT void ReleasePngJob(int job);
+
+/*
+ * Attach a job's file to the response of the request being handled, like
+ * AttachBase64Payload(), without waiting for it: the proxy holds the
+ * response until the job is done. A failed job expands to an empty string.
+ * The handle stays valid and still has to be released.
+ *
+ * @param job Handle returned by EncodePngAsync()
+ * @return Pointer to a static buffer holding the token, valid until the
+ *         next call, or NULL if the job is unknown, failed or the payload
+ *         limits are reached
+ */
+EXPORT const char* AttachPngJobPayload(int job);
+
+/*
+ * Frame deltas (frames.c)
+ */
+
+/*
+ * Diff a capture against the previous frame of a session, in 32x32 tiles,
+ * and start encoding only what changed: the whole frame for a keyframe,
+ * otherwise an atlas of the changed tiles (layout in frames.h). The image
+ * is a lossless PNG job like those of EncodeImageAsync(). The frame is
+ * copied, and resized if asked, before returning.
+ *
+ * @param session Caller-chosen session name (up to 63 characters)
+ * @param rgba First byte of the pixel buffer
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param stride As for EncodePngAsync()
+ * @param target_width Size to diff and send at (0 or less to keep the
+ *        capture's), box-filtered
+ * @param target_height See target_width
+ * @param keyframe_interval Frames between keyframes (0 or less for never)
+ * @param force_keyframe Non-zero to send a keyframe now
+ * @param tiles Receives the row-major indices of the changed tiles, in
+ *        atlas order
+ * @param capacity Length of tiles; at least the frame's tile count
+ * @param info Receives FRAME_INFO_FIELDS (7) ints: frame number, base
+ *        frame, keyframe flag, width, height, atlas columns and the image
+ *        job handle (0 if nothing changed), which the caller releases
+ * @return Number of changed tiles (every tile for a keyframe, whose
+ *         indices are not written), or -1 on failure
+ */
+EXPORT int DiffFrame(const char* session, const unsigned char* rgba, int width, int height, int stride,
+    int target_width, int target_height, int keyframe_interval, int force_keyframe,
+    int* tiles, int capacity, int* info);
+
+/*
+ * Forget a session's previous frame so that its next frame is a keyframe.
+ *
+ * @param session Session name, or NULL for every session
+ */
+EXPORT void ResetFrameSession(const char* session);
+
+/*
+ * Rebuild a frame from the previous one and a decoded delta atlas.
+ *
+ * @param frame Previous frame, RGBA top row first; updated in place
+ * @param width Frame width in pixels
+ * @param height Frame height in pixels
+ * @param atlas Decoded atlas, RGBA top row first
+ * @param atlas_width Atlas width in pixels
+ * @param atlas_height Atlas height in pixels
+ * @param tiles Tile indices returned by DiffFrame()
+ * @param tile_count Number of tiles
+ * @return 0 on success, -1 if a tile or the atlas size does not fit
+ */
+EXPORT int ApplyFrameDelta(unsigned char* frame, int width, int height, const unsigned char* atlas,
+    int atlas_width, int atlas_height, const int* tiles, int tile_count);
+
+/*
+ * Texture kernels (texture.c)
+ *
+ * Pixel work for manage_texture on raw RGBA8 / RGBAHalf data, spread over
+ * the worker pool; each call returns when it is done. Rows may be in either
+ * order.
+ */
+
+/*
+ * Convert RGBAHalf pixels to RGBA8, clamping to [0, 1].
+ *
+ * @param half pixel_count * 4 binary16 values
+ * @param rgba Receives pixel_count * 4 bytes
+ * @param pixel_count Number of pixels
+ * @return 0 on success, -1 on invalid arguments
+ */
+EXPORT int TextureHalfToRgba8(const unsigned short* half, unsigned char* rgba, int pixel_count);
+
+/*
+ * Convert RGBA8 pixels to RGBAHalf (v / 255 rounded to the nearest half).
+ *
+ * @param rgba pixel_count * 4 bytes
+ * @param half Receives pixel_count * 4 binary16 values
+ * @param pixel_count Number of pixels
+ * @return 0 on success, -1 on invalid arguments
+ */
+EXPORT int TextureRgba8ToHalf(const unsigned char* rgba, unsigned short* half, int pixel_count);
+
+/*
+ * Build RGBA8 pixels from one channel of up to four same-sized RGBA8
+ * images. Also unpacks a channel: pass the same image for red, green and
+ * blue with that channel, and a NULL alpha source with 255.
+ *
+ * @param red Source of the red channel, or NULL for a constant
+ * @param green Source of the green channel, or NULL
+ * @param blue Source of the blue channel, or NULL
+ * @param alpha Source of the alpha channel, or NULL
+ * @param channels Four ints: the channel (0-3, RGBA) to take from each
+ *        source, or the constant (0-255) for a NULL source
+ * @param rgba Receives pixel_count * 4 bytes
+ * @param pixel_count Number of pixels
+ * @return 0 on success, -1 on invalid arguments
+ */
+EXPORT int TexturePackChannels(const unsigned char* red, const unsigned char* green, const unsigned char* blue,
+    const unsigned char* alpha, const int* channels, unsigned char* rgba, int pixel_count);
+
+/*
+ * Multiply the color channels of RGBA8 pixels by their alpha, in place.
+ *
+ * @param rgba pixel_count * 4 bytes
+ * @param pixel_count Number of pixels
+ * @return 0 on success, -1 on invalid arguments
+ */
+EXPORT int TexturePremultiply(unsigned char* rgba, int pixel_count);
+
+/*
+ * Resize RGBA8 pixels.
+ *
+ * @param rgba width * height * 4 bytes
+ * @param width Source width
+ * @param height Source height
+ * @param output Receives target_width * target_height * 4 bytes
+ * @param target_width Output width
+ * @param target_height Output height
+ * @param filter 0 for box (area average), 1 for Lanczos-3
+ * @return 0 on success, -1 on invalid arguments or out of memory
+ */
+EXPORT int TextureResize(const unsigned char* rgba, int width, int height, unsigned char* output,
+    int target_width, int target_height, int filter);
+
+/*
+ * Count the values of each channel of RGBA8 pixels.
+ *
+ * @param rgba pixel_count * 4 bytes
+ * @param pixel_count Number of pixels
+ * @param histogram Receives 1024 counts: 256 for red, then green, blue and
+ *        alpha
+ * @return 0 on success, -1 on invalid arguments
+ */
+EXPORT int TextureHistogram(const unsigned char* rgba, int pixel_count, unsigned int* histogram);
+
+/*
+ * Typed arrays (arrays.c)
+ *
+ * Binary transfer format for large numeric arrays; layout in arrays.h.
+ */
+
+/*
+ * Get an upper bound of the encoded size of an array, for sizing the
+ * buffer passed to EncodeTypedArray().
+ *
+ * @param type Element type (1 uint8, 2 uint16, 3 int32, 4 float32)
+ * @param shape Extent of each axis
+ * @param rank Number of axes (1-4)
+ * @return Size in bytes, or -1 for an invalid or too large shape
+ */
+EXPORT int TypedArrayBound(int type, const int* shape, int rank);
+
+/*
+ * Encode an array, compressing it on the worker pool if asked.
+ *
+ * @param data Elements in host (little-endian) order, row-major
+ * @param type Element type
+ * @param shape Extent of each axis
+ * @param rank Number of axes (1-4)
+ * @param flags 1 delta, 2 byte shuffle, 4 deflate (zlib), combined
+ * @param output Receives the encoded array
+ * @param capacity Size of output; TypedArrayBound() is always enough
+ * @return Encoded size in bytes, or -1 on invalid arguments, a short
+ *         buffer or out of memory
+ */
+EXPORT int EncodeTypedArray(const void* data, int type, const int* shape, int rank, int flags,
+    unsigned char* output, int capacity);
+
+/*
+ * Parse the header of an encoded array.
+ *
+ * @param encoded Encoded array
+ * @param length Its length in bytes
+ * @param header Receives ARRAY_HEADER_FIELDS (7) ints: type, flags, rank
+ *        and four extents (0 past the rank); may be NULL
+ * @return Element count, or -1 if the header is invalid
+ */
+EXPORT int ReadTypedArrayHeader(const unsigned char* encoded, int length, int* header);
+
+/*
+ * Decode an encoded array, verifying its zlib checksum if compressed.
+ *
+ * @param encoded Encoded array
+ * @param length Its length in bytes
+ * @param output Receives the elements in host order
+ * @param capacity Size of output in bytes
+ * @return Element count, or -1 if the array is invalid or corrupt, or
+ *         output is too small
+ */
+EXPORT int DecodeTypedArray(const unsigned char* encoded, int length, void* output, int capacity);
+
+/*
+ * Memory pools (pool.c)
+ */
+
+/*
+ * Get allocation statistics for mongoose's memory as a JSON object: per
+ * size class the block size, live and peak block counts, reserved slab
+ * bytes and total allocations, plus the same for large blocks that bypass
+ * the pools. The returned pointer is valid until the next call.
+ *
+ * @return Pointer to a static JSON string
+ */
+EXPORT const char* GetProxyMemoryStats(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,835 @@
+/*
+ * UnixxtyMCP Proxy - Request queue test
+ *
+ * Standalone executable that starts the proxy on a loopback port, sends it
+ * JSON-RPC requests over HTTP from client threads and plays the C# side
+ * itself through GetPendingRequest() and SendResponseForRequest(). Checks
+ * that identical read-only requests in flight run once and every client
+ * gets the reply with its own id, that mutating requests are never shared,
+ * that resources/read replies are tagged and answered "not modified" for a
+ * client holding the current tag, that a response to a request that has
+ * already failed is dropped instead of answering the next request, and
+ * that responses handed over as spill files reach every waiting client
+ * whole and the files are deleted, that request bodies too large for the
+ * request buffer are streamed to a file C# reads instead, and that files
+ * posted to /upload are staged under sanitized names.
+ *
+ * Usage:
+ *   proxy_test
+ *
+ * Build with build_proxy_test.sh (Linux/macOS). Not shipped with the plugin.
+ * Exits with status 1 if any check fails.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "platform.h"
+#include "staging.h"
+#include "mongoose.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define TEST_FIRST_PORT 18390
+#define TEST_CLIENTS 8
+#define TEST_SPILL_SIZE (3 * 1024 * 1024)
+
+static int s_failures = 0;
+static int s_checks = 0;
+static int s_port = 0;
+static char s_spill_directory[1024] = "";
+static char s_staging_directory[1024] = "";
+
+#define CHECK(condition, ...) \
+    do \
+    { \
+        s_checks++; \
+        if (!(condition)) \
+        { \
+            s_failures++; \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+        } \
+    } while (0)
+
+/*
+ * HTTP client
+ */
+
+typedef struct HttpReply
+{
+    int status;
+    char* body;     /* NUL-terminated, caller frees */
+    size_t length;
+} HttpReply;
+
+static int SendAll(int fd, const char* data, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t sent = send(fd, data, length, 0);
+        if (sent <= 0)
+        {
+            return 0;
+        }
+        data += sent;
+        length -= (size_t)sent;
+    }
+    return 1;
+}
+
+/*
+ * Send one request on a new connection and read the reply. headers holds
+ * extra "Name: value\r\n" lines, or NULL. A NULL body announces body_length
+ * bytes but sends none, for requests the server refuses from the headers.
+ * Returns 0 if the connection failed.
+ */
+static int HttpRequest(const char* method, const char* path, const char* headers,
+    const char* body, size_t body_length, HttpReply* reply)
+{
+    struct sockaddr_in address;
+    struct timeval timeout = { 40, 0 };
+    char head[1024];
+    char* buffer = NULL;
+    size_t size = 0;
+    size_t capacity = 0;
+    size_t header_end = 0;
+    size_t content_length = 0;
+    int fd;
+
+    memset(reply, 0, sizeof(*reply));
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return 0;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((unsigned short)s_port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0)
+    {
+        close(fd);
+        return 0;
+    }
+
+    snprintf(head, sizeof(head), "%s %s HTTP/1.1\r\nHost: 127.0.0.1\r\n%sContent-Length: %lu\r\n\r\n",
+        method, path, headers != NULL ? headers : "", (unsigned long)body_length);
+    if (!SendAll(fd, head, strlen(head)) || (body != NULL && !SendAll(fd, body, body_length)))
+    {
+        close(fd);
+        return 0;
+    }
+
+    for (;;)
+    {
+        ssize_t received;
+        if (size + 4096 + 1 > capacity)
+        {
+            capacity = (size + 4096 + 1) * 2;
+            buffer = (char*)realloc(buffer, capacity);
+        }
+        received = recv(fd, buffer + size, capacity - size - 1, 0);
+        if (received <= 0)
+        {
+            break;
+        }
+        size += (size_t)received;
+        buffer[size] = '\0';
+        if (header_end == 0)
+        {
+            char* end = strstr(buffer, "\r\n\r\n");
+            char* field = strstr(buffer, "Content-Length:");
+            if (end == NULL || field == NULL || field > end)
+            {
+                continue;
+            }
+            header_end = (size_t)(end + 4 - buffer);
+            content_length = (size_t)strtoul(field + 15, NULL, 10);
+        }
+        if (size >= header_end + content_length)
+        {
+            break;
+        }
+    }
+    close(fd);
+
+    if (header_end == 0 || size < header_end + content_length)
+    {
+        free(buffer);
+        return 0;
+    }
+    reply->status = atoi(buffer + 9);
+    reply->length = content_length;
+    reply->body = (char*)malloc(content_length + 1);
+    memcpy(reply->body, buffer + header_end, content_length);
+    reply->body[content_length] = '\0';
+    free(buffer);
+    return 1;
+}
+
+static int PostJson(const char* body, HttpReply* reply)
+{
+    return HttpRequest("POST", "/", "Content-Type: application/json\r\n", body, strlen(body), reply);
+}
+
+/*
+ * A client thread sending one JSON-RPC request
+ */
+
+typedef struct Client
+{
+    char body[512];
+    const char* large_body;     /* Sent instead of body if set */
+    HttpReply reply;
+    int ok;
+    volatile int done;
+    pthread_t thread;
+} Client;
+
+static void* ClientThread(void* param)
+{
+    Client* client = (Client*)param;
+    client->ok = PostJson(client->large_body != NULL ? client->large_body : client->body, &client->reply);
+    client->done = 1;
+    return NULL;
+}
+
+static void StartClient(Client* client, const char* body)
+{
+    memset(client, 0, sizeof(*client));
+    snprintf(client->body, sizeof(client->body), "%s", body);
+    pthread_create(&client->thread, NULL, ClientThread, client);
+}
+
+static void StartLargeClient(Client* client, const char* body)
+{
+    memset(client, 0, sizeof(*client));
+    client->large_body = body;
+    pthread_create(&client->thread, NULL, ClientThread, client);
+}
+
+static void FinishClient(Client* client)
+{
+    pthread_join(client->thread, NULL);
+    free(client->reply.body);
+    client->reply.body = NULL;
+}
+
+/*
+ * The C# side: wait for the next request and copy it out.
+ */
+static int WaitForRequest(char* request, size_t capacity, int timeout_ms)
+{
+    int waited;
+    for (waited = 0; waited < timeout_ms; waited++)
+    {
+        int sequence = GetPendingRequestSequence();
+        const char* pending = GetPendingRequest();
+        if (sequence != 0 && pending != NULL)
+        {
+            snprintf(request, capacity, "%s", pending);
+            if (sequence == GetPendingRequestSequence())
+            {
+                return sequence;
+            }
+        }
+        PROXY_SLEEP_MS(1);
+    }
+    return 0;
+}
+
+/*
+ * Reply {"jsonrpc":"2.0","id":<request id>,"result":<result>}.
+ */
+static void Answer(int sequence, const char* request, const char* result)
+{
+    char response[1024];
+    int length = 0;
+    int offset = mg_json_get(mg_str(request), "$.id", &length);
+    snprintf(response, sizeof(response), "{\"jsonrpc\":\"2.0\",\"id\":%.*s,\"result\":%s}",
+        offset >= 0 ? length : 4, offset >= 0 ? request + offset : "null", result);
+    SendResponseForRequest(sequence, response);
+}
+
+static int Contains(const HttpReply* reply, const char* text)
+{
+    return reply->body != NULL && strstr(reply->body, text) != NULL;
+}
+
+/*
+ * Play C# until no request arrives for idle_ms, answering each with result.
+ * Returns the number of requests executed.
+ */
+static int ServeRequests(const char* result, int idle_ms)
+{
+    char request[1024];
+    int executions = 0;
+    int sequence;
+
+    while ((sequence = WaitForRequest(request, sizeof(request), idle_ms)) != 0)
+    {
+        executions++;
+        Answer(sequence, request, result);
+    }
+    return executions;
+}
+
+/*
+ * Identical read-only requests share one execution; each client gets its id
+ */
+static void TestCoalescing(void)
+{
+    Client clients[TEST_CLIENTS];
+    char body[256];
+    char id[32];
+    int executions;
+    int i;
+
+    for (i = 0; i < TEST_CLIENTS; i++)
+    {
+        snprintf(body, sizeof(body),
+            "{\"jsonrpc\":\"2.0\",\"id\":%d,\"method\":\"resources/list\",\"params\":{\"cursor\":\"a\"}}", 100 + i);
+        StartClient(&clients[i], body);
+    }
+    PROXY_SLEEP_MS(200);  /* Every client is connected and waiting */
+
+    executions = ServeRequests("{\"resources\":[{\"uri\":\"test://shared\"}]}", 300);
+    CHECK(executions == 1, "%d executions for %d identical requests", executions, TEST_CLIENTS);
+    for (i = 0; i < TEST_CLIENTS; i++)
+    {
+        pthread_join(clients[i].thread, NULL);
+        snprintf(id, sizeof(id), "\"id\":%d,", 100 + i);
+        CHECK(clients[i].ok && Contains(&clients[i].reply, id) && Contains(&clients[i].reply, "test://shared"),
+            "Client %d reply: %s", i, clients[i].reply.body != NULL ? clients[i].reply.body : "(none)");
+        free(clients[i].reply.body);
+    }
+
+    /* Other arguments are another request */
+    StartClient(&clients[0], "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"resources/list\",\"params\":{\"cursor\":\"a\"}}");
+    StartClient(&clients[1], "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"resources/list\",\"params\":{\"cursor\":\"b\"}}");
+    PROXY_SLEEP_MS(200);
+    executions = ServeRequests("{\"resources\":[]}", 300);
+    CHECK(executions == 2, "%d executions for two different requests", executions);
+    FinishClient(&clients[0]);
+    FinishClient(&clients[1]);
+}
+
+/*
+ * Tools that may change editor state run once per request
+ */
+static void TestMutatingNotShared(void)
+{
+    Client clients[3];
+    int executions;
+    int i;
+
+    for (i = 0; i < 3; i++)
+    {
+        StartClient(&clients[i], "{\"jsonrpc\":\"2.0\",\"id\":7,\"method\":\"tools/call\","
+            "\"params\":{\"name\":\"gameobject_create\",\"arguments\":{\"name\":\"Cube\"}}}");
+    }
+    PROXY_SLEEP_MS(200);
+    executions = ServeRequests("{\"content\":[]}", 300);
+    CHECK(executions == 3, "%d executions for 3 mutating requests", executions);
+    for (i = 0; i < 3; i++)
+    {
+        pthread_join(clients[i].thread, NULL);
+        CHECK(clients[i].ok && Contains(&clients[i].reply, "\"id\":7,"), "Mutating reply %d: %s", i,
+            clients[i].reply.body != NULL ? clients[i].reply.body : "(none)");
+        free(clients[i].reply.body);
+    }
+}
+
+/*
+ * resources/read replies carry an ETag; a client that sends it back gets
+ * "not modified" while the contents are unchanged
+ */
+static void TestConditionalRead(void)
+{
+    Client client;
+    char body[256];
+    char etag[17] = "";
+    static const char TAG[] = "\"_meta\":{\"etag\":\"";
+    const char* tag;
+    int executions;
+
+    StartClient(&client, "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"resources/read\",\"params\":{\"uri\":\"test://doc\"}}");
+    executions = ServeRequests("{\"contents\":[{\"text\":\"first\"}]}", 300);
+    pthread_join(client.thread, NULL);
+    tag = client.reply.body != NULL ? strstr(client.reply.body, TAG) : NULL;
+    CHECK(executions == 1 && tag != NULL && Contains(&client.reply, "first"),
+        "Tagged reply: %s", client.reply.body != NULL ? client.reply.body : "(none)");
+    if (tag != NULL)
+    {
+        memcpy(etag, tag + sizeof(TAG) - 1, 16);
+    }
+    free(client.reply.body);
+
+    /* Same contents: not modified */
+    snprintf(body, sizeof(body), "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"resources/read\","
+        "\"params\":{\"uri\":\"test://doc\",\"_meta\":{\"ifNoneMatch\":\"%s\"}}}", etag);
+    StartClient(&client, body);
+    ServeRequests("{\"contents\":[{\"text\":\"first\"}]}", 300);
+    pthread_join(client.thread, NULL);
+    CHECK(client.ok && Contains(&client.reply, "\"notModified\":true") && Contains(&client.reply, etag) &&
+        Contains(&client.reply, "\"id\":2") && !Contains(&client.reply, "first"),
+        "Matching ETag: %s", client.reply.body != NULL ? client.reply.body : "(none)");
+    free(client.reply.body);
+
+    /* Changed contents: the full reply under a new tag */
+    StartClient(&client, body);
+    ServeRequests("{\"contents\":[{\"text\":\"second\"}]}", 300);
+    pthread_join(client.thread, NULL);
+    CHECK(client.ok && Contains(&client.reply, "second") && !Contains(&client.reply, "notModified") &&
+        !Contains(&client.reply, etag), "Stale ETag: %s", client.reply.body != NULL ? client.reply.body : "(none)");
+    free(client.reply.body);
+}
+
+/*
+ * A response to a request that failed in the meantime must not answer the
+ * next request
+ */
+static void TestStaleResponse(void)
+{
+    Client first;
+    Client second;
+    char request[1024];
+    int first_sequence;
+    int second_sequence;
+
+    StartClient(&first, "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/call\",\"params\":{\"name\":\"slow_tool\"}}");
+    first_sequence = WaitForRequest(request, sizeof(request), 2000);
+    CHECK(first_sequence != 0, "First request not handed over");
+
+    /* A domain reload interrupts it before C# answers */
+    SetPollingActive(0);
+    pthread_join(first.thread, NULL);
+    CHECK(first.ok && Contains(&first.reply, "domain reload") && Contains(&first.reply, "\"id\":1"),
+        "Interrupted reply: %s", first.reply.body != NULL ? first.reply.body : "(none)");
+    free(first.reply.body);
+    SetPollingActive(1);
+
+    StartClient(&second, "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"tools/call\",\"params\":{\"name\":\"fast_tool\"}}");
+    second_sequence = WaitForRequest(request, sizeof(request), 2000);
+    CHECK(second_sequence != 0 && second_sequence != first_sequence, "Sequence %d reused for %d",
+        second_sequence, first_sequence);
+    CHECK(strstr(request, "fast_tool") != NULL, "Second request: %s", request);
+
+    /* The first request's answer finally arrives */
+    SendResponseForRequest(first_sequence, "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":{\"stale\":true}}");
+    PROXY_SLEEP_MS(100);
+    CHECK(!second.done, "Stale response answered the next request: %s",
+        second.reply.body != NULL ? second.reply.body : "(none)");
+    CHECK(GetPendingRequestSequence() == second_sequence, "Stale response cleared the pending request");
+
+    Answer(second_sequence, request, "{\"fresh\":true}");
+    pthread_join(second.thread, NULL);
+    CHECK(second.ok && Contains(&second.reply, "\"id\":2,") && Contains(&second.reply, "fresh") &&
+        !Contains(&second.reply, "stale"), "Second reply: %s", second.reply.body != NULL ? second.reply.body : "(none)");
+    CHECK(GetPendingRequestSequence() == 0, "Request still pending after its answer");
+    free(second.reply.body);
+}
+
+static int FileExists(const char* path)
+{
+    return access(path, F_OK) == 0;
+}
+
+/*
+ * Write {"jsonrpc":"2.0","id":<id>,"result":{"text":"aaa..."}} of about
+ * TEST_SPILL_SIZE bytes to the spill directory. Returns its length.
+ */
+static size_t WriteSpilledResponse(const char* path, const char* id)
+{
+    FILE* file = fopen(path, "wb");
+    size_t length = 0;
+    size_t i;
+
+    CHECK(file != NULL, "Cannot write %s", path);
+    if (file == NULL)
+    {
+        return 0;
+    }
+    length += (size_t)fprintf(file, "{\"jsonrpc\":\"2.0\",\"id\":%s,\"result\":{\"text\":\"", id);
+    for (i = 0; i < TEST_SPILL_SIZE; i++)
+    {
+        fputc('a' + (int)(i % 26), file);
+    }
+    length += TEST_SPILL_SIZE;
+    length += (size_t)fprintf(file, "\"}}");
+    fclose(file);
+    return length;
+}
+
+/* The text of a spilled reply arrived whole */
+static int IsSpilledText(const HttpReply* reply)
+{
+    const char* text = reply->body != NULL ? strstr(reply->body, "\"text\":\"") : NULL;
+    size_t i;
+
+    if (text == NULL)
+    {
+        return 0;
+    }
+    text += 8;
+    for (i = 0; i < TEST_SPILL_SIZE; i++)
+    {
+        if (text[i] != 'a' + (int)(i % 26))
+        {
+            return 0;
+        }
+    }
+    return strcmp(text + TEST_SPILL_SIZE, "\"}}") == 0;
+}
+
+/*
+ * Responses too large for SendResponse() are streamed from a spill file,
+ * which the proxy deletes afterwards
+ */
+static void TestSpilledResponse(void)
+{
+    Client clients[2];
+    char request[1024];
+    char path[1100];
+    size_t length;
+    int sequence;
+    int waited;
+    int i;
+
+    /* Only files directly inside the spill directory are taken */
+    CHECK(SendResponseFileForRequest(1, "/etc/passwd") == 0, "File outside the spill directory taken");
+
+    StartClient(&clients[0], "{\"jsonrpc\":\"2.0\",\"id\":11,\"method\":\"tools/call\",\"params\":{\"name\":\"big_tool\"}}");
+    sequence = WaitForRequest(request, sizeof(request), 2000);
+    snprintf(path, sizeof(path), "%s/response_1.json", s_spill_directory);
+    length = WriteSpilledResponse(path, "11");
+    CHECK(SendResponseFileForRequest(sequence, path) == 1, "Spill file not taken");
+    pthread_join(clients[0].thread, NULL);
+    CHECK(clients[0].ok && clients[0].reply.length == length && IsSpilledText(&clients[0].reply) &&
+        Contains(&clients[0].reply, "\"id\":11,"),
+        "Spilled reply of %lu bytes, expected %lu", (unsigned long)clients[0].reply.length, (unsigned long)length);
+    free(clients[0].reply.body);
+    for (waited = 0; waited < 1000 && FileExists(path); waited += 10)
+    {
+        PROXY_SLEEP_MS(10);
+    }
+    CHECK(!FileExists(path), "Spill file kept after sending");
+
+    /* Shared by coalesced clients, each with its own id */
+    StartClient(&clients[0], "{\"jsonrpc\":\"2.0\",\"id\":21,\"method\":\"resources/read\",\"params\":{\"uri\":\"test://big\"}}");
+    StartClient(&clients[1], "{\"jsonrpc\":\"2.0\",\"id\":\"twenty-two\",\"method\":\"resources/read\",\"params\":{\"uri\":\"test://big\"}}");
+    PROXY_SLEEP_MS(200);
+    sequence = WaitForRequest(request, sizeof(request), 2000);
+    snprintf(path, sizeof(path), "%s/response_2.json", s_spill_directory);
+    WriteSpilledResponse(path, strstr(request, "twenty-two") != NULL ? "\"twenty-two\"" : "21");
+    CHECK(SendResponseFileForRequest(sequence, path) == 1, "Shared spill file not taken");
+    for (i = 0; i < 2; i++)
+    {
+        pthread_join(clients[i].thread, NULL);
+        CHECK(clients[i].ok && IsSpilledText(&clients[i].reply) &&
+            Contains(&clients[i].reply, i == 0 ? "\"id\":21," : "\"id\":\"twenty-two\","),
+            "Shared spilled reply %d: %.60s", i, clients[i].reply.body != NULL ? clients[i].reply.body : "(none)");
+        free(clients[i].reply.body);
+    }
+    CHECK(WaitForRequest(request, sizeof(request), 100) == 0, "Coalesced request executed twice");
+
+    /* A spill file for a request that is gone is deleted unsent */
+    snprintf(path, sizeof(path), "%s/response_3.json", s_spill_directory);
+    WriteSpilledResponse(path, "31");
+    CHECK(SendResponseFileForRequest(sequence, path) == 1 && !FileExists(path), "Stale spill file kept");
+}
+
+/*
+ * Request bodies too large for the request buffer are streamed to a spill
+ * file that C# reads instead
+ */
+static void TestStreamedRequest(void)
+{
+    static const char PREFIX[] = "{\"jsonrpc\":\"2.0\",\"id\":41,\"method\":\"tools/call\","
+        "\"params\":{\"name\":\"import_data\",\"arguments\":{\"data\":\"";
+    size_t length = PROXY_MAX_REQUEST_SIZE * 4 + 123;
+    char* body = (char*)malloc(length + 1);
+    char* received = (char*)malloc(length + 1);
+    char path[1024] = "";
+    Client client;
+    FILE* file;
+    size_t read = 0;
+    size_t i;
+    int sequence = 0;
+    int waited;
+
+    memcpy(body, PREFIX, sizeof(PREFIX) - 1);
+    for (i = sizeof(PREFIX) - 1; i < length - 4; i++)
+    {
+        body[i] = (char)('0' + (i * 7) % 10);
+    }
+    memcpy(body + length - 4, "\"}}}", 5);
+
+    StartLargeClient(&client, body);
+    for (waited = 0; waited < 5000 && sequence == 0; waited++)
+    {
+        const char* pending = GetPendingRequestFile();
+        sequence = GetPendingRequestSequence();
+        if (pending != NULL && sequence != 0)
+        {
+            snprintf(path, sizeof(path), "%s", pending);
+        }
+        else
+        {
+            sequence = 0;
+            PROXY_SLEEP_MS(1);
+        }
+    }
+    CHECK(sequence != 0 && GetPendingRequest() == NULL, "Large request not handed over as a file");
+    CHECK(strncmp(path, s_spill_directory, strlen(s_spill_directory)) == 0, "Request file %s", path);
+
+    file = fopen(path, "rb");
+    if (file != NULL)
+    {
+        read = fread(received, 1, length + 1, file);
+        fclose(file);
+    }
+    CHECK(read == length && memcmp(received, body, length) == 0, "Request file holds %lu of %lu bytes",
+        (unsigned long)read, (unsigned long)length);
+
+    Answer(sequence, body, "{\"content\":[{\"type\":\"text\",\"text\":\"imported\"}]}");
+    pthread_join(client.thread, NULL);
+    CHECK(client.ok && Contains(&client.reply, "\"id\":41,") && Contains(&client.reply, "imported"),
+        "Large request reply: %s", client.reply.body != NULL ? client.reply.body : "(none)");
+    free(client.reply.body);
+    for (waited = 0; waited < 1000 && FileExists(path); waited += 10)
+    {
+        PROXY_SLEEP_MS(10);
+    }
+    CHECK(!FileExists(path), "Request file kept after the reply");
+
+    /* Without a spill directory (C# not initialized) the request is refused unread */
+    ConfigureSpillDirectory(NULL);
+    client.ok = HttpRequest("POST", "/", "Content-Type: application/json\r\n", NULL, length, &client.reply);
+    CHECK(client.ok && Contains(&client.reply, "-32600") && Contains(&client.reply, "Request too large"),
+        "Large request without a spill directory: %s", client.reply.body != NULL ? client.reply.body : "(none)");
+    CHECK(GetPendingRequestSequence() == 0, "Refused request handed over");
+    free(client.reply.body);
+    ConfigureSpillDirectory(s_spill_directory);
+
+    free(received);
+    free(body);
+}
+
+#define BOUNDARY "----proxytest7d2a"
+
+/*
+ * Append one multipart part to body at *length. filename may be NULL for a
+ * plain form field.
+ */
+static void AddPart(char* body, size_t* length, const char* name, const char* filename,
+    const char* data, size_t data_length)
+{
+    if (filename != NULL)
+    {
+        *length += (size_t)sprintf(body + *length, "--" BOUNDARY "\r\nContent-Disposition: form-data; "
+            "name=\"%s\"; filename=\"%s\"\r\nContent-Type: application/octet-stream\r\n\r\n", name, filename);
+    }
+    else
+    {
+        *length += (size_t)sprintf(body + *length, "--" BOUNDARY "\r\nContent-Disposition: form-data; "
+            "name=\"%s\"\r\n\r\n", name);
+    }
+    memcpy(body + *length, data, data_length);
+    *length += data_length;
+    *length += (size_t)sprintf(body + *length, "\r\n");
+}
+
+/*
+ * Copy the id of the index-th upload in a POST /upload reply to id.
+ */
+static int UploadId(const HttpReply* reply, int index, char* id, size_t capacity)
+{
+    char path[32];
+    char* value;
+
+    snprintf(path, sizeof(path), "$.uploads[%d].id", index);
+    value = reply->body != NULL ? mg_json_get_str(mg_str(reply->body), path) : NULL;
+    snprintf(id, capacity, "%s", value != NULL ? value : "");
+    mg_free(value);
+    return id[0] != '\0';
+}
+
+/* Contents of a staged upload equal data */
+static int IsStaged(const char* id, const char* data, size_t data_length)
+{
+    const char* path = GetStagedUpload(id);
+    char* contents = (char*)malloc(data_length + 1);
+    FILE* file;
+    size_t read = 0;
+
+    if (path == NULL || strncmp(path, s_staging_directory, strlen(s_staging_directory)) != 0 ||
+        strchr(path + strlen(s_staging_directory) + 1, '/') != NULL)
+    {
+        free(contents);
+        return 0;
+    }
+    file = fopen(path, "rb");
+    if (file != NULL)
+    {
+        read = fread(contents, 1, data_length + 1, file);
+        fclose(file);
+    }
+    read = read == data_length && memcmp(contents, data, data_length) == 0;
+    free(contents);
+    return (int)read;
+}
+
+/*
+ * Files posted to /upload as multipart/form-data are staged under safe
+ * names for file_import's upload_id
+ */
+static void TestStagedUpload(void)
+{
+    static const char MULTIPART[] = "Content-Type: multipart/form-data; boundary=" BOUNDARY "\r\n";
+    size_t large_length = PROXY_MAX_REQUEST_SIZE * 2;
+    char* large = (char*)malloc(large_length);
+    char* body = (char*)malloc(large_length + 4096);
+    char ids[4][STAGING_ID_LENGTH + 1];
+    char path[1100];
+    HttpReply reply;
+    size_t length = 0;
+    size_t i;
+    int ok;
+
+    for (i = 0; i < large_length; i++)
+    {
+        large[i] = (char)(i * 31 % 251);
+    }
+
+    AddPart(body, &length, "texture", "../../Assets/evil name.png", "PNG\0data", 8);
+    AddPart(body, &length, "comment", NULL, "not a file", 10);
+    AddPart(body, &length, "../mesh", "C:\\Users\\me\\model (1).fbx", "FBX", 3);
+    AddPart(body, &length, "dots", "..", "x", 1);
+    length += (size_t)sprintf(body + length, "--" BOUNDARY "--\r\n");
+
+    /* No staging directory yet (C# not initialized) */
+    ConfigureStagingDirectory(NULL);
+    ok = HttpRequest("POST", "/upload", MULTIPART, body, length, &reply);
+    CHECK(ok && reply.status == 500, "Upload without a staging directory: %d %s", reply.status,
+        reply.body != NULL ? reply.body : "(none)");
+    free(reply.body);
+    ConfigureStagingDirectory(s_staging_directory);
+
+    ok = HttpRequest("POST", "/upload", MULTIPART, body, length, &reply);
+    CHECK(ok && reply.status == 201, "Upload: %d %s", reply.status, reply.body != NULL ? reply.body : "(none)");
+    CHECK(Contains(&reply, "\"field\":\"texture\",\"filename\":\"evil_name.png\",\"size\":8") &&
+        Contains(&reply, "\"field\":\"mesh\",\"filename\":\"model__1_.fbx\",\"size\":3") &&
+        Contains(&reply, "\"field\":\"dots\",\"filename\":\"upload.bin\",\"size\":1") &&
+        !Contains(&reply, "comment"), "Staged names: %s", reply.body != NULL ? reply.body : "(none)");
+    ok = UploadId(&reply, 0, ids[0], sizeof(ids[0])) && UploadId(&reply, 1, ids[1], sizeof(ids[1])) &&
+        UploadId(&reply, 2, ids[2], sizeof(ids[2])) && !UploadId(&reply, 3, ids[3], sizeof(ids[3]));
+    CHECK(ok && strlen(ids[0]) == STAGING_ID_LENGTH && strcmp(ids[0], ids[1]) != 0, "Upload ids: %s",
+        reply.body != NULL ? reply.body : "(none)");
+    free(reply.body);
+    if (ok)
+    {
+        CHECK(IsStaged(ids[0], "PNG\0data", 8) && IsStaged(ids[1], "FBX", 3) && IsStaged(ids[2], "x", 1),
+            "Staged contents");
+        snprintf(path, sizeof(path), "%s", GetStagedUpload(ids[0]));
+        DropStagedUpload(ids[0]);
+        CHECK(GetStagedUpload(ids[0]) == NULL && !FileExists(path), "Dropped upload kept");
+        DropStagedUpload(ids[1]);
+        DropStagedUpload(ids[2]);
+    }
+    CHECK(GetStagedUpload("0123456789abcdef0123456789abcdef") == NULL, "Unknown upload found");
+
+    /* A body over the request buffer arrives through a spill file */
+    length = 0;
+    AddPart(body, &length, "file", "terrain.raw", large, large_length);
+    length += (size_t)sprintf(body + length, "--" BOUNDARY "--\r\n");
+    ok = HttpRequest("POST", "/upload", MULTIPART, body, length, &reply) && reply.status == 201 &&
+        UploadId(&reply, 0, ids[0], sizeof(ids[0]));
+    CHECK(ok && IsStaged(ids[0], large, large_length), "Large upload: %d %s", reply.status,
+        reply.body != NULL ? reply.body : "(none)");
+    free(reply.body);
+    if (ok)
+    {
+        DropStagedUpload(ids[0]);
+    }
+
+    ok = HttpRequest("POST", "/upload", "Content-Type: application/octet-stream\r\n", "abc", 3, &reply);
+    CHECK(ok && reply.status == 400, "Upload that is not multipart: %d", reply.status);
+    free(reply.body);
+    length = 0;
+    AddPart(body, &length, "comment", NULL, "no files", 8);
+    length += (size_t)sprintf(body + length, "--" BOUNDARY "--\r\n");
+    ok = HttpRequest("POST", "/upload", MULTIPART, body, length, &reply);
+    CHECK(ok && reply.status == 400 && Contains(&reply, "No file parts"), "Upload without files: %d", reply.status);
+    free(reply.body);
+
+    free(body);
+    free(large);
+}
+
+int main(int argc, char** argv)
+{
+    int port;
+
+    if (argc > 1)
+    {
+        printf("Usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    mg_log_set(MG_LL_ERROR);
+    for (port = TEST_FIRST_PORT; port < TEST_FIRST_PORT + 50; port++)
+    {
+        if (StartServer(port) == 0)
+        {
+            s_port = port;
+            break;
+        }
+    }
+    if (s_port == 0)
+    {
+        printf("Cannot listen on ports %d-%d\n", TEST_FIRST_PORT, TEST_FIRST_PORT + 49);
+        return 1;
+    }
+    SetPollingActive(1);
+    if (getcwd(s_spill_directory, sizeof(s_spill_directory) - 32) == NULL)
+    {
+        printf("Cannot get the working directory\n");
+        return 1;
+    }
+    strcat(s_spill_directory, "/proxy_test_spill");
+    mkdir(s_spill_directory, 0755);
+    ConfigureSpillDirectory(s_spill_directory);
+    snprintf(s_staging_directory, sizeof(s_staging_directory), "%s_staging", s_spill_directory);
+    mkdir(s_staging_directory, 0755);
+    ConfigureStagingDirectory(s_staging_directory);
+
+    TestCoalescing();
+    TestMutatingNotShared();
+    TestConditionalRead();
+    TestStaleResponse();
+    TestSpilledResponse();
+    TestStreamedRequest();
+    TestStagedUpload();
+
+    SetPollingActive(0);
+    StopServer();
+    ConfigureSpillDirectory(NULL);
+    ConfigureStagingDirectory(NULL);
+    rmdir(s_spill_directory);
+    rmdir(s_staging_directory);
+
+    printf("%d checks, %d failed\n", s_checks, s_failures);
+    return s_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,938 @@
+/*
+ * UnixxtyMCP Proxy - Reverse asset references
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "references.h"
+#include "assets.h"
+#include "project.h"
+#include "jsonutil.h"
+#include "workers.h"
+#include "platform.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define REFERENCES_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+#define GUID_BYTES 16
+#define GUID_PREFIX "guid: "
+#define GUID_PREFIX_LENGTH 6
+
+/* Files that serialize references to other assets as text */
+static const char* const REFERENCE_EXTENSIONS[] = {
+    ".unity", ".prefab", ".mat", ".asset", ".controller", ".overridecontroller", ".anim", ".mask",
+    ".playable", ".mixer", ".spriteatlas", ".terrainlayer", ".lighting",
+};
+
+typedef struct ReferenceTarget
+{
+    unsigned char guid[GUID_BYTES];
+    uint32_t count;                   /* Mentions in the file */
+} ReferenceTarget;
+
+typedef struct ReferenceFile
+{
+    int references;                   /* Indexes holding it; guarded by s_references_lock */
+    char* path;
+    uint64_t size;
+    int64_t modified;
+    ReferenceTarget* targets;         /* Sorted by GUID */
+    uint32_t target_count;
+} ReferenceFile;
+
+typedef struct ReferenceKey
+{
+    unsigned char guid[GUID_BYTES];
+    uint32_t start;                   /* First posting */
+    uint32_t count;                   /* 0 when the slot is empty */
+} ReferenceKey;
+
+typedef struct ReferenceIndex
+{
+    int references;
+    unsigned generation;              /* Project root generation it was built for */
+    ReferenceFile** files;            /* Sorted by path */
+    int file_count;
+    ReferenceKey* keys;               /* Open addressing by GUID */
+    uint32_t capacity;                /* Power of two */
+    uint32_t key_count;
+    uint32_t* postings;               /* File indexes, ascending per GUID */
+    size_t posting_count;
+    uint64_t built_at;
+    uint64_t build_ms;
+} ReferenceIndex;
+
+static ProxyMutex s_references_lock = PROXY_MUTEX_INITIALIZER;
+static ReferenceIndex* s_references_index = NULL;
+static int s_references_running = 0;
+static int s_references_again = 0;
+static char s_references_stats_buffer[256];
+
+static void FormatGuid(const unsigned char* guid, char* text)
+{
+    static const char DIGITS[] = "0123456789abcdef";
+    int i;
+    for (i = 0; i < GUID_BYTES; i++)
+    {
+        text[i * 2] = DIGITS[guid[i] >> 4];
+        text[i * 2 + 1] = DIGITS[guid[i] & 15];
+    }
+    text[GUID_BYTES * 2] = '\0';
+}
+
+static uint32_t GuidSlot(const unsigned char* guid, uint32_t capacity)
+{
+    uint64_t value;
+    memcpy(&value, guid, sizeof(value));
+    return (uint32_t)((value * 0x9e3779b97f4a7c15ull) >> 32) & (capacity - 1);
+}
+
+/*
+ * Files and indexes
+ */
+
+static void ReleaseFile(ReferenceFile* file)
+{
+    int last;
+
+    PROXY_MUTEX_LOCK(&s_references_lock);
+    last = --file->references == 0;
+    PROXY_MUTEX_UNLOCK(&s_references_lock);
+    if (last)
+    {
+        free(file->path);
+        free(file->targets);
+        free(file);
+    }
+}
+
+static void ReleaseIndex(ReferenceIndex* index)
+{
+    int last;
+    int i;
+
+    if (index == NULL)
+    {
+        return;
+    }
+    PROXY_MUTEX_LOCK(&s_references_lock);
+    last = --index->references == 0;
+    PROXY_MUTEX_UNLOCK(&s_references_lock);
+    if (!last)
+    {
+        return;
+    }
+    for (i = 0; i < index->file_count; i++)
+    {
+        ReleaseFile(index->files[i]);
+    }
+    free(index->files);
+    free(index->keys);
+    free(index->postings);
+    free(index);
+}
+
+static ReferenceIndex* AcquireIndex(void)
+{
+    ReferenceIndex* index;
+
+    PROXY_MUTEX_LOCK(&s_references_lock);
+    index = s_references_index;
+    if (index != NULL)
+    {
+        index->references++;
+    }
+    PROXY_MUTEX_UNLOCK(&s_references_lock);
+    return index;
+}
+
+static const ReferenceKey* FindKey(const ReferenceIndex* index, const unsigned char* guid)
+{
+    uint32_t slot;
+
+    if (index->capacity == 0)
+    {
+        return NULL;
+    }
+    for (slot = GuidSlot(guid, index->capacity); index->keys[slot].count != 0;
+         slot = (slot + 1) & (index->capacity - 1))
+    {
+        if (memcmp(index->keys[slot].guid, guid, GUID_BYTES) == 0)
+        {
+            return &index->keys[slot];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Scanning one file
+ */
+
+/*
+ * Decode 32 lowercase hex digits, as Unity writes GUIDs. Returns 0 if they
+ * are not. Hex letters are told from digits by bit 6, without branches;
+ * random digits would mispredict a branch per character.
+ */
+static int DecodeGuid(const char* text, unsigned char* guid)
+{
+    int i;
+
+#ifdef REFERENCES_SSE2
+    {
+        const __m128i digit_low = _mm_set1_epi8('0' - 1);
+        const __m128i digit_high = _mm_set1_epi8('9' + 1);
+        const __m128i letter_low = _mm_set1_epi8('a' - 1);
+        const __m128i letter_high = _mm_set1_epi8('f' + 1);
+        for (i = 0; i < 32; i += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(text + i));
+            __m128i valid = _mm_or_si128(
+                _mm_and_si128(_mm_cmpgt_epi8(v, digit_low), _mm_cmplt_epi8(v, digit_high)),
+                _mm_and_si128(_mm_cmpgt_epi8(v, letter_low), _mm_cmplt_epi8(v, letter_high)));
+            if (_mm_movemask_epi8(valid) != 0xffff)
+            {
+                return 0;
+            }
+        }
+    }
+#else
+    for (i = 0; i < 32; i++)
+    {
+        if (!((text[i] >= '0' && text[i] <= '9') || (text[i] >= 'a' && text[i] <= 'f')))
+        {
+            return 0;
+        }
+    }
+#endif
+    for (i = 0; i < GUID_BYTES; i++)
+    {
+        unsigned char high = (unsigned char)text[i * 2];
+        unsigned char low = (unsigned char)text[i * 2 + 1];
+        guid[i] = (unsigned char)((((high & 15) + 9 * (high >> 6)) << 4) | ((low & 15) + 9 * (low >> 6)));
+    }
+    return 1;
+}
+
+/*
+ * The distinct GUIDs of one file with their mention counts, deduplicated
+ * through a hash set as they are found (a scene mentions the same few
+ * materials and prefabs thousands of times).
+ */
+typedef struct TargetSet
+{
+    ReferenceTarget* items;
+    uint32_t count;
+    uint32_t* slots;                  /* Item index + 1, 0 when empty */
+    uint32_t capacity;                /* Power of two, at least twice count */
+} TargetSet;
+
+static void AddMention(TargetSet* set, const char* digits)
+{
+    unsigned char guid[GUID_BYTES];
+    uint32_t slot;
+
+    if (!DecodeGuid(digits, guid))
+    {
+        return;
+    }
+    if ((set->count + 1) * 2 > set->capacity)
+    {
+        uint32_t capacity = set->capacity > 0 ? set->capacity * 2 : 256;
+        uint32_t* slots = (uint32_t*)calloc(capacity, sizeof(uint32_t));
+        ReferenceTarget* items = (ReferenceTarget*)realloc(set->items, (capacity / 2) * sizeof(ReferenceTarget));
+        uint32_t i;
+
+        if (items != NULL)
+        {
+            set->items = items;
+        }
+        if (slots == NULL || items == NULL)
+        {
+            free(slots);
+            return;
+        }
+        for (i = 0; i < set->count; i++)
+        {
+            for (slot = GuidSlot(set->items[i].guid, capacity); slots[slot] != 0; slot = (slot + 1) & (capacity - 1))
+            {
+            }
+            slots[slot] = i + 1;
+        }
+        free(set->slots);
+        set->slots = slots;
+        set->capacity = capacity;
+    }
+
+    for (slot = GuidSlot(guid, set->capacity); set->slots[slot] != 0; slot = (slot + 1) & (set->capacity - 1))
+    {
+        ReferenceTarget* target = &set->items[set->slots[slot] - 1];
+        if (memcmp(target->guid, guid, GUID_BYTES) == 0)
+        {
+            target->count++;
+            return;
+        }
+    }
+    memcpy(set->items[set->count].guid, guid, GUID_BYTES);
+    set->items[set->count].count = 1;
+    set->slots[slot] = ++set->count;
+}
+
+/*
+ * Collect every "guid: <32 hex digits>" of a buffer. Positions holding 'g'
+ * with ':' four bytes later are found sixteen at a time and then checked.
+ */
+static void ScanMentions(const char* data, size_t length, TargetSet* set)
+{
+    const size_t needed = GUID_PREFIX_LENGTH + GUID_BYTES * 2;
+    size_t i = 0;
+
+    if (length < needed)
+    {
+        return;
+    }
+#ifdef REFERENCES_SSE2
+    {
+        const __m128i first = _mm_set1_epi8('g');
+        const __m128i colon = _mm_set1_epi8(':');
+
+        for (; i + 4 + 16 <= length; i += 16)
+        {
+            __m128i head = _mm_loadu_si128((const __m128i*)(data + i));
+            __m128i tail = _mm_loadu_si128((const __m128i*)(data + i + 4));
+            unsigned mask = (unsigned)_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, colon)));
+
+            while (mask != 0)
+            {
+                int bit = 0;
+                size_t at;
+                while ((mask & (1u << bit)) == 0)
+                {
+                    bit++;
+                }
+                mask &= mask - 1;
+                at = i + (size_t)bit;
+                if (at + needed <= length && memcmp(data + at, GUID_PREFIX, GUID_PREFIX_LENGTH) == 0)
+                {
+                    AddMention(set, data + at + GUID_PREFIX_LENGTH);
+                }
+            }
+        }
+    }
+#endif
+    for (; i + needed <= length; i++)
+    {
+        if (data[i] == 'g' && memcmp(data + i, GUID_PREFIX, GUID_PREFIX_LENGTH) == 0)
+        {
+            AddMention(set, data + i + GUID_PREFIX_LENGTH);
+        }
+    }
+}
+
+static int CompareTargets(const void* a, const void* b)
+{
+    return memcmp(((const ReferenceTarget*)a)->guid, ((const ReferenceTarget*)b)->guid, GUID_BYTES);
+}
+
+/*
+ * Map a file and record the GUIDs it mentions, with their counts.
+ */
+static void ScanFile(ReferenceFile* file)
+{
+    ProjectMapping mapping;
+    TargetSet set;
+
+    free(file->targets);
+    file->targets = NULL;
+    file->target_count = 0;
+    if (!ProjectMapFile(file->path, REFERENCES_MAX_FILE_SIZE, &mapping))
+    {
+        return;
+    }
+    memset(&set, 0, sizeof(set));
+    if (mapping.data != NULL)
+    {
+        ScanMentions(mapping.data, mapping.length, &set);
+    }
+    ProjectUnmapFile(&mapping);
+    free(set.slots);
+    if (set.count == 0)
+    {
+        free(set.items);
+        return;
+    }
+
+    qsort(set.items, set.count, sizeof(ReferenceTarget), CompareTargets);
+    file->targets = (ReferenceTarget*)realloc(set.items, set.count * sizeof(ReferenceTarget));
+    if (file->targets == NULL)
+    {
+        file->targets = set.items;
+    }
+    file->target_count = set.count;
+}
+
+typedef struct ScanJob
+{
+    ReferenceFile** files;
+} ScanJob;
+
+static void ScanRange(void* context, int begin, int end)
+{
+    ScanJob* job = (ScanJob*)context;
+    int i;
+
+    for (i = begin; i < end; i++)
+    {
+        ScanFile(job->files[i]);
+    }
+}
+
+/*
+ * Building the reverse table
+ */
+
+/*
+ * Slot for a GUID in a table under construction, growing it at half load.
+ * Returns UINT32_MAX if out of memory.
+ */
+static uint32_t InsertKey(ReferenceIndex* index, const unsigned char* guid)
+{
+    uint32_t slot;
+
+    if (index->key_count * 2 >= index->capacity)
+    {
+        uint32_t capacity = index->capacity * 2;
+        ReferenceKey* keys = (ReferenceKey*)calloc(capacity, sizeof(ReferenceKey));
+        uint32_t i;
+
+        if (keys == NULL)
+        {
+            return UINT32_MAX;
+        }
+        for (i = 0; i < index->capacity; i++)
+        {
+            if (index->keys[i].count != 0)
+            {
+                for (slot = GuidSlot(index->keys[i].guid, capacity); keys[slot].count != 0;
+                     slot = (slot + 1) & (capacity - 1))
+                {
+                }
+                keys[slot] = index->keys[i];
+            }
+        }
+        free(index->keys);
+        index->keys = keys;
+        index->capacity = capacity;
+    }
+
+    for (slot = GuidSlot(guid, index->capacity);
+         index->keys[slot].count != 0 && memcmp(index->keys[slot].guid, guid, GUID_BYTES) != 0;
+         slot = (slot + 1) & (index->capacity - 1))
+    {
+    }
+    if (index->keys[slot].count == 0)
+    {
+        memcpy(index->keys[slot].guid, guid, GUID_BYTES);
+        index->key_count++;
+    }
+    return slot;
+}
+
+static int BuildPostings(ReferenceIndex* index)
+{
+    size_t total = 0;
+    uint32_t slot;
+    int i;
+    uint32_t k;
+
+    index->capacity = 1u << 12;
+    if ((index->keys = (ReferenceKey*)calloc(index->capacity, sizeof(ReferenceKey))) == NULL)
+    {
+        return 0;
+    }
+
+    /* Count the files per GUID */
+    for (i = 0; i < index->file_count; i++)
+    {
+        const ReferenceFile* file = index->files[i];
+        for (k = 0; k < file->target_count; k++)
+        {
+            if ((slot = InsertKey(index, file->targets[k].guid)) == UINT32_MAX)
+            {
+                return 0;
+            }
+            index->keys[slot].count++;
+            total++;
+        }
+    }
+    if (total > UINT32_MAX)
+    {
+        return 0;
+    }
+
+    index->posting_count = total;
+    if ((index->postings = (uint32_t*)malloc((total > 0 ? total : 1) * sizeof(uint32_t))) == NULL)
+    {
+        return 0;
+    }
+    total = 0;
+    for (slot = 0; slot < index->capacity; slot++)
+    {
+        index->keys[slot].start = (uint32_t)total;
+        total += index->keys[slot].count;
+    }
+
+    /* Files are visited in order, so each posting list comes out ascending */
+    for (i = 0; i < index->file_count; i++)
+    {
+        const ReferenceFile* file = index->files[i];
+        for (k = 0; k < file->target_count; k++)
+        {
+            ReferenceKey* key = (ReferenceKey*)FindKey(index, file->targets[k].guid);
+            index->postings[key->start++] = (uint32_t)i;
+        }
+    }
+    for (slot = 0; slot < index->capacity; slot++)
+    {
+        index->keys[slot].start -= index->keys[slot].count;
+    }
+    return 1;
+}
+
+/*
+ * Scanning the project
+ */
+
+typedef struct ScanState
+{
+    ReferenceFile** files;
+    int count;
+    int capacity;
+} ScanState;
+
+int ReferencesAffectedBy(const char* path)
+{
+    const char* slash = strrchr(path, '/');
+    const char* extension = strrchr(slash != NULL ? slash : path, '.');
+    size_t i;
+
+    for (i = 0; extension != NULL && i < sizeof(REFERENCE_EXTENSIONS) / sizeof(REFERENCE_EXTENSIONS[0]); i++)
+    {
+        if (mg_strcasecmp(mg_str(extension), mg_str(REFERENCE_EXTENSIONS[i])) == 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int CollectFile(void* context, const char* path, uint64_t size, int64_t modified)
+{
+    ScanState* state = (ScanState*)context;
+    ReferenceFile* file;
+
+    if (!ReferencesAffectedBy(path) || size > REFERENCES_MAX_FILE_SIZE)
+    {
+        return 1;
+    }
+    if (state->count == state->capacity)
+    {
+        int capacity = state->capacity > 0 ? state->capacity * 2 : 4096;
+        ReferenceFile** grown = (ReferenceFile**)realloc(state->files, (size_t)capacity * sizeof(ReferenceFile*));
+        if (grown == NULL)
+        {
+            return 0;
+        }
+        state->files = grown;
+        state->capacity = capacity;
+    }
+    file = (ReferenceFile*)calloc(1, sizeof(ReferenceFile));
+    if (file == NULL || (file->path = (char*)malloc(strlen(path) + 1)) == NULL)
+    {
+        free(file);
+        return 0;
+    }
+    memcpy(file->path, path, strlen(path) + 1);
+    file->references = 1;
+    file->size = size;
+    file->modified = modified;
+    state->files[state->count++] = file;
+    return 1;
+}
+
+static int CompareFilePaths(const void* a, const void* b)
+{
+    return strcmp((*(ReferenceFile* const*)a)->path, (*(ReferenceFile* const*)b)->path);
+}
+
+static ReferenceFile* FindFile(const ReferenceIndex* index, const char* path)
+{
+    int low = 0;
+    int high = index->file_count - 1;
+
+    while (low <= high)
+    {
+        int middle = low + (high - low) / 2;
+        int order = strcmp(index->files[middle]->path, path);
+        if (order == 0)
+        {
+            return index->files[middle];
+        }
+        if (order < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Walk the project and build a new index, reusing unchanged files of the
+ * previous one. Returns NULL if no root is configured or out of memory.
+ */
+static ReferenceIndex* BuildIndex(ReferenceIndex* previous)
+{
+    char root[PROJECT_MAX_PATH];
+    ScanState scan;
+    ScanJob job;
+    ReferenceIndex* index;
+    uint64_t started = mg_millis();
+    unsigned generation = ProjectRoot(root, sizeof(root));
+    int scan_count = 0;
+    int i;
+
+    memset(&scan, 0, sizeof(scan));
+    if (generation == 0 || ProjectWalk(CollectFile, &scan) < 0)
+    {
+        free(scan.files);
+        return NULL;
+    }
+    if (scan.count > 0)
+    {
+        qsort(scan.files, (size_t)scan.count, sizeof(ReferenceFile*), CompareFilePaths);
+    }
+
+    /* Take over the GUID lists of files that did not change */
+    job.files = (ReferenceFile**)malloc((size_t)(scan.count > 0 ? scan.count : 1) * sizeof(ReferenceFile*));
+    for (i = 0; i < scan.count && job.files != NULL; i++)
+    {
+        ReferenceFile* file = scan.files[i];
+        ReferenceFile* old = previous != NULL && previous->generation == generation
+            ? FindFile(previous, file->path) : NULL;
+        if (old != NULL && old->size == file->size && old->modified == file->modified)
+        {
+            PROXY_MUTEX_LOCK(&s_references_lock);
+            old->references++;
+            PROXY_MUTEX_UNLOCK(&s_references_lock);
+            ReleaseFile(file);
+            scan.files[i] = old;
+        }
+        else
+        {
+            job.files[scan_count++] = file;
+        }
+    }
+    if (job.files != NULL)
+    {
+        WorkerParallelFor(scan_count, 4, ScanRange, &job);
+    }
+    free(job.files);
+
+    index = (ReferenceIndex*)calloc(1, sizeof(ReferenceIndex));
+    if (index == NULL)
+    {
+        for (i = 0; i < scan.count; i++)
+        {
+            ReleaseFile(scan.files[i]);
+        }
+        free(scan.files);
+        return NULL;
+    }
+    index->references = 1;
+    index->generation = generation;
+    index->files = scan.files;
+    index->file_count = scan.count;
+    if (!BuildPostings(index))
+    {
+        ReleaseIndex(index);
+        return NULL;
+    }
+    index->built_at = mg_millis();
+    index->build_ms = index->built_at - started;
+    return index;
+}
+
+static void RebuildTask(void* context)
+{
+    (void)context;
+    for (;;)
+    {
+        ReferenceIndex* previous = AcquireIndex();
+        ReferenceIndex* index = BuildIndex(previous);
+        ReferenceIndex* replaced = NULL;
+        int again;
+
+        PROXY_MUTEX_LOCK(&s_references_lock);
+        if (index != NULL)
+        {
+            replaced = s_references_index;
+            s_references_index = index;
+        }
+        again = s_references_again;
+        s_references_again = 0;
+        if (!again)
+        {
+            s_references_running = 0;
+        }
+        PROXY_MUTEX_UNLOCK(&s_references_lock);
+
+        ReleaseIndex(replaced);
+        ReleaseIndex(previous);
+        if (!again)
+        {
+            return;
+        }
+    }
+}
+
+/*
+ * Start a scan unless one is running; `again` schedules another one after it.
+ */
+static void StartScan(int again)
+{
+    int start;
+
+    PROXY_MUTEX_LOCK(&s_references_lock);
+    start = !s_references_running;
+    if (start)
+    {
+        s_references_running = 1;
+    }
+    else if (again)
+    {
+        s_references_again = 1;
+    }
+    PROXY_MUTEX_UNLOCK(&s_references_lock);
+
+    if (start && !WorkerSubmit(RebuildTask, NULL))
+    {
+        PROXY_MUTEX_LOCK(&s_references_lock);
+        s_references_running = 0;
+        PROXY_MUTEX_UNLOCK(&s_references_lock);
+    }
+}
+
+void ReferencesRefresh(void)
+{
+    StartScan(1);
+}
+
+/*
+ * Get reverse reference index statistics as a JSON object.
+ */
+EXPORT const char* GetReferenceIndexStats(void)
+{
+    ReferenceIndex* index = AcquireIndex();
+    int running;
+
+    PROXY_MUTEX_LOCK(&s_references_lock);
+    running = s_references_running;
+    PROXY_MUTEX_UNLOCK(&s_references_lock);
+
+    if (index == NULL)
+    {
+        snprintf(s_references_stats_buffer, sizeof(s_references_stats_buffer),
+            "{\"ready\":false,\"scanning\":%s}", running ? "true" : "false");
+        return s_references_stats_buffer;
+    }
+    snprintf(s_references_stats_buffer, sizeof(s_references_stats_buffer),
+        "{\"ready\":true,\"scanning\":%s,\"files\":%d,\"guids\":%lu,\"references\":%lu,\"build_ms\":%lu,"
+        "\"age_ms\":%lu}",
+        running ? "true" : "false", index->file_count, (unsigned long)index->key_count,
+        (unsigned long)index->posting_count, (unsigned long)index->build_ms,
+        (unsigned long)(mg_millis() - index->built_at));
+    ReleaseIndex(index);
+    return s_references_stats_buffer;
+}
+
+/*
+ * Queries
+ */
+
+/*
+ * Mentions of a GUID in a file's sorted target list.
+ */
+static uint32_t CountMentions(const ReferenceFile* file, const unsigned char* guid)
+{
+    uint32_t low = 0;
+    uint32_t high = file->target_count;
+
+    while (low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+        int order = memcmp(file->targets[middle].guid, guid, GUID_BYTES);
+        if (order == 0)
+        {
+            return file->targets[middle].count;
+        }
+        if (order < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Find the target GUID from the params. Returns NULL or an error message.
+ */
+static const char* ParseTarget(struct mg_str request, char* guid, char* path, size_t path_capacity, int* code)
+{
+    char* value;
+    unsigned char bytes[GUID_BYTES];
+
+    *code = -32602;
+    /* mongoose allocates from the pool (mg_free) */
+    if ((value = mg_json_get_str(request, "$.params.guid")) != NULL)
+    {
+        char* p;
+        int valid;
+        for (p = value; *p != '\0'; p++)
+        {
+            *p = (char)((*p >= 'A' && *p <= 'F') ? *p + 32 : *p);
+        }
+        valid = strlen(value) == ASSETS_GUID_LENGTH && DecodeGuid(value, bytes);
+        mg_free(value);
+        if (!valid)
+        {
+            return "guid must be 32 hex digits";
+        }
+        FormatGuid(bytes, guid);
+        if (!AssetsFindPath(guid, path, path_capacity))
+        {
+            path[0] = '\0';
+        }
+        return NULL;
+    }
+    if ((value = mg_json_get_str(request, "$.params.path")) != NULL)
+    {
+        char* p;
+        int found;
+        for (p = value; *p != '\0'; p++)
+        {
+            if (*p == '\\')
+            {
+                *p = '/';
+            }
+        }
+        found = strlen(value) < path_capacity && AssetsFindGuid(value, guid);
+        if (found)
+        {
+            memcpy(path, value, strlen(value) + 1);
+        }
+        mg_free(value);
+        if (!found)
+        {
+            /* The asset index may not be built yet; it knows every path with a .meta */
+            *code = PROJECT_ERROR_NOT_READY;
+            return "Asset path not in the asset index (unknown, or the index is being built)";
+        }
+        return NULL;
+    }
+    return "guid or path is required";
+}
+
+int ReferencesMethod(struct mg_str request, struct mg_iobuf* result, const char** error)
+{
+    uint64_t started = mg_millis();
+    char guid[ASSETS_GUID_LENGTH + 1];
+    char path[PROJECT_MAX_PATH];
+    unsigned char bytes[GUID_BYTES];
+    ReferenceIndex* index;
+    const ReferenceKey* key;
+    long max_results = mg_json_get_long(request, "$.params.max_results", REFERENCES_DEFAULT_RESULTS);
+    uint32_t count;
+    uint32_t i;
+    int code;
+    char summary[192];
+
+    if ((*error = ParseTarget(request, guid, path, sizeof(path), &code)) != NULL)
+    {
+        return code;
+    }
+    DecodeGuid(guid, bytes);
+    max_results = max_results < 1 ? 1 : max_results > REFERENCES_MAX_RESULTS ? REFERENCES_MAX_RESULTS : max_results;
+
+    index = AcquireIndex();
+    if (index == NULL)
+    {
+        StartScan(0);
+    }
+    {
+        char root[PROJECT_MAX_PATH];
+        unsigned generation = ProjectRoot(root, sizeof(root));
+
+        /* An index of another root or exclude set would answer for the wrong files */
+        if (index != NULL && index->generation != generation)
+        {
+            ReleaseIndex(index);
+            index = NULL;
+        }
+        if (index == NULL)
+        {
+            *error = generation == 0 ? "Project root not configured"
+                : "Reference index is being built; retry shortly";
+            return PROJECT_ERROR_NOT_READY;
+        }
+    }
+
+    mg_iobuf_add(result, result->len, "{\"guid\":\"", 9);
+    mg_iobuf_add(result, result->len, guid, ASSETS_GUID_LENGTH);
+    mg_iobuf_add(result, result->len, "\",\"path\":", 9);
+    if (path[0] != '\0')
+    {
+        JsonAppendString(result, path, strlen(path));
+    }
+    else
+    {
+        mg_iobuf_add(result, result->len, "null", 4);
+    }
+    mg_iobuf_add(result, result->len, ",\"references\":[", 15);
+
+    key = FindKey(index, bytes);
+    count = key != NULL ? key->count : 0;
+    for (i = 0; i < count && i < (uint32_t)max_results; i++)
+    {
+        const ReferenceFile* file = index->files[index->postings[key->start + i]];
+        char number[48];
+
+        mg_iobuf_add(result, result->len, i > 0 ? ",{\"path\":" : "{\"path\":", i > 0 ? 9 : 8);
+        JsonAppendString(result, file->path, strlen(file->path));
+        snprintf(number, sizeof(number), ",\"count\":%lu}", (unsigned long)CountMentions(file, bytes));
+        mg_iobuf_add(result, result->len, number, strlen(number));
+    }
+
+    snprintf(summary, sizeof(summary),
+        "],\"truncated\":%s,\"files_scanned\":%d,\"index_age_ms\":%lu,\"elapsed_ms\":%lu}",
+        count > (uint32_t)max_results ? "true" : "false", index->file_count,
+        (unsigned long)(mg_millis() - index->built_at), (unsigned long)(mg_millis() - started));
+    mg_iobuf_add(result, result->len, summary, strlen(summary));
+    ReleaseIndex(index);
+    return 0;
+}
@@ -0,0 +1,56 @@
+/*
+ * UnixxtyMCP Proxy - Reverse asset references
+ *
+ * Answers the "assets/references" JSON-RPC method ("who uses this asset")
+ * on the server thread, without Unity loading anything. Scenes, prefabs,
+ * materials and the other text-serialized assets refer to other assets as
+ * "{fileID: ..., guid: <32 hex digits>, type: ...}"; every such file is
+ * memory-mapped and scanned for "guid: " sixteen bytes at a time with SSE2,
+ * and the GUIDs it mentions are kept per file. A reverse table maps each
+ * GUID to the files mentioning it, so a lookup costs one hash probe.
+ *
+ * Like the search index, it is built on the worker pool and refreshed after
+ * every batch of changes to those files from the file watcher (see
+ * watcher.h); files whose size and modification time are unchanged keep
+ * their GUID lists, so a refresh costs a walk plus the changed files.
+ * Binary-serialized assets mention no GUIDs in text and are not found.
+ *
+ * Request params:
+ *   guid         GUID of the asset whose users to find, or
+ *   path         its path, resolved through the asset index (see assets.h)
+ *   max_results  Default REFERENCES_DEFAULT_RESULTS, at most
+ *                REFERENCES_MAX_RESULTS
+ *
+ * Result: {"guid", "path", "references":[{"path","count"}], "truncated",
+ * "files_scanned", "index_age_ms", "elapsed_ms"}, with the referencing
+ * files sorted by path and the number of times each mentions the GUID.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_REFERENCES_H
+#define UNITY_MCP_REFERENCES_H
+
+#include "mongoose.h"
+
+#define REFERENCES_MAX_FILE_SIZE (1024u * 1024u * 1024u)
+#define REFERENCES_DEFAULT_RESULTS 500
+#define REFERENCES_MAX_RESULTS 20000
+
+/*
+ * Start a background rescan of the referencing files, or schedule another
+ * one after the scan in progress.
+ */
+void ReferencesRefresh(void);
+
+/*
+ * True if a change to this project-relative path can change the index.
+ */
+int ReferencesAffectedBy(const char* path);
+
+/*
+ * The "assets/references" method (a ProjectMethod, see project.h).
+ */
+int ReferencesMethod(struct mg_str request, struct mg_iobuf* result, const char** error);
+
+#endif /* UNITY_MCP_REFERENCES_H */
@@ -0,0 +1,2177 @@
+/*
+ * UnixxtyMCP Proxy - Scene and prefab reader
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "scenes.h"
+#include "assets.h"
+#include "project.h"
+#include "jsonutil.h"
+#include "workers.h"
+#include "platform.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SCENE_NONE 0xffffffffu
+#define GUID_BYTES 16
+#define MAX_KEYS 32                   /* Nesting kept for field names */
+#define MAX_FIELD 256
+#define MAX_NAME 1024
+
+#define CLASS_GAME_OBJECT 1
+#define CLASS_TRANSFORM 4
+#define CLASS_MONO_BEHAVIOUR 114
+#define CLASS_RECT_TRANSFORM 224
+#define CLASS_PREFAB_INSTANCE 1001
+#define CLASS_SCENE_ROOTS 1660057539
+
+typedef struct SceneObject
+{
+    int64_t file_id;
+    int64_t game_object;              /* Components: m_GameObject */
+    int64_t father;                   /* Transforms: m_Father */
+    int64_t prefab_instance;          /* Objects of a prefab instance: m_PrefabInstance */
+    int64_t transform_parent;         /* Prefab instances: m_TransformParent */
+    int32_t class_id;
+    int32_t root_order;               /* Transforms: m_RootOrder, -1 if absent */
+    int32_t layer;
+    uint32_t type;                    /* String id of the class name ("MonoBehaviour") */
+    uint32_t name;                    /* String ids, SCENE_NONE if absent */
+    uint32_t tag;
+    uint32_t member_start;            /* m_Component, m_Children or m_Roots entries */
+    uint32_t member_count;
+    uint32_t link_start;              /* References to objects and assets */
+    uint32_t link_count;
+    uint32_t parent;                  /* Nodes (GameObjects, prefab instances): parent node */
+    uint32_t child_start;             /* Nodes: children in the file's child list */
+    uint32_t child_count;
+    unsigned char asset[GUID_BYTES];  /* m_Script, or m_SourcePrefab of an instance */
+    uint8_t has_asset;
+    int8_t active;                    /* m_IsActive or m_Enabled, -1 if absent */
+    uint8_t stripped;                 /* Stand-in for an object of a prefab instance */
+} SceneObject;
+
+typedef struct SceneLink
+{
+    int64_t file_id;
+    uint32_t field;                   /* String id of the field path ("settings.target") */
+    uint8_t has_guid;                 /* 0 for objects of the same file */
+    unsigned char guid[GUID_BYTES];
+} SceneLink;
+
+/*
+ * Interned strings: names, tags, class names and field paths repeat a lot.
+ */
+typedef struct SceneStrings
+{
+    char* text;                       /* NUL-terminated strings back to back */
+    size_t length;
+    size_t capacity;
+    uint32_t* offsets;                /* By string id */
+    uint32_t count;
+    uint32_t offset_capacity;
+    uint32_t* slots;                  /* String id + 1, 0 when empty */
+    uint32_t slot_capacity;           /* Power of two */
+} SceneStrings;
+
+/*
+ * Objects parsed from one chunk of the file.
+ */
+typedef struct SceneBuilder
+{
+    SceneObject* objects;
+    uint32_t object_count;
+    uint32_t object_capacity;
+    int64_t* members;
+    uint32_t member_count;
+    uint32_t member_capacity;
+    SceneLink* links;
+    uint32_t link_count;
+    uint32_t link_capacity;
+    SceneStrings strings;
+    int failed;                       /* Out of memory */
+} SceneBuilder;
+
+typedef struct SceneFile
+{
+    char path[PROJECT_MAX_PATH];
+    unsigned generation;
+    uint64_t size;
+    int64_t modified;
+    SceneObject* objects;             /* In file order */
+    uint32_t object_count;
+    uint32_t* by_id;                  /* Object indexes sorted by file ID */
+    int64_t* members;
+    uint32_t member_count;
+    SceneLink* links;
+    uint32_t link_count;
+    uint32_t* children;               /* Node indexes grouped by parent, in order */
+    uint32_t* roots;
+    uint32_t root_count;
+    SceneStrings strings;
+    size_t bytes;
+    uint64_t parse_ms;
+    uint64_t used_at;
+} SceneFile;
+
+/* Touched by the server thread only; the lock is for the statistics */
+static ProxyMutex s_scenes_lock = PROXY_MUTEX_INITIALIZER;
+static SceneFile* s_scenes_cache[SCENES_CACHE_FILES];
+static int s_scenes_cache_count = 0;
+static unsigned long s_scenes_parses = 0;
+static unsigned long s_scenes_hits = 0;
+static char s_scenes_stats_buffer[256];
+
+/*
+ * Storage
+ */
+
+static int Reserve(void** items, uint32_t* capacity, uint32_t needed, size_t item_size)
+{
+    uint32_t grown;
+    void* resized;
+
+    if (needed <= *capacity)
+    {
+        return 1;
+    }
+    grown = *capacity > 0 ? *capacity : 64;
+    while (grown < needed)
+    {
+        grown *= 2;
+    }
+    if ((resized = realloc(*items, (size_t)grown * item_size)) == NULL)
+    {
+        return 0;
+    }
+    *items = resized;
+    *capacity = grown;
+    return 1;
+}
+
+static uint32_t StringSlot(const char* text, size_t length, uint32_t capacity)
+{
+    return (uint32_t)JsonHash64(text, length, JSON_HASH_SEED) & (capacity - 1);
+}
+
+/*
+ * Id of a string, added if new, or SCENE_NONE when out of memory.
+ */
+static uint32_t Intern(SceneStrings* strings, const char* text, size_t length)
+{
+    uint32_t slot;
+
+    if ((strings->count + 1) * 2 > strings->slot_capacity)
+    {
+        uint32_t capacity = strings->slot_capacity > 0 ? strings->slot_capacity * 2 : 256;
+        uint32_t* slots = (uint32_t*)calloc(capacity, sizeof(uint32_t));
+        uint32_t i;
+
+        if (slots == NULL)
+        {
+            return SCENE_NONE;
+        }
+        for (i = 0; i < strings->count; i++)
+        {
+            const char* existing = strings->text + strings->offsets[i];
+            for (slot = StringSlot(existing, strlen(existing), capacity); slots[slot] != 0;
+                slot = (slot + 1) & (capacity - 1))
+            {
+            }
+            slots[slot] = i + 1;
+        }
+        free(strings->slots);
+        strings->slots = slots;
+        strings->slot_capacity = capacity;
+    }
+
+    for (slot = StringSlot(text, length, strings->slot_capacity); strings->slots[slot] != 0;
+        slot = (slot + 1) & (strings->slot_capacity - 1))
+    {
+        const char* existing = strings->text + strings->offsets[strings->slots[slot] - 1];
+        if (strncmp(existing, text, length) == 0 && existing[length] == '\0')
+        {
+            return strings->slots[slot] - 1;
+        }
+    }
+
+    if (strings->length + length + 1 > strings->capacity)
+    {
+        size_t capacity = strings->capacity > 0 ? strings->capacity : 4096;
+        char* grown;
+        while (capacity < strings->length + length + 1)
+        {
+            capacity *= 2;
+        }
+        if ((grown = (char*)realloc(strings->text, capacity)) == NULL)
+        {
+            return SCENE_NONE;
+        }
+        strings->text = grown;
+        strings->capacity = capacity;
+    }
+    if (!Reserve((void**)&strings->offsets, &strings->offset_capacity, strings->count + 1, sizeof(uint32_t)))
+    {
+        return SCENE_NONE;
+    }
+    memcpy(strings->text + strings->length, text, length);
+    strings->text[strings->length + length] = '\0';
+    strings->offsets[strings->count] = (uint32_t)strings->length;
+    strings->length += length + 1;
+    strings->slots[slot] = ++strings->count;
+    return strings->count - 1;
+}
+
+static void FreeStrings(SceneStrings* strings)
+{
+    free(strings->text);
+    free(strings->offsets);
+    free(strings->slots);
+    memset(strings, 0, sizeof(*strings));
+}
+
+static const char* StringAt(const SceneFile* file, uint32_t id)
+{
+    return id != SCENE_NONE ? file->strings.text + file->strings.offsets[id] : NULL;
+}
+
+static void FreeBuilder(SceneBuilder* builder)
+{
+    free(builder->objects);
+    free(builder->members);
+    free(builder->links);
+    FreeStrings(&builder->strings);
+}
+
+static void FreeScene(SceneFile* file)
+{
+    if (file == NULL)
+    {
+        return;
+    }
+    free(file->objects);
+    free(file->by_id);
+    free(file->members);
+    free(file->links);
+    free(file->children);
+    free(file->roots);
+    FreeStrings(&file->strings);
+    free(file);
+}
+
+/*
+ * Values
+ */
+
+static int HexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static int ParseGuid(const char* text, const char* end, unsigned char* guid)
+{
+    int i;
+
+    if (end - text < GUID_BYTES * 2)
+    {
+        return 0;
+    }
+    for (i = 0; i < GUID_BYTES; i++)
+    {
+        int high = HexValue(text[i * 2]);
+        int low = HexValue(text[i * 2 + 1]);
+        if (high < 0 || low < 0)
+        {
+            return 0;
+        }
+        guid[i] = (unsigned char)(high << 4 | low);
+    }
+    return 1;
+}
+
+static void FormatGuid(const unsigned char* guid, char* text)
+{
+    static const char DIGITS[] = "0123456789abcdef";
+    int i;
+
+    for (i = 0; i < GUID_BYTES; i++)
+    {
+        text[i * 2] = DIGITS[guid[i] >> 4];
+        text[i * 2 + 1] = DIGITS[guid[i] & 15];
+    }
+    text[GUID_BYTES * 2] = '\0';
+}
+
+static int64_t ParseInteger(const char* p, const char* end)
+{
+    int negative = 0;
+    uint64_t value = 0;
+
+    if (p < end && *p == '-')
+    {
+        negative = 1;
+        p++;
+    }
+    for (; p < end && *p >= '0' && *p <= '9'; p++)
+    {
+        value = value * 10 + (uint64_t)(*p - '0');
+    }
+    return negative ? -(int64_t)value : (int64_t)value;
+}
+
+/*
+ * Parse "{fileID: N, guid: G, type: T}" at the start of a value. Returns 0
+ * if the value is not such a reference.
+ */
+static int ParseReference(const char* p, const char* end, int64_t* file_id, unsigned char* guid, int* has_guid)
+{
+    static const char FILE_ID[] = "{fileID: ";
+    static const char GUID[] = ", guid: ";
+
+    *has_guid = 0;
+    if ((size_t)(end - p) < sizeof(FILE_ID) - 1 || memcmp(p, FILE_ID, sizeof(FILE_ID) - 1) != 0)
+    {
+        return 0;
+    }
+    p += sizeof(FILE_ID) - 1;
+    *file_id = ParseInteger(p, end);
+    while (p < end && *p != ',' && *p != '}')
+    {
+        p++;
+    }
+    if ((size_t)(end - p) >= sizeof(GUID) - 1 && memcmp(p, GUID, sizeof(GUID) - 1) == 0)
+    {
+        *has_guid = ParseGuid(p + sizeof(GUID) - 1, end, guid);
+    }
+    return 1;
+}
+
+static size_t AppendUtf8(char* out, unsigned code)
+{
+    if (code < 0x80)
+    {
+        out[0] = (char)code;
+        return 1;
+    }
+    if (code < 0x800)
+    {
+        out[0] = (char)(0xc0 | (code >> 6));
+        out[1] = (char)(0x80 | (code & 0x3f));
+        return 2;
+    }
+    if (code < 0x10000)
+    {
+        out[0] = (char)(0xe0 | (code >> 12));
+        out[1] = (char)(0x80 | ((code >> 6) & 0x3f));
+        out[2] = (char)(0x80 | (code & 0x3f));
+        return 3;
+    }
+    out[0] = (char)(0xf0 | (code >> 18));
+    out[1] = (char)(0x80 | ((code >> 12) & 0x3f));
+    out[2] = (char)(0x80 | ((code >> 6) & 0x3f));
+    out[3] = (char)(0x80 | (code & 0x3f));
+    return 4;
+}
+
+static unsigned ParseHex4(const char* p, const char* end)
+{
+    unsigned code = 0;
+    int i;
+
+    for (i = 0; i < 4; i++)
+    {
+        int digit = p + i < end ? HexValue(p[i]) : -1;
+        if (digit < 0)
+        {
+            return 0xfffd;
+        }
+        code = code << 4 | (unsigned)digit;
+    }
+    return code;
+}
+
+/*
+ * Decode a scalar value on one line: plain, 'single' or "double" quoted
+ * (Unity quotes names with non-ASCII characters as \u escapes). Values
+ * wrapped over several lines keep their first line.
+ */
+static size_t DecodeScalar(const char* p, const char* end, char* out, size_t capacity)
+{
+    size_t length = 0;
+
+    while (end > p && (end[-1] == ' ' || end[-1] == '\t'))
+    {
+        end--;
+    }
+    if (p < end && *p == '\'')
+    {
+        for (p++; p < end && length + 1 < capacity; p++)
+        {
+            if (*p == '\'')
+            {
+                if (p + 1 < end && p[1] == '\'')
+                {
+                    p++;
+                }
+                else
+                {
+                    break;
+                }
+            }
+            out[length++] = *p;
+        }
+    }
+    else if (p < end && *p == '"')
+    {
+        for (p++; p < end && *p != '"' && length + 4 < capacity; p++)
+        {
+            if (*p != '\\' || p + 1 >= end)
+            {
+                out[length++] = *p;
+                continue;
+            }
+            p++;
+            switch (*p)
+            {
+            case 'n': out[length++] = '\n'; break;
+            case 't': out[length++] = '\t'; break;
+            case 'r': out[length++] = '\r'; break;
+            case '0': out[length++] = '\0'; break;
+            case 'u':
+            {
+                unsigned code = ParseHex4(p + 1, end);
+                p += 4;
+                if (code >= 0xd800 && code < 0xdc00 && p + 6 < end && p[1] == '\\' && p[2] == 'u')
+                {
+                    unsigned low = ParseHex4(p + 3, end);
+                    if (low >= 0xdc00 && low < 0xe000)
+                    {
+                        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                        p += 6;
+                    }
+                }
+                length += AppendUtf8(out + length, code);
+                break;
+            }
+            default: out[length++] = *p; break;
+            }
+        }
+    }
+    else
+    {
+        length = (size_t)(end - p) < capacity ? (size_t)(end - p) : capacity - 1;
+        memcpy(out, p, length);
+    }
+    out[length] = '\0';
+    return length;
+}
+
+/*
+ * Parsing
+ */
+
+typedef struct SceneKey
+{
+    int indent;
+    const char* text;
+    size_t length;
+} SceneKey;
+
+typedef struct ChunkState
+{
+    SceneBuilder* builder;
+    SceneObject* object;              /* Document being parsed, or NULL */
+    SceneKey keys[MAX_KEYS];
+    int key_count;
+    int name_override;                /* Next "value:" of m_Modifications sets the name */
+} ChunkState;
+
+static int KeyIs(const SceneKey* key, const char* name)
+{
+    size_t length = strlen(name);
+    return key->length == length && memcmp(key->text, name, length) == 0;
+}
+
+static int StartObject(ChunkState* state, const char* line, const char* end)
+{
+    SceneBuilder* builder = state->builder;
+    SceneObject* object;
+    const char* p = line + 7;         /* "--- !u!" */
+
+    if (!Reserve((void**)&builder->objects, &builder->object_capacity, builder->object_count + 1, sizeof(SceneObject)))
+    {
+        builder->failed = 1;
+        return 0;
+    }
+    object = &builder->objects[builder->object_count++];
+    memset(object, 0, sizeof(*object));
+    object->class_id = (int32_t)ParseInteger(p, end);
+    while (p < end && *p != '&')
+    {
+        p++;
+    }
+    object->file_id = p < end ? ParseInteger(p + 1, end) : 0;
+    object->stripped = end - line >= 9 && memcmp(end - 9, " stripped", 9) == 0;
+    object->root_order = -1;
+    object->active = -1;
+    object->type = SCENE_NONE;
+    object->name = SCENE_NONE;
+    object->tag = SCENE_NONE;
+    object->member_start = builder->member_count;
+    object->link_start = builder->link_count;
+    object->parent = SCENE_NONE;
+    state->object = object;
+    state->key_count = 0;
+    state->name_override = 0;
+    return 1;
+}
+
+static void AddMember(ChunkState* state, int64_t file_id)
+{
+    SceneBuilder* builder = state->builder;
+
+    if (!Reserve((void**)&builder->members, &builder->member_capacity, builder->member_count + 1, sizeof(int64_t)))
+    {
+        builder->failed = 1;
+        return;
+    }
+    builder->members[builder->member_count++] = file_id;
+    state->object->member_count++;
+}
+
+static void AddLink(ChunkState* state, int64_t file_id, const unsigned char* guid, int has_guid)
+{
+    SceneBuilder* builder = state->builder;
+    char field[MAX_FIELD];
+    size_t length = 0;
+    SceneLink* link;
+    int i;
+
+    for (i = 0; i < state->key_count; i++)
+    {
+        const SceneKey* key = &state->keys[i];
+        if (length + key->length + 2 > sizeof(field))
+        {
+            break;
+        }
+        if (length > 0)
+        {
+            field[length++] = '.';
+        }
+        memcpy(field + length, key->text, key->length);
+        length += key->length;
+    }
+    if (!Reserve((void**)&builder->links, &builder->link_capacity, builder->link_count + 1, sizeof(SceneLink)))
+    {
+        builder->failed = 1;
+        return;
+    }
+    link = &builder->links[builder->link_count];
+    memset(link, 0, sizeof(*link));
+    link->file_id = file_id;
+    link->field = Intern(&builder->strings, field, length);
+    link->has_guid = (uint8_t)has_guid;
+    if (has_guid)
+    {
+        memcpy(link->guid, guid, GUID_BYTES);
+    }
+    builder->link_count++;
+    state->object->link_count++;
+}
+
+static void SetString(ChunkState* state, uint32_t* id, const char* value, const char* end)
+{
+    char text[MAX_NAME];
+    size_t length = DecodeScalar(value, end, text, sizeof(text));
+    *id = Intern(&state->builder->strings, text, length);
+}
+
+/*
+ * Fields of the object itself, two spaces in.
+ */
+static int ParseTopField(ChunkState* state, const SceneKey* key, const char* value, const char* end)
+{
+    SceneObject* object = state->object;
+    int64_t file_id;
+    unsigned char guid[GUID_BYTES];
+    int has_guid;
+
+    if (KeyIs(key, "m_Name"))
+    {
+        if (object->name == SCENE_NONE)
+        {
+            SetString(state, &object->name, value, end);
+        }
+    }
+    else if (KeyIs(key, "m_TagString"))
+    {
+        SetString(state, &object->tag, value, end);
+    }
+    else if (KeyIs(key, "m_Layer"))
+    {
+        object->layer = (int32_t)ParseInteger(value, end);
+    }
+    else if (KeyIs(key, "m_IsActive") || KeyIs(key, "m_Enabled"))
+    {
+        object->active = (int8_t)(ParseInteger(value, end) != 0);
+    }
+    else if (KeyIs(key, "m_RootOrder"))
+    {
+        object->root_order = (int32_t)ParseInteger(value, end);
+    }
+    else if (KeyIs(key, "m_GameObject") || KeyIs(key, "m_Father") || KeyIs(key, "m_PrefabInstance"))
+    {
+        if (ParseReference(value, end, &file_id, guid, &has_guid))
+        {
+            *(KeyIs(key, "m_GameObject") ? &object->game_object
+                : KeyIs(key, "m_Father") ? &object->father : &object->prefab_instance) = file_id;
+        }
+    }
+    else if (KeyIs(key, "m_Script") || KeyIs(key, "m_SourcePrefab") || KeyIs(key, "m_ParentPrefab"))
+    {
+        if (ParseReference(value, end, &file_id, guid, &has_guid) && has_guid)
+        {
+            memcpy(object->asset, guid, GUID_BYTES);
+            object->has_asset = 1;
+        }
+    }
+    else if (KeyIs(key, "m_CorrespondingSourceObject") || KeyIs(key, "m_PrefabAsset") ||
+        KeyIs(key, "m_PrefabParentObject") || KeyIs(key, "m_PrefabInternal"))
+    {
+        /* Prefab bookkeeping, not references of the object */
+    }
+    else
+    {
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Top-level fields whose nested entries are structure rather than
+ * references.
+ */
+static int IsStructural(const SceneKey* key)
+{
+    return KeyIs(key, "m_Component") || KeyIs(key, "m_Children") || KeyIs(key, "m_Roots") ||
+        KeyIs(key, "m_Modification");
+}
+
+static void ParseLine(ChunkState* state, const char* line, const char* end)
+{
+    const char* p = line;
+    const char* colon;
+    const char* value;
+    int indent;
+    int item = 0;
+    int keyed = 0;
+    int64_t file_id;
+    unsigned char guid[GUID_BYTES];
+    int has_guid;
+
+    while (p < end && *p == ' ')
+    {
+        p++;
+    }
+    indent = (int)(p - line);
+    if (p == end)
+    {
+        return;
+    }
+    if (indent == 0)
+    {
+        /* "GameObject:" names the class of the document */
+        if (state->object->type == SCENE_NONE && end[-1] == ':')
+        {
+            state->object->type = Intern(&state->builder->strings, p, (size_t)(end - p - 1));
+        }
+        state->key_count = 0;
+        return;
+    }
+    if (*p == '-' && (p + 1 == end || p[1] == ' '))
+    {
+        /* A sequence item: its list's key sits at the dash's indent */
+        while (state->key_count > 0 && state->keys[state->key_count - 1].indent > indent)
+        {
+            state->key_count--;
+        }
+        item = 1;
+        p = p + 1 < end ? p + 2 : end;
+        indent += 2;
+    }
+    else
+    {
+        while (state->key_count > 0 && state->keys[state->key_count - 1].indent >= indent)
+        {
+            state->key_count--;
+        }
+    }
+
+    value = p;
+    if (p < end && *p != '{' && *p != '\'' && *p != '"' && *p != '[')
+    {
+        for (colon = p; colon < end && *colon != ':' && *colon != ' '; colon++)
+        {
+        }
+        if (colon < end && *colon == ':' && (colon + 1 == end || colon[1] == ' '))
+        {
+            if (state->key_count < MAX_KEYS)
+            {
+                SceneKey* key = &state->keys[state->key_count++];
+                key->indent = indent;
+                key->text = p;
+                key->length = (size_t)(colon - p);
+            }
+            keyed = 1;
+            value = colon + 1 < end ? colon + 2 : end;
+        }
+    }
+    if (state->key_count == 0)
+    {
+        return;
+    }
+
+    if (keyed && !item && state->key_count == 1)
+    {
+        if (ParseTopField(state, &state->keys[0], value, end))
+        {
+            return;
+        }
+    }
+    if (IsStructural(&state->keys[0]))
+    {
+        const SceneKey* key = &state->keys[state->key_count - 1];
+        if (KeyIs(&state->keys[0], "m_Modification"))
+        {
+            if (KeyIs(key, "m_TransformParent") && ParseReference(value, end, &file_id, guid, &has_guid))
+            {
+                state->object->transform_parent = file_id;
+            }
+            else if (KeyIs(key, "target"))
+            {
+                state->name_override = 0;
+            }
+            else if (KeyIs(key, "propertyPath"))
+            {
+                state->name_override = end - value == 6 && memcmp(value, "m_Name", 6) == 0;
+            }
+            else if (KeyIs(key, "value") && state->name_override)
+            {
+                if (state->object->name == SCENE_NONE)
+                {
+                    SetString(state, &state->object->name, value, end);
+                }
+                state->name_override = 0;
+            }
+        }
+        else if (item && state->key_count <= 2 && ParseReference(value, end, &file_id, guid, &has_guid))
+        {
+            AddMember(state, file_id);
+        }
+        return;
+    }
+    if (value < end && *value == '{' && ParseReference(value, end, &file_id, guid, &has_guid) &&
+        (file_id != 0 || has_guid))
+    {
+        AddLink(state, file_id, guid, has_guid);
+    }
+}
+
+/*
+ * Parse the documents starting in [begin, end); both are line starts.
+ */
+static void ParseChunk(SceneBuilder* builder, const char* data, size_t begin, size_t end)
+{
+    ChunkState state;
+    size_t position = begin;
+
+    memset(&state, 0, sizeof(state));
+    state.builder = builder;
+    while (position < end && !builder->failed)
+    {
+        const char* line = data + position;
+        const char* stop = memchr(line, '\n', end - position);
+        const char* line_end = stop != NULL ? stop : data + end;
+
+        position = (size_t)(line_end - data) + 1;
+        if (line_end > line && line_end[-1] == '\r')
+        {
+            line_end--;
+        }
+        if (line_end - line >= 7 && memcmp(line, "--- !u!", 7) == 0)
+        {
+            StartObject(&state, line, line_end);
+        }
+        else if (state.object != NULL)
+        {
+            ParseLine(&state, line, line_end);
+        }
+    }
+}
+
+typedef struct ParseJob
+{
+    const char* data;
+    const size_t* bounds;
+    SceneBuilder* builders;
+} ParseJob;
+
+static void ParseRange(void* context, int begin, int end)
+{
+    ParseJob* job = (ParseJob*)context;
+    int i;
+
+    for (i = begin; i < end; i++)
+    {
+        ParseChunk(&job->builders[i], job->data, job->bounds[i], job->bounds[i + 1]);
+    }
+}
+
+/*
+ * Hierarchy
+ */
+
+static const SceneFile* s_sort_file;
+
+static int CompareIds(const void* a, const void* b)
+{
+    int64_t left = s_sort_file->objects[*(const uint32_t*)a].file_id;
+    int64_t right = s_sort_file->objects[*(const uint32_t*)b].file_id;
+    return left < right ? -1 : left > right ? 1 : 0;
+}
+
+static uint32_t FindObject(const SceneFile* file, int64_t file_id)
+{
+    uint32_t low = 0;
+    uint32_t high = file->object_count;
+
+    while (low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+        int64_t id = file->objects[file->by_id[middle]].file_id;
+        if (id == file_id)
+        {
+            return file->by_id[middle];
+        }
+        if (id < file_id)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return SCENE_NONE;
+}
+
+static int IsTransform(const SceneObject* object)
+{
+    return object->class_id == CLASS_TRANSFORM || object->class_id == CLASS_RECT_TRANSFORM;
+}
+
+static int IsNode(const SceneObject* object)
+{
+    return (object->class_id == CLASS_GAME_OBJECT && !object->stripped) || object->class_id == CLASS_PREFAB_INSTANCE;
+}
+
+/*
+ * The node a Transform stands for: its GameObject, or the prefab instance
+ * of a stripped one.
+ */
+static uint32_t TransformNode(const SceneFile* file, int64_t file_id)
+{
+    uint32_t index = FindObject(file, file_id);
+    const SceneObject* transform;
+
+    if (index == SCENE_NONE)
+    {
+        return SCENE_NONE;
+    }
+    transform = &file->objects[index];
+    if (transform->stripped)
+    {
+        index = transform->prefab_instance != 0 ? FindObject(file, transform->prefab_instance) : SCENE_NONE;
+    }
+    else
+    {
+        index = FindObject(file, transform->game_object);
+    }
+    return index != SCENE_NONE && IsNode(&file->objects[index]) ? index : SCENE_NONE;
+}
+
+typedef struct NodeOrder
+{
+    uint32_t parent;
+    uint32_t node;
+    uint64_t rank;                    /* Position among its siblings */
+} NodeOrder;
+
+static int CompareNodes(const void* a, const void* b)
+{
+    const NodeOrder* left = (const NodeOrder*)a;
+    const NodeOrder* right = (const NodeOrder*)b;
+    if (left->parent != right->parent)
+    {
+        return left->parent < right->parent ? -1 : 1;
+    }
+    return left->rank < right->rank ? -1 : left->rank > right->rank ? 1 : 0;
+}
+
+static void SetParent(SceneFile* file, uint64_t* ranks, uint32_t node, uint32_t parent, uint64_t rank)
+{
+    if (node != SCENE_NONE && node != parent && file->objects[node].parent == SCENE_NONE)
+    {
+        file->objects[node].parent = parent;
+        if (rank != UINT64_MAX)
+        {
+            ranks[node] = rank;
+        }
+    }
+}
+
+/*
+ * Link nodes to their parents, ordered like Unity's hierarchy: by the
+ * parent Transform's m_Children, and at the root by SceneRoots or
+ * m_RootOrder; nodes without an order follow in file order.
+ */
+static int BuildHierarchy(SceneFile* file)
+{
+    uint64_t* ranks = (uint64_t*)malloc((file->object_count + 1) * sizeof(uint64_t));
+    NodeOrder* order = (NodeOrder*)malloc((file->object_count + 1) * sizeof(NodeOrder));
+    uint32_t node_count = 0;
+    uint32_t i;
+    uint32_t k;
+
+    file->children = (uint32_t*)malloc((file->object_count + 1) * sizeof(uint32_t));
+    file->roots = (uint32_t*)malloc((file->object_count + 1) * sizeof(uint32_t));
+    if (ranks == NULL || order == NULL || file->children == NULL || file->roots == NULL)
+    {
+        free(ranks);
+        free(order);
+        return 0;
+    }
+    for (i = 0; i < file->object_count; i++)
+    {
+        ranks[i] = ((uint64_t)1 << 40) + i;
+    }
+
+    for (i = 0; i < file->object_count; i++)
+    {
+        const SceneObject* object = &file->objects[i];
+        uint32_t owner;
+
+        if (!IsTransform(object) || object->stripped || (owner = FindObject(file, object->game_object)) == SCENE_NONE)
+        {
+            continue;
+        }
+        for (k = 0; k < object->member_count; k++)
+        {
+            SetParent(file, ranks, TransformNode(file, file->members[object->member_start + k]), owner, k);
+        }
+        if (object->father == 0 && object->root_order >= 0)
+        {
+            ranks[owner] = (uint64_t)object->root_order;
+        }
+    }
+    for (i = 0; i < file->object_count; i++)
+    {
+        const SceneObject* object = &file->objects[i];
+
+        if (IsTransform(object) && !object->stripped && object->father != 0)
+        {
+            SetParent(file, ranks, FindObject(file, object->game_object), TransformNode(file, object->father), UINT64_MAX);
+        }
+        else if (object->class_id == CLASS_PREFAB_INSTANCE && object->transform_parent != 0)
+        {
+            SetParent(file, ranks, i, TransformNode(file, object->transform_parent), UINT64_MAX);
+        }
+        else if (object->class_id == CLASS_SCENE_ROOTS)
+        {
+            for (k = 0; k < object->member_count; k++)
+            {
+                uint32_t root = TransformNode(file, file->members[object->member_start + k]);
+                if (root != SCENE_NONE)
+                {
+                    ranks[root] = k;
+                }
+            }
+        }
+    }
+
+    for (i = 0; i < file->object_count; i++)
+    {
+        if (IsNode(&file->objects[i]))
+        {
+            order[node_count].parent = file->objects[i].parent;
+            order[node_count].node = i;
+            order[node_count].rank = ranks[i];
+            node_count++;
+        }
+    }
+    qsort(order, node_count, sizeof(NodeOrder), CompareNodes);
+    file->root_count = 0;
+    for (i = 0, k = 0; i < node_count; i++)
+    {
+        if (order[i].parent == SCENE_NONE)
+        {
+            file->roots[file->root_count++] = order[i].node;
+            continue;
+        }
+        if (i == 0 || order[i - 1].parent != order[i].parent)
+        {
+            file->objects[order[i].parent].child_start = k;
+        }
+        file->objects[order[i].parent].child_count++;
+        file->children[k++] = order[i].node;
+    }
+    free(ranks);
+    free(order);
+    return 1;
+}
+
+/*
+ * Join the chunks into one file: objects in file order, strings interned
+ * again so that each is stored once.
+ */
+static int MergeBuilders(SceneFile* file, SceneBuilder* builders, int count)
+{
+    uint32_t objects = 0;
+    uint32_t members = 0;
+    uint32_t links = 0;
+    int c;
+
+    for (c = 0; c < count; c++)
+    {
+        if (builders[c].failed)
+        {
+            return 0;
+        }
+        objects += builders[c].object_count;
+        members += builders[c].member_count;
+        links += builders[c].link_count;
+    }
+    file->objects = (SceneObject*)malloc((objects + 1) * sizeof(SceneObject));
+    file->by_id = (uint32_t*)malloc((objects + 1) * sizeof(uint32_t));
+    file->members = (int64_t*)malloc((members + 1) * sizeof(int64_t));
+    file->links = (SceneLink*)malloc((links + 1) * sizeof(SceneLink));
+    if (file->objects == NULL || file->by_id == NULL || file->members == NULL || file->links == NULL)
+    {
+        return 0;
+    }
+
+    for (c = 0; c < count; c++)
+    {
+        SceneBuilder* builder = &builders[c];
+        uint32_t* remap = (uint32_t*)malloc((builder->strings.count + 1) * sizeof(uint32_t));
+        uint32_t i;
+
+        if (remap == NULL)
+        {
+            return 0;
+        }
+        for (i = 0; i < builder->strings.count; i++)
+        {
+            const char* text = builder->strings.text + builder->strings.offsets[i];
+            remap[i] = Intern(&file->strings, text, strlen(text));
+        }
+        for (i = 0; i < builder->object_count; i++)
+        {
+            SceneObject* object = &file->objects[file->object_count++];
+            *object = builder->objects[i];
+            object->type = object->type != SCENE_NONE ? remap[object->type] : SCENE_NONE;
+            object->name = object->name != SCENE_NONE ? remap[object->name] : SCENE_NONE;
+            object->tag = object->tag != SCENE_NONE ? remap[object->tag] : SCENE_NONE;
+            object->member_start += file->member_count;
+            object->link_start += file->link_count;
+        }
+        memcpy(file->members + file->member_count, builder->members, builder->member_count * sizeof(int64_t));
+        file->member_count += builder->member_count;
+        for (i = 0; i < builder->link_count; i++)
+        {
+            SceneLink* link = &file->links[file->link_count++];
+            *link = builder->links[i];
+            link->field = link->field != SCENE_NONE ? remap[link->field] : SCENE_NONE;
+        }
+        free(remap);
+    }
+    return 1;
+}
+
+/*
+ * Parse a mapped file, splitting it at document starts into chunks for the
+ * worker pool.
+ */
+static SceneFile* ParseScene(const char* data, size_t length)
+{
+    SceneFile* file = (SceneFile*)calloc(1, sizeof(SceneFile));
+    int chunk_count = (int)(length / SCENES_CHUNK_SIZE) + 1;
+    size_t* bounds;
+    SceneBuilder* builders;
+    ParseJob job;
+    int ok;
+    int i;
+
+    if (chunk_count > 256)
+    {
+        chunk_count = 256;
+    }
+    bounds = (size_t*)malloc((chunk_count + 1) * sizeof(size_t));
+    builders = (SceneBuilder*)calloc(chunk_count, sizeof(SceneBuilder));
+    if (file == NULL || bounds == NULL || builders == NULL)
+    {
+        free(file);
+        free(bounds);
+        free(builders);
+        return NULL;
+    }
+    bounds[0] = 0;
+    for (i = 1; i < chunk_count; i++)
+    {
+        size_t at = length / chunk_count * i;
+        if (at < bounds[i - 1])
+        {
+            at = bounds[i - 1];
+        }
+        while (at < length && !(data[at - 1] == '\n' && length - at >= 4 && memcmp(data + at, "--- ", 4) == 0))
+        {
+            const char* next = memchr(data + at, '\n', length - at);
+            at = next != NULL ? (size_t)(next - data) + 1 : length;
+        }
+        bounds[i] = at;
+    }
+    bounds[chunk_count] = length;
+
+    job.data = data;
+    job.bounds = bounds;
+    job.builders = builders;
+    WorkerParallelFor(chunk_count, 1, ParseRange, &job);
+
+    ok = MergeBuilders(file, builders, chunk_count);
+    for (i = 0; i < chunk_count; i++)
+    {
+        FreeBuilder(&builders[i]);
+    }
+    free(builders);
+    free(bounds);
+
+    if (ok)
+    {
+        uint32_t j;
+        for (j = 0; j < file->object_count; j++)
+        {
+            file->by_id[j] = j;
+        }
+        /* The server thread is the only caller */
+        s_sort_file = file;
+        qsort(file->by_id, file->object_count, sizeof(uint32_t), CompareIds);
+        ok = BuildHierarchy(file);
+    }
+    if (!ok)
+    {
+        FreeScene(file);
+        return NULL;
+    }
+    free(file->strings.slots);
+    file->strings.slots = NULL;
+    file->strings.slot_capacity = 0;
+    file->bytes = sizeof(SceneFile) + file->object_count * (sizeof(SceneObject) + 3 * sizeof(uint32_t)) +
+        file->member_count * sizeof(int64_t) + file->link_count * sizeof(SceneLink) +
+        file->strings.length + file->strings.count * sizeof(uint32_t);
+    return file;
+}
+
+/*
+ * Cache
+ */
+
+static void EvictScenes(size_t incoming)
+{
+    for (;;)
+    {
+        size_t bytes = incoming;
+        int oldest = -1;
+        int i;
+
+        for (i = 0; i < s_scenes_cache_count; i++)
+        {
+            bytes += s_scenes_cache[i]->bytes;
+            if (oldest < 0 || s_scenes_cache[i]->used_at < s_scenes_cache[oldest]->used_at)
+            {
+                oldest = i;
+            }
+        }
+        if (oldest < 0 || (s_scenes_cache_count < SCENES_CACHE_FILES && bytes <= SCENES_CACHE_BYTES))
+        {
+            return;
+        }
+        FreeScene(s_scenes_cache[oldest]);
+        s_scenes_cache[oldest] = s_scenes_cache[--s_scenes_cache_count];
+    }
+}
+
+static int HasSceneExtension(const char* path)
+{
+    const char* dot = strrchr(path, '.');
+    return dot != NULL && strchr(dot, '/') == NULL &&
+        (mg_strcasecmp(mg_str(dot), mg_str(".unity")) == 0 || mg_strcasecmp(mg_str(dot), mg_str(".prefab")) == 0);
+}
+
+/*
+ * The parsed file named by the "path" param, from the cache or parsed now.
+ * Returns NULL or an error message.
+ */
+static const char* AcquireScene(struct mg_str request, SceneFile** scene, int* code)
+{
+    char root[PROJECT_MAX_PATH];
+    unsigned generation = ProjectRoot(root, sizeof(root));
+    char* value;
+    char path[PROJECT_MAX_PATH];
+    uint64_t size;
+    int64_t modified;
+    ProjectMapping mapping;
+    SceneFile* file = NULL;
+    uint64_t started = mg_millis();
+    char* p;
+    int valid;
+    int i;
+
+    *code = -32602;
+    /* mongoose allocates from the pool (mg_free) */
+    if ((value = mg_json_get_str(request, "$.params.path")) == NULL)
+    {
+        return "path is required";
+    }
+    for (p = value; *p != '\0'; p++)
+    {
+        if (*p == '\\')
+        {
+            *p = '/';
+        }
+    }
+    snprintf(path, sizeof(path), "%s", value);
+    valid = strlen(value) < sizeof(path) && HasSceneExtension(value);
+    mg_free(value);
+    if (!valid)
+    {
+        return "path must name a .unity or .prefab file";
+    }
+    if (!ProjectIsValidPath(path))
+    {
+        return "path must be inside Assets/ or Packages/, without \"..\"";
+    }
+    if (generation == 0)
+    {
+        *code = PROJECT_ERROR_NOT_READY;
+        return "Project root not configured";
+    }
+    if (!ProjectStatFile(path, &size, &modified))
+    {
+        return "Scene or prefab not found";
+    }
+
+    for (i = 0; i < s_scenes_cache_count; i++)
+    {
+        SceneFile* cached = s_scenes_cache[i];
+        if (strcmp(cached->path, path) == 0)
+        {
+            if (cached->generation == generation && cached->size == size && cached->modified == modified)
+            {
+                file = cached;
+            }
+            else
+            {
+                PROXY_MUTEX_LOCK(&s_scenes_lock);
+                FreeScene(cached);
+                s_scenes_cache[i] = s_scenes_cache[--s_scenes_cache_count];
+                PROXY_MUTEX_UNLOCK(&s_scenes_lock);
+            }
+            break;
+        }
+    }
+    if (file != NULL)
+    {
+        PROXY_MUTEX_LOCK(&s_scenes_lock);
+        s_scenes_hits++;
+        PROXY_MUTEX_UNLOCK(&s_scenes_lock);
+        file->used_at = mg_millis();
+        *scene = file;
+        return NULL;
+    }
+
+    if (!ProjectMapFile(path, SCENES_MAX_FILE_SIZE, &mapping))
+    {
+        *code = -32603;
+        return "Could not read the file (unreadable, or larger than the reader accepts)";
+    }
+    if (mapping.length < 5 || memcmp(mapping.data, "%YAML", 5) != 0)
+    {
+        ProjectUnmapFile(&mapping);
+        return "Not a text-serialized scene or prefab (Asset Serialization must be Force Text)";
+    }
+    file = ParseScene(mapping.data, mapping.length);
+    ProjectUnmapFile(&mapping);
+    if (file == NULL)
+    {
+        *code = -32603;
+        return "Out of memory parsing the file";
+    }
+    snprintf(file->path, sizeof(file->path), "%s", path);
+    file->generation = generation;
+    file->size = size;
+    file->modified = modified;
+    file->parse_ms = mg_millis() - started;
+    file->used_at = mg_millis();
+
+    PROXY_MUTEX_LOCK(&s_scenes_lock);
+    EvictScenes(file->bytes);
+    s_scenes_cache[s_scenes_cache_count++] = file;
+    s_scenes_parses++;
+    PROXY_MUTEX_UNLOCK(&s_scenes_lock);
+    *scene = file;
+    return NULL;
+}
+
+/*
+ * Get scene reader statistics as a JSON object.
+ */
+EXPORT const char* GetSceneCacheStats(void)
+{
+    size_t bytes = 0;
+    unsigned long objects = 0;
+    int i;
+
+    PROXY_MUTEX_LOCK(&s_scenes_lock);
+    for (i = 0; i < s_scenes_cache_count; i++)
+    {
+        bytes += s_scenes_cache[i]->bytes;
+        objects += s_scenes_cache[i]->object_count;
+    }
+    snprintf(s_scenes_stats_buffer, sizeof(s_scenes_stats_buffer),
+        "{\"files\":%d,\"objects\":%lu,\"bytes\":%lu,\"parses\":%lu,\"hits\":%lu}",
+        s_scenes_cache_count, objects, (unsigned long)bytes, s_scenes_parses, s_scenes_hits);
+    PROXY_MUTEX_UNLOCK(&s_scenes_lock);
+    return s_scenes_stats_buffer;
+}
+
+/*
+ * Queries
+ */
+
+/*
+ * Make room for `more` bytes, doubling: iobufs grow by their alignment,
+ * which costs a copy of the whole result every few KB of a large tree.
+ */
+static void ReserveOutput(struct mg_iobuf* out, size_t more)
+{
+    if (out->len + more > out->size)
+    {
+        size_t size = out->size * 2 > out->len + more ? out->size * 2 : out->len + more;
+        mg_iobuf_resize(out, size);
+    }
+}
+
+static void AppendFileId(struct mg_iobuf* out, int64_t file_id)
+{
+    char number[32];
+    int length = snprintf(number, sizeof(number), "\"%lld\"", (long long)file_id);
+    mg_iobuf_add(out, out->len, number, (size_t)length);
+}
+
+static void AppendText(struct mg_iobuf* out, const char* text)
+{
+    if (text != NULL)
+    {
+        JsonAppendString(out, text, strlen(text));
+    }
+    else
+    {
+        mg_iobuf_add(out, out->len, "null", 4);
+    }
+}
+
+/*
+ * Read a file ID param, given as a string or a number. Returns 0 if absent.
+ */
+static int GetFileIdParam(struct mg_str request, const char* name, int64_t* file_id)
+{
+    int length = 0;
+    int offset = mg_json_get(request, name, &length);
+    const char* p;
+    const char* end;
+
+    if (offset < 0)
+    {
+        return 0;
+    }
+    p = request.buf + offset;
+    end = p + length;
+    if (p < end && *p == '"')
+    {
+        p++;
+        end--;
+    }
+    if (p >= end || !((*p >= '0' && *p <= '9') || *p == '-'))
+    {
+        return 0;
+    }
+    *file_id = ParseInteger(p, end);
+    return 1;
+}
+
+/*
+ * The name a component is listed under: its script's for MonoBehaviours,
+ * otherwise its class.
+ */
+static const char* ComponentName(const SceneFile* file, const SceneObject* object, char* buffer, size_t capacity)
+{
+    char guid[GUID_BYTES * 2 + 1];
+    char path[PROJECT_MAX_PATH];
+
+    if (object->class_id == CLASS_MONO_BEHAVIOUR && object->has_asset)
+    {
+        FormatGuid(object->asset, guid);
+        if (AssetsFindPath(guid, path, sizeof(path)))
+        {
+            const char* name = strrchr(path, '/');
+            const char* dot;
+            name = name != NULL ? name + 1 : path;
+            dot = strrchr(name, '.');
+            snprintf(buffer, capacity, "%.*s", (int)(dot != NULL ? dot - name : (long)strlen(name)), name);
+            return buffer;
+        }
+    }
+    return object->type != SCENE_NONE ? StringAt(file, object->type) : "Unknown";
+}
+
+/*
+ * A node's name: its m_Name, or for a prefab instance without a name
+ * override, its prefab's file name.
+ */
+static const char* NodeName(const SceneFile* file, const SceneObject* node, char* buffer, size_t capacity)
+{
+    char guid[GUID_BYTES * 2 + 1];
+    char path[PROJECT_MAX_PATH];
+
+    if (node->name != SCENE_NONE)
+    {
+        return StringAt(file, node->name);
+    }
+    if (node->has_asset)
+    {
+        FormatGuid(node->asset, guid);
+        if (AssetsFindPath(guid, path, sizeof(path)))
+        {
+            const char* name = strrchr(path, '/');
+            const char* dot;
+            name = name != NULL ? name + 1 : path;
+            dot = strrchr(name, '.');
+            snprintf(buffer, capacity, "%.*s", (int)(dot != NULL ? dot - name : (long)strlen(name)), name);
+            return buffer;
+        }
+    }
+    return NULL;
+}
+
+static void AppendComponents(struct mg_iobuf* out, const SceneFile* file, const SceneObject* node)
+{
+    uint32_t k;
+
+    mg_iobuf_add(out, out->len, ",\"components\":[", 15);
+    for (k = 0; k < node->member_count; k++)
+    {
+        uint32_t index = FindObject(file, file->members[node->member_start + k]);
+        char name[PROJECT_MAX_PATH];
+
+        if (k > 0)
+        {
+            mg_iobuf_add(out, out->len, ",", 1);
+        }
+        AppendText(out, index != SCENE_NONE ? ComponentName(file, &file->objects[index], name, sizeof(name)) : NULL);
+    }
+    mg_iobuf_add(out, out->len, "]", 1);
+}
+
+static void AppendAsset(struct mg_iobuf* out, const unsigned char* asset)
+{
+    char guid[GUID_BYTES * 2 + 1];
+    char path[PROJECT_MAX_PATH];
+
+    FormatGuid(asset, guid);
+    mg_iobuf_add(out, out->len, "{\"guid\":\"", 9);
+    mg_iobuf_add(out, out->len, guid, GUID_BYTES * 2);
+    mg_iobuf_add(out, out->len, "\",\"path\":", 9);
+    AppendText(out, AssetsFindPath(guid, path, sizeof(path)) ? path : NULL);
+    mg_iobuf_add(out, out->len, "}", 1);
+}
+
+/*
+ * The fields every node is listed with, without the closing brace; the
+ * component names are left out for scenes/object, which details them.
+ */
+static void AppendNodeFields(struct mg_iobuf* out, const SceneFile* file, const SceneObject* node, int components)
+{
+    char name[PROJECT_MAX_PATH];
+    const char* tag = StringAt(file, node->tag);
+
+    mg_iobuf_add(out, out->len, "{\"file_id\":", 11);
+    AppendFileId(out, node->file_id);
+    mg_iobuf_add(out, out->len, ",\"name\":", 8);
+    AppendText(out, NodeName(file, node, name, sizeof(name)));
+    if (node->class_id == CLASS_PREFAB_INSTANCE)
+    {
+        if (node->has_asset)
+        {
+            mg_iobuf_add(out, out->len, ",\"prefab\":", 10);
+            AppendAsset(out, node->asset);
+        }
+        return;
+    }
+    mg_iobuf_add(out, out->len, node->active != 0 ? ",\"active\":true" : ",\"active\":false",
+        node->active != 0 ? 14 : 15);
+    if (tag != NULL && strcmp(tag, "Untagged") != 0)
+    {
+        mg_iobuf_add(out, out->len, ",\"tag\":", 7);
+        AppendText(out, tag);
+    }
+    if (node->layer != 0)
+    {
+        char number[32];
+        int length = snprintf(number, sizeof(number), ",\"layer\":%d", (int)node->layer);
+        mg_iobuf_add(out, out->len, number, (size_t)length);
+    }
+    if (components)
+    {
+        AppendComponents(out, file, node);
+    }
+}
+
+typedef struct HierarchyWalk
+{
+    const SceneFile* file;
+    struct mg_iobuf* out;
+    int max_depth;
+    long max_results;
+    long emitted;
+    int truncated;
+} HierarchyWalk;
+
+static void AppendNode(HierarchyWalk* walk, uint32_t index, int depth)
+{
+    const SceneObject* node = &walk->file->objects[index];
+    uint32_t k;
+
+    ReserveOutput(walk->out, 1024);
+    AppendNodeFields(walk->out, walk->file, node, 1);
+    walk->emitted++;
+    if (node->child_count > 0 && (depth >= walk->max_depth || depth >= SCENES_MAX_DEPTH))
+    {
+        char number[48];
+        int length = snprintf(number, sizeof(number), ",\"child_count\":%lu}", (unsigned long)node->child_count);
+        mg_iobuf_add(walk->out, walk->out->len, number, (size_t)length);
+        return;
+    }
+    mg_iobuf_add(walk->out, walk->out->len, ",\"children\":[", 13);
+    for (k = 0; k < node->child_count; k++)
+    {
+        if (walk->emitted >= walk->max_results)
+        {
+            walk->truncated = 1;
+            break;
+        }
+        if (k > 0)
+        {
+            mg_iobuf_add(walk->out, walk->out->len, ",", 1);
+        }
+        AppendNode(walk, walk->file->children[node->child_start + k], depth + 1);
+    }
+    mg_iobuf_add(walk->out, walk->out->len, "]}", 2);
+}
+
+typedef struct NameCount
+{
+    const char* name;
+    uint32_t count;
+} NameCount;
+
+static int CompareNameCounts(const void* a, const void* b)
+{
+    return strcmp(((const NameCount*)a)->name, ((const NameCount*)b)->name);
+}
+
+/*
+ * Append "name":count members for the names in `counts`, merging equal ones.
+ */
+static void AppendHistogram(struct mg_iobuf* out, NameCount* counts, uint32_t count)
+{
+    uint32_t i;
+    int first = 1;
+
+    qsort(counts, count, sizeof(NameCount), CompareNameCounts);
+    mg_iobuf_add(out, out->len, "{", 1);
+    for (i = 0; i < count; i++)
+    {
+        uint32_t total = counts[i].count;
+        char number[32];
+        int length;
+
+        while (i + 1 < count && strcmp(counts[i + 1].name, counts[i].name) == 0)
+        {
+            total += counts[++i].count;
+        }
+        if (!first)
+        {
+            mg_iobuf_add(out, out->len, ",", 1);
+        }
+        first = 0;
+        AppendText(out, counts[i].name);
+        length = snprintf(number, sizeof(number), ":%lu", (unsigned long)total);
+        mg_iobuf_add(out, out->len, number, (size_t)length);
+    }
+    mg_iobuf_add(out, out->len, "}", 1);
+}
+
+static int CompareAssets(const void* a, const void* b)
+{
+    return memcmp(((const SceneObject* const*)a)[0]->asset, ((const SceneObject* const*)b)[0]->asset, GUID_BYTES);
+}
+
+/*
+ * "classes" (every object by class name) and "scripts" (MonoBehaviours by
+ * script, each script looked up once).
+ */
+static int AppendCensus(struct mg_iobuf* out, const SceneFile* file)
+{
+    NameCount* counts = (NameCount*)malloc((file->object_count + 1) * sizeof(NameCount));
+    const SceneObject** scripts = (const SceneObject**)malloc((file->object_count + 1) * sizeof(SceneObject*));
+    uint32_t* classes = (uint32_t*)calloc(file->strings.count + 1, sizeof(uint32_t));
+    char* names = NULL;
+    size_t names_length = 0;
+    uint32_t script_count = 0;
+    uint32_t count = 0;
+    uint32_t i;
+
+    if (counts == NULL || scripts == NULL || classes == NULL)
+    {
+        free(counts);
+        free(scripts);
+        free(classes);
+        return 0;
+    }
+    for (i = 0; i < file->object_count; i++)
+    {
+        const SceneObject* object = &file->objects[i];
+        if (object->type != SCENE_NONE)
+        {
+            classes[object->type]++;
+        }
+        if (object->class_id == CLASS_MONO_BEHAVIOUR && object->has_asset && !object->stripped)
+        {
+            scripts[script_count++] = object;
+        }
+    }
+    for (i = 0; i < file->strings.count; i++)
+    {
+        if (classes[i] > 0)
+        {
+            counts[count].name = StringAt(file, i);
+            counts[count++].count = classes[i];
+        }
+    }
+    free(classes);
+    mg_iobuf_add(out, out->len, ",\"classes\":", 11);
+    AppendHistogram(out, counts, count);
+
+    /* Script names are resolved into one buffer, then pointed at */
+    qsort(scripts, script_count, sizeof(SceneObject*), CompareAssets);
+    count = 0;
+    for (i = 0; i < script_count; )
+    {
+        uint32_t run = 1;
+        char name[PROJECT_MAX_PATH];
+        const char* resolved;
+        size_t length;
+        char* grown;
+
+        while (i + run < script_count && memcmp(scripts[i + run]->asset, scripts[i]->asset, GUID_BYTES) == 0)
+        {
+            run++;
+        }
+        resolved = ComponentName(file, scripts[i], name, sizeof(name));
+        length = strlen(resolved) + 1;
+        if ((grown = (char*)realloc(names, names_length + length)) != NULL)
+        {
+            names = grown;
+            memcpy(names + names_length, resolved, length);
+            counts[count].name = (const char*)(uintptr_t)names_length;
+            counts[count++].count = run;
+            names_length += length;
+        }
+        i += run;
+    }
+    for (i = 0; i < count; i++)
+    {
+        counts[i].name = names + (uintptr_t)counts[i].name;
+    }
+    mg_iobuf_add(out, out->len, ",\"scripts\":", 11);
+    AppendHistogram(out, counts, count);
+    free(names);
+    free(counts);
+    free(scripts);
+    return 1;
+}
+
+static void AppendTimes(struct mg_iobuf* out, const SceneFile* file, uint64_t started)
+{
+    char summary[96];
+    int length = snprintf(summary, sizeof(summary), ",\"parse_ms\":%lu,\"elapsed_ms\":%lu}",
+        (unsigned long)file->parse_ms, (unsigned long)(mg_millis() - started));
+    mg_iobuf_add(out, out->len, summary, (size_t)length);
+}
+
+static long GetMaxResults(struct mg_str request)
+{
+    long max_results = mg_json_get_long(request, "$.params.max_results", SCENES_DEFAULT_RESULTS);
+    return max_results < 1 ? 1 : max_results > SCENES_MAX_RESULTS ? SCENES_MAX_RESULTS : max_results;
+}
+
+int ScenesHierarchyMethod(struct mg_str request, struct mg_iobuf* result, const char** error)
+{
+    uint64_t started = mg_millis();
+    SceneFile* file;
+    HierarchyWalk walk;
+    int64_t root_id;
+    uint32_t root = SCENE_NONE;
+    uint32_t counts[3] = {0, 0, 0};   /* GameObjects, components, prefab instances */
+    uint32_t i;
+    int code;
+    char number[160];
+
+    if ((*error = AcquireScene(request, &file, &code)) != NULL)
+    {
+        return code;
+    }
+    if (GetFileIdParam(request, "$.params.root", &root_id))
+    {
+        root = FindObject(file, root_id);
+        if (root == SCENE_NONE || !IsNode(&file->objects[root]))
+        {
+            *error = "root is not a GameObject or prefab instance of the file";
+            return -32602;
+        }
+    }
+    walk.file = file;
+    walk.out = result;
+    walk.max_depth = (int)mg_json_get_long(request, "$.params.max_depth", SCENES_MAX_DEPTH);
+    walk.max_results = GetMaxResults(request);
+    walk.emitted = 0;
+    walk.truncated = 0;
+
+    for (i = 0; i < file->object_count; i++)
+    {
+        const SceneObject* object = &file->objects[i];
+        if (object->stripped)
+        {
+            continue;
+        }
+        if (object->class_id == CLASS_GAME_OBJECT)
+        {
+            counts[0]++;
+        }
+        else if (object->class_id == CLASS_PREFAB_INSTANCE)
+        {
+            counts[2]++;
+        }
+        else if (object->game_object != 0)
+        {
+            counts[1]++;
+        }
+    }
+
+    mg_iobuf_add(result, result->len, "{\"path\":", 8);
+    AppendText(result, file->path);
+    snprintf(number, sizeof(number), ",\"objects\":%lu,\"components\":%lu,\"prefab_instances\":%lu",
+        (unsigned long)counts[0], (unsigned long)counts[1], (unsigned long)counts[2]);
+    mg_iobuf_add(result, result->len, number, strlen(number));
+    if (!AppendCensus(result, file))
+    {
+        *error = "Out of memory";
+        return -32603;
+    }
+    mg_iobuf_add(result, result->len, ",\"hierarchy\":[", 14);
+    if (root != SCENE_NONE)
+    {
+        AppendNode(&walk, root, 0);
+    }
+    else
+    {
+        for (i = 0; i < file->root_count; i++)
+        {
+            if (walk.emitted >= walk.max_results)
+            {
+                walk.truncated = 1;
+                break;
+            }
+            if (i > 0)
+            {
+                mg_iobuf_add(result, result->len, ",", 1);
+            }
+            AppendNode(&walk, file->roots[i], 0);
+        }
+    }
+    mg_iobuf_add(result, result->len, walk.truncated ? "],\"truncated\":true" : "],\"truncated\":false",
+        walk.truncated ? 18 : 19);
+    AppendTimes(result, file, started);
+    return 0;
+}
+
+static int ContainsFolded(const char* text, const char* needle)
+{
+    size_t length = strlen(needle);
+
+    for (; *text != '\0'; text++)
+    {
+        if (mg_strcasecmp(mg_str_n(text, strnlen(text, length)), mg_str_n(needle, length)) == 0)
+        {
+            return 1;
+        }
+    }
+    return length == 0;
+}
+
+static int HasComponent(const SceneFile* file, const SceneObject* node, const char* wanted)
+{
+    uint32_t k;
+
+    for (k = 0; k < node->member_count; k++)
+    {
+        uint32_t index = FindObject(file, file->members[node->member_start + k]);
+        char name[PROJECT_MAX_PATH];
+        if (index != SCENE_NONE &&
+            mg_strcasecmp(mg_str(ComponentName(file, &file->objects[index], name, sizeof(name))), mg_str(wanted)) == 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Append the names from the root down to a node, separated by '/'. A
+ * malformed m_Father chain that loops back starts the path at the first
+ * ancestor seen twice.
+ */
+static void AppendNodePath(struct mg_iobuf* out, const SceneFile* file, uint32_t index)
+{
+    uint32_t chain[SCENES_MAX_DEPTH];
+    struct mg_iobuf path = {0, 0, 0, 256};
+    int depth = 0;
+
+    while (index != SCENE_NONE && depth < SCENES_MAX_DEPTH)
+    {
+        int k;
+        for (k = 0; k < depth && chain[k] != index; k++)
+        {
+        }
+        if (k < depth)
+        {
+            break;  /* Cycle */
+        }
+        chain[depth++] = index;
+        index = file->objects[index].parent;
+    }
+    while (depth-- > 0)
+    {
+        char buffer[PROJECT_MAX_PATH];
+        const char* name = NodeName(file, &file->objects[chain[depth]], buffer, sizeof(buffer));
+        if (path.len > 0)
+        {
+            mg_iobuf_add(&path, path.len, "/", 1);
+        }
+        if (name != NULL)
+        {
+            mg_iobuf_add(&path, path.len, name, strlen(name));
+        }
+    }
+    JsonAppendString(out, path.buf != NULL ? (const char*)path.buf : "", path.len);
+    mg_iobuf_free(&path);
+}
+
+int ScenesFindMethod(struct mg_str request, struct mg_iobuf* result, const char** error)
+{
+    uint64_t started = mg_millis();
+    SceneFile* file;
+    /* mongoose allocates from the pool (mg_free) */
+    char* name = mg_json_get_str(request, "$.params.name");
+    char* component = mg_json_get_str(request, "$.params.component");
+    char* tag = mg_json_get_str(request, "$.params.tag");
+    long max_results = GetMaxResults(request);
+    long found = 0;
+    int truncated = 0;
+    uint32_t i;
+    int code;
+
+    if ((*error = AcquireScene(request, &file, &code)) != NULL)
+    {
+        mg_free(name);
+        mg_free(component);
+        mg_free(tag);
+        return code;
+    }
+
+    mg_iobuf_add(result, result->len, "{\"path\":", 8);
+    AppendText(result, file->path);
+    mg_iobuf_add(result, result->len, ",\"objects\":[", 12);
+    for (i = 0; i < file->object_count; i++)
+    {
+        const SceneObject* node = &file->objects[i];
+        char buffer[PROJECT_MAX_PATH];
+        const char* node_name;
+        const char* node_tag;
+
+        if (!IsNode(node))
+        {
+            continue;
+        }
+        node_name = NodeName(file, node, buffer, sizeof(buffer));
+        node_tag = StringAt(file, node->tag);
+        if ((name != NULL && (node_name == NULL || !ContainsFolded(node_name, name))) ||
+            (tag != NULL && (node_tag == NULL || mg_strcasecmp(mg_str(node_tag), mg_str(tag)) != 0)) ||
+            (component != NULL && !HasComponent(file, node, component)))
+        {
+            continue;
+        }
+        if (found == max_results)
+        {
+            truncated = 1;
+            break;
+        }
+        ReserveOutput(result, 1024);
+        mg_iobuf_add(result, result->len, found > 0 ? ",{\"file_id\":" : "{\"file_id\":", found > 0 ? 12 : 11);
+        AppendFileId(result, node->file_id);
+        mg_iobuf_add(result, result->len, ",\"name\":", 8);
+        AppendText(result, node_name);
+        mg_iobuf_add(result, result->len, ",\"path\":", 8);
+        AppendNodePath(result, file, i);
+        if (node->class_id == CLASS_PREFAB_INSTANCE)
+        {
+            if (node->has_asset)
+            {
+                mg_iobuf_add(result, result->len, ",\"prefab\":", 10);
+                AppendAsset(result, node->asset);
+            }
+        }
+        else
+        {
+            AppendComponents(result, file, node);
+        }
+        mg_iobuf_add(result, result->len, "}", 1);
+        found++;
+    }
+    mg_iobuf_add(result, result->len, truncated ? "],\"truncated\":true" : "],\"truncated\":false",
+        truncated ? 18 : 19);
+    AppendTimes(result, file, started);
+    mg_free(name);
+    mg_free(component);
+    mg_free(tag);
+    return 0;
+}
+
+static void AppendReferences(struct mg_iobuf* out, const SceneFile* file, const SceneObject* object)
+{
+    uint32_t k;
+
+    mg_iobuf_add(out, out->len, ",\"references\":[", 15);
+    for (k = 0; k < object->link_count; k++)
+    {
+        const SceneLink* link = &file->links[object->link_start + k];
+
+        ReserveOutput(out, 512);
+        mg_iobuf_add(out, out->len, k > 0 ? ",{\"field\":" : "{\"field\":", k > 0 ? 10 : 9);
+        AppendText(out, StringAt(file, link->field));
+        mg_iobuf_add(out, out->len, ",\"file_id\":", 11);
+        AppendFileId(out, link->file_id);
+        if (link->has_guid)
+        {
+            char guid[GUID_BYTES * 2 + 1];
+            char path[PROJECT_MAX_PATH];
+
+            FormatGuid(link->guid, guid);
+            mg_iobuf_add(out, out->len, ",\"guid\":\"", 9);
+            mg_iobuf_add(out, out->len, guid, GUID_BYTES * 2);
+            mg_iobuf_add(out, out->len, "\",\"path\":", 9);
+            AppendText(out, AssetsFindPath(guid, path, sizeof(path)) ? path : NULL);
+        }
+        else
+        {
+            uint32_t target = FindObject(file, link->file_id);
+            mg_iobuf_add(out, out->len, ",\"class\":", 9);
+            AppendText(out, target != SCENE_NONE ? StringAt(file, file->objects[target].type) : NULL);
+        }
+        mg_iobuf_add(out, out->len, "}", 1);
+    }
+    mg_iobuf_add(out, out->len, "]", 1);
+}
+
+/*
+ * Class, script and references of any object, without the closing brace.
+ */
+static void AppendObject(struct mg_iobuf* out, const SceneFile* file, const SceneObject* object)
+{
+    char number[64];
+    int length;
+
+    mg_iobuf_add(out, out->len, "{\"file_id\":", 11);
+    AppendFileId(out, object->file_id);
+    length = snprintf(number, sizeof(number), ",\"class_id\":%ld,\"class\":", (long)object->class_id);
+    mg_iobuf_add(out, out->len, number, (size_t)length);
+    AppendText(out, StringAt(file, object->type));
+    if (object->stripped)
+    {
+        mg_iobuf_add(out, out->len, ",\"stripped\":true", 16);
+    }
+    if (object->prefab_instance != 0)
+    {
+        mg_iobuf_add(out, out->len, ",\"prefab_instance\":", 19);
+        AppendFileId(out, object->prefab_instance);
+    }
+    if (object->class_id == CLASS_MONO_BEHAVIOUR && object->has_asset)
+    {
+        mg_iobuf_add(out, out->len, ",\"script\":", 10);
+        AppendAsset(out, object->asset);
+    }
+    if (object->game_object != 0)
+    {
+        mg_iobuf_add(out, out->len, ",\"game_object\":", 15);
+        AppendFileId(out, object->game_object);
+        if (object->active >= 0)
+        {
+            mg_iobuf_add(out, out->len, object->active ? ",\"enabled\":true" : ",\"enabled\":false",
+                object->active ? 15 : 16);
+        }
+    }
+    AppendReferences(out, file, object);
+}
+
+int ScenesObjectMethod(struct mg_str request, struct mg_iobuf* result, const char** error)
+{
+    uint64_t started = mg_millis();
+    SceneFile* file;
+    const SceneObject* object;
+    int64_t file_id;
+    uint32_t index;
+    uint32_t i;
+    uint32_t k;
+    int first = 1;
+    int code;
+
+    if ((*error = AcquireScene(request, &file, &code)) != NULL)
+    {
+        return code;
+    }
+    if (!GetFileIdParam(request, "$.params.file_id", &file_id))
+    {
+        *error = "file_id is required";
+        return -32602;
+    }
+    if ((index = FindObject(file, file_id)) == SCENE_NONE)
+    {
+        *error = "No object with this file_id in the file";
+        return -32602;
+    }
+    object = &file->objects[index];
+
+    mg_iobuf_add(result, result->len, "{\"path\":", 8);
+    AppendText(result, file->path);
+    mg_iobuf_add(result, result->len, ",\"object\":", 10);
+    if (IsNode(object))
+    {
+        char buffer[PROJECT_MAX_PATH];
+
+        char number[64];
+        int length;
+
+        /* The node fields, then its place in the tree and full components */
+        AppendNodeFields(result, file, object, 0);
+        length = snprintf(number, sizeof(number), ",\"class_id\":%ld,\"class\":", (long)object->class_id);
+        mg_iobuf_add(result, result->len, number, (size_t)length);
+        AppendText(result, StringAt(file, object->type));
+        mg_iobuf_add(result, result->len, ",\"node_path\":", 13);
+        AppendNodePath(result, file, index);
+        mg_iobuf_add(result, result->len, ",\"parent\":", 10);
+        if (object->parent != SCENE_NONE)
+        {
+            AppendFileId(result, file->objects[object->parent].file_id);
+        }
+        else
+        {
+            mg_iobuf_add(result, result->len, "null", 4);
+        }
+        mg_iobuf_add(result, result->len, ",\"children\":[", 13);
+        for (k = 0; k < object->child_count; k++)
+        {
+            const SceneObject* child = &file->objects[file->children[object->child_start + k]];
+            mg_iobuf_add(result, result->len, k > 0 ? ",{\"file_id\":" : "{\"file_id\":", k > 0 ? 12 : 11);
+            AppendFileId(result, child->file_id);
+            mg_iobuf_add(result, result->len, ",\"name\":", 8);
+            AppendText(result, NodeName(file, child, buffer, sizeof(buffer)));
+            mg_iobuf_add(result, result->len, "}", 1);
+        }
+        mg_iobuf_add(result, result->len, "],\"components\":[", 16);
+        for (k = 0; k < object->member_count; k++)
+        {
+            uint32_t component = FindObject(file, file->members[object->member_start + k]);
+            if (component == SCENE_NONE)
+            {
+                continue;
+            }
+            if (!first)
+            {
+                mg_iobuf_add(result, result->len, ",", 1);
+            }
+            first = 0;
+            AppendObject(result, file, &file->objects[component]);
+            mg_iobuf_add(result, result->len, "}", 1);
+        }
+        mg_iobuf_add(result, result->len, "]", 1);
+        AppendReferences(result, file, object);
+    }
+    else
+    {
+        AppendObject(result, file, object);
+    }
+
+    mg_iobuf_add(result, result->len, ",\"referenced_by\":[", 18);
+    first = 1;
+    for (i = 0; i < file->object_count; i++)
+    {
+        const SceneObject* source = &file->objects[i];
+        for (k = 0; k < source->link_count; k++)
+        {
+            const SceneLink* link = &file->links[source->link_start + k];
+            if (link->has_guid || link->file_id != file_id)
+            {
+                continue;
+            }
+            ReserveOutput(result, 512);
+            mg_iobuf_add(result, result->len, first ? "{\"file_id\":" : ",{\"file_id\":", first ? 11 : 12);
+            AppendFileId(result, source->file_id);
+            mg_iobuf_add(result, result->len, ",\"class\":", 9);
+            AppendText(result, StringAt(file, source->type));
+            mg_iobuf_add(result, result->len, ",\"field\":", 9);
+            AppendText(result, StringAt(file, link->field));
+            mg_iobuf_add(result, result->len, "}", 1);
+            first = 0;
+        }
+    }
+    mg_iobuf_add(result, result->len, "]}", 2);
+    AppendTimes(result, file, started);
+    return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * UnixxtyMCP Proxy - Scene and prefab reader
+ *
+ * Answers read-only questions about scenes and prefabs ("what is in this
+ * scene", "which objects carry this component", "what does this object
+ * reference") from their files, on the server thread, without opening them
+ * in the editor or waiting for its main thread. Unity writes them as a
+ * stream of YAML documents, one per object:
+ *
+ *   --- !u!1 &6843127              class ID and file ID
+ *   GameObject:
+ *     m_Component:
+ *     - component: {fileID: 6843128}
+ *     m_Name: Player
+ *
+ * The file is memory-mapped and that subset of YAML is parsed line by line,
+ * the documents split into chunks across the worker pool. What is kept is a
+ * compact table of the objects: class, name, tag, layer and active flag, the
+ * component lists of GameObjects, the Transform hierarchy, prefab instances
+ * (named by their m_Name override, or after their prefab) and every
+ * {fileID, guid} reference with the field holding it; other field values
+ * are dropped. Parsed files are cached, SCENES_CACHE_FILES at most, and
+ * parsed again when their size or modification time change.
+ *
+ * Prefab instances are not expanded: an instance is one node whose children
+ * are the objects added under it in this file, and its overrides other than
+ * the name are not read. Binary-serialized files are rejected.
+ *
+ * File IDs are 64-bit and sent as strings; params take strings or numbers.
+ *
+ * Params of every method:
+ *   path         Project-relative path of a .unity or .prefab file under
+ *                Assets/ or Packages/; paths with ".." are refused
+ *
+ * "scenes/hierarchy" - the GameObject tree
+ *   root         File ID of a GameObject or prefab instance to start from
+ *                (default: the roots)
+ *   max_depth    Levels below the start to expand (default: all); deeper
+ *                nodes report "child_count"
+ *   max_results  Nodes, default SCENES_DEFAULT_RESULTS, at most
+ *                SCENES_MAX_RESULTS
+ * Result: {"path", "objects", "components", "prefab_instances", "classes":
+ * {class:count}, "scripts":{script:count}, "hierarchy":[{"file_id", "name",
+ * "active", "tag", "layer", "components":[type], "children":[...]}],
+ * "truncated", "parse_ms", "elapsed_ms"}. A prefab instance node has
+ * "prefab":{"guid","path"} instead of "components"; tag and layer are left
+ * out when Untagged and 0. MonoBehaviours are named after their script.
+ *
+ * "scenes/find" - GameObjects and prefab instances matching every filter
+ *   name         Case-insensitive substring of the name
+ *   component    Component type or script name, case-insensitive
+ *   tag          Tag, case-insensitive
+ *   max_results  As above
+ * Result: {"path", "objects":[{"file_id", "name", "path", "components"}],
+ * "truncated", "parse_ms", "elapsed_ms"}, "path" being the names from the
+ * root down ("Level/Enemies/Grunt").
+ *
+ * "scenes/object" - one object with its references
+ *   file_id      Any object of the file
+ * Result: {"path", "object":{"file_id", "class_id", "class", ...,
+ * "references":[{"field", "file_id", "guid", "path"}], "referenced_by":
+ * [{"file_id", "class", "field"}]}, "parse_ms", "elapsed_ms"}. A GameObject
+ * also lists its parent, children and components, each with its own
+ * references. References within the file have no guid.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_SCENES_H
+#define UNITY_MCP_SCENES_H
+
+#include "mongoose.h"
+
+#define SCENES_MAX_FILE_SIZE (512u * 1024u * 1024u)
+#define SCENES_CACHE_FILES 8
+#define SCENES_CACHE_BYTES (256u * 1024u * 1024u)   /* Parsed size kept across files */
+#define SCENES_CHUNK_SIZE (1024u * 1024u)           /* Text parsed per worker task */
+#define SCENES_DEFAULT_RESULTS 2000
+#define SCENES_MAX_RESULTS 50000
+#define SCENES_MAX_DEPTH 128
+
+/*
+ * The "scenes/hierarchy", "scenes/find" and "scenes/object" methods
+ * (ProjectMethods, see project.h).
+ */
+int ScenesHierarchyMethod(struct mg_str request, struct mg_iobuf* result, const char** error);
+int ScenesFindMethod(struct mg_str request, struct mg_iobuf* result, const char** error);
+int ScenesObjectMethod(struct mg_str request, struct mg_iobuf* result, const char** error);
+
+#endif /* UNITY_MCP_SCENES_H */
@@ -0,0 +1,1390 @@
+/*
+ * UnixxtyMCP Proxy - Project file search
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "search.h"
+#include "watcher.h"
+#include "project.h"
+#include "pattern.h"
+#include "jsonutil.h"
+#include "workers.h"
+#include "platform.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SEARCH_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+#define TRIGRAM_SPACE (1u << 24)
+#define VERIFY_BATCH 64             /* Candidate files verified per parallel round */
+
+typedef struct SearchFile
+{
+    int references;                 /* Indexes holding it; guarded by s_search_lock */
+    char* path;
+    uint64_t size;
+    int64_t modified;
+    int text;                       /* 0 for binary, unreadable or oversized files */
+    uint32_t trigram_count;
+    unsigned char* trigrams;        /* Ascending, as varint deltas */
+} SearchFile;
+
+typedef struct SearchIndex
+{
+    int references;
+    unsigned generation;            /* Project root generation it was built for */
+    SearchFile** files;             /* Sorted by path */
+    int file_count;
+    int text_count;
+    uint32_t* keys;                 /* Open addressing; trigram + 1, 0 when empty */
+    uint32_t* starts;               /* First posting of each key */
+    uint32_t* counts;
+    uint32_t capacity;              /* Power of two */
+    uint32_t key_count;
+    uint32_t* postings;             /* File indexes, ascending per trigram */
+    size_t posting_count;
+    uint64_t built_at;
+    uint64_t build_ms;
+} SearchIndex;
+
+static ProxyMutex s_search_lock = PROXY_MUTEX_INITIALIZER;
+static SearchIndex* s_search_index = NULL;
+static int s_search_running = 0;
+static int s_search_again = 0;
+static char s_search_stats_buffer[384];
+
+static unsigned char FoldByte(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + 32) : c;
+}
+
+static uint32_t TrigramAt(const unsigned char* p)
+{
+    return ((uint32_t)FoldByte(p[0]) << 16) | ((uint32_t)FoldByte(p[1]) << 8) | FoldByte(p[2]);
+}
+
+/*
+ * Files and indexes
+ */
+
+static void ReleaseFile(SearchFile* file)
+{
+    int last;
+
+    PROXY_MUTEX_LOCK(&s_search_lock);
+    last = --file->references == 0;
+    PROXY_MUTEX_UNLOCK(&s_search_lock);
+    if (last)
+    {
+        free(file->path);
+        free(file->trigrams);
+        free(file);
+    }
+}
+
+static void ReleaseIndex(SearchIndex* index)
+{
+    int last;
+    int i;
+
+    if (index == NULL)
+    {
+        return;
+    }
+    PROXY_MUTEX_LOCK(&s_search_lock);
+    last = --index->references == 0;
+    PROXY_MUTEX_UNLOCK(&s_search_lock);
+    if (!last)
+    {
+        return;
+    }
+    for (i = 0; i < index->file_count; i++)
+    {
+        ReleaseFile(index->files[i]);
+    }
+    free(index->files);
+    free(index->keys);
+    free(index->starts);
+    free(index->counts);
+    free(index->postings);
+    free(index);
+}
+
+static SearchIndex* AcquireIndex(void)
+{
+    SearchIndex* index;
+
+    PROXY_MUTEX_LOCK(&s_search_lock);
+    index = s_search_index;
+    if (index != NULL)
+    {
+        index->references++;
+    }
+    PROXY_MUTEX_UNLOCK(&s_search_lock);
+    return index;
+}
+
+static uint32_t HashSlot(uint32_t key, uint32_t capacity)
+{
+    return (key * 2654435761u) & (capacity - 1);
+}
+
+/*
+ * Slot of a trigram in the posting table, or UINT32_MAX if absent.
+ */
+static uint32_t FindTrigram(const SearchIndex* index, uint32_t trigram)
+{
+    uint32_t key = trigram + 1;
+    uint32_t slot;
+
+    if (index->capacity == 0)
+    {
+        return UINT32_MAX;
+    }
+    for (slot = HashSlot(key, index->capacity); index->keys[slot] != 0; slot = (slot + 1) & (index->capacity - 1))
+    {
+        if (index->keys[slot] == key)
+        {
+            return slot;
+        }
+    }
+    return UINT32_MAX;
+}
+
+/*
+ * Iterates a file's trigram set.
+ */
+typedef struct TrigramReader
+{
+    const unsigned char* p;
+    uint32_t remaining;
+    uint32_t value;
+} TrigramReader;
+
+static void TrigramReaderInit(TrigramReader* reader, const SearchFile* file)
+{
+    reader->p = file->trigrams;
+    reader->remaining = file->trigram_count;
+    reader->value = 0;
+}
+
+static int TrigramReaderNext(TrigramReader* reader, uint32_t* trigram)
+{
+    uint32_t delta = 0;
+    int shift = 0;
+
+    if (reader->remaining == 0)
+    {
+        return 0;
+    }
+    reader->remaining--;
+    while (*reader->p & 0x80)
+    {
+        delta |= (uint32_t)(*reader->p++ & 0x7f) << shift;
+        shift += 7;
+    }
+    delta |= (uint32_t)*reader->p++ << shift;
+    reader->value += delta;
+    *trigram = reader->value;
+    return 1;
+}
+
+/*
+ * Sort 24-bit trigrams with two 12-bit radix passes through `scratch`; a
+ * file has thousands of them, which qsort() spends most of an index build on.
+ */
+static void SortTrigrams(uint32_t* list, uint32_t* scratch, uint32_t count)
+{
+    uint32_t buckets[4096];
+    uint32_t* from = list;
+    uint32_t* to = scratch;
+    int shift;
+
+    for (shift = 0; shift < 24; shift += 12)
+    {
+        uint32_t total = 0;
+        uint32_t i;
+
+        memset(buckets, 0, sizeof(buckets));
+        for (i = 0; i < count; i++)
+        {
+            buckets[(from[i] >> shift) & 4095]++;
+        }
+        for (i = 0; i < 4096; i++)
+        {
+            uint32_t size = buckets[i];
+            buckets[i] = total;
+            total += size;
+        }
+        for (i = 0; i < count; i++)
+        {
+            to[buckets[(from[i] >> shift) & 4095]++] = from[i];
+        }
+        from = to;
+        to = from == list ? scratch : list;
+    }
+}
+
+/*
+ * Read a file and record its trigram set. `seen` is a TRIGRAM_SPACE bit set,
+ * clear on entry and on return.
+ */
+static void IndexFile(SearchFile* file, uint32_t* seen)
+{
+    size_t length = 0;
+    unsigned char* data;
+    uint32_t* list;
+    unsigned char* out;
+    uint32_t count = 0;
+    uint32_t previous = 0;
+    size_t i;
+
+    file->text = 0;
+    data = (unsigned char*)ProjectReadFile(file->path, SEARCH_MAX_FILE_SIZE, &length);
+    if (data == NULL)
+    {
+        return;
+    }
+    if (memchr(data, 0, length < SEARCH_BINARY_PROBE ? length : SEARCH_BINARY_PROBE) != NULL ||
+        (list = (uint32_t*)malloc((length > 2 ? length - 2 : 1) * 2 * sizeof(uint32_t))) == NULL)
+    {
+        free(data);
+        return;
+    }
+
+    for (i = 0; i + 2 < length; i++)
+    {
+        uint32_t trigram = TrigramAt(data + i);
+        if ((seen[trigram >> 5] & (1u << (trigram & 31))) == 0)
+        {
+            seen[trigram >> 5] |= 1u << (trigram & 31);
+            list[count++] = trigram;
+        }
+    }
+    free(data);
+    SortTrigrams(list, list + (length > 2 ? length - 2 : 1), count);
+
+    /* At most four bytes per delta of a 24-bit value */
+    file->trigrams = (unsigned char*)malloc((size_t)count * 4 + 1);
+    out = file->trigrams;
+    for (i = 0; i < count; i++)
+    {
+        seen[list[i] >> 5] = 0;
+        if (out != NULL)
+        {
+            uint32_t delta = list[i] - previous;
+            previous = list[i];
+            while (delta >= 0x80)
+            {
+                *out++ = (unsigned char)(delta | 0x80);
+                delta >>= 7;
+            }
+            *out++ = (unsigned char)delta;
+        }
+    }
+    free(list);
+    if (out == NULL)
+    {
+        return;
+    }
+    {
+        unsigned char* shrunk = (unsigned char*)realloc(file->trigrams, (size_t)(out - file->trigrams) + 1);
+        if (shrunk != NULL)
+        {
+            file->trigrams = shrunk;
+        }
+    }
+    file->trigram_count = count;
+    file->text = 1;
+}
+
+typedef struct IndexJob
+{
+    SearchFile** files;
+    int count;
+} IndexJob;
+
+static void IndexRange(void* context, int begin, int end)
+{
+    IndexJob* job = (IndexJob*)context;
+    uint32_t* seen = (uint32_t*)calloc(TRIGRAM_SPACE / 32, sizeof(uint32_t));
+    int i;
+
+    for (i = begin; i < end && seen != NULL; i++)
+    {
+        IndexFile(job->files[i], seen);
+    }
+    free(seen);
+}
+
+/*
+ * Slot for a key in a table under construction, growing it at half load.
+ * Returns UINT32_MAX if out of memory.
+ */
+static uint32_t InsertKey(SearchIndex* index, uint32_t key)
+{
+    uint32_t slot;
+
+    if (index->key_count * 2 >= index->capacity)
+    {
+        uint32_t capacity = index->capacity * 2;
+        uint32_t* keys = (uint32_t*)calloc(capacity, sizeof(uint32_t));
+        uint32_t* counts = (uint32_t*)calloc(capacity, sizeof(uint32_t));
+        uint32_t i;
+
+        if (keys == NULL || counts == NULL)
+        {
+            free(keys);
+            free(counts);
+            return UINT32_MAX;
+        }
+        for (i = 0; i < index->capacity; i++)
+        {
+            if (index->keys[i] != 0)
+            {
+                for (slot = HashSlot(index->keys[i], capacity); keys[slot] != 0; slot = (slot + 1) & (capacity - 1))
+                {
+                }
+                keys[slot] = index->keys[i];
+                counts[slot] = index->counts[i];
+            }
+        }
+        free(index->keys);
+        free(index->counts);
+        index->keys = keys;
+        index->counts = counts;
+        index->capacity = capacity;
+    }
+
+    for (slot = HashSlot(key, index->capacity); index->keys[slot] != 0 && index->keys[slot] != key;
+         slot = (slot + 1) & (index->capacity - 1))
+    {
+    }
+    if (index->keys[slot] == 0)
+    {
+        index->keys[slot] = key;
+        index->key_count++;
+    }
+    return slot;
+}
+
+/*
+ * Build the posting table of an index from its files' trigram sets.
+ */
+static int BuildPostings(SearchIndex* index)
+{
+    TrigramReader reader;
+    uint32_t trigram;
+    uint32_t slot;
+    size_t total = 0;
+    int i;
+
+    index->capacity = 1u << 16;
+    index->keys = (uint32_t*)calloc(index->capacity, sizeof(uint32_t));
+    index->counts = (uint32_t*)calloc(index->capacity, sizeof(uint32_t));
+    if (index->keys == NULL || index->counts == NULL)
+    {
+        return 0;
+    }
+
+    /* Count the files per trigram */
+    for (i = 0; i < index->file_count; i++)
+    {
+        TrigramReaderInit(&reader, index->files[i]);
+        while (TrigramReaderNext(&reader, &trigram))
+        {
+            if ((slot = InsertKey(index, trigram + 1)) == UINT32_MAX)
+            {
+                return 0;
+            }
+            index->counts[slot]++;
+            total++;
+        }
+    }
+    if (total > UINT32_MAX)
+    {
+        return 0;
+    }
+
+    index->posting_count = total;
+    index->starts = (uint32_t*)malloc((size_t)index->capacity * sizeof(uint32_t));
+    index->postings = (uint32_t*)malloc((total > 0 ? total : 1) * sizeof(uint32_t));
+    if (index->starts == NULL || index->postings == NULL)
+    {
+        return 0;
+    }
+    total = 0;
+    for (slot = 0; slot < index->capacity; slot++)
+    {
+        index->starts[slot] = (uint32_t)total;
+        total += index->counts[slot];
+        index->counts[slot] = 0;
+    }
+
+    /* Files are visited in order, so each posting list comes out ascending */
+    for (i = 0; i < index->file_count; i++)
+    {
+        TrigramReaderInit(&reader, index->files[i]);
+        while (TrigramReaderNext(&reader, &trigram))
+        {
+            slot = FindTrigram(index, trigram);
+            index->postings[index->starts[slot] + index->counts[slot]++] = (uint32_t)i;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Scanning
+ */
+
+typedef struct ScanState
+{
+    SearchFile** files;
+    int count;
+    int capacity;
+} ScanState;
+
+static int CollectFile(void* context, const char* path, uint64_t size, int64_t modified)
+{
+    ScanState* state = (ScanState*)context;
+    SearchFile* file;
+
+    if (state->count == SEARCH_MAX_FILES)
+    {
+        return 0;
+    }
+    if (state->count == state->capacity)
+    {
+        int capacity = state->capacity > 0 ? state->capacity * 2 : 4096;
+        SearchFile** grown = (SearchFile**)realloc(state->files, (size_t)capacity * sizeof(SearchFile*));
+        if (grown == NULL)
+        {
+            return 0;
+        }
+        state->files = grown;
+        state->capacity = capacity;
+    }
+    /* .meta files are Unity's bookkeeping; the GUIDs in them are not what a text search is after */
+    {
+        size_t length = strlen(path);
+        if (length > 5 && strcmp(path + length - 5, ".meta") == 0)
+        {
+            return 1;
+        }
+    }
+    file = (SearchFile*)calloc(1, sizeof(SearchFile));
+    if (file == NULL || (file->path = (char*)malloc(strlen(path) + 1)) == NULL)
+    {
+        free(file);
+        return 0;
+    }
+    memcpy(file->path, path, strlen(path) + 1);
+    file->references = 1;
+    file->size = size;
+    file->modified = modified;
+    state->files[state->count++] = file;
+    return 1;
+}
+
+static int CompareFilePaths(const void* a, const void* b)
+{
+    return strcmp((*(SearchFile* const*)a)->path, (*(SearchFile* const*)b)->path);
+}
+
+static SearchFile* FindFile(const SearchIndex* index, const char* path)
+{
+    int low = 0;
+    int high = index->file_count - 1;
+
+    while (low <= high)
+    {
+        int middle = low + (high - low) / 2;
+        int order = strcmp(index->files[middle]->path, path);
+        if (order == 0)
+        {
+            return index->files[middle];
+        }
+        if (order < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Walk the project and build a new index, reusing unchanged files of the
+ * previous one. Returns NULL if no root is configured or out of memory.
+ */
+static SearchIndex* BuildIndex(SearchIndex* previous)
+{
+    char root[PROJECT_MAX_PATH];
+    ScanState scan;
+    IndexJob job;
+    SearchIndex* index;
+    uint64_t started = mg_millis();
+    unsigned generation = ProjectRoot(root, sizeof(root));
+    int i;
+
+    memset(&scan, 0, sizeof(scan));
+    if (generation == 0 || ProjectWalk(CollectFile, &scan) < 0)
+    {
+        free(scan.files);
+        return NULL;
+    }
+    if (scan.count > 0)
+    {
+        qsort(scan.files, (size_t)scan.count, sizeof(SearchFile*), CompareFilePaths);
+    }
+
+    /* Take over the trigrams of files that did not change */
+    job.files = (SearchFile**)malloc((size_t)(scan.count > 0 ? scan.count : 1) * sizeof(SearchFile*));
+    job.count = 0;
+    for (i = 0; i < scan.count && job.files != NULL; i++)
+    {
+        SearchFile* file = scan.files[i];
+        SearchFile* old = previous != NULL && previous->generation == generation ? FindFile(previous, file->path) : NULL;
+        if (old != NULL && old->size == file->size && old->modified == file->modified)
+        {
+            PROXY_MUTEX_LOCK(&s_search_lock);
+            old->references++;
+            PROXY_MUTEX_UNLOCK(&s_search_lock);
+            ReleaseFile(file);
+            scan.files[i] = old;
+        }
+        else
+        {
+            job.files[job.count++] = file;
+        }
+    }
+    if (job.files != NULL)
+    {
+        WorkerParallelFor(job.count, 16, IndexRange, &job);
+    }
+    free(job.files);
+
+    index = (SearchIndex*)calloc(1, sizeof(SearchIndex));
+    if (index == NULL)
+    {
+        for (i = 0; i < scan.count; i++)
+        {
+            ReleaseFile(scan.files[i]);
+        }
+        free(scan.files);
+        return NULL;
+    }
+    index->references = 1;
+    index->generation = generation;
+    index->files = scan.files;
+    index->file_count = scan.count;
+    for (i = 0; i < scan.count; i++)
+    {
+        index->text_count += scan.files[i]->text;
+    }
+    if (!BuildPostings(index))
+    {
+        ReleaseIndex(index);
+        return NULL;
+    }
+    index->built_at = mg_millis();
+    index->build_ms = index->built_at - started;
+    return index;
+}
+
+static void RebuildTask(void* context)
+{
+    (void)context;
+    for (;;)
+    {
+        SearchIndex* previous = AcquireIndex();
+        SearchIndex* index = BuildIndex(previous);
+        SearchIndex* replaced = NULL;
+        int again;
+
+        PROXY_MUTEX_LOCK(&s_search_lock);
+        if (index != NULL)
+        {
+            replaced = s_search_index;
+            s_search_index = index;
+        }
+        again = s_search_again;
+        s_search_again = 0;
+        if (!again)
+        {
+            s_search_running = 0;
+        }
+        PROXY_MUTEX_UNLOCK(&s_search_lock);
+
+        ReleaseIndex(replaced);
+        ReleaseIndex(previous);
+        if (!again)
+        {
+            return;
+        }
+    }
+}
+
+/*
+ * Start a scan unless one is running; `again` schedules another one after it.
+ */
+static void StartScan(int again)
+{
+    int start;
+
+    PROXY_MUTEX_LOCK(&s_search_lock);
+    start = !s_search_running;
+    if (start)
+    {
+        s_search_running = 1;
+    }
+    else if (again)
+    {
+        s_search_again = 1;
+    }
+    PROXY_MUTEX_UNLOCK(&s_search_lock);
+
+    if (start && !WorkerSubmit(RebuildTask, NULL))
+    {
+        PROXY_MUTEX_LOCK(&s_search_lock);
+        s_search_running = 0;
+        PROXY_MUTEX_UNLOCK(&s_search_lock);
+    }
+}
+
+void SearchRefresh(void)
+{
+    StartScan(1);
+}
+
+/*
+ * Get search index statistics as a JSON object.
+ */
+EXPORT const char* GetSearchIndexStats(void)
+{
+    SearchIndex* index = AcquireIndex();
+    int running;
+
+    PROXY_MUTEX_LOCK(&s_search_lock);
+    running = s_search_running;
+    PROXY_MUTEX_UNLOCK(&s_search_lock);
+
+    if (index == NULL)
+    {
+        snprintf(s_search_stats_buffer, sizeof(s_search_stats_buffer), "{\"ready\":false,\"scanning\":%s}",
+            running ? "true" : "false");
+        return s_search_stats_buffer;
+    }
+    snprintf(s_search_stats_buffer, sizeof(s_search_stats_buffer),
+        "{\"ready\":true,\"scanning\":%s,\"files\":%d,\"text_files\":%d,\"trigrams\":%lu,"
+        "\"postings\":%lu,\"build_ms\":%lu,\"age_ms\":%lu}",
+        running ? "true" : "false", index->file_count, index->text_count, (unsigned long)index->key_count,
+        (unsigned long)index->posting_count, (unsigned long)index->build_ms,
+        (unsigned long)(mg_millis() - index->built_at));
+    ReleaseIndex(index);
+    return s_search_stats_buffer;
+}
+
+/*
+ * Verification
+ */
+
+/*
+ * Find the first occurrence of needle (lowercase if `folded`) in haystack,
+ * comparing case-insensitively if `folded`. Sixteen candidate positions at
+ * a time are screened on the needle's first and last bytes.
+ */
+static const char* FindLiteral(const char* haystack, size_t length, const char* needle, size_t needle_length,
+    int folded)
+{
+    size_t i = 0;
+    size_t j;
+
+    if (needle_length == 0 || needle_length > length)
+    {
+        return needle_length == 0 ? haystack : NULL;
+    }
+#ifdef SEARCH_SSE2
+    {
+        const __m128i first = _mm_set1_epi8(needle[0]);
+        const __m128i last = _mm_set1_epi8(needle[needle_length - 1]);
+        const __m128i upper_low = _mm_set1_epi8('A' - 1);
+        const __m128i upper_high = _mm_set1_epi8('Z' + 1);
+        const __m128i case_bit = _mm_set1_epi8(0x20);
+
+        for (; i + needle_length - 1 + 16 <= length; i += 16)
+        {
+            __m128i head = _mm_loadu_si128((const __m128i*)(haystack + i));
+            __m128i tail = _mm_loadu_si128((const __m128i*)(haystack + i + needle_length - 1));
+            unsigned mask;
+
+            if (folded)
+            {
+                /* Set the case bit of 'A'..'Z'; bytes >= 0x80 compare negative and are left alone */
+                head = _mm_or_si128(head, _mm_and_si128(case_bit,
+                    _mm_and_si128(_mm_cmpgt_epi8(head, upper_low), _mm_cmplt_epi8(head, upper_high))));
+                tail = _mm_or_si128(tail, _mm_and_si128(case_bit,
+                    _mm_and_si128(_mm_cmpgt_epi8(tail, upper_low), _mm_cmplt_epi8(tail, upper_high))));
+            }
+            mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last)));
+            while (mask != 0)
+            {
+                int bit = 0;
+                const char* candidate;
+                while ((mask & (1u << bit)) == 0)
+                {
+                    bit++;
+                }
+                mask &= mask - 1;
+                candidate = haystack + i + bit;
+                for (j = 1; j + 1 < needle_length; j++)
+                {
+                    unsigned char c = (unsigned char)candidate[j];
+                    if ((folded ? FoldByte(c) : c) != (unsigned char)needle[j])
+                    {
+                        break;
+                    }
+                }
+                if (j + 1 >= needle_length)
+                {
+                    return candidate;
+                }
+            }
+        }
+    }
+#endif
+    for (; i + needle_length <= length; i++)
+    {
+        for (j = 0; j < needle_length; j++)
+        {
+            unsigned char c = (unsigned char)haystack[i + j];
+            if ((folded ? FoldByte(c) : c) != (unsigned char)needle[j])
+            {
+                break;
+            }
+        }
+        if (j == needle_length)
+        {
+            return haystack + i;
+        }
+    }
+    return NULL;
+}
+
+static size_t CountNewlines(const char* p, const char* end)
+{
+    size_t count = 0;
+#ifdef SEARCH_SSE2
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - p >= 16)
+    {
+        /* Up to 255 blocks of byte counters, then a horizontal sum */
+        __m128i counters = _mm_setzero_si128();
+        __m128i sums;
+        int blocks = 0;
+        while (end - p >= 16 && blocks < 255)
+        {
+            counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), newline));
+            p += 16;
+            blocks++;
+        }
+        sums = _mm_sad_epu8(counters, _mm_setzero_si128());
+        count += (size_t)_mm_cvtsi128_si32(sums) + (size_t)_mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+    }
+#endif
+    for (; p < end; p++)
+    {
+        count += *p == '\n';
+    }
+    return count;
+}
+
+typedef struct SearchQuery
+{
+    char* text;
+    size_t text_length;
+    char* folded;                   /* Lowercase query, for case-insensitive literals */
+    int regex;
+    int case_sensitive;
+    Pattern* pattern;
+    const char* prefilter;          /* Literal every matching line contains, or NULL */
+    size_t prefilter_length;
+    char* prefilter_folded;
+    char* path;
+    size_t path_length;
+    char* glob;
+    int glob_has_slash;
+    int max_results;
+} SearchQuery;
+
+typedef struct VerifyTask
+{
+    SearchFile* file;
+    struct mg_iobuf matches;
+    size_t* ends;                   /* End of each match in `matches` */
+    int match_count;
+    int limit;
+    int more;                       /* Stopped at the limit with lines left */
+} VerifyTask;
+
+typedef struct VerifyJob
+{
+    const SearchQuery* query;
+    VerifyTask* tasks;
+} VerifyJob;
+
+static void AppendMatch(VerifyTask* task, const char* line, size_t line_length, size_t line_number, size_t column)
+{
+    char number[64];
+    size_t begin = 0;
+    size_t end = line_length;
+
+    if (line_length > 0 && line[line_length - 1] == '\r')
+    {
+        end--;
+    }
+    /* Long lines: a window around the match, cut at UTF-8 sequence boundaries */
+    if (end > SEARCH_LINE_PREVIEW)
+    {
+        begin = column > SEARCH_LINE_PREVIEW / 4 ? column - SEARCH_LINE_PREVIEW / 4 : 0;
+        while (begin > 0 && ((unsigned char)line[begin] & 0xc0) == 0x80)
+        {
+            begin--;
+        }
+        if (end - begin > SEARCH_LINE_PREVIEW)
+        {
+            end = begin + SEARCH_LINE_PREVIEW;
+            while (end > begin && ((unsigned char)line[end] & 0xc0) == 0x80)
+            {
+                end--;
+            }
+        }
+    }
+
+    if (task->match_count > 0)
+    {
+        mg_iobuf_add(&task->matches, task->matches.len, ",", 1);
+    }
+    mg_iobuf_add(&task->matches, task->matches.len, "{\"path\":", 8);
+    JsonAppendString(&task->matches, task->file->path, strlen(task->file->path));
+    snprintf(number, sizeof(number), ",\"line\":%lu,\"column\":%lu,\"text\":", (unsigned long)line_number,
+        (unsigned long)column + 1);
+    mg_iobuf_add(&task->matches, task->matches.len, number, strlen(number));
+    JsonAppendString(&task->matches, line + begin, end - begin);
+    mg_iobuf_add(&task->matches, task->matches.len, "}", 1);
+    task->ends[task->match_count++] = task->matches.len;
+}
+
+static void VerifyFile(const SearchQuery* query, VerifyTask* task, PatternScratch* scratch)
+{
+    size_t length = 0;
+    char* data = ProjectReadFile(task->file->path, SEARCH_MAX_FILE_SIZE, &length);
+    const char* end;
+    const char* cursor;
+    const char* counted;
+    size_t line_number = 1;
+
+    if (data == NULL || (task->ends = (size_t*)malloc((size_t)task->limit * sizeof(size_t))) == NULL)
+    {
+        free(data);
+        return;
+    }
+    end = data + length;
+    cursor = data;
+    counted = data;
+
+    while (cursor < end)
+    {
+        const char* hit = NULL;
+        const char* line;
+        const char* line_end;
+        size_t column = 0;
+
+        /* Jump to the next line holding the literal (or take every line) */
+        if (!query->regex)
+        {
+            hit = FindLiteral(cursor, (size_t)(end - cursor), query->case_sensitive ? query->text : query->folded,
+                query->text_length, !query->case_sensitive);
+        }
+        else if (query->prefilter != NULL)
+        {
+            hit = FindLiteral(cursor, (size_t)(end - cursor),
+                query->case_sensitive ? query->prefilter : query->prefilter_folded, query->prefilter_length,
+                !query->case_sensitive);
+        }
+        else
+        {
+            hit = cursor;
+        }
+        if (hit == NULL)
+        {
+            break;
+        }
+
+        line = hit;
+        while (line > cursor && line[-1] != '\n')
+        {
+            line--;
+        }
+        line_end = (const char*)memchr(hit, '\n', (size_t)(end - hit));
+        if (line_end == NULL)
+        {
+            line_end = end;
+        }
+
+        if (!query->regex || PatternMatch(query->pattern, scratch, line, (size_t)(line_end - line), &column))
+        {
+            if (!query->regex)
+            {
+                column = (size_t)(hit - line);
+            }
+            if (task->match_count == task->limit)
+            {
+                task->more = 1;
+                break;
+            }
+            line_number += CountNewlines(counted, line);
+            counted = line;
+            AppendMatch(task, line, (size_t)(line_end - line), line_number, column);
+        }
+        cursor = line_end + 1;
+    }
+    free(data);
+}
+
+static void VerifyRange(void* context, int begin, int end)
+{
+    VerifyJob* job = (VerifyJob*)context;
+    PatternScratch* scratch = job->query->regex ? PatternScratchCreate(job->query->pattern) : NULL;
+    int i;
+
+    if (job->query->regex && scratch == NULL)
+    {
+        return;
+    }
+    for (i = begin; i < end; i++)
+    {
+        VerifyFile(job->query, &job->tasks[i], scratch);
+    }
+    PatternScratchFree(scratch);
+}
+
+/*
+ * Candidates
+ */
+
+/*
+ * Mark the files holding every trigram of the literals in `marks`.
+ */
+static void MarkClause(const SearchIndex* index, const char* const* literals, const size_t* lengths, int count,
+    unsigned char* marks, uint32_t* scratch)
+{
+    uint32_t slots[256];
+    int slot_count = 0;
+    uint32_t candidate_count;
+    int i;
+    int k;
+
+    for (k = 0; k < count; k++)
+    {
+        size_t j;
+        for (j = 0; j + 2 < lengths[k]; j++)
+        {
+            uint32_t slot = FindTrigram(index, TrigramAt((const unsigned char*)literals[k] + j));
+            if (slot == UINT32_MAX)
+            {
+                return;  /* Some trigram occurs in no file */
+            }
+            if (slot_count < (int)(sizeof(slots) / sizeof(slots[0])))
+            {
+                slots[slot_count++] = slot;
+            }
+        }
+    }
+    if (slot_count == 0)
+    {
+        memset(marks, 1, (size_t)index->file_count);
+        return;
+    }
+
+    /* Intersect from the shortest posting list */
+    for (i = 1; i < slot_count; i++)
+    {
+        uint32_t slot = slots[i];
+        int j = i;
+        while (j > 0 && index->counts[slots[j - 1]] > index->counts[slot])
+        {
+            slots[j] = slots[j - 1];
+            j--;
+        }
+        slots[j] = slot;
+    }
+    candidate_count = index->counts[slots[0]];
+    memcpy(scratch, index->postings + index->starts[slots[0]], candidate_count * sizeof(uint32_t));
+    for (i = 1; i < slot_count && candidate_count > 0; i++)
+    {
+        const uint32_t* list = index->postings + index->starts[slots[i]];
+        uint32_t list_count = index->counts[slots[i]];
+        uint32_t a = 0;
+        uint32_t b = 0;
+        uint32_t kept = 0;
+        while (a < candidate_count && b < list_count)
+        {
+            if (scratch[a] < list[b])
+            {
+                a++;
+            }
+            else if (scratch[a] > list[b])
+            {
+                b++;
+            }
+            else
+            {
+                scratch[kept++] = scratch[a];
+                a++;
+                b++;
+            }
+        }
+        candidate_count = kept;
+    }
+    for (i = 0; i < (int)candidate_count; i++)
+    {
+        marks[scratch[i]] = 1;
+    }
+}
+
+static int MatchesScope(const SearchQuery* query, const char* path)
+{
+    if (query->path != NULL && query->path_length > 0 &&
+        (strncmp(path, query->path, query->path_length) != 0 || path[query->path_length] != '/'))
+    {
+        return 0;
+    }
+    if (query->glob != NULL && query->glob[0] != '\0')
+    {
+        const char* name = strrchr(path, '/');
+        return mg_match(mg_str(query->glob_has_slash || name == NULL ? path : name + 1), mg_str(query->glob), NULL);
+    }
+    return 1;
+}
+
+static void FreeQuery(SearchQuery* query)
+{
+    free(query->text);
+    free(query->folded);
+    free(query->prefilter_folded);
+    free(query->path);
+    free(query->glob);
+    PatternFree(query->pattern);
+}
+
+static char* GetParamString(struct mg_str request, const char* name)
+{
+    char path[64];
+    char* value;
+    char* copy = NULL;
+
+    snprintf(path, sizeof(path), "$.params.%s", name);
+    /* mongoose allocates from the pool (mg_free); the query owns malloc'd strings */
+    if ((value = mg_json_get_str(request, path)) != NULL)
+    {
+        if ((copy = (char*)malloc(strlen(value) + 1)) != NULL)
+        {
+            memcpy(copy, value, strlen(value) + 1);
+        }
+        mg_free(value);
+    }
+    return copy;
+}
+
+static int GetParamBool(struct mg_str request, const char* name, int fallback)
+{
+    char path[64];
+    bool value;
+    snprintf(path, sizeof(path), "$.params.%s", name);
+    return mg_json_get_bool(request, path, &value) ? (int)value : fallback;
+}
+
+static char* FoldCopy(const char* text, size_t length)
+{
+    char* folded = (char*)malloc(length + 1);
+    size_t i;
+    if (folded != NULL)
+    {
+        for (i = 0; i < length; i++)
+        {
+            folded[i] = (char)FoldByte((unsigned char)text[i]);
+        }
+        folded[length] = '\0';
+    }
+    return folded;
+}
+
+/*
+ * Parse the request params. Returns NULL or an error message.
+ */
+static const char* ParseQuery(struct mg_str request, SearchQuery* query)
+{
+    long max_results;
+
+    memset(query, 0, sizeof(*query));
+    query->text = GetParamString(request, "query");
+    if (query->text == NULL || query->text[0] == '\0')
+    {
+        return "query is required";
+    }
+    query->text_length = strlen(query->text);
+    query->regex = GetParamBool(request, "regex", 0);
+    query->case_sensitive = GetParamBool(request, "case_sensitive", 1);
+    query->folded = FoldCopy(query->text, query->text_length);
+    query->path = GetParamString(request, "path");
+    query->glob = GetParamString(request, "glob");
+    max_results = mg_json_get_long(request, "$.params.max_results", SEARCH_DEFAULT_RESULTS);
+    query->max_results = max_results < 1 ? 1 : max_results > SEARCH_MAX_RESULTS ? SEARCH_MAX_RESULTS : (int)max_results;
+    if (query->folded == NULL)
+    {
+        return "Out of memory";
+    }
+
+    if (query->path != NULL)
+    {
+        char* p;
+        for (p = query->path; *p != '\0'; p++)
+        {
+            if (*p == '\\')
+            {
+                *p = '/';
+            }
+        }
+        query->path_length = strlen(query->path);
+        while (query->path_length > 0 && query->path[query->path_length - 1] == '/')
+        {
+            query->path[--query->path_length] = '\0';
+        }
+    }
+    if (query->glob != NULL)
+    {
+        /* "**" crosses folders; mongoose globs spell that '#' */
+        char* in = query->glob;
+        char* out = query->glob;
+        while (*in != '\0')
+        {
+            if (in[0] == '*' && in[1] == '*')
+            {
+                *out++ = '#';
+                in += 2;
+            }
+            else
+            {
+                *out++ = *in++;
+            }
+        }
+        *out = '\0';
+        query->glob_has_slash = strchr(query->glob, '/') != NULL;
+    }
+
+    if (query->regex)
+    {
+        const char* error = NULL;
+        const PatternPlan* plan;
+
+        query->pattern = PatternCompile(mg_str_n(query->text, query->text_length), !query->case_sensitive, &error);
+        if (query->pattern == NULL)
+        {
+            return error;
+        }
+        /* With a single clause its longest literal is on every matching line */
+        plan = PatternLiterals(query->pattern);
+        if (plan->clause_count == 1)
+        {
+            int i;
+            for (i = 0; i < plan->clauses[0].count; i++)
+            {
+                if ((size_t)plan->clauses[0].lengths[i] > query->prefilter_length)
+                {
+                    query->prefilter = plan->clauses[0].literals[i];
+                    query->prefilter_length = (size_t)plan->clauses[0].lengths[i];
+                }
+            }
+            if (query->prefilter != NULL &&
+                (query->prefilter_folded = FoldCopy(query->prefilter, query->prefilter_length)) == NULL)
+            {
+                return "Out of memory";
+            }
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Mark the candidate files of a query.
+ */
+static int MarkCandidates(const SearchIndex* index, const SearchQuery* query, unsigned char* marks)
+{
+    uint32_t* scratch = (uint32_t*)malloc((size_t)(index->file_count > 0 ? index->file_count : 1) * sizeof(uint32_t));
+
+    if (scratch == NULL)
+    {
+        return 0;
+    }
+    if (!query->regex)
+    {
+        const char* literal = query->text;
+        MarkClause(index, &literal, &query->text_length, 1, marks, scratch);
+    }
+    else
+    {
+        const PatternPlan* plan = PatternLiterals(query->pattern);
+        int i;
+        if (plan->clause_count == 0)
+        {
+            memset(marks, 1, (size_t)index->file_count);
+        }
+        for (i = 0; i < plan->clause_count; i++)
+        {
+            const char* literals[PATTERN_MAX_LITERALS];
+            size_t lengths[PATTERN_MAX_LITERALS];
+            int k;
+            for (k = 0; k < plan->clauses[i].count; k++)
+            {
+                literals[k] = plan->clauses[i].literals[k];
+                lengths[k] = (size_t)plan->clauses[i].lengths[k];
+            }
+            MarkClause(index, literals, lengths, plan->clauses[i].count, marks, scratch);
+        }
+    }
+    free(scratch);
+    return 1;
+}
+
+int SearchFilesMethod(struct mg_str request, struct mg_iobuf* result, const char** error)
+{
+    uint64_t started = mg_millis();
+    SearchQuery query;
+    SearchIndex* index;
+    unsigned char* marks;
+    int* candidates;
+    int candidate_count = 0;
+    int match_count = 0;
+    int truncated = 0;
+    int i;
+    char summary[256];
+
+    if ((*error = ParseQuery(request, &query)) != NULL)
+    {
+        FreeQuery(&query);
+        return -32602;
+    }
+
+    index = AcquireIndex();
+    /* The watcher refreshes the index as files change; without it, age decides */
+    if (index == NULL || (WatcherMode() == WATCH_MODE_OFF && mg_millis() - index->built_at > SEARCH_RESCAN_MS))
+    {
+        StartScan(0);
+    }
+    {
+        char root[PROJECT_MAX_PATH];
+        unsigned generation = ProjectRoot(root, sizeof(root));
+
+        /* An index of another root or exclude set would answer for the wrong files */
+        if (index != NULL && index->generation != generation)
+        {
+            ReleaseIndex(index);
+            index = NULL;
+        }
+        if (index == NULL)
+        {
+            FreeQuery(&query);
+            *error = generation == 0 ? "Project root not configured"
+                : "Search index is being built; retry shortly";
+            return PROJECT_ERROR_NOT_READY;
+        }
+    }
+
+    marks = (unsigned char*)calloc((size_t)index->file_count + 1, 1);
+    candidates = (int*)malloc(((size_t)index->file_count + 1) * sizeof(int));
+    if (marks == NULL || candidates == NULL || !MarkCandidates(index, &query, marks))
+    {
+        free(marks);
+        free(candidates);
+        ReleaseIndex(index);
+        FreeQuery(&query);
+        *error = "Out of memory";
+        return -32603;
+    }
+    for (i = 0; i < index->file_count; i++)
+    {
+        if (marks[i] && index->files[i]->text && MatchesScope(&query, index->files[i]->path))
+        {
+            candidates[candidate_count++] = i;
+        }
+    }
+    free(marks);
+
+    mg_iobuf_add(result, result->len, "{\"matches\":[", 12);
+    for (i = 0; i < candidate_count && !truncated; i += VERIFY_BATCH)
+    {
+        VerifyTask tasks[VERIFY_BATCH];
+        VerifyJob job;
+        int batch = candidate_count - i < VERIFY_BATCH ? candidate_count - i : VERIFY_BATCH;
+        int k;
+
+        memset(tasks, 0, sizeof(tasks));
+        for (k = 0; k < batch; k++)
+        {
+            tasks[k].file = index->files[candidates[i + k]];
+            tasks[k].matches.align = 1024;
+            tasks[k].limit = query.max_results - match_count;
+        }
+        job.query = &query;
+        job.tasks = tasks;
+        WorkerParallelFor(batch, 1, VerifyRange, &job);
+
+        for (k = 0; k < batch; k++)
+        {
+            int count = tasks[k].match_count;
+            if (count > query.max_results - match_count)
+            {
+                count = query.max_results - match_count;
+            }
+            if (count > 0)
+            {
+                mg_iobuf_add(result, result->len, match_count > 0 ? "," : "", match_count > 0 ? 1 : 0);
+                mg_iobuf_add(result, result->len, tasks[k].matches.buf, tasks[k].ends[count - 1]);
+                match_count += count;
+            }
+            if (count < tasks[k].match_count || tasks[k].more)
+            {
+                truncated = 1;
+            }
+            mg_iobuf_free(&tasks[k].matches);
+            free(tasks[k].ends);
+        }
+        if (match_count == query.max_results && i + batch < candidate_count)
+        {
+            truncated = 1;  /* Files left unverified */
+        }
+    }
+
+    snprintf(summary, sizeof(summary),
+        "],\"truncated\":%s,\"files_indexed\":%d,\"files_searched\":%d,\"index_age_ms\":%lu,\"elapsed_ms\":%lu}",
+        truncated ? "true" : "false", index->text_count, candidate_count,
+        (unsigned long)(mg_millis() - index->built_at), (unsigned long)(mg_millis() - started));
+    mg_iobuf_add(result, result->len, summary, strlen(summary));
+
+    free(candidates);
+    ReleaseIndex(index);
+    FreeQuery(&query);
+    return 0;
+}
@@ -0,0 +1,60 @@
+/*
+ * UnixxtyMCP Proxy - Project file search
+ *
+ * Answers the "search/files" JSON-RPC method on the server thread, without
+ * involving C#, from a trigram index of the project's text files (see
+ * project.h). For every file the index keeps the set of case-folded
+ * three-byte sequences it contains; a query is narrowed to the files that
+ * hold every trigram of its literal (or of the literals a regular
+ * expression requires, see pattern.h), and only those are read and
+ * verified line by line with an SSE2 substring search.
+ *
+ * The index is built on the worker pool. Later scans reuse the trigrams of
+ * files whose size and modification time are unchanged, so refreshing it
+ * costs a directory walk plus the changed files. The file watcher (see
+ * watcher.h) starts a refresh after every batch of changes; should it not
+ * be running, a search does when the index is older than SEARCH_RESCAN_MS.
+ * Searches are answered from the current index meanwhile, and candidate
+ * files are always verified against their contents on disk.
+ *
+ * Request params:
+ *   query          Text or pattern to find (required)
+ *   regex          Treat query as a regular expression (default false)
+ *   case_sensitive Default true
+ *   path           Only files under this project-relative folder
+ *   glob           Only files matching this glob; matched against the file
+ *                  name unless it contains '/' ("*.cs", "Assets/Shaders/x*.shader")
+ *   max_results    Default SEARCH_DEFAULT_RESULTS, at most SEARCH_MAX_RESULTS
+ *
+ * Result: {"matches":[{"path","line","column","text"}], "truncated",
+ * "files_indexed", "files_searched", "index_age_ms", "elapsed_ms"}. One match
+ * is reported per line; columns are 1-based byte offsets.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_SEARCH_H
+#define UNITY_MCP_SEARCH_H
+
+#include "mongoose.h"
+
+#define SEARCH_MAX_FILES 200000
+#define SEARCH_MAX_FILE_SIZE (4 * 1024 * 1024)   /* Larger files are not indexed */
+#define SEARCH_BINARY_PROBE 8000                  /* A NUL byte in this prefix marks a binary file */
+#define SEARCH_RESCAN_MS 2000
+#define SEARCH_DEFAULT_RESULTS 100
+#define SEARCH_MAX_RESULTS 2000
+#define SEARCH_LINE_PREVIEW 240                   /* Bytes of line text per match */
+
+/*
+ * Start a background rescan of the project, or schedule another one after
+ * the scan in progress.
+ */
+void SearchRefresh(void);
+
+/*
+ * The "search/files" method (a ProjectMethod, see project.h).
+ */
+int SearchFilesMethod(struct mg_str request, struct mg_iobuf* result, const char** error);
+
+#endif /* UNITY_MCP_SEARCH_H */
@@ -0,0 +1,584 @@
+/*
+ * UnixxtyMCP Proxy - Spill files for large responses and request bodies
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "spill.h"
+#include "mongoose.h"
+#include "platform.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+    #define SPILL_HAVE_SENDFILE 0
+#else
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #if defined(__linux__)
+        #include <sys/sendfile.h>
+        #define SPILL_HAVE_SENDFILE 1
+    #elif defined(__APPLE__)
+        #include <sys/socket.h>
+        #include <sys/uio.h>
+        #define SPILL_HAVE_SENDFILE 1
+    #else
+        #define SPILL_HAVE_SENDFILE 0
+    #endif
+#endif
+
+struct SpillFile
+{
+    int references;
+    char path[1024];
+    const char* data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+};
+
+/*
+ * One client's transfer of a spilled file: [position, cut_start) from the
+ * file, then the replacement bytes, then [cut_end, size) from the file.
+ */
+typedef struct SpillStream
+{
+    struct mg_connection* connection;
+    SpillFile* file;
+    size_t position;
+    size_t cut_start;
+    size_t cut_end;
+    char* replacement;
+    size_t replacement_len;
+    int replacement_sent;
+    struct SpillStream* next;
+} SpillStream;
+
+/*
+ * A request body being received into a spill file.
+ */
+typedef struct SpillUpload
+{
+    struct mg_connection* connection;
+    FILE* file;
+    char path[1024];
+    char* head;
+    size_t remaining;
+    struct SpillUpload* next;
+} SpillUpload;
+
+static char s_spill_directory[1024] = "";
+
+/* Active streams and uploads (server thread only) */
+static SpillStream* s_streams = NULL;
+static SpillUpload* s_uploads = NULL;
+static unsigned long s_upload_counter = 0;
+
+/*
+ * Configure the directory C# writes spilled responses to.
+ */
+EXPORT void ConfigureSpillDirectory(const char* path)
+{
+    size_t length;
+    if (path == NULL)
+    {
+        s_spill_directory[0] = '\0';
+        return;
+    }
+    snprintf(s_spill_directory, sizeof(s_spill_directory), "%s", path);
+    length = strlen(s_spill_directory);
+    while (length > 0 && (s_spill_directory[length - 1] == '/' || s_spill_directory[length - 1] == '\\'))
+    {
+        s_spill_directory[--length] = '\0';
+    }
+}
+
+/*
+ * Only files directly inside the spill directory may be handed over,
+ * since they are deleted after sending.
+ */
+static int IsSpillPath(const char* path)
+{
+    size_t length = strlen(s_spill_directory);
+    if (length == 0 || strncmp(path, s_spill_directory, length) != 0)
+    {
+        return 0;
+    }
+    if (path[length] != '/' && path[length] != '\\')
+    {
+        return 0;
+    }
+    path += length + 1;
+    return path[0] != '\0' && strchr(path, '/') == NULL && strchr(path, '\\') == NULL &&
+        strcmp(path, ".") != 0 && strcmp(path, "..") != 0;
+}
+
+SpillFile* SpillOpen(const char* path)
+{
+    SpillFile* file;
+    if (path == NULL || !IsSpillPath(path))
+    {
+        return NULL;
+    }
+
+    file = (SpillFile*)calloc(1, sizeof(SpillFile));
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    file->references = 1;
+    snprintf(file->path, sizeof(file->path), "%s", path);
+
+#ifdef _WIN32
+    {
+        LARGE_INTEGER size;
+        file->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file->file, &size))
+        {
+            if (file->file != INVALID_HANDLE_VALUE) CloseHandle(file->file);
+            free(file);
+            return NULL;
+        }
+        file->size = (size_t)size.QuadPart;
+        if (file->size > 0)
+        {
+            file->mapping = CreateFileMappingA(file->file, NULL, PAGE_READONLY, 0, 0, NULL);
+            file->data = file->mapping != NULL
+                ? (const char*)MapViewOfFile(file->mapping, FILE_MAP_READ, 0, 0, 0)
+                : NULL;
+            if (file->data == NULL)
+            {
+                if (file->mapping != NULL) CloseHandle(file->mapping);
+                CloseHandle(file->file);
+                free(file);
+                return NULL;
+            }
+        }
+    }
+#else
+    {
+        struct stat info;
+        file->fd = open(path, O_RDONLY);
+        if (file->fd < 0 || fstat(file->fd, &info) != 0)
+        {
+            if (file->fd >= 0) close(file->fd);
+            free(file);
+            return NULL;
+        }
+        file->size = (size_t)info.st_size;
+        if (file->size > 0)
+        {
+            void* data = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, file->fd, 0);
+            if (data == MAP_FAILED)
+            {
+                close(file->fd);
+                free(file);
+                return NULL;
+            }
+            file->data = (const char*)data;
+        }
+    }
+#endif
+
+    return file;
+}
+
+void SpillRetain(SpillFile* file)
+{
+    file->references++;
+}
+
+void SpillRelease(SpillFile* file)
+{
+    if (file == NULL || --file->references > 0)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    if (file->data != NULL) UnmapViewOfFile(file->data);
+    if (file->mapping != NULL) CloseHandle(file->mapping);
+    CloseHandle(file->file);
+    DeleteFileA(file->path);
+#else
+    if (file->data != NULL) munmap((void*)file->data, file->size);
+    close(file->fd);
+    unlink(file->path);
+#endif
+    free(file);
+}
+
+struct mg_str SpillContents(const SpillFile* file)
+{
+    return mg_str_n(file->data, file->size);
+}
+
+const char* SpillPath(const SpillFile* file)
+{
+    return file->path;
+}
+
+int SpillStreamStart(struct mg_connection* connection, SpillFile* file,
+    size_t cut_start, size_t cut_end, struct mg_str replacement)
+{
+    SpillStream* stream = (SpillStream*)calloc(1, sizeof(SpillStream));
+    if (stream == NULL)
+    {
+        return 0;
+    }
+
+    if (replacement.buf != NULL && cut_start <= cut_end && cut_end <= file->size)
+    {
+        stream->replacement = (char*)malloc(replacement.len + 1);
+        if (stream->replacement == NULL)
+        {
+            free(stream);
+            return 0;
+        }
+        memcpy(stream->replacement, replacement.buf, replacement.len);
+        stream->replacement_len = replacement.len;
+        stream->cut_start = cut_start;
+        stream->cut_end = cut_end;
+    }
+    else
+    {
+        stream->cut_start = file->size;
+        stream->cut_end = file->size;
+        stream->replacement_sent = 1;
+    }
+
+    stream->connection = connection;
+    stream->file = file;
+    file->references++;
+    stream->next = s_streams;
+    s_streams = stream;
+
+    SpillStreamPump(connection);
+    return 1;
+}
+
+static SpillStream** FindStream(struct mg_connection* connection)
+{
+    SpillStream** link = &s_streams;
+    while (*link != NULL && (*link)->connection != connection)
+    {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+static void RemoveStream(SpillStream** link)
+{
+    SpillStream* stream = *link;
+    *link = stream->next;
+    SpillRelease(stream->file);
+    free(stream->replacement);
+    free(stream);
+}
+
+/*
+ * Append bytes to the send buffer without mg_send(), which re-fits the
+ * buffer on every call; once grown, the buffer is reused for each chunk.
+ */
+static int AppendToSendBuffer(struct mg_connection* connection, const char* data, size_t length)
+{
+    struct mg_iobuf* send = &connection->send;
+    if (send->len + length > send->size && !mg_iobuf_resize(send, send->len + length))
+    {
+        return 0;
+    }
+    memcpy(send->buf + send->len, data, length);
+    send->len += length;
+    return 1;
+}
+
+/*
+ * Send file bytes [position, end). Returns 1 when the range is done, 0 to
+ * wait for the socket or send buffer to drain, -1 on error.
+ */
+static int PumpRange(SpillStream* stream, size_t end)
+{
+    struct mg_connection* connection = stream->connection;
+
+#if SPILL_HAVE_SENDFILE
+    if (!connection->is_tls)
+    {
+        int socket_fd = (int)(size_t)connection->fd;
+        while (stream->position < end)
+        {
+            size_t remaining = end - stream->position;
+            size_t sent;
+
+            /* Headers and earlier bytes queued in mongoose must reach the socket first */
+            if (connection->send.len > 0)
+            {
+                return 0;
+            }
+
+#if defined(__linux__)
+            {
+                off_t offset = (off_t)stream->position;
+                ssize_t result = sendfile(socket_fd, stream->file->fd, &offset, remaining);
+                if (result < 0)
+                {
+                    return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+                }
+                if (result == 0)
+                {
+                    return -1;  /* File shrank underneath us */
+                }
+                sent = (size_t)result;
+            }
+#else
+            {
+                off_t length = (off_t)remaining;
+                int result = sendfile(stream->file->fd, socket_fd, (off_t)stream->position, &length, NULL, 0);
+                if (result < 0 && errno != EAGAIN && errno != EINTR)
+                {
+                    return -1;
+                }
+                if (length == 0)
+                {
+                    return result < 0 ? 0 : -1;
+                }
+                sent = (size_t)length;
+            }
+#endif
+            stream->position += sent;
+        }
+        return 1;
+    }
+#endif
+
+    /* Mapped path: keep up to two chunks queued for mongoose to write (and encrypt) */
+    while (stream->position < end && connection->send.len < SPILL_CHUNK_SIZE)
+    {
+        size_t chunk = end - stream->position;
+        if (chunk > SPILL_CHUNK_SIZE)
+        {
+            chunk = SPILL_CHUNK_SIZE;
+        }
+        if (!AppendToSendBuffer(connection, stream->file->data + stream->position, chunk))
+        {
+            return -1;
+        }
+        stream->position += chunk;
+    }
+    return stream->position >= end ? 1 : 0;
+}
+
+void SpillStreamPump(struct mg_connection* connection)
+{
+    SpillStream** link;
+    SpillStream* stream;
+    int result;
+
+    if (s_streams == NULL)
+    {
+        return;
+    }
+    link = FindStream(connection);
+    if ((stream = *link) == NULL)
+    {
+        return;
+    }
+
+    result = PumpRange(stream, stream->cut_start);
+    if (result == 1 && !stream->replacement_sent)
+    {
+        if (!AppendToSendBuffer(connection, stream->replacement, stream->replacement_len))
+        {
+            result = -1;
+        }
+        else
+        {
+            stream->replacement_sent = 1;
+            stream->position = stream->cut_end;
+        }
+    }
+    if (result == 1)
+    {
+        result = PumpRange(stream, stream->file->size);
+    }
+
+    if (result < 0)
+    {
+        connection->is_closing = 1;  /* Client already has a Content-Length it will never get */
+        RemoveStream(link);
+    }
+    else if (result == 1)
+    {
+        RemoveStream(link);
+    }
+}
+
+int SpillStreamsActive(void)
+{
+    return s_streams != NULL;
+}
+
+void SpillStreamClose(struct mg_connection* connection)
+{
+    SpillStream** link;
+    if (s_streams == NULL)
+    {
+        return;
+    }
+    link = FindStream(connection);
+    if (*link != NULL)
+    {
+        RemoveStream(link);
+    }
+}
+
+/*
+ * Request body uploads
+ */
+static SpillUpload** FindUpload(const struct mg_connection* connection)
+{
+    SpillUpload** link = &s_uploads;
+    while (*link != NULL && (*link)->connection != connection)
+    {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+static void RemoveUpload(SpillUpload** link, int delete_file)
+{
+    SpillUpload* upload = *link;
+    *link = upload->next;
+    if (upload->file != NULL)
+    {
+        fclose(upload->file);
+    }
+    if (delete_file)
+    {
+        remove(upload->path);
+    }
+    free(upload->head);
+    free(upload);
+}
+
+int SpillUploadStart(struct mg_connection* connection, struct mg_str head, size_t length)
+{
+    SpillUpload* upload;
+
+    if (s_spill_directory[0] == '\0' || *FindUpload(connection) != NULL)
+    {
+        return 0;
+    }
+    upload = (SpillUpload*)calloc(1, sizeof(SpillUpload));
+    if (upload == NULL)
+    {
+        return 0;
+    }
+    upload->head = (char*)malloc(head.len + 1);
+    if (upload->head == NULL)
+    {
+        free(upload);
+        return 0;
+    }
+    memcpy(upload->head, head.buf, head.len);
+    upload->head[head.len] = '\0';
+
+    /* The "upload_" prefix keeps C# from clearing bodies of requests queued across a domain reload */
+    if (snprintf(upload->path, sizeof(upload->path), "%s/upload_%lu_%lu.body",
+            s_spill_directory, connection->id, ++s_upload_counter) >= (int)sizeof(upload->path) ||
+        (upload->file = fopen(upload->path, "wb")) == NULL)
+    {
+        free(upload->head);
+        free(upload);
+        return 0;
+    }
+    upload->connection = connection;
+    upload->remaining = length;
+    upload->next = s_uploads;
+    s_uploads = upload;
+
+    /* Read in large steps; the buffer is emptied after every read */
+    if (connection->recv.size < SPILL_UPLOAD_BUFFER_SIZE)
+    {
+        mg_iobuf_resize(&connection->recv, SPILL_UPLOAD_BUFFER_SIZE);
+    }
+    return 1;
+}
+
+int SpillUploadActive(const struct mg_connection* connection)
+{
+    return s_uploads != NULL && *FindUpload(connection) != NULL;
+}
+
+int SpillUploadPump(struct mg_connection* connection)
+{
+    SpillUpload** link = FindUpload(connection);
+    SpillUpload* upload = *link;
+    size_t length;
+
+    if (upload == NULL)
+    {
+        return 0;
+    }
+    length = connection->recv.len < upload->remaining ? connection->recv.len : upload->remaining;
+    if (length > 0)
+    {
+        if (fwrite(connection->recv.buf, 1, length, upload->file) != length)
+        {
+            RemoveUpload(link, 1);
+            return -1;
+        }
+        mg_iobuf_del(&connection->recv, 0, length);
+        upload->remaining -= length;
+    }
+    return upload->remaining == 0 ? 1 : 0;
+}
+
+SpillFile* SpillUploadFinish(struct mg_connection* connection, char** head)
+{
+    SpillUpload** link = FindUpload(connection);
+    SpillUpload* upload = *link;
+    SpillFile* file = NULL;
+    int closed;
+
+    *head = NULL;
+    if (upload == NULL)
+    {
+        return NULL;
+    }
+    closed = fclose(upload->file) == 0;
+    upload->file = NULL;
+    if (closed && upload->remaining == 0)
+    {
+        file = SpillOpen(upload->path);
+    }
+    if (file != NULL)
+    {
+        *head = upload->head;
+        upload->head = NULL;
+    }
+    RemoveUpload(link, file == NULL);
+    return file;
+}
+
+void SpillUploadClose(struct mg_connection* connection)
+{
+    SpillUpload** link;
+    if (s_uploads == NULL)
+    {
+        return;
+    }
+    link = FindUpload(connection);
+    if (*link != NULL)
+    {
+        RemoveUpload(link, 1);
+    }
+}
@@ -0,0 +1,124 @@
+/*
+ * UnixxtyMCP Proxy - Spill files for large responses and request bodies
+ *
+ * Responses too large for the shared response buffer are written by C# to a
+ * file in the proxy's spill directory (outside Assets/, so Unity never
+ * imports them) and handed over with SendResponseFile(). The proxy maps the
+ * file and streams it to each waiting client after the reply headers: with
+ * sendfile() on plain POSIX connections, and by copying from the mapping
+ * into the send buffer a chunk at a time for TLS (or where sendfile is not
+ * available). The file is deleted once every stream has finished.
+ *
+ * Request bodies too large for the request buffer travel the other way.
+ * Once their headers are in, the proxy detaches mongoose's HTTP parser from
+ * the connection and appends each read to a new spill file, emptying the
+ * receive buffer as it goes, so neither MG_MAX_RECV_SIZE nor one contiguous
+ * allocation limits the body. The finished file is mapped like a response
+ * and C# reads the request from its path (GetPendingRequestFile()).
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_SPILL_H
+#define UNITY_MCP_SPILL_H
+
+#include "mongoose.h"
+
+/* Bytes copied into a connection's send buffer per step on the mapped path */
+#define SPILL_CHUNK_SIZE (64 * 1024)
+
+/* Receive buffer size while a request body is streamed to a file */
+#define SPILL_UPLOAD_BUFFER_SIZE (256 * 1024)
+
+typedef struct SpillFile SpillFile;
+
+/*
+ * Open and map a spilled response. The path must lie inside the configured
+ * spill directory. Returns NULL if it does not, or on any I/O error.
+ * The caller owns one reference.
+ */
+SpillFile* SpillOpen(const char* path);
+
+/*
+ * Take another reference.
+ */
+void SpillRetain(SpillFile* file);
+
+/*
+ * Drop a reference. The last one unmaps, closes and deletes the file.
+ */
+void SpillRelease(SpillFile* file);
+
+/*
+ * Mapped contents of a spilled response.
+ */
+struct mg_str SpillContents(const SpillFile* file);
+
+/*
+ * Path of a spill file.
+ */
+const char* SpillPath(const SpillFile* file);
+
+/*
+ * Stream a spilled response to a connection whose reply headers are already
+ * in its send buffer. If replacement.buf is set, bytes [cut_start, cut_end)
+ * of the file are sent as replacement instead (used to substitute the
+ * JSON-RPC id for coalesced waiters). Takes its own reference on the file.
+ * Returns 0 if the stream could not be allocated.
+ */
+int SpillStreamStart(struct mg_connection* connection, SpillFile* file,
+    size_t cut_start, size_t cut_end, struct mg_str replacement);
+
+/*
+ * Advance the connection's stream, if it has one. Call on MG_EV_POLL and
+ * MG_EV_WRITE.
+ */
+void SpillStreamPump(struct mg_connection* connection);
+
+/*
+ * Whether any stream is in progress (the event loop should poll quickly).
+ */
+int SpillStreamsActive(void);
+
+/*
+ * Release the connection's stream, if it has one. Call on MG_EV_CLOSE.
+ */
+void SpillStreamClose(struct mg_connection* connection);
+
+/*
+ * Start receiving a request body of `length` bytes into a new spill file.
+ * `head` (the request line and headers) is kept for SpillUploadFinish().
+ * The caller then removes the headers from the receive buffer, which makes
+ * mongoose stop parsing the connection, and calls SpillUploadPump().
+ * Returns 0 if no spill directory is configured or the file cannot be
+ * created.
+ */
+int SpillUploadStart(struct mg_connection* connection, struct mg_str head, size_t length);
+
+/*
+ * Whether a body is being received on the connection.
+ */
+int SpillUploadActive(const struct mg_connection* connection);
+
+/*
+ * Move received body bytes from the receive buffer to the file; anything
+ * after the body (a pipelined request) stays buffered. Call on MG_EV_READ.
+ * Returns 1 once the whole body is in, 0 while more is expected, and -1 on
+ * a write error (the upload is then discarded).
+ */
+int SpillUploadPump(struct mg_connection* connection);
+
+/*
+ * Close and map a completely received body. Returns the file (the caller
+ * owns one reference, and it is deleted with the last one) and hands over
+ * the saved head, NUL-terminated, for the caller to free(). Returns NULL
+ * if the file cannot be mapped.
+ */
+SpillFile* SpillUploadFinish(struct mg_connection* connection, char** head);
+
+/*
+ * Discard the connection's partial body, if any. Call on MG_EV_CLOSE.
+ */
+void SpillUploadClose(struct mg_connection* connection);
+
+#endif /* UNITY_MCP_SPILL_H */
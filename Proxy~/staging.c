@@ -0,0 +1,291 @@
+/*
+ * UnixxtyMCP Proxy - Staged file uploads
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "staging.h"
+#include "mongoose.h"
+#include "platform.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct StagedUpload
+{
+    char id[STAGING_ID_LENGTH + 1];
+    char path[1024];
+    size_t size;
+    uint64_t expires_at;
+    struct StagedUpload* next;
+} StagedUpload;
+
+/* Staged files, oldest first */
+static ProxyMutex s_staging_lock = PROXY_MUTEX_INITIALIZER;
+static char s_staging_directory[1024] = "";
+static StagedUpload* s_staged_head = NULL;
+static size_t s_staged_bytes = 0;
+
+static char s_staged_path_buffer[1024];
+
+/*
+ * Configure the directory uploads are staged in.
+ */
+EXPORT void ConfigureStagingDirectory(const char* path)
+{
+    size_t length;
+
+    PROXY_MUTEX_LOCK(&s_staging_lock);
+    snprintf(s_staging_directory, sizeof(s_staging_directory), "%s", path != NULL ? path : "");
+    length = strlen(s_staging_directory);
+    while (length > 0 && (s_staging_directory[length - 1] == '/' || s_staging_directory[length - 1] == '\\'))
+    {
+        s_staging_directory[--length] = '\0';
+    }
+    PROXY_MUTEX_UNLOCK(&s_staging_lock);
+}
+
+/*
+ * Unlink an upload from the list and delete its file. Caller holds the lock.
+ */
+static void RemoveStaged(StagedUpload** link)
+{
+    StagedUpload* upload = *link;
+    *link = upload->next;
+    s_staged_bytes -= upload->size;
+    remove(upload->path);
+    free(upload);
+}
+
+/*
+ * Drop expired uploads, then the oldest ones until `incoming` more bytes
+ * fit the budget. Caller holds the lock.
+ */
+static void SweepStaged(uint64_t now, size_t incoming)
+{
+    StagedUpload** link = &s_staged_head;
+    while (*link != NULL)
+    {
+        if (now >= (*link)->expires_at)
+        {
+            RemoveStaged(link);
+        }
+        else
+        {
+            link = &(*link)->next;
+        }
+    }
+    while (s_staged_head != NULL && s_staged_bytes + incoming > STAGING_BUDGET)
+    {
+        RemoveStaged(&s_staged_head);
+    }
+}
+
+static StagedUpload** FindStaged(const char* id)
+{
+    StagedUpload** link = &s_staged_head;
+    while (*link != NULL && strcmp((*link)->id, id) != 0)
+    {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+/*
+ * Reduce a client-supplied name to its last path component in a safe
+ * character set, so it can neither leave the directory nor need escaping
+ * in JSON.
+ */
+static void SanitizeName(struct mg_str name, char* output, size_t capacity, const char* fallback)
+{
+    size_t start = 0;
+    size_t length = 0;
+    size_t i;
+
+    for (i = 0; i < name.len; i++)
+    {
+        if (name.buf[i] == '/' || name.buf[i] == '\\')
+        {
+            start = i + 1;
+        }
+    }
+    for (i = start; i < name.len && length + 1 < capacity; i++)
+    {
+        char c = name.buf[i];
+        int safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+            c == '.' || c == '-' || c == '_';
+        output[length++] = safe ? c : '_';
+    }
+    output[length] = '\0';
+    if (length == 0 || strcmp(output, ".") == 0 || strcmp(output, "..") == 0)
+    {
+        snprintf(output, capacity, "%s", fallback);
+    }
+}
+
+static int WriteStagedFile(const char* path, struct mg_str data)
+{
+    FILE* file = fopen(path, "wb");
+    int written;
+    if (file == NULL)
+    {
+        return 0;
+    }
+    written = data.len == 0 || fwrite(data.buf, 1, data.len, file) == data.len;
+    if (fclose(file) != 0)
+    {
+        written = 0;
+    }
+    if (!written)
+    {
+        remove(path);
+    }
+    return written;
+}
+
+int StageMultipart(struct mg_str body, char* reply, size_t capacity)
+{
+    StagedUpload* staged[STAGING_MAX_PARTS];
+    char fields[STAGING_MAX_PARTS][64];
+    char directory[1024];
+    struct mg_http_part part;
+    size_t offset = 0;
+    size_t total = 0;
+    size_t used;
+    int count = 0;
+    int failed = 0;
+    int i;
+
+    PROXY_MUTEX_LOCK(&s_staging_lock);
+    memcpy(directory, s_staging_directory, sizeof(directory));
+    PROXY_MUTEX_UNLOCK(&s_staging_lock);
+    if (directory[0] == '\0')
+    {
+        return -1;
+    }
+
+    while (!failed && (offset = mg_http_next_multipart(body, offset, &part)) > 0)
+    {
+        unsigned char random[STAGING_ID_LENGTH / 2];
+        char filename[STAGING_MAX_FILENAME];
+        StagedUpload* upload;
+        size_t j;
+
+        if (part.filename.len == 0)
+        {
+            continue;  /* Plain form field */
+        }
+        upload = count < STAGING_MAX_PARTS ? (StagedUpload*)calloc(1, sizeof(StagedUpload)) : NULL;
+        if (upload == NULL || !mg_random(random, sizeof(random)))
+        {
+            free(upload);
+            failed = 1;
+            break;
+        }
+        for (j = 0; j < sizeof(random); j++)
+        {
+            snprintf(upload->id + j * 2, 3, "%02x", random[j]);
+        }
+        SanitizeName(part.filename, filename, sizeof(filename), "upload.bin");
+        SanitizeName(part.name, fields[count], sizeof(fields[count]), "file");
+        if (snprintf(upload->path, sizeof(upload->path), "%s/%s_%s", directory, upload->id, filename) >=
+                (int)sizeof(upload->path) ||
+            !WriteStagedFile(upload->path, part.body))
+        {
+            free(upload);
+            failed = 1;
+            break;
+        }
+        upload->size = part.body.len;
+        total += upload->size;
+        staged[count++] = upload;
+    }
+
+    if (failed || total > STAGING_BUDGET)
+    {
+        for (i = 0; i < count; i++)
+        {
+            remove(staged[i]->path);
+            free(staged[i]);
+        }
+        return -1;
+    }
+
+    used = (size_t)snprintf(reply, capacity, "{\"uploads\":[");
+    for (i = 0; i < count && used < capacity; i++)
+    {
+        used += (size_t)snprintf(reply + used, capacity - used,
+            "%s{\"id\":\"%s\",\"field\":\"%s\",\"filename\":\"%s\",\"size\":%lu}", i > 0 ? "," : "",
+            staged[i]->id, fields[i], staged[i]->path + strlen(directory) + 2 + STAGING_ID_LENGTH,
+            (unsigned long)staged[i]->size);
+    }
+    if (used < capacity)
+    {
+        snprintf(reply + used, capacity - used, "]}");
+    }
+
+    PROXY_MUTEX_LOCK(&s_staging_lock);
+    SweepStaged(mg_millis(), total);
+    {
+        StagedUpload** tail = &s_staged_head;
+        while (*tail != NULL)
+        {
+            tail = &(*tail)->next;
+        }
+        for (i = 0; i < count; i++)
+        {
+            staged[i]->expires_at = mg_millis() + STAGING_TTL_MS;
+            *tail = staged[i];
+            tail = &staged[i]->next;
+            s_staged_bytes += staged[i]->size;
+        }
+    }
+    PROXY_MUTEX_UNLOCK(&s_staging_lock);
+    return count;
+}
+
+/*
+ * Look up a staged upload and extend its lifetime.
+ */
+EXPORT const char* GetStagedUpload(const char* id)
+{
+    StagedUpload* upload;
+    const char* path = NULL;
+
+    if (id == NULL)
+    {
+        return NULL;
+    }
+    PROXY_MUTEX_LOCK(&s_staging_lock);
+    SweepStaged(mg_millis(), 0);
+    upload = *FindStaged(id);
+    if (upload != NULL)
+    {
+        upload->expires_at = mg_millis() + STAGING_TTL_MS;
+        snprintf(s_staged_path_buffer, sizeof(s_staged_path_buffer), "%s", upload->path);
+        path = s_staged_path_buffer;
+    }
+    PROXY_MUTEX_UNLOCK(&s_staging_lock);
+    return path;
+}
+
+/*
+ * Delete a staged upload (once imported).
+ */
+EXPORT void DropStagedUpload(const char* id)
+{
+    StagedUpload** link;
+
+    if (id == NULL)
+    {
+        return;
+    }
+    PROXY_MUTEX_LOCK(&s_staging_lock);
+    link = FindStaged(id);
+    if (*link != NULL)
+    {
+        RemoveStaged(link);
+    }
+    PROXY_MUTEX_UNLOCK(&s_staging_lock);
+}
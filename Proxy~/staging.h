@@ -0,0 +1,40 @@
+/*
+ * UnixxtyMCP Proxy - Staged file uploads
+ *
+ * Clients send files for file_import with POST /upload as
+ * multipart/form-data instead of base64 inside a tool call. Parts are not
+ * staged as they arrive: once the whole body is in (streamed to a spill
+ * file and mapped when it is large, see spill.h), each file part is copied
+ * to "<id>_<filename>" in the staging directory, and the reply lists one
+ * upload id per part. file_import takes
+ * the id as upload_id; C# finds the file with GetStagedUpload() and removes
+ * it with DropStagedUpload() once imported. Uploads expire after
+ * STAGING_TTL_MS, and the oldest are dropped when staged files exceed
+ * STAGING_BUDGET.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_STAGING_H
+#define UNITY_MCP_STAGING_H
+
+#include "mongoose.h"
+
+#define STAGING_ID_LENGTH 32                  /* Hex characters */
+#define STAGING_TTL_MS (10 * 60 * 1000)
+#define STAGING_BUDGET ((size_t)1024 * 1024 * 1024)
+#define STAGING_MAX_PARTS 16
+#define STAGING_MAX_FILENAME 128
+
+/*
+ * Stage every file part of a multipart/form-data body. Writes the reply
+ * JSON, {"uploads":[{"id","field","filename","size"}, ...]}, to `reply`.
+ * Parts without a filename (plain form fields) are skipped.
+ *
+ * Returns the number of files staged, 0 if the body has no file parts or
+ * is not valid multipart, or -1 if no staging directory is configured or a
+ * file could not be written (nothing is staged then).
+ */
+int StageMultipart(struct mg_str body, char* reply, size_t capacity);
+
+#endif /* UNITY_MCP_STAGING_H */
@@ -0,0 +1,2214 @@
+/*
+ * UnixxtyMCP Proxy - C# symbol index
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "symbols.h"
+#include "project.h"
+#include "jsonutil.h"
+#include "workers.h"
+#include "platform.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SYMBOL_NONE 0xffffffffu
+#define MAX_USAGE_TEXT 200            /* Bytes of a usage line sent */
+
+enum
+{
+    KIND_NAMESPACE,
+    KIND_CLASS,
+    KIND_STRUCT,
+    KIND_INTERFACE,
+    KIND_ENUM,
+    KIND_RECORD,
+    KIND_DELEGATE,
+    KIND_METHOD,
+    KIND_CONSTRUCTOR,
+    KIND_PROPERTY,
+    KIND_INDEXER,
+    KIND_EVENT,
+    KIND_FIELD,
+    KIND_OPERATOR,
+    KIND_ENUM_MEMBER,
+    KIND_COUNT
+};
+
+static const char* const KIND_NAMES[KIND_COUNT] = {
+    "namespace", "class", "struct", "interface", "enum", "record", "delegate", "method", "constructor",
+    "property", "indexer", "event", "field", "operator", "enum_member",
+};
+
+/* Modifier keywords, by bit */
+static const char* const MODIFIER_NAMES[] = {
+    "public", "protected", "internal", "private", "static", "abstract", "sealed", "virtual", "override",
+    "partial", "readonly", "const", "async", "extern", "unsafe", "new", "volatile", "required", "ref", "file",
+};
+#define MODIFIER_COUNT (sizeof(MODIFIER_NAMES) / sizeof(MODIFIER_NAMES[0]))
+
+typedef struct CodeSymbol
+{
+    uint32_t name;                    /* Offsets into the file's text */
+    uint32_t signature;               /* SYMBOL_NONE if none */
+    uint32_t parent;                  /* Symbol index, SYMBOL_NONE at the top */
+    uint32_t line;
+    uint32_t end_line;
+    uint32_t modifiers;               /* Bits of MODIFIER_NAMES */
+    uint8_t kind;
+} CodeSymbol;
+
+typedef struct CodeFile
+{
+    int references;                   /* Indexes holding it; guarded by s_symbols_lock */
+    char* path;
+    uint64_t size;
+    int64_t modified;
+    CodeSymbol* symbols;              /* In file order, containers before their members */
+    uint32_t symbol_count;
+    char* text;                       /* NUL-terminated names and signatures */
+    uint32_t* identifiers;            /* Distinct identifier hashes, ascending */
+    uint32_t identifier_count;
+} CodeFile;
+
+typedef struct SymbolEntry
+{
+    uint32_t file;
+    uint32_t symbol;
+} SymbolEntry;
+
+typedef struct SymbolIndex
+{
+    int references;
+    unsigned generation;              /* Project root generation it was built for */
+    CodeFile** files;                 /* Sorted by path */
+    int file_count;
+    SymbolEntry* entries;             /* By case-folded name, then path and position */
+    size_t entry_count;
+    uint64_t built_at;
+    uint64_t build_ms;
+} SymbolIndex;
+
+static ProxyMutex s_symbols_lock = PROXY_MUTEX_INITIALIZER;
+static SymbolIndex* s_symbols_index = NULL;
+static int s_symbols_running = 0;
+static int s_symbols_again = 0;
+static char s_symbols_stats_buffer[256];
+
+/* Read by the entry comparison; set by the one build running at a time */
+static const SymbolIndex* s_sort_index;
+
+static uint32_t IdentifierHash(const char* text, size_t length)
+{
+    return (uint32_t)JsonHash64(text, length, 0);
+}
+
+static const char* SymbolName(const CodeFile* file, const CodeSymbol* symbol)
+{
+    return file->text + symbol->name;
+}
+
+/*
+ * ASCII case-insensitive comparison, the order of the name array.
+ */
+static int FoldCompare(const char* a, const char* b)
+{
+    for (;; a++, b++)
+    {
+        int x = (*a >= 'A' && *a <= 'Z') ? *a + 32 : (unsigned char)*a;
+        int y = (*b >= 'A' && *b <= 'Z') ? *b + 32 : (unsigned char)*b;
+        if (x != y || x == 0)
+        {
+            return x - y;
+        }
+    }
+}
+
+static int FoldPrefix(const char* text, const char* prefix, size_t length)
+{
+    return mg_strcasecmp(mg_str_n(text, strnlen(text, length)), mg_str_n(prefix, length)) == 0;
+}
+
+static int ContainsFolded(const char* text, const char* needle, size_t length)
+{
+    for (; *text != '\0'; text++)
+    {
+        if (FoldPrefix(text, needle, length))
+        {
+            return 1;
+        }
+    }
+    return length == 0;
+}
+
+/*
+ * Files and indexes
+ */
+
+static void ReleaseFile(CodeFile* file)
+{
+    int last;
+
+    PROXY_MUTEX_LOCK(&s_symbols_lock);
+    last = --file->references == 0;
+    PROXY_MUTEX_UNLOCK(&s_symbols_lock);
+    if (last)
+    {
+        free(file->path);
+        free(file->symbols);
+        free(file->text);
+        free(file->identifiers);
+        free(file);
+    }
+}
+
+static void ReleaseIndex(SymbolIndex* index)
+{
+    int last;
+    int i;
+
+    if (index == NULL)
+    {
+        return;
+    }
+    PROXY_MUTEX_LOCK(&s_symbols_lock);
+    last = --index->references == 0;
+    PROXY_MUTEX_UNLOCK(&s_symbols_lock);
+    if (!last)
+    {
+        return;
+    }
+    for (i = 0; i < index->file_count; i++)
+    {
+        ReleaseFile(index->files[i]);
+    }
+    free(index->files);
+    free(index->entries);
+    free(index);
+}
+
+static SymbolIndex* AcquireIndex(void)
+{
+    SymbolIndex* index;
+
+    PROXY_MUTEX_LOCK(&s_symbols_lock);
+    index = s_symbols_index;
+    if (index != NULL)
+    {
+        index->references++;
+    }
+    PROXY_MUTEX_UNLOCK(&s_symbols_lock);
+    return index;
+}
+
+/*
+ * Tokenizer
+ *
+ * Only what declarations need: identifiers, single-character punctuation
+ * and "=>". Comments, preprocessor lines and the contents of literals are
+ * skipped, interpolation holes included.
+ */
+
+enum
+{
+    TOKEN_END,
+    TOKEN_IDENT,
+    TOKEN_PUNCT,
+    TOKEN_ARROW,
+    TOKEN_LITERAL
+};
+
+typedef struct CodeToken
+{
+    int kind;
+    const char* text;
+    size_t length;
+    uint32_t line;
+} CodeToken;
+
+typedef struct Lexer
+{
+    const char* p;
+    const char* end;
+    uint32_t line;
+    int line_start;                   /* Only whitespace so far on this line */
+} Lexer;
+
+static int IsIdentStart(unsigned char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c >= 0x80;
+}
+
+static int IsIdentPart(unsigned char c)
+{
+    return IsIdentStart(c) || (c >= '0' && c <= '9');
+}
+
+static void NextToken(Lexer* lexer, CodeToken* token);
+
+/*
+ * Skip a string literal from its opening quote: regular, verbatim (@"",
+ * with "" for a quote), interpolated ($"", holes skipped as code) or raw
+ * (three or more quotes, closed by as many).
+ */
+static void SkipString(Lexer* lexer, int verbatim, int interpolated)
+{
+    const char* p = lexer->p;
+    const char* end = lexer->end;
+    size_t quotes = 0;
+
+    while (p + quotes < end && p[quotes] == '"')
+    {
+        quotes++;
+    }
+    if (quotes >= 3)
+    {
+        for (p += quotes; p < end;)
+        {
+            size_t run = 0;
+            if (*p != '"')
+            {
+                lexer->line += *p == '\n';
+                p++;
+                continue;
+            }
+            while (p + run < end && p[run] == '"')
+            {
+                run++;
+            }
+            p += run;
+            if (run >= quotes)
+            {
+                break;
+            }
+        }
+        lexer->p = p;
+        return;
+    }
+
+    for (p++; p < end;)
+    {
+        char c = *p;
+        if (c == '"')
+        {
+            if (verbatim && p + 1 < end && p[1] == '"')
+            {
+                p += 2;
+                continue;
+            }
+            p++;
+            break;
+        }
+        if (c == '\\' && !verbatim)
+        {
+            p = p + 2 < end ? p + 2 : end;
+            continue;
+        }
+        if (c == '\n')
+        {
+            lexer->line++;
+            if (!verbatim)
+            {
+                /* Unterminated; resume at the next line */
+                p++;
+                lexer->line_start = 1;
+                lexer->p = p;
+                return;
+            }
+        }
+        if (c == '{' && interpolated)
+        {
+            CodeToken token;
+            int depth = 1;
+
+            if (p + 1 < end && p[1] == '{')
+            {
+                p += 2;
+                continue;
+            }
+            lexer->p = p + 1;
+            while (depth > 0)
+            {
+                NextToken(lexer, &token);
+                if (token.kind == TOKEN_END)
+                {
+                    break;
+                }
+                if (token.kind == TOKEN_PUNCT)
+                {
+                    depth += token.text[0] == '{' ? 1 : token.text[0] == '}' ? -1 : 0;
+                }
+            }
+            p = lexer->p;
+            continue;
+        }
+        p++;
+    }
+    lexer->p = p;
+}
+
+static void NextToken(Lexer* lexer, CodeToken* token)
+{
+    const char* p = lexer->p;
+    const char* end = lexer->end;
+    unsigned char c;
+
+    for (;;)
+    {
+        if (p >= end)
+        {
+            lexer->p = end;
+            token->kind = TOKEN_END;
+            token->text = end;
+            token->length = 0;
+            token->line = lexer->line;
+            return;
+        }
+        c = (unsigned char)*p;
+        if (c == '\n')
+        {
+            lexer->line++;
+            lexer->line_start = 1;
+            p++;
+        }
+        else if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v')
+        {
+            p++;
+        }
+        else if (c == '/' && p + 1 < end && p[1] == '/')
+        {
+            while (p < end && *p != '\n')
+            {
+                p++;
+            }
+        }
+        else if (c == '/' && p + 1 < end && p[1] == '*')
+        {
+            for (p += 2; p < end && !(*p == '*' && p + 1 < end && p[1] == '/'); p++)
+            {
+                lexer->line += *p == '\n';
+            }
+            p = p + 2 < end ? p + 2 : end;
+        }
+        else if (c == '#' && lexer->line_start)
+        {
+            while (p < end && *p != '\n')
+            {
+                p++;
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    lexer->line_start = 0;
+    token->text = p;
+    token->line = lexer->line;
+
+    if (c == '"' || c == '$' || c == '@')
+    {
+        const char* q = p;
+        int verbatim = 0;
+        int interpolated = 0;
+
+        while (q < end && (*q == '$' || *q == '@'))
+        {
+            verbatim |= *q == '@';
+            interpolated |= *q == '$';
+            q++;
+        }
+        if (q < end && *q == '"')
+        {
+            lexer->p = q;
+            SkipString(lexer, verbatim, interpolated);
+            token->kind = TOKEN_LITERAL;
+            token->length = (size_t)(lexer->p - p);
+            return;
+        }
+        if (c == '@' && q == p + 1 && q < end && IsIdentStart((unsigned char)*q))
+        {
+            /* @class: a keyword used as a name */
+            token->text = ++p;
+            c = (unsigned char)*p;
+        }
+    }
+
+    if (IsIdentStart(c))
+    {
+        const char* q = p + 1;
+        while (q < end && IsIdentPart((unsigned char)*q))
+        {
+            q++;
+        }
+        token->kind = TOKEN_IDENT;
+        token->length = (size_t)(q - p);
+        lexer->p = q;
+        return;
+    }
+    if ((c >= '0' && c <= '9') || (c == '.' && p + 1 < end && p[1] >= '0' && p[1] <= '9'))
+    {
+        const char* q = p + 1;
+        while (q < end && (IsIdentPart((unsigned char)*q) || *q == '.'))
+        {
+            q++;
+        }
+        token->kind = TOKEN_LITERAL;
+        token->length = (size_t)(q - p);
+        lexer->p = q;
+        return;
+    }
+    if (c == '\'')
+    {
+        const char* q = p + 1;
+        const char* limit = end - q > 12 ? q + 12 : end;
+        if (q < end && *q == '\\')
+        {
+            q++;
+        }
+        for (q++; q < limit && *q != '\'' && *q != '\n'; q++)
+        {
+        }
+        q = q < end && *q == '\'' ? q + 1 : q;
+        token->kind = TOKEN_LITERAL;
+        token->length = (size_t)(q - p);
+        lexer->p = q;
+        return;
+    }
+    if (c == '=' && p + 1 < end && p[1] == '>')
+    {
+        token->kind = TOKEN_ARROW;
+        token->length = 2;
+        lexer->p = p + 2;
+        return;
+    }
+    token->kind = TOKEN_PUNCT;
+    token->length = 1;
+    lexer->p = p + 1;
+}
+
+/*
+ * Parsing one file
+ */
+
+typedef struct FileBuilder
+{
+    CodeSymbol* symbols;
+    uint32_t symbol_count;
+    uint32_t symbol_capacity;
+    char* text;
+    size_t text_length;
+    size_t text_capacity;
+    uint32_t* identifiers;
+    uint32_t identifier_count;
+    uint32_t identifier_capacity;
+    int failed;                       /* Out of memory */
+} FileBuilder;
+
+typedef struct Parser
+{
+    Lexer lexer;
+    CodeToken token;
+    FileBuilder* out;
+} Parser;
+
+enum
+{
+    SCOPE_FILE,
+    SCOPE_NAMESPACE,
+    SCOPE_TYPE
+};
+
+static int TokenIs(const CodeToken* token, const char* word)
+{
+    size_t length = strlen(word);
+    return token->kind == TOKEN_IDENT && token->length == length && memcmp(token->text, word, length) == 0;
+}
+
+static int PunctIs(const CodeToken* token, char c)
+{
+    return token->kind == TOKEN_PUNCT && token->text[0] == c;
+}
+
+static void Advance(Parser* parser)
+{
+    FileBuilder* out = parser->out;
+
+    NextToken(&parser->lexer, &parser->token);
+    if (parser->token.kind != TOKEN_IDENT)
+    {
+        return;
+    }
+    if (out->identifier_count == out->identifier_capacity)
+    {
+        uint32_t capacity = out->identifier_capacity > 0 ? out->identifier_capacity * 2 : 1024;
+        uint32_t* grown = (uint32_t*)realloc(out->identifiers, capacity * sizeof(uint32_t));
+        if (grown == NULL)
+        {
+            out->failed = 1;
+            return;
+        }
+        out->identifiers = grown;
+        out->identifier_capacity = capacity;
+    }
+    out->identifiers[out->identifier_count++] = IdentifierHash(parser->token.text, parser->token.length);
+}
+
+static int ReserveText(FileBuilder* out, size_t more)
+{
+    if (out->text_length + more > out->text_capacity)
+    {
+        size_t capacity = out->text_capacity > 0 ? out->text_capacity * 2 : 4096;
+        char* grown;
+        while (capacity < out->text_length + more)
+        {
+            capacity *= 2;
+        }
+        if ((grown = (char*)realloc(out->text, capacity)) == NULL)
+        {
+            out->failed = 1;
+            return 0;
+        }
+        out->text = grown;
+        out->text_capacity = capacity;
+    }
+    return 1;
+}
+
+/*
+ * Append source text with comments dropped and whitespace runs collapsed
+ * to one space, SYMBOLS_MAX_SIGNATURE bytes at most from `start`.
+ */
+static void AppendCollapsed(FileBuilder* out, size_t start, const char* p, const char* end)
+{
+    int space = 0;
+    int quoted = 0;
+
+    while (p < end && out->text_length - start < SYMBOLS_MAX_SIGNATURE)
+    {
+        char c = *p;
+        if (!quoted && c == '/' && p + 1 < end && (p[1] == '/' || p[1] == '*'))
+        {
+            int line_comment = p[1] == '/';
+            for (p += 2; p < end && (line_comment ? *p != '\n' : !(*p == '*' && p + 1 < end && p[1] == '/')); p++)
+            {
+            }
+            p = line_comment || p + 2 > end ? p : p + 2;
+            space = 1;
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        {
+            space = 1;
+            p++;
+            continue;
+        }
+        quoted ^= c == '"';
+        if (space && out->text_length > start)
+        {
+            out->text[out->text_length++] = ' ';
+            if (out->text_length - start >= SYMBOLS_MAX_SIGNATURE)
+            {
+                break;
+            }
+        }
+        space = 0;
+        out->text[out->text_length++] = c;
+        p++;
+    }
+}
+
+/*
+ * Store a declaration header: the source from `begin` to `end`, then
+ * `name` if given (for the later declarators of a field).
+ */
+static uint32_t AddSignature(FileBuilder* out, const char* begin, const char* end, const char* name, size_t name_length)
+{
+    size_t start = out->text_length;
+
+    if (out->text_length > UINT32_MAX - SYMBOLS_MAX_SIGNATURE * 2 ||
+        !ReserveText(out, SYMBOLS_MAX_SIGNATURE + 2))
+    {
+        return SYMBOL_NONE;
+    }
+    AppendCollapsed(out, start, begin, end);
+    if (name != NULL && out->text_length - start + name_length + 1 < SYMBOLS_MAX_SIGNATURE)
+    {
+        if (out->text_length > start)
+        {
+            out->text[out->text_length++] = ' ';
+        }
+        memcpy(out->text + out->text_length, name, name_length);
+        out->text_length += name_length;
+    }
+    out->text[out->text_length++] = '\0';
+    return (uint32_t)start;
+}
+
+/*
+ * Store a name, dropping the spaces of "A . B" or "operator ==".
+ */
+static uint32_t AddName(FileBuilder* out, const char* prefix, const char* begin, const char* end)
+{
+    size_t start = out->text_length;
+    size_t prefix_length = prefix != NULL ? strlen(prefix) : 0;
+
+    if (out->text_length > UINT32_MAX - (size_t)(end - begin) - 64 ||
+        !ReserveText(out, prefix_length + (size_t)(end - begin) + 2))
+    {
+        return SYMBOL_NONE;
+    }
+    if (prefix != NULL)
+    {
+        memcpy(out->text + out->text_length, prefix, prefix_length);
+        out->text_length += prefix_length;
+        out->text[out->text_length++] = ' ';
+    }
+    for (; begin < end; begin++)
+    {
+        if (*begin != ' ' && *begin != '\t' && *begin != '\r' && *begin != '\n')
+        {
+            out->text[out->text_length++] = *begin;
+        }
+    }
+    out->text[out->text_length++] = '\0';
+    return (uint32_t)start;
+}
+
+/*
+ * Add a declaration. Returns its index, or SYMBOL_NONE if out of memory.
+ */
+static uint32_t AddSymbol(Parser* parser, int kind, uint32_t name, uint32_t parent, uint32_t line,
+    uint32_t modifiers, uint32_t signature)
+{
+    FileBuilder* out = parser->out;
+    CodeSymbol* symbol;
+
+    if (name == SYMBOL_NONE)
+    {
+        return SYMBOL_NONE;
+    }
+    if (out->symbol_count == out->symbol_capacity)
+    {
+        uint32_t capacity = out->symbol_capacity > 0 ? out->symbol_capacity * 2 : 64;
+        CodeSymbol* grown = (CodeSymbol*)realloc(out->symbols, capacity * sizeof(CodeSymbol));
+        if (grown == NULL)
+        {
+            out->failed = 1;
+            return SYMBOL_NONE;
+        }
+        out->symbols = grown;
+        out->symbol_capacity = capacity;
+    }
+    symbol = &out->symbols[out->symbol_count];
+    symbol->name = name;
+    symbol->signature = signature;
+    symbol->parent = parent;
+    symbol->line = line;
+    symbol->end_line = line;
+    symbol->modifiers = modifiers;
+    symbol->kind = (uint8_t)kind;
+    return out->symbol_count++;
+}
+
+static void SetEndLine(Parser* parser, uint32_t symbol, uint32_t line)
+{
+    if (symbol != SYMBOL_NONE)
+    {
+        parser->out->symbols[symbol].end_line = line;
+    }
+}
+
+/*
+ * From an opening bracket to its closing one (or the end of the file).
+ */
+static void SkipBalanced(Parser* parser)
+{
+    char open = parser->token.text[0];
+    char close = open == '(' ? ')' : open == '[' ? ']' : open == '<' ? '>' : '}';
+    int depth = 0;
+
+    for (; parser->token.kind != TOKEN_END; Advance(parser))
+    {
+        if (parser->token.kind != TOKEN_PUNCT)
+        {
+            continue;
+        }
+        if (parser->token.text[0] == open)
+        {
+            depth++;
+        }
+        else if (parser->token.text[0] == close && --depth == 0)
+        {
+            return;
+        }
+    }
+}
+
+/*
+ * Skip an expression up to the ';' (or ',' if `comma`) ending it, or the
+ * '}' closing the enclosing scope, and stop on that token.
+ */
+static void SkipExpression(Parser* parser, int comma)
+{
+    int depth = 0;
+
+    for (; parser->token.kind != TOKEN_END; Advance(parser))
+    {
+        char c;
+        if (parser->token.kind != TOKEN_PUNCT)
+        {
+            continue;
+        }
+        c = parser->token.text[0];
+        if (c == '(' || c == '[' || c == '{')
+        {
+            depth++;
+        }
+        else if (c == ')' || c == ']' || c == '}')
+        {
+            if (depth == 0 && c == '}')
+            {
+                return;
+            }
+            depth -= depth > 0;
+        }
+        else if (depth == 0 && (c == ';' || (comma && c == ',')))
+        {
+            return;
+        }
+    }
+}
+
+static void ParseScope(Parser* parser, uint32_t parent, int scope, const CodeToken* type_name, int depth);
+
+/*
+ * Enum members: names separated by commas, with optional values.
+ */
+static void ParseEnumMembers(Parser* parser, uint32_t parent)
+{
+    for (;;)
+    {
+        const CodeToken* token = &parser->token;
+        if (token->kind == TOKEN_END || PunctIs(token, '}'))
+        {
+            return;
+        }
+        if (PunctIs(token, '['))
+        {
+            SkipBalanced(parser);
+            Advance(parser);
+        }
+        else if (token->kind == TOKEN_IDENT)
+        {
+            uint32_t line = token->line;
+            uint32_t name = AddName(parser->out, NULL, token->text, token->text + token->length);
+            AddSymbol(parser, KIND_ENUM_MEMBER, name, parent, line, 0, SYMBOL_NONE);
+            Advance(parser);
+            SkipExpression(parser, 1);
+            if (PunctIs(&parser->token, ','))
+            {
+                Advance(parser);
+            }
+        }
+        else
+        {
+            Advance(parser);
+        }
+    }
+}
+
+/*
+ * A type declaration, from its keyword ("class", "enum", ...) to its body's
+ * closing brace.
+ */
+static void ParseType(Parser* parser, int kind, uint32_t parent, const char* start, uint32_t line,
+    uint32_t modifiers, int depth)
+{
+    CodeToken name;
+    uint32_t symbol;
+
+    Advance(parser);
+    if (kind == KIND_RECORD && (TokenIs(&parser->token, "struct") || TokenIs(&parser->token, "class")))
+    {
+        Advance(parser);
+    }
+    if (parser->token.kind != TOKEN_IDENT)
+    {
+        return;
+    }
+    name = parser->token;
+    Advance(parser);
+
+    /* Type parameters, primary constructor, base list and constraints */
+    while (parser->token.kind != TOKEN_END && !PunctIs(&parser->token, '{') && !PunctIs(&parser->token, ';') &&
+           !PunctIs(&parser->token, '}'))
+    {
+        if (PunctIs(&parser->token, '('))
+        {
+            SkipBalanced(parser);
+        }
+        Advance(parser);
+    }
+    symbol = AddSymbol(parser, kind, AddName(parser->out, NULL, name.text, name.text + name.length), parent, line,
+        modifiers, AddSignature(parser->out, start, parser->token.text, NULL, 0));
+    if (!PunctIs(&parser->token, '{'))
+    {
+        SetEndLine(parser, symbol, parser->token.line);
+        if (PunctIs(&parser->token, ';'))
+        {
+            Advance(parser);
+        }
+        return;
+    }
+
+    if (depth >= SYMBOLS_MAX_DEPTH || symbol == SYMBOL_NONE)
+    {
+        SkipBalanced(parser);
+    }
+    else
+    {
+        Advance(parser);
+        if (kind == KIND_ENUM)
+        {
+            ParseEnumMembers(parser, symbol);
+        }
+        else
+        {
+            ParseScope(parser, symbol, SCOPE_TYPE, &name, depth + 1);
+        }
+    }
+    SetEndLine(parser, symbol, parser->token.line);
+    if (PunctIs(&parser->token, '}'))
+    {
+        Advance(parser);
+    }
+    if (PunctIs(&parser->token, ';'))
+    {
+        Advance(parser);
+    }
+}
+
+/*
+ * "namespace A.B { ... }", or file-scoped "namespace A.B;" holding the rest
+ * of the file.
+ */
+static void ParseNamespace(Parser* parser, uint32_t parent, const char* start, uint32_t line, int depth)
+{
+    const char* begin;
+    const char* end;
+    uint32_t symbol;
+
+    Advance(parser);
+    begin = end = parser->token.text;
+    while (parser->token.kind == TOKEN_IDENT || PunctIs(&parser->token, '.'))
+    {
+        end = parser->token.text + parser->token.length;
+        Advance(parser);
+    }
+    if (end == begin || (!PunctIs(&parser->token, '{') && !PunctIs(&parser->token, ';')))
+    {
+        return;
+    }
+    symbol = AddSymbol(parser, KIND_NAMESPACE, AddName(parser->out, NULL, begin, end), parent, line, 0,
+        AddSignature(parser->out, start, end, NULL, 0));
+    if (PunctIs(&parser->token, ';'))
+    {
+        Advance(parser);
+        ParseScope(parser, symbol, SCOPE_NAMESPACE, NULL, depth + 1);
+        SetEndLine(parser, symbol, parser->token.line);
+        return;
+    }
+    if (depth >= SYMBOLS_MAX_DEPTH || symbol == SYMBOL_NONE)
+    {
+        SkipBalanced(parser);
+    }
+    else
+    {
+        Advance(parser);
+        ParseScope(parser, symbol, SCOPE_NAMESPACE, NULL, depth + 1);
+    }
+    SetEndLine(parser, symbol, parser->token.line);
+    if (PunctIs(&parser->token, '}'))
+    {
+        Advance(parser);
+    }
+}
+
+/*
+ * The declarators of a field or event field, from the token after the
+ * first name ('=', ',' or ';'). A later name must be followed by one of
+ * those too; anything else means a comma of an initializer was taken for a
+ * separator ("= new Dictionary<int, string>()"), and the rest is skipped.
+ */
+static void ParseFields(Parser* parser, int kind, uint32_t parent, const char* start, const char* prefix_end,
+    uint32_t line, uint32_t modifiers, CodeToken name)
+{
+    uint32_t first = parser->out->symbol_count;
+    uint32_t i;
+
+    for (;;)
+    {
+        AddSymbol(parser, kind, AddName(parser->out, NULL, name.text, name.text + name.length), parent, line,
+            modifiers, AddSignature(parser->out, start, prefix_end, name.text, name.length));
+        if (PunctIs(&parser->token, '='))
+        {
+            Advance(parser);
+            SkipExpression(parser, 1);
+        }
+        if (!PunctIs(&parser->token, ','))
+        {
+            break;
+        }
+        Advance(parser);
+        if (parser->token.kind != TOKEN_IDENT)
+        {
+            SkipExpression(parser, 0);
+            break;
+        }
+        name = parser->token;
+        line = parser->token.line;
+        Advance(parser);
+        if (!PunctIs(&parser->token, '=') && !PunctIs(&parser->token, ',') && !PunctIs(&parser->token, ';'))
+        {
+            SkipExpression(parser, 0);
+            break;
+        }
+    }
+    for (i = first; i < parser->out->symbol_count; i++)
+    {
+        parser->out->symbols[i].end_line = parser->token.line;
+    }
+    if (PunctIs(&parser->token, ';'))
+    {
+        Advance(parser);
+    }
+}
+
+/*
+ * Skip the rest of a member after its header: a block body, an expression
+ * body, or the ';' of an abstract or extern one. Returns the line it ends on.
+ */
+static uint32_t SkipMemberBody(Parser* parser)
+{
+    uint32_t line;
+
+    for (; parser->token.kind != TOKEN_END; Advance(parser))
+    {
+        if (PunctIs(&parser->token, '{'))
+        {
+            SkipBalanced(parser);
+            line = parser->token.line;
+            Advance(parser);
+            return line;
+        }
+        if (parser->token.kind == TOKEN_ARROW)
+        {
+            SkipExpression(parser, 0);
+            break;
+        }
+        if (PunctIs(&parser->token, ';') || PunctIs(&parser->token, '}'))
+        {
+            break;
+        }
+        if (PunctIs(&parser->token, '(') || PunctIs(&parser->token, '['))
+        {
+            SkipBalanced(parser);
+        }
+    }
+    /* On the ';' ending it, or the '}' closing the enclosing scope */
+    line = parser->token.line;
+    if (PunctIs(&parser->token, ';'))
+    {
+        Advance(parser);
+    }
+    return line;
+}
+
+/*
+ * One declaration of a scope: a namespace, type or member, or a using
+ * directive or other statement that declares nothing.
+ */
+static void ParseDeclaration(Parser* parser, uint32_t parent, int scope, const CodeToken* type_name, int depth)
+{
+    const char* start = parser->token.text;
+    uint32_t line = parser->token.line;
+    uint32_t modifiers = 0;
+    CodeToken name;
+    const char* name_start = NULL;   /* Where the last name began, for field signatures */
+    const char* operator_end = NULL;  /* After "operator" */
+    int has_name = 0;
+    int angle = 0;
+    int is_event = 0;
+    int is_delegate = 0;
+    const char* tilde = NULL;         /* A finalizer's '~' */
+
+    memset(&name, 0, sizeof(name));
+    for (;;)
+    {
+        CodeToken* token = &parser->token;
+
+        if (token->kind == TOKEN_END || PunctIs(token, '}'))
+        {
+            return;
+        }
+
+        /* "operator ==(" or "implicit operator int(": the name runs to the '(' */
+        if (operator_end != NULL && !PunctIs(token, '('))
+        {
+            Advance(parser);
+            continue;
+        }
+
+        if (token->kind == TOKEN_IDENT)
+        {
+            size_t k;
+            int modifier = -1;
+
+            if (angle > 0)
+            {
+                Advance(parser);
+                continue;
+            }
+            if (!has_name)
+            {
+                for (k = 0; k < MODIFIER_COUNT; k++)
+                {
+                    if (TokenIs(token, MODIFIER_NAMES[k]))
+                    {
+                        modifier = (int)k;
+                        break;
+                    }
+                }
+            }
+            if (modifier >= 0)
+            {
+                modifiers |= 1u << modifier;
+            }
+            else if (!has_name && !is_event && !is_delegate && (TokenIs(token, "class") || TokenIs(token, "struct") ||
+                     TokenIs(token, "interface") || TokenIs(token, "enum") || TokenIs(token, "record")))
+            {
+                int kind = TokenIs(token, "class") ? KIND_CLASS : TokenIs(token, "struct") ? KIND_STRUCT
+                    : TokenIs(token, "interface") ? KIND_INTERFACE : TokenIs(token, "enum") ? KIND_ENUM : KIND_RECORD;
+                ParseType(parser, kind, parent, start, line, modifiers, depth);
+                return;
+            }
+            else if (!has_name && scope != SCOPE_TYPE && TokenIs(token, "namespace"))
+            {
+                ParseNamespace(parser, parent, start, line, depth);
+                return;
+            }
+            else if (!has_name && scope != SCOPE_TYPE && TokenIs(token, "using"))
+            {
+                SkipExpression(parser, 0);
+                if (PunctIs(&parser->token, ';'))
+                {
+                    Advance(parser);
+                }
+                return;
+            }
+            else if (TokenIs(token, "event"))
+            {
+                is_event = 1;
+            }
+            else if (TokenIs(token, "delegate"))
+            {
+                is_delegate = 1;
+            }
+            else if (TokenIs(token, "operator"))
+            {
+                operator_end = token->text + token->length;
+            }
+            else
+            {
+                name = *token;
+                name_start = token->text;
+                has_name = 1;
+            }
+            Advance(parser);
+            continue;
+        }
+
+        if (token->kind == TOKEN_ARROW || PunctIs(token, '{'))
+        {
+            /* A property, indexer or event with accessors or an expression body */
+            uint32_t symbol = SYMBOL_NONE;
+            if (has_name && scope == SCOPE_TYPE)
+            {
+                int kind = TokenIs(&name, "this") ? KIND_INDEXER : is_event ? KIND_EVENT : KIND_PROPERTY;
+                symbol = AddSymbol(parser, kind, AddName(parser->out, NULL, name.text, name.text + name.length),
+                    parent, line, modifiers, AddSignature(parser->out, start, token->text, NULL, 0));
+            }
+            if (token->kind == TOKEN_ARROW)
+            {
+                SkipExpression(parser, 0);
+                SetEndLine(parser, symbol, parser->token.line);
+            }
+            else
+            {
+                Lexer next_lexer;
+                CodeToken next;
+
+                SkipBalanced(parser);
+                SetEndLine(parser, symbol, parser->token.line);
+                if (parser->token.kind == TOKEN_END)
+                {
+                    return;
+                }
+                /* "{ get; set; } = value;" */
+                next_lexer = parser->lexer;
+                NextToken(&next_lexer, &next);
+                Advance(parser);
+                if (next.kind != TOKEN_PUNCT || next.text[0] != '=')
+                {
+                    return;
+                }
+                SkipExpression(parser, 0);
+            }
+            if (PunctIs(&parser->token, ';'))
+            {
+                Advance(parser);
+            }
+            return;
+        }
+
+        if (token->kind != TOKEN_PUNCT)
+        {
+            Advance(parser);
+            continue;
+        }
+
+        switch (token->text[0])
+        {
+        case '<':
+            angle++;
+            Advance(parser);
+            break;
+        case '>':
+            angle -= angle > 0;
+            Advance(parser);
+            break;
+        case '~':
+            tilde = token->text;
+            Advance(parser);
+            break;
+        case '[':
+            SkipBalanced(parser);
+            Advance(parser);
+            break;
+        case '(':
+            if ((!has_name || angle > 0) && operator_end == NULL)
+            {
+                /* A tuple type */
+                SkipBalanced(parser);
+                Advance(parser);
+                break;
+            }
+            {
+                const char* header_end;
+                uint32_t symbol = SYMBOL_NONE;
+                uint32_t symbol_name;
+                int kind;
+
+                if (operator_end != NULL)
+                {
+                    kind = KIND_OPERATOR;
+                    symbol_name = AddName(parser->out, "operator", operator_end, token->text);
+                }
+                else
+                {
+                    kind = is_delegate ? KIND_DELEGATE
+                        : (tilde == NULL && type_name != NULL && name.length == type_name->length &&
+                           memcmp(name.text, type_name->text, name.length) == 0) ? KIND_CONSTRUCTOR : KIND_METHOD;
+                    symbol_name = tilde != NULL ? AddName(parser->out, NULL, tilde, name.text + name.length)
+                        : AddName(parser->out, NULL, name.text, name.text + name.length);
+                }
+                SkipBalanced(parser);
+                header_end = parser->token.text + parser->token.length;
+                if (scope == SCOPE_TYPE || kind == KIND_DELEGATE)
+                {
+                    symbol = AddSymbol(parser, kind, symbol_name, parent, line, modifiers,
+                        AddSignature(parser->out, start, header_end, NULL, 0));
+                }
+                Advance(parser);
+                SetEndLine(parser, symbol, SkipMemberBody(parser));
+                return;
+            }
+        case '=':
+        case ',':
+        case ';':
+            if (angle > 0 && token->text[0] == ',')
+            {
+                /* Between type arguments */
+                Advance(parser);
+                break;
+            }
+            if (has_name && scope == SCOPE_TYPE)
+            {
+                ParseFields(parser, is_event ? KIND_EVENT : KIND_FIELD, parent, start, name_start, line, modifiers,
+                    name);
+                return;
+            }
+            if (token->text[0] == ';')
+            {
+                Advance(parser);
+                return;
+            }
+            SkipExpression(parser, 0);
+            if (PunctIs(&parser->token, ';'))
+            {
+                Advance(parser);
+            }
+            return;
+        default:
+            Advance(parser);
+            break;
+        }
+    }
+}
+
+/*
+ * Declarations up to the '}' closing the scope, or the end of the file.
+ */
+static void ParseScope(Parser* parser, uint32_t parent, int scope, const CodeToken* type_name, int depth)
+{
+    for (;;)
+    {
+        const CodeToken* token = &parser->token;
+        if (token->kind == TOKEN_END || PunctIs(token, '}'))
+        {
+            return;
+        }
+        if (PunctIs(token, ';'))
+        {
+            Advance(parser);
+        }
+        else if (PunctIs(token, '['))
+        {
+            /* Attributes */
+            SkipBalanced(parser);
+            Advance(parser);
+        }
+        else
+        {
+            ParseDeclaration(parser, parent, scope, type_name, depth);
+        }
+    }
+}
+
+static int CompareHashes(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+/*
+ * Map a file and record its declarations and identifiers.
+ */
+static void ScanFile(CodeFile* file)
+{
+    ProjectMapping mapping;
+    FileBuilder out;
+    Parser parser;
+    uint32_t i;
+    uint32_t count = 0;
+
+    free(file->symbols);
+    free(file->text);
+    free(file->identifiers);
+    file->symbols = NULL;
+    file->text = NULL;
+    file->identifiers = NULL;
+    file->symbol_count = 0;
+    file->identifier_count = 0;
+    if (!ProjectMapFile(file->path, SYMBOLS_MAX_FILE_SIZE, &mapping))
+    {
+        return;
+    }
+    memset(&out, 0, sizeof(out));
+    if (mapping.data != NULL)
+    {
+        memset(&parser, 0, sizeof(parser));
+        parser.lexer.p = mapping.data;
+        parser.lexer.end = mapping.data + mapping.length;
+        parser.lexer.line = 1;
+        parser.lexer.line_start = 1;
+        parser.out = &out;
+        /* A byte order mark */
+        if (mapping.length >= 3 && memcmp(mapping.data, "\xef\xbb\xbf", 3) == 0)
+        {
+            parser.lexer.p += 3;
+        }
+        Advance(&parser);
+        while (parser.token.kind != TOKEN_END && !out.failed)
+        {
+            ParseScope(&parser, SYMBOL_NONE, SCOPE_FILE, NULL, 0);
+            if (parser.token.kind != TOKEN_END)
+            {
+                /* A stray '}' */
+                Advance(&parser);
+            }
+        }
+    }
+    ProjectUnmapFile(&mapping);
+    if (out.failed)
+    {
+        free(out.symbols);
+        free(out.text);
+        free(out.identifiers);
+        return;
+    }
+
+    if (out.identifier_count > 0)
+    {
+        qsort(out.identifiers, out.identifier_count, sizeof(uint32_t), CompareHashes);
+        for (i = 0; i < out.identifier_count; i++)
+        {
+            if (count == 0 || out.identifiers[count - 1] != out.identifiers[i])
+            {
+                out.identifiers[count++] = out.identifiers[i];
+            }
+        }
+    }
+    file->symbols = out.symbols;
+    file->symbol_count = out.symbol_count;
+    file->text = out.text;
+    if (count == 0)
+    {
+        free(out.identifiers);
+    }
+    else
+    {
+        file->identifiers = (uint32_t*)realloc(out.identifiers, count * sizeof(uint32_t));
+        if (file->identifiers == NULL)
+        {
+            file->identifiers = out.identifiers;
+        }
+    }
+    file->identifier_count = count;
+}
+
+typedef struct ScanJob
+{
+    CodeFile** files;
+} ScanJob;
+
+static void ScanRange(void* context, int begin, int end)
+{
+    ScanJob* job = (ScanJob*)context;
+    int i;
+
+    for (i = begin; i < end; i++)
+    {
+        ScanFile(job->files[i]);
+    }
+}
+
+/*
+ * Scanning the project
+ */
+
+typedef struct ScanState
+{
+    CodeFile** files;
+    int count;
+    int capacity;
+} ScanState;
+
+int SymbolsAffectedBy(const char* path)
+{
+    size_t length = strlen(path);
+    return length > 3 && mg_strcasecmp(mg_str(path + length - 3), mg_str(".cs")) == 0;
+}
+
+static int CollectFile(void* context, const char* path, uint64_t size, int64_t modified)
+{
+    ScanState* state = (ScanState*)context;
+    CodeFile* file;
+
+    if (!SymbolsAffectedBy(path) || size > SYMBOLS_MAX_FILE_SIZE)
+    {
+        return 1;
+    }
+    if (state->count == state->capacity)
+    {
+        int capacity = state->capacity > 0 ? state->capacity * 2 : 4096;
+        CodeFile** grown = (CodeFile**)realloc(state->files, (size_t)capacity * sizeof(CodeFile*));
+        if (grown == NULL)
+        {
+            return 0;
+        }
+        state->files = grown;
+        state->capacity = capacity;
+    }
+    file = (CodeFile*)calloc(1, sizeof(CodeFile));
+    if (file == NULL || (file->path = (char*)malloc(strlen(path) + 1)) == NULL)
+    {
+        free(file);
+        return 0;
+    }
+    memcpy(file->path, path, strlen(path) + 1);
+    file->references = 1;
+    file->size = size;
+    file->modified = modified;
+    state->files[state->count++] = file;
+    return 1;
+}
+
+static int CompareFilePaths(const void* a, const void* b)
+{
+    return strcmp((*(CodeFile* const*)a)->path, (*(CodeFile* const*)b)->path);
+}
+
+static CodeFile* FindFile(const SymbolIndex* index, const char* path)
+{
+    int low = 0;
+    int high = index->file_count - 1;
+
+    while (low <= high)
+    {
+        int middle = low + (high - low) / 2;
+        int order = strcmp(index->files[middle]->path, path);
+        if (order == 0)
+        {
+            return index->files[middle];
+        }
+        if (order < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    return NULL;
+}
+
+static const char* EntryName(const SymbolIndex* index, const SymbolEntry* entry)
+{
+    const CodeFile* file = index->files[entry->file];
+    return SymbolName(file, &file->symbols[entry->symbol]);
+}
+
+static int CompareEntries(const void* a, const void* b)
+{
+    const SymbolEntry* x = (const SymbolEntry*)a;
+    const SymbolEntry* y = (const SymbolEntry*)b;
+    int order = FoldCompare(EntryName(s_sort_index, x), EntryName(s_sort_index, y));
+
+    if (order != 0)
+    {
+        return order;
+    }
+    if (x->file != y->file)
+    {
+        return x->file < y->file ? -1 : 1;
+    }
+    return x->symbol < y->symbol ? -1 : x->symbol > y->symbol ? 1 : 0;
+}
+
+static int BuildEntries(SymbolIndex* index)
+{
+    size_t total = 0;
+    int i;
+    uint32_t k;
+
+    for (i = 0; i < index->file_count; i++)
+    {
+        total += index->files[i]->symbol_count;
+    }
+    if ((index->entries = (SymbolEntry*)malloc((total > 0 ? total : 1) * sizeof(SymbolEntry))) == NULL)
+    {
+        return 0;
+    }
+    for (i = 0; i < index->file_count; i++)
+    {
+        for (k = 0; k < index->files[i]->symbol_count; k++)
+        {
+            index->entries[index->entry_count].file = (uint32_t)i;
+            index->entries[index->entry_count].symbol = k;
+            index->entry_count++;
+        }
+    }
+    s_sort_index = index;
+    qsort(index->entries, index->entry_count, sizeof(SymbolEntry), CompareEntries);
+    s_sort_index = NULL;
+    return 1;
+}
+
+/*
+ * Walk the project and build a new index, reusing unchanged files of the
+ * previous one. Returns NULL if no root is configured or out of memory.
+ */
+static SymbolIndex* BuildIndex(SymbolIndex* previous)
+{
+    char root[PROJECT_MAX_PATH];
+    ScanState scan;
+    ScanJob job;
+    SymbolIndex* index;
+    uint64_t started = mg_millis();
+    unsigned generation = ProjectRoot(root, sizeof(root));
+    int scan_count = 0;
+    int i;
+
+    memset(&scan, 0, sizeof(scan));
+    if (generation == 0 || ProjectWalk(CollectFile, &scan) < 0)
+    {
+        free(scan.files);
+        return NULL;
+    }
+    if (scan.count > 0)
+    {
+        qsort(scan.files, (size_t)scan.count, sizeof(CodeFile*), CompareFilePaths);
+    }
+
+    /* Take over the symbols of files that did not change */
+    job.files = (CodeFile**)malloc((size_t)(scan.count > 0 ? scan.count : 1) * sizeof(CodeFile*));
+    for (i = 0; i < scan.count && job.files != NULL; i++)
+    {
+        CodeFile* file = scan.files[i];
+        CodeFile* old = previous != NULL && previous->generation == generation
+            ? FindFile(previous, file->path) : NULL;
+        if (old != NULL && old->size == file->size && old->modified == file->modified)
+        {
+            PROXY_MUTEX_LOCK(&s_symbols_lock);
+            old->references++;
+            PROXY_MUTEX_UNLOCK(&s_symbols_lock);
+            ReleaseFile(file);
+            scan.files[i] = old;
+        }
+        else
+        {
+            job.files[scan_count++] = file;
+        }
+    }
+    if (job.files != NULL)
+    {
+        WorkerParallelFor(scan_count, 8, ScanRange, &job);
+    }
+    free(job.files);
+
+    index = (SymbolIndex*)calloc(1, sizeof(SymbolIndex));
+    if (index == NULL)
+    {
+        for (i = 0; i < scan.count; i++)
+        {
+            ReleaseFile(scan.files[i]);
+        }
+        free(scan.files);
+        return NULL;
+    }
+    index->references = 1;
+    index->generation = generation;
+    index->files = scan.files;
+    index->file_count = scan.count;
+    if (!BuildEntries(index))
+    {
+        ReleaseIndex(index);
+        return NULL;
+    }
+    index->built_at = mg_millis();
+    index->build_ms = index->built_at - started;
+    return index;
+}
+
+static void RebuildTask(void* context)
+{
+    (void)context;
+    for (;;)
+    {
+        SymbolIndex* previous = AcquireIndex();
+        SymbolIndex* index = BuildIndex(previous);
+        SymbolIndex* replaced = NULL;
+        int again;
+
+        PROXY_MUTEX_LOCK(&s_symbols_lock);
+        if (index != NULL)
+        {
+            replaced = s_symbols_index;
+            s_symbols_index = index;
+        }
+        again = s_symbols_again;
+        s_symbols_again = 0;
+        if (!again)
+        {
+            s_symbols_running = 0;
+        }
+        PROXY_MUTEX_UNLOCK(&s_symbols_lock);
+
+        ReleaseIndex(replaced);
+        ReleaseIndex(previous);
+        if (!again)
+        {
+            return;
+        }
+    }
+}
+
+/*
+ * Start a scan unless one is running; `again` schedules another one after it.
+ */
+static void StartScan(int again)
+{
+    int start;
+
+    PROXY_MUTEX_LOCK(&s_symbols_lock);
+    start = !s_symbols_running;
+    if (start)
+    {
+        s_symbols_running = 1;
+    }
+    else if (again)
+    {
+        s_symbols_again = 1;
+    }
+    PROXY_MUTEX_UNLOCK(&s_symbols_lock);
+
+    if (start && !WorkerSubmit(RebuildTask, NULL))
+    {
+        PROXY_MUTEX_LOCK(&s_symbols_lock);
+        s_symbols_running = 0;
+        PROXY_MUTEX_UNLOCK(&s_symbols_lock);
+    }
+}
+
+void SymbolsRefresh(void)
+{
+    StartScan(1);
+}
+
+/*
+ * Get symbol index statistics as a JSON object.
+ */
+EXPORT const char* GetSymbolIndexStats(void)
+{
+    SymbolIndex* index = AcquireIndex();
+    int running;
+
+    PROXY_MUTEX_LOCK(&s_symbols_lock);
+    running = s_symbols_running;
+    PROXY_MUTEX_UNLOCK(&s_symbols_lock);
+
+    if (index == NULL)
+    {
+        snprintf(s_symbols_stats_buffer, sizeof(s_symbols_stats_buffer),
+            "{\"ready\":false,\"scanning\":%s}", running ? "true" : "false");
+        return s_symbols_stats_buffer;
+    }
+    snprintf(s_symbols_stats_buffer, sizeof(s_symbols_stats_buffer),
+        "{\"ready\":true,\"scanning\":%s,\"files\":%d,\"symbols\":%lu,\"build_ms\":%lu,\"age_ms\":%lu}",
+        running ? "true" : "false", index->file_count, (unsigned long)index->entry_count,
+        (unsigned long)index->build_ms, (unsigned long)(mg_millis() - index->built_at));
+    ReleaseIndex(index);
+    return s_symbols_stats_buffer;
+}
+
+/*
+ * Queries
+ */
+
+/*
+ * The index for the configured root, or NULL with an error set.
+ */
+static SymbolIndex* AcquireCurrentIndex(const char** error)
+{
+    char root[PROJECT_MAX_PATH];
+    SymbolIndex* index = AcquireIndex();
+    unsigned generation = ProjectRoot(root, sizeof(root));
+
+    if (index == NULL)
+    {
+        StartScan(0);
+    }
+    /* An index of another root or exclude set would answer for the wrong files */
+    if (index != NULL && index->generation != generation)
+    {
+        ReleaseIndex(index);
+        index = NULL;
+    }
+    if (index == NULL)
+    {
+        *error = generation == 0 ? "Project root not configured" : "Symbol index is being built; retry shortly";
+    }
+    return index;
+}
+
+static long GetMaxResults(struct mg_str request)
+{
+    long max_results = mg_json_get_long(request, "$.params.max_results", SYMBOLS_DEFAULT_RESULTS);
+    return max_results < 1 ? 1 : max_results > SYMBOLS_MAX_RESULTS ? SYMBOLS_MAX_RESULTS : max_results;
+}
+
+/*
+ * The "kind" param: -1 if absent, KIND_COUNT if unknown.
+ */
+static int GetKindParam(struct mg_str request)
+{
+    char* value = mg_json_get_str(request, "$.params.kind");
+    int kind;
+
+    if (value == NULL)
+    {
+        return -1;
+    }
+    for (kind = 0; kind < KIND_COUNT && strcmp(value, KIND_NAMES[kind]) != 0; kind++)
+    {
+    }
+    mg_free(value);
+    return kind;
+}
+
+/*
+ * The "path" param with '/' separators and no trailing one, or NULL.
+ */
+static char* GetPathParam(struct mg_str request)
+{
+    char* value = mg_json_get_str(request, "$.params.path");
+    size_t length;
+    char* p;
+
+    if (value == NULL)
+    {
+        return NULL;
+    }
+    for (p = value; *p != '\0'; p++)
+    {
+        if (*p == '\\')
+        {
+            *p = '/';
+        }
+    }
+    length = strlen(value);
+    while (length > 0 && value[length - 1] == '/')
+    {
+        value[--length] = '\0';
+    }
+    return value;
+}
+
+/*
+ * True if a file is the path, or under it.
+ */
+static int PathMatches(const char* file, const char* path)
+{
+    size_t length;
+
+    if (path == NULL)
+    {
+        return 1;
+    }
+    length = strlen(path);
+    return strncmp(file, path, length) == 0 && (file[length] == '\0' || file[length] == '/' || length == 0);
+}
+
+/*
+ * The dotted names of the enclosing namespaces and types, or 0 at the top.
+ */
+static size_t FormatContainer(const CodeFile* file, uint32_t parent, char* buffer, size_t capacity)
+{
+    size_t length = 0;
+    const char* name;
+    size_t name_length;
+
+    if (parent == SYMBOL_NONE)
+    {
+        return 0;
+    }
+    length = FormatContainer(file, file->symbols[parent].parent, buffer, capacity);
+    name = SymbolName(file, &file->symbols[parent]);
+    name_length = strlen(name);
+    if (length + name_length + 2 > capacity)
+    {
+        return length;
+    }
+    if (length > 0)
+    {
+        buffer[length++] = '.';
+    }
+    memcpy(buffer + length, name, name_length);
+    length += name_length;
+    buffer[length] = '\0';
+    return length;
+}
+
+static void AppendSymbol(struct mg_iobuf* out, const CodeFile* file, const CodeSymbol* symbol)
+{
+    char container[PROJECT_MAX_PATH];
+    char number[96];
+    const char* name = SymbolName(file, symbol);
+    size_t length;
+    size_t k;
+    int first = 1;
+
+    mg_iobuf_add(out, out->len, "{\"name\":", 8);
+    JsonAppendString(out, name, strlen(name));
+    mg_iobuf_add(out, out->len, ",\"kind\":\"", 9);
+    mg_iobuf_add(out, out->len, KIND_NAMES[symbol->kind], strlen(KIND_NAMES[symbol->kind]));
+    mg_iobuf_add(out, out->len, "\",\"container\":", 14);
+    if ((length = FormatContainer(file, symbol->parent, container, sizeof(container))) > 0)
+    {
+        JsonAppendString(out, container, length);
+    }
+    else
+    {
+        mg_iobuf_add(out, out->len, "null", 4);
+    }
+    mg_iobuf_add(out, out->len, ",\"path\":", 8);
+    JsonAppendString(out, file->path, strlen(file->path));
+    length = (size_t)snprintf(number, sizeof(number), ",\"line\":%lu,\"end_line\":%lu,\"modifiers\":[",
+        (unsigned long)symbol->line, (unsigned long)symbol->end_line);
+    mg_iobuf_add(out, out->len, number, length);
+    for (k = 0; k < MODIFIER_COUNT; k++)
+    {
+        if ((symbol->modifiers & (1u << k)) != 0)
+        {
+            mg_iobuf_add(out, out->len, first ? "\"" : ",\"", first ? 1 : 2);
+            mg_iobuf_add(out, out->len, MODIFIER_NAMES[k], strlen(MODIFIER_NAMES[k]));
+            mg_iobuf_add(out, out->len, "\"", 1);
+            first = 0;
+        }
+    }
+    mg_iobuf_add(out, out->len, "],\"signature\":", 14);
+    if (symbol->signature != SYMBOL_NONE)
+    {
+        const char* signature = file->text + symbol->signature;
+        JsonAppendString(out, signature, strlen(signature));
+    }
+    else
+    {
+        mg_iobuf_add(out, out->len, "null", 4);
+    }
+    mg_iobuf_add(out, out->len, "}", 1);
+}
+
+/*
+ * First entry whose folded name is not below `name`.
+ */
+static size_t LowerBound(const SymbolIndex* index, const char* name)
+{
+    size_t low = 0;
+    size_t high = index->entry_count;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (FoldCompare(EntryName(index, &index->entries[middle]), name) < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+typedef struct SymbolOutput
+{
+    struct mg_iobuf* out;
+    long max_results;
+    long emitted;
+    int truncated;
+} SymbolOutput;
+
+/*
+ * Append a symbol unless the limit is reached. Returns 0 once it is.
+ */
+static int EmitSymbol(SymbolOutput* output, const CodeFile* file, const CodeSymbol* symbol)
+{
+    if (output->emitted >= output->max_results)
+    {
+        output->truncated = 1;
+        return 0;
+    }
+    if (output->emitted > 0)
+    {
+        mg_iobuf_add(output->out, output->out->len, ",", 1);
+    }
+    AppendSymbol(output->out, file, symbol);
+    output->emitted++;
+    return 1;
+}
+
+static void AppendSummary(struct mg_iobuf* out, const SymbolIndex* index, uint64_t started)
+{
+    char summary[160];
+    int length = snprintf(summary, sizeof(summary), ",\"files_indexed\":%d,\"index_age_ms\":%lu,\"elapsed_ms\":%lu}",
+        index->file_count, (unsigned long)(mg_millis() - index->built_at), (unsigned long)(mg_millis() - started));
+    mg_iobuf_add(out, out->len, summary, (size_t)length);
+}
+
+int CodeSymbolsMethod(struct mg_str request, struct mg_iobuf* result, const char** error)
+{
+    uint64_t started = mg_millis();
+    SymbolIndex* index;
+    SymbolOutput output;
+    char* query = mg_json_get_str(request, "$.params.query");
+    char* path = GetPathParam(request);
+    int kind = GetKindParam(request);
+    size_t query_length = query != NULL ? strlen(query) : 0;
+    size_t i;
+
+    if (kind == KIND_COUNT || (query_length == 0 && path == NULL))
+    {
+        *error = kind == KIND_COUNT ? "Unknown kind" : "query or path is required";
+        mg_free(query);
+        mg_free(path);
+        return -32602;
+    }
+    if ((index = AcquireCurrentIndex(error)) == NULL)
+    {
+        mg_free(query);
+        mg_free(path);
+        return PROJECT_ERROR_NOT_READY;
+    }
+
+    memset(&output, 0, sizeof(output));
+    output.out = result;
+    output.max_results = GetMaxResults(request);
+    mg_iobuf_add(result, result->len, "{\"symbols\":[", 12);
+
+    if (query_length == 0)
+    {
+        /* The outline of the files under the path */
+        int f;
+        for (f = 0; f < index->file_count && !output.truncated; f++)
+        {
+            const CodeFile* file = index->files[f];
+            uint32_t k;
+            if (!PathMatches(file->path, path))
+            {
+                continue;
+            }
+            for (k = 0; k < file->symbol_count; k++)
+            {
+                if ((kind < 0 || file->symbols[k].kind == kind) && !EmitSymbol(&output, file, &file->symbols[k]))
+                {
+                    break;
+                }
+            }
+        }
+    }
+    else
+    {
+        /* Exact matches and prefixes are one range of the name array, in that order */
+        size_t begin = LowerBound(index, query);
+        size_t end = begin;
+
+        for (; end < index->entry_count && FoldPrefix(EntryName(index, &index->entries[end]), query, query_length);
+             end++)
+        {
+            const SymbolEntry* entry = &index->entries[end];
+            const CodeFile* file = index->files[entry->file];
+            const CodeSymbol* symbol = &file->symbols[entry->symbol];
+            if ((kind < 0 || symbol->kind == kind) && PathMatches(file->path, path) &&
+                !EmitSymbol(&output, file, symbol))
+            {
+                break;
+            }
+        }
+        /* Then other substrings, skipping that range */
+        for (i = 0; i < index->entry_count && !output.truncated; i++)
+        {
+            const SymbolEntry* entry = &index->entries[i];
+            const CodeFile* file = index->files[entry->file];
+            const CodeSymbol* symbol = &file->symbols[entry->symbol];
+            if (i >= begin && i < end)
+            {
+                continue;
+            }
+            if ((kind < 0 || symbol->kind == kind) && PathMatches(file->path, path) &&
+                ContainsFolded(SymbolName(file, symbol) + 1, query, query_length))
+            {
+                EmitSymbol(&output, file, symbol);
+            }
+        }
+    }
+
+    mg_iobuf_add(result, result->len, output.truncated ? "],\"truncated\":true" : "],\"truncated\":false",
+        output.truncated ? 18 : 19);
+    AppendSummary(result, index, started);
+    ReleaseIndex(index);
+    mg_free(query);
+    mg_free(path);
+    return 0;
+}
+
+/*
+ * True if the symbol's container ends with the qualifier ("Game.Player"
+ * for "Game.Player.Damage"), on a segment boundary.
+ */
+static int QualifierMatches(const CodeFile* file, const CodeSymbol* symbol, const char* qualifier, size_t length)
+{
+    char container[PROJECT_MAX_PATH];
+    size_t container_length;
+
+    if (length == 0)
+    {
+        return 1;
+    }
+    container_length = FormatContainer(file, symbol->parent, container, sizeof(container));
+    return container_length >= length &&
+        memcmp(container + container_length - length, qualifier, length) == 0 &&
+        (container_length == length || container[container_length - length - 1] == '.');
+}
+
+/*
+ * List the lines of the indexed files that use an identifier, narrowed to
+ * the files holding its hash. Returns 1 if the limit cut the list short.
+ */
+static int AppendUsages(struct mg_iobuf* out, const SymbolIndex* index, const char* name, long max_results)
+{
+    uint32_t hash = IdentifierHash(name, strlen(name));
+    size_t name_length = strlen(name);
+    long emitted = 0;
+    int f;
+
+    for (f = 0; f < index->file_count; f++)
+    {
+        const CodeFile* file = index->files[f];
+        ProjectMapping mapping;
+        Lexer lexer;
+        CodeToken token;
+        uint32_t last_line = 0;
+
+        if (file->identifier_count == 0 ||
+            bsearch(&hash, file->identifiers, file->identifier_count, sizeof(uint32_t), CompareHashes) == NULL ||
+            !ProjectMapFile(file->path, SYMBOLS_MAX_FILE_SIZE, &mapping))
+        {
+            continue;
+        }
+        memset(&lexer, 0, sizeof(lexer));
+        lexer.p = mapping.data;
+        lexer.end = mapping.data + mapping.length;
+        lexer.line = 1;
+        lexer.line_start = 1;
+        for (NextToken(&lexer, &token); token.kind != TOKEN_END; NextToken(&lexer, &token))
+        {
+            const char* line_start;
+            const char* line_end;
+            char number[48];
+            int length;
+
+            if (token.kind != TOKEN_IDENT || token.length != name_length ||
+                memcmp(token.text, name, name_length) != 0 || token.line == last_line)
+            {
+                continue;
+            }
+            if (emitted >= max_results)
+            {
+                ProjectUnmapFile(&mapping);
+                return 1;
+            }
+            last_line = token.line;
+
+            /* The line, trimmed */
+            for (line_start = token.text; line_start > mapping.data && line_start[-1] != '\n'; line_start--)
+            {
+            }
+            for (line_end = token.text; line_end < lexer.end && *line_end != '\n'; line_end++)
+            {
+            }
+            while (line_start < line_end && (*line_start == ' ' || *line_start == '\t'))
+            {
+                line_start++;
+            }
+            while (line_end > line_start && (line_end[-1] == ' ' || line_end[-1] == '\t' || line_end[-1] == '\r'))
+            {
+                line_end--;
+            }
+            if (line_end - line_start > MAX_USAGE_TEXT)
+            {
+                line_end = line_start + MAX_USAGE_TEXT;
+            }
+
+            mg_iobuf_add(out, out->len, emitted > 0 ? ",{\"path\":" : "{\"path\":", emitted > 0 ? 9 : 8);
+            JsonAppendString(out, file->path, strlen(file->path));
+            length = snprintf(number, sizeof(number), ",\"line\":%lu,\"text\":", (unsigned long)token.line);
+            mg_iobuf_add(out, out->len, number, (size_t)length);
+            JsonAppendString(out, line_start, (size_t)(line_end - line_start));
+            mg_iobuf_add(out, out->len, "}", 1);
+            emitted++;
+        }
+        ProjectUnmapFile(&mapping);
+    }
+    return 0;
+}
+
+int CodeDefinitionMethod(struct mg_str request, struct mg_iobuf* result, const char** error)
+{
+    uint64_t started = mg_millis();
+    SymbolIndex* index;
+    char* name = mg_json_get_str(request, "$.params.name");
+    int kind = GetKindParam(request);
+    bool usages = false;
+    const char* simple;
+    size_t qualifier_length;
+    size_t begin;
+    size_t i;
+    int pass;
+    int found = 0;
+
+    if (name == NULL || name[0] == '\0' || kind == KIND_COUNT)
+    {
+        *error = kind == KIND_COUNT ? "Unknown kind" : "name is required";
+        mg_free(name);
+        return -32602;
+    }
+    if ((index = AcquireCurrentIndex(error)) == NULL)
+    {
+        mg_free(name);
+        return PROJECT_ERROR_NOT_READY;
+    }
+    mg_json_get_bool(request, "$.params.usages", &usages);
+    simple = strrchr(name, '.') != NULL ? strrchr(name, '.') + 1 : name;
+    qualifier_length = simple > name ? (size_t)(simple - name - 1) : 0;
+
+    mg_iobuf_add(result, result->len, "{\"name\":", 8);
+    JsonAppendString(result, name, strlen(name));
+    mg_iobuf_add(result, result->len, ",\"definitions\":[", 16);
+
+    /* Case-sensitive first; case-insensitive if that finds nothing */
+    begin = LowerBound(index, simple);
+    for (pass = 0; pass < 2 && found == 0; pass++)
+    {
+        for (i = begin; i < index->entry_count && FoldCompare(EntryName(index, &index->entries[i]), simple) == 0; i++)
+        {
+            const SymbolEntry* entry = &index->entries[i];
+            const CodeFile* file = index->files[entry->file];
+            const CodeSymbol* symbol = &file->symbols[entry->symbol];
+            if ((pass == 0 && strcmp(SymbolName(file, symbol), simple) != 0) ||
+                (kind >= 0 && symbol->kind != kind) ||
+                !QualifierMatches(file, symbol, name, qualifier_length))
+            {
+                continue;
+            }
+            if (found++ > 0)
+            {
+                mg_iobuf_add(result, result->len, ",", 1);
+            }
+            AppendSymbol(result, file, symbol);
+        }
+    }
+    mg_iobuf_add(result, result->len, "]", 1);
+
+    if (usages)
+    {
+        int truncated;
+        mg_iobuf_add(result, result->len, ",\"usages\":[", 11);
+        truncated = AppendUsages(result, index, simple, GetMaxResults(request));
+        mg_iobuf_add(result, result->len, truncated ? "],\"usages_truncated\":true" : "],\"usages_truncated\":false",
+            truncated ? 25 : 26);
+    }
+    AppendSummary(result, index, started);
+    ReleaseIndex(index);
+    mg_free(name);
+    return 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * UnixxtyMCP Proxy - C# symbol index
+ *
+ * Answers code-structure questions ("where is PlayerController defined",
+ * "what does this file declare", "who mentions TakeDamage") on the server
+ * thread from the project's .cs files, without reflection, so they work on
+ * code that does not compile and while the domain reloads. Every .cs file
+ * under Assets/ and the packages is tokenized (comments, strings including
+ * verbatim, interpolated and raw ones, and preprocessor lines are skipped)
+ * and its declarations recorded: namespaces, types, members and enum
+ * members, with their container, modifiers, header text and line span.
+ * Method and property bodies are skipped unread, so local functions are not
+ * listed; preprocessor branches are all read, as the compiler's defines are
+ * not known here. Each file also keeps the hashes of the identifiers it
+ * uses, which narrows a usage search to the files that can match.
+ *
+ * Like the reference index, it is built on the worker pool and refreshed
+ * after every batch of .cs changes from the file watcher (see watcher.h);
+ * files whose size and modification time are unchanged keep their symbols.
+ * Names are held in one array sorted case-insensitively, so a lookup is a
+ * binary search.
+ *
+ * "code/symbols" - declarations by name, or the outline of files
+ *   query        Case-insensitive name; exact matches come first, then
+ *                prefixes, then other substrings
+ *   kind         Only this kind (see below)
+ *   path         Only files at or under this project-relative path; alone,
+ *                lists their declarations in file order
+ *   max_results  Default SYMBOLS_DEFAULT_RESULTS, at most SYMBOLS_MAX_RESULTS
+ * Result: {"symbols":[symbol], "truncated", "files_indexed",
+ * "index_age_ms", "elapsed_ms"}.
+ *
+ * "code/definition" - where a name is declared
+ *   name         Simple or qualified name ("Damage", "Player.Damage",
+ *                "Game.Combat.Player"); case-sensitive unless nothing
+ *                matches that way
+ *   kind         As above
+ *   usages       Also list the lines using the name (default false)
+ *   max_results  Usages listed, as above
+ * Result: {"name", "definitions":[symbol], "usages":[{"path", "line",
+ * "text"}], "usages_truncated", "files_indexed", "index_age_ms",
+ * "elapsed_ms"}; a partial type has one definition per part. Usages are
+ * identifier tokens with the name's last segment, declarations included.
+ *
+ * A symbol is {"name", "kind", "container", "path", "line", "end_line",
+ * "modifiers":[...], "signature"}: kind one of namespace, class, struct,
+ * interface, enum, record, delegate, method, constructor, property,
+ * indexer, event, field, operator, enum_member; container the dotted names
+ * of the enclosing namespaces and types (null at the top); signature the
+ * declaration up to its body, whitespace collapsed. Lines are 1-based.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_SYMBOLS_H
+#define UNITY_MCP_SYMBOLS_H
+
+#include "mongoose.h"
+
+#define SYMBOLS_MAX_FILE_SIZE (16u * 1024u * 1024u)
+#define SYMBOLS_MAX_SIGNATURE 256      /* Bytes of header text kept per declaration */
+#define SYMBOLS_MAX_DEPTH 64           /* Nested namespaces and types read */
+#define SYMBOLS_DEFAULT_RESULTS 200
+#define SYMBOLS_MAX_RESULTS 5000
+
+/*
+ * Start a background rescan of the .cs files, or schedule another one
+ * after the scan in progress.
+ */
+void SymbolsRefresh(void);
+
+/*
+ * True if a change to this project-relative path can change the index.
+ */
+int SymbolsAffectedBy(const char* path);
+
+/*
+ * The "code/symbols" and "code/definition" methods (ProjectMethods, see
+ * project.h).
+ */
+int CodeSymbolsMethod(struct mg_str request, struct mg_iobuf* result, const char** error);
+int CodeDefinitionMethod(struct mg_str request, struct mg_iobuf* result, const char** error);
+
+#endif /* UNITY_MCP_SYMBOLS_H */
@@ -0,0 +1,348 @@
+/*
+ * UnixxtyMCP Proxy - Texture pixel kernels
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "texture.h"
+#include "image.h"
+#include "platform.h"
+#include "workers.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define TEXTURE_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+/* Scales a half's exponent and mantissa, shifted into a float, to its value */
+#define HALF_EXPONENT_SCALE 0x77800000u     /* 2^112 */
+
+typedef struct TextureKernel
+{
+    const unsigned char* source;
+    unsigned char* target;
+    const uint16_t* half_source;
+    uint16_t* half_target;
+    const unsigned char* sources[4];
+    int channels[4];
+    const uint16_t* table;
+    unsigned int* histogram;
+} TextureKernel;
+
+static ProxyMutex s_histogram_lock = PROXY_MUTEX_INITIALIZER;
+
+static float FloatFromBits(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static unsigned char HalfToByte(uint16_t half)
+{
+    /* Negative values (and -0) clamp to 0; infinities and NaNs come out huge and clamp to 1 */
+    float value = FloatFromBits((uint32_t)(half & 0x7fff) << 13) * FloatFromBits(HALF_EXPONENT_SCALE);
+    if (half & 0x8000) value = 0.0f;
+    if (value > 1.0f) value = 1.0f;
+    return (unsigned char)(int)(value * 255.0f + 0.5f);
+}
+
+/*
+ * Nearest half of a value in [0, 1], ties to even.
+ */
+static uint16_t HalfFromUnit(float value)
+{
+    uint32_t bits, mantissa, result, rest;
+    int exponent;
+
+    if (value <= 0.0f)
+    {
+        return 0;
+    }
+    memcpy(&bits, &value, sizeof(bits));
+    exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+    mantissa = bits & 0x7fffff;
+    if (exponent <= 0)
+    {
+        /* Below the smallest normal half; no v / 255 gets here */
+        return 0;
+    }
+    result = ((uint32_t)exponent << 10) | (mantissa >> 13);
+    rest = mantissa & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (result & 1)))
+    {
+        result++;      /* A carry into the exponent is still the right value */
+    }
+    return (uint16_t)result;
+}
+
+static void ConvertHalfChunk(void* context, int begin, int end)
+{
+    const TextureKernel* kernel = (const TextureKernel*)context;
+    const uint16_t* source = kernel->half_source + (size_t)begin * 4;
+    unsigned char* target = kernel->target + (size_t)begin * 4;
+    size_t count = (size_t)(end - begin) * 4;
+    size_t i = 0;
+#ifdef TEXTURE_SSE2
+    __m128i zero = _mm_setzero_si128();
+    __m128i magnitude = _mm_set1_epi32(0x7fff);
+    __m128i sign = _mm_set1_epi32(0x8000);
+    __m128 scale = _mm_castsi128_ps(_mm_set1_epi32((int)HALF_EXPONENT_SCALE));
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 bytes = _mm_set1_ps(255.0f);
+    __m128 round = _mm_set1_ps(0.5f);
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i low = _mm_loadu_si128((const __m128i*)(source + i));
+        __m128i high = _mm_loadu_si128((const __m128i*)(source + i + 8));
+        __m128i halves[4];
+        __m128i values[4];
+        int k;
+
+        halves[0] = _mm_unpacklo_epi16(low, zero);
+        halves[1] = _mm_unpackhi_epi16(low, zero);
+        halves[2] = _mm_unpacklo_epi16(high, zero);
+        halves[3] = _mm_unpackhi_epi16(high, zero);
+        for (k = 0; k < 4; k++)
+        {
+            __m128 value = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(halves[k], magnitude), 13)), scale);
+            __m128i negative = _mm_cmpeq_epi32(_mm_and_si128(halves[k], sign), sign);
+            value = _mm_andnot_ps(_mm_castsi128_ps(negative), _mm_min_ps(value, one));
+            values[k] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, bytes), round));
+        }
+        _mm_storeu_si128((__m128i*)(target + i),
+            _mm_packus_epi16(_mm_packs_epi32(values[0], values[1]), _mm_packs_epi32(values[2], values[3])));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        target[i] = HalfToByte(source[i]);
+    }
+}
+
+static void ConvertByteChunk(void* context, int begin, int end)
+{
+    const TextureKernel* kernel = (const TextureKernel*)context;
+    const unsigned char* source = kernel->source + (size_t)begin * 4;
+    uint16_t* target = kernel->half_target + (size_t)begin * 4;
+    size_t count = (size_t)(end - begin) * 4;
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        target[i] = kernel->table[source[i]];
+    }
+}
+
+static void PackChunk(void* context, int begin, int end)
+{
+    const TextureKernel* kernel = (const TextureKernel*)context;
+    unsigned char* target = kernel->target + (size_t)begin * 4;
+    size_t count = (size_t)(end - begin);
+    int c;
+    for (c = 0; c < 4; c++)
+    {
+        size_t i;
+        if (kernel->sources[c] == NULL)
+        {
+            unsigned char constant = (unsigned char)kernel->channels[c];
+            for (i = 0; i < count; i++)
+            {
+                target[i * 4 + c] = constant;
+            }
+        }
+        else
+        {
+            const unsigned char* source = kernel->sources[c] + (size_t)begin * 4 + kernel->channels[c];
+            for (i = 0; i < count; i++)
+            {
+                target[i * 4 + c] = source[i * 4];
+            }
+        }
+    }
+}
+
+/*
+ * round(value * alpha / 255) without a division.
+ */
+static unsigned char MultiplyAlpha(unsigned int value, unsigned int alpha)
+{
+    unsigned int product = value * alpha + 128;
+    return (unsigned char)((product + (product >> 8)) >> 8);
+}
+
+static void PremultiplyChunk(void* context, int begin, int end)
+{
+    const TextureKernel* kernel = (const TextureKernel*)context;
+    unsigned char* pixels = kernel->target + (size_t)begin * 4;
+    size_t count = (size_t)(end - begin);
+    size_t i = 0;
+#ifdef TEXTURE_SSE2
+    __m128i zero = _mm_setzero_si128();
+    __m128i keep_color = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    __m128i alpha_one = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    __m128i round = _mm_set1_epi16(128);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(pixels + i * 4));
+        __m128i halves[2];
+        int k;
+
+        halves[0] = _mm_unpacklo_epi8(block, zero);
+        halves[1] = _mm_unpackhi_epi8(block, zero);
+        for (k = 0; k < 2; k++)
+        {
+            /* Each pixel's alpha in its color lanes, 255 in its alpha lane */
+            __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(halves[k], 0xff), 0xff);
+            __m128i product;
+            alpha = _mm_or_si128(_mm_and_si128(alpha, keep_color), alpha_one);
+            product = _mm_add_epi16(_mm_mullo_epi16(halves[k], alpha), round);
+            halves[k] = _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+        }
+        _mm_storeu_si128((__m128i*)(pixels + i * 4), _mm_packus_epi16(halves[0], halves[1]));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        unsigned char* pixel = pixels + i * 4;
+        pixel[0] = MultiplyAlpha(pixel[0], pixel[3]);
+        pixel[1] = MultiplyAlpha(pixel[1], pixel[3]);
+        pixel[2] = MultiplyAlpha(pixel[2], pixel[3]);
+    }
+}
+
+static void HistogramChunk(void* context, int begin, int end)
+{
+    const TextureKernel* kernel = (const TextureKernel*)context;
+    const unsigned char* pixels = kernel->source + (size_t)begin * 4;
+    size_t count = (size_t)(end - begin);
+    unsigned int counts[4 * TEXTURE_HISTOGRAM_BINS];
+    size_t i;
+
+    memset(counts, 0, sizeof(counts));
+    for (i = 0; i < count; i++)
+    {
+        const unsigned char* pixel = pixels + i * 4;
+        counts[pixel[0]]++;
+        counts[TEXTURE_HISTOGRAM_BINS + pixel[1]]++;
+        counts[2 * TEXTURE_HISTOGRAM_BINS + pixel[2]]++;
+        counts[3 * TEXTURE_HISTOGRAM_BINS + pixel[3]]++;
+    }
+
+    PROXY_MUTEX_LOCK(&s_histogram_lock);
+    for (i = 0; i < 4 * TEXTURE_HISTOGRAM_BINS; i++)
+    {
+        kernel->histogram[i] += counts[i];
+    }
+    PROXY_MUTEX_UNLOCK(&s_histogram_lock);
+}
+
+EXPORT int TextureHalfToRgba8(const unsigned short* half, unsigned char* rgba, int pixel_count)
+{
+    TextureKernel kernel;
+
+    if (half == NULL || rgba == NULL || pixel_count <= 0)
+    {
+        return -1;
+    }
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.half_source = half;
+    kernel.target = rgba;
+    WorkerParallelFor(pixel_count, TEXTURE_CHUNK_PIXELS, ConvertHalfChunk, &kernel);
+    return 0;
+}
+
+EXPORT int TextureRgba8ToHalf(const unsigned char* rgba, unsigned short* half, int pixel_count)
+{
+    TextureKernel kernel;
+    uint16_t table[256];
+    int i;
+
+    if (rgba == NULL || half == NULL || pixel_count <= 0)
+    {
+        return -1;
+    }
+    for (i = 0; i < 256; i++)
+    {
+        table[i] = HalfFromUnit((float)i / 255.0f);
+    }
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.source = rgba;
+    kernel.half_target = half;
+    kernel.table = table;
+    WorkerParallelFor(pixel_count, TEXTURE_CHUNK_PIXELS, ConvertByteChunk, &kernel);
+    return 0;
+}
+
+EXPORT int TexturePackChannels(const unsigned char* red, const unsigned char* green, const unsigned char* blue,
+    const unsigned char* alpha, const int* channels, unsigned char* rgba, int pixel_count)
+{
+    TextureKernel kernel;
+    int c;
+
+    if (channels == NULL || rgba == NULL || pixel_count <= 0)
+    {
+        return -1;
+    }
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.sources[0] = red;
+    kernel.sources[1] = green;
+    kernel.sources[2] = blue;
+    kernel.sources[3] = alpha;
+    for (c = 0; c < 4; c++)
+    {
+        int limit = kernel.sources[c] != NULL ? TEXTURE_CHANNEL_ALPHA : 255;
+        if (channels[c] < 0 || channels[c] > limit)
+        {
+            return -1;
+        }
+        kernel.channels[c] = channels[c];
+    }
+    kernel.target = rgba;
+    WorkerParallelFor(pixel_count, TEXTURE_CHUNK_PIXELS, PackChunk, &kernel);
+    return 0;
+}
+
+EXPORT int TexturePremultiply(unsigned char* rgba, int pixel_count)
+{
+    TextureKernel kernel;
+
+    if (rgba == NULL || pixel_count <= 0)
+    {
+        return -1;
+    }
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.target = rgba;
+    WorkerParallelFor(pixel_count, TEXTURE_CHUNK_PIXELS, PremultiplyChunk, &kernel);
+    return 0;
+}
+
+EXPORT int TextureResize(const unsigned char* rgba, int width, int height, unsigned char* output,
+    int target_width, int target_height, int filter)
+{
+    if (rgba == NULL || output == NULL || width <= 0 || height <= 0 || target_width <= 0 || target_height <= 0 ||
+        (filter != IMAGE_FILTER_BOX && filter != IMAGE_FILTER_LANCZOS))
+    {
+        return -1;
+    }
+    return ImageResizeInto(rgba, width, height, output, target_width, target_height, filter) ? 0 : -1;
+}
+
+EXPORT int TextureHistogram(const unsigned char* rgba, int pixel_count, unsigned int* histogram)
+{
+    TextureKernel kernel;
+
+    if (rgba == NULL || histogram == NULL || pixel_count <= 0)
+    {
+        return -1;
+    }
+    memset(histogram, 0, sizeof(unsigned int) * 4 * TEXTURE_HISTOGRAM_BINS);
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.source = rgba;
+    kernel.histogram = histogram;
+    WorkerParallelFor(pixel_count, TEXTURE_CHUNK_PIXELS, HistogramChunk, &kernel);
+    return 0;
+}
@@ -0,0 +1,32 @@
+/*
+ * UnixxtyMCP Proxy - Texture pixel kernels
+ *
+ * Pixel work for manage_texture on raw texture data handed over by C#:
+ * RGBA8 <-> RGBAHalf conversion, channel packing, alpha premultiplication,
+ * resizing (image.c) and per-channel histograms. Every kernel splits its
+ * pixels into chunks of TEXTURE_CHUNK_PIXELS and runs them with
+ * WorkerParallelFor(), so a 4K texture is processed by all cores while the
+ * calling thread waits. Half conversion and premultiplication have SSE2
+ * kernels with matching scalar loops for other targets.
+ *
+ * RGBA8 data is four bytes per pixel, RGBAHalf four IEEE 754 binary16
+ * values; the row order does not matter to any kernel. Half values convert
+ * to 8 bits clamped to [0, 1] and rounded to nearest; 8-bit values convert
+ * to the nearest half of v / 255, so a round trip returns every byte.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_TEXTURE_H
+#define UNITY_MCP_TEXTURE_H
+
+#define TEXTURE_CHUNK_PIXELS 65536
+#define TEXTURE_HISTOGRAM_BINS 256
+
+/* Byte offsets of the channels in an RGBA8 pixel */
+#define TEXTURE_CHANNEL_RED 0
+#define TEXTURE_CHANNEL_GREEN 1
+#define TEXTURE_CHANNEL_BLUE 2
+#define TEXTURE_CHANNEL_ALPHA 3
+
+#endif /* UNITY_MCP_TEXTURE_H */
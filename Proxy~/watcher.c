@@ -0,0 +1,887 @@
+/*
+ * UnixxtyMCP Proxy - Project file watcher
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "proxy.h"
+#include "watcher.h"
+#include "project.h"
+#include "search.h"
+#include "assets.h"
+#include "references.h"
+#include "symbols.h"
+#include "jsonutil.h"
+#include "platform.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __linux__
+    #include <sys/inotify.h>
+    #include <poll.h>
+    #include <errno.h>
+#endif
+
+enum
+{
+    WATCH_CANCELLED = 0,             /* Added and deleted again within a batch */
+    WATCH_ADDED,
+    WATCH_MODIFIED,
+    WATCH_DELETED,
+    WATCH_RESET
+};
+
+static const char* const WATCH_KIND_NAMES[] = { "", "added", "modified", "deleted", "reset" };
+
+typedef struct WatchEntry
+{
+    int64_t sequence;
+    int kind;
+    int directory;
+    char* path;
+} WatchEntry;
+
+static ProxyMutex s_watch_lock = PROXY_MUTEX_INITIALIZER;
+static ProxyCondition s_watch_wake = PROXY_CONDITION_INITIALIZER;
+static WatchEntry s_watch_log[WATCH_LOG_CAPACITY];
+static int64_t s_watch_sequence = 0;          /* Latest change */
+static int64_t s_watch_reset = 0;             /* Latest reset; older cursors must rescan */
+static WatchMode s_watch_mode = WATCH_MODE_OFF;
+static unsigned s_watch_restarts = 0;
+static int s_watch_started = 0;
+static struct mg_iobuf s_watch_export = {0, 0, 0, 4096};
+
+static char* CopyString(const char* text)
+{
+    size_t length = strlen(text);
+    char* copy = (char*)malloc(length + 1);
+    if (copy != NULL)
+    {
+        memcpy(copy, text, length + 1);
+    }
+    return copy;
+}
+
+/*
+ * Change log
+ */
+
+/*
+ * Append one change. Caller holds the lock.
+ */
+static void AppendEntry(int kind, int directory, char* path)
+{
+    WatchEntry* entry;
+
+    s_watch_sequence++;
+    entry = &s_watch_log[s_watch_sequence % WATCH_LOG_CAPACITY];
+    free(entry->path);
+    entry->sequence = s_watch_sequence;
+    entry->kind = kind;
+    entry->directory = directory;
+    entry->path = path;
+}
+
+/*
+ * Record that changes were lost.
+ */
+static void AppendReset(void)
+{
+    PROXY_MUTEX_LOCK(&s_watch_lock);
+    AppendEntry(WATCH_RESET, 0, NULL);
+    s_watch_reset = s_watch_sequence;
+    PROXY_MUTEX_UNLOCK(&s_watch_lock);
+}
+
+static void SetMode(WatchMode mode)
+{
+    PROXY_MUTEX_LOCK(&s_watch_lock);
+    s_watch_mode = mode;
+    PROXY_MUTEX_UNLOCK(&s_watch_lock);
+}
+
+WatchMode WatcherMode(void)
+{
+    WatchMode mode;
+    PROXY_MUTEX_LOCK(&s_watch_lock);
+    mode = s_watch_mode;
+    PROXY_MUTEX_UNLOCK(&s_watch_lock);
+    return mode;
+}
+
+const char* WatcherModeName(WatchMode mode)
+{
+    return mode == WATCH_MODE_INOTIFY ? "inotify" : mode == WATCH_MODE_POLLING ? "polling" : "off";
+}
+
+int64_t WatcherCursor(void)
+{
+    int64_t cursor;
+    PROXY_MUTEX_LOCK(&s_watch_lock);
+    cursor = s_watch_sequence;
+    PROXY_MUTEX_UNLOCK(&s_watch_lock);
+    return cursor;
+}
+
+int64_t WatcherFormatChanges(int64_t cursor, struct mg_iobuf* out)
+{
+    char header[160];
+    int64_t latest;
+    int64_t last;
+    int64_t sequence;
+    int reset;
+    int first = 1;
+
+    PROXY_MUTEX_LOCK(&s_watch_lock);
+    latest = s_watch_sequence;
+    if (cursor < 0)
+    {
+        cursor = latest;
+    }
+    reset = cursor > latest || cursor < s_watch_reset || latest - cursor > WATCH_LOG_CAPACITY;
+    if (reset)
+    {
+        cursor = latest;
+    }
+    last = latest - cursor > WATCH_MAX_REPLY ? cursor + WATCH_MAX_REPLY : latest;
+
+    snprintf(header, sizeof(header), "{\"cursor\":%lld,\"reset\":%s,\"more\":%s,\"mode\":\"%s\",\"changes\":[",
+        (long long)last, reset ? "true" : "false", last < latest ? "true" : "false", WatcherModeName(s_watch_mode));
+    mg_iobuf_add(out, out->len, header, strlen(header));
+    for (sequence = cursor + 1; sequence <= last; sequence++)
+    {
+        const WatchEntry* entry = &s_watch_log[sequence % WATCH_LOG_CAPACITY];
+        if (entry->kind == WATCH_RESET || entry->path == NULL)
+        {
+            continue;
+        }
+        mg_iobuf_add(out, out->len, first ? "{\"path\":" : ",{\"path\":", first ? 8 : 9);
+        JsonAppendString(out, entry->path, strlen(entry->path));
+        mg_iobuf_add(out, out->len, ",\"kind\":\"", 9);
+        mg_iobuf_add(out, out->len, WATCH_KIND_NAMES[entry->kind], strlen(WATCH_KIND_NAMES[entry->kind]));
+        if (entry->directory)
+        {
+            mg_iobuf_add(out, out->len, "\",\"directory\":true}", 19);
+        }
+        else
+        {
+            mg_iobuf_add(out, out->len, "\"}", 2);
+        }
+        first = 0;
+    }
+    PROXY_MUTEX_UNLOCK(&s_watch_lock);
+    mg_iobuf_add(out, out->len, "]}", 2);
+    return last;
+}
+
+/*
+ * Get the file changes after a cursor.
+ */
+EXPORT const char* GetFileChanges(long long cursor)
+{
+    /* Callers are serialized (C# main thread), like the other static reply buffers */
+    s_watch_export.len = 0;
+    WatcherFormatChanges((int64_t)cursor, &s_watch_export);
+    mg_iobuf_add(&s_watch_export, s_watch_export.len, "", 1);
+    return s_watch_export.buf != NULL ? (const char*)s_watch_export.buf : "";
+}
+
+int FileChangesMethod(struct mg_str request, struct mg_iobuf* result, const char** error)
+{
+    char root[PROJECT_MAX_PATH];
+
+    if (ProjectRoot(root, sizeof(root)) == 0)
+    {
+        *error = "Project root not configured";
+        return PROJECT_ERROR_NOT_READY;
+    }
+    WatcherFormatChanges((int64_t)mg_json_get_long(request, "$.params.cursor", -1), result);
+    return 0;
+}
+
+/*
+ * Pending batch: changes seen since the last publish, one per path
+ */
+
+typedef struct PendingChange
+{
+    char* path;
+    int kind;
+    int directory;
+} PendingChange;
+
+typedef struct PendingBatch
+{
+    PendingChange* items;
+    int count;
+    int capacity;
+    uint32_t* slots;                 /* Open addressing; item index + 1, 0 when empty */
+    uint32_t slot_capacity;          /* Power of two, at least twice capacity */
+    uint64_t first_at;
+    uint64_t last_at;
+} PendingBatch;
+
+static uint32_t HashPath(const char* path)
+{
+    uint32_t hash = 2166136261u;
+    while (*path != '\0')
+    {
+        hash = (hash ^ (unsigned char)*path++) * 16777619u;
+    }
+    return hash;
+}
+
+/*
+ * Fold a new event into the kind already pending for its path.
+ */
+static int CombineKinds(int pending, int kind)
+{
+    switch (pending)
+    {
+        case WATCH_CANCELLED:
+            return kind == WATCH_DELETED ? WATCH_CANCELLED : WATCH_ADDED;
+        case WATCH_ADDED:
+            return kind == WATCH_DELETED ? WATCH_CANCELLED : WATCH_ADDED;
+        case WATCH_MODIFIED:
+            return kind == WATCH_DELETED ? WATCH_DELETED : WATCH_MODIFIED;
+        default:
+            return kind == WATCH_DELETED ? WATCH_DELETED : WATCH_MODIFIED;
+    }
+}
+
+static int GrowBatch(PendingBatch* batch)
+{
+    int capacity = batch->capacity > 0 ? batch->capacity * 2 : 256;
+    uint32_t slot_capacity = (uint32_t)capacity * 2;
+    PendingChange* items = (PendingChange*)realloc(batch->items, (size_t)capacity * sizeof(PendingChange));
+    uint32_t* slots;
+    int i;
+
+    if (items == NULL)
+    {
+        return 0;
+    }
+    batch->items = items;
+    if ((slots = (uint32_t*)calloc(slot_capacity, sizeof(uint32_t))) == NULL)
+    {
+        return 0;
+    }
+    for (i = 0; i < batch->count; i++)
+    {
+        uint32_t slot = HashPath(items[i].path) & (slot_capacity - 1);
+        while (slots[slot] != 0)
+        {
+            slot = (slot + 1) & (slot_capacity - 1);
+        }
+        slots[slot] = (uint32_t)i + 1;
+    }
+    free(batch->slots);
+    batch->slots = slots;
+    batch->slot_capacity = slot_capacity;
+    batch->capacity = capacity;
+    return 1;
+}
+
+static void QueueChange(PendingBatch* batch, const char* path, int kind, int directory)
+{
+    uint64_t now = mg_millis();
+    uint32_t slot;
+
+    if (batch->count == batch->capacity && !GrowBatch(batch))
+    {
+        return;
+    }
+    for (slot = HashPath(path) & (batch->slot_capacity - 1); batch->slots[slot] != 0;
+         slot = (slot + 1) & (batch->slot_capacity - 1))
+    {
+        PendingChange* item = &batch->items[batch->slots[slot] - 1];
+        if (strcmp(item->path, path) == 0)
+        {
+            item->kind = CombineKinds(item->kind, kind);
+            item->directory = directory;
+            batch->last_at = now;
+            return;
+        }
+    }
+    if ((batch->items[batch->count].path = CopyString(path)) == NULL)
+    {
+        return;
+    }
+    batch->items[batch->count].kind = kind;
+    batch->items[batch->count].directory = directory;
+    batch->slots[slot] = (uint32_t)++batch->count;
+    if (batch->count == 1)
+    {
+        batch->first_at = now;
+    }
+    batch->last_at = now;
+}
+
+static void ClearBatch(PendingBatch* batch)
+{
+    int i;
+    for (i = 0; i < batch->count; i++)
+    {
+        free(batch->items[i].path);
+    }
+    batch->count = 0;
+    if (batch->slots != NULL)
+    {
+        memset(batch->slots, 0, batch->slot_capacity * sizeof(uint32_t));
+    }
+}
+
+static void FreeBatch(PendingBatch* batch)
+{
+    ClearBatch(batch);
+    free(batch->items);
+    free(batch->slots);
+    memset(batch, 0, sizeof(*batch));
+}
+
+/*
+ * Move the pending changes to the log and let the indexes catch up.
+ */
+static void PublishBatch(PendingBatch* batch)
+{
+    int published = 0;
+    int assets = 0;
+    int references = 0;
+    int symbols = 0;
+    int i;
+
+    PROXY_MUTEX_LOCK(&s_watch_lock);
+    for (i = 0; i < batch->count; i++)
+    {
+        if (batch->items[i].kind != WATCH_CANCELLED)
+        {
+            assets |= batch->items[i].directory || AssetsAffectedBy(batch->items[i].path);
+            references |= batch->items[i].directory || ReferencesAffectedBy(batch->items[i].path);
+            symbols |= batch->items[i].directory || SymbolsAffectedBy(batch->items[i].path);
+            AppendEntry(batch->items[i].kind, batch->items[i].directory, batch->items[i].path);
+            batch->items[i].path = NULL;
+            published++;
+        }
+    }
+    PROXY_MUTEX_UNLOCK(&s_watch_lock);
+    ClearBatch(batch);
+
+    if (published > 0)
+    {
+        SearchRefresh();
+    }
+    if (assets)
+    {
+        AssetsRefresh();
+    }
+    if (references)
+    {
+        ReferencesRefresh();
+    }
+    if (symbols)
+    {
+        SymbolsRefresh();
+    }
+}
+
+static int RestartRequested(unsigned restarts)
+{
+    int requested;
+    PROXY_MUTEX_LOCK(&s_watch_lock);
+    requested = s_watch_restarts != restarts;
+    PROXY_MUTEX_UNLOCK(&s_watch_lock);
+    return requested;
+}
+
+/*
+ * Polling: walk the tree and compare it with the previous walk
+ */
+
+typedef struct SnapshotFile
+{
+    char* path;
+    uint64_t size;
+    int64_t modified;
+} SnapshotFile;
+
+typedef struct Snapshot
+{
+    SnapshotFile* files;
+    int count;
+    int capacity;
+    int failed;
+} Snapshot;
+
+static int AddSnapshotFile(void* context, const char* path, uint64_t size, int64_t modified)
+{
+    Snapshot* snapshot = (Snapshot*)context;
+
+    if (snapshot->count == snapshot->capacity)
+    {
+        int capacity = snapshot->capacity > 0 ? snapshot->capacity * 2 : 4096;
+        SnapshotFile* files = (SnapshotFile*)realloc(snapshot->files, (size_t)capacity * sizeof(SnapshotFile));
+        if (files == NULL)
+        {
+            snapshot->failed = 1;
+            return 0;
+        }
+        snapshot->files = files;
+        snapshot->capacity = capacity;
+    }
+    if ((snapshot->files[snapshot->count].path = CopyString(path)) == NULL)
+    {
+        snapshot->failed = 1;
+        return 0;
+    }
+    snapshot->files[snapshot->count].size = size;
+    snapshot->files[snapshot->count].modified = modified;
+    snapshot->count++;
+    return 1;
+}
+
+static int CompareSnapshotFiles(const void* a, const void* b)
+{
+    return strcmp(((const SnapshotFile*)a)->path, ((const SnapshotFile*)b)->path);
+}
+
+static void FreeSnapshot(Snapshot* snapshot)
+{
+    int i;
+    for (i = 0; i < snapshot->count; i++)
+    {
+        free(snapshot->files[i].path);
+    }
+    free(snapshot->files);
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+
+static int TakeSnapshot(Snapshot* snapshot)
+{
+    memset(snapshot, 0, sizeof(*snapshot));
+    if (ProjectWalk(AddSnapshotFile, snapshot) < 0 || snapshot->failed)
+    {
+        FreeSnapshot(snapshot);
+        return 0;
+    }
+    qsort(snapshot->files, (size_t)snapshot->count, sizeof(SnapshotFile), CompareSnapshotFiles);
+    return 1;
+}
+
+static void DiffSnapshots(const Snapshot* before, const Snapshot* after, PendingBatch* batch)
+{
+    int i = 0;
+    int j = 0;
+
+    while (i < before->count || j < after->count)
+    {
+        int order = i == before->count ? 1 : j == after->count ? -1
+            : strcmp(before->files[i].path, after->files[j].path);
+        if (order < 0)
+        {
+            QueueChange(batch, before->files[i++].path, WATCH_DELETED, 0);
+        }
+        else if (order > 0)
+        {
+            QueueChange(batch, after->files[j++].path, WATCH_ADDED, 0);
+        }
+        else
+        {
+            if (before->files[i].size != after->files[j].size ||
+                before->files[i].modified != after->files[j].modified)
+            {
+                QueueChange(batch, after->files[j].path, WATCH_MODIFIED, 0);
+            }
+            i++;
+            j++;
+        }
+    }
+}
+
+static void WatchByPolling(unsigned restarts)
+{
+    PendingBatch batch;
+    Snapshot snapshot;
+    int have_snapshot;
+
+    memset(&batch, 0, sizeof(batch));
+    SetMode(WATCH_MODE_POLLING);
+    have_snapshot = TakeSnapshot(&snapshot);
+    for (;;)
+    {
+        Snapshot next;
+
+        PROXY_MUTEX_LOCK(&s_watch_lock);
+        if (s_watch_restarts == restarts)
+        {
+            PROXY_CONDITION_WAIT_MS(&s_watch_wake, &s_watch_lock, WATCH_POLL_INTERVAL_MS);
+        }
+        PROXY_MUTEX_UNLOCK(&s_watch_lock);
+        if (RestartRequested(restarts))
+        {
+            break;
+        }
+        if (!TakeSnapshot(&next))
+        {
+            continue;
+        }
+        if (have_snapshot)
+        {
+            DiffSnapshots(&snapshot, &next, &batch);
+            PublishBatch(&batch);
+            FreeSnapshot(&snapshot);
+        }
+        snapshot = next;
+        have_snapshot = 1;
+    }
+    if (have_snapshot)
+    {
+        FreeSnapshot(&snapshot);
+    }
+    FreeBatch(&batch);
+}
+
+#ifdef __linux__
+
+/*
+ * inotify: one watch per folder, each mapped back to its project path
+ */
+
+#define WATCH_INOTIFY_MASK (IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM | \
+    IN_MOVED_TO | IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK)
+
+typedef struct InotifyState
+{
+    int fd;
+    char** folders;                  /* Project path of each watch descriptor */
+    int capacity;
+    int exhausted;                   /* Out of watches: fall back to polling */
+    PendingBatch* batch;
+} InotifyState;
+
+static int AddFolderWatch(void* context, const char* path, const char* full_path)
+{
+    InotifyState* state = (InotifyState*)context;
+    int wd = inotify_add_watch(state->fd, full_path, WATCH_INOTIFY_MASK);
+
+    if (wd < 0)
+    {
+        if (errno == ENOSPC || errno == ENOMEM)
+        {
+            state->exhausted = 1;
+        }
+        return 0;
+    }
+    if (wd >= state->capacity)
+    {
+        int capacity = wd + 1 > state->capacity * 2 ? wd + 1 : state->capacity * 2;
+        char** folders = (char**)realloc(state->folders, (size_t)capacity * sizeof(char*));
+        if (folders == NULL)
+        {
+            inotify_rm_watch(state->fd, wd);
+            state->exhausted = 1;
+            return 0;
+        }
+        memset(folders + state->capacity, 0, (size_t)(capacity - state->capacity) * sizeof(char*));
+        state->folders = folders;
+        state->capacity = capacity;
+    }
+    free(state->folders[wd]);
+    state->folders[wd] = CopyString(path);
+    return 1;
+}
+
+static int QueueAddedFile(void* context, const char* path, uint64_t size, int64_t modified)
+{
+    InotifyState* state = (InotifyState*)context;
+    (void)size;
+    (void)modified;
+    QueueChange(state->batch, path, WATCH_ADDED, 0);
+    return 1;
+}
+
+/*
+ * Stop watching a folder that moved away, and everything below it.
+ */
+static void RemoveFolderWatches(InotifyState* state, const char* path)
+{
+    size_t length = strlen(path);
+    int wd;
+
+    for (wd = 0; wd < state->capacity; wd++)
+    {
+        const char* folder = state->folders[wd];
+        if (folder != NULL && strncmp(folder, path, length) == 0 && (folder[length] == '/' || folder[length] == '\0'))
+        {
+            inotify_rm_watch(state->fd, wd);
+            free(state->folders[wd]);
+            state->folders[wd] = NULL;
+        }
+    }
+}
+
+static void HandleInotifyEvent(InotifyState* state, const struct inotify_event* event)
+{
+    char path[PROJECT_MAX_PATH];
+
+    if ((event->mask & IN_IGNORED) != 0)
+    {
+        if (event->wd >= 0 && event->wd < state->capacity)
+        {
+            free(state->folders[event->wd]);
+            state->folders[event->wd] = NULL;
+        }
+        return;
+    }
+    if (event->len == 0 || event->wd < 0 || event->wd >= state->capacity || state->folders[event->wd] == NULL ||
+        snprintf(path, sizeof(path), "%s/%s", state->folders[event->wd], event->name) >= (int)sizeof(path) ||
+        ProjectIsExcluded(path))
+    {
+        return;
+    }
+
+    if ((event->mask & IN_ISDIR) != 0)
+    {
+        if ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0)
+        {
+            /* Files may land in it before its watch exists: report what is there */
+            QueueChange(state->batch, path, WATCH_ADDED, 1);
+            ProjectWalkTree(path, QueueAddedFile, AddFolderWatch, state);
+        }
+        else if ((event->mask & (IN_DELETE | IN_MOVED_FROM)) != 0)
+        {
+            QueueChange(state->batch, path, WATCH_DELETED, 1);
+            RemoveFolderWatches(state, path);
+        }
+    }
+    else if ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0)
+    {
+        QueueChange(state->batch, path, WATCH_ADDED, 0);
+    }
+    else if ((event->mask & (IN_DELETE | IN_MOVED_FROM)) != 0)
+    {
+        QueueChange(state->batch, path, WATCH_DELETED, 0);
+    }
+    else if ((event->mask & (IN_MODIFY | IN_CLOSE_WRITE)) != 0)
+    {
+        QueueChange(state->batch, path, WATCH_MODIFIED, 0);
+    }
+}
+
+static void CloseInotify(InotifyState* state)
+{
+    int wd;
+    for (wd = 0; wd < state->capacity; wd++)
+    {
+        free(state->folders[wd]);
+    }
+    free(state->folders);
+    state->folders = NULL;
+    state->capacity = 0;
+    if (state->fd >= 0)
+    {
+        close(state->fd);
+        state->fd = -1;
+    }
+}
+
+/*
+ * Watch until a restart is requested (returns 1) or inotify cannot keep up
+ * with the tree (returns 0, to poll instead).
+ */
+static int WatchByInotify(unsigned restarts)
+{
+    union
+    {
+        struct inotify_event event;
+        char bytes[64 * 1024];
+    } buffer;
+    PendingBatch batch;
+    InotifyState state;
+    int watched = 0;
+    int result = 0;
+
+    memset(&batch, 0, sizeof(batch));
+    for (;;)
+    {
+        int overflowed = 0;
+
+        memset(&state, 0, sizeof(state));
+        state.batch = &batch;
+        if ((state.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) < 0)
+        {
+            break;
+        }
+        ProjectWalkTree(NULL, NULL, AddFolderWatch, &state);
+        if (state.exhausted)
+        {
+            CloseInotify(&state);
+            break;
+        }
+        SetMode(WATCH_MODE_INOTIFY);
+        ClearBatch(&batch);
+        watched = 1;
+
+        while (!overflowed && !state.exhausted)
+        {
+            struct pollfd descriptor;
+            int timeout = 250;
+            ssize_t length;
+
+            if (batch.count > 0)
+            {
+                uint64_t now = mg_millis();
+                uint64_t due = batch.last_at + WATCH_DEBOUNCE_MS;
+                if (due > batch.first_at + WATCH_MAX_DELAY_MS)
+                {
+                    due = batch.first_at + WATCH_MAX_DELAY_MS;
+                }
+                timeout = due > now ? (int)(due - now) : 0;
+            }
+            descriptor.fd = state.fd;
+            descriptor.events = POLLIN;
+            descriptor.revents = 0;
+            poll(&descriptor, 1, timeout);
+            if (RestartRequested(restarts))
+            {
+                result = 1;
+                break;
+            }
+
+            while ((length = read(state.fd, buffer.bytes, sizeof(buffer.bytes))) > 0)
+            {
+                const char* p = buffer.bytes;
+                while (p < buffer.bytes + length)
+                {
+                    const struct inotify_event* event = (const struct inotify_event*)(const void*)p;
+                    if ((event->mask & IN_Q_OVERFLOW) != 0)
+                    {
+                        overflowed = 1;
+                    }
+                    else
+                    {
+                        HandleInotifyEvent(&state, event);
+                    }
+                    p += sizeof(struct inotify_event) + event->len;
+                }
+            }
+
+            if (batch.count > 0)
+            {
+                uint64_t now = mg_millis();
+                if (overflowed || state.exhausted || now >= batch.last_at + WATCH_DEBOUNCE_MS ||
+                    now >= batch.first_at + WATCH_MAX_DELAY_MS)
+                {
+                    PublishBatch(&batch);
+                }
+            }
+        }
+        CloseInotify(&state);
+        if (result == 1 || state.exhausted)
+        {
+            break;
+        }
+        /* Events were dropped: tell clients to rescan, then watch the tree afresh */
+        AppendReset();
+        SearchRefresh();
+        AssetsRefresh();
+        ReferencesRefresh();
+        SymbolsRefresh();
+    }
+    if (state.exhausted && watched)
+    {
+        AppendReset();  /* Changes until polling starts are missed */
+    }
+    FreeBatch(&batch);
+    return result;
+}
+
+#endif
+
+static void RunWatcher(void)
+{
+    int started = 0;
+
+    for (;;)
+    {
+        char root[PROJECT_MAX_PATH];
+        unsigned restarts;
+
+        PROXY_MUTEX_LOCK(&s_watch_lock);
+        while (ProjectRoot(root, sizeof(root)) == 0)
+        {
+            s_watch_mode = WATCH_MODE_OFF;
+            PROXY_CONDITION_WAIT(&s_watch_wake, &s_watch_lock);
+        }
+        restarts = s_watch_restarts;
+        PROXY_MUTEX_UNLOCK(&s_watch_lock);
+
+        /* Changes reported so far name files of another configuration */
+        if (started)
+        {
+            AppendReset();
+        }
+        started = 1;
+
+#ifdef __linux__
+        if (WatchByInotify(restarts))
+        {
+            continue;
+        }
+#endif
+        WatchByPolling(restarts);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI WatcherThreadFunc(LPVOID param)
+{
+    (void)param;
+    RunWatcher();
+    return 0;
+}
+#else
+static void* WatcherThreadFunc(void* param)
+{
+    (void)param;
+    RunWatcher();
+    return NULL;
+}
+#endif
+
+void WatcherRestart(void)
+{
+    int start;
+
+    PROXY_MUTEX_LOCK(&s_watch_lock);
+    s_watch_restarts++;
+    start = !s_watch_started;
+    s_watch_started = 1;
+    PROXY_CONDITION_BROADCAST(&s_watch_wake);
+    PROXY_MUTEX_UNLOCK(&s_watch_lock);
+
+    if (start)
+    {
+#ifdef _WIN32
+        HANDLE thread = CreateThread(NULL, 0, WatcherThreadFunc, NULL, 0, NULL);
+        start = thread != NULL;
+        if (start)
+        {
+            CloseHandle(thread);
+        }
+#else
+        pthread_t thread;
+        start = pthread_create(&thread, NULL, WatcherThreadFunc, NULL) == 0;
+        if (start)
+        {
+            pthread_detach(thread);
+        }
+#endif
+        if (!start)
+        {
+            PROXY_MUTEX_LOCK(&s_watch_lock);
+            s_watch_started = 0;
+            PROXY_MUTEX_UNLOCK(&s_watch_lock);
+        }
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ * UnixxtyMCP Proxy - Project file watcher
+ *
+ * Follows changes to the files the project walk covers (see project.h) and
+ * publishes them in debounced batches. On Linux every folder gets an
+ * inotify watch, and a burst of events (an editor saving, a git checkout)
+ * is coalesced until WATCH_DEBOUNCE_MS pass without another one, or until
+ * WATCH_MAX_DELAY_MS after its first. On other platforms, or once inotify
+ * runs out of watches, the tree is walked again every
+ * WATCH_POLL_INTERVAL_MS and compared by size and modification time.
+ *
+ * Every change gets a sequence number and the latest WATCH_LOG_CAPACITY
+ * are kept. Clients ask for the changes after the last sequence number they
+ * saw (their cursor) through GetFileChanges(), the "files/changes" method
+ * or the GET /events stream, and get back the cursor to pass next time.
+ * "reset" means changes were lost - the cursor is too old or from another
+ * session, events overflowed, or the project was reconfigured - and the
+ * client should rescan whatever it derived from the files.
+ *
+ * A change is {"path","kind"} with kind "added", "modified" or "deleted".
+ * Folders are reported with "directory":true when inotify sees them
+ * created, moved or deleted; their contents changed with them. A file
+ * replaced by a rename (the usual atomic save) is reported as "added".
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_WATCHER_H
+#define UNITY_MCP_WATCHER_H
+
+#include "mongoose.h"
+#include <stdint.h>
+
+#define WATCH_DEBOUNCE_MS 50
+#define WATCH_MAX_DELAY_MS 500
+#define WATCH_POLL_INTERVAL_MS 1000
+#define WATCH_LOG_CAPACITY 8192
+#define WATCH_MAX_REPLY 2000           /* Changes per reply; "more" marks the rest */
+
+typedef enum WatchMode
+{
+    WATCH_MODE_OFF = 0,
+    WATCH_MODE_INOTIFY,
+    WATCH_MODE_POLLING
+} WatchMode;
+
+/*
+ * Start watching, or start over after the project configuration changed.
+ */
+void WatcherRestart(void);
+
+WatchMode WatcherMode(void);
+const char* WatcherModeName(WatchMode mode);
+
+/*
+ * Sequence number of the latest change (0 before the first).
+ */
+int64_t WatcherCursor(void);
+
+/*
+ * Append {"cursor","reset","more","mode","changes"} for the changes after
+ * `cursor`. A negative cursor starts at the latest change. Returns the
+ * cursor reported, to pass next time.
+ */
+int64_t WatcherFormatChanges(int64_t cursor, struct mg_iobuf* out);
+
+/*
+ * The "files/changes" method (a ProjectMethod, see project.h): params
+ * {"cursor"}.
+ */
+int FileChangesMethod(struct mg_str request, struct mg_iobuf* result, const char** error);
+
+#endif /* UNITY_MCP_WATCHER_H */
@@ -0,0 +1,252 @@
+/*
+ * UnixxtyMCP Proxy - Native worker pool
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#include "workers.h"
+#include "platform.h"
+#include <stdlib.h>
+
+typedef struct WorkerItem
+{
+    WorkerTask task;
+    void* context;
+    struct WorkerItem* next;
+} WorkerItem;
+
+static ProxyMutex s_worker_lock = PROXY_MUTEX_INITIALIZER;
+static ProxyCondition s_worker_wake = PROXY_CONDITION_INITIALIZER;
+static WorkerItem* s_queue_head = NULL;
+static WorkerItem* s_queue_tail = NULL;
+static int s_thread_count = 0;
+static int s_started = 0;
+
+static void RunWorker(void)
+{
+    for (;;)
+    {
+        WorkerItem* item;
+
+        PROXY_MUTEX_LOCK(&s_worker_lock);
+        while (s_queue_head == NULL)
+        {
+            PROXY_CONDITION_WAIT(&s_worker_wake, &s_worker_lock);
+        }
+        item = s_queue_head;
+        s_queue_head = item->next;
+        if (s_queue_head == NULL)
+        {
+            s_queue_tail = NULL;
+        }
+        PROXY_MUTEX_UNLOCK(&s_worker_lock);
+
+        item->task(item->context);
+        free(item);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI WorkerThreadFunc(LPVOID param)
+{
+    (void)param;
+    RunWorker();
+    return 0;
+}
+#else
+static void* WorkerThreadFunc(void* param)
+{
+    (void)param;
+    RunWorker();
+    return NULL;
+}
+#endif
+
+/*
+ * Start the threads. Caller holds the lock.
+ */
+static void StartWorkers(void)
+{
+    int wanted = GetProcessorCount() - 1;
+    int i;
+
+    s_started = 1;
+    if (wanted < 1) wanted = 1;
+    if (wanted > WORKER_MAX_THREADS) wanted = WORKER_MAX_THREADS;
+
+    for (i = 0; i < wanted; i++)
+    {
+#ifdef _WIN32
+        HANDLE thread = CreateThread(NULL, 0, WorkerThreadFunc, NULL, 0, NULL);
+        if (thread == NULL)
+        {
+            break;
+        }
+        CloseHandle(thread);
+#else
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, WorkerThreadFunc, NULL) != 0)
+        {
+            break;
+        }
+        pthread_detach(thread);
+#endif
+        s_thread_count++;
+    }
+}
+
+int WorkerSubmit(WorkerTask task, void* context)
+{
+    WorkerItem* item = (WorkerItem*)malloc(sizeof(WorkerItem));
+    if (item == NULL)
+    {
+        return 0;
+    }
+    item->task = task;
+    item->context = context;
+    item->next = NULL;
+
+    PROXY_MUTEX_LOCK(&s_worker_lock);
+    if (!s_started)
+    {
+        StartWorkers();
+    }
+    if (s_thread_count == 0)
+    {
+        PROXY_MUTEX_UNLOCK(&s_worker_lock);
+        free(item);
+        return 0;
+    }
+    if (s_queue_tail != NULL) s_queue_tail->next = item;
+    else s_queue_head = item;
+    s_queue_tail = item;
+    PROXY_CONDITION_SIGNAL(&s_worker_wake);
+    PROXY_MUTEX_UNLOCK(&s_worker_lock);
+    return 1;
+}
+
+int WorkerCount(void)
+{
+    int count;
+    PROXY_MUTEX_LOCK(&s_worker_lock);
+    if (!s_started)
+    {
+        StartWorkers();
+    }
+    count = s_thread_count;
+    PROXY_MUTEX_UNLOCK(&s_worker_lock);
+    return count;
+}
+
+typedef struct ParallelRange
+{
+    WorkerRange body;
+    void* context;
+    int count;
+    int grain;
+    int next;           /* First item not taken yet */
+    int running;        /* Chunks taken but not finished */
+    int references;     /* The caller and the helpers not yet finished */
+} ParallelRange;
+
+static ProxyMutex s_parallel_lock = PROXY_MUTEX_INITIALIZER;
+static ProxyCondition s_parallel_done = PROXY_CONDITION_INITIALIZER;
+
+/*
+ * Take and run chunks until none are left.
+ */
+static void RunChunks(ParallelRange* range)
+{
+    PROXY_MUTEX_LOCK(&s_parallel_lock);
+    while (range->next < range->count)
+    {
+        int begin = range->next;
+        int end = range->count - begin > range->grain ? begin + range->grain : range->count;
+
+        range->next = end;
+        range->running++;
+        PROXY_MUTEX_UNLOCK(&s_parallel_lock);
+
+        range->body(range->context, begin, end);
+
+        PROXY_MUTEX_LOCK(&s_parallel_lock);
+        range->running--;
+    }
+    if (range->running == 0)
+    {
+        PROXY_CONDITION_BROADCAST(&s_parallel_done);
+    }
+    PROXY_MUTEX_UNLOCK(&s_parallel_lock);
+}
+
+/*
+ * Drop a reference, freeing the range with the last one.
+ */
+static void ReleaseRange(ParallelRange* range, int references)
+{
+    int last;
+
+    PROXY_MUTEX_LOCK(&s_parallel_lock);
+    range->references -= references;
+    last = range->references == 0;
+    PROXY_MUTEX_UNLOCK(&s_parallel_lock);
+    if (last)
+    {
+        free(range);
+    }
+}
+
+static void RunHelper(void* context)
+{
+    ParallelRange* range = (ParallelRange*)context;
+    RunChunks(range);
+    ReleaseRange(range, 1);
+}
+
+void WorkerParallelFor(int count, int grain, WorkerRange body, void* context)
+{
+    ParallelRange* range;
+    int chunks, helpers, i;
+
+    if (count <= 0)
+    {
+        return;
+    }
+    if (grain < 1) grain = 1;
+    chunks = (count - 1) / grain + 1;
+    helpers = chunks > 1 ? WorkerCount() : 0;
+    if (helpers > chunks - 1) helpers = chunks - 1;
+
+    range = helpers > 0 ? (ParallelRange*)malloc(sizeof(ParallelRange)) : NULL;
+    if (range == NULL)
+    {
+        body(context, 0, count);
+        return;
+    }
+    range->body = body;
+    range->context = context;
+    range->count = count;
+    range->grain = grain;
+    range->next = 0;
+    range->running = 0;
+    range->references = 1 + helpers;
+
+    for (i = 0; i < helpers; i++)
+    {
+        if (!WorkerSubmit(RunHelper, range))
+        {
+            ReleaseRange(range, helpers - i);
+            break;
+        }
+    }
+
+    /* Helpers still queued behind other tasks find nothing left to take */
+    RunChunks(range);
+    PROXY_MUTEX_LOCK(&s_parallel_lock);
+    while (range->running > 0)
+    {
+        PROXY_CONDITION_WAIT(&s_parallel_done, &s_parallel_lock);
+    }
+    PROXY_MUTEX_UNLOCK(&s_parallel_lock);
+    ReleaseRange(range, 1);
+}
@@ -0,0 +1,41 @@
+/*
+ * UnixxtyMCP Proxy - Native worker pool
+ *
+ * A fixed set of background threads for CPU-heavy work handed over by C#
+ * (image encoding), so neither Unity's main thread nor the server thread
+ * pays for it. Threads are started on first use, one per processor minus
+ * one (at least one, at most WORKER_MAX_THREADS), and live until the
+ * process exits, like the plugin itself. Tasks run in submission order.
+ * WorkerParallelFor() splits a synchronous loop across the pool; the calling
+ * thread works through the chunks too, so it never waits on queued tasks.
+ *
+ * License: GPLv2 (compatible with Mongoose library)
+ */
+
+#ifndef UNITY_MCP_WORKERS_H
+#define UNITY_MCP_WORKERS_H
+
+#define WORKER_MAX_THREADS 8
+
+typedef void (*WorkerTask)(void* context);
+typedef void (*WorkerRange)(void* context, int begin, int end);
+
+/*
+ * Queue a task. Returns 0 if it could not be queued (no thread could be
+ * started, or out of memory); the caller then still owns the context.
+ */
+int WorkerSubmit(WorkerTask task, void* context);
+
+/*
+ * Number of worker threads (starting them if needed).
+ */
+int WorkerCount(void);
+
+/*
+ * Run body over [0, count) in chunks of `grain` items, on the workers and
+ * the calling thread, and return once every chunk is done. Chunks may run
+ * in any order and concurrently.
+ */
+void WorkerParallelFor(int count, int grain, WorkerRange body, void* context);
+
+#endif /* UNITY_MCP_WORKERS_H */
@@ -6,6 +6,9 @@ Watches:
   tools/*.py          → Restart sidecar process
   Package/**/*.cs     → Trigger Unity recompile via MCP
 
+C# changes come from the Unity proxy's file change stream (GET /events) when the
+project Unity has open uses this Package/ folder; otherwise the tree is polled.
+
 Usage:
   python tools/dev.py [sidecar args...]
 
@@ -14,15 +17,21 @@ Examples:
   python tools/dev.py --verbose --log dev.log  # passed to sidecar.py
 """
 
+import json
 import os
+import queue
 import sys
 import signal
 import subprocess
+import threading
 import time
+import urllib.request
 
 # ─── Configuration ───────────────────────────────────────────────────────────
 
 POLL_INTERVAL = 1.5  # seconds between file checks
+STREAM_RETRY_SECONDS = 3.0  # wait before reconnecting to the change stream
+STREAM_READ_TIMEOUT = 40  # the proxy sends a keepalive every 15s
 DEBOUNCE_SECONDS = 2.0  # ignore rapid successive changes
 SIDECAR_RESTART_DELAY = 0.3  # brief pause before restarting sidecar
 
@@ -74,6 +83,87 @@ def find_changes(old_snapshot, new_snapshot):
     return changes
 
 
+class ChangeStream:
+    """
+    Follows the Unity proxy's file change stream (GET /events) on a thread.
+
+    The proxy watches the project with inotify (or polling) and sends debounced batches
+    of project-relative paths. Only C# files of this Package/ folder are queued, and only
+    when the project uses it, embedded or as a local "file:" package.
+    """
+
+    def __init__(self, port, package_dir):
+        self.url = f"http://localhost:{port}/events"
+        self.package_dir = os.path.realpath(package_dir)
+        self.package_path = None  # "Packages/<name>" while the stream covers Package/
+        self.events = queue.Queue()
+        self.cursor = None
+        threading.Thread(target=self._run, daemon=True).start()
+
+    def covers_package(self):
+        return self.package_path is not None
+
+    def wait(self, timeout):
+        """Block up to timeout for changes; returns [(path, change_type)], or None after a reset."""
+        changes = []
+        try:
+            item = self.events.get(timeout=timeout)
+            while True:
+                if item is None:
+                    return None
+                changes.append(item)
+                item = self.events.get_nowait()
+        except queue.Empty:
+            return changes
+
+    def _run(self):
+        while True:
+            try:
+                url = self.url if self.cursor is None else f"{self.url}?cursor={self.cursor}"
+                with urllib.request.urlopen(url, timeout=STREAM_READ_TIMEOUT) as stream:
+                    self._read(stream)
+            except Exception:
+                pass
+            self.package_path = None
+            time.sleep(STREAM_RETRY_SECONDS)
+
+    def _read(self, stream):
+        event = None
+        for raw in stream:
+            line = raw.decode("utf-8", "replace").rstrip("\r\n")
+            if line.startswith("event: "):
+                event = line[7:]
+            elif line.startswith("data: ") and event == "hello":
+                self._on_hello(json.loads(line[6:]))
+            elif line.startswith("data: ") and event == "changes":
+                self._on_changes(json.loads(line[6:]))
+
+    def _on_hello(self, hello):
+        self.package_path = None
+        folders = dict(hello.get("packages", {}))
+        try:
+            with open(os.path.join(self.package_dir, "package.json"), encoding="utf-8") as f:
+                name = json.load(f)["name"]
+            folders.setdefault(f"Packages/{name}", os.path.join(hello["root"], "Packages", name))
+            folder = folders[f"Packages/{name}"]
+            if os.path.realpath(folder) == self.package_dir:
+                self.package_path = f"Packages/{name}"
+        except (OSError, KeyError, ValueError):
+            pass
+        if self.cursor is None:
+            self.cursor = hello.get("cursor")
+
+    def _on_changes(self, batch):
+        self.cursor = batch.get("cursor", self.cursor)
+        if batch.get("reset"):
+            self.events.put(None)
+        prefix = f"{self.package_path}/" if self.package_path else None
+        for change in batch.get("changes", []):
+            path = change.get("path", "")
+            if prefix and path.startswith(prefix) and (path.endswith(".cs") or change.get("directory")):
+                self.events.put((os.path.join(self.package_dir, path[len(prefix):]), change.get("kind")))
+
+
 def relative_path(path):
     """Make path relative to project root for cleaner display."""
     try:
@@ -188,6 +278,8 @@ def main():
 
     sidecar = SidecarProcess(sidecar_args)
     sidecar.start()
+    stream = ChangeStream(unity_port, PACKAGE_DIR)
+    streamed_cs = []
 
     # Take initial snapshots
     py_snapshot = collect_files(TOOLS_DIR, ".py")
@@ -205,7 +297,15 @@ def main():
 
     try:
         while True:
-            time.sleep(POLL_INTERVAL)
+            if stream.covers_package():
+                # Wakes as soon as the proxy reports a batch
+                changes = stream.wait(POLL_INTERVAL)
+                if changes is None:
+                    # The proxy lost events: diff against the last snapshot once
+                    changes = find_changes(cs_snapshot, collect_files(PACKAGE_DIR, ".cs"))
+                streamed_cs.extend(changes)
+            else:
+                time.sleep(POLL_INTERVAL)
 
             now = time.time()
 
@@ -236,8 +336,12 @@ def main():
             py_snapshot = new_py
 
             # Check C# file changes → trigger Unity recompile
-            new_cs = collect_files(PACKAGE_DIR, ".cs")
-            cs_changes = find_changes(cs_snapshot, new_cs)
+            if stream.covers_package():
+                cs_changes, streamed_cs = streamed_cs, []
+                new_cs = cs_snapshot
+            else:
+                new_cs = collect_files(PACKAGE_DIR, ".cs")
+                cs_changes = find_changes(cs_snapshot, new_cs)
             if cs_changes:
                 last_change_time = now
                 for path, change_type in cs_changes:
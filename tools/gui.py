@@ -24,6 +24,8 @@ from tkinter import ttk, scrolledtext
 import urllib.request
 import urllib.error
 
+from dev import ChangeStream
+
 # ─── Paths ───────────────────────────────────────────────────────────────────
 
 TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
@@ -36,6 +38,7 @@ SETTINGS_FILE = os.path.join(TOOLS_DIR, ".gui_settings.json")
 
 STATUS_POLL_MS = 2000
 FILE_POLL_MS = 1500
+STREAM_POLL_MS = 100
 LOG_DRAIN_MS = 100
 UPTIME_MS = 1000
 DEBOUNCE_SECONDS = 2.0
@@ -99,6 +102,8 @@ class SidecarGUI(tk.Tk):
         # File watching
         self.py_snap = {}
         self.cs_snap = {}
+        self.cs_stream = None
+        self.streamed_cs = []
         self.last_change = 0
 
         # Instance tracking from /status
@@ -121,6 +126,7 @@ class SidecarGUI(tk.Tk):
         # Schedule periodic tasks
         self.after(STATUS_POLL_MS, self._poll_status)
         self.after(FILE_POLL_MS, self._poll_files)
+        self.after(STREAM_POLL_MS, self._drain_stream)
         self.after(LOG_DRAIN_MS, self._drain_logs)
         self.after(UPTIME_MS, self._tick_uptime)
 
@@ -240,6 +246,8 @@ class SidecarGUI(tk.Tk):
         # Snapshot files
         self.py_snap = collect_files(TOOLS_DIR, ".py")
         self.cs_snap = collect_files(PACKAGE_DIR, ".cs")
+        if self.cs_stream is None:
+            self.cs_stream = ChangeStream(self.unity_port, PACKAGE_DIR)
 
         # Stderr reader thread
         threading.Thread(target=self._read_stderr, daemon=True).start()
@@ -354,20 +362,40 @@ class SidecarGUI(tk.Tk):
             return
         self.py_snap = new_py
 
-        # C# files → trigger Unity recompile
-        new_cs = collect_files(PACKAGE_DIR, ".cs")
-        cs_changes = find_changes(self.cs_snap, new_cs)
-        if cs_changes:
-            self.last_change = now
-            for path, kind in cs_changes:
-                self._log(f"[dev] {kind}: {relative_path(path)}", "DEV")
-            threading.Thread(target=self._trigger_recompile, daemon=True).start()
-            self.cs_snap = collect_files(PACKAGE_DIR, ".cs")
-        else:
-            self.cs_snap = new_cs
+        # C# files → trigger Unity recompile (_drain_stream handles them while streamed)
+        if not self._stream_covers_package():
+            new_cs = collect_files(PACKAGE_DIR, ".cs")
+            cs_changes = find_changes(self.cs_snap, new_cs)
+            if cs_changes:
+                self._recompile_for(cs_changes)
+            else:
+                self.cs_snap = new_cs
 
         self.after(FILE_POLL_MS, self._poll_files)
 
+    def _stream_covers_package(self):
+        return self.cs_stream is not None and self.cs_stream.covers_package()
+
+    def _drain_stream(self):
+        if self._stream_covers_package():
+            changes = self.cs_stream.wait(0)
+            if changes is None:
+                # The proxy lost events: diff against the last snapshot once
+                changes = find_changes(self.cs_snap, collect_files(PACKAGE_DIR, ".cs"))
+            self.streamed_cs.extend(changes)
+            if (self.streamed_cs and self._is_alive()
+                    and time.time() - self.last_change >= DEBOUNCE_SECONDS):
+                cs_changes, self.streamed_cs = self.streamed_cs, []
+                self._recompile_for(cs_changes)
+        self.after(STREAM_POLL_MS, self._drain_stream)
+
+    def _recompile_for(self, cs_changes):
+        self.last_change = time.time()
+        for path, kind in cs_changes:
+            self._log(f"[dev] {kind}: {relative_path(path)}", "DEV")
+        threading.Thread(target=self._trigger_recompile, daemon=True).start()
+        self.cs_snap = collect_files(PACKAGE_DIR, ".cs")
+
     def _trigger_recompile(self):
         body = json.dumps({
             "jsonrpc": "2.0",